@@ -13,6 +13,7 @@ option(ORYOL_UNITTESTS "Enable unit tests" ON)
 option(ORYOL_UNITTESTS_RUN_AFTER_BUILD "Automatically run unit tests after building" OFF)
 option(ORYOL_EXCEPTIONS "Enable C++ exceptions" OFF)
 option(ORYOL_ALLOCATOR_DEBUG "Enable allocator debugging code (slow)" OFF)
+option(ORYOL_PROFILING "Enable CPU profiler markers in release builds (always on in debug builds)" OFF)
 option(ORYOL_SAMPLES "Compile sample programs" ON)
 
 # turn some dependent options on/off
@@ -87,6 +88,9 @@ macro(oryol_setup)
     else()
         add_definitions(-DORYOL_ALLOCATOR_DEBUG=0)
     endif()
+    if (ORYOL_PROFILING)
+        add_definitions(-DORYOL_PROFILING=1)
+    endif()
     if (ORYOL_UNITTESTS)
         add_definitions(-DORYOL_UNITTESTS=1)
     else()
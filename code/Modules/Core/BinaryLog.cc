@@ -0,0 +1,467 @@
+//------------------------------------------------------------------------------
+//  BinaryLog.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "BinaryLog.h"
+#include "Core/Assert.h"
+#include "Core/String/String.h"
+#include "Core/Threading/spscRecordQueue.h"
+#include "Core/Time/Clock.h"
+#include <atomic>
+#include <mutex>
+#include <cstdio>
+
+namespace Oryol {
+namespace Core {
+
+namespace {
+    // a registered call site
+    struct binLogFormat {
+        Log::Level level;
+        const char* file;
+        int32 line;
+        const char* fmt;
+    };
+
+    // record header in the thread buffers and dumps, followed by the arguments
+    struct binLogRecord {
+        int64 time;
+        int32 formatId;
+        uint32 argsSize;
+    };
+
+    // per-thread record buffer, created on first use and never freed
+    struct binLogBuffer {
+        int32 threadIndex;
+        spscRecordQueue<ORYOL_BINARYLOG_BUFFER_SIZE> queue;
+    };
+
+    const uint32 dumpMagic = 'BLOG';
+    const uint32 dumpVersion = 1;
+    /// smallest encoded format entry: level, line and two empty strings
+    const int32 minFormatSize = 2 * sizeof(int32) + 2 * sizeof(uint16);
+    const int32 maxTextLength = 4096;
+
+    binLogFormat formats[ORYOL_BINARYLOG_MAX_FORMATS];
+    std::atomic<int32> numFormats{0};
+    std::atomic<int32> numDropped{0};
+    std::mutex formatLock;
+    std::mutex registryLock;
+    std::mutex consumerLock;
+    Array<binLogBuffer*> buffers;
+    ORYOL_THREAD_LOCAL binLogBuffer* threadBuffer = nullptr;
+
+    //--------------------------------------------------------------------------
+    binLogBuffer* getThreadBuffer() {
+        if (nullptr == threadBuffer) {
+            binLogBuffer* buf = new binLogBuffer;
+            std::lock_guard<std::mutex> lock(registryLock);
+            buf->threadIndex = buffers.Size();
+            buffers.AddBack(buf);
+            threadBuffer = buf;
+        }
+        return threadBuffer;
+    }
+
+    //--------------------------------------------------------------------------
+    // call func(threadIndex, record) for all pending records, oldest first
+    template<class FUNC> int32 consumeRecords(FUNC func) {
+        Array<binLogBuffer*> bufs;
+        {
+            std::lock_guard<std::mutex> lock(registryLock);
+            bufs = buffers;
+        }
+        int32 num = 0;
+        for (;;) {
+            binLogBuffer* oldestBuf = nullptr;
+            const binLogRecord* oldestRec = nullptr;
+            for (binLogBuffer* buf : bufs) {
+                uint32 size = 0;
+                const binLogRecord* rec = (const binLogRecord*) buf->queue.Front(size);
+                if ((nullptr != rec) && ((nullptr == oldestRec) || (rec->time < oldestRec->time))) {
+                    oldestBuf = buf;
+                    oldestRec = rec;
+                }
+            }
+            if (nullptr == oldestRec) {
+                break;
+            }
+            func(oldestBuf->threadIndex, oldestRec);
+            oldestBuf->queue.Pop();
+            num++;
+        }
+        return num;
+    }
+
+    //--------------------------------------------------------------------------
+    // appends to a fixed-size, always 0-terminated text buffer
+    struct textWriter {
+        char* buf;
+        int32 size;
+        int32 len;
+
+        void append(char c) {
+            if (this->len < (this->size - 1)) {
+                this->buf[this->len++] = c;
+                this->buf[this->len] = 0;
+            }
+        };
+        template<typename... ARGS> void appendf(const char* fmt, ARGS... args) {
+            if (this->len < (this->size - 1)) {
+                int32 n = std::snprintf(this->buf + this->len, this->size - this->len, fmt, args...);
+                if (n > 0) {
+                    this->len = std::min(this->len + n, this->size - 1);
+                }
+            }
+        };
+    };
+
+    //--------------------------------------------------------------------------
+    // reads the encoded arguments of a record
+    struct argReader {
+        const uint8* ptr;
+        const uint8* end;
+        uint8 type;
+        uint64 bits;
+        char str[ORYOL_BINARYLOG_MAX_STRING_LENGTH + 1];
+
+        bool next() {
+            if (this->ptr >= this->end) {
+                return false;
+            }
+            this->type = *this->ptr++;
+            if (BinaryLog::ArgString == this->type) {
+                uint16 len = 0;
+                if ((this->end - this->ptr) < 2) {
+                    return false;
+                }
+                std::memcpy(&len, this->ptr, 2);
+                this->ptr += 2;
+                if ((len > ORYOL_BINARYLOG_MAX_STRING_LENGTH) || ((this->end - this->ptr) < len)) {
+                    return false;
+                }
+                std::memcpy(this->str, this->ptr, len);
+                this->str[len] = 0;
+                this->ptr += len;
+            }
+            else {
+                if ((this->type > BinaryLog::ArgString) || ((this->end - this->ptr) < 8)) {
+                    return false;
+                }
+                std::memcpy(&this->bits, this->ptr, 8);
+                this->ptr += 8;
+            }
+            return true;
+        };
+        long long asInt() const {
+            return (BinaryLog::ArgFloat64 == this->type) ? (long long) this->asFloat() : (long long) this->bits;
+        };
+        double asFloat() const {
+            if (BinaryLog::ArgInt64 == this->type) {
+                return double((long long) this->bits);
+            }
+            else if (BinaryLog::ArgFloat64 == this->type) {
+                double val;
+                std::memcpy(&val, &this->bits, 8);
+                return val;
+            }
+            return double(this->bits);
+        };
+    };
+
+    //--------------------------------------------------------------------------
+    // format the arguments of a record with a printf format string, the
+    // length modifiers of the format string are replaced with the ones
+    // matching the recorded argument types
+    void formatRecord(const char* fmt, const uint8* args, uint32 argsSize, char* buf, int32 bufSize) {
+        textWriter writer{buf, bufSize, 0};
+        buf[0] = 0;
+        argReader reader;
+        reader.ptr = args;
+        reader.end = args + argsSize;
+        const char* f = fmt;
+        while (*f) {
+            if ('%' != *f) {
+                writer.append(*f++);
+                continue;
+            }
+            if ('%' == f[1]) {
+                writer.append('%');
+                f += 2;
+                continue;
+            }
+            // copy flags, width and precision, skip length modifiers
+            char spec[32];
+            int32 specLen = 0;
+            spec[specLen++] = *f++;
+            while (*f && std::strchr("-+ #0123456789.", *f) && (specLen < 24)) {
+                spec[specLen++] = *f++;
+            }
+            while (*f && std::strchr("hlLqjzt", *f)) {
+                f++;
+            }
+            const char conv = *f;
+            if (0 == conv) {
+                break;
+            }
+            f++;
+            if (!std::strchr("diuoxXcfFeEgGaAsp", conv)) {
+                continue;
+            }
+            if (!reader.next()) {
+                writer.appendf("%s", "<missing>");
+                continue;
+            }
+            switch (conv) {
+                case 'd':
+                case 'i':
+                case 'u':
+                case 'o':
+                case 'x':
+                case 'X':
+                    if (BinaryLog::ArgString == reader.type) {
+                        writer.appendf("%s", "<?>");
+                    }
+                    else {
+                        spec[specLen++] = 'l';
+                        spec[specLen++] = 'l';
+                        spec[specLen++] = conv;
+                        spec[specLen] = 0;
+                        writer.appendf(spec, reader.asInt());
+                    }
+                    break;
+                case 'c':
+                    spec[specLen++] = conv;
+                    spec[specLen] = 0;
+                    writer.appendf(spec, int(reader.asInt()));
+                    break;
+                case 's':
+                    spec[specLen++] = conv;
+                    spec[specLen] = 0;
+                    writer.appendf(spec, (BinaryLog::ArgString == reader.type) ? reader.str : "<?>");
+                    break;
+                case 'p':
+                    spec[specLen++] = conv;
+                    spec[specLen] = 0;
+                    writer.appendf(spec, (const void*) (uintptr_t) reader.bits);
+                    break;
+                default:
+                    if (BinaryLog::ArgString == reader.type) {
+                        writer.appendf("%s", "<?>");
+                    }
+                    else {
+                        spec[specLen++] = conv;
+                        spec[specLen] = 0;
+                        writer.appendf(spec, reader.asFloat());
+                    }
+                    break;
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    void putBytes(Array<uint8>& dst, const void* src, int32 size) {
+        const uint8* ptr = (const uint8*) src;
+        for (int32 i = 0; i < size; i++) {
+            dst.AddBack(ptr[i]);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    void putString(Array<uint8>& dst, const char* str) {
+        const uint16 len = uint16(std::min(std::strlen(str), size_t(0xFFFF)));
+        putBytes(dst, &len, sizeof(len));
+        putBytes(dst, str, len);
+    }
+
+    //--------------------------------------------------------------------------
+    // bounds-checked reads from a dump
+    struct dumpReader {
+        const uint8* ptr;
+        const uint8* end;
+
+        bool read(void* dst, int32 size) {
+            if ((this->end - this->ptr) < size) {
+                return false;
+            }
+            std::memcpy(dst, this->ptr, size);
+            this->ptr += size;
+            return true;
+        };
+        bool readString(String& str) {
+            uint16 len = 0;
+            if (!this->read(&len, sizeof(len)) || ((this->end - this->ptr) < len)) {
+                return false;
+            }
+            str.Assign((const char*) this->ptr, 0, len);
+            this->ptr += len;
+            return true;
+        };
+    };
+}
+
+//------------------------------------------------------------------------------
+BinaryLog::FormatId
+BinaryLog::RegisterFormat(Log::Level level, const char* file, int32 line, const char* fmt) {
+    o_assert((nullptr != file) && (nullptr != fmt));
+    std::lock_guard<std::mutex> lock(formatLock);
+    const int32 id = numFormats.load(std::memory_order_relaxed);
+    o_assert(id < ORYOL_BINARYLOG_MAX_FORMATS);
+    binLogFormat& format = formats[id];
+    format.level = level;
+    format.file = file;
+    format.line = line;
+    format.fmt = fmt;
+    numFormats.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+//------------------------------------------------------------------------------
+uint32
+BinaryLog::strLength(const char* str) {
+    if (nullptr == str) {
+        str = "(null)";
+    }
+    uint32 len = 0;
+    while (str[len] && (len < ORYOL_BINARYLOG_MAX_STRING_LENGTH)) {
+        len++;
+    }
+    return len;
+}
+
+//------------------------------------------------------------------------------
+uint8*
+BinaryLog::putArg(uint8* p, const char* str) {
+    const uint16 len = uint16(strLength(str));
+    *p++ = ArgString;
+    std::memcpy(p, &len, sizeof(len));
+    p += sizeof(len);
+    std::memcpy(p, str ? str : "(null)", len);
+    return p + len;
+}
+
+//------------------------------------------------------------------------------
+uint8*
+BinaryLog::beginWrite(FormatId id, uint32 argsSize) {
+    const uint32 size = sizeof(binLogRecord) + argsSize;
+    binLogBuffer* buf = getThreadBuffer();
+    binLogRecord* rec = nullptr;
+    if (size <= buf->queue.MaxRecordSize) {
+        rec = (binLogRecord*) buf->queue.BeginPush(size);
+    }
+    if (nullptr == rec) {
+        numDropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    rec->time = Clock::Now();
+    rec->formatId = id;
+    rec->argsSize = argsSize;
+    return (uint8*) (rec + 1);
+}
+
+//------------------------------------------------------------------------------
+void
+BinaryLog::endWrite() {
+    threadBuffer->queue.EndPush();
+}
+
+//------------------------------------------------------------------------------
+int32
+BinaryLog::GetNumDropped() {
+    return numDropped.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+int32
+BinaryLog::Dispatch() {
+    std::lock_guard<std::mutex> lock(consumerLock);
+    char text[maxTextLength];
+    return consumeRecords([&text](int32 /*threadIndex*/, const binLogRecord* rec) {
+        const binLogFormat& format = formats[rec->formatId];
+        formatRecord(format.fmt, (const uint8*) (rec + 1), rec->argsSize, text, sizeof(text));
+        switch (format.level) {
+            case Log::Level::Error: Log::Error("%s", text); break;
+            case Log::Level::Warn:  Log::Warn("%s", text); break;
+            case Log::Level::Info:  Log::Info("%s", text); break;
+            default:                Log::Dbg("%s", text); break;
+        }
+    });
+}
+
+//------------------------------------------------------------------------------
+Array<uint8>
+BinaryLog::CreateDump() {
+    std::lock_guard<std::mutex> lock(consumerLock);
+    Array<uint8> dump;
+    const int32 num = numFormats.load(std::memory_order_acquire);
+    putBytes(dump, &dumpMagic, sizeof(dumpMagic));
+    putBytes(dump, &dumpVersion, sizeof(dumpVersion));
+    putBytes(dump, &num, sizeof(num));
+    for (int32 i = 0; i < num; i++) {
+        const int32 level = int32(formats[i].level);
+        putBytes(dump, &level, sizeof(level));
+        putBytes(dump, &formats[i].line, sizeof(formats[i].line));
+        putString(dump, formats[i].file);
+        putString(dump, formats[i].fmt);
+    }
+    consumeRecords([&dump](int32 threadIndex, const binLogRecord* rec) {
+        putBytes(dump, &threadIndex, sizeof(threadIndex));
+        putBytes(dump, rec, sizeof(binLogRecord) + rec->argsSize);
+    });
+    return dump;
+}
+
+//------------------------------------------------------------------------------
+bool
+BinaryLog::Decode(const uint8* data, int32 size, const RecordFunc& func) {
+    dumpReader reader{data, data + size};
+    uint32 magic = 0, version = 0;
+    int32 num = 0;
+    if (!reader.read(&magic, sizeof(magic)) || (magic != dumpMagic) ||
+        !reader.read(&version, sizeof(version)) || (version != dumpVersion) ||
+        !reader.read(&num, sizeof(num)) || (num < 0) ||
+        (num > (reader.end - reader.ptr) / minFormatSize)) {
+        return false;
+    }
+    struct format {
+        int32 level;
+        int32 line;
+        String file;
+        String fmt;
+    };
+    Array<format> dumpFormats;
+    dumpFormats.Reserve(num);
+    for (int32 i = 0; i < num; i++) {
+        dumpFormats.EmplaceBack();
+        format& f = dumpFormats.Back();
+        if (!reader.read(&f.level, sizeof(f.level)) || !reader.read(&f.line, sizeof(f.line)) ||
+            !reader.readString(f.file) || !reader.readString(f.fmt)) {
+            return false;
+        }
+    }
+    char text[maxTextLength];
+    while (reader.ptr < reader.end) {
+        int32 threadIndex = 0;
+        binLogRecord rec;
+        if (!reader.read(&threadIndex, sizeof(threadIndex)) || !reader.read(&rec, sizeof(rec)) ||
+            (rec.formatId < 0) || (rec.formatId >= num) || ((reader.end - reader.ptr) < rec.argsSize)) {
+            return false;
+        }
+        const format& f = dumpFormats[rec.formatId];
+        formatRecord(f.fmt.AsCStr(), reader.ptr, rec.argsSize, text, sizeof(text));
+        reader.ptr += rec.argsSize;
+
+        Record record;
+        record.threadIndex = threadIndex;
+        record.time = rec.time;
+        record.level = Log::Level(f.level);
+        record.file = f.file.AsCStr();
+        record.line = f.line;
+        record.text = text;
+        func(record);
+    }
+    return true;
+}
+
+} // namespace Core
+} // namespace Oryol
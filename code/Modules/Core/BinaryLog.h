@@ -0,0 +1,152 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Core::BinaryLog
+    @brief deferred-format binary logging
+
+    Logging for hot code paths where even formatting a message costs too
+    much. The o_binlog() macro records the id of its call site (format
+    string, level, file and line, registered once on the first call) and
+    the raw argument values into a lock-free ring buffer of the calling
+    thread, formatting happens later:
+
+    - Dispatch() formats all pending records and sends them through
+      Log, call it regularly (e.g. from the RunLoop or a background
+      thread)
+    - CreateDump() moves all pending records into a self-contained
+      binary dump (format strings included), which can be written to
+      a file and formatted offline with Decode() (see the binlogdump
+      tool in code/Tools)
+
+    Example:
+    ```
+    o_binlog(Log::Level::Dbg, "frame %d: %s took %.3f ms\n", frameIndex, name, ms);
+    ```
+
+    Supported argument types are integers, floating point values,
+    pointers and C strings (copied, truncated to
+    ORYOL_BINARYLOG_MAX_STRING_LENGTH bytes). The format string must be
+    a string literal and may use all printf conversions except '*' width
+    and precision, the integer length modifiers don't need to match the
+    argument types. When a thread's buffer is full, records are dropped
+    (see GetNumDropped()). Dispatch(), CreateDump() and Decode() may be
+    called from any thread.
+*/
+#include <functional>
+#include <cstring>
+#include "Core/Types.h"
+#include "Core/Log.h"
+#include "Core/Containers/Array.h"
+
+namespace Oryol {
+namespace Core {
+
+class BinaryLog {
+public:
+    /// call site id
+    typedef int32 FormatId;
+
+    /// a decoded record
+    struct Record {
+        /// index of the thread which wrote the record
+        int32 threadIndex = 0;
+        /// time in nanoseconds (monotonic clock)
+        int64 time = 0;
+        /// log level of the call site
+        Log::Level level = Log::Level::InvalidLevel;
+        /// source file of the call site
+        const char* file = nullptr;
+        /// source line of the call site
+        int32 line = 0;
+        /// the formatted message
+        const char* text = nullptr;
+    };
+    /// callback for Decode()
+    typedef std::function<void(const Record& record)> RecordFunc;
+    /// argument type tags of the binary encoding
+    enum ArgType : uint8 {
+        ArgInt64,
+        ArgUInt64,
+        ArgFloat64,
+        ArgPointer,
+        ArgString,
+    };
+
+    /// register a call site (use the o_binlog macro)
+    static FormatId RegisterFormat(Log::Level level, const char* file, int32 line, const char* fmt);
+    /// write a record (use the o_binlog macro)
+    template<typename... ARGS> static void Write(FormatId id, ARGS... args);
+
+    /// format pending records and send them to Log, return number of records
+    static int32 Dispatch();
+    /// move pending records into a binary dump
+    static Array<uint8> CreateDump();
+    /// decode a binary dump, return false if the dump is invalid
+    static bool Decode(const uint8* data, int32 size, const RecordFunc& func);
+    /// get number of records dropped because a thread's buffer was full
+    static int32 GetNumDropped();
+
+private:
+    /// reserve a record in the calling thread's buffer, nullptr if full
+    static uint8* beginWrite(FormatId id, uint32 argsSize);
+    /// publish the record
+    static void endWrite();
+
+    /// get the encoded size of an argument
+    static uint32 argSize(long long) { return 1 + 8; };
+    static uint32 argSize(unsigned long long) { return 1 + 8; };
+    static uint32 argSize(int) { return 1 + 8; };
+    static uint32 argSize(unsigned int) { return 1 + 8; };
+    static uint32 argSize(long) { return 1 + 8; };
+    static uint32 argSize(unsigned long) { return 1 + 8; };
+    static uint32 argSize(double) { return 1 + 8; };
+    static uint32 argSize(const void*) { return 1 + 8; };
+    static uint32 argSize(const char* str) { return 1 + 2 + strLength(str); };
+    /// encode an argument
+    static uint8* putArg(uint8* p, long long val) { return put(p, ArgInt64, &val, 8); };
+    static uint8* putArg(uint8* p, unsigned long long val) { return put(p, ArgUInt64, &val, 8); };
+    static uint8* putArg(uint8* p, int val) { return putArg(p, (long long) val); };
+    static uint8* putArg(uint8* p, unsigned int val) { return putArg(p, (unsigned long long) val); };
+    static uint8* putArg(uint8* p, long val) { return putArg(p, (long long) val); };
+    static uint8* putArg(uint8* p, unsigned long val) { return putArg(p, (unsigned long long) val); };
+    static uint8* putArg(uint8* p, double val) { return put(p, ArgFloat64, &val, 8); };
+    static uint8* putArg(uint8* p, const void* ptr) {
+        uint64 val = (uint64) (uintptr_t) ptr;
+        return put(p, ArgPointer, &val, 8);
+    };
+    static uint8* putArg(uint8* p, const char* str);
+    /// write a type tag and raw value
+    static uint8* put(uint8* p, ArgType type, const void* val, uint32 size) {
+        *p++ = type;
+        std::memcpy(p, val, size);
+        return p + size;
+    };
+    /// get the truncated length of a string argument
+    static uint32 strLength(const char* str);
+};
+
+//------------------------------------------------------------------------------
+template<typename... ARGS> void
+BinaryLog::Write(FormatId id, ARGS... args) {
+    const uint32 sizes[] = { 0, argSize(args)... };
+    uint32 argsSize = 0;
+    for (uint32 size : sizes) {
+        argsSize += size;
+    }
+    uint8* p = beginWrite(id, argsSize);
+    if (nullptr != p) {
+        // braced initializer lists are evaluated left to right
+        uint8* const dummy[] = { p, (p = putArg(p, args))... };
+        (void)dummy;
+        endWrite();
+    }
+}
+
+} // namespace Core
+} // namespace Oryol
+
+/// record a binary log message with deferred formatting
+#define o_binlog(level, fmt, ...) do { \
+    static const Oryol::Core::BinaryLog::FormatId o_binlog_id = Oryol::Core::BinaryLog::RegisterFormat(level, __FILE__, __LINE__, fmt); \
+    Oryol::Core::BinaryLog::Write(o_binlog_id, ##__VA_ARGS__); \
+} while(0)
@@ -38,3 +38,54 @@
 #define ORYOL_CONTAINER_DEFAULT_MIN_GROW (16)
 /// maximum grow size for dynamic container classes (num elements)
 #define ORYOL_CONTAINER_DEFAULT_MAX_GROW (1<<16)
+
+/// default chunk size of the per-thread StringAtom string buffers (bytes, see StringAtom::SetChunkSize)
+#define ORYOL_STRINGATOM_CHUNK_SIZE (1<<14)
+
+// CPU profiler markers (o_prof_scope), on by default in debug builds
+#ifndef ORYOL_PROFILING
+#if ORYOL_DEBUG
+#define ORYOL_PROFILING (1)
+#else
+/// set to (1) to compile in the o_prof_scope() profiler markers
+#define ORYOL_PROFILING (0)
+#endif
+#endif
+/// number of events in each per-thread profiler ring buffer (must be 2^N)
+#define ORYOL_PROFILER_EVENTS_PER_THREAD (1<<14)
+
+/// size of each per-thread async log buffer (bytes, must be 2^N, see Log::StartAsync)
+#define ORYOL_LOG_ASYNC_BUFFER_SIZE (1<<16)
+/// max length of an async log message, longer messages are truncated
+#define ORYOL_LOG_MAX_ASYNC_MESSAGE_LENGTH (4096)
+/// size of each per-thread binary log buffer (bytes, must be 2^N, see BinaryLog)
+#define ORYOL_BINARYLOG_BUFFER_SIZE (1<<16)
+/// max number of binary log call sites
+#define ORYOL_BINARYLOG_MAX_FORMATS (4096)
+/// max length of a string argument in the binary log, longer strings are truncated
+#define ORYOL_BINARYLOG_MAX_STRING_LENGTH (256)
+/// max number of metrics (counters, gauges and histograms, see Metrics)
+#define ORYOL_METRICS_MAX_METRICS (256)
+/// max number of histogram metrics
+#define ORYOL_METRICS_MAX_HISTOGRAMS (64)
+
+// SIMD instruction sets which can be used by Core (higher levels selected at runtime)
+#if (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)) && !ORYOL_EMSCRIPTEN
+/// set to (1) if SSE2 is guaranteed and SSSE3/AVX2 code paths may be compiled
+#define ORYOL_SIMD_SSE (1)
+#else
+#define ORYOL_SIMD_SSE (0)
+#endif
+#if (defined(__aarch64__) || defined(_M_ARM64)) && !ORYOL_EMSCRIPTEN
+/// set to (1) if NEON (AArch64) code paths may be compiled
+#define ORYOL_SIMD_NEON (1)
+#else
+#define ORYOL_SIMD_NEON (0)
+#endif
+
+#if ORYOL_WINDOWS
+#define ORYOL_SIMD_TARGET(isa)
+#else
+/// compile a single function for an instruction set which is not enabled globally
+#define ORYOL_SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
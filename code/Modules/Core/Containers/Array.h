@@ -91,6 +91,8 @@ public:
     void AddBack(const TYPE& elm);
     /// move-add element to back of array
     void AddBack(TYPE&& elm);
+    /// copy-add a range of elements to back of array
+    void AddBack(const TYPE* elms, int32 num);
     /// copy-insert element at index, keep array order
     void Insert(int32 index, const TYPE& elm);
     /// move-insert element at index, keep array order
@@ -303,6 +305,17 @@ Array<TYPE>::AddBack(TYPE&& elm) {
     this->buffer.pushBack(std::move(elm));
 }
 
+//------------------------------------------------------------------------------
+template<class TYPE> void
+Array<TYPE>::AddBack(const TYPE* elms, int32 num) {
+    if (num > 0) {
+        if (this->buffer.backSpare() < num) {
+            this->adjustCapacity(this->buffer.size() + num);
+        }
+        this->buffer.pushBack(elms, num);
+    }
+}
+
 //------------------------------------------------------------------------------
 template<class TYPE> void
 Array<TYPE>::Insert(int32 index, const TYPE& elm) {
@@ -48,6 +48,11 @@ public:
     /// erase element
     void Erase(const VALUETYPE& val);
     
+    /// get number of buckets
+    int32 NumBuckets() const;
+    /// get bucket by index (for statistics and iteration)
+    const Set<VALUETYPE>& Bucket(int32 index) const;
+    
 private:
     /// get the bucket for a value
     const Set<VALUETYPE>& findBucket(const VALUETYPE& val) const;
@@ -170,6 +175,19 @@ HashSet<VALUETYPE, HASHER, NUMBUCKETS>::Erase(const VALUETYPE& val) {
     bucket.Erase(val);
 };
     
+//------------------------------------------------------------------------------
+template<class VALUETYPE, class HASHER, int32 NUMBUCKETS> int32
+HashSet<VALUETYPE, HASHER, NUMBUCKETS>::NumBuckets() const {
+    return NUMBUCKETS;
+}
+
+//------------------------------------------------------------------------------
+template<class VALUETYPE, class HASHER, int32 NUMBUCKETS> const Set<VALUETYPE>&
+HashSet<VALUETYPE, HASHER, NUMBUCKETS>::Bucket(int32 index) const {
+    o_assert_range_dbg(index, NUMBUCKETS);
+    return this->buckets[index];
+}
+
 //------------------------------------------------------------------------------
 template<class VALUETYPE, class HASHER, int32 NUMBUCKETS> const Set<VALUETYPE>&
 HashSet<VALUETYPE, HASHER, NUMBUCKETS>::findBucket(const VALUETYPE& val) const {
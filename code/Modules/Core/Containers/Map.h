@@ -22,7 +22,8 @@
       
     When adding large numbers of elements, consider using the 
     bulk methods, these destroy the sorted order when inserting,
-    and sorting will happen inside EndBulk().
+    and sorting will happen inside EndBulk() (in parallel for
+    large maps, see Parallel::Sort()).
     
     The Map uses a double-ended element buffer internally which
     initially has spare room at the front and end. When inserting elements,
@@ -35,6 +36,7 @@
 #include "Core/Config.h"
 #include "Core/Containers/elementBuffer.h"
 #include "Core/Containers/KeyValuePair.h"
+#include "Core/Threading/Parallel.h"
 
 namespace Oryol {
 namespace Core {
@@ -410,7 +412,7 @@ Map<KEY, VALUE>::InsertBulk(KeyValuePair<KEY, VALUE>&& kvp) {
 //------------------------------------------------------------------------------
 template<class KEY, class VALUE> void
 Map<KEY, VALUE>::InsertBulk(const KEY& key, const VALUE& value) {
-    this->Insert(KeyValuePair<KEY, VALUE>(key, value));
+    this->InsertBulk(KeyValuePair<KEY, VALUE>(key, value));
 }
 
 //------------------------------------------------------------------------------
@@ -418,7 +420,7 @@ template<class KEY, class VALUE> void
 Map<KEY, VALUE>::EndBulk() {
     o_assert(this->inBulkMode);
     this->inBulkMode = false;
-    std::sort(this->buffer.elmStart, this->buffer.elmEnd);
+    Parallel::Sort(this->buffer.elmStart, this->buffer.elmEnd);
 }
 
 //------------------------------------------------------------------------------
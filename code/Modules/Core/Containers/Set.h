@@ -49,6 +49,8 @@ public:
     void Insert(const VALUE& val);
     /// erase element
     void Erase(const VALUE& val);
+    /// clear the set
+    void Clear();
     /// get value at index
     const VALUE& ValueAtIndex(int32 index);
     
@@ -131,6 +133,12 @@ Set<VALUE>::Empty() const {
     return this->valueArray.Empty();
 }
 
+//------------------------------------------------------------------------------
+template<class VALUE> void
+Set<VALUE>::Clear() {
+    this->valueArray.Clear();
+}
+
 //------------------------------------------------------------------------------
 template<class VALUE> int32
 Set<VALUE>::Capacity() const {
@@ -87,6 +87,8 @@ public:
     void pushBack(const TYPE& elm);
     /// move element to back (backSpare must be > 0!)
     void pushBack(TYPE&& elm);
+    /// copy-push a range of elements to back (backSpare must be >= num!)
+    void pushBack(const TYPE* elms, int32 num);
     /// emplace element at back (backSpare must be > 0!)
     template<class... ARGS> void emplaceBack(ARGS&&... args);
     /// pop back element
@@ -398,6 +400,14 @@ elementBuffer<TYPE>::pushBack(TYPE&& elm) {
     new(this->elmEnd++) TYPE(std::move(elm));
 }
 
+//------------------------------------------------------------------------------
+template<class TYPE> void
+elementBuffer<TYPE>::pushBack(const TYPE* elms, int32 num) {
+    o_assert((nullptr != this->elmEnd) && ((this->elmEnd + num) <= this->bufEnd));
+    copyConstruct(elms, this->elmEnd, num);
+    this->elmEnd += num;
+}
+
 //------------------------------------------------------------------------------
 template<class TYPE> template<class... ARGS> void
 elementBuffer<TYPE>::emplaceBack(ARGS&&... args) {
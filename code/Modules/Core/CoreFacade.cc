@@ -12,18 +12,22 @@ OryolGlobalSingletonImpl(CoreFacade);
 ORYOL_THREAD_LOCAL RunLoop* CoreFacade::threadRunLoop = 0;
 
 //------------------------------------------------------------------------------
-CoreFacade::CoreFacade() {
+CoreFacade::CoreFacade() :
+jobSystem(nullptr) {
     this->SingletonEnsureUnique();
     this->mainThreadId = std::this_thread::get_id();
     stringAtomTable::CreateSingleton();    
     threadRunLoop = RunLoop::Create();
     threadRunLoop->addRef();
+    this->jobSystem = new Core::JobSystem(Core::JobSystem::DefaultNumWorkers());
 }
 
 //------------------------------------------------------------------------------
 CoreFacade::~CoreFacade() {
     o_assert(this->isMainThread());
     o_assert(nullptr != threadRunLoop);
+    delete this->jobSystem;
+    this->jobSystem = nullptr;
     threadRunLoop->release();
     threadRunLoop = 0;
 
@@ -38,6 +42,13 @@ CoreFacade::RunLoop() {
     return threadRunLoop;
 }
 
+//------------------------------------------------------------------------------
+JobSystem*
+CoreFacade::JobSystem() {
+    o_assert(nullptr != this->jobSystem);
+    return this->jobSystem;
+}
+
 //------------------------------------------------------------------------------
 bool
 CoreFacade::isMainThread() const {
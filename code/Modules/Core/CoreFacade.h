@@ -9,6 +9,7 @@
 #include "Core/RefCounted.h"
 #include "Core/Macros.h"
 #include "Core/RunLoop.h"
+#include "Core/Threading/JobSystem.h"
 #include <thread>
 
 namespace Oryol {
@@ -24,6 +25,8 @@ public:
     
     /// get pointer to the per-thread runloop
     class RunLoop* RunLoop();
+    /// get pointer to the global job system
+    class JobSystem* JobSystem();
 
     /// called when a thread is entered
     static void EnterThread();
@@ -35,6 +38,7 @@ private:
     bool isMainThread() const;
 
     std::thread::id mainThreadId;
+    class JobSystem* jobSystem;
     static ORYOL_THREAD_LOCAL class RunLoop* threadRunLoop;
 };
 
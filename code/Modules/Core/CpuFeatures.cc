@@ -0,0 +1,103 @@
+//------------------------------------------------------------------------------
+//  CpuFeatures.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "CpuFeatures.h"
+#include "Core/Assert.h"
+#if ORYOL_SIMD_SSE && ORYOL_WINDOWS
+#include <intrin.h>
+#endif
+
+namespace Oryol {
+namespace Core {
+
+#if ORYOL_SIMD_SSE && ORYOL_WINDOWS
+//------------------------------------------------------------------------------
+static bool
+windowsHasFeature(CpuFeatures::Code feature) {
+    int info[4] = { 0 };
+    __cpuid(info, 0);
+    const int maxLevel = info[0];
+    __cpuid(info, 1);
+    const int ecx1 = info[2];
+    const int edx1 = info[3];
+    switch (feature) {
+        case CpuFeatures::SSE2:     return 0 != (edx1 & (1<<26));
+        case CpuFeatures::SSSE3:    return 0 != (ecx1 & (1<<9));
+        case CpuFeatures::SSE41:    return 0 != (ecx1 & (1<<19));
+        case CpuFeatures::AVX2:
+            {
+                // need OS support for saving the YMM registers (OSXSAVE + XCR0)
+                const bool osxsave = 0 != (ecx1 & (1<<27));
+                const bool avx = 0 != (ecx1 & (1<<28));
+                if ((maxLevel < 7) || !osxsave || !avx) {
+                    return false;
+                }
+                if (6 != (_xgetbv(0) & 6)) {
+                    return false;
+                }
+                __cpuidex(info, 7, 0);
+                return 0 != (info[1] & (1<<5));
+            }
+        default: return false;
+    }
+}
+#endif
+
+//------------------------------------------------------------------------------
+static bool
+detectFeature(CpuFeatures::Code feature) {
+    #if ORYOL_SIMD_SSE
+        #if ORYOL_WINDOWS
+        return windowsHasFeature(feature);
+        #else
+        __builtin_cpu_init();
+        switch (feature) {
+            case CpuFeatures::SSE2:     return __builtin_cpu_supports("sse2");
+            case CpuFeatures::SSSE3:    return __builtin_cpu_supports("ssse3");
+            case CpuFeatures::SSE41:    return __builtin_cpu_supports("sse4.1");
+            case CpuFeatures::AVX2:     return __builtin_cpu_supports("avx2");
+            default:                    return false;
+        }
+        #endif
+    #elif ORYOL_SIMD_NEON
+        // NEON is mandatory on AArch64
+        return CpuFeatures::NEON == feature;
+    #else
+        return false;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+bool
+CpuFeatures::Has(Code feature) {
+    o_assert_range(feature, NumFeatures);
+    
+    // detect once, the result never changes while the process is running
+    // (function-local static init is thread-safe)
+    static const struct detector {
+        bool supported[NumFeatures];
+        detector() {
+            for (int32 i = 0; i < NumFeatures; i++) {
+                this->supported[i] = detectFeature((Code) i);
+            }
+        }
+    } features;
+    return features.supported[feature];
+}
+
+//------------------------------------------------------------------------------
+const char*
+CpuFeatures::ToString(Code feature) {
+    switch (feature) {
+        case SSE2:  return "SSE2";
+        case SSSE3: return "SSSE3";
+        case SSE41: return "SSE4.1";
+        case AVX2:  return "AVX2";
+        case NEON:  return "NEON";
+        default:    return "InvalidFeature";
+    }
+}
+
+} // namespace Core
+} // namespace Oryol
@@ -0,0 +1,40 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Core::CpuFeatures
+    @brief query SIMD instruction set support at runtime
+    
+    Code which has SIMD fast paths (for instance the UTF-8 conversion
+    in StringConverter) uses CpuFeatures to pick the best implementation
+    once at runtime, so that the same executable runs on older CPUs.
+    Features which cannot be compiled for the target platform (see 
+    ORYOL_SIMD_SSE and ORYOL_SIMD_NEON in Core/Config.h) are always
+    reported as unsupported.
+*/
+#include "Core/Types.h"
+
+namespace Oryol {
+namespace Core {
+    
+class CpuFeatures {
+public:
+    /// CPU feature codes
+    enum Code {
+        SSE2 = 0,
+        SSSE3,
+        SSE41,
+        AVX2,
+        NEON,
+        
+        NumFeatures,
+        InvalidFeature,
+    };
+    
+    /// test if a feature is supported by the running CPU
+    static bool Has(Code feature);
+    /// convert feature code to string
+    static const char* ToString(Code feature);
+};
+    
+} // namespace Core
+} // namespace Oryol
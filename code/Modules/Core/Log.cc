@@ -8,6 +8,14 @@
 #include "Core/Logger.h"
 #include "Core/Threading/RWLock.h"
 #include "Core/Containers/Array.h"
+#include "Core/Threading/spscRecordQueue.h"
+#include <cstring>
+#include <cstdlib>
+#if ORYOL_HAS_THREADS
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
 
 namespace Oryol {
 namespace Core {
@@ -18,6 +26,54 @@ Log::Level curLogLevel = Log::Level::Dbg;
 RWLock lock;
 Array<Ptr<Logger>> loggers;
 
+#if ORYOL_HAS_THREADS
+namespace {
+    // async message header, followed by the 0-terminated message text
+    struct asyncRecord {
+        int32 level;
+        int32 pad;
+        uint64 seq;
+    };
+    typedef spscRecordQueue<ORYOL_LOG_ASYNC_BUFFER_SIZE> asyncBuffer;
+    static_assert(ORYOL_LOG_MAX_ASYNC_MESSAGE_LENGTH + sizeof(asyncRecord) <= asyncBuffer::MaxRecordSize, "ORYOL_LOG_MAX_ASYNC_MESSAGE_LENGTH too big");
+
+    std::atomic<bool> asyncActive{false};
+    std::atomic<bool> asyncStopRequested{false};
+    std::atomic<uint64> asyncSeq{0};
+    std::atomic<int32> asyncNumDropped{0};
+    int32 asyncNumDroppedReported = 0;
+    std::thread asyncThread;
+    std::mutex asyncWakeupLock;
+    std::condition_variable asyncWakeup;
+    bool asyncExitHandlerRegistered = false;
+
+    // per-thread buffers, created on first use and never freed
+    std::mutex asyncRegistryLock;
+    Array<asyncBuffer*> asyncBuffers;
+    ORYOL_THREAD_LOCAL asyncBuffer* threadAsyncBuffer = nullptr;
+    ORYOL_THREAD_LOCAL bool isAsyncThread = false;
+
+    asyncBuffer* getAsyncBuffer() {
+        if (nullptr == threadAsyncBuffer) {
+            asyncBuffer* buf = new asyncBuffer;
+            std::lock_guard<std::mutex> lockGuard(asyncRegistryLock);
+            asyncBuffers.AddBack(buf);
+            threadAsyncBuffer = buf;
+        }
+        return threadAsyncBuffer;
+    }
+
+    void wakeupAsyncThread() {
+        std::lock_guard<std::mutex> lockGuard(asyncWakeupLock);
+        asyncWakeup.notify_one();
+    }
+
+    void asyncExitHandler() {
+        Log::StopAsync();
+    }
+}
+#endif
+
 //------------------------------------------------------------------------------
 void
 Log::AddLogger(const Ptr<Logger>& l) {
@@ -28,6 +84,20 @@ Log::AddLogger(const Ptr<Logger>& l) {
     }
 }
 
+//------------------------------------------------------------------------------
+void
+Log::RemoveLogger(const Ptr<Logger>& l) {
+    Flush();
+    lock.LockWrite();
+    for (int32 i = 0; i < loggers.Size(); i++) {
+        if (loggers[i] == l) {
+            loggers.Erase(i);
+            break;
+        }
+    }
+    lock.UnlockWrite();
+}
+
 //------------------------------------------------------------------------------
 int32
 Log::GetNumLoggers() {
@@ -99,21 +169,234 @@ Log::Error(const char* msg, ...) {
 //------------------------------------------------------------------------------
 void
 Log::vprint(Level lvl, const char* msg, va_list args) {
+    #if ORYOL_HAS_THREADS
+    if (asyncActive.load(std::memory_order_acquire)) {
+        Log::push(lvl, msg, args);
+        if (Level::Error == lvl) {
+            // an error may be followed by an abort (o_error)
+            Log::Flush();
+        }
+        return;
+    }
+    #endif
     lock.LockRead();
     if (loggers.Empty()) {
         std::vprintf(msg, args);
     }
     else {
         for (auto l : loggers) {
-            l->VPrint(lvl, msg, args);
+            // each logger needs its own copy of the argument list
+            va_list argsCopy;
+            va_copy(argsCopy, args);
+            l->VPrint(lvl, msg, argsCopy);
+            va_end(argsCopy);
         }
     }
     lock.UnlockRead();
 }
 
+//------------------------------------------------------------------------------
+static void
+printToLogger(Logger* l, Log::Level lvl, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    l->VPrint(lvl, fmt, args);
+    va_end(args);
+}
+
+//------------------------------------------------------------------------------
+void
+Log::dispatch(Level lvl, const char* text) {
+    lock.LockRead();
+    if (loggers.Empty()) {
+        std::fputs(text, stdout);
+    }
+    else {
+        for (const auto& l : loggers) {
+            printToLogger(l.getUnsafe(), lvl, "%s", text);
+        }
+    }
+    lock.UnlockRead();
+}
+
+//------------------------------------------------------------------------------
+void
+Log::push(Level lvl, const char* msg, va_list args) {
+    #if ORYOL_HAS_THREADS
+    char text[ORYOL_LOG_MAX_ASYNC_MESSAGE_LENGTH];
+    int32 len = std::vsnprintf(text, sizeof(text), msg, args);
+    if (len < 0) {
+        return;
+    }
+    if (len >= int32(sizeof(text))) {
+        len = sizeof(text) - 1;
+    }
+    asyncBuffer* buf = getAsyncBuffer();
+    asyncRecord* rec;
+    while (nullptr == (rec = (asyncRecord*) buf->BeginPush(sizeof(asyncRecord) + len + 1))) {
+        // buffer is full: drop debug and info messages, wait with warnings and errors
+        if ((lvl >= Level::Info) || isAsyncThread) {
+            asyncNumDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        wakeupAsyncThread();
+        std::this_thread::yield();
+    }
+    rec->level = int32(lvl);
+    rec->pad = 0;
+    rec->seq = asyncSeq.fetch_add(1, std::memory_order_relaxed);
+    std::memcpy(rec + 1, text, len);
+    ((char*)(rec + 1))[len] = 0;
+    buf->EndPush();
+    #endif
+}
+
+//------------------------------------------------------------------------------
+bool
+Log::dispatchPending() {
+    #if ORYOL_HAS_THREADS
+    Array<asyncBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lockGuard(asyncRegistryLock);
+        buffers = asyncBuffers;
+    }
+    bool dispatched = false;
+    for (;;) {
+        // dispatch the oldest message of all thread buffers
+        asyncBuffer* oldestBuf = nullptr;
+        const asyncRecord* oldestRec = nullptr;
+        for (asyncBuffer* buf : buffers) {
+            uint32 size = 0;
+            const asyncRecord* rec = (const asyncRecord*) buf->Front(size);
+            if ((nullptr != rec) && ((nullptr == oldestRec) || (rec->seq < oldestRec->seq))) {
+                oldestBuf = buf;
+                oldestRec = rec;
+            }
+        }
+        if (nullptr == oldestRec) {
+            break;
+        }
+        Log::dispatch(Level(oldestRec->level), (const char*)(oldestRec + 1));
+        oldestBuf->Pop();
+        dispatched = true;
+    }
+    const int32 numDropped = asyncNumDropped.load(std::memory_order_relaxed);
+    if (numDropped != asyncNumDroppedReported) {
+        char text[64];
+        std::snprintf(text, sizeof(text), "Log: %d messages dropped!\n", numDropped - asyncNumDroppedReported);
+        asyncNumDroppedReported = numDropped;
+        Log::dispatch(Level::Warn, text);
+    }
+    return dispatched;
+    #else
+    return false;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+Log::asyncThreadFunc() {
+    #if ORYOL_HAS_THREADS
+    isAsyncThread = true;
+    for (;;) {
+        if (!Log::dispatchPending()) {
+            if (asyncStopRequested.load(std::memory_order_acquire)) {
+                break;
+            }
+            std::unique_lock<std::mutex> lockGuard(asyncWakeupLock);
+            asyncWakeup.wait_for(lockGuard, std::chrono::milliseconds(5));
+        }
+    }
+    isAsyncThread = false;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+Log::StartAsync() {
+    #if ORYOL_HAS_THREADS
+    if (!asyncActive) {
+        asyncStopRequested = false;
+        asyncThread = std::thread(&Log::asyncThreadFunc);
+        asyncActive.store(true, std::memory_order_release);
+        if (!asyncExitHandlerRegistered) {
+            asyncExitHandlerRegistered = true;
+            std::atexit(asyncExitHandler);
+        }
+    }
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+Log::StopAsync() {
+    #if ORYOL_HAS_THREADS
+    if (asyncActive) {
+        asyncActive.store(false, std::memory_order_release);
+        asyncStopRequested = true;
+        wakeupAsyncThread();
+        asyncThread.join();
+        // catch messages which were pushed while stopping
+        Log::dispatchPending();
+    }
+    #endif
+}
+
+//------------------------------------------------------------------------------
+bool
+Log::IsAsync() {
+    #if ORYOL_HAS_THREADS
+    return asyncActive.load(std::memory_order_relaxed);
+    #else
+    return false;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+Log::Flush() {
+    #if ORYOL_HAS_THREADS
+    if (!asyncActive.load(std::memory_order_acquire) || isAsyncThread) {
+        return;
+    }
+    // wait until the dispatch thread has consumed everything
+    // which has been pushed until now
+    Array<asyncBuffer*> buffers;
+    Array<uint64> tails;
+    {
+        std::lock_guard<std::mutex> lockGuard(asyncRegistryLock);
+        buffers = asyncBuffers;
+    }
+    for (asyncBuffer* buf : buffers) {
+        tails.AddBack(buf->PushPosition());
+    }
+    wakeupAsyncThread();
+    for (int32 i = 0; i < buffers.Size(); i++) {
+        while (buffers[i]->PopPosition() < tails[i]) {
+            if (!asyncActive.load(std::memory_order_acquire)) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+    #endif
+}
+
+//------------------------------------------------------------------------------
+int32
+Log::GetNumDropped() {
+    #if ORYOL_HAS_THREADS
+    return asyncNumDropped.load(std::memory_order_relaxed);
+    #else
+    return 0;
+    #endif
+}
+
 //------------------------------------------------------------------------------
 void
 Log::AssertMsg(const char* cond, const char* msg, const char* file, int32 line, const char* func) {
+    // make sure that all messages before the assert are visible
+    Log::Flush();
     lock.LockRead();
     if (loggers.Empty()) {
         std::printf("oryol assert: cond='%s'\nmsg='%s'\nfile='%s'\nline='%d'\nfunc='%s'\n",
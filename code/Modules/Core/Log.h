@@ -8,6 +8,15 @@
     output is logged to stdout and stderr, but custom Logger objects
     can be attached to handle log output differently.
 
+    After StartAsync(), messages are formatted on the calling thread and
+    pushed into a lock-free per-thread ring buffer, a background thread
+    dispatches them to the loggers in order. When a thread's buffer is
+    full, debug and info messages are dropped (see GetNumDropped()),
+    warnings and errors wait for free space. Errors and asserts flush
+    all pending messages before they return, and pending messages are
+    flushed at exit. Async messages are truncated to
+    ORYOL_LOG_MAX_ASYNC_MESSAGE_LENGTH bytes.
+
     @see Logger
 */
 #include <cstdarg>
@@ -35,6 +44,8 @@ public:
 
     /// add a logger object
     static void AddLogger(const Ptr<Logger>& p);
+    /// remove a logger object
+    static void RemoveLogger(const Ptr<Logger>& p);
     /// get number of loggers
     static int32 GetNumLoggers();
     /// get logger at index
@@ -55,9 +66,28 @@ public:
     /// print an assert message
     static void AssertMsg(const char* cond, const char* msg, const char* file, int32 line, const char* func);
 
+    /// switch to asynchronous logging through a background thread
+    static void StartAsync();
+    /// switch back to synchronous logging, dispatches pending messages (call while no other thread logs)
+    static void StopAsync();
+    /// return true if asynchronous logging is active
+    static bool IsAsync();
+    /// wait until all pending asynchronous messages have been dispatched
+    static void Flush();
+    /// get number of messages dropped because a thread's buffer was full
+    static int32 GetNumDropped();
+
 private:
     /// generic vprint-style method
     static void vprint(Level l, const char* msg, va_list args);
+    /// dispatch a formatted message to the loggers
+    static void dispatch(Level l, const char* text);
+    /// push a message to the calling thread's async buffer
+    static void push(Level l, const char* msg, va_list args);
+    /// dispatch pending async messages, return false if there were none
+    static bool dispatchPending();
+    /// the async dispatch thread function
+    static void asyncThreadFunc();
 };
 } // namespace Core
 } // namespace Oryol
\ No newline at end of file
@@ -4,16 +4,22 @@
 #include <memory>
 #include <cstdlib>
 #include <cstring>
+#include <atomic>
 #include "Memory.h"
 
 namespace Oryol {
 namespace Core {
+
+#if ORYOL_ALLOCATOR_DEBUG || ORYOL_UNITTESTS
+static std::atomic<int64> numAllocs(0);
+#endif
     
 //------------------------------------------------------------------------------
 void*
 Memory::Alloc(int32 numBytes) {
     void* ptr = std::malloc(numBytes);
 #if ORYOL_ALLOCATOR_DEBUG || ORYOL_UNITTESTS
+    numAllocs.fetch_add(1, std::memory_order_relaxed);
     Memory::Fill(ptr, numBytes, ORYOL_MEMORY_DEBUG_BYTE);
 #endif
     return ptr;
@@ -29,9 +35,22 @@ Memory::Fill(void* ptr, int32 numBytes, uint8 value) {
 void*
 Memory::ReAlloc(void* ptr, int32 s) {
     /// @todo: HMM need to fix fill with debug pattern...
+#if ORYOL_ALLOCATOR_DEBUG || ORYOL_UNITTESTS
+    numAllocs.fetch_add(1, std::memory_order_relaxed);
+#endif
     return std::realloc(ptr, s);
 }
 
+//------------------------------------------------------------------------------
+int64
+Memory::NumAllocs() {
+#if ORYOL_ALLOCATOR_DEBUG || ORYOL_UNITTESTS
+    return numAllocs.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
 //------------------------------------------------------------------------------
 void
 Memory::Free(void* p) {
@@ -37,6 +37,8 @@ public:
     static void* Align(void* ptr, int32 byteSize);
     /// round-up a value to the next multiple of byteSize
     static int32 RoundUp(int32 val, int32 byteSize);
+    /// number of Alloc()/ReAlloc() calls (only counted with ORYOL_ALLOCATOR_DEBUG or ORYOL_UNITTESTS, otherwise 0)
+    static int64 NumAllocs();
 };
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,430 @@
+//------------------------------------------------------------------------------
+//  Metrics.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "Metrics.h"
+#include "Core/MetricsExporter.h"
+#include "Core/CoreFacade.h"
+#include "Core/String/StringBuilder.h"
+#include <atomic>
+#include <mutex>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+namespace Oryol {
+namespace Core {
+
+namespace {
+    const int32 MaxMetrics = ORYOL_METRICS_MAX_METRICS;
+    const int32 MaxHistograms = ORYOL_METRICS_MAX_HISTOGRAMS;
+    const int32 NumBuckets = Metrics::NumHistogramBuckets;
+    const int32 SubBucketBits = 4;
+    const int32 NumSubBuckets = 1 << SubBucketBits;
+
+    // the histogram of one thread, only written by the owner thread
+    struct mtrHistogram {
+        std::atomic<int64> count{0};
+        std::atomic<int64> sum{0};
+        std::atomic<int64> min{INT64_MAX};
+        std::atomic<int64> max{0};
+        std::atomic<int64> buckets[NumBuckets];
+
+        mtrHistogram() {
+            for (auto& b : this->buckets) {
+                b.store(0, std::memory_order_relaxed);
+            }
+        };
+    };
+
+    // per-thread metric values, only the owner thread writes,
+    // histograms are created on first use and published with release semantics
+    struct mtrThreadBuffer {
+        std::atomic<int64> values[MaxMetrics];
+        std::atomic<mtrHistogram*> histograms[MaxHistograms];
+
+        mtrThreadBuffer() {
+            for (auto& v : this->values) {
+                v.store(0, std::memory_order_relaxed);
+            }
+            for (auto& h : this->histograms) {
+                h.store(nullptr, std::memory_order_relaxed);
+            }
+        };
+    };
+
+    // a registered metric
+    struct mtrInfo {
+        char name[64];
+        Metrics::Type type;
+        int32 histIndex;
+    };
+
+    // registered metrics, an entry is complete before numMetrics is
+    // incremented (with release semantics), entries are never removed
+    mtrInfo metricInfos[MaxMetrics];
+    std::atomic<int32> numMetrics{0};
+    int32 numHistograms = 0;
+
+    // counter values and time of the previous Collect() for rates
+    int64 prevValues[MaxMetrics] = { };
+    Clock::Ticks prevCollectTime = 0;
+
+    // periodic export
+    RunLoop* exportRunLoop = nullptr;
+    TimerWheel::Id exportTimer = TimerWheel::InvalidId;
+
+    ORYOL_THREAD_LOCAL mtrThreadBuffer* threadBuffer = nullptr;
+
+    // all thread buffers, never freed, the lock also protects
+    // registration, the exporters and the rate computation
+    std::mutex& registryLock() {
+        static std::mutex lock;
+        return lock;
+    }
+    Array<mtrThreadBuffer*>& registry() {
+        static Array<mtrThreadBuffer*> buffers;
+        return buffers;
+    }
+    Array<Ptr<MetricsExporter>>& exporters() {
+        static Array<Ptr<MetricsExporter>> exp;
+        return exp;
+    }
+
+    mtrThreadBuffer* getThreadBuffer() {
+        if (nullptr == threadBuffer) {
+            mtrThreadBuffer* buf = new mtrThreadBuffer;
+            std::lock_guard<std::mutex> lock(registryLock());
+            registry().AddBack(buf);
+            threadBuffer = buf;
+        }
+        return threadBuffer;
+    }
+
+    // single-writer update, no read-modify-write needed
+    inline void addRelaxed(std::atomic<int64>& val, int64 n) {
+        val.store(val.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    // sum a counter or gauge over all threads, registry lock must be held
+    int64 sumValues(Metrics::Id id) {
+        int64 sum = 0;
+        for (const mtrThreadBuffer* buf : registry()) {
+            sum += buf->values[id].load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+    // find the value at a percentile in merged buckets
+    int64 percentile(const int64* buckets, int64 count, int64 min, int64 max, float64 p) {
+        int64 rank = int64(p * float64(count) + 0.5);
+        if (rank < 1) {
+            rank = 1;
+        }
+        int64 acc = 0;
+        for (int32 i = 0; i < NumBuckets; i++) {
+            acc += buckets[i];
+            if (acc >= rank) {
+                int64 val = Metrics::HistogramBucketMax(i);
+                return val < min ? min : (val > max ? max : val);
+            }
+        }
+        return max;
+    }
+}
+
+//------------------------------------------------------------------------------
+int32
+Metrics::HistogramBucket(int64 val) {
+    if (val < NumSubBuckets) {
+        return val < 0 ? 0 : int32(val);
+    }
+    #if defined(__GNUC__)
+    const int32 msb = 63 - __builtin_clzll(uint64(val));
+    #else
+    int32 msb = 63;
+    while (0 == (uint64(val) & (uint64(1) << msb))) {
+        msb--;
+    }
+    #endif
+    const int32 shift = msb - SubBucketBits;
+    return (msb - SubBucketBits + 1) * NumSubBuckets + int32((val >> shift) - NumSubBuckets);
+}
+
+//------------------------------------------------------------------------------
+int64
+Metrics::HistogramBucketMin(int32 bucket) {
+    o_assert_range_dbg(bucket, NumBuckets);
+    if (bucket < NumSubBuckets) {
+        return bucket;
+    }
+    const int32 shift = (bucket / NumSubBuckets) - 1;
+    return int64(NumSubBuckets + (bucket % NumSubBuckets)) << shift;
+}
+
+//------------------------------------------------------------------------------
+int64
+Metrics::HistogramBucketMax(int32 bucket) {
+    o_assert_range_dbg(bucket, NumBuckets);
+    if (bucket == (NumBuckets - 1)) {
+        return INT64_MAX;
+    }
+    return HistogramBucketMin(bucket + 1) - 1;
+}
+
+//------------------------------------------------------------------------------
+Metrics::Id
+Metrics::registerMetric(const char* name, Type type) {
+    o_assert(nullptr != name);
+    o_assert2(std::strlen(name) < sizeof(metricInfos[0].name), "Metrics: name too long\n");
+    std::lock_guard<std::mutex> lock(registryLock());
+    const int32 num = numMetrics.load(std::memory_order_relaxed);
+    for (int32 i = 0; i < num; i++) {
+        if (0 == std::strcmp(metricInfos[i].name, name)) {
+            o_assert2(metricInfos[i].type == type, "Metrics: name registered with different type\n");
+            return i;
+        }
+    }
+    o_assert2(num < MaxMetrics, "Metrics: too many metrics (ORYOL_METRICS_MAX_METRICS)\n");
+    mtrInfo& info = metricInfos[num];
+    std::strcpy(info.name, name);
+    info.type = type;
+    info.histIndex = InvalidIndex;
+    if (Type::Histogram == type) {
+        o_assert2(numHistograms < MaxHistograms, "Metrics: too many histograms (ORYOL_METRICS_MAX_HISTOGRAMS)\n");
+        info.histIndex = numHistograms++;
+    }
+    numMetrics.store(num + 1, std::memory_order_release);
+    return num;
+}
+
+//------------------------------------------------------------------------------
+Metrics::Id
+Metrics::RegisterCounter(const char* name) {
+    return registerMetric(name, Type::Counter);
+}
+
+//------------------------------------------------------------------------------
+Metrics::Id
+Metrics::RegisterGauge(const char* name) {
+    return registerMetric(name, Type::Gauge);
+}
+
+//------------------------------------------------------------------------------
+Metrics::Id
+Metrics::RegisterHistogram(const char* name) {
+    return registerMetric(name, Type::Histogram);
+}
+
+//------------------------------------------------------------------------------
+Metrics::Id
+Metrics::Find(const char* name) {
+    o_assert(nullptr != name);
+    const int32 num = numMetrics.load(std::memory_order_acquire);
+    for (int32 i = 0; i < num; i++) {
+        if (0 == std::strcmp(metricInfos[i].name, name)) {
+            return i;
+        }
+    }
+    return InvalidIndex;
+}
+
+//------------------------------------------------------------------------------
+void
+Metrics::Add(Id id, int64 val) {
+    o_assert_dbg((id >= 0) && (id < numMetrics.load(std::memory_order_acquire)));
+    o_assert_dbg(Type::Histogram != metricInfos[id].type);
+    addRelaxed(getThreadBuffer()->values[id], val);
+}
+
+//------------------------------------------------------------------------------
+void
+Metrics::Set(Id id, int64 val) {
+    o_assert_dbg((id >= 0) && (id < numMetrics.load(std::memory_order_acquire)));
+    o_assert_dbg(Type::Gauge == metricInfos[id].type);
+    getThreadBuffer()->values[id].store(val, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+void
+Metrics::Record(Id id, int64 val) {
+    o_assert_dbg((id >= 0) && (id < numMetrics.load(std::memory_order_acquire)));
+    o_assert_dbg(Type::Histogram == metricInfos[id].type);
+    if (val < 0) {
+        val = 0;
+    }
+    mtrThreadBuffer* buf = getThreadBuffer();
+    const int32 histIndex = metricInfos[id].histIndex;
+    mtrHistogram* hist = buf->histograms[histIndex].load(std::memory_order_relaxed);
+    if (nullptr == hist) {
+        hist = new mtrHistogram;
+        buf->histograms[histIndex].store(hist, std::memory_order_release);
+    }
+    addRelaxed(hist->buckets[HistogramBucket(val)], 1);
+    addRelaxed(hist->count, 1);
+    addRelaxed(hist->sum, val);
+    if (val < hist->min.load(std::memory_order_relaxed)) {
+        hist->min.store(val, std::memory_order_relaxed);
+    }
+    if (val > hist->max.load(std::memory_order_relaxed)) {
+        hist->max.store(val, std::memory_order_relaxed);
+    }
+}
+
+//------------------------------------------------------------------------------
+int64
+Metrics::Value(Id id) {
+    o_assert((id >= 0) && (id < numMetrics.load(std::memory_order_acquire)));
+    o_assert(Type::Histogram != metricInfos[id].type);
+    std::lock_guard<std::mutex> lock(registryLock());
+    return sumValues(id);
+}
+
+//------------------------------------------------------------------------------
+Array<Metrics::Sample>
+Metrics::Collect() {
+    std::lock_guard<std::mutex> lock(registryLock());
+    const Clock::Ticks now = Clock::Now();
+    const float64 dt = prevCollectTime > 0 ? Clock::ToSeconds(now - prevCollectTime) : 0.0;
+    prevCollectTime = now;
+
+    const int32 num = numMetrics.load(std::memory_order_relaxed);
+    Array<Sample> samples;
+    samples.Reserve(num);
+    int64 buckets[NumBuckets];
+    for (Id id = 0; id < num; id++) {
+        const mtrInfo& info = metricInfos[id];
+        Sample sample;
+        sample.Name = info.name;
+        sample.Type = info.type;
+        if (Type::Histogram != info.type) {
+            sample.Value = sumValues(id);
+            if (Type::Counter == info.type) {
+                if (dt > 0.0) {
+                    sample.Rate = float64(sample.Value - prevValues[id]) / dt;
+                }
+                prevValues[id] = sample.Value;
+            }
+        }
+        else {
+            // merge the buckets of all threads
+            std::memset(buckets, 0, sizeof(buckets));
+            int64 min = INT64_MAX;
+            for (const mtrThreadBuffer* buf : registry()) {
+                const mtrHistogram* hist = buf->histograms[info.histIndex].load(std::memory_order_acquire);
+                if (nullptr != hist) {
+                    for (int32 i = 0; i < NumBuckets; i++) {
+                        buckets[i] += hist->buckets[i].load(std::memory_order_relaxed);
+                    }
+                    sample.Value += hist->count.load(std::memory_order_relaxed);
+                    sample.Sum += hist->sum.load(std::memory_order_relaxed);
+                    const int64 hmin = hist->min.load(std::memory_order_relaxed);
+                    const int64 hmax = hist->max.load(std::memory_order_relaxed);
+                    min = hmin < min ? hmin : min;
+                    sample.Max = hmax > sample.Max ? hmax : sample.Max;
+                }
+            }
+            if (sample.Value > 0) {
+                // bucket counts and count are read at slightly different
+                // times while other threads record, so use the bucket sum
+                int64 count = 0;
+                for (int32 i = 0; i < NumBuckets; i++) {
+                    count += buckets[i];
+                }
+                sample.Min = min;
+                sample.P50 = percentile(buckets, count, min, sample.Max, 0.5);
+                sample.P90 = percentile(buckets, count, min, sample.Max, 0.9);
+                sample.P99 = percentile(buckets, count, min, sample.Max, 0.99);
+                sample.P999 = percentile(buckets, count, min, sample.Max, 0.999);
+            }
+        }
+        samples.AddBack(sample);
+    }
+    return samples;
+}
+
+//------------------------------------------------------------------------------
+String
+Metrics::Format(const Array<Sample>& samples) {
+    StringBuilder builder;
+    char line[512];
+    for (const Sample& s : samples) {
+        switch (s.Type) {
+            case Type::Counter:
+                std::snprintf(line, sizeof(line), "counter %s %" PRId64 " rate=%.3f\n",
+                    s.Name.AsCStr(), s.Value, s.Rate);
+                break;
+            case Type::Gauge:
+                std::snprintf(line, sizeof(line), "gauge %s %" PRId64 "\n",
+                    s.Name.AsCStr(), s.Value);
+                break;
+            case Type::Histogram:
+                std::snprintf(line, sizeof(line),
+                    "histogram %s count=%" PRId64 " sum=%" PRId64 " min=%" PRId64 " p50=%" PRId64
+                    " p90=%" PRId64 " p99=%" PRId64 " p999=%" PRId64 " max=%" PRId64 "\n",
+                    s.Name.AsCStr(), s.Value, s.Sum, s.Min, s.P50, s.P90, s.P99, s.P999, s.Max);
+                break;
+        }
+        builder.Append(line);
+    }
+    return builder.GetString();
+}
+
+//------------------------------------------------------------------------------
+void
+Metrics::AddExporter(const Ptr<MetricsExporter>& exporter) {
+    o_assert(exporter.isValid());
+    std::lock_guard<std::mutex> lock(registryLock());
+    o_assert(InvalidIndex == exporters().FindIndexLinear(exporter));
+    exporters().AddBack(exporter);
+}
+
+//------------------------------------------------------------------------------
+void
+Metrics::RemoveExporter(const Ptr<MetricsExporter>& exporter) {
+    std::lock_guard<std::mutex> lock(registryLock());
+    const int32 index = exporters().FindIndexLinear(exporter);
+    if (InvalidIndex != index) {
+        exporters().Erase(index);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+Metrics::Export() {
+    Array<Ptr<MetricsExporter>> exp;
+    {
+        std::lock_guard<std::mutex> lock(registryLock());
+        exp = exporters();
+    }
+    if (!exp.Empty()) {
+        const Array<Sample> samples = Collect();
+        for (const auto& e : exp) {
+            e->Export(samples);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+Metrics::StartExport(Clock::Ticks interval) {
+    o_assert(interval > 0);
+    o_assert(nullptr == exportRunLoop);
+    exportRunLoop = CoreFacade::Instance()->RunLoop();
+    exportTimer = exportRunLoop->Timers().Add(interval, []() {
+        Export();
+    }, interval);
+}
+
+//------------------------------------------------------------------------------
+void
+Metrics::StopExport() {
+    if (nullptr != exportRunLoop) {
+        exportRunLoop->Timers().Remove(exportTimer);
+        exportRunLoop = nullptr;
+        exportTimer = TimerWheel::InvalidId;
+    }
+}
+
+} // namespace Core
+} // namespace Oryol
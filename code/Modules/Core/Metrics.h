@@ -0,0 +1,132 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Core::Metrics
+    @brief runtime counters, gauges and latency histograms
+
+    Register a metric once by name and keep the returned Id (metrics
+    can't be unregistered, registering an existing name returns the
+    existing Id):
+
+        static const Metrics::Id numMsgs = Metrics::RegisterCounter("messaging.messages");
+        Metrics::Add(numMsgs);
+
+    There are 3 types of metrics:
+
+    - counters only go up (messages handled, bytes loaded), the
+      exported value is the total and the rate per second since the
+      last Collect()
+    - gauges go up and down (queue depth, pool occupancy), the value
+      is the sum of the contributions of all threads: Add() changes
+      the calling thread's contribution, so a gauge can be incremented
+      on one thread and decremented on another, Set() replaces it, so
+      a gauge which is Set() should only be written by one thread
+    - histograms record values (usually latencies in nanoseconds)
+      into log-linear buckets with a relative error of at most 1/16,
+      and export count, sum, min, max and percentiles
+
+    Writing a metric never takes a lock and never writes to memory
+    which is shared with other threads: each thread has its own
+    counters and histogram buckets, which are only updated by the
+    owner thread (relaxed atomic stores), Collect() sums them up.
+    Per-thread data is never freed, so the contributions of finished
+    threads are kept.
+
+    Exporters (see MetricsExporter) receive the collected samples when
+    Export() is called, StartExport() calls Export() periodically from
+    the calling thread's RunLoop. Format() converts samples into a
+    simple line-based text format, one metric per line:
+
+        counter messaging.messages 1024 rate=51.2
+        gauge messaging.queue_depth 3
+        histogram io.request_ns count=64 sum=... min=... p50=... p90=... p99=... p999=... max=...
+*/
+#include "Core/Types.h"
+#include "Core/Ptr.h"
+#include "Core/String/String.h"
+#include "Core/Containers/Array.h"
+#include "Core/Time/Clock.h"
+
+namespace Oryol {
+namespace Core {
+
+class MetricsExporter;
+
+class Metrics {
+public:
+    /// a metric id
+    typedef int32 Id;
+    /// metric types
+    enum class Type {
+        Counter,
+        Gauge,
+        Histogram,
+    };
+    /// a metric value collected from all threads
+    struct Sample {
+        String Name;
+        Metrics::Type Type = Metrics::Type::Counter;
+        /// counter total, gauge value or histogram count
+        int64 Value = 0;
+        /// counters: increase per second since the previous Collect()
+        float64 Rate = 0.0;
+        /// histogram statistics
+        int64 Sum = 0;
+        int64 Min = 0;
+        int64 Max = 0;
+        int64 P50 = 0;
+        int64 P90 = 0;
+        int64 P99 = 0;
+        int64 P999 = 0;
+    };
+
+    /// register a counter, returns existing id if name exists
+    static Id RegisterCounter(const char* name);
+    /// register a gauge, returns existing id if name exists
+    static Id RegisterGauge(const char* name);
+    /// register a histogram, returns existing id if name exists
+    static Id RegisterHistogram(const char* name);
+    /// find a metric by name, returns InvalidIndex if not registered
+    static Id Find(const char* name);
+
+    /// add to a counter or the calling thread's contribution to a gauge
+    static void Add(Id id, int64 val = 1);
+    /// set the calling thread's contribution to a gauge
+    static void Set(Id id, int64 val);
+    /// record a histogram value
+    static void Record(Id id, int64 val);
+
+    /// get the current value of a counter or gauge (summed over all threads)
+    static int64 Value(Id id);
+    /// collect all metrics from all threads
+    static Array<Sample> Collect();
+    /// convert samples to the text format
+    static String Format(const Array<Sample>& samples);
+
+    /// add an exporter
+    static void AddExporter(const Ptr<MetricsExporter>& exporter);
+    /// remove an exporter
+    static void RemoveExporter(const Ptr<MetricsExporter>& exporter);
+    /// collect metrics and pass them to the exporters
+    static void Export();
+    /// call Export() periodically from the calling thread's RunLoop
+    static void StartExport(Clock::Ticks interval);
+    /// stop periodic exports
+    static void StopExport();
+
+    /// number of histogram buckets
+    static const int32 NumHistogramBuckets = 960;
+    /// get the histogram bucket of a value
+    static int32 HistogramBucket(int64 val);
+    /// get the smallest value of a histogram bucket
+    static int64 HistogramBucketMin(int32 bucket);
+    /// get the largest value of a histogram bucket
+    static int64 HistogramBucketMax(int32 bucket);
+
+private:
+    /// register a metric
+    static Id registerMetric(const char* name, Type type);
+};
+
+} // namespace Core
+} // namespace Oryol
@@ -0,0 +1,60 @@
+//------------------------------------------------------------------------------
+//  MetricsExporter.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "MetricsExporter.h"
+#include "Core/Log.h"
+#include "Core/Time/Clock.h"
+#include <cinttypes>
+#include <cstdio>
+
+namespace Oryol {
+namespace Core {
+
+OryolClassImpl(MetricsExporter);
+OryolClassImpl(LogMetricsExporter);
+OryolClassImpl(FileMetricsExporter);
+
+//------------------------------------------------------------------------------
+MetricsExporter::MetricsExporter() {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+MetricsExporter::~MetricsExporter() {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+void
+MetricsExporter::Export(const Array<Metrics::Sample>& /*samples*/) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+void
+LogMetricsExporter::Export(const Array<Metrics::Sample>& samples) {
+    Log::Info("%s", Metrics::Format(samples).AsCStr());
+}
+
+//------------------------------------------------------------------------------
+FileMetricsExporter::FileMetricsExporter(const String& path_) :
+path(path_) {
+    o_assert(path_.IsValid());
+}
+
+//------------------------------------------------------------------------------
+void
+FileMetricsExporter::Export(const Array<Metrics::Sample>& samples) {
+    FILE* fp = std::fopen(this->path.AsCStr(), "a");
+    if (nullptr == fp) {
+        Log::Warn("FileMetricsExporter: failed to open '%s'\n", this->path.AsCStr());
+        return;
+    }
+    const String text = Metrics::Format(samples);
+    std::fprintf(fp, "# time=%" PRId64 "\n%s", int64(Clock::Now()), text.AsCStr());
+    std::fclose(fp);
+}
+
+} // namespace Core
+} // namespace Oryol
@@ -0,0 +1,57 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Core::MetricsExporter
+    @brief base class for metrics exporters
+
+    Derive from this class and override Export() to send metrics to a
+    custom destination, and register the exporter with
+    Metrics::AddExporter(). Export() is called from the thread which
+    calls Metrics::Export().
+
+    LogMetricsExporter writes the metrics in the text format of
+    Metrics::Format() to the log, FileMetricsExporter appends them to
+    a local file, with a time stamp line before each export.
+
+    @see Metrics
+*/
+#include "Core/Types.h"
+#include "Core/RefCounted.h"
+#include "Core/Metrics.h"
+
+namespace Oryol {
+namespace Core {
+
+class MetricsExporter : public RefCounted {
+    OryolClassDecl(MetricsExporter);
+public:
+    /// constructor
+    MetricsExporter();
+    /// destructor
+    virtual ~MetricsExporter();
+    /// export collected metrics
+    virtual void Export(const Array<Metrics::Sample>& samples);
+};
+
+//------------------------------------------------------------------------------
+class LogMetricsExporter : public MetricsExporter {
+    OryolClassDecl(LogMetricsExporter);
+public:
+    /// write metrics to the log
+    virtual void Export(const Array<Metrics::Sample>& samples) override;
+};
+
+//------------------------------------------------------------------------------
+class FileMetricsExporter : public MetricsExporter {
+    OryolClassDecl(FileMetricsExporter);
+public:
+    /// constructor with path of a local file
+    FileMetricsExporter(const String& path);
+    /// append metrics to the file
+    virtual void Export(const Array<Metrics::Sample>& samples) override;
+private:
+    String path;
+};
+
+} // namespace Core
+} // namespace Oryol
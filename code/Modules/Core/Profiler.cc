@@ -0,0 +1,238 @@
+//------------------------------------------------------------------------------
+//  Profiler.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "Profiler.h"
+#include "Core/Containers/Array.h"
+#include "Core/String/StringBuilder.h"
+#include "Core/Time/Clock.h"
+#include <atomic>
+#include <mutex>
+#include <cstdio>
+#include <cstring>
+
+namespace Oryol {
+namespace Core {
+
+namespace {
+    // a finished scope
+    struct profEvent {
+        const char* name;
+        int64 start;
+        int64 end;
+    };
+
+    // per-thread event ring buffer, only the owner thread writes events,
+    // writeIndex is published with release semantics after each event
+    struct profThreadBuffer {
+        static const int32 MaxDepth = 64;
+        static const int32 NumEvents = ORYOL_PROFILER_EVENTS_PER_THREAD;
+        static_assert((NumEvents & (NumEvents - 1)) == 0, "ORYOL_PROFILER_EVENTS_PER_THREAD must be 2^N");
+
+        int32 tid = 0;
+        char name[64];
+        std::atomic<uint64> writeIndex{0};
+        int32 depth = 0;
+        const char* openNames[MaxDepth];
+        int64 openStarts[MaxDepth];
+        profEvent events[NumEvents];
+    };
+
+    std::atomic<bool> capturing{false};
+    std::atomic<int64> captureStart{0};
+    std::atomic<int64> captureEnd{0};
+    ORYOL_THREAD_LOCAL profThreadBuffer* threadBuffer = nullptr;
+
+    // all thread buffers, never freed
+    std::mutex& registryLock() {
+        static std::mutex lock;
+        return lock;
+    }
+    Array<profThreadBuffer*>& registry() {
+        static Array<profThreadBuffer*> buffers;
+        return buffers;
+    }
+
+    profThreadBuffer* getThreadBuffer() {
+        if (nullptr == threadBuffer) {
+            profThreadBuffer* buf = new profThreadBuffer;
+            std::lock_guard<std::mutex> lock(registryLock());
+            buf->tid = registry().Size() + 1;
+            std::snprintf(buf->name, sizeof(buf->name), "Thread %d", buf->tid);
+            registry().AddBack(buf);
+            threadBuffer = buf;
+        }
+        return threadBuffer;
+    }
+
+    // copy the valid events of a buffer which lie inside the capture window
+    void collectEvents(const profThreadBuffer* buf, int64 start, int64 end, Array<profEvent>& outEvents) {
+        const uint64 numEvents = profThreadBuffer::NumEvents;
+        const uint64 w0 = buf->writeIndex.load(std::memory_order_acquire);
+        const uint64 first = w0 > numEvents ? w0 - numEvents : 0;
+        Array<profEvent> events;
+        events.Reserve(int32(w0 - first));
+        for (uint64 i = first; i < w0; i++) {
+            events.AddBack(buf->events[i & (numEvents - 1)]);
+        }
+        // events may have been overwritten by the owner thread while
+        // copying, the slot of index i is reused by index i + numEvents,
+        // and the event at the current write index may be in flight
+        const uint64 w1 = buf->writeIndex.load(std::memory_order_acquire);
+        const uint64 firstValid = (w1 + 1) > numEvents ? (w1 + 1) - numEvents : 0;
+        for (int32 i = 0; i < events.Size(); i++) {
+            const profEvent& e = events[i];
+            if (((first + i) >= firstValid) && (e.start >= start) && (e.end <= end)) {
+                outEvents.AddBack(e);
+            }
+        }
+    }
+
+    // append a string as JSON string literal
+    void appendJSONString(StringBuilder& builder, const char* str) {
+        builder.Append('"');
+        for (const char* p = str; *p; p++) {
+            const char c = *p;
+            if (('"' == c) || ('\\' == c)) {
+                builder.Append('\\');
+                builder.Append(c);
+            }
+            else if (uchar(c) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                builder.Append(buf);
+            }
+            else {
+                builder.Append(c);
+            }
+        }
+        builder.Append('"');
+    }
+}
+
+//------------------------------------------------------------------------------
+int64
+Profiler::Now() {
+    return Clock::Now();
+}
+
+//------------------------------------------------------------------------------
+void
+Profiler::BeginCapture() {
+    captureStart.store(Now(), std::memory_order_relaxed);
+    captureEnd.store(0, std::memory_order_relaxed);
+    capturing.store(true, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+void
+Profiler::EndCapture() {
+    o_assert(capturing);
+    capturing.store(false, std::memory_order_release);
+    captureEnd.store(Now(), std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+bool
+Profiler::IsCapturing() {
+    return capturing.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+void
+Profiler::SetThreadName(const char* name) {
+    o_assert(nullptr != name);
+    profThreadBuffer* buf = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(registryLock());
+    std::strncpy(buf->name, name, sizeof(buf->name) - 1);
+    buf->name[sizeof(buf->name) - 1] = 0;
+}
+
+//------------------------------------------------------------------------------
+bool
+Profiler::Begin(const char* name) {
+    if (!capturing.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    profThreadBuffer* buf = getThreadBuffer();
+    if (buf->depth >= profThreadBuffer::MaxDepth) {
+        return false;
+    }
+    buf->openNames[buf->depth] = name;
+    buf->openStarts[buf->depth] = Now();
+    buf->depth++;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+Profiler::End() {
+    const int64 end = Now();
+    profThreadBuffer* buf = threadBuffer;
+    o_assert_dbg((nullptr != buf) && (buf->depth > 0));
+    buf->depth--;
+    const uint64 w = buf->writeIndex.load(std::memory_order_relaxed);
+    profEvent& e = buf->events[w & (profThreadBuffer::NumEvents - 1)];
+    e.name = buf->openNames[buf->depth];
+    e.start = buf->openStarts[buf->depth];
+    e.end = end;
+    buf->writeIndex.store(w + 1, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+int32
+Profiler::NumCapturedEvents() {
+    const int64 start = captureStart.load(std::memory_order_relaxed);
+    const int64 end = capturing ? Now() : captureEnd.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(registryLock());
+    int32 num = 0;
+    Array<profEvent> events;
+    for (const profThreadBuffer* buf : registry()) {
+        events.Clear();
+        collectEvents(buf, start, end, events);
+        num += events.Size();
+    }
+    return num;
+}
+
+//------------------------------------------------------------------------------
+String
+Profiler::ChromeTrace() {
+    const int64 start = captureStart.load(std::memory_order_relaxed);
+    const int64 end = capturing ? Now() : captureEnd.load(std::memory_order_relaxed);
+
+    StringBuilder builder;
+    builder.Append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    bool first = true;
+    char buf[128];
+    std::lock_guard<std::mutex> lock(registryLock());
+    Array<profEvent> events;
+    for (const profThreadBuffer* threadBuf : registry()) {
+        events.Clear();
+        collectEvents(threadBuf, start, end, events);
+
+        // thread name metadata event
+        if (!first) {
+            builder.Append(',');
+        }
+        first = false;
+        std::snprintf(buf, sizeof(buf), "\n{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":", threadBuf->tid);
+        builder.Append(buf);
+        appendJSONString(builder, threadBuf->name);
+        builder.Append("}}");
+
+        // complete events, timestamps in microseconds relative to capture start
+        for (const profEvent& e : events) {
+            std::snprintf(buf, sizeof(buf), ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"name\":",
+                threadBuf->tid, float64(e.start - start) * 0.001, float64(e.end - e.start) * 0.001);
+            builder.Append(buf);
+            appendJSONString(builder, e.name);
+            builder.Append('}');
+        }
+    }
+    builder.Append("\n]}\n");
+    return builder.GetString();
+}
+
+} // namespace Core
+} // namespace Oryol
@@ -0,0 +1,90 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Core::Profiler
+    @brief scoped CPU profiler with Chrome trace export
+
+    Mark code regions with the o_prof_scope() macro:
+
+        void MyClass::Update() {
+            o_prof_scope("MyClass::Update");
+            ...
+        }
+
+    While a capture is running (between BeginCapture() and EndCapture()),
+    each scope records a single event (name, start time, duration, nesting
+    depth) into a lock-free ring buffer of the calling thread, the oldest
+    events are overwritten when a ring buffer is full. Outside of a capture
+    a scope costs one relaxed atomic load. The per-thread buffers are created
+    on the first recorded event and are never freed, so events of threads
+    which have already finished can still be exported.
+
+    ChromeTrace() converts the events of the last capture into the JSON
+    format of chrome://tracing and the Perfetto UI.
+
+    Scope names must be string literals or other strings which
+    live as long as the Profiler (e.g. StringAtom::AsCStr()).
+
+    The profiler is only compiled in if ORYOL_PROFILING is 1 (on by
+    default in debug builds, in release builds enable the
+    ORYOL_PROFILING cmake option), otherwise o_prof_scope() and
+    o_prof_thread_name() expand to nothing.
+*/
+#include "Core/Types.h"
+#include "Core/String/String.h"
+
+namespace Oryol {
+namespace Core {
+
+class Profiler {
+public:
+    /// start capturing events
+    static void BeginCapture();
+    /// stop capturing events
+    static void EndCapture();
+    /// return true if currently capturing
+    static bool IsCapturing();
+    /// set the name of the calling thread (shown in the trace viewer)
+    static void SetThreadName(const char* name);
+    /// get the number of events of the last capture
+    static int32 NumCapturedEvents();
+    /// convert the last capture to Chrome trace JSON
+    static String ChromeTrace();
+    /// get current time in nanoseconds (high resolution, monotonic)
+    static int64 Now();
+
+    /// begin a scope, return false if the event won't be recorded
+    static bool Begin(const char* name);
+    /// end a scope
+    static void End();
+
+    /// scope helper object (use the o_prof_scope macro)
+    class Scope {
+    public:
+        /// constructor, begins a scope
+        Scope(const char* name) : active(Profiler::Begin(name)) { };
+        /// destructor, ends the scope
+        ~Scope() {
+            if (this->active) {
+                Profiler::End();
+            }
+        };
+    private:
+        bool active;
+    };
+};
+
+} // namespace Core
+} // namespace Oryol
+
+#if ORYOL_PROFILING
+#define o_prof_concat_inner(a, b) a##b
+#define o_prof_concat(a, b) o_prof_concat_inner(a, b)
+/// profile the enclosing scope
+#define o_prof_scope(name) Oryol::Core::Profiler::Scope o_prof_concat(o_prof_scope_, __LINE__)(name)
+/// set the profiler name of the calling thread
+#define o_prof_thread_name(name) Oryol::Core::Profiler::SetThreadName(name)
+#else
+#define o_prof_scope(name)
+#define o_prof_thread_name(name)
+#endif
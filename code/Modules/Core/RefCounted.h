@@ -54,7 +54,8 @@ RefCounted::addRef() {
 inline void
 RefCounted::release() {
     #if ORYOL_HAS_THREADS
-    if (1 == this->refCount.fetch_sub(1, std::memory_order_relaxed)) {
+    // acq_rel: the destroying thread must see all writes of other owners
+    if (1 == this->refCount.fetch_sub(1, std::memory_order_acq_rel)) {
     #else
     if (1 == this->refCount--) {
     #endif
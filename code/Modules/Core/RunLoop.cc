@@ -3,6 +3,8 @@
 //------------------------------------------------------------------------------
 #include "Pre.h"
 #include "RunLoop.h"
+#include "Core/Profiler.h"
+#include "Core/CoreFacade.h"
 
 namespace Oryol {
 namespace Core {
@@ -12,31 +14,288 @@ OryolClassImpl(RunLoop);
 //------------------------------------------------------------------------------
 RunLoop::RunLoop()
 {
-    // empty
+    this->timers.Setup(Clock::FromMilliSeconds(1.0), Clock::Now());
 }
 
 //------------------------------------------------------------------------------
 RunLoop::~RunLoop() {
     this->callbacks.Clear();
+    delete[] this->pending;
 }
 
 //------------------------------------------------------------------------------
 void
 RunLoop::Run() {
+    this->Run(Clock::Now());
+}
+
+//------------------------------------------------------------------------------
+void
+RunLoop::Run(Clock::Ticks now) {
+    o_prof_scope("RunLoop::Run");
+    this->frameDuration = (this->frameTime > 0) ? (now - this->frameTime) : 0;
+    this->frameTime = now;
+    this->RemoveCallbacks();
     this->AddCallbacks();
-    for (const auto& entry : this->callbacks) {
-        const Callback& cb = entry.Value();
-        if (cb.IsValid()) {
-            cb.Func()();
+    if (this->scheduleDirty) {
+        this->buildSchedule();
+    }
+    this->timers.Advance(now);
+    this->callPosted();
+    const int32 numSteps = this->fixedTimestep.Advance(this->frameDuration);
+    JobSystem* jobSystem = this->scheduled ? this->getJobSystem() : nullptr;
+    const int32 numSegments = this->segments.Size();
+    for (int32 segIndex = 0; segIndex < numSegments; ) {
+        if (Phase::FixedUpdate == this->segments[segIndex].phase) {
+            // run all segments of the fixed update phase once per step
+            int32 endIndex = segIndex;
+            while ((endIndex < numSegments) && (Phase::FixedUpdate == this->segments[endIndex].phase)) {
+                endIndex++;
+            }
+            for (int32 step = 0; step < numSteps; step++) {
+                for (int32 i = segIndex; i < endIndex; i++) {
+                    this->runSegment(i, jobSystem);
+                }
+            }
+            segIndex = endIndex;
+        }
+        else {
+            this->runSegment(segIndex++, jobSystem);
         }
     }
     this->RemoveCallbacks();
 }
 
+//------------------------------------------------------------------------------
+void
+RunLoop::runSegment(int32 segIndex, JobSystem* jobSystem) {
+    const segment& seg = this->segments[segIndex];
+    if ((nullptr == jobSystem) || !seg.parallel || (seg.numNodes == 1)) {
+        for (int32 i = seg.firstNode; i < seg.firstNode + seg.numNodes; i++) {
+            this->callNode(i);
+        }
+    }
+    else {
+        // start the callbacks without dependencies, the others are
+        // started by the callbacks they depend on
+        JobSystem::Counter counter;
+        for (int32 i = seg.firstNode; i < seg.firstNode + seg.numNodes; i++) {
+            this->pending[i].store(this->nodes[i].numDeps, std::memory_order_relaxed);
+        }
+        for (int32 i = seg.firstNode; i < seg.firstNode + seg.numNodes; i++) {
+            if (0 == this->nodes[i].numDeps) {
+                jobSystem->Run([this, jobSystem, i, &counter]() {
+                    this->runNodeJob(jobSystem, i, &counter);
+                }, &counter);
+            }
+        }
+        jobSystem->Wait(&counter);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+RunLoop::callNode(int32 nodeIndex) {
+    const Callback& cb = this->callbacks.ValueAtIndex(this->nodes[nodeIndex].callbackIndex);
+    if (cb.IsValid()) {
+        o_prof_scope(cb.Name().AsCStr());
+        cb.Func()();
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+RunLoop::runNodeJob(JobSystem* jobSystem, int32 nodeIndex, JobSystem::Counter* counter) {
+    this->callNode(nodeIndex);
+    const node& n = this->nodes[nodeIndex];
+    for (int32 i = n.firstSuccessor; i < n.firstSuccessor + n.numSuccessors; i++) {
+        const int32 succ = this->successors[i];
+        if (1 == this->pending[succ].fetch_sub(1, std::memory_order_acq_rel)) {
+            jobSystem->Run([this, jobSystem, succ, counter]() {
+                this->runNodeJob(jobSystem, succ, counter);
+            }, counter);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+ Sort the callbacks by phase and priority into segments, exclusive
+ callbacks get a segment of their own, the others are grouped into
+ one parallel segment per phase (between exclusive callbacks), and
+ each callback of a parallel segment depends on the earlier callbacks
+ of its segment which it conflicts with.
+*/
+void
+RunLoop::buildSchedule() {
+    this->nodes.Clear();
+    this->successors.Clear();
+    this->segments.Clear();
+    for (int32 phase = 0; phase < int32(Phase::NumPhases); phase++) {
+        bool segmentOpen = false;
+        for (int32 cbIndex = 0; cbIndex < this->callbacks.Size(); cbIndex++) {
+            const Callback& cb = this->callbacks.ValueAtIndex(cbIndex);
+            if (int32(cb.GetPhase()) != phase) {
+                continue;
+            }
+            const bool exclusive = cb.IsExclusive();
+            if (exclusive || !segmentOpen) {
+                segment seg;
+                seg.firstNode = this->nodes.Size();
+                seg.phase = Phase(phase);
+                seg.parallel = !exclusive;
+                this->segments.AddBack(seg);
+                segmentOpen = !exclusive;
+            }
+            node n;
+            n.callbackIndex = cbIndex;
+            this->nodes.AddBack(n);
+            this->segments.Back().numNodes++;
+        }
+    }
+    for (const segment& seg : this->segments) {
+        for (int32 i = seg.firstNode; i < seg.firstNode + seg.numNodes; i++) {
+            node& n = this->nodes[i];
+            n.firstSuccessor = this->successors.Size();
+            const Callback& cb = this->callbacks.ValueAtIndex(n.callbackIndex);
+            for (int32 j = i + 1; j < seg.firstNode + seg.numNodes; j++) {
+                if (cb.ConflictsWith(this->callbacks.ValueAtIndex(this->nodes[j].callbackIndex))) {
+                    this->successors.AddBack(j);
+                    this->nodes[j].numDeps++;
+                }
+            }
+            n.numSuccessors = this->successors.Size() - n.firstSuccessor;
+        }
+    }
+    delete[] this->pending;
+    this->pending = new std::atomic<int32>[this->nodes.Size()];
+    this->scheduleDirty = false;
+}
+
+//------------------------------------------------------------------------------
+JobSystem*
+RunLoop::getJobSystem() const {
+    JobSystem* jobSystem = this->jobSystemOverride;
+    #if ORYOL_HAS_THREADS
+    if ((nullptr == jobSystem) && CoreFacade::HasInstance()) {
+        jobSystem = CoreFacade::Instance()->JobSystem();
+    }
+    #endif
+    if ((nullptr != jobSystem) && (jobSystem->NumWorkers() > 0)) {
+        return jobSystem;
+    }
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+void
+RunLoop::SetScheduled(bool b) {
+    this->scheduled = b;
+}
+
+//------------------------------------------------------------------------------
+bool
+RunLoop::IsScheduled() const {
+    return this->scheduled;
+}
+
+//------------------------------------------------------------------------------
+void
+RunLoop::SetJobSystem(JobSystem* jobSystem) {
+    this->jobSystemOverride = jobSystem;
+}
+
+//------------------------------------------------------------------------------
+void
+RunLoop::SetFixedTimestep(Clock::Ticks stepDuration, int32 maxStepsPerFrame) {
+    this->fixedTimestep.Setup(stepDuration, maxStepsPerFrame);
+}
+
+//------------------------------------------------------------------------------
+const FixedTimestep&
+RunLoop::GetFixedTimestep() const {
+    return this->fixedTimestep;
+}
+
+//------------------------------------------------------------------------------
+TimerWheel&
+RunLoop::Timers() {
+    return this->timers;
+}
+
+//------------------------------------------------------------------------------
+Clock::Ticks
+RunLoop::FrameDuration() const {
+    return this->frameDuration;
+}
+
+//------------------------------------------------------------------------------
+Clock::Ticks
+RunLoop::FrameTime() const {
+    return this->frameTime;
+}
+
+//------------------------------------------------------------------------------
+Task<void>
+RunLoop::Delay(Clock::Ticks delay) {
+    Promise<void> promise;
+    this->timers.Add(delay, [promise]() mutable {
+        promise.Resolve();
+    });
+    return promise.GetTask();
+}
+
+//------------------------------------------------------------------------------
+void
+RunLoop::Post(std::function<void()> func) {
+    this->postLock.Lock();
+    this->posted.AddBack(std::move(func));
+    this->postLock.Unlock();
+}
+
+//------------------------------------------------------------------------------
+void
+RunLoop::callPosted() {
+    // swap the arrays, so that functions can post new functions
+    // (which will be called in the next frame)
+    this->postLock.Lock();
+    if (this->posted.Empty()) {
+        this->postLock.Unlock();
+        return;
+    }
+    Array<std::function<void()>> tmp(std::move(this->posted));
+    this->posted = std::move(this->postedRunning);
+    this->postedRunning = std::move(tmp);
+    this->postLock.Unlock();
+    for (auto& func : this->postedRunning) {
+        func();
+    }
+    this->postedRunning.Clear();
+}
+
+//------------------------------------------------------------------------------
+bool
+RunLoop::Callback::ConflictsWith(const Callback& other) const {
+    if (this->IsExclusive() || other.IsExclusive()) {
+        return true;
+    }
+    for (const StringAtom& res : this->writes) {
+        if ((InvalidIndex != other.reads.FindIndexLinear(res)) || (InvalidIndex != other.writes.FindIndexLinear(res))) {
+            return true;
+        }
+    }
+    for (const StringAtom& res : other.writes) {
+        if (InvalidIndex != this->reads.FindIndexLinear(res)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 //------------------------------------------------------------------------------
 bool
 RunLoop::HasCallback(const StringAtom& name) const {
-    return this->FindCallback(name);
+    return InvalidIndex != this->FindCallback(name);
 }
 
 //------------------------------------------------------------------------------
@@ -44,7 +303,7 @@ int32
 RunLoop::FindCallback(const StringAtom& name) const {
     const int32 num = this->callbacks.Size();
     for (int32 i = 0; i < num; i++) {
-        if (this->callbacks[i].Name() == name) {
+        if (this->callbacks.ValueAtIndex(i).Name() == name) {
             return i;
         }
     }
@@ -56,12 +315,15 @@ RunLoop::FindCallback(const StringAtom& name) const {
  Add a new callback to the runloop. Callbacks with smaller priority
  values are called earlier in the frame. The callback name must be unique.
  NOTE that the callback will not be added immediately, but only at the 
- beginning of the next Run() call.
+ beginning of the next Run() call (after callbacks which have been
+ removed in the meantime are gone).
 */
 void
 RunLoop::Add(const Callback& callback) {
     o_assert(!this->toAdd.Contains(callback.Name()));
-    o_assert(InvalidIndex == this->FindCallback(callback.Name()));
+    // a callback which is waiting to be removed can be replaced
+    const int32 index = this->FindCallback(callback.Name());
+    o_assert((InvalidIndex == index) || !this->callbacks.ValueAtIndex(index).IsValid());
     
     this->toAdd.Insert(callback.Name(), callback);
 }
@@ -78,7 +340,7 @@ RunLoop::Remove(const StringAtom& name) {
     
     int32 index = this->FindCallback(name);
     o_assert(InvalidIndex != index);
-    this->callbacks[index].SetValid(false);
+    this->callbacks.ValueAtIndex(index).SetValid(false);
     this->toRemove.Insert(name);
 }
 
@@ -89,6 +351,7 @@ RunLoop::AddCallbacks() {
         Callback& cb = entry.Value();
         cb.SetValid(true);
         this->callbacks.Insert(cb.Priority(), cb);
+        this->scheduleDirty = true;
     }
     this->toAdd.Clear();
 }
@@ -99,10 +362,12 @@ RunLoop::RemoveCallbacks() {
     for (const StringAtom& name : this->toRemove) {
         int32 index = this->FindCallback(name);
         if (InvalidIndex != index) {
-            o_assert(!this->callbacks[index].IsValid());
+            o_assert(!this->callbacks.ValueAtIndex(index).IsValid());
             this->callbacks.EraseIndex(index);
+            this->scheduleDirty = true;
         }
     }
+    this->toRemove.Clear();
 }
 
 //------------------------------------------------------------------------------
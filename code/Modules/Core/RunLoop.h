@@ -21,11 +21,53 @@
 
         MyClass myObj;<br>
         Callback("name", pri, std::function<void()>(&MyClass::MyMethod, &myObj));
+
+    Callbacks belong to a frame phase (Input, FixedUpdate, Update,
+    IOPump, RenderSubmit, default is Update), the phases are executed
+    in this order, callbacks inside a phase in priority order. Callbacks may
+    declare which (named) resources they read and write:
+
+        Callback("physics", 0, func).SetPhase(RunLoop::Phase::Update).Reads("input").Writes("transforms");
+
+    By default a RunLoop calls all callbacks one after another on its
+    own thread. After SetScheduled(true), callbacks of the same phase
+    whose declared reads and writes don't conflict run concurrently
+    as jobs on the JobSystem, a callback which conflicts with earlier
+    callbacks of its phase waits for them to finish. Callbacks without
+    declared resources are exclusive: they run alone on the RunLoop's
+    thread, after all earlier and before all later callbacks of their
+    phase (this is the safe default for existing callbacks and for
+    callbacks which must run on the main thread, like rendering). The
+    dependency graph is only rebuilt when callbacks are added or
+    removed. Concurrent callbacks must not add or remove callbacks.
+
+    Each Run() measures the time since the previous frame with the
+    Clock (FrameDuration()). After SetFixedTimestep(), the callbacks
+    of the FixedUpdate phase run zero or more times per frame, once
+    per fixed step which has elapsed (see FixedTimestep), use the
+    FixedTimestep's Alpha() to interpolate rendering between steps.
+    Without a fixed timestep, FixedUpdate callbacks run once per frame.
+    Timers() returns a TimerWheel for one-shot and periodic callbacks
+    (stats flushes, cache trims, ...), it's advanced at the start of
+    each frame on the RunLoop's thread.
+
+    Post() is thread-safe and queues a function which is called at
+    the start of the next frame on the RunLoop's thread, this is how
+    asynchronous operations (IO requests, messages) resume their Task
+    continuations on the thread which started them (see Core::Task).
 */
 #include <functional>
+#include <atomic>
 #include "Core/RefCounted.h"
 #include "Core/String/StringAtom.h"
 #include "Core/Containers/Map.h"
+#include "Core/Containers/Array.h"
+#include "Core/Threading/JobSystem.h"
+#include "Core/Time/Clock.h"
+#include "Core/Time/FixedTimestep.h"
+#include "Core/Time/TimerWheel.h"
+#include "Core/Task.h"
+#include "Core/Threading/Mutex.h"
 
 namespace Oryol {
 namespace Core {
@@ -33,13 +75,24 @@ namespace Core {
 class RunLoop : public RefCounted {
     OryolClassDecl(RunLoop);
 public:
+    /// frame phases, executed in this order
+    enum class Phase {
+        Input,
+        FixedUpdate,
+        Update,
+        IOPump,
+        RenderSubmit,
+
+        NumPhases,
+    };
+
     /// callback object
     class Callback {
     public:
         /// default constructor
-        Callback() : pri(0), valid(false) { };
+        Callback() : pri(0), phase(Phase::Update), valid(false) { };
         /// constructor with name, priority and function
-        Callback(const StringAtom& name_, int32 pri_, std::function<void()> func_) : name(name_), pri(pri_), func(func_), valid(false) { };
+        Callback(const StringAtom& name_, int32 pri_, std::function<void()> func_) : name(name_), pri(pri_), phase(Phase::Update), func(func_), valid(false) { };
         /// get name
         const StringAtom& Name() const { return this->name; };
         /// get priority
@@ -50,10 +103,30 @@ public:
         void SetValid(bool b) { this->valid = b; };
         /// get valid flag
         bool IsValid() const { return this->valid; };
+
+        /// set the frame phase
+        Callback& SetPhase(Phase p) { this->phase = p; return *this; };
+        /// get the frame phase
+        Phase GetPhase() const { return this->phase; };
+        /// declare a resource which is read by the callback
+        Callback& Reads(const StringAtom& res) { this->reads.AddBack(res); return *this; };
+        /// declare a resource which is written by the callback
+        Callback& Writes(const StringAtom& res) { this->writes.AddBack(res); return *this; };
+        /// get the declared read resources
+        const Array<StringAtom>& ReadResources() const { return this->reads; };
+        /// get the declared write resources
+        const Array<StringAtom>& WriteResources() const { return this->writes; };
+        /// return true if no resources are declared (never runs concurrently)
+        bool IsExclusive() const { return this->reads.Empty() && this->writes.Empty(); };
+        /// return true if the callbacks can't run concurrently
+        bool ConflictsWith(const Callback& other) const;
     private:
         StringAtom name;
         int32 pri;
+        Phase phase;
         std::function<void()> func;
+        Array<StringAtom> reads;
+        Array<StringAtom> writes;
         bool valid;
     };
 
@@ -64,6 +137,8 @@ public:
     
     /// run one frame
     void Run();
+    /// run one frame at a given time (for tests and replays)
+    void Run(Clock::Ticks now);
     
     /// add a callback to the run loop, higher priorities run earlier, slow!
     void Add(const Callback& callback);
@@ -73,6 +148,29 @@ public:
     bool HasCallback(const StringAtom& name) const;
     /// get the callbacks map, key is priority, value is Callback object
     const Map<int32, Callback>& Callbacks() const;
+
+    /// run independent callbacks concurrently (default is false)
+    void SetScheduled(bool b);
+    /// return true if callbacks are run concurrently
+    bool IsScheduled() const;
+    /// override the JobSystem used in scheduled mode (nullptr: CoreFacade's JobSystem)
+    void SetJobSystem(JobSystem* jobSystem);
+
+    /// run the FixedUpdate phase in fixed steps (0 to run it once per frame)
+    void SetFixedTimestep(Clock::Ticks stepDuration, int32 maxStepsPerFrame = 8);
+    /// get the fixed timestep accumulator
+    const FixedTimestep& GetFixedTimestep() const;
+    /// get the timer wheel
+    TimerWheel& Timers();
+    /// get the duration of the last frame (time between the last 2 Run() calls)
+    Clock::Ticks FrameDuration() const;
+    /// get the start time of the current or last frame
+    Clock::Ticks FrameTime() const;
+    /// get a Task which completes after a delay
+    Task<void> Delay(Clock::Ticks delay);
+
+    /// call a function at the start of the next frame on the RunLoop's thread (thread-safe)
+    void Post(std::function<void()> func);
     
 private:
     /// find callback index by name
@@ -81,10 +179,54 @@ private:
     void AddCallbacks();
     /// remove callbacks that have been removed (called at end of Run())
     void RemoveCallbacks();
-    
+    /// call the posted functions
+    void callPosted();
+    /// rebuild the execution schedule from the callbacks
+    void buildSchedule();
+    /// get the JobSystem for scheduled mode, nullptr if callbacks must run serially
+    JobSystem* getJobSystem() const;
+    /// run the callbacks of a schedule segment
+    void runSegment(int32 segIndex, JobSystem* jobSystem);
+    /// call the callback of a schedule node
+    void callNode(int32 nodeIndex);
+    /// run a node as job, then start successors whose dependencies are done
+    void runNodeJob(JobSystem* jobSystem, int32 nodeIndex, JobSystem::Counter* counter);
+
+    /// a callback in the schedule
+    struct node {
+        int32 callbackIndex = InvalidIndex;
+        int32 numDeps = 0;
+        int32 firstSuccessor = 0;
+        int32 numSuccessors = 0;
+    };
+    /// a range of nodes, nodes of a parallel segment may run concurrently
+    struct segment {
+        int32 firstNode = 0;
+        int32 numNodes = 0;
+        Phase phase = Phase::Update;
+        bool parallel = false;
+    };
+
     Map<int32, Callback> callbacks;
     Map<StringAtom, Callback> toAdd;
     Set<StringAtom> toRemove;
+
+    bool scheduled = false;
+    bool scheduleDirty = true;
+    JobSystem* jobSystemOverride = nullptr;
+    Array<node> nodes;                      // in execution order (phase, priority)
+    Array<int32> successors;                // node successor lists
+    Array<segment> segments;
+    std::atomic<int32>* pending = nullptr;  // remaining dependencies per node while running
+
+    Clock::Ticks frameTime = 0;
+    Clock::Ticks frameDuration = 0;
+    FixedTimestep fixedTimestep;
+    TimerWheel timers;
+
+    Mutex postLock;
+    Array<std::function<void()>> posted;
+    Array<std::function<void()>> postedRunning;
 };
     
 } // namespace Core
@@ -10,6 +10,19 @@ namespace Oryol {
 namespace Core {
 const char* StringAtom::emptyString = "";
 
+namespace {
+    // binary snapshot layout: snapshotHeader, followed by numAtoms
+    // entries of [int32 hash][int32 length][length+1 bytes string data]
+    struct snapshotHeader {
+        uint32 magic;
+        uint32 version;
+        int32 numAtoms;
+        int32 numStringBytes;   // sum of all string lengths (without terminating 0)
+    };
+    const uint32 snapshotMagic = 'SATM';
+    const uint32 snapshotVersion = 1;
+}
+
 //------------------------------------------------------------------------------
 StringAtom::StringAtom(const String& rhs) {
     this->setupFromCString(rhs.AsCStr());
@@ -125,5 +138,127 @@ StringAtom::operator==(const char* rhs) const {
     }
 }
 
+
+//------------------------------------------------------------------------------
+StringAtom::TableStats
+StringAtom::GetTableStats() {
+    const stringAtomTable* table = stringAtomTable::Instance();
+    const stringAtomBuffer& buffer = table->Buffer();
+    TableStats stats;
+    stats.numAtoms = table->NumAtoms();
+    stats.numBytesUsed = buffer.NumBytesUsed();
+    stats.numBytesReserved = buffer.NumBytesReserved();
+    stats.numChunks = buffer.NumChunks();
+    table->BucketStats(stats.numBuckets, stats.numUsedBuckets, stats.maxBucketSize);
+    return stats;
+}
+
+//------------------------------------------------------------------------------
+void
+StringAtom::SetChunkSize(int32 numBytes) {
+    stringAtomBuffer::SetChunkSize(numBytes);
+}
+
+//------------------------------------------------------------------------------
+int32
+StringAtom::GetChunkSize() {
+    return stringAtomBuffer::GetChunkSize();
+}
+
+//------------------------------------------------------------------------------
+Array<uint8>
+StringAtom::CreateSnapshot() {
+    const stringAtomTable* table = stringAtomTable::Instance();
+    Array<const stringAtomBuffer::Header*> headers;
+    table->Headers(headers);
+
+    snapshotHeader hdr;
+    hdr.magic = snapshotMagic;
+    hdr.version = snapshotVersion;
+    hdr.numAtoms = headers.Size();
+    hdr.numStringBytes = 0;
+    for (const stringAtomBuffer::Header* entry : headers) {
+        hdr.numStringBytes += entry->length;
+    }
+    const int32 entryOverhead = 2 * sizeof(int32) + 1;
+    const int32 size = sizeof(hdr) + hdr.numAtoms * entryOverhead + hdr.numStringBytes;
+
+    Array<uint8> snapshot;
+    snapshot.Reserve(size);
+    for (int32 i = 0; i < size; i++) {
+        snapshot.AddBack(0);
+    }
+    uint8* dst = &snapshot[0];
+    std::memcpy(dst, &hdr, sizeof(hdr));
+    dst += sizeof(hdr);
+    for (const stringAtomBuffer::Header* entry : headers) {
+        std::memcpy(dst, &entry->hash, sizeof(int32));
+        dst += sizeof(int32);
+        std::memcpy(dst, &entry->length, sizeof(int32));
+        dst += sizeof(int32);
+        std::memcpy(dst, entry->str, entry->length + 1);
+        dst += entry->length + 1;
+    }
+    o_assert(dst == &snapshot[0] + size);
+    return snapshot;
+}
+
+//------------------------------------------------------------------------------
+int32
+StringAtom::LoadSnapshot(const uint8* data, int32 numBytes) {
+    o_assert(nullptr != data);
+
+    // validate header and entries before touching the table
+    snapshotHeader hdr;
+    if (numBytes < int32(sizeof(hdr))) {
+        return InvalidIndex;
+    }
+    std::memcpy(&hdr, data, sizeof(hdr));
+    if ((snapshotMagic != hdr.magic) || (snapshotVersion != hdr.version) ||
+        (hdr.numAtoms < 0) || (hdr.numStringBytes < 0)) {
+        return InvalidIndex;
+    }
+    const uint8* const end = data + numBytes;
+    const uint8* const first = data + sizeof(hdr);
+    int32 reserveBytes = 0;
+    const uint8* ptr = first;
+    for (int32 i = 0; i < hdr.numAtoms; i++) {
+        int32 length = 0;
+        if ((end - ptr) < int32(2 * sizeof(int32))) {
+            return InvalidIndex;
+        }
+        std::memcpy(&length, ptr + sizeof(int32), sizeof(int32));
+        ptr += 2 * sizeof(int32);
+        if ((length <= 0) || ((end - ptr) <= length) || (0 != ptr[length]) ||
+            (nullptr != std::memchr(ptr, 0, length))) {
+            return InvalidIndex;
+        }
+        ptr += length + 1;
+        reserveBytes += stringAtomBuffer::EntrySize(length);
+    }
+
+    // add the strings, the hashes are taken from the snapshot
+    stringAtomTable* table = stringAtomTable::Instance();
+    table->Reserve(reserveBytes);
+    int32 numAdded = 0;
+    ptr = first;
+    for (int32 i = 0; i < hdr.numAtoms; i++) {
+        int32 hash = 0;
+        int32 length = 0;
+        std::memcpy(&hash, ptr, sizeof(int32));
+        std::memcpy(&length, ptr + sizeof(int32), sizeof(int32));
+        const char* str = (const char*) (ptr + 2 * sizeof(int32));
+        #if ORYOL_DEBUG
+        o_assert(stringAtomTable::HashForString(str) == hash);
+        #endif
+        if (nullptr == table->Find(hash, str)) {
+            table->Add(hash, str);
+            numAdded++;
+        }
+        ptr += 2 * sizeof(int32) + length + 1;
+    }
+    return numAdded;
+}
+
 } // namespace Core
-} // namespace Oryol
\ No newline at end of file
+} // namespace Oryol
@@ -8,6 +8,12 @@
     String atoms are stored in thread-local stringAtomTables and comparison
     is fastest in the creator thread.
     
+    The static methods GetTableStats(), CreateSnapshot() and LoadSnapshot()
+    always work on the string atom table of the calling thread. A snapshot
+    is a binary blob with all strings of a table and their hashes, loading
+    a snapshot at startup pre-interns the strings without hashing and
+    with a single string buffer allocation.
+    
     @see String
 */
 #include "Core/Types.h"
@@ -20,6 +26,18 @@ class String;
 
 class StringAtom {
 public:
+    /// statistics of a thread-local string atom table
+    struct TableStats {
+        int32 numAtoms = 0;             ///< number of unique strings
+        int32 numBytesUsed = 0;         ///< string buffer bytes used (headers, strings and padding)
+        int32 numBytesReserved = 0;     ///< string buffer bytes allocated
+        int32 numChunks = 0;            ///< number of string buffer chunks
+        int32 numBuckets = 0;           ///< number of hash buckets
+        int32 numUsedBuckets = 0;       ///< number of non-empty hash buckets
+        int32 maxBucketSize = 0;        ///< number of entries in the fullest bucket
+    };
+    
+
     /// default constructor
     StringAtom();
     /// construct from String
@@ -78,6 +96,17 @@ public:
     const char* AsCStr() const;
     /// get String (slow because string object must be constructed)
     String AsString() const;
+    
+    /// get statistics of the calling thread's string atom table
+    static TableStats GetTableStats();
+    /// set string buffer chunk size for chunks allocated from now on (all threads)
+    static void SetChunkSize(int32 numBytes);
+    /// get the current string buffer chunk size
+    static int32 GetChunkSize();
+    /// serialize the calling thread's string atom table into a binary snapshot
+    static Array<uint8> CreateSnapshot();
+    /// seed the calling thread's string atom table from a snapshot, returns number of new atoms or InvalidIndex
+    static int32 LoadSnapshot(const uint8* data, int32 numBytes);
 
 private:
     /// copy content
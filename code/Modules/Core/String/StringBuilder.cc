@@ -4,6 +4,7 @@
 #include "Pre.h"
 #include <cstring>
 #include "StringBuilder.h"
+#include "simdScan.h"
 #include "Core/Memory/Memory.h"
 
 #if ORYOL_WINDOWS
@@ -383,13 +384,16 @@ StringBuilder::SubstituteFirst(const String& match, const String& subst) {
 //------------------------------------------------------------------------------
 int32
 StringBuilder::findFirstOf(const char* str, int32 strLen, int32 startIndex, int32 endIndex, const char* delims) {
-    const char* ptr = str + startIndex;
-    const int index = std::strcspn(ptr, delims) + startIndex;
-    if (((endIndex != EndOfString) && (index >= endIndex)) || (index >= strLen)) {
+    const int32 limit = ((EndOfString == endIndex) || (endIndex > strLen)) ? strLen : endIndex;
+    if (startIndex >= limit) {
+        return InvalidIndex;
+    }
+    const int32 index = simdScan::FindFirstOf(str + startIndex, limit - startIndex, delims);
+    if (InvalidIndex == index) {
         return InvalidIndex;
     }
     else {
-        return index;
+        return index + startIndex;
     }
 }
 
@@ -431,13 +435,16 @@ StringBuilder::FindFirstOf(int32 startIndex, int32 endIndex, const char* delims)
 //------------------------------------------------------------------------------
 int32
 StringBuilder::findFirstNotOf(const char* str, int32 strLen, int32 startIndex, int32 endIndex, const char* delims) {
-    const char* ptr = str + startIndex;
-    int index = std::strspn(ptr, delims) + startIndex;
-    if (((EndOfString != endIndex) && (index >= endIndex)) || (index >= strLen)) {
+    const int32 limit = ((EndOfString == endIndex) || (endIndex > strLen)) ? strLen : endIndex;
+    if (startIndex >= limit) {
+        return InvalidIndex;
+    }
+    const int32 index = simdScan::FindFirstNotOf(str + startIndex, limit - startIndex, delims);
+    if (InvalidIndex == index) {
         return InvalidIndex;
     }
     else {
-        return index;
+        return index + startIndex;
     }
 }
 
@@ -451,9 +458,9 @@ int32
 StringBuilder::FindFirstNotOf(const char* str, int32 startIndex, int32 endIndex, const char* delims) {
     o_assert(0 != delims);
     o_assert(str);
-    o_assert((EndOfString != endIndex) || (endIndex >= startIndex));
+    o_assert((EndOfString == endIndex) || (endIndex >= startIndex));
     const int32 strLen = std::strlen(str);
-    return findFirstOf(str, strLen, startIndex, endIndex, delims);
+    return findFirstNotOf(str, strLen, startIndex, endIndex, delims);
 }
 
 //------------------------------------------------------------------------------
@@ -478,20 +485,19 @@ StringBuilder::FindFirstNotOf(int32 startIndex, int32 endIndex, const char* deli
 
 //------------------------------------------------------------------------------
 int32
-StringBuilder::findSubString(const char* str, int32 startIndex, int32 endIndex, const char* subStr) {
-    const char* ptr = str + startIndex;
-    const char* occur = std::strstr(ptr, subStr);
-    if (nullptr == occur) {
+StringBuilder::findSubString(const char* str, int32 strLen, int32 startIndex, int32 endIndex, const char* subStr) {
+    // NOTE: a match must start before endIndex, but may extend beyond it
+    const int32 limit = ((EndOfString == endIndex) || (endIndex > strLen)) ? strLen : endIndex;
+    if (startIndex > limit) {
+        return InvalidIndex;
+    }
+    const int32 subStrLen = std::strlen(subStr);
+    const int32 index = simdScan::FindSubString(str + startIndex, strLen - startIndex, limit - startIndex, subStr, subStrLen);
+    if (InvalidIndex == index) {
         return InvalidIndex;
     }
     else {
-        int32 index = (occur - ptr) + startIndex;
-        if ((EndOfString != endIndex) && (index >= endIndex)) {
-            return InvalidIndex;
-        }
-        else {
-            return index;
-        }
+        return index + startIndex;
     }
 }
 
@@ -504,8 +510,10 @@ StringBuilder::findSubString(const char* str, int32 startIndex, int32 endIndex,
 int32
 StringBuilder::FindSubString(const char* str, int32 startIndex, int32 endIndex, const char* subStr) {
     o_assert(0 != subStr);
+    o_assert(str);
     o_assert((EndOfString == endIndex) || (endIndex >= startIndex));
-    return findSubString(str, startIndex, endIndex, subStr);
+    const int32 strLen = std::strlen(str);
+    return findSubString(str, strLen, startIndex, endIndex, subStr);
 }
     
 //------------------------------------------------------------------------------
@@ -520,7 +528,7 @@ StringBuilder::FindSubString(int32 startIndex, int32 endIndex, const char* subSt
     o_assert(startIndex < this->size);
     o_assert((EndOfString == endIndex) || (endIndex >= startIndex));
     if (nullptr != this->buffer) {
-        return findSubString(this->buffer, startIndex, endIndex, subStr);
+        return findSubString(this->buffer, this->size, startIndex, endIndex, subStr);
     }
     else {
         // no content
@@ -596,6 +604,48 @@ StringBuilder::Tokenize(const char* delims, char fence, Array<String>& outTokens
     return outTokens.Size();
 }
 
+//------------------------------------------------------------------------------
+/**
+ Percent-encode the content (RFC 3986), all characters except the
+ unreserved characters (A-Z a-z 0-9 - . _ ~) are replaced with
+ a %XX sequence.
+*/
+void
+StringBuilder::PercentEncode() {
+    if ((nullptr == this->buffer) || (0 == this->size)) {
+        return;
+    }
+    // early out if nothing needs to be encoded
+    static const char* unreserved = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-._~";
+    if (InvalidIndex == simdScan::FindFirstNotOf(this->buffer, this->size, unreserved)) {
+        return;
+    }
+    const int32 newCapacity = (this->size * 3) + 1;
+    char* newBuffer = (char*) Memory::Alloc(newCapacity);
+    const int32 newSize = simdScan::PercentEncode(this->buffer, this->size, newBuffer);
+    o_assert(newSize < newCapacity);
+    newBuffer[newSize] = 0;
+    Memory::Free(this->buffer);
+    this->buffer = newBuffer;
+    this->capacity = newCapacity;
+    this->size = newSize;
+}
+
+//------------------------------------------------------------------------------
+/**
+ Percent-decode the content in place, %XX sequences (upper- or lowercase
+ hex digits) are replaced with the byte value, malformed sequences are
+ kept as is. A '+' is NOT decoded to a space.
+*/
+void
+StringBuilder::PercentDecode() {
+    if ((nullptr == this->buffer) || (0 == this->size)) {
+        return;
+    }
+    this->size = simdScan::PercentDecode(this->buffer, this->size, this->buffer);
+    this->buffer[this->size] = 0;
+}
+
 //------------------------------------------------------------------------------
 bool
 StringBuilder::Format(int32 maxLength, const char* fmt, ...) {
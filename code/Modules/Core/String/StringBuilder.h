@@ -114,9 +114,9 @@ public:
     /// remove the last char
     char PopBack();
 
-    /// percent-encode content
+    /// percent-encode content (RFC 3986 unreserved chars are kept)
     void PercentEncode();
-    /// percent-decode content
+    /// percent-decode content in place
     void PercentDecode();
     
 private:
@@ -129,7 +129,7 @@ private:
     /// helper function for FindFirstNotOf functions
     static int32 findFirstNotOf(const char* str, int32 strLen, int32 startIndex, int32 endIndex, const char* delims);
     /// helper function for FindSubString functions
-    static int32 findSubString(const char* str, int32 startIndex, int32 endIndex, const char* subStr);
+    static int32 findSubString(const char* str, int32 strLen, int32 startIndex, int32 endIndex, const char* subStr);
     
     static const int minGrowSize = 128;
     char* buffer;
@@ -4,6 +4,7 @@
 #include "Pre.h"
 #include "Core/Assert.h"
 #include "StringConverter.h"
+#include "simdUTF.h"
 #include "Ext/ConvertUTF/ConvertUTF.h"
 #include <cstdlib>
 #include <cstring>
@@ -25,21 +26,33 @@ DumpWarning(ConversionResult convRes) {
 int32
 StringConverter::UTF8ToWide(const unsigned char* src, int32 srcNumBytes, wchar_t* dst, int32 dstMaxBytes) {
     o_assert((0 != src) && (0 != dst));
-    int32 result = 0;
     const UTF8* srcPtr = src;
 
     // need to keep 1 wchar_t for the terminating 0
     ConversionResult convRes = conversionOK;
     wchar_t* dstEndPtr = dst + ((dstMaxBytes / sizeof(wchar_t)) - 1);
     o_assert(dstEndPtr > dst);
+
+    // fast path, on failure fall through to ConvertUTF which provides the detailed error
+    const int32 dstMaxChars = (int32) (dstEndPtr - dst);
+    int32 numChars = InvalidIndex;
+    if (sizeof(wchar_t) == 4) {
+        numChars = simdUTF::UTF8ToUTF32(src, srcNumBytes, (uint32*) dst, dstMaxChars);
+    }
+    else {
+        numChars = simdUTF::UTF8ToUTF16(src, srcNumBytes, (uint16*) dst, dstMaxChars);
+    }
+    if (InvalidIndex != numChars) {
+        dst[numChars] = 0;
+        return numChars + 1;
+    }
+
+    // slow path, only used to find out why the conversion failed
     if (sizeof(wchar_t) == 4) {
         UTF32* dstPtr = (UTF32*)dst;
         convRes = ConvertUTF8toUTF32(&srcPtr, src + srcNumBytes, &dstPtr, (UTF32*) dstEndPtr, strictConversion);
         o_assert(dstPtr < (UTF32*) (dst + (dstMaxBytes / sizeof(wchar_t))));
         *dstPtr = 0;
-        if (conversionOK == convRes) {
-            result = (dstPtr - (UTF32*)dst) + 1;
-        }
     } 
     else {
         o_assert(2 == sizeof(wchar_t));
@@ -47,15 +60,14 @@ StringConverter::UTF8ToWide(const unsigned char* src, int32 srcNumBytes, wchar_t
         convRes = ConvertUTF8toUTF16(&srcPtr, src + srcNumBytes, &dstPtr, (UTF16*) dstEndPtr, strictConversion);
         o_assert(dstPtr < (UTF16*) (dst + (dstMaxBytes / sizeof(wchar_t))));
         *dstPtr = 0;
-        if (conversionOK == convRes) {
-            result = (int32) ((dstPtr - (UTF16*)dst) + 1);
-        }
     }
-    if (conversionOK != convRes) {
-        DumpWarning(convRes);
-        return 0;
+    if (conversionOK == convRes) {
+        // ConvertUTF is lenient for some invalid sequences (e.g. 0xED or 0xF4
+        // followed by ASCII), the fast path rejected the input, so we do too
+        convRes = sourceIllegal;
     }
-    return result;
+    DumpWarning(convRes);
+    return 0;
 }
 
 //------------------------------------------------------------------------------
@@ -69,6 +81,22 @@ StringConverter::WideToUTF8(const wchar_t* src, int32 srcNumChars, unsigned char
     ConversionResult convRes = conversionOK;
     UTF8* dstEnd = (dst + dstMaxBytes) - 1;
     o_assert(dstEnd > dst);
+
+    // fast path, on failure fall through to ConvertUTF which provides the detailed error
+    const int32 dstMaxChars = (int32) (dstEnd - dst);
+    int32 numBytes = InvalidIndex;
+    if (sizeof(wchar_t) == 4) {
+        numBytes = simdUTF::UTF32ToUTF8((const uint32*) src, srcNumChars, dst, dstMaxChars);
+    }
+    else {
+        numBytes = simdUTF::UTF16ToUTF8((const uint16*) src, srcNumChars, dst, dstMaxChars);
+    }
+    if (InvalidIndex != numBytes) {
+        dst[numBytes] = 0;
+        return numBytes + 1;
+    }
+
+    // slow path
     if (sizeof(wchar_t) == 4) {
         o_assert(4 == sizeof(wchar_t));
         const UTF32* srcPtr = (const UTF32*) src;
@@ -98,6 +126,19 @@ StringConverter::WideToUTF8(const wchar_t* src, int32 srcNumChars, unsigned char
     return result;
 }
 
+//------------------------------------------------------------------------------
+bool
+StringConverter::IsValidUTF8(const unsigned char* src, int32 srcNumBytes) {
+    o_assert(0 != src);
+    return simdUTF::ValidateUTF8(src, srcNumBytes);
+}
+
+//------------------------------------------------------------------------------
+bool
+StringConverter::IsValidUTF8(const String& src) {
+    return IsValidUTF8((const unsigned char*) src.AsCStr(), src.Length());
+}
+
 //------------------------------------------------------------------------------
 String
 StringConverter::WideToUTF8(const wchar_t* wide, int32 numWideChars) {
@@ -8,6 +8,11 @@
     and from and to simple types (int, float, ...). Please note that
     wchar_t is 2 bytes (UTF-16) on Windows, but 4 bytes (UTF-32) 
     on other UNIX-like platforms!
+
+    UTF-8 validation and conversion use SSE/AVX2/NEON code paths
+    which are selected at runtime (see CpuFeatures), invalid input
+    is rejected (strict conversion, no overlongs, surrogates
+    or code points above U+10FFFF).
 */
 #include "Core/Types.h"
 #include "Core/Containers/Array.h"
@@ -24,6 +29,10 @@ public:
     /// convert a string to simple type
     template<class TYPE> static TYPE FromString(const String& str);
     
+    /// check if a raw byte range is valid UTF-8
+    static bool IsValidUTF8(const unsigned char* src, int32 srcNumBytes);
+    /// check if a string object contains valid UTF-8
+    static bool IsValidUTF8(const String& src);
     /// convert raw UTF8 string range to raw wide string
     static int32 UTF8ToWide(const unsigned char* src, int32 srcNumBytes, wchar_t* dst, int32 dstMaxBytes);
     /// convert raw wide string range to raw UTF8 string
@@ -0,0 +1,574 @@
+//------------------------------------------------------------------------------
+//  simdScan.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "simdScan.h"
+#include "Core/CpuFeatures.h"
+#include <cstring>
+#if ORYOL_SIMD_SSE
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#if ORYOL_WINDOWS
+#include <intrin.h>
+#endif
+#elif ORYOL_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace Oryol {
+namespace Core {
+
+//------------------------------------------------------------------------------
+/**
+    A set of bytes, as a 256-bit bitmap for the scalar code, and as
+    2 nibble lookup tables for the SIMD code.
+*/
+struct byteSet {
+    uint32 bits[8];
+    alignas(16) uint8 loTable[16];
+    alignas(16) uint8 hiTable[16];
+    bool simdCapable;
+
+    /// test if a byte is in the set
+    bool Contains(uint8 c) const {
+        return 0 != (this->bits[c >> 5] & (1 << (c & 31)));
+    }
+};
+
+//------------------------------------------------------------------------------
+static void
+buildByteSet(const uint8* chars, int32 numChars, byteSet& set) {
+    std::memset(&set, 0, sizeof(set));
+    for (int32 i = 0; i < numChars; i++) {
+        const uint8 c = chars[i];
+        set.bits[c >> 5] |= (1 << (c & 31));
+    }
+
+    // assign one bit per distinct high nibble
+    int32 numGroups = 0;
+    for (int32 hi = 0; hi < 16; hi++) {
+        bool used = false;
+        for (int32 lo = 0; lo < 16; lo++) {
+            if (set.Contains((uint8)((hi << 4) | lo))) {
+                used = true;
+                break;
+            }
+        }
+        if (used) {
+            if (numGroups == 8) {
+                // too many distinct high nibbles, scalar only
+                return;
+            }
+            const uint8 bit = (uint8) (1 << numGroups++);
+            set.hiTable[hi] = bit;
+            for (int32 lo = 0; lo < 16; lo++) {
+                if (set.Contains((uint8)((hi << 4) | lo))) {
+                    set.loTable[lo] |= bit;
+                }
+            }
+        }
+    }
+    set.simdCapable = true;
+}
+
+//------------------------------------------------------------------------------
+static void
+buildByteSet(const char* delims, byteSet& set) {
+    buildByteSet((const uint8*) delims, (int32) std::strlen(delims), set);
+}
+
+//------------------------------------------------------------------------------
+/**
+    The RFC 3986 unreserved characters, these are not percent-encoded.
+*/
+static const byteSet&
+unreservedSet() {
+    static const struct unreserved {
+        byteSet set;
+        unreserved() {
+            buildByteSet("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-._~", this->set);
+        }
+    } u;
+    return u.set;
+}
+
+//------------------------------------------------------------------------------
+static inline int32
+hexValue(uint8 c) {
+    if ((c >= '0') && (c <= '9')) return c - '0';
+    if ((c >= 'A') && (c <= 'F')) return c - 'A' + 10;
+    if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+static inline char*
+encodeChar(uint8 c, char* out) {
+    static const char* hexDigits = "0123456789ABCDEF";
+    out[0] = '%';
+    out[1] = hexDigits[c >> 4];
+    out[2] = hexDigits[c & 0x0F];
+    return out + 3;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Decode the percent-sequence at src[i] (which must be a '%'), returns
+    number of consumed source bytes. Malformed sequences are copied as is.
+*/
+static inline int32
+decodeChar(const char* src, int32 i, int32 len, char* out) {
+    if ((i + 2) < len) {
+        const int32 hi = hexValue((uint8)src[i + 1]);
+        const int32 lo = hexValue((uint8)src[i + 2]);
+        if ((hi >= 0) && (lo >= 0)) {
+            *out = (char) ((hi << 4) | lo);
+            return 3;
+        }
+    }
+    *out = '%';
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+static int32
+findInSetScalar(const uint8* str, int32 len, const byteSet& set, bool member) {
+    for (int32 i = 0; i < len; i++) {
+        if (set.Contains(str[i]) == member) {
+            return i;
+        }
+    }
+    return InvalidIndex;
+}
+
+//------------------------------------------------------------------------------
+static int32
+encodeScalar(const char* src, int32 len, char* dst, const byteSet& unreserved) {
+    char* out = dst;
+    for (int32 i = 0; i < len; i++) {
+        const uint8 c = (uint8) src[i];
+        if (unreserved.Contains(c)) {
+            *out++ = (char) c;
+        }
+        else {
+            out = encodeChar(c, out);
+        }
+    }
+    return (int32) (out - dst);
+}
+
+//------------------------------------------------------------------------------
+static int32
+decodeScalar(const char* src, int32 len, char* dst) {
+    char* out = dst;
+    int32 i = 0;
+    while (i < len) {
+        if ('%' == src[i]) {
+            i += decodeChar(src, i, len, out++);
+        }
+        else {
+            *out++ = src[i++];
+        }
+    }
+    return (int32) (out - dst);
+}
+
+//------------------------------------------------------------------------------
+static int32
+findSubStringScalar(const char* str, int32 strLen, int32 limit, const char* subStr, int32 subStrLen) {
+    const int32 last = strLen - subStrLen;
+    const char first = subStr[0];
+    for (int32 i = 0; (i < limit) && (i <= last); i++) {
+        if ((first == str[i]) && (0 == std::memcmp(str + i + 1, subStr + 1, subStrLen - 1))) {
+            return i;
+        }
+    }
+    return InvalidIndex;
+}
+
+//------------------------------------------------------------------------------
+static inline int32
+firstBit(uint32 mask) {
+    #if ORYOL_WINDOWS
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int32) index;
+    #else
+    return __builtin_ctz(mask);
+    #endif
+}
+
+//------------------------------------------------------------------------------
+/**
+    Percent-encode a 16-byte block, bits in reservedMask are set for
+    every byte which must be encoded.
+*/
+static inline char*
+encodeBlock(const char* src, uint32 reservedMask, char* out) {
+    int32 pos = 0;
+    while (0 != reservedMask) {
+        const int32 n = firstBit(reservedMask);
+        std::memcpy(out, src + pos, n - pos);
+        out = encodeChar((uint8)src[n], out + (n - pos));
+        pos = n + 1;
+        reservedMask &= reservedMask - 1;
+    }
+    std::memcpy(out, src + pos, 16 - pos);
+    return out + (16 - pos);
+}
+
+#if ORYOL_SIMD_SSE
+//------------------------------------------------------------------------------
+static bool
+useSIMD() {
+    static const bool ssse3 = CpuFeatures::Has(CpuFeatures::SSSE3);
+    return ssse3;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Return a 16-bit mask with a bit set for every byte which is in the set.
+*/
+ORYOL_SIMD_TARGET("ssse3") static inline uint32
+classify(__m128i v, __m128i loTable, __m128i hiTable) {
+    const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+    const __m128i lo = _mm_shuffle_epi8(loTable, _mm_and_si128(v, nibbleMask));
+    const __m128i hi = _mm_shuffle_epi8(hiTable, _mm_and_si128(_mm_srli_epi16(v, 4), nibbleMask));
+    const __m128i nonMember = _mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128());
+    return (~_mm_movemask_epi8(nonMember)) & 0xFFFF;
+}
+
+//------------------------------------------------------------------------------
+ORYOL_SIMD_TARGET("ssse3") static int32
+findInSetSIMD(const uint8* str, int32 len, const byteSet& set, bool member) {
+    const __m128i loTable = _mm_load_si128((const __m128i*)set.loTable);
+    const __m128i hiTable = _mm_load_si128((const __m128i*)set.hiTable);
+    const uint32 flip = member ? 0 : 0xFFFF;
+    int32 i = 0;
+    for (; (i + 16) <= len; i += 16) {
+        const uint32 mask = classify(_mm_loadu_si128((const __m128i*)(str + i)), loTable, hiTable) ^ flip;
+        if (0 != mask) {
+            return i + firstBit(mask);
+        }
+    }
+    const int32 res = findInSetScalar(str + i, len - i, set, member);
+    return (InvalidIndex == res) ? InvalidIndex : (i + res);
+}
+
+//------------------------------------------------------------------------------
+static int32
+findSubStringSIMD(const char* str, int32 strLen, int32 limit, const char* subStr, int32 subStrLen) {
+    const __m128i first = _mm_set1_epi8(subStr[0]);
+    const __m128i last = _mm_set1_epi8(subStr[subStrLen - 1]);
+    int32 i = 0;
+    for (; (i < limit) && ((i + subStrLen - 1 + 16) <= strLen); i += 16) {
+        const __m128i blockFirst = _mm_loadu_si128((const __m128i*)(str + i));
+        const __m128i blockLast = _mm_loadu_si128((const __m128i*)(str + i + subStrLen - 1));
+        uint32 mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last)));
+        while (0 != mask) {
+            const int32 pos = i + firstBit(mask);
+            if (pos >= limit) {
+                return InvalidIndex;
+            }
+            if ((subStrLen <= 2) || (0 == std::memcmp(str + pos + 1, subStr + 1, subStrLen - 2))) {
+                return pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+    if (i >= limit) {
+        return InvalidIndex;
+    }
+    const int32 res = findSubStringScalar(str + i, strLen - i, limit - i, subStr, subStrLen);
+    return (InvalidIndex == res) ? InvalidIndex : (i + res);
+}
+
+//------------------------------------------------------------------------------
+ORYOL_SIMD_TARGET("ssse3") static int32
+encodeSIMD(const char* src, int32 len, char* dst, const byteSet& unreserved) {
+    const __m128i loTable = _mm_load_si128((const __m128i*)unreserved.loTable);
+    const __m128i hiTable = _mm_load_si128((const __m128i*)unreserved.hiTable);
+    char* out = dst;
+    int32 i = 0;
+    while ((i + 16) <= len) {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        const uint32 reserved = classify(v, loTable, hiTable) ^ 0xFFFF;
+        if (0 == reserved) {
+            _mm_storeu_si128((__m128i*)out, v);
+            out += 16;
+            i += 16;
+        }
+        else {
+            out = encodeBlock(src + i, reserved, out);
+            i += 16;
+        }
+    }
+    return (int32) (out - dst) + encodeScalar(src + i, len - i, out, unreserved);
+}
+
+//------------------------------------------------------------------------------
+static int32
+decodeSIMD(const char* src, int32 len, char* dst) {
+    const __m128i percent = _mm_set1_epi8('%');
+    char* out = dst;
+    int32 i = 0;
+    while ((i + 16) <= len) {
+        // NOTE: out is never ahead of src, so the 16-byte store is safe for in-place decoding
+        const __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        const uint32 mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, percent));
+        if (0 == mask) {
+            _mm_storeu_si128((__m128i*)out, v);
+            out += 16;
+            i += 16;
+        }
+        else {
+            // a full store could overwrite the escape sequence when decoding in-place
+            const int32 n = firstBit(mask);
+            std::memmove(out, src + i, n);
+            out += n;
+            i += n;
+            i += decodeChar(src, i, len, out++);
+        }
+    }
+    return (int32) (out - dst) + decodeScalar(src + i, len - i, out);
+}
+#elif ORYOL_SIMD_NEON
+//------------------------------------------------------------------------------
+static bool
+useSIMD() {
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+    NEON has no movemask, narrow each byte to a nibble instead, so that
+    the result is a 64-bit mask with 4 bits per byte.
+*/
+static inline uint64
+nibbleMask(uint8x16_t cmp) {
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4)), 0);
+}
+
+//------------------------------------------------------------------------------
+static inline int32
+firstNibble(uint64 mask) {
+    return __builtin_ctzll(mask) >> 2;
+}
+
+//------------------------------------------------------------------------------
+static inline uint8x16_t
+classify(uint8x16_t v, uint8x16_t loTable, uint8x16_t hiTable) {
+    const uint8x16_t lo = vqtbl1q_u8(loTable, vandq_u8(v, vdupq_n_u8(0x0F)));
+    const uint8x16_t hi = vqtbl1q_u8(hiTable, vshrq_n_u8(v, 4));
+    return vtstq_u8(lo, hi);
+}
+
+//------------------------------------------------------------------------------
+static int32
+findInSetSIMD(const uint8* str, int32 len, const byteSet& set, bool member) {
+    const uint8x16_t loTable = vld1q_u8(set.loTable);
+    const uint8x16_t hiTable = vld1q_u8(set.hiTable);
+    int32 i = 0;
+    for (; (i + 16) <= len; i += 16) {
+        uint8x16_t m = classify(vld1q_u8(str + i), loTable, hiTable);
+        if (!member) {
+            m = vmvnq_u8(m);
+        }
+        const uint64 mask = nibbleMask(m);
+        if (0 != mask) {
+            return i + firstNibble(mask);
+        }
+    }
+    const int32 res = findInSetScalar(str + i, len - i, set, member);
+    return (InvalidIndex == res) ? InvalidIndex : (i + res);
+}
+
+//------------------------------------------------------------------------------
+static int32
+findSubStringSIMD(const char* str, int32 strLen, int32 limit, const char* subStr, int32 subStrLen) {
+    const uint8x16_t first = vdupq_n_u8((uint8)subStr[0]);
+    const uint8x16_t last = vdupq_n_u8((uint8)subStr[subStrLen - 1]);
+    int32 i = 0;
+    for (; (i < limit) && ((i + subStrLen - 1 + 16) <= strLen); i += 16) {
+        const uint8x16_t blockFirst = vld1q_u8((const uint8*)(str + i));
+        const uint8x16_t blockLast = vld1q_u8((const uint8*)(str + i + subStrLen - 1));
+        uint64 mask = nibbleMask(vandq_u8(vceqq_u8(blockFirst, first), vceqq_u8(blockLast, last)));
+        while (0 != mask) {
+            const int32 pos = i + firstNibble(mask);
+            if (pos >= limit) {
+                return InvalidIndex;
+            }
+            if ((subStrLen <= 2) || (0 == std::memcmp(str + pos + 1, subStr + 1, subStrLen - 2))) {
+                return pos;
+            }
+            mask &= ~(uint64(0xF) << ((pos - i) * 4));
+        }
+    }
+    if (i >= limit) {
+        return InvalidIndex;
+    }
+    const int32 res = findSubStringScalar(str + i, strLen - i, limit - i, subStr, subStrLen);
+    return (InvalidIndex == res) ? InvalidIndex : (i + res);
+}
+
+//------------------------------------------------------------------------------
+static int32
+encodeSIMD(const char* src, int32 len, char* dst, const byteSet& unreserved) {
+    const uint8x16_t loTable = vld1q_u8(unreserved.loTable);
+    const uint8x16_t hiTable = vld1q_u8(unreserved.hiTable);
+    char* out = dst;
+    int32 i = 0;
+    while ((i + 16) <= len) {
+        const uint8x16_t v = vld1q_u8((const uint8*)(src + i));
+        const uint64 reserved = nibbleMask(vmvnq_u8(classify(v, loTable, hiTable)));
+        if (0 == reserved) {
+            vst1q_u8((uint8*)out, v);
+            out += 16;
+            i += 16;
+        }
+        else {
+            // compress the 4-bit-per-byte mask to 1 bit per byte
+            uint32 mask = 0;
+            for (int32 j = 0; j < 16; j++) {
+                mask |= ((reserved >> (j * 4)) & 1) << j;
+            }
+            out = encodeBlock(src + i, mask, out);
+            i += 16;
+        }
+    }
+    return (int32) (out - dst) + encodeScalar(src + i, len - i, out, unreserved);
+}
+
+//------------------------------------------------------------------------------
+static int32
+decodeSIMD(const char* src, int32 len, char* dst) {
+    const uint8x16_t percent = vdupq_n_u8('%');
+    char* out = dst;
+    int32 i = 0;
+    while ((i + 16) <= len) {
+        const uint8x16_t v = vld1q_u8((const uint8*)(src + i));
+        const uint64 mask = nibbleMask(vceqq_u8(v, percent));
+        if (0 == mask) {
+            vst1q_u8((uint8*)out, v);
+            out += 16;
+            i += 16;
+        }
+        else {
+            const int32 n = firstNibble(mask);
+            std::memmove(out, src + i, n);
+            out += n;
+            i += n;
+            i += decodeChar(src, i, len, out++);
+        }
+    }
+    return (int32) (out - dst) + decodeScalar(src + i, len - i, out);
+}
+#endif
+
+#if ORYOL_SIMD_SSE || ORYOL_SIMD_NEON
+#define ORYOL_SIMD_SCAN (1)
+#else
+#define ORYOL_SIMD_SCAN (0)
+#endif
+
+//------------------------------------------------------------------------------
+int32
+simdScan::FindFirstOfScalar(const char* str, int32 len, const char* delims) {
+    byteSet set;
+    buildByteSet(delims, set);
+    return findInSetScalar((const uint8*)str, len, set, true);
+}
+
+//------------------------------------------------------------------------------
+int32
+simdScan::FindFirstNotOfScalar(const char* str, int32 len, const char* delims) {
+    byteSet set;
+    buildByteSet(delims, set);
+    return findInSetScalar((const uint8*)str, len, set, false);
+}
+
+//------------------------------------------------------------------------------
+int32
+simdScan::FindSubStringScalar(const char* str, int32 strLen, int32 limit, const char* subStr, int32 subStrLen) {
+    if (0 == subStrLen) {
+        return (limit > 0) ? 0 : InvalidIndex;
+    }
+    return findSubStringScalar(str, strLen, limit, subStr, subStrLen);
+}
+
+//------------------------------------------------------------------------------
+int32
+simdScan::PercentEncodeScalar(const char* src, int32 len, char* dst) {
+    return encodeScalar(src, len, dst, unreservedSet());
+}
+
+//------------------------------------------------------------------------------
+int32
+simdScan::PercentDecodeScalar(const char* src, int32 len, char* dst) {
+    return decodeScalar(src, len, dst);
+}
+
+//------------------------------------------------------------------------------
+int32
+simdScan::FindFirstOf(const char* str, int32 len, const char* delims) {
+    byteSet set;
+    buildByteSet(delims, set);
+    #if ORYOL_SIMD_SCAN
+    if ((len >= MinSimdLength) && set.simdCapable && useSIMD()) {
+        return findInSetSIMD((const uint8*)str, len, set, true);
+    }
+    #endif
+    return findInSetScalar((const uint8*)str, len, set, true);
+}
+
+//------------------------------------------------------------------------------
+int32
+simdScan::FindFirstNotOf(const char* str, int32 len, const char* delims) {
+    byteSet set;
+    buildByteSet(delims, set);
+    #if ORYOL_SIMD_SCAN
+    if ((len >= MinSimdLength) && set.simdCapable && useSIMD()) {
+        return findInSetSIMD((const uint8*)str, len, set, false);
+    }
+    #endif
+    return findInSetScalar((const uint8*)str, len, set, false);
+}
+
+//------------------------------------------------------------------------------
+int32
+simdScan::FindSubString(const char* str, int32 strLen, int32 limit, const char* subStr, int32 subStrLen) {
+    if (0 == subStrLen) {
+        return (limit > 0) ? 0 : InvalidIndex;
+    }
+    #if ORYOL_SIMD_SCAN
+    if ((strLen >= MinSimdLength) && useSIMD()) {
+        return findSubStringSIMD(str, strLen, limit, subStr, subStrLen);
+    }
+    #endif
+    return findSubStringScalar(str, strLen, limit, subStr, subStrLen);
+}
+
+//------------------------------------------------------------------------------
+int32
+simdScan::PercentEncode(const char* src, int32 len, char* dst) {
+    #if ORYOL_SIMD_SCAN
+    if ((len >= MinSimdLength) && useSIMD()) {
+        return encodeSIMD(src, len, dst, unreservedSet());
+    }
+    #endif
+    return encodeScalar(src, len, dst, unreservedSet());
+}
+
+//------------------------------------------------------------------------------
+int32
+simdScan::PercentDecode(const char* src, int32 len, char* dst) {
+    #if ORYOL_SIMD_SCAN
+    if ((len >= MinSimdLength) && useSIMD()) {
+        return decodeSIMD(src, len, dst);
+    }
+    #endif
+    return decodeScalar(src, len, dst);
+}
+
+} // namespace Core
+} // namespace Oryol
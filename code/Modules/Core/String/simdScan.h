@@ -0,0 +1,55 @@
+#pragma once
+//------------------------------------------------------------------------------
+/*
+    private class, do not use
+
+    SIMD accelerated scan primitives for StringBuilder.
+
+    Character set searches (FindFirstOf, FindFirstNotOf, percent-encoding)
+    classify 16 bytes at once with a pshufb nibble lookup: each distinct
+    high nibble in the set gets one bit, a byte is a member if the bit
+    of its high nibble is set in the table entry of its low nibble. This
+    works for sets with up to 8 distinct high nibbles, larger sets fall
+    back to the scalar code. Substring search compares the first and
+    last character of the needle against 16 positions at once and only
+    verifies the candidates (memchr-style).
+
+    Strings shorter than MinSimdLength and CPUs without SSSE3 or NEON
+    use the scalar implementations, which are public for testing.
+    All ranges are explicit, the functions never look for a terminating 0.
+*/
+#include "Core/Types.h"
+
+namespace Oryol {
+namespace Core {
+
+class simdScan {
+public:
+    /// find first byte in [0, len) which is in delims, InvalidIndex if not found
+    static int32 FindFirstOf(const char* str, int32 len, const char* delims);
+    /// find first byte in [0, len) which is not in delims, InvalidIndex if not found
+    static int32 FindFirstNotOf(const char* str, int32 len, const char* delims);
+    /// find first occurrence of subStr starting before limit, str must have strLen valid bytes
+    static int32 FindSubString(const char* str, int32 strLen, int32 limit, const char* subStr, int32 subStrLen);
+    /// percent-encode (RFC 3986, everything but unreserved chars), dst needs room for 3*len bytes, returns new length
+    static int32 PercentEncode(const char* src, int32 len, char* dst);
+    /// percent-decode, dst may be identical with src (in-place), returns new length
+    static int32 PercentDecode(const char* src, int32 len, char* dst);
+
+    /// scalar version of FindFirstOf
+    static int32 FindFirstOfScalar(const char* str, int32 len, const char* delims);
+    /// scalar version of FindFirstNotOf
+    static int32 FindFirstNotOfScalar(const char* str, int32 len, const char* delims);
+    /// scalar version of FindSubString
+    static int32 FindSubStringScalar(const char* str, int32 strLen, int32 limit, const char* subStr, int32 subStrLen);
+    /// scalar version of PercentEncode
+    static int32 PercentEncodeScalar(const char* src, int32 len, char* dst);
+    /// scalar version of PercentDecode
+    static int32 PercentDecodeScalar(const char* src, int32 len, char* dst);
+
+    /// strings shorter than this are always handled by the scalar code
+    static const int32 MinSimdLength = 16;
+};
+
+} // namespace Core
+} // namespace Oryol
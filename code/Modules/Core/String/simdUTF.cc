@@ -0,0 +1,932 @@
+//------------------------------------------------------------------------------
+//  simdUTF.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "simdUTF.h"
+#include "Core/CpuFeatures.h"
+#include <cstring>
+#if ORYOL_SIMD_SSE
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <immintrin.h>
+#elif ORYOL_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace Oryol {
+namespace Core {
+
+// error bits of the lookup-table validator, each bit marks a forbidden
+// combination of the high/low nibble of the previous byte and
+// the high nibble of the current byte
+static const uint8 TooShort     = 1<<0;    // 11______ 0_______ or 11______ 11______
+static const uint8 TooLong      = 1<<1;    // 0_______ 10______
+static const uint8 Overlong3    = 1<<2;    // 11100000 100_____
+static const uint8 TooLarge     = 1<<3;    // 11110100 1001____ and above
+static const uint8 Surrogate    = 1<<4;    // 11101101 101_____
+static const uint8 Overlong2    = 1<<5;    // 1100000_ 10______
+static const uint8 TooLarge1000 = 1<<6;    // 11110101 1000____ and above
+static const uint8 Overlong4    = 1<<6;    // 11110000 1000____
+static const uint8 TwoConts     = 1<<7;    // 10______ 10______
+static const uint8 Carry        = TooShort | TooLong | TwoConts;
+
+// lookup by high nibble of previous byte
+alignas(16) static const uint8 byte1HighTable[16] = {
+    TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong,
+    TwoConts, TwoConts, TwoConts, TwoConts,
+    TooShort | Overlong2,
+    TooShort,
+    TooShort | Overlong3 | Surrogate,
+    TooShort | TooLarge | TooLarge1000 | Overlong4
+};
+// lookup by low nibble of previous byte
+alignas(16) static const uint8 byte1LowTable[16] = {
+    Carry | Overlong3 | Overlong2 | Overlong4,
+    Carry | Overlong2,
+    Carry,
+    Carry,
+    Carry | TooLarge,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000 | Surrogate,
+    Carry | TooLarge | TooLarge1000,
+    Carry | TooLarge | TooLarge1000
+};
+// lookup by high nibble of current byte
+alignas(16) static const uint8 byte2HighTable[16] = {
+    TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort,
+    TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge1000 | Overlong4,
+    TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge,
+    TooLong | Overlong2 | TwoConts | Surrogate | TooLarge,
+    TooLong | Overlong2 | TwoConts | Surrogate | TooLarge,
+    TooShort, TooShort, TooShort, TooShort
+};
+// a block is 'incomplete' if one of the last 3 bytes starts a sequence
+// which continues in the next block
+alignas(32) static const uint8 incompleteTable[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1
+};
+
+//------------------------------------------------------------------------------
+//  scalar helpers, these are also used for the multi-byte parts
+//  of the SIMD code paths
+//------------------------------------------------------------------------------
+static inline uint32
+decodeValidated(const uint8*& p) {
+    const uint32 c = p[0];
+    if (c < 0x80) {
+        p += 1;
+        return c;
+    }
+    else if (c < 0xE0) {
+        const uint32 cp = ((c & 0x1F) << 6) | (p[1] & 0x3F);
+        p += 2;
+        return cp;
+    }
+    else if (c < 0xF0) {
+        const uint32 cp = ((c & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F);
+        p += 3;
+        return cp;
+    }
+    else {
+        const uint32 cp = ((c & 0x07) << 18) | ((p[1] & 0x3F) << 12) | ((p[2] & 0x3F) << 6) | (p[3] & 0x3F);
+        p += 4;
+        return cp;
+    }
+}
+
+//------------------------------------------------------------------------------
+static inline bool
+putUTF16(uint32 cp, uint16*& out, const uint16* outEnd) {
+    if (cp < 0x10000) {
+        if (out >= outEnd) {
+            return false;
+        }
+        *out++ = (uint16) cp;
+    }
+    else {
+        if ((outEnd - out) < 2) {
+            return false;
+        }
+        cp -= 0x10000;
+        *out++ = (uint16) (0xD800 + (cp >> 10));
+        *out++ = (uint16) (0xDC00 + (cp & 0x3FF));
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+static inline bool
+putUTF8(uint32 cp, uint8*& out, const uint8* outEnd) {
+    if (cp < 0x80) {
+        if (out >= outEnd) {
+            return false;
+        }
+        *out++ = (uint8) cp;
+    }
+    else if (cp < 0x800) {
+        if ((outEnd - out) < 2) {
+            return false;
+        }
+        *out++ = (uint8) (0xC0 | (cp >> 6));
+        *out++ = (uint8) (0x80 | (cp & 0x3F));
+    }
+    else if (cp < 0x10000) {
+        if (((cp >= 0xD800) && (cp <= 0xDFFF)) || ((outEnd - out) < 3)) {
+            return false;
+        }
+        *out++ = (uint8) (0xE0 | (cp >> 12));
+        *out++ = (uint8) (0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (uint8) (0x80 | (cp & 0x3F));
+    }
+    else {
+        if ((cp > 0x10FFFF) || ((outEnd - out) < 4)) {
+            return false;
+        }
+        *out++ = (uint8) (0xF0 | (cp >> 18));
+        *out++ = (uint8) (0x80 | ((cp >> 12) & 0x3F));
+        *out++ = (uint8) (0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (uint8) (0x80 | (cp & 0x3F));
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Encode one UTF-16 code unit (or surrogate pair) to UTF-8, lone
+    surrogates are illegal.
+*/
+static inline bool
+putUTF16AsUTF8(const uint16*& p, const uint16* end, uint8*& out, const uint8* outEnd) {
+    uint32 c = *p++;
+    if ((c >= 0xD800) && (c <= 0xDBFF)) {
+        if ((p >= end) || (*p < 0xDC00) || (*p > 0xDFFF)) {
+            return false;
+        }
+        c = 0x10000 + ((c - 0xD800) << 10) + (*p++ - 0xDC00);
+    }
+    else if ((c >= 0xDC00) && (c <= 0xDFFF)) {
+        return false;
+    }
+    return putUTF8(c, out, outEnd);
+}
+
+//------------------------------------------------------------------------------
+static bool
+validateScalar(const uint8* src, int32 numBytes) {
+    const uint8* p = src;
+    const uint8* end = src + numBytes;
+    while (p < end) {
+        // skip ASCII 8 bytes at a time
+        while ((end - p) >= 8) {
+            uint64 chunk;
+            std::memcpy(&chunk, p, sizeof(chunk));
+            if (0 != (chunk & 0x8080808080808080ULL)) {
+                break;
+            }
+            p += 8;
+        }
+        if (p >= end) {
+            break;
+        }
+        const uint8 c = *p;
+        if (c < 0x80) {
+            p++;
+            continue;
+        }
+        int32 len = 0;
+        uint8 lo = 0x80;
+        uint8 hi = 0xBF;
+        if ((c >= 0xC2) && (c <= 0xDF)) {
+            len = 2;
+        }
+        else if ((c >= 0xE0) && (c <= 0xEF)) {
+            len = 3;
+            if (0xE0 == c) lo = 0xA0;
+            else if (0xED == c) hi = 0x9F;
+        }
+        else if ((c >= 0xF0) && (c <= 0xF4)) {
+            len = 4;
+            if (0xF0 == c) lo = 0x90;
+            else if (0xF4 == c) hi = 0x8F;
+        }
+        else {
+            return false;
+        }
+        if ((end - p) < len) {
+            return false;
+        }
+        if ((p[1] < lo) || (p[1] > hi)) {
+            return false;
+        }
+        for (int32 i = 2; i < len; i++) {
+            if (0x80 != (p[i] & 0xC0)) {
+                return false;
+            }
+        }
+        p += len;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+static int32
+utf8ToUTF32Scalar(const uint8* src, int32 numBytes, uint32* dst, int32 dstMaxChars) {
+    if (!validateScalar(src, numBytes)) {
+        return InvalidIndex;
+    }
+    const uint8* p = src;
+    const uint8* end = src + numBytes;
+    uint32* out = dst;
+    const uint32* outEnd = dst + dstMaxChars;
+    while (p < end) {
+        if (out >= outEnd) {
+            return InvalidIndex;
+        }
+        *out++ = decodeValidated(p);
+    }
+    return (int32) (out - dst);
+}
+
+//------------------------------------------------------------------------------
+static int32
+utf8ToUTF16Scalar(const uint8* src, int32 numBytes, uint16* dst, int32 dstMaxChars) {
+    if (!validateScalar(src, numBytes)) {
+        return InvalidIndex;
+    }
+    const uint8* p = src;
+    const uint8* end = src + numBytes;
+    uint16* out = dst;
+    const uint16* outEnd = dst + dstMaxChars;
+    while (p < end) {
+        if (!putUTF16(decodeValidated(p), out, outEnd)) {
+            return InvalidIndex;
+        }
+    }
+    return (int32) (out - dst);
+}
+
+//------------------------------------------------------------------------------
+static int32
+utf32ToUTF8Scalar(const uint32* src, int32 numChars, uint8* dst, int32 dstMaxBytes) {
+    uint8* out = dst;
+    const uint8* outEnd = dst + dstMaxBytes;
+    for (int32 i = 0; i < numChars; i++) {
+        if (!putUTF8(src[i], out, outEnd)) {
+            return InvalidIndex;
+        }
+    }
+    return (int32) (out - dst);
+}
+
+//------------------------------------------------------------------------------
+static int32
+utf16ToUTF8Scalar(const uint16* src, int32 numChars, uint8* dst, int32 dstMaxBytes) {
+    const uint16* p = src;
+    const uint16* end = src + numChars;
+    uint8* out = dst;
+    const uint8* outEnd = dst + dstMaxBytes;
+    while (p < end) {
+        if (!putUTF16AsUTF8(p, end, out, outEnd)) {
+            return InvalidIndex;
+        }
+    }
+    return (int32) (out - dst);
+}
+
+#if ORYOL_SIMD_SSE
+//------------------------------------------------------------------------------
+//  SSE2 / SSSE3 / AVX2 code paths
+//------------------------------------------------------------------------------
+ORYOL_SIMD_TARGET("ssse3") static inline __m128i
+checkBlockSSSE3(__m128i input, __m128i prevInput) {
+    const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+    const __m128i prev1 = _mm_alignr_epi8(input, prevInput, 15);
+    const __m128i prev2 = _mm_alignr_epi8(input, prevInput, 14);
+    const __m128i prev3 = _mm_alignr_epi8(input, prevInput, 13);
+    const __m128i byte1High = _mm_shuffle_epi8(_mm_load_si128((const __m128i*)byte1HighTable),
+        _mm_and_si128(_mm_srli_epi16(prev1, 4), nibbleMask));
+    const __m128i byte1Low = _mm_shuffle_epi8(_mm_load_si128((const __m128i*)byte1LowTable),
+        _mm_and_si128(prev1, nibbleMask));
+    const __m128i byte2High = _mm_shuffle_epi8(_mm_load_si128((const __m128i*)byte2HighTable),
+        _mm_and_si128(_mm_srli_epi16(input, 4), nibbleMask));
+    const __m128i special = _mm_and_si128(_mm_and_si128(byte1High, byte1Low), byte2High);
+
+    // the 3rd and 4th byte of a sequence must be continuation bytes,
+    // only bytes >= 0xE0 (or >= 0xF0) 'survive' the saturating subtract with the high bit set
+    const __m128i isThird = _mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80));
+    const __m128i isFourth = _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80));
+    const __m128i must23 = _mm_and_si128(_mm_or_si128(isThird, isFourth), _mm_set1_epi8((char)0x80));
+    return _mm_xor_si128(must23, special);
+}
+
+//------------------------------------------------------------------------------
+ORYOL_SIMD_TARGET("ssse3") static bool
+validateSSSE3(const uint8* src, int32 numBytes) {
+    const __m128i maxValue = _mm_loadu_si128((const __m128i*)(incompleteTable + 16));
+    __m128i error = _mm_setzero_si128();
+    __m128i prevInput = _mm_setzero_si128();
+    __m128i prevIncomplete = _mm_setzero_si128();
+    int32 i = 0;
+    alignas(16) uint8 tail[16];
+    while (i < numBytes) {
+        __m128i input;
+        if ((numBytes - i) >= 16) {
+            input = _mm_loadu_si128((const __m128i*)(src + i));
+        }
+        else {
+            std::memset(tail, 0, sizeof(tail));
+            std::memcpy(tail, src + i, numBytes - i);
+            input = _mm_load_si128((const __m128i*)tail);
+        }
+        if (0 == _mm_movemask_epi8(input)) {
+            error = _mm_or_si128(error, prevIncomplete);
+            prevIncomplete = _mm_setzero_si128();
+        }
+        else {
+            error = _mm_or_si128(error, checkBlockSSSE3(input, prevInput));
+            prevIncomplete = _mm_subs_epu8(input, maxValue);
+        }
+        prevInput = input;
+        i += 16;
+    }
+    error = _mm_or_si128(error, prevIncomplete);
+    return 0xFFFF == _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128()));
+}
+
+//------------------------------------------------------------------------------
+ORYOL_SIMD_TARGET("avx2") static inline __m256i
+checkBlockAVX2(__m256i input, __m256i prevInput) {
+    const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+    // shift the previous 32-byte block across the 128-bit lane boundary
+    const __m256i carried = _mm256_permute2x128_si256(prevInput, input, 0x21);
+    const __m256i prev1 = _mm256_alignr_epi8(input, carried, 16 - 1);
+    const __m256i prev2 = _mm256_alignr_epi8(input, carried, 16 - 2);
+    const __m256i prev3 = _mm256_alignr_epi8(input, carried, 16 - 3);
+    const __m256i t1h = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)byte1HighTable));
+    const __m256i t1l = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)byte1LowTable));
+    const __m256i t2h = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)byte2HighTable));
+    const __m256i byte1High = _mm256_shuffle_epi8(t1h, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibbleMask));
+    const __m256i byte1Low = _mm256_shuffle_epi8(t1l, _mm256_and_si256(prev1, nibbleMask));
+    const __m256i byte2High = _mm256_shuffle_epi8(t2h, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibbleMask));
+    const __m256i special = _mm256_and_si256(_mm256_and_si256(byte1High, byte1Low), byte2High);
+    const __m256i isThird = _mm256_subs_epu8(prev2, _mm256_set1_epi8(0xE0 - 0x80));
+    const __m256i isFourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xF0 - 0x80));
+    const __m256i must23 = _mm256_and_si256(_mm256_or_si256(isThird, isFourth), _mm256_set1_epi8((char)0x80));
+    return _mm256_xor_si256(must23, special);
+}
+
+//------------------------------------------------------------------------------
+ORYOL_SIMD_TARGET("avx2") static bool
+validateAVX2(const uint8* src, int32 numBytes) {
+    const __m256i maxValue = _mm256_load_si256((const __m256i*)incompleteTable);
+    __m256i error = _mm256_setzero_si256();
+    __m256i prevInput = _mm256_setzero_si256();
+    __m256i prevIncomplete = _mm256_setzero_si256();
+    int32 i = 0;
+    alignas(32) uint8 tail[32];
+    while (i < numBytes) {
+        __m256i input;
+        if ((numBytes - i) >= 32) {
+            input = _mm256_loadu_si256((const __m256i*)(src + i));
+        }
+        else {
+            std::memset(tail, 0, sizeof(tail));
+            std::memcpy(tail, src + i, numBytes - i);
+            input = _mm256_load_si256((const __m256i*)tail);
+        }
+        if (0 == _mm256_movemask_epi8(input)) {
+            error = _mm256_or_si256(error, prevIncomplete);
+            prevIncomplete = _mm256_setzero_si256();
+        }
+        else {
+            error = _mm256_or_si256(error, checkBlockAVX2(input, prevInput));
+            prevIncomplete = _mm256_subs_epu8(input, maxValue);
+        }
+        prevInput = input;
+        i += 32;
+    }
+    error = _mm256_or_si256(error, prevIncomplete);
+    return 0 != _mm256_testz_si256(error, error);
+}
+
+//------------------------------------------------------------------------------
+static int32
+utf8ToUTF32SSE2(const uint8* src, int32 numBytes, uint32* dst, int32 dstMaxChars) {
+    const uint8* p = src;
+    const uint8* end = src + numBytes;
+    uint32* out = dst;
+    const uint32* outEnd = dst + dstMaxChars;
+    const __m128i zero = _mm_setzero_si128();
+    while (p < end) {
+        if (((end - p) >= 16) && ((outEnd - out) >= 16)) {
+            const __m128i v = _mm_loadu_si128((const __m128i*)p);
+            if (0 == _mm_movemask_epi8(v)) {
+                const __m128i lo16 = _mm_unpacklo_epi8(v, zero);
+                const __m128i hi16 = _mm_unpackhi_epi8(v, zero);
+                _mm_storeu_si128((__m128i*)(out + 0), _mm_unpacklo_epi16(lo16, zero));
+                _mm_storeu_si128((__m128i*)(out + 4), _mm_unpackhi_epi16(lo16, zero));
+                _mm_storeu_si128((__m128i*)(out + 8), _mm_unpacklo_epi16(hi16, zero));
+                _mm_storeu_si128((__m128i*)(out + 12), _mm_unpackhi_epi16(hi16, zero));
+                p += 16;
+                out += 16;
+            }
+            else {
+                // at most 16 code points start in this block, so no bounds checks needed
+                const uint8* blockEnd = p + 16;
+                while (p < blockEnd) {
+                    *out++ = decodeValidated(p);
+                }
+            }
+        }
+        else {
+            if (out >= outEnd) {
+                return InvalidIndex;
+            }
+            *out++ = decodeValidated(p);
+        }
+    }
+    return (int32) (out - dst);
+}
+
+//------------------------------------------------------------------------------
+static int32
+utf8ToUTF16SSE2(const uint8* src, int32 numBytes, uint16* dst, int32 dstMaxChars) {
+    const uint8* p = src;
+    const uint8* end = src + numBytes;
+    uint16* out = dst;
+    const uint16* outEnd = dst + dstMaxChars;
+    const __m128i zero = _mm_setzero_si128();
+    while (p < end) {
+        // a block yields at most 17 UTF-16 units (15 ASCII + surrogate pair)
+        if (((end - p) >= 16) && ((outEnd - out) >= 20)) {
+            const __m128i v = _mm_loadu_si128((const __m128i*)p);
+            if (0 == _mm_movemask_epi8(v)) {
+                _mm_storeu_si128((__m128i*)(out + 0), _mm_unpacklo_epi8(v, zero));
+                _mm_storeu_si128((__m128i*)(out + 8), _mm_unpackhi_epi8(v, zero));
+                p += 16;
+                out += 16;
+            }
+            else {
+                const uint8* blockEnd = p + 16;
+                while (p < blockEnd) {
+                    putUTF16(decodeValidated(p), out, outEnd);
+                }
+            }
+        }
+        else if (!putUTF16(decodeValidated(p), out, outEnd)) {
+            return InvalidIndex;
+        }
+    }
+    return (int32) (out - dst);
+}
+
+//------------------------------------------------------------------------------
+ORYOL_SIMD_TARGET("avx2") static int32
+utf8ToUTF32AVX2(const uint8* src, int32 numBytes, uint32* dst, int32 dstMaxChars) {
+    const uint8* p = src;
+    const uint8* end = src + numBytes;
+    uint32* out = dst;
+    const uint32* outEnd = dst + dstMaxChars;
+    while (p < end) {
+        if (((end - p) >= 32) && ((outEnd - out) >= 32)) {
+            const __m256i v = _mm256_loadu_si256((const __m256i*)p);
+            if (0 == _mm256_movemask_epi8(v)) {
+                _mm256_storeu_si256((__m256i*)(out + 0), _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(p + 0))));
+                _mm256_storeu_si256((__m256i*)(out + 8), _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(p + 8))));
+                _mm256_storeu_si256((__m256i*)(out + 16), _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(p + 16))));
+                _mm256_storeu_si256((__m256i*)(out + 24), _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(p + 24))));
+                p += 32;
+                out += 32;
+            }
+            else {
+                const uint8* blockEnd = p + 32;
+                while (p < blockEnd) {
+                    *out++ = decodeValidated(p);
+                }
+            }
+        }
+        else {
+            if (out >= outEnd) {
+                return InvalidIndex;
+            }
+            *out++ = decodeValidated(p);
+        }
+    }
+    return (int32) (out - dst);
+}
+
+//------------------------------------------------------------------------------
+ORYOL_SIMD_TARGET("avx2") static int32
+utf8ToUTF16AVX2(const uint8* src, int32 numBytes, uint16* dst, int32 dstMaxChars) {
+    const uint8* p = src;
+    const uint8* end = src + numBytes;
+    uint16* out = dst;
+    const uint16* outEnd = dst + dstMaxChars;
+    while (p < end) {
+        if (((end - p) >= 32) && ((outEnd - out) >= 36)) {
+            const __m256i v = _mm256_loadu_si256((const __m256i*)p);
+            if (0 == _mm256_movemask_epi8(v)) {
+                _mm256_storeu_si256((__m256i*)(out + 0), _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(p + 0))));
+                _mm256_storeu_si256((__m256i*)(out + 16), _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(p + 16))));
+                p += 32;
+                out += 32;
+            }
+            else {
+                const uint8* blockEnd = p + 32;
+                while (p < blockEnd) {
+                    putUTF16(decodeValidated(p), out, outEnd);
+                }
+            }
+        }
+        else if (!putUTF16(decodeValidated(p), out, outEnd)) {
+            return InvalidIndex;
+        }
+    }
+    return (int32) (out - dst);
+}
+
+//------------------------------------------------------------------------------
+static int32
+utf32ToUTF8SSE2(const uint32* src, int32 numChars, uint8* dst, int32 dstMaxBytes) {
+    const uint32* p = src;
+    const uint32* end = src + numChars;
+    uint8* out = dst;
+    const uint8* outEnd = dst + dstMaxBytes;
+    const __m128i nonASCIIMask = _mm_set1_epi32(~0x7F);
+    const __m128i zero = _mm_setzero_si128();
+    while (p < end) {
+        if (((end - p) >= 8) && ((outEnd - out) >= 8)) {
+            const __m128i a = _mm_loadu_si128((const __m128i*)(p + 0));
+            const __m128i b = _mm_loadu_si128((const __m128i*)(p + 4));
+            const __m128i nonASCII = _mm_and_si128(_mm_or_si128(a, b), nonASCIIMask);
+            if (0xFFFF == _mm_movemask_epi8(_mm_cmpeq_epi32(nonASCII, zero))) {
+                const __m128i w = _mm_packs_epi32(a, b);
+                _mm_storel_epi64((__m128i*)out, _mm_packus_epi16(w, w));
+                p += 8;
+                out += 8;
+                continue;
+            }
+        }
+        if (!putUTF8(*p++, out, outEnd)) {
+            return InvalidIndex;
+        }
+    }
+    return (int32) (out - dst);
+}
+
+//------------------------------------------------------------------------------
+static int32
+utf16ToUTF8SSE2(const uint16* src, int32 numChars, uint8* dst, int32 dstMaxBytes) {
+    const uint16* p = src;
+    const uint16* end = src + numChars;
+    uint8* out = dst;
+    const uint8* outEnd = dst + dstMaxBytes;
+    const __m128i nonASCIIMask = _mm_set1_epi16(~0x7F);
+    const __m128i zero = _mm_setzero_si128();
+    while (p < end) {
+        if (((end - p) >= 8) && ((outEnd - out) >= 8)) {
+            const __m128i v = _mm_loadu_si128((const __m128i*)p);
+            if (0xFFFF == _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, nonASCIIMask), zero))) {
+                _mm_storel_epi64((__m128i*)out, _mm_packus_epi16(v, v));
+                p += 8;
+                out += 8;
+                continue;
+            }
+        }
+        if (!putUTF16AsUTF8(p, end, out, outEnd)) {
+            return InvalidIndex;
+        }
+    }
+    return (int32) (out - dst);
+}
+#endif // ORYOL_SIMD_SSE
+
+#if ORYOL_SIMD_NEON
+//------------------------------------------------------------------------------
+//  NEON code paths (AArch64)
+//------------------------------------------------------------------------------
+static inline uint8x16_t
+checkBlockNEON(uint8x16_t input, uint8x16_t prevInput) {
+    const uint8x16_t nibbleMask = vdupq_n_u8(0x0F);
+    const uint8x16_t prev1 = vextq_u8(prevInput, input, 15);
+    const uint8x16_t prev2 = vextq_u8(prevInput, input, 14);
+    const uint8x16_t prev3 = vextq_u8(prevInput, input, 13);
+    const uint8x16_t byte1High = vqtbl1q_u8(vld1q_u8(byte1HighTable), vshrq_n_u8(prev1, 4));
+    const uint8x16_t byte1Low = vqtbl1q_u8(vld1q_u8(byte1LowTable), vandq_u8(prev1, nibbleMask));
+    const uint8x16_t byte2High = vqtbl1q_u8(vld1q_u8(byte2HighTable), vshrq_n_u8(input, 4));
+    const uint8x16_t special = vandq_u8(vandq_u8(byte1High, byte1Low), byte2High);
+    const uint8x16_t isThird = vqsubq_u8(prev2, vdupq_n_u8(0xE0 - 0x80));
+    const uint8x16_t isFourth = vqsubq_u8(prev3, vdupq_n_u8(0xF0 - 0x80));
+    const uint8x16_t must23 = vandq_u8(vorrq_u8(isThird, isFourth), vdupq_n_u8(0x80));
+    return veorq_u8(must23, special);
+}
+
+//------------------------------------------------------------------------------
+static bool
+validateNEON(const uint8* src, int32 numBytes) {
+    const uint8x16_t maxValue = vld1q_u8(incompleteTable + 16);
+    uint8x16_t error = vdupq_n_u8(0);
+    uint8x16_t prevInput = vdupq_n_u8(0);
+    uint8x16_t prevIncomplete = vdupq_n_u8(0);
+    int32 i = 0;
+    uint8 tail[16];
+    while (i < numBytes) {
+        uint8x16_t input;
+        if ((numBytes - i) >= 16) {
+            input = vld1q_u8(src + i);
+        }
+        else {
+            std::memset(tail, 0, sizeof(tail));
+            std::memcpy(tail, src + i, numBytes - i);
+            input = vld1q_u8(tail);
+        }
+        if (vmaxvq_u8(input) < 0x80) {
+            error = vorrq_u8(error, prevIncomplete);
+            prevIncomplete = vdupq_n_u8(0);
+        }
+        else {
+            error = vorrq_u8(error, checkBlockNEON(input, prevInput));
+            prevIncomplete = vqsubq_u8(input, maxValue);
+        }
+        prevInput = input;
+        i += 16;
+    }
+    error = vorrq_u8(error, prevIncomplete);
+    return 0 == vmaxvq_u8(error);
+}
+
+//------------------------------------------------------------------------------
+static int32
+utf8ToUTF32NEON(const uint8* src, int32 numBytes, uint32* dst, int32 dstMaxChars) {
+    const uint8* p = src;
+    const uint8* end = src + numBytes;
+    uint32* out = dst;
+    const uint32* outEnd = dst + dstMaxChars;
+    while (p < end) {
+        if (((end - p) >= 16) && ((outEnd - out) >= 16)) {
+            const uint8x16_t v = vld1q_u8(p);
+            if (vmaxvq_u8(v) < 0x80) {
+                const uint16x8_t lo16 = vmovl_u8(vget_low_u8(v));
+                const uint16x8_t hi16 = vmovl_u8(vget_high_u8(v));
+                vst1q_u32(out + 0, vmovl_u16(vget_low_u16(lo16)));
+                vst1q_u32(out + 4, vmovl_u16(vget_high_u16(lo16)));
+                vst1q_u32(out + 8, vmovl_u16(vget_low_u16(hi16)));
+                vst1q_u32(out + 12, vmovl_u16(vget_high_u16(hi16)));
+                p += 16;
+                out += 16;
+            }
+            else {
+                const uint8* blockEnd = p + 16;
+                while (p < blockEnd) {
+                    *out++ = decodeValidated(p);
+                }
+            }
+        }
+        else {
+            if (out >= outEnd) {
+                return InvalidIndex;
+            }
+            *out++ = decodeValidated(p);
+        }
+    }
+    return (int32) (out - dst);
+}
+
+//------------------------------------------------------------------------------
+static int32
+utf8ToUTF16NEON(const uint8* src, int32 numBytes, uint16* dst, int32 dstMaxChars) {
+    const uint8* p = src;
+    const uint8* end = src + numBytes;
+    uint16* out = dst;
+    const uint16* outEnd = dst + dstMaxChars;
+    while (p < end) {
+        if (((end - p) >= 16) && ((outEnd - out) >= 20)) {
+            const uint8x16_t v = vld1q_u8(p);
+            if (vmaxvq_u8(v) < 0x80) {
+                vst1q_u16(out + 0, vmovl_u8(vget_low_u8(v)));
+                vst1q_u16(out + 8, vmovl_u8(vget_high_u8(v)));
+                p += 16;
+                out += 16;
+            }
+            else {
+                const uint8* blockEnd = p + 16;
+                while (p < blockEnd) {
+                    putUTF16(decodeValidated(p), out, outEnd);
+                }
+            }
+        }
+        else if (!putUTF16(decodeValidated(p), out, outEnd)) {
+            return InvalidIndex;
+        }
+    }
+    return (int32) (out - dst);
+}
+
+//------------------------------------------------------------------------------
+static int32
+utf32ToUTF8NEON(const uint32* src, int32 numChars, uint8* dst, int32 dstMaxBytes) {
+    const uint32* p = src;
+    const uint32* end = src + numChars;
+    uint8* out = dst;
+    const uint8* outEnd = dst + dstMaxBytes;
+    while (p < end) {
+        if (((end - p) >= 8) && ((outEnd - out) >= 8)) {
+            const uint32x4_t a = vld1q_u32(p + 0);
+            const uint32x4_t b = vld1q_u32(p + 4);
+            if (vmaxvq_u32(vorrq_u32(a, b)) < 0x80) {
+                const uint16x8_t w = vcombine_u16(vmovn_u32(a), vmovn_u32(b));
+                vst1_u8(out, vmovn_u16(w));
+                p += 8;
+                out += 8;
+                continue;
+            }
+        }
+        if (!putUTF8(*p++, out, outEnd)) {
+            return InvalidIndex;
+        }
+    }
+    return (int32) (out - dst);
+}
+
+//------------------------------------------------------------------------------
+static int32
+utf16ToUTF8NEON(const uint16* src, int32 numChars, uint8* dst, int32 dstMaxBytes) {
+    const uint16* p = src;
+    const uint16* end = src + numChars;
+    uint8* out = dst;
+    const uint8* outEnd = dst + dstMaxBytes;
+    while (p < end) {
+        if (((end - p) >= 8) && ((outEnd - out) >= 8)) {
+            const uint16x8_t v = vld1q_u16(p);
+            if (vmaxvq_u16(v) < 0x80) {
+                vst1_u8(out, vmovn_u16(v));
+                p += 8;
+                out += 8;
+                continue;
+            }
+        }
+        if (!putUTF16AsUTF8(p, end, out, outEnd)) {
+            return InvalidIndex;
+        }
+    }
+    return (int32) (out - dst);
+}
+#endif // ORYOL_SIMD_NEON
+
+//------------------------------------------------------------------------------
+//  runtime dispatch
+//------------------------------------------------------------------------------
+struct utfImplementation {
+    const char* name;
+    bool (*validate)(const uint8*, int32);
+    int32 (*utf8ToUTF32)(const uint8*, int32, uint32*, int32);
+    int32 (*utf8ToUTF16)(const uint8*, int32, uint16*, int32);
+    int32 (*utf32ToUTF8)(const uint32*, int32, uint8*, int32);
+    int32 (*utf16ToUTF8)(const uint16*, int32, uint8*, int32);
+};
+
+#if ORYOL_SIMD_SSE
+//------------------------------------------------------------------------------
+static int32
+utf8ToUTF32SSSE3(const uint8* src, int32 numBytes, uint32* dst, int32 dstMaxChars) {
+    if (!validateSSSE3(src, numBytes)) {
+        return InvalidIndex;
+    }
+    return utf8ToUTF32SSE2(src, numBytes, dst, dstMaxChars);
+}
+
+//------------------------------------------------------------------------------
+static int32
+utf8ToUTF16SSSE3(const uint8* src, int32 numBytes, uint16* dst, int32 dstMaxChars) {
+    if (!validateSSSE3(src, numBytes)) {
+        return InvalidIndex;
+    }
+    return utf8ToUTF16SSE2(src, numBytes, dst, dstMaxChars);
+}
+
+//------------------------------------------------------------------------------
+static int32
+utf8ToUTF32ValidatedAVX2(const uint8* src, int32 numBytes, uint32* dst, int32 dstMaxChars) {
+    if (!validateAVX2(src, numBytes)) {
+        return InvalidIndex;
+    }
+    return utf8ToUTF32AVX2(src, numBytes, dst, dstMaxChars);
+}
+
+//------------------------------------------------------------------------------
+static int32
+utf8ToUTF16ValidatedAVX2(const uint8* src, int32 numBytes, uint16* dst, int32 dstMaxChars) {
+    if (!validateAVX2(src, numBytes)) {
+        return InvalidIndex;
+    }
+    return utf8ToUTF16AVX2(src, numBytes, dst, dstMaxChars);
+}
+#endif
+
+#if ORYOL_SIMD_NEON
+//------------------------------------------------------------------------------
+static int32
+utf8ToUTF32ValidatedNEON(const uint8* src, int32 numBytes, uint32* dst, int32 dstMaxChars) {
+    if (!validateNEON(src, numBytes)) {
+        return InvalidIndex;
+    }
+    return utf8ToUTF32NEON(src, numBytes, dst, dstMaxChars);
+}
+
+//------------------------------------------------------------------------------
+static int32
+utf8ToUTF16ValidatedNEON(const uint8* src, int32 numBytes, uint16* dst, int32 dstMaxChars) {
+    if (!validateNEON(src, numBytes)) {
+        return InvalidIndex;
+    }
+    return utf8ToUTF16NEON(src, numBytes, dst, dstMaxChars);
+}
+#endif
+
+//------------------------------------------------------------------------------
+static utfImplementation
+selectImplementation() {
+    #if ORYOL_SIMD_SSE
+    if (CpuFeatures::Has(CpuFeatures::AVX2)) {
+        return utfImplementation{ "AVX2", validateAVX2,
+            utf8ToUTF32ValidatedAVX2, utf8ToUTF16ValidatedAVX2,
+            utf32ToUTF8SSE2, utf16ToUTF8SSE2 };
+    }
+    if (CpuFeatures::Has(CpuFeatures::SSSE3)) {
+        return utfImplementation{ "SSSE3", validateSSSE3,
+            utf8ToUTF32SSSE3, utf8ToUTF16SSSE3,
+            utf32ToUTF8SSE2, utf16ToUTF8SSE2 };
+    }
+    if (CpuFeatures::Has(CpuFeatures::SSE2)) {
+        // no byte shuffle for the validator, only use SSE2 for the wide-to-UTF-8 direction
+        return utfImplementation{ "SSE2", validateScalar,
+            utf8ToUTF32Scalar, utf8ToUTF16Scalar,
+            utf32ToUTF8SSE2, utf16ToUTF8SSE2 };
+    }
+    #elif ORYOL_SIMD_NEON
+    if (CpuFeatures::Has(CpuFeatures::NEON)) {
+        return utfImplementation{ "NEON", validateNEON,
+            utf8ToUTF32ValidatedNEON, utf8ToUTF16ValidatedNEON,
+            utf32ToUTF8NEON, utf16ToUTF8NEON };
+    }
+    #endif
+    return utfImplementation{ "Scalar", validateScalar,
+        utf8ToUTF32Scalar, utf8ToUTF16Scalar,
+        utf32ToUTF8Scalar, utf16ToUTF8Scalar };
+}
+
+//------------------------------------------------------------------------------
+static const utfImplementation&
+impl() {
+    static const utfImplementation selected = selectImplementation();
+    return selected;
+}
+
+//------------------------------------------------------------------------------
+const char*
+simdUTF::ImplementationName() {
+    return impl().name;
+}
+
+//------------------------------------------------------------------------------
+bool
+simdUTF::ValidateUTF8(const uint8* src, int32 numBytes) {
+    return impl().validate(src, numBytes);
+}
+
+//------------------------------------------------------------------------------
+int32
+simdUTF::UTF8ToUTF32(const uint8* src, int32 numBytes, uint32* dst, int32 dstMaxChars) {
+    return impl().utf8ToUTF32(src, numBytes, dst, dstMaxChars);
+}
+
+//------------------------------------------------------------------------------
+int32
+simdUTF::UTF8ToUTF16(const uint8* src, int32 numBytes, uint16* dst, int32 dstMaxChars) {
+    return impl().utf8ToUTF16(src, numBytes, dst, dstMaxChars);
+}
+
+//------------------------------------------------------------------------------
+int32
+simdUTF::UTF32ToUTF8(const uint32* src, int32 numChars, uint8* dst, int32 dstMaxBytes) {
+    return impl().utf32ToUTF8(src, numChars, dst, dstMaxBytes);
+}
+
+//------------------------------------------------------------------------------
+int32
+simdUTF::UTF16ToUTF8(const uint16* src, int32 numChars, uint8* dst, int32 dstMaxBytes) {
+    return impl().utf16ToUTF8(src, numChars, dst, dstMaxBytes);
+}
+
+} // namespace Core
+} // namespace Oryol
@@ -0,0 +1,45 @@
+#pragma once
+//------------------------------------------------------------------------------
+/*
+    private class, do not use
+
+    SIMD accelerated UTF-8 validation and transcoding for StringConverter.
+
+    UTF-8 input is validated with the table-lookup algorithm by Keiser
+    and Lemire ("Validating UTF-8 In Less Than One Instruction Per Byte"),
+    16 bytes per step with SSSE3 or NEON, 32 bytes per step with AVX2.
+    Blocks of pure ASCII are widened or narrowed with SIMD instructions,
+    multi-byte sequences go through a scalar decoder which doesn't need
+    to check for errors anymore since the input has already been
+    validated. The best implementation is selected once at runtime
+    through CpuFeatures, on platforms without SIMD support a scalar
+    implementation is used.
+
+    All transcoding functions return the number of characters written
+    (without a terminating 0), or InvalidIndex if the input is invalid
+    or the destination is too small. StringConverter falls back to
+    the ConvertUTF functions in this case to produce a detailed error.
+*/
+#include "Core/Types.h"
+
+namespace Oryol {
+namespace Core {
+
+class simdUTF {
+public:
+    /// get the name of the selected implementation (e.g. "AVX2")
+    static const char* ImplementationName();
+    /// validate a UTF-8 byte sequence (RFC 3629, no overlongs, surrogates or codepoints > U+10FFFF)
+    static bool ValidateUTF8(const uint8* src, int32 numBytes);
+    /// convert UTF-8 to UTF-32
+    static int32 UTF8ToUTF32(const uint8* src, int32 numBytes, uint32* dst, int32 dstMaxChars);
+    /// convert UTF-8 to UTF-16
+    static int32 UTF8ToUTF16(const uint8* src, int32 numBytes, uint16* dst, int32 dstMaxChars);
+    /// convert UTF-32 to UTF-8
+    static int32 UTF32ToUTF8(const uint32* src, int32 numChars, uint8* dst, int32 dstMaxBytes);
+    /// convert UTF-16 to UTF-8
+    static int32 UTF16ToUTF8(const uint16* src, int32 numChars, uint8* dst, int32 dstMaxBytes);
+};
+
+} // namespace Core
+} // namespace Oryol
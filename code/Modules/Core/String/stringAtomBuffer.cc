@@ -6,9 +6,12 @@
 #include "stringAtomBuffer.h"
 #include "Core/Memory/Memory.h"
 #include "Core/Assert.h"
+#include <atomic>
 
 namespace Oryol {
 namespace Core {
+
+static std::atomic<int32> chunkSizeSetting(ORYOL_STRINGATOM_CHUNK_SIZE);
     
 //------------------------------------------------------------------------------
 stringAtomBuffer::~stringAtomBuffer() {
@@ -18,14 +21,67 @@ stringAtomBuffer::~stringAtomBuffer() {
     }
     this->chunks.Clear();
     this->curPointer = 0;
+    this->curEnd = 0;
+}
+
+//------------------------------------------------------------------------------
+void
+stringAtomBuffer::SetChunkSize(int32 numBytes) {
+    o_assert(numBytes >= int32(4 * sizeof(Header)));
+    chunkSizeSetting.store(numBytes, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+int32
+stringAtomBuffer::GetChunkSize() {
+    return chunkSizeSetting.load(std::memory_order_relaxed);
 }
     
 //------------------------------------------------------------------------------
 void
-stringAtomBuffer::allocChunk() {
-    int8* newChunk = (int8*) Memory::Alloc(this->chunkSize);
+stringAtomBuffer::allocChunk(int32 minSize) {
+    int32 size = chunkSizeSetting.load(std::memory_order_relaxed);
+    if (minSize > size) {
+        size = minSize;
+    }
+    int8* newChunk = (int8*) Memory::Alloc(size);
     this->chunks.AddBack(newChunk);
     this->curPointer = newChunk;
+    this->curEnd = newChunk + size;
+    this->numBytesReserved += size;
+}
+
+//------------------------------------------------------------------------------
+int32
+stringAtomBuffer::EntrySize(int32 strLen) {
+    // NOTE: this is an upper bound, the actual alignment is min(sizeof(Header), ORYOL_MAX_PLATFORM_ALIGN)
+    return Memory::RoundUp(strLen + sizeof(Header) + 1, ORYOL_MAX_PLATFORM_ALIGN);
+}
+
+//------------------------------------------------------------------------------
+void
+stringAtomBuffer::Reserve(int32 numBytes) {
+    if ((0 == this->curPointer) || ((this->curPointer + numBytes) > this->curEnd)) {
+        this->allocChunk(numBytes);
+    }
+}
+
+//------------------------------------------------------------------------------
+int32
+stringAtomBuffer::NumChunks() const {
+    return this->chunks.Size();
+}
+
+//------------------------------------------------------------------------------
+int32
+stringAtomBuffer::NumBytesUsed() const {
+    return this->numBytesUsed;
+}
+
+//------------------------------------------------------------------------------
+int32
+stringAtomBuffer::NumBytesReserved() const {
+    return this->numBytesReserved;
 }
 
 //------------------------------------------------------------------------------
@@ -34,19 +90,14 @@ stringAtomBuffer::AddString(stringAtomTable* table, int32 hash, const char* str)
     o_assert(nullptr != table);
     o_assert(nullptr != str);
     
-    // no chunks allocated yet?
-    if (0 == this->curPointer) {
-        this->allocChunk();
-    }
-    
     // compute length of new entry (header + string len + 0 terminator byte)
     const int32 strLen = std::strlen(str);
-    size_t requiredSize = strLen + sizeof(Header) + 1;
-    o_assert(requiredSize < this->chunkSize);
+    const int32 requiredSize = strLen + sizeof(Header) + 1;
     
-    // check if there's enough room in the current chunk
-    if ((this->curPointer + requiredSize) >= (this->chunks.Back() + this->chunkSize)) {
-        this->allocChunk();
+    // check if there's enough room in the current chunk (or no chunk allocated yet),
+    // strings bigger than the chunk size get a chunk of their own
+    if ((0 == this->curPointer) || ((this->curPointer + requiredSize) > this->curEnd)) {
+        this->allocChunk(requiredSize);
     }
     
     // copy over data
@@ -58,7 +109,9 @@ stringAtomBuffer::AddString(stringAtomTable* table, int32 hash, const char* str)
     std::strcpy((char*)head->str, str);
     
     // set curPointer to the next aligned position
-    this->curPointer = (int8*) Memory::Align(this->curPointer + requiredSize, sizeof(Header));
+    int8* nextPointer = (int8*) Memory::Align(this->curPointer + requiredSize, sizeof(Header));
+    this->numBytesUsed += int32(nextPointer - this->curPointer);
+    this->curPointer = nextPointer;
     
     return head;
 }
@@ -4,6 +4,9 @@
     private class, do not use
     
     A growable buffer for raw string data for the StringAtom system.
+    Memory is allocated in chunks, the chunk size can be changed at
+    runtime (see StringAtom::SetChunkSize), strings which don't fit
+    into a regular chunk get a chunk of their own.
 */
 #include "Core/Types.h"
 #include "Core/Containers/Array.h"
@@ -31,16 +34,34 @@ public:
     /// destructor
     ~stringAtomBuffer();
     
+    /// set the size of chunks allocated from now on (all threads)
+    static void SetChunkSize(int32 numBytes);
+    /// get the current chunk size
+    static int32 GetChunkSize();
+    
+    /// make sure that numBytes of entries can be added without allocating a new chunk
+    void Reserve(int32 numBytes);
     /// add a new string to the buffer, return pointer to start of header
     const Header* AddString(stringAtomTable* table, int32 hash, const char* str);
+    /// compute the max number of buffer bytes used by a string entry
+    static int32 EntrySize(int32 strLen);
+    
+    /// get number of allocated chunks
+    int32 NumChunks() const;
+    /// get number of bytes used by entries (including headers and alignment padding)
+    int32 NumBytesUsed() const;
+    /// get number of bytes allocated for chunks
+    int32 NumBytesReserved() const;
     
 private:
-    /// allocate a new chunk
-    void allocChunk();
+    /// allocate a new chunk with at least minSize bytes
+    void allocChunk(int32 minSize);
 
-    static const int32 chunkSize = (1<<14);    // careful with this: each thread has its own stringbuffer!
-    Array<int8*> chunks;
+    Array<int8*> chunks;         // careful with the chunk size: each thread has its own stringbuffer!
     int8* curPointer = 0;        // this is always aligned to min(sizeof(header), ORYOL_MAX_PLATFORM_ALIGN)
+    int8* curEnd = 0;
+    int32 numBytesUsed = 0;
+    int32 numBytesReserved = 0;
 };
     
 } // namespace Core
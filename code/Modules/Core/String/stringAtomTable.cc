@@ -50,6 +50,53 @@ stringAtomTable::Add(int32 hash, const char* str) {
     return newHeader;
 }
 
+//------------------------------------------------------------------------------
+void
+stringAtomTable::Reserve(int32 numBytes) {
+    this->buffer.Reserve(numBytes);
+}
+
+//------------------------------------------------------------------------------
+int32
+stringAtomTable::NumAtoms() const {
+    return this->table.Size();
+}
+
+//------------------------------------------------------------------------------
+const stringAtomBuffer&
+stringAtomTable::Buffer() const {
+    return this->buffer;
+}
+
+//------------------------------------------------------------------------------
+void
+stringAtomTable::BucketStats(int32& outNumBuckets, int32& outNumUsedBuckets, int32& outMaxBucketSize) const {
+    outNumBuckets = this->table.NumBuckets();
+    outNumUsedBuckets = 0;
+    outMaxBucketSize = 0;
+    for (int32 i = 0; i < outNumBuckets; i++) {
+        const int32 bucketSize = this->table.Bucket(i).Size();
+        if (bucketSize > 0) {
+            outNumUsedBuckets++;
+        }
+        if (bucketSize > outMaxBucketSize) {
+            outMaxBucketSize = bucketSize;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+stringAtomTable::Headers(Array<const stringAtomBuffer::Header*>& outHeaders) const {
+    outHeaders.Clear();
+    outHeaders.Reserve(this->table.Size());
+    for (int32 i = 0; i < this->table.NumBuckets(); i++) {
+        for (const Entry& entry : this->table.Bucket(i)) {
+            outHeaders.AddBack(entry.header);
+        }
+    }
+}
+
 //------------------------------------------------------------------------------
 int32
 stringAtomTable::HashForString(const char* str) {
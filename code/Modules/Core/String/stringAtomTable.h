@@ -27,6 +27,17 @@ public:
     const stringAtomBuffer::Header* Find(int32 hash, const char* str) const;
     /// add a string to the atom table
     const stringAtomBuffer::Header* Add(int32 hash, const char* str);
+    /// reserve string buffer space for numBytes of new entries
+    void Reserve(int32 numBytes);
+    
+    /// get number of atoms in the table
+    int32 NumAtoms() const;
+    /// get the string buffer (for statistics)
+    const stringAtomBuffer& Buffer() const;
+    /// get hash bucket occupancy
+    void BucketStats(int32& outNumBuckets, int32& outNumUsedBuckets, int32& outMaxBucketSize) const;
+    /// get all entry headers in the table
+    void Headers(Array<const stringAtomBuffer::Header*>& outHeaders) const;
 
 private:
     /// a bucket entry
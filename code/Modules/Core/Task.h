@@ -0,0 +1,409 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Core::Task
+    @brief the result of an asynchronous operation, with continuations
+
+    A Task<TYPE> is a handle to a value which becomes available later
+    (the result of a file load, a message round-trip, a timer). Instead
+    of keeping the request object around and polling it every frame,
+    attach a continuation with Then(), which is called exactly once
+    when the result is available. Then() returns a new Task for the
+    result of the continuation, and if the continuation itself returns
+    a Task, the returned Task completes when that inner Task completes,
+    so dependent asynchronous steps are written as a linear chain:
+
+        ioFacade->LoadFileTask("res:config.json").Then([](const Ptr<IOProtocol::Get>& req) {
+            Config cfg = parseConfig(req->GetStream());
+            return ioFacade->LoadFileTask(cfg.textureURL);
+        }).Then([](const Ptr<IOProtocol::Get>& req) {
+            ...
+        });
+
+    WhenAll() combines an array of Tasks into one Task. A Task<void>
+    completes without a value (e.g. RunLoop::Delay()).
+
+    The producer side of a Task is a Promise: create a Promise, hand
+    out its Task, and call Resolve() when the result is there, or
+    Fail() when there won't be a result (e.g. a request has been
+    rejected). A failed Task is done but has no result, Then()
+    continuations are skipped and the Tasks they return fail too,
+    so a failure travels down the chain to where OnFailed() handles
+    it. WhenAll() fails as soon as one of its Tasks fails.
+
+    Tasks and Promises are not thread-safe: a Task is resolved and
+    continued on one thread. Asynchronous sources (IO threads, timers)
+    resolve their Promise through RunLoop::Post(), so continuations
+    are always called from the RunLoop of the thread which started
+    the operation, with no per-frame cost while the operation is in
+    flight. The shared state of a Task is pool-allocated.
+
+    NOTE: Oryol is compiled as C++11, so there is no co_await, Then()
+    continuations take the place of coroutine resumption.
+*/
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include "Core/RefCounted.h"
+#include "Core/Containers/Array.h"
+
+namespace Oryol {
+namespace Core {
+
+template<class TYPE> class Task;
+template<class TYPE> class Promise;
+template<class TYPE> struct taskResolve;
+
+// private class, do not use
+template<class TYPE> struct taskValue {
+    typedef const TYPE& ref;
+    TYPE value;
+    ref get() const { return this->value; };
+};
+template<> struct taskValue<void> {
+    typedef void ref;
+    void get() const { };
+};
+
+// private class, do not use
+template<class TYPE> class taskState : public RefCounted {
+    OryolClassPoolAllocDecl(taskState);
+public:
+    /// mark as done and call the continuation
+    void complete();
+    /// mark as failed and done, and call the continuation
+    void fail();
+    /// add a continuation (called immediately if already done)
+    void then(std::function<void()>&& func);
+
+    taskValue<TYPE> result;
+    std::function<void()> continuation;
+    bool done = false;
+    bool failed = false;
+};
+OryolTemplClassPoolAllocImpl(TYPE, taskState);
+
+// private class, do not use: return type of a Then() continuation
+template<class TYPE, class FUNC> struct taskFuncResult {
+    typedef typename std::result_of<FUNC(const TYPE&)>::type type;
+    static type call(FUNC& func, taskState<TYPE>* src) { return func(src->result.value); };
+};
+template<class FUNC> struct taskFuncResult<void, FUNC> {
+    typedef typename std::result_of<FUNC()>::type type;
+    static type call(FUNC& func, taskState<void>* src) { return func(); };
+};
+
+// private class, do not use: Task type returned by Then(), Task<Task<T>> is flattened to Task<T>
+template<class TYPE> struct taskUnwrap {
+    typedef Task<TYPE> type;
+};
+template<class TYPE> struct taskUnwrap<Task<TYPE>> {
+    typedef Task<TYPE> type;
+};
+
+//------------------------------------------------------------------------------
+template<class TYPE> class Task {
+public:
+    /// the value type
+    typedef TYPE ValueType;
+
+    /// default constructor, creates an invalid Task
+    Task() { };
+
+    /// return true if the Task is valid (has been obtained from a Promise)
+    bool IsValid() const;
+    /// return true if the result is available or the Task has failed
+    bool IsDone() const;
+    /// return true if the Task has failed
+    bool IsFailed() const;
+    /// get the result, Task must be done and not failed
+    typename taskValue<TYPE>::ref Result() const;
+    /// call func(result) when done (func() for Task<void>), returns Task for func's result
+    template<class FUNC> typename taskUnwrap<typename taskFuncResult<TYPE, FUNC>::type>::type Then(FUNC func) const;
+    /// call func() if the Task fails
+    template<class FUNC> void OnFailed(FUNC func) const;
+
+private:
+    friend class Promise<TYPE>;
+    template<class> friend struct taskResolve;
+    /// construct from state
+    Task(const Ptr<taskState<TYPE>>& s) : state(s) { };
+
+    Ptr<taskState<TYPE>> state;
+};
+
+//------------------------------------------------------------------------------
+template<class TYPE> class Promise {
+public:
+    /// constructor, creates a new unresolved Task
+    Promise() : state(taskState<TYPE>::Create()) { };
+
+    /// get the Task of the promise
+    Task<TYPE> GetTask() const;
+    /// resolve with a value (calls continuations of the Task)
+    template<class VALUE> void Resolve(VALUE&& val);
+    /// resolve a Promise<void>
+    void Resolve();
+    /// fail the Task of the promise (skips Then() continuations, calls OnFailed())
+    void Fail();
+    /// return true if the Promise has been resolved or failed
+    bool IsResolved() const;
+
+private:
+    template<class> friend struct taskResolve;
+    /// resolve with the result of another task state
+    void resolveFrom(taskState<TYPE>* src);
+
+    Ptr<taskState<TYPE>> state;
+};
+
+// private class, do not use: resolve a promise with the result of a continuation
+template<class TYPE> struct taskResolve {
+    template<class CALL> static void run(Promise<TYPE>& promise, CALL&& call) {
+        promise.Resolve(call());
+    };
+};
+template<> struct taskResolve<void> {
+    template<class CALL> static void run(Promise<void>& promise, CALL&& call) {
+        call();
+        promise.Resolve();
+    };
+};
+template<class TYPE> struct taskResolve<Task<TYPE>> {
+    template<class CALL> static void run(Promise<TYPE>& promise, CALL&& call) {
+        Task<TYPE> inner = call();
+        o_assert(inner.IsValid());
+        Promise<TYPE> p(promise);
+        taskState<TYPE>* src = inner.state.get();
+        inner.state->then([p, src]() mutable {
+            p.resolveFrom(src);
+        });
+    };
+};
+
+//------------------------------------------------------------------------------
+template<class TYPE> void
+taskState<TYPE>::complete() {
+    o_assert(!this->done);
+    // keep alive, the continuation may release the last reference
+    Ptr<taskState<TYPE>> keepAlive(this);
+    this->done = true;
+    if (this->continuation) {
+        std::function<void()> func(std::move(this->continuation));
+        this->continuation = nullptr;
+        func();
+    }
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> void
+taskState<TYPE>::fail() {
+    this->failed = true;
+    this->complete();
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> void
+taskState<TYPE>::then(std::function<void()>&& func) {
+    if (this->done) {
+        func();
+    }
+    else if (this->continuation) {
+        // several continuations on the same task, call them in order
+        std::function<void()> first(std::move(this->continuation));
+        std::function<void()> second(std::move(func));
+        this->continuation = [first, second]() {
+            first();
+            second();
+        };
+    }
+    else {
+        this->continuation = std::move(func);
+    }
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> bool
+Task<TYPE>::IsValid() const {
+    return this->state.isValid();
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> bool
+Task<TYPE>::IsDone() const {
+    o_assert(this->state.isValid());
+    return this->state->done;
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> bool
+Task<TYPE>::IsFailed() const {
+    o_assert(this->state.isValid());
+    return this->state->failed;
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> typename taskValue<TYPE>::ref
+Task<TYPE>::Result() const {
+    o_assert(this->state.isValid() && this->state->done && !this->state->failed);
+    return this->state->result.get();
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE>
+template<class FUNC> typename taskUnwrap<typename taskFuncResult<TYPE, FUNC>::type>::type
+Task<TYPE>::Then(FUNC func) const {
+    o_assert(this->state.isValid());
+    typedef typename taskFuncResult<TYPE, FUNC>::type resultType;
+    typedef typename taskUnwrap<resultType>::type taskType;
+    Promise<typename taskType::ValueType> promise;
+    // the continuation is owned by src, so it can't outlive it
+    taskState<TYPE>* src = this->state.get();
+    this->state->then([promise, src, func]() mutable {
+        if (src->failed) {
+            promise.Fail();
+            return;
+        }
+        taskResolve<resultType>::run(promise, [src, &func]() {
+            return taskFuncResult<TYPE, FUNC>::call(func, src);
+        });
+    });
+    return promise.GetTask();
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE>
+template<class FUNC> void
+Task<TYPE>::OnFailed(FUNC func) const {
+    o_assert(this->state.isValid());
+    taskState<TYPE>* src = this->state.get();
+    this->state->then([src, func]() mutable {
+        if (src->failed) {
+            func();
+        }
+    });
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> Task<TYPE>
+Promise<TYPE>::GetTask() const {
+    return Task<TYPE>(this->state);
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE>
+template<class VALUE> void
+Promise<TYPE>::Resolve(VALUE&& val) {
+    static_assert(!std::is_void<TYPE>::value, "Promise<void>::Resolve() takes no value");
+    this->state->result.value = std::forward<VALUE>(val);
+    this->state->complete();
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> void
+Promise<TYPE>::Resolve() {
+    static_assert(std::is_void<TYPE>::value, "Promise::Resolve() needs a value");
+    this->state->complete();
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> void
+Promise<TYPE>::Fail() {
+    this->state->fail();
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> bool
+Promise<TYPE>::IsResolved() const {
+    return this->state->done;
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> void
+Promise<TYPE>::resolveFrom(taskState<TYPE>* src) {
+    if (src->failed) {
+        this->state->fail();
+    }
+    else {
+        this->state->result = src->result;
+        this->state->complete();
+    }
+}
+
+// private class, do not use
+class whenAllCounter : public RefCounted {
+    OryolClassDecl(whenAllCounter);
+public:
+    int32 remaining = 0;
+};
+
+// private class, do not use
+template<class TYPE> class whenAllState : public RefCounted {
+    OryolClassDecl(whenAllState);
+public:
+    Promise<Array<TYPE>> promise;
+    Array<TYPE> results;
+    int32 remaining = 0;
+};
+
+//------------------------------------------------------------------------------
+/**
+ Combine tasks into one task which completes when all tasks are done,
+ the results are in the same order as the tasks. The combined task
+ fails when one of the tasks fails.
+*/
+template<class TYPE> Task<Array<TYPE>>
+WhenAll(const Array<Task<TYPE>>& tasks) {
+    Ptr<whenAllState<TYPE>> all = whenAllState<TYPE>::Create();
+    const int32 num = tasks.Size();
+    all->results.Reserve(num);
+    for (int32 i = 0; i < num; i++) {
+        all->results.AddBack(TYPE());
+    }
+    all->remaining = num;
+    Task<Array<TYPE>> task = all->promise.GetTask();
+    if (0 == num) {
+        all->promise.Resolve(std::move(all->results));
+    }
+    for (int32 i = 0; i < num; i++) {
+        tasks[i].Then([all, i](const TYPE& val) {
+            all->results[i] = val;
+            if (0 == --all->remaining) {
+                all->promise.Resolve(std::move(all->results));
+            }
+        });
+        tasks[i].OnFailed([all]() {
+            if (!all->promise.IsResolved()) {
+                all->promise.Fail();
+            }
+        });
+    }
+    return task;
+}
+
+//------------------------------------------------------------------------------
+inline Task<void>
+WhenAll(const Array<Task<void>>& tasks) {
+    Promise<void> promise;
+    Ptr<whenAllCounter> all = whenAllCounter::Create();
+    all->remaining = tasks.Size();
+    if (0 == all->remaining) {
+        promise.Resolve();
+    }
+    for (const Task<void>& task : tasks) {
+        task.Then([all, promise]() mutable {
+            if (0 == --all->remaining) {
+                promise.Resolve();
+            }
+        });
+        task.OnFailed([promise]() mutable {
+            if (!promise.IsResolved()) {
+                promise.Fail();
+            }
+        });
+    }
+    return promise.GetTask();
+}
+
+} // namespace Core
+} // namespace Oryol
@@ -0,0 +1,309 @@
+//------------------------------------------------------------------------------
+//  JobSystem.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "JobSystem.h"
+#include "Core/CoreFacade.h"
+
+namespace Oryol {
+namespace Core {
+
+ORYOL_THREAD_LOCAL JobSystem* JobSystem::threadJobSystem = nullptr;
+ORYOL_THREAD_LOCAL int32 JobSystem::threadIndex = InvalidIndex;
+
+//------------------------------------------------------------------------------
+JobSystem::JobSystem(int32 numWorkers) {
+    o_assert(numWorkers >= 0);
+    #if !ORYOL_HAS_THREADS
+    numWorkers = 0;
+    #endif
+    this->ownerThreadId = std::this_thread::get_id();
+    this->queues.Reserve(numWorkers + 1);
+    for (int32 i = 0; i < numWorkers + 1; i++) {
+        this->queues.AddBack(new jobQueue());
+    }
+    #if ORYOL_HAS_THREADS
+    this->workers.Reserve(numWorkers);
+    for (int32 i = 0; i < numWorkers; i++) {
+        this->workers.EmplaceBack(&JobSystem::workerFunc, this, i + 1);
+    }
+    #endif
+}
+
+//------------------------------------------------------------------------------
+JobSystem::~JobSystem() {
+    o_assert(std::this_thread::get_id() == this->ownerThreadId);
+
+    // finish all pending jobs, then stop the workers
+    while (this->numQueued.load() > 0) {
+        if (!this->RunPending()) {
+            std::this_thread::yield();
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(this->sleepLock);
+        this->stopRequested = true;
+    }
+    this->wakeup.notify_all();
+    #if ORYOL_HAS_THREADS
+    for (std::thread& worker : this->workers) {
+        worker.join();
+    }
+    this->workers.Clear();
+    #endif
+    while (this->RunPending()) {
+        // jobs may have been pushed to our deque by the last running jobs
+    }
+    for (jobQueue* queue : this->queues) {
+        delete queue;
+    }
+    this->queues.Clear();
+}
+
+//------------------------------------------------------------------------------
+int32
+JobSystem::DefaultNumWorkers() {
+    #if ORYOL_HAS_THREADS
+    // the main thread helps out in Wait(), so leave one core for it
+    const int32 numCores = std::thread::hardware_concurrency();
+    return numCores > 1 ? numCores - 1 : 1;
+    #else
+    return 0;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+int32
+JobSystem::NumWorkers() const {
+    return this->queues.Size() - 1;
+}
+
+//------------------------------------------------------------------------------
+int32
+JobSystem::threadQueueIndex() const {
+    if (this == threadJobSystem) {
+        return threadIndex;
+    }
+    else if (std::this_thread::get_id() == this->ownerThreadId) {
+        return 0;
+    }
+    else {
+        return InvalidIndex;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+JobSystem::Run(Func func, Counter* counter) {
+    if (nullptr != counter) {
+        counter->value.fetch_add(1, std::memory_order_relaxed);
+    }
+    job* j = new job;
+    j->func = std::move(func);
+    j->counter = counter;
+    this->push(j);
+}
+
+//------------------------------------------------------------------------------
+void
+JobSystem::RunAfter(Counter* dependency, Func func, Counter* counter) {
+    o_assert(nullptr != dependency);
+    if (nullptr != counter) {
+        counter->value.fetch_add(1, std::memory_order_relaxed);
+    }
+    job* j = new job;
+    j->func = std::move(func);
+    j->counter = counter;
+
+    // the dependency counter only drains its continuations after it
+    // has reached zero and while holding the lock, so checking the
+    // value under the lock can't miss the transition
+    lockCounter(dependency);
+    if (dependency->value.load(std::memory_order_acquire) > 0) {
+        dependency->continuations.AddBack(j);
+        j = nullptr;
+    }
+    unlockCounter(dependency);
+    if (nullptr != j) {
+        this->push(j);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+JobSystem::push(job* j) {
+    this->numQueued.fetch_add(1, std::memory_order_seq_cst);
+    const int32 queueIndex = this->threadQueueIndex();
+    bool queued = false;
+    if (InvalidIndex != queueIndex) {
+        queued = this->queues[queueIndex]->Push(j);
+    }
+    else {
+        std::lock_guard<std::mutex> lock(this->sharedLock);
+        this->sharedQueue.Enqueue(j);
+        this->numShared.fetch_add(1, std::memory_order_release);
+        queued = true;
+    }
+    if (!queued) {
+        // own deque is full, execute right away
+        this->numQueued.fetch_sub(1, std::memory_order_relaxed);
+        this->execute(j);
+        return;
+    }
+    if (this->numSleeping.load(std::memory_order_seq_cst) > 0) {
+        // taking the lock guarantees that a worker which is about to
+        // sleep either sees the new job or receives the notification
+        std::lock_guard<std::mutex> lock(this->sleepLock);
+        this->wakeup.notify_one();
+    }
+}
+
+//------------------------------------------------------------------------------
+JobSystem::job*
+JobSystem::find(int32 queueIndex, uint32& rand) {
+    job* j = nullptr;
+    if (InvalidIndex != queueIndex) {
+        j = this->queues[queueIndex]->Pop();
+    }
+    if ((nullptr == j) && (this->numShared.load(std::memory_order_acquire) > 0)) {
+        std::lock_guard<std::mutex> lock(this->sharedLock);
+        if (!this->sharedQueue.Empty()) {
+            j = this->sharedQueue.Dequeue();
+            this->numShared.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+    if (nullptr == j) {
+        // try to steal, starting at a random victim (xorshift)
+        const int32 numQueues = this->queues.Size();
+        rand ^= rand << 13;
+        rand ^= rand >> 17;
+        rand ^= rand << 5;
+        const int32 start = rand % numQueues;
+        for (int32 i = 0; (i < numQueues) && (nullptr == j); i++) {
+            const int32 victim = (start + i) % numQueues;
+            if (victim != queueIndex) {
+                j = this->queues[victim]->Steal();
+            }
+        }
+    }
+    if (nullptr != j) {
+        this->numQueued.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return j;
+}
+
+//------------------------------------------------------------------------------
+void
+JobSystem::execute(job* j) {
+    j->func();
+    Counter* counter = j->counter;
+    delete j;
+    if (nullptr != counter) {
+        this->signal(counter);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+JobSystem::signal(Counter* counter) {
+    // the decrement happens under the lock, Wait() takes the lock once
+    // after the counter has reached zero, so the counter isn't touched
+    // anymore after Wait() returns and may be destroyed
+    Array<job*> continuations;
+    lockCounter(counter);
+    if (1 == counter->value.fetch_sub(1, std::memory_order_acq_rel)) {
+        if (!counter->continuations.Empty()) {
+            continuations = std::move(counter->continuations);
+        }
+    }
+    unlockCounter(counter);
+    for (job* j : continuations) {
+        this->push(j);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+JobSystem::lockCounter(Counter* counter) {
+    while (counter->lock.exchange(true, std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+JobSystem::unlockCounter(Counter* counter) {
+    counter->lock.store(false, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+bool
+JobSystem::RunPending() {
+    static ORYOL_THREAD_LOCAL uint32 rand = 0;
+    if (0 == rand) {
+        rand = uint32(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+    }
+    job* j = this->find(this->threadQueueIndex(), rand);
+    if (nullptr != j) {
+        this->execute(j);
+        return true;
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void
+JobSystem::Wait(Counter* counter) {
+    o_assert(nullptr != counter);
+    while (counter->value.load(std::memory_order_acquire) > 0) {
+        if (!this->RunPending()) {
+            std::this_thread::yield();
+        }
+    }
+    // synchronize with the last signal()
+    lockCounter(counter);
+    unlockCounter(counter);
+}
+
+//------------------------------------------------------------------------------
+void
+JobSystem::workerFunc(int32 queueIndex) {
+    CoreFacade::EnterThread();
+    threadJobSystem = this;
+    threadIndex = queueIndex;
+
+    uint32 rand = uint32(queueIndex) * 0x9E3779B9 | 1;
+    const int32 maxSpins = 64;
+    int32 spins = 0;
+    for (;;) {
+        job* j = this->find(queueIndex, rand);
+        if (nullptr != j) {
+            this->execute(j);
+            spins = 0;
+        }
+        else if (this->stopRequested.load(std::memory_order_acquire)) {
+            // no more work and the JobSystem is going down
+            break;
+        }
+        else if (++spins < maxSpins) {
+            std::this_thread::yield();
+        }
+        else {
+            // nothing to do, go to sleep until new jobs are pushed
+            std::unique_lock<std::mutex> lock(this->sleepLock);
+            this->numSleeping.fetch_add(1, std::memory_order_seq_cst);
+            while ((0 == this->numQueued.load(std::memory_order_seq_cst)) && !this->stopRequested) {
+                this->wakeup.wait(lock);
+            }
+            this->numSleeping.fetch_sub(1, std::memory_order_relaxed);
+            spins = 0;
+        }
+    }
+
+    threadJobSystem = nullptr;
+    threadIndex = InvalidIndex;
+    CoreFacade::LeaveThread();
+}
+
+} // namespace Core
+} // namespace Oryol
@@ -0,0 +1,145 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Core::JobSystem
+    @brief work-stealing job scheduler
+
+    The JobSystem runs small jobs (std::function<void()>) on a pool of
+    worker threads. Each worker and the thread which created the
+    JobSystem own a Chase-Lev work-stealing deque, new jobs are pushed
+    to the deque of the calling thread, idle workers steal jobs from
+    the other deques. Jobs which are submitted from other threads go
+    through a shared, mutex-protected queue.
+
+    Completion is tracked with Counter objects: a counter is
+    incremented when a job is submitted and decremented when the job
+    has finished. Wait() doesn't block, the calling thread executes
+    other jobs until the counter has reached zero ("wait while helping"),
+    so it is safe to Wait() from inside a job. RunAfter() submits a job
+    which is started when a counter has reached zero, this is how
+    dependencies between jobs are expressed.
+
+    The worker threads call CoreFacade::EnterThread()/LeaveThread(), so
+    thread-local singletons (StringAtom tables, RunLoops) can be used
+    inside jobs. The CoreFacade creates a JobSystem with one worker per
+    CPU core (minus the main thread), which is accessible through
+    CoreFacade::Instance()->JobSystem(). On platforms without threads
+    there are no workers and jobs are executed inside Wait().
+
+    Counter objects must outlive their jobs, call Wait() on a counter
+    before destroying it. Jobs should not block on locks for a long
+    time since this stalls a worker thread.
+*/
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "Core/Types.h"
+#include "Core/Containers/Array.h"
+#include "Core/Containers/Queue.h"
+#include "Core/Threading/workStealingQueue.h"
+
+namespace Oryol {
+namespace Core {
+
+class JobSystem {
+    struct job;
+public:
+    /// a job function
+    typedef std::function<void()> Func;
+
+    /// job completion counter
+    class Counter {
+    public:
+        /// constructor
+        Counter() { };
+        /// get number of pending jobs
+        int32 Value() const;
+        /// return true if all jobs have finished
+        bool Done() const;
+    private:
+        friend class JobSystem;
+        Counter(const Counter&) = delete;
+        void operator=(const Counter&) = delete;
+        std::atomic<int32> value{0};
+        std::atomic<bool> lock{false};
+        Array<job*> continuations;
+    };
+
+    /// constructor, with number of worker threads
+    JobSystem(int32 numWorkers);
+    /// destructor, finishes all pending jobs
+    ~JobSystem();
+
+    /// get the default number of workers for this machine
+    static int32 DefaultNumWorkers();
+    /// get number of worker threads
+    int32 NumWorkers() const;
+
+    /// submit a job, counter (optional) is decremented when the job has finished
+    void Run(Func func, Counter* counter = nullptr);
+    /// submit a job which starts when the dependency counter has reached zero
+    void RunAfter(Counter* dependency, Func func, Counter* counter = nullptr);
+    /// execute other jobs until the counter has reached zero
+    void Wait(Counter* counter);
+    /// execute a single pending job if one is available, return false if none
+    bool RunPending();
+
+private:
+    struct job {
+        Func func;
+        Counter* counter;
+    };
+    static const int32 QueueCapacity = 4096;
+    typedef workStealingQueue<job, QueueCapacity> jobQueue;
+
+    /// the worker thread function
+    void workerFunc(int32 queueIndex);
+    /// get deque index of the calling thread, InvalidIndex if it doesn't own one
+    int32 threadQueueIndex() const;
+    /// push a job into a queue and wake up a worker
+    void push(job* j);
+    /// find a job to execute (own deque, shared queue, other deques)
+    job* find(int32 queueIndex, uint32& rand);
+    /// execute a job and signal its counter
+    void execute(job* j);
+    /// decrement counter, starts continuations when it reaches zero
+    void signal(Counter* counter);
+    /// lock a counter's continuation list
+    static void lockCounter(Counter* counter);
+    /// unlock a counter's continuation list
+    static void unlockCounter(Counter* counter);
+
+    std::thread::id ownerThreadId;
+    Array<jobQueue*> queues;            // [0] is owned by the creator thread, [1..] by the workers
+    #if ORYOL_HAS_THREADS
+    Array<std::thread> workers;
+    #endif
+    std::mutex sharedLock;
+    Queue<job*> sharedQueue;            // jobs submitted by other threads
+    std::atomic<int32> numShared{0};
+    std::mutex sleepLock;
+    std::condition_variable wakeup;
+    std::atomic<int32> numQueued{0};    // jobs in any queue
+    std::atomic<int32> numSleeping{0};
+    std::atomic<bool> stopRequested{false};
+
+    static ORYOL_THREAD_LOCAL JobSystem* threadJobSystem;
+    static ORYOL_THREAD_LOCAL int32 threadIndex;
+};
+
+//------------------------------------------------------------------------------
+inline int32
+JobSystem::Counter::Value() const {
+    return this->value.load(std::memory_order_acquire);
+}
+
+//------------------------------------------------------------------------------
+inline bool
+JobSystem::Counter::Done() const {
+    return 0 == this->value.load(std::memory_order_acquire);
+}
+
+} // namespace Core
+} // namespace Oryol
@@ -0,0 +1,43 @@
+//------------------------------------------------------------------------------
+//  Mutex.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "Mutex.h"
+#include "Core/Threading/futex.h"
+
+namespace Oryol {
+namespace Core {
+
+//------------------------------------------------------------------------------
+void
+Mutex::lockSlow() {
+    // spin while the lock holder is likely to release the lock soon
+    for (int32 i = 0; i < SpinCount; i++) {
+        int32 s = this->state.load(std::memory_order_relaxed);
+        if (0 == s) {
+            if (this->state.compare_exchange_weak(s, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        else if (2 == s) {
+            // other threads are already sleeping, don't compete with them
+            break;
+        }
+        futex::Relax();
+    }
+    // mark the lock as contended and sleep until it is released, the
+    // lock is taken in the contended state since other threads may
+    // still be sleeping
+    while (this->state.exchange(2, std::memory_order_acquire) != 0) {
+        futex::Wait(&this->state, 2);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+Mutex::wake() {
+    futex::WakeOne(&this->state);
+}
+
+} // namespace Core
+} // namespace Oryol
@@ -0,0 +1,74 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Core::Mutex
+    @brief adaptive spin-then-block mutex
+
+    A small (4 bytes) non-recursive mutex. An uncontended Lock() and
+    Unlock() are a single atomic operation each. Under contention,
+    Lock() spins for a short while (critical sections are usually
+    short), and then sleeps in the kernel (futex on Linux) instead of
+    burning a core. Unlock() only enters the kernel if a thread is
+    sleeping. Not fair, a thread which releases the lock may re-acquire
+    it before a woken up waiter.
+*/
+#include <atomic>
+#include "Core/Types.h"
+
+namespace Oryol {
+namespace Core {
+
+class Mutex {
+public:
+    /// constructor
+    Mutex() { };
+
+    /// acquire the lock
+    void Lock();
+    /// try to acquire the lock without waiting, return false if locked
+    bool TryLock();
+    /// release the lock
+    void Unlock();
+
+    /// number of spins before the calling thread goes to sleep
+    static const int32 SpinCount = 100;
+
+private:
+    Mutex(const Mutex&) = delete;
+    void operator=(const Mutex&) = delete;
+
+    /// contended lock path
+    void lockSlow();
+    /// wake up a sleeping thread
+    void wake();
+
+    // 0: unlocked, 1: locked, 2: locked and maybe threads sleeping
+    std::atomic<int32> state{0};
+};
+
+//------------------------------------------------------------------------------
+inline void
+Mutex::Lock() {
+    int32 expected = 0;
+    if (!this->state.compare_exchange_strong(expected, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+        this->lockSlow();
+    }
+}
+
+//------------------------------------------------------------------------------
+inline bool
+Mutex::TryLock() {
+    int32 expected = 0;
+    return this->state.compare_exchange_strong(expected, 1, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+inline void
+Mutex::Unlock() {
+    if (this->state.exchange(0, std::memory_order_release) == 2) {
+        this->wake();
+    }
+}
+
+} // namespace Core
+} // namespace Oryol
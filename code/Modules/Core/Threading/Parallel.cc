@@ -0,0 +1,95 @@
+//------------------------------------------------------------------------------
+//  Parallel.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "Parallel.h"
+#include "Core/CoreFacade.h"
+#include "Core/Threading/JobSystem.h"
+
+namespace Oryol {
+namespace Core {
+
+namespace {
+    JobSystem* jobSystemOverride = nullptr;
+
+    JobSystem* jobSystem() {
+        #if ORYOL_HAS_THREADS
+        if (nullptr != jobSystemOverride) {
+            return jobSystemOverride;
+        }
+        else if (CoreFacade::HasInstance()) {
+            return CoreFacade::Instance()->JobSystem();
+        }
+        #endif
+        return nullptr;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+Parallel::SetJobSystem(JobSystem* jobSystem) {
+    jobSystemOverride = jobSystem;
+}
+
+//------------------------------------------------------------------------------
+int32
+Parallel::NumThreads() {
+    JobSystem* js = jobSystem();
+    return (nullptr != js) ? js->NumWorkers() + 1 : 1;
+}
+
+//------------------------------------------------------------------------------
+int32
+Parallel::numChunks(int32 num, int32 grainSize) {
+    o_assert(grainSize > 0);
+    const int32 numThreads = NumThreads();
+    if ((numThreads <= 1) || (num <= grainSize)) {
+        return 1;
+    }
+    // a few chunks per thread so that stealing can balance uneven chunks
+    const int32 maxChunks = num / grainSize;
+    return std::min(maxChunks, numThreads * 4);
+}
+
+//------------------------------------------------------------------------------
+void
+Parallel::run(int32 numTasks, const std::function<void(int32)>& task) {
+    JobSystem* js = jobSystem();
+    if ((nullptr == js) || (numTasks <= 1)) {
+        for (int32 i = 0; i < numTasks; i++) {
+            task(i);
+        }
+        return;
+    }
+    // the calling thread executes the first task itself and
+    // helps with the others in Wait()
+    JobSystem::Counter counter;
+    for (int32 i = 1; i < numTasks; i++) {
+        js->Run([&task, i]() { task(i); }, &counter);
+    }
+    task(0);
+    js->Wait(&counter);
+}
+
+//------------------------------------------------------------------------------
+void
+Parallel::For(int32 begin, int32 end, const RangeFunc& func, int32 grainSize) {
+    o_assert(begin <= end);
+    const int32 num = end - begin;
+    if (num == 0) {
+        return;
+    }
+    const int32 chunks = numChunks(num, grainSize > 0 ? grainSize : 1);
+    if (chunks <= 1) {
+        func(begin, end);
+        return;
+    }
+    run(chunks, [begin, num, chunks, &func](int32 chunk) {
+        const int32 chunkBegin = begin + int32((int64(num) * chunk) / chunks);
+        const int32 chunkEnd = begin + int32((int64(num) * (chunk + 1)) / chunks);
+        func(chunkBegin, chunkEnd);
+    });
+}
+
+} // namespace Core
+} // namespace Oryol
@@ -0,0 +1,186 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Core::Parallel
+    @brief parallel algorithms on top of the JobSystem
+
+    Data-parallel building blocks which split a range into chunks and
+    execute the chunks as jobs on the CoreFacade's JobSystem (or the
+    JobSystem set with SetJobSystem()). The calling thread helps
+    executing the chunks, so the algorithms may be called from inside
+    jobs. Without a JobSystem, with a single thread or on platforms
+    without threads everything runs serially on the calling thread.
+
+    - For(): call func(begin, end) for sub-ranges of an index range,
+      the grain size (min number of indices per chunk) is picked
+      automatically if 0
+    - Transform(): dst[i] = func(src[i])
+    - Reduce(): accumulate chunks in parallel, then combine the
+      per-chunk results in order (deterministic for associative ops)
+    - Sort(): sort chunks in parallel, then merge pairs of chunks in
+      parallel rounds (used by Map::EndBulk() for large maps)
+
+    Ranges are raw pointer ranges or Arrays, the element functions must
+    be safe to call concurrently.
+*/
+#include <functional>
+#include <algorithm>
+#include "Core/Types.h"
+#include "Core/Containers/Array.h"
+
+namespace Oryol {
+namespace Core {
+
+class JobSystem;
+
+class Parallel {
+public:
+    /// chunk callback for For()
+    typedef std::function<void(int32 begin, int32 end)> RangeFunc;
+
+    /// override the JobSystem (nullptr: CoreFacade's JobSystem), call while no parallel algorithm is running
+    static void SetJobSystem(JobSystem* jobSystem);
+    /// get number of threads which execute chunks (workers + calling thread)
+    static int32 NumThreads();
+
+    /// call func(chunkBegin, chunkEnd) for chunks of [begin, end), grainSize 0 is automatic
+    static void For(int32 begin, int32 end, const RangeFunc& func, int32 grainSize = 0);
+    /// dst[i] = func(src[i]) for num elements
+    template<class SRC, class DST, class FUNC> static void Transform(const SRC* src, DST* dst, int32 num, FUNC func);
+    /// transform an Array, dst is resized to the size of src
+    template<class SRC, class DST, class FUNC> static void Transform(const Array<SRC>& src, Array<DST>& dst, FUNC func);
+    /// reduce num elements with accumulate(RESULT, const TYPE&) and combine(RESULT, RESULT)
+    template<class TYPE, class RESULT, class ACCUMULATE, class COMBINE> static RESULT Reduce(const TYPE* elms, int32 num, RESULT identity, ACCUMULATE accumulate, COMBINE combine);
+    /// reduce an Array
+    template<class TYPE, class RESULT, class ACCUMULATE, class COMBINE> static RESULT Reduce(const Array<TYPE>& array, RESULT identity, ACCUMULATE accumulate, COMBINE combine);
+    /// sort a range with operator<
+    template<class TYPE> static void Sort(TYPE* begin, TYPE* end);
+    /// sort a range with a less-than function
+    template<class TYPE, class LESS> static void Sort(TYPE* begin, TYPE* end, LESS less);
+    /// sort an Array
+    template<class TYPE> static void Sort(Array<TYPE>& array);
+
+    /// element-wise algorithms use at least this many elements per chunk
+    static const int32 MinGrainSize = 2048;
+    /// ranges shorter than this are sorted with std::sort
+    static const int32 MinSortSize = 16384;
+
+private:
+    /// number of chunks for num elements with a minimum grain size
+    static int32 numChunks(int32 num, int32 grainSize);
+    /// execute task(0..numTasks-1) in parallel and wait for completion
+    static void run(int32 numTasks, const std::function<void(int32)>& task);
+};
+
+//------------------------------------------------------------------------------
+template<class SRC, class DST, class FUNC> void
+Parallel::Transform(const SRC* src, DST* dst, int32 num, FUNC func) {
+    For(0, num, [src, dst, &func](int32 begin, int32 end) {
+        for (int32 i = begin; i < end; i++) {
+            dst[i] = func(src[i]);
+        }
+    }, MinGrainSize);
+}
+
+//------------------------------------------------------------------------------
+template<class SRC, class DST, class FUNC> void
+Parallel::Transform(const Array<SRC>& src, Array<DST>& dst, FUNC func) {
+    if (dst.Size() != src.Size()) {
+        dst.Clear();
+        dst.Reserve(src.Size());
+        for (int32 i = 0; i < src.Size(); i++) {
+            dst.EmplaceBack();
+        }
+    }
+    if (!src.Empty()) {
+        Transform(src.begin(), dst.begin(), src.Size(), func);
+    }
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE, class RESULT, class ACCUMULATE, class COMBINE> RESULT
+Parallel::Reduce(const TYPE* elms, int32 num, RESULT identity, ACCUMULATE accumulate, COMBINE combine) {
+    const int32 chunks = numChunks(num, MinGrainSize);
+    if (chunks <= 1) {
+        RESULT result = identity;
+        for (int32 i = 0; i < num; i++) {
+            result = accumulate(result, elms[i]);
+        }
+        return result;
+    }
+    Array<RESULT> partials;
+    partials.Reserve(chunks);
+    for (int32 i = 0; i < chunks; i++) {
+        partials.AddBack(identity);
+    }
+    RESULT* partial = partials.begin();
+    run(chunks, [elms, num, chunks, partial, &accumulate](int32 chunk) {
+        const int32 begin = int32((int64(num) * chunk) / chunks);
+        const int32 end = int32((int64(num) * (chunk + 1)) / chunks);
+        RESULT result = partial[chunk];
+        for (int32 i = begin; i < end; i++) {
+            result = accumulate(result, elms[i]);
+        }
+        partial[chunk] = result;
+    });
+    RESULT result = identity;
+    for (const RESULT& chunkResult : partials) {
+        result = combine(result, chunkResult);
+    }
+    return result;
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE, class RESULT, class ACCUMULATE, class COMBINE> RESULT
+Parallel::Reduce(const Array<TYPE>& array, RESULT identity, ACCUMULATE accumulate, COMBINE combine) {
+    return Reduce(array.begin(), array.Size(), identity, accumulate, combine);
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE, class LESS> void
+Parallel::Sort(TYPE* begin, TYPE* end, LESS less) {
+    const int32 num = int32(end - begin);
+    int32 chunks = 1;
+    if (num >= MinSortSize) {
+        chunks = std::min(NumThreads(), num / (MinSortSize / 2));
+    }
+    if (chunks <= 1) {
+        std::sort(begin, end, less);
+        return;
+    }
+
+    // sort the chunks, then merge neighbours until one chunk is left,
+    // chunk boundaries are computed the same way in each round
+    auto bound = [begin, num, chunks](int32 chunk) -> TYPE* {
+        return begin + int32((int64(num) * chunk) / chunks);
+    };
+    run(chunks, [&bound, &less](int32 chunk) {
+        std::sort(bound(chunk), bound(chunk + 1), less);
+    });
+    for (int32 width = 1; width < chunks; width *= 2) {
+        const int32 numMerges = (chunks + 2 * width - 1) / (2 * width);
+        run(numMerges, [&bound, &less, width, chunks](int32 merge) {
+            const int32 first = merge * 2 * width;
+            const int32 mid = std::min(first + width, chunks);
+            const int32 last = std::min(first + 2 * width, chunks);
+            if (mid < last) {
+                std::inplace_merge(bound(first), bound(mid), bound(last), less);
+            }
+        });
+    }
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> void
+Parallel::Sort(TYPE* begin, TYPE* end) {
+    Sort(begin, end, [](const TYPE& a, const TYPE& b) { return a < b; });
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> void
+Parallel::Sort(Array<TYPE>& array) {
+    Sort(array.begin(), array.end());
+}
+
+} // namespace Core
+} // namespace Oryol
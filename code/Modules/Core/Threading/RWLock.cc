@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------------
+//  RWLock.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "RWLock.h"
+#include "Core/Threading/futex.h"
+
+namespace Oryol {
+namespace Core {
+
+#if ORYOL_HAS_THREADS
+ORYOL_THREAD_LOCAL int32 RWLock::threadSlotIndex = 0;
+#endif
+
+//------------------------------------------------------------------------------
+void
+RWLock::LockWrite() {
+#if ORYOL_HAS_THREADS
+    this->writerLock.Lock();
+    this->writerActive.store(1, std::memory_order_seq_cst);
+    // wait until all readers have left, readers bump readerExits
+    // after leaving while a writer is active
+    for (;;) {
+        const int32 exits = this->readerExits.load(std::memory_order_seq_cst);
+        int32 numReaders = 0;
+        for (const readerSlot& slot : this->slots) {
+            numReaders += slot.count.load(std::memory_order_seq_cst);
+        }
+        if (0 == numReaders) {
+            break;
+        }
+        futex::Wait(&this->readerExits, exits);
+    }
+#endif
+}
+
+//------------------------------------------------------------------------------
+void
+RWLock::UnlockWrite() {
+#if ORYOL_HAS_THREADS
+    this->writerActive.store(0, std::memory_order_seq_cst);
+    this->writerLock.Unlock();
+#endif
+}
+
+//------------------------------------------------------------------------------
+void
+RWLock::lockReadSlow(int32 slot) {
+#if ORYOL_HAS_THREADS
+    // back off, and queue up behind the writer on the writer lock,
+    // no writer can be active while the writer lock is held
+    this->slots[slot].count.fetch_sub(1, std::memory_order_seq_cst);
+    this->wakeWriter();
+    this->writerLock.Lock();
+    this->slots[slot].count.fetch_add(1, std::memory_order_seq_cst);
+    this->writerLock.Unlock();
+#endif
+}
+
+//------------------------------------------------------------------------------
+void
+RWLock::wakeWriter() {
+#if ORYOL_HAS_THREADS
+    this->readerExits.fetch_add(1, std::memory_order_seq_cst);
+    futex::WakeOne(&this->readerExits);
+#endif
+}
+
+} // namespace Core
+} // namespace Oryol
@@ -3,14 +3,35 @@
 /**
     @class Oryol::Core::RWLock
     @brief single-write / multiple-reader lock
+
+    A reader-biased lock for data which is read often and written
+    rarely (registries, the Log's logger list). Each thread increments
+    a reader counter in one of several cache-line sized slots, so
+    readers on different threads don't write to the same cache line,
+    and a read lock without a writer around costs one atomic increment
+    and one load.
+
+    Writers are serialized with a Mutex, announce themselves and then
+    sleep until the reader slots have drained. Readers which arrive
+    while a writer is active or waiting queue up behind it, so a
+    stream of readers can't starve a writer. Nobody spins for long,
+    waiting threads sleep in the kernel.
+
+    Read locks are not recursive: a thread must not call LockRead()
+    again while it holds a read lock, a waiting writer would dead-lock.
 */
+#include <atomic>
 #include "Core/Types.h"
+#include "Core/Threading/Mutex.h"
 
 namespace Oryol {
 namespace Core {
 
 class RWLock {
 public:
+    /// constructor
+    RWLock() { };
+
     /// lock for writing
     void LockWrite();
     /// unlock from writing
@@ -19,34 +40,48 @@ public:
     void LockRead();
     /// unlock from reading
     void UnlockRead();
-    
+
+    /// number of reader counter slots
+    static const int32 NumSlots = 16;
+
 private:
+    RWLock(const RWLock&) = delete;
+    void operator=(const RWLock&) = delete;
+
+    /// get the reader slot of the calling thread
+    static int32 threadSlot();
+    /// read lock path when a writer is active
+    void lockReadSlow(int32 slot);
+    /// wake up a writer waiting for readers
+    void wakeWriter();
+
 #if ORYOL_HAS_THREADS
-    std::atomic<bool> writeLock{false};
-    std::atomic<int32> readCount{0};
+    // a reader counter on its own cache line
+    struct readerSlot {
+        std::atomic<int32> count{0};
+        uint8 pad[64 - sizeof(std::atomic<int32>)];
+    };
+    readerSlot slots[NumSlots];
+    std::atomic<int32> writerActive{0};
+    std::atomic<int32> readerExits{0};
+    Mutex writerLock;
+
+    static ORYOL_THREAD_LOCAL int32 threadSlotIndex;
 #endif
 };
 
 //------------------------------------------------------------------------------
-inline void
-RWLock::LockWrite() {
+inline int32
+RWLock::threadSlot() {
 #if ORYOL_HAS_THREADS
-    /// acquire the write-lock
-    while (std::atomic_exchange_explicit(&this->writeLock, true, std::memory_order_acquire)) {
-        // spinning...
-    }
-    /// spin until no-one's reading anymore
-    while (this->readCount > 0) {
-        // spinning...
+    // slot index + 1 (0 means no slot assigned yet)
+    if (0 == threadSlotIndex) {
+        static std::atomic<int32> nextSlot{0};
+        threadSlotIndex = (nextSlot.fetch_add(1, std::memory_order_relaxed) % NumSlots) + 1;
     }
-#endif
-}
-
-//------------------------------------------------------------------------------
-inline void
-RWLock::UnlockWrite() {
-#if ORYOL_HAS_THREADS
-    std::atomic_store_explicit(&this->writeLock, false, std::memory_order_release);
+    return threadSlotIndex - 1;
+#else
+    return 0;
 #endif
 }
 
@@ -54,12 +89,14 @@ RWLock::UnlockWrite() {
 inline void
 RWLock::LockRead() {
 #if ORYOL_HAS_THREADS
-    /// spin until no one is writing anymore
-    while (this->writeLock) {
-        // spinning...
+    // announce the reader, then check for writers (the writer does
+    // the opposite, sequential consistency guarantees that one of
+    // them sees the other)
+    const int32 slot = threadSlot();
+    this->slots[slot].count.fetch_add(1, std::memory_order_seq_cst);
+    if (this->writerActive.load(std::memory_order_seq_cst)) {
+        this->lockReadSlow(slot);
     }
-    /// increment the read-count
-    ++this->readCount;
 #endif
 }
 
@@ -67,10 +104,12 @@ RWLock::LockRead() {
 inline void
 RWLock::UnlockRead() {
 #if ORYOL_HAS_THREADS
-    --this->readCount;
+    this->slots[threadSlot()].count.fetch_sub(1, std::memory_order_seq_cst);
+    if (this->writerActive.load(std::memory_order_seq_cst)) {
+        this->wakeWriter();
+    }
 #endif
 }
 
 } // namespace Core
 } // namespace Oryol
-
@@ -0,0 +1,161 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Core::SeqLock
+    @brief sequence lock for small, rarely written values
+
+    Holds a copy of a trivially copyable value (e.g. a config table).
+    Read() never blocks writers and never writes to shared memory:
+    it copies the value and retries if a writer was active in the
+    meantime, so readers scale perfectly as long as writes are rare.
+    Writers are serialized with a Mutex. The value is stored as
+    atomic 64-bit words, so concurrent reads and writes are
+    well-defined.
+
+    Example:
+    ```
+    SeqLock<RenderSettings> settings;
+    settings.Write(newSettings);            // any thread
+    RenderSettings s = settings.Read();     // any thread
+    settings.Update([](RenderSettings& s) { s.vsync = true; });
+    ```
+*/
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+#include <thread>
+#include "Core/Types.h"
+#include "Core/Threading/Mutex.h"
+#include "Core/Threading/futex.h"
+
+namespace Oryol {
+namespace Core {
+
+template<class TYPE> class SeqLock {
+    static_assert(std::is_trivially_copyable<TYPE>::value, "SeqLock: TYPE must be trivially copyable");
+public:
+    /// default constructor (value-initialized value)
+    SeqLock();
+    /// construct with initial value
+    SeqLock(const TYPE& val);
+
+    /// get a consistent copy of the value
+    TYPE Read() const;
+    /// set a new value
+    void Write(const TYPE& val);
+    /// modify the value with func(TYPE&), concurrent writers are serialized
+    template<class FUNC> void Update(FUNC func);
+    /// get the number of writes so far
+    uint32 Version() const;
+
+private:
+    SeqLock(const SeqLock&) = delete;
+    void operator=(const SeqLock&) = delete;
+
+    /// copy the value out of the words
+    void load(TYPE& val) const;
+    /// copy a value into the words
+    void store(const TYPE& val);
+    /// publish a new value (writeLock must be held)
+    void publish(const TYPE& val);
+
+    static const int32 numWords = (sizeof(TYPE) + 7) / 8;
+    std::atomic<uint32> sequence{0};
+    std::atomic<uint64> words[numWords];
+    Mutex writeLock;
+};
+
+//------------------------------------------------------------------------------
+template<class TYPE>
+SeqLock<TYPE>::SeqLock() {
+    this->store(TYPE());
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE>
+SeqLock<TYPE>::SeqLock(const TYPE& val) {
+    this->store(val);
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> void
+SeqLock<TYPE>::load(TYPE& val) const {
+    uint64 buf[numWords];
+    for (int32 i = 0; i < numWords; i++) {
+        buf[i] = this->words[i].load(std::memory_order_relaxed);
+    }
+    std::memcpy(&val, buf, sizeof(TYPE));
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> void
+SeqLock<TYPE>::store(const TYPE& val) {
+    uint64 buf[numWords] = { };
+    std::memcpy(buf, &val, sizeof(TYPE));
+    for (int32 i = 0; i < numWords; i++) {
+        this->words[i].store(buf[i], std::memory_order_relaxed);
+    }
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> TYPE
+SeqLock<TYPE>::Read() const {
+    TYPE val;
+    int32 spins = 0;
+    for (;;) {
+        const uint32 seq0 = this->sequence.load(std::memory_order_acquire);
+        if (0 == (seq0 & 1)) {
+            this->load(val);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (this->sequence.load(std::memory_order_relaxed) == seq0) {
+                return val;
+            }
+        }
+        // a writer is active
+        if (++spins < Mutex::SpinCount) {
+            futex::Relax();
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> void
+SeqLock<TYPE>::Write(const TYPE& val) {
+    this->writeLock.Lock();
+    this->publish(val);
+    this->writeLock.Unlock();
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> template<class FUNC> void
+SeqLock<TYPE>::Update(FUNC func) {
+    this->writeLock.Lock();
+    TYPE val;
+    this->load(val);
+    func(val);
+    this->publish(val);
+    this->writeLock.Unlock();
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> void
+SeqLock<TYPE>::publish(const TYPE& val) {
+    // an odd sequence number tells readers that a write is in progress
+    const uint32 seq = this->sequence.load(std::memory_order_relaxed);
+    this->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    this->store(val);
+    this->sequence.store(seq + 2, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> uint32
+SeqLock<TYPE>::Version() const {
+    return this->sequence.load(std::memory_order_acquire) / 2;
+}
+
+} // namespace Core
+} // namespace Oryol
@@ -0,0 +1,109 @@
+//------------------------------------------------------------------------------
+//  futex.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "futex.h"
+#if ORYOL_LINUX
+#include <climits>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <time.h>
+#elif ORYOL_POSIX
+#include <unistd.h>
+#endif
+#if !ORYOL_LINUX && ORYOL_HAS_THREADS
+#include <mutex>
+#include <condition_variable>
+#endif
+
+namespace Oryol {
+namespace Core {
+
+#if !ORYOL_LINUX && ORYOL_HAS_THREADS
+namespace {
+    // a parking bucket, shared by all addresses which hash to it
+    struct parkingBucket {
+        std::mutex mutex;
+        std::condition_variable cond;
+        uint8 pad[64];
+    };
+    const int32 numBuckets = 64;
+    parkingBucket buckets[numBuckets];
+
+    parkingBucket& bucket(std::atomic<int32>* addr) {
+        const uintptr_t key = uintptr_t(addr) >> 2;
+        return buckets[(key ^ (key >> 6)) & (numBuckets - 1)];
+    }
+}
+#endif
+
+//------------------------------------------------------------------------------
+void
+futex::Wait(std::atomic<int32>* addr, int32 expected) {
+    #if ORYOL_LINUX
+    syscall(SYS_futex, (int32*) addr, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+    #elif ORYOL_HAS_THREADS
+    parkingBucket& b = bucket(addr);
+    std::unique_lock<std::mutex> lock(b.mutex);
+    if (addr->load(std::memory_order_relaxed) == expected) {
+        b.cond.wait(lock);
+    }
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+futex::WakeOne(std::atomic<int32>* addr) {
+    #if ORYOL_LINUX
+    syscall(SYS_futex, (int32*) addr, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    #elif ORYOL_HAS_THREADS
+    // the bucket may be shared with other addresses, so everybody wakes up
+    WakeAll(addr);
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+futex::WakeAll(std::atomic<int32>* addr) {
+    #if ORYOL_LINUX
+    syscall(SYS_futex, (int32*) addr, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+    #elif ORYOL_HAS_THREADS
+    parkingBucket& b = bucket(addr);
+    std::lock_guard<std::mutex> lock(b.mutex);
+    b.cond.notify_all();
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+futex::WaitShared(std::atomic<int32>* addr, int32 expected, int64 timeoutNs) {
+    #if ORYOL_LINUX
+    if (timeoutNs < 0) {
+        syscall(SYS_futex, (int32*) addr, FUTEX_WAIT, expected, nullptr, nullptr, 0);
+    }
+    else {
+        struct timespec ts;
+        ts.tv_sec = time_t(timeoutNs / 1000000000);
+        ts.tv_nsec = long(timeoutNs % 1000000000);
+        syscall(SYS_futex, (int32*) addr, FUTEX_WAIT, expected, &ts, nullptr, 0);
+    }
+    #elif ORYOL_POSIX
+    // no process-shared wait, the caller polls
+    if (addr->load(std::memory_order_relaxed) == expected) {
+        const int64 sleepNs = ((timeoutNs >= 0) && (timeoutNs < 100000)) ? timeoutNs : 100000;
+        usleep(useconds_t(sleepNs / 1000));
+    }
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+futex::WakeAllShared(std::atomic<int32>* addr) {
+    #if ORYOL_LINUX
+    syscall(SYS_futex, (int32*) addr, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    #endif
+}
+
+} // namespace Core
+} // namespace Oryol
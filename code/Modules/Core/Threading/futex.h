@@ -0,0 +1,50 @@
+#pragma once
+//------------------------------------------------------------------------------
+/*
+    private class, do not use
+
+    Wait on / wake up threads waiting on the value of an atomic int32
+    (the Linux futex semantics). On Linux this is the futex syscall, on
+    other platforms threads are parked on one of a fixed number of
+    condition variables selected by the address. Wait() may return
+    spuriously, callers must re-check their condition in a loop.
+    Relax() is a short pause for spin-wait loops.
+
+    WaitShared() and WakeAllShared() work on memory which is shared
+    between processes (e.g. POSIX shared memory). This is only 
+    supported on Linux, on other platforms WaitShared() sleeps for a
+    short time and callers end up polling.
+*/
+#include <atomic>
+#include "Core/Types.h"
+#if ORYOL_SIMD_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Oryol {
+namespace Core {
+
+class futex {
+public:
+    /// block while *addr == expected (may return spuriously)
+    static void Wait(std::atomic<int32>* addr, int32 expected);
+    /// wake up one thread waiting on addr
+    static void WakeOne(std::atomic<int32>* addr);
+    /// wake up all threads waiting on addr
+    static void WakeAll(std::atomic<int32>* addr);
+    /// block while *addr == expected in process-shared memory, timeout in nanoseconds (<0: infinite)
+    static void WaitShared(std::atomic<int32>* addr, int32 expected, int64 timeoutNs = -1);
+    /// wake up all threads and processes waiting on addr in process-shared memory
+    static void WakeAllShared(std::atomic<int32>* addr);
+    /// pause instruction for spin-wait loops
+    static void Relax() {
+        #if ORYOL_SIMD_SSE
+        _mm_pause();
+        #elif defined(__aarch64__)
+        __asm__ __volatile__("yield");
+        #endif
+    };
+};
+
+} // namespace Core
+} // namespace Oryol
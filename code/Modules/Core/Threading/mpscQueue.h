@@ -0,0 +1,119 @@
+#pragma once
+//------------------------------------------------------------------------------
+/*
+    private class, do not use
+
+    Unbounded multi-producer/single-consumer FIFO queue, after Dmitry
+    Vyukov's non-intrusive MPSC node-based queue. Push() can be called
+    from any thread and is wait-free (one atomic exchange), Pop() and
+    Empty() must only be called from the consumer thread. A pushed item
+    may not be visible to Pop() until the producer has finished its
+    Push() (the producer links the node after the exchange), so a
+    consumer which goes to sleep must be woken up by the producer
+    after Push() returned.
+*/
+#include <atomic>
+#include <utility>
+#include "Core/Types.h"
+
+namespace Oryol {
+namespace Core {
+
+template<class TYPE> class mpscQueue {
+public:
+    /// constructor
+    mpscQueue();
+    /// destructor, destroys remaining items
+    ~mpscQueue();
+
+    /// push an item (any thread)
+    void Push(const TYPE& item);
+    /// push an item by move (any thread)
+    void Push(TYPE&& item);
+    /// pop the oldest item (consumer only), return false if empty
+    bool Pop(TYPE& outItem);
+    /// test if empty (consumer only)
+    bool Empty() const;
+
+private:
+    struct node {
+        std::atomic<node*> next{nullptr};
+        TYPE value;
+    };
+    /// link a new node
+    void push(node* n);
+
+    // producers swap head, the consumer owns tail, on separate cache lines
+    std::atomic<node*> head;
+    uint8 pad0[64 - sizeof(std::atomic<node*>)];
+    node* tail;
+    uint8 pad1[64 - sizeof(node*)];
+};
+
+//------------------------------------------------------------------------------
+template<class TYPE>
+mpscQueue<TYPE>::mpscQueue() {
+    node* stub = new node;
+    this->head.store(stub, std::memory_order_relaxed);
+    this->tail = stub;
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE>
+mpscQueue<TYPE>::~mpscQueue() {
+    node* n = this->tail;
+    while (n) {
+        node* next = n->next.load(std::memory_order_relaxed);
+        delete n;
+        n = next;
+    }
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> void
+mpscQueue<TYPE>::push(node* n) {
+    node* prev = this->head.exchange(n, std::memory_order_acq_rel);
+    prev->next.store(n, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> void
+mpscQueue<TYPE>::Push(const TYPE& item) {
+    node* n = new node;
+    n->value = item;
+    this->push(n);
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> void
+mpscQueue<TYPE>::Push(TYPE&& item) {
+    node* n = new node;
+    n->value = std::move(item);
+    this->push(n);
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> bool
+mpscQueue<TYPE>::Pop(TYPE& outItem) {
+    // tail is a dummy node, its successor holds the oldest item and
+    // becomes the new dummy
+    node* t = this->tail;
+    node* next = t->next.load(std::memory_order_acquire);
+    if (nullptr == next) {
+        return false;
+    }
+    outItem = std::move(next->value);
+    next->value = TYPE();
+    this->tail = next;
+    delete t;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> bool
+mpscQueue<TYPE>::Empty() const {
+    return nullptr == this->tail->next.load(std::memory_order_acquire);
+}
+
+} // namespace Core
+} // namespace Oryol
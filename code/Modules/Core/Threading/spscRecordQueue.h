@@ -0,0 +1,146 @@
+#pragma once
+//------------------------------------------------------------------------------
+/*
+    private class, do not use
+
+    Fixed-capacity lock-free single-producer / single-consumer queue of
+    variable-sized byte records. The producer reserves a record with
+    BeginPush(), writes it, and publishes it with EndPush(). The consumer
+    looks at the oldest record with Front() and removes it with Pop().
+    Records are 8-byte aligned and never wrap around the end of the
+    buffer (the rest of the buffer is skipped instead). BeginPush()
+    returns nullptr when the queue is full, the producer decides
+    whether to drop the record or to wait.
+*/
+#include <atomic>
+#include "Core/Types.h"
+
+namespace Oryol {
+namespace Core {
+
+template<uint32 CAPACITY> class spscRecordQueue {
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be 2^N");
+    static_assert(CAPACITY >= 64, "CAPACITY too small");
+public:
+    /// constructor
+    spscRecordQueue();
+
+    /// reserve a record (producer only), nullptr if not enough space
+    uint8* BeginPush(uint32 size);
+    /// publish the record reserved with BeginPush() (producer only)
+    void EndPush();
+    /// get the oldest record (consumer only), nullptr if empty
+    const uint8* Front(uint32& outSize);
+    /// remove the oldest record returned by Front() (consumer only)
+    void Pop();
+
+    /// get the number of bytes pushed so far (monotonic)
+    uint64 PushPosition() const;
+    /// get the number of bytes popped so far (monotonic)
+    uint64 PopPosition() const;
+
+    /// max size of a single record
+    static const uint32 MaxRecordSize = CAPACITY / 2;
+
+private:
+    static const uint32 headerSize = 8;
+    static const uint32 padMarker = 0xFFFFFFFF;
+    static const uint64 mask = CAPACITY - 1;
+
+    /// get total size of a record in the buffer
+    static uint64 recordSize(uint32 size) {
+        return (headerSize + size + 7) & ~uint64(7);
+    };
+    /// access the header of the record at a position
+    uint32& header(uint64 pos) {
+        return *(uint32*) (((uint8*)this->data) + (pos & mask));
+    };
+
+    // head written by the consumer, tail by the producer, on separate cache lines
+    std::atomic<uint64> head;
+    uint8 pad0[64 - sizeof(std::atomic<uint64>)];
+    std::atomic<uint64> tail;
+    uint64 pendingTail;
+    uint8 pad1[64 - sizeof(std::atomic<uint64>) - sizeof(uint64)];
+    uint64 data[CAPACITY / 8];
+};
+
+//------------------------------------------------------------------------------
+template<uint32 CAPACITY>
+spscRecordQueue<CAPACITY>::spscRecordQueue() :
+head(0),
+tail(0),
+pendingTail(0) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+template<uint32 CAPACITY> uint8*
+spscRecordQueue<CAPACITY>::BeginPush(uint32 size) {
+    o_assert_dbg(size <= MaxRecordSize);
+    const uint64 total = recordSize(size);
+    uint64 t = this->tail.load(std::memory_order_relaxed);
+    const uint64 h = this->head.load(std::memory_order_acquire);
+    const uint64 pos = t & mask;
+    const uint64 padding = (pos + total > CAPACITY) ? (CAPACITY - pos) : 0;
+    if ((t + padding + total - h) > CAPACITY) {
+        return nullptr;
+    }
+    if (padding > 0) {
+        this->header(t) = padMarker;
+        t += padding;
+    }
+    this->header(t) = size;
+    this->pendingTail = t + total;
+    return ((uint8*)this->data) + (t & mask) + headerSize;
+}
+
+//------------------------------------------------------------------------------
+template<uint32 CAPACITY> void
+spscRecordQueue<CAPACITY>::EndPush() {
+    this->tail.store(this->pendingTail, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+template<uint32 CAPACITY> const uint8*
+spscRecordQueue<CAPACITY>::Front(uint32& outSize) {
+    uint64 h = this->head.load(std::memory_order_relaxed);
+    const uint64 t = this->tail.load(std::memory_order_acquire);
+    if (h == t) {
+        return nullptr;
+    }
+    if (padMarker == this->header(h)) {
+        // skip the unused rest of the buffer
+        h += CAPACITY - (h & mask);
+        this->head.store(h, std::memory_order_release);
+        if (h == t) {
+            return nullptr;
+        }
+    }
+    outSize = this->header(h);
+    return ((const uint8*)this->data) + (h & mask) + headerSize;
+}
+
+//------------------------------------------------------------------------------
+template<uint32 CAPACITY> void
+spscRecordQueue<CAPACITY>::Pop() {
+    const uint64 h = this->head.load(std::memory_order_relaxed);
+    o_assert_dbg(h != this->tail.load(std::memory_order_relaxed));
+    o_assert_dbg(padMarker != this->header(h));
+    this->head.store(h + recordSize(this->header(h)), std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+template<uint32 CAPACITY> uint64
+spscRecordQueue<CAPACITY>::PushPosition() const {
+    return this->tail.load(std::memory_order_acquire);
+}
+
+//------------------------------------------------------------------------------
+template<uint32 CAPACITY> uint64
+spscRecordQueue<CAPACITY>::PopPosition() const {
+    return this->head.load(std::memory_order_acquire);
+}
+
+} // namespace Core
+} // namespace Oryol
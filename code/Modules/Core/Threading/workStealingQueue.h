@@ -0,0 +1,118 @@
+#pragma once
+//------------------------------------------------------------------------------
+/*
+    private class, do not use
+
+    Fixed-capacity Chase-Lev work-stealing deque of pointers, with the
+    memory orderings from Le, Pop, Cohen, Nardelli: "Correct and Efficient
+    Work-Stealing for Weak Memory Models" (PPoPP 2013). Only the owner
+    thread may call Push() and Pop() (LIFO end), any thread may call
+    Steal() (FIFO end). Push() returns false when the deque is full,
+    Steal() may return nullptr on contention even if the deque is
+    not empty.
+*/
+#include <atomic>
+#include "Core/Types.h"
+
+namespace Oryol {
+namespace Core {
+
+template<class TYPE, int32 CAPACITY> class workStealingQueue {
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be 2^N");
+public:
+    /// constructor
+    workStealingQueue();
+
+    /// push an item to the bottom (owner only), return false if full
+    bool Push(TYPE* item);
+    /// pop an item from the bottom (owner only), nullptr if empty
+    TYPE* Pop();
+    /// steal an item from the top (any thread), nullptr if empty or lost a race
+    TYPE* Steal();
+    /// get approximate number of items
+    int32 Size() const;
+
+private:
+    static const int64 mask = CAPACITY - 1;
+
+    // top and bottom on separate cache lines, thieves hammer top, the owner bottom
+    std::atomic<int64> top;
+    uint8 pad0[64 - sizeof(std::atomic<int64>)];
+    std::atomic<int64> bottom;
+    uint8 pad1[64 - sizeof(std::atomic<int64>)];
+    std::atomic<TYPE*> items[CAPACITY];
+};
+
+//------------------------------------------------------------------------------
+template<class TYPE, int32 CAPACITY>
+workStealingQueue<TYPE, CAPACITY>::workStealingQueue() :
+top(0),
+bottom(0) {
+    for (int32 i = 0; i < CAPACITY; i++) {
+        this->items[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE, int32 CAPACITY> bool
+workStealingQueue<TYPE, CAPACITY>::Push(TYPE* item) {
+    const int64 b = this->bottom.load(std::memory_order_relaxed);
+    const int64 t = this->top.load(std::memory_order_acquire);
+    if ((b - t) >= CAPACITY) {
+        return false;
+    }
+    this->items[b & mask].store(item, std::memory_order_relaxed);
+    this->bottom.store(b + 1, std::memory_order_release);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE, int32 CAPACITY> TYPE*
+workStealingQueue<TYPE, CAPACITY>::Pop() {
+    const int64 b = this->bottom.load(std::memory_order_relaxed) - 1;
+    this->bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64 t = this->top.load(std::memory_order_relaxed);
+    TYPE* item = nullptr;
+    if (t <= b) {
+        item = this->items[b & mask].load(std::memory_order_relaxed);
+        if (t == b) {
+            // last item, race against thieves
+            if (!this->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            this->bottom.store(b + 1, std::memory_order_relaxed);
+        }
+    }
+    else {
+        // was empty
+        this->bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE, int32 CAPACITY> TYPE*
+workStealingQueue<TYPE, CAPACITY>::Steal() {
+    int64 t = this->top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64 b = this->bottom.load(std::memory_order_acquire);
+    if (t < b) {
+        TYPE* item = this->items[t & mask].load(std::memory_order_relaxed);
+        if (this->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return item;
+        }
+    }
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE, int32 CAPACITY> int32
+workStealingQueue<TYPE, CAPACITY>::Size() const {
+    const int64 b = this->bottom.load(std::memory_order_relaxed);
+    const int64 t = this->top.load(std::memory_order_relaxed);
+    return b > t ? int32(b - t) : 0;
+}
+
+} // namespace Core
+} // namespace Oryol
@@ -0,0 +1,54 @@
+//------------------------------------------------------------------------------
+//  Clock.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "Clock.h"
+#if ORYOL_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif ORYOL_OSX || ORYOL_IOS
+#include <mach/mach_time.h>
+#elif ORYOL_EMSCRIPTEN
+#include <emscripten/emscripten.h>
+#elif ORYOL_POSIX
+#include <time.h>
+#else
+#include <chrono>
+#endif
+
+namespace Oryol {
+namespace Core {
+
+//------------------------------------------------------------------------------
+Clock::Ticks
+Clock::Now() {
+#if ORYOL_WINDOWS
+    static LARGE_INTEGER freq = { };
+    if (0 == freq.QuadPart) {
+        QueryPerformanceFrequency(&freq);
+    }
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    // split into seconds and remainder to avoid an overflow
+    const int64 secs = counter.QuadPart / freq.QuadPart;
+    const int64 rem = counter.QuadPart % freq.QuadPart;
+    return secs * TicksPerSecond + (rem * TicksPerSecond) / freq.QuadPart;
+#elif ORYOL_OSX || ORYOL_IOS
+    static mach_timebase_info_data_t timebase = { };
+    if (0 == timebase.denom) {
+        mach_timebase_info(&timebase);
+    }
+    return Ticks((mach_absolute_time() * timebase.numer) / timebase.denom);
+#elif ORYOL_EMSCRIPTEN
+    return Ticks(emscripten_get_now() * 1000000.0);
+#elif ORYOL_POSIX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return Ticks(ts.tv_sec) * TicksPerSecond + ts.tv_nsec;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+} // namespace Core
+} // namespace Oryol
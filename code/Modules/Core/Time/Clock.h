@@ -0,0 +1,87 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Core::Clock
+    @brief monotonic high-resolution clock
+
+    Clock::Now() returns the current time as monotonic Ticks from an
+    arbitrary starting point. On all platforms one tick is one
+    nanosecond, so converting ticks to seconds is a single
+    multiplication. Use Ticks for time stamps and durations, and only
+    convert to seconds at the end (a float64 second value loses
+    nanosecond precision after a few days of uptime).
+
+    Example:
+    ```
+    Clock::Ticks start = Clock::Now();
+    ...
+    float64 ms = Clock::ToMilliSeconds(Clock::Since(start));
+    ```
+*/
+#include "Core/Types.h"
+
+namespace Oryol {
+namespace Core {
+
+class Clock {
+public:
+    /// a time stamp or duration in nanoseconds
+    typedef int64 Ticks;
+    /// number of ticks per second
+    static const Ticks TicksPerSecond = 1000000000;
+
+    /// get the current time
+    static Ticks Now();
+    /// get the time elapsed since a time stamp
+    static Ticks Since(Ticks start);
+
+    /// convert ticks to seconds
+    static float64 ToSeconds(Ticks ticks);
+    /// convert ticks to milliseconds
+    static float64 ToMilliSeconds(Ticks ticks);
+    /// convert ticks to microseconds
+    static float64 ToMicroSeconds(Ticks ticks);
+    /// convert seconds to ticks
+    static Ticks FromSeconds(float64 secs);
+    /// convert milliseconds to ticks
+    static Ticks FromMilliSeconds(float64 ms);
+};
+
+//------------------------------------------------------------------------------
+inline Clock::Ticks
+Clock::Since(Ticks start) {
+    return Now() - start;
+}
+
+//------------------------------------------------------------------------------
+inline float64
+Clock::ToSeconds(Ticks ticks) {
+    return float64(ticks) * (1.0 / 1000000000.0);
+}
+
+//------------------------------------------------------------------------------
+inline float64
+Clock::ToMilliSeconds(Ticks ticks) {
+    return float64(ticks) * (1.0 / 1000000.0);
+}
+
+//------------------------------------------------------------------------------
+inline float64
+Clock::ToMicroSeconds(Ticks ticks) {
+    return float64(ticks) * (1.0 / 1000.0);
+}
+
+//------------------------------------------------------------------------------
+inline Clock::Ticks
+Clock::FromSeconds(float64 secs) {
+    return Ticks(secs * 1000000000.0);
+}
+
+//------------------------------------------------------------------------------
+inline Clock::Ticks
+Clock::FromMilliSeconds(float64 ms) {
+    return Ticks(ms * 1000000.0);
+}
+
+} // namespace Core
+} // namespace Oryol
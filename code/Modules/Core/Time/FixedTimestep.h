@@ -0,0 +1,157 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Core::FixedTimestep
+    @brief accumulator for fixed-timestep updates
+
+    Converts variable frame durations into a number of fixed-size
+    simulation steps per frame. Elapsed frame time is added to an
+    accumulator (in integer Ticks, so there's no floating point drift),
+    and each full step is consumed. The number of steps per frame is
+    clamped, so a long frame (loading, debugger break) doesn't trigger
+    an ever growing number of catch-up steps, the excess time is
+    dropped instead. Alpha() is the fraction of a step left over in
+    the accumulator, use it to interpolate between the last two
+    simulation states when rendering.
+
+    The RunLoop has a FixedTimestep which drives the FixedUpdate phase.
+*/
+#include "Core/Types.h"
+#include "Core/Assert.h"
+#include "Core/Time/Clock.h"
+
+namespace Oryol {
+namespace Core {
+
+class FixedTimestep {
+public:
+    /// constructor, a zero step duration disables fixed stepping
+    FixedTimestep(Clock::Ticks stepDuration = 0, int32 maxSteps = 8);
+
+    /// set the step duration (0 disables fixed stepping) and max steps per frame
+    void Setup(Clock::Ticks stepDuration, int32 maxSteps = 8);
+    /// return true if a step duration is set
+    bool IsEnabled() const;
+    /// get the step duration
+    Clock::Ticks StepDuration() const;
+    /// get the max number of steps per frame
+    int32 MaxSteps() const;
+
+    /// add frame time, return the number of steps to run this frame
+    int32 Advance(Clock::Ticks frameDuration);
+    /// get the number of steps of the last Advance()
+    int32 NumSteps() const;
+    /// get the leftover fraction of a step (0.0 .. 1.0) for interpolation
+    float64 Alpha() const;
+    /// get the total number of steps so far
+    int64 TotalSteps() const;
+    /// get the total time dropped because of the max steps limit
+    Clock::Ticks DroppedTime() const;
+    /// clear the accumulator (e.g. after a pause)
+    void Reset();
+
+private:
+    Clock::Ticks stepDuration;
+    int32 maxSteps;
+    int32 numSteps = 0;
+    int64 totalSteps = 0;
+    Clock::Ticks accumulator = 0;
+    Clock::Ticks droppedTime = 0;
+};
+
+//------------------------------------------------------------------------------
+inline
+FixedTimestep::FixedTimestep(Clock::Ticks stepDuration_, int32 maxSteps_) :
+stepDuration(stepDuration_),
+maxSteps(maxSteps_) {
+    o_assert((stepDuration_ >= 0) && (maxSteps_ > 0));
+}
+
+//------------------------------------------------------------------------------
+inline void
+FixedTimestep::Setup(Clock::Ticks stepDuration_, int32 maxSteps_) {
+    o_assert((stepDuration_ >= 0) && (maxSteps_ > 0));
+    this->stepDuration = stepDuration_;
+    this->maxSteps = maxSteps_;
+    this->Reset();
+}
+
+//------------------------------------------------------------------------------
+inline bool
+FixedTimestep::IsEnabled() const {
+    return this->stepDuration > 0;
+}
+
+//------------------------------------------------------------------------------
+inline Clock::Ticks
+FixedTimestep::StepDuration() const {
+    return this->stepDuration;
+}
+
+//------------------------------------------------------------------------------
+inline int32
+FixedTimestep::MaxSteps() const {
+    return this->maxSteps;
+}
+
+//------------------------------------------------------------------------------
+inline int32
+FixedTimestep::Advance(Clock::Ticks frameDuration) {
+    if (!this->IsEnabled()) {
+        this->numSteps = 1;
+    }
+    else {
+        this->accumulator += frameDuration > 0 ? frameDuration : 0;
+        int64 steps = this->accumulator / this->stepDuration;
+        if (steps > this->maxSteps) {
+            // drop whole steps, but keep the fraction for smooth interpolation
+            const Clock::Ticks drop = (steps - this->maxSteps) * this->stepDuration;
+            this->droppedTime += drop;
+            this->accumulator -= drop;
+            steps = this->maxSteps;
+        }
+        this->accumulator -= steps * this->stepDuration;
+        this->numSteps = int32(steps);
+    }
+    this->totalSteps += this->numSteps;
+    return this->numSteps;
+}
+
+//------------------------------------------------------------------------------
+inline int32
+FixedTimestep::NumSteps() const {
+    return this->numSteps;
+}
+
+//------------------------------------------------------------------------------
+inline float64
+FixedTimestep::Alpha() const {
+    if (this->IsEnabled()) {
+        return float64(this->accumulator) / float64(this->stepDuration);
+    }
+    else {
+        return 0.0;
+    }
+}
+
+//------------------------------------------------------------------------------
+inline int64
+FixedTimestep::TotalSteps() const {
+    return this->totalSteps;
+}
+
+//------------------------------------------------------------------------------
+inline Clock::Ticks
+FixedTimestep::DroppedTime() const {
+    return this->droppedTime;
+}
+
+//------------------------------------------------------------------------------
+inline void
+FixedTimestep::Reset() {
+    this->accumulator = 0;
+    this->numSteps = 0;
+}
+
+} // namespace Core
+} // namespace Oryol
@@ -0,0 +1,265 @@
+//------------------------------------------------------------------------------
+//  TimerWheel.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "TimerWheel.h"
+#include "Core/Assert.h"
+#include <algorithm>
+
+namespace Oryol {
+namespace Core {
+
+//------------------------------------------------------------------------------
+TimerWheel::TimerWheel() :
+resolution(1000000),
+now(0),
+curTick(0),
+numTimers(0),
+numRemovedLinked(0),
+advancing(false) {
+    for (int32 i = 0; i < NumSlots; i++) {
+        this->slots[i] = InvalidIndex;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+TimerWheel::Setup(Clock::Ticks res, Clock::Ticks time) {
+    o_assert(res > 0);
+    o_assert(0 == this->numTimers);
+    this->resolution = res;
+    this->now = time;
+    this->curTick = time / res;
+}
+
+//------------------------------------------------------------------------------
+Clock::Ticks
+TimerWheel::Resolution() const {
+    return this->resolution;
+}
+
+//------------------------------------------------------------------------------
+Clock::Ticks
+TimerWheel::Time() const {
+    return this->now;
+}
+
+//------------------------------------------------------------------------------
+int32
+TimerWheel::NumTimers() const {
+    return this->numTimers;
+}
+
+//------------------------------------------------------------------------------
+int64
+TimerWheel::toWheelTicks(Clock::Ticks duration) const {
+    const int64 ticks = (duration + this->resolution - 1) / this->resolution;
+    return ticks > 0 ? ticks : 1;
+}
+
+//------------------------------------------------------------------------------
+TimerWheel::Id
+TimerWheel::Add(Clock::Ticks delay, std::function<void()> func, Clock::Ticks interval) {
+    o_assert(func);
+    const int32 index = this->allocTimer();
+    timer& t = this->timers[index];
+    t.func = std::move(func);
+    // round the due time up, a timer must never fire early
+    t.dueTick = (this->now + (delay > 0 ? delay : 0) + this->resolution - 1) / this->resolution;
+    if (t.dueTick <= this->curTick) {
+        t.dueTick = this->curTick + 1;
+    }
+    t.interval = interval > 0 ? this->toWheelTicks(interval) : 0;
+    t.active = true;
+    this->link(index);
+    this->numTimers++;
+    return (Id(t.generation) << 32) | Id(index);
+}
+
+//------------------------------------------------------------------------------
+int32
+TimerWheel::lookup(Id id) const {
+    const int32 index = int32(id & 0xFFFFFFFF);
+    const uint32 generation = uint32(id >> 32);
+    if ((index < this->timers.Size()) && (this->timers[index].generation == generation) && this->timers[index].active) {
+        return index;
+    }
+    return InvalidIndex;
+}
+
+//------------------------------------------------------------------------------
+bool
+TimerWheel::Remove(Id id) {
+    const int32 index = this->lookup(id);
+    if (InvalidIndex == index) {
+        return false;
+    }
+    // the timer stays linked into its slot, and is released when
+    // the wheel passes the slot
+    timer& t = this->timers[index];
+    t.active = false;
+    t.func = nullptr;
+    if (t.linked) {
+        this->numRemovedLinked++;
+    }
+    this->numTimers--;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool
+TimerWheel::Contains(Id id) const {
+    return InvalidIndex != this->lookup(id);
+}
+
+//------------------------------------------------------------------------------
+int32
+TimerWheel::Advance(Clock::Ticks time) {
+    o_assert(!this->advancing);
+    if (time > this->now) {
+        this->now = time;
+    }
+    const int64 targetTick = this->now / this->resolution;
+    if (0 == this->numTimers) {
+        // only removed timers may still be linked, release them
+        // without advancing tick by tick
+        if (this->numRemovedLinked > 0) {
+            for (int32 i = 0; i < NumSlots; i++) {
+                while (InvalidIndex != this->slots[i]) {
+                    const int32 index = this->slots[i];
+                    this->slots[i] = this->timers[index].next;
+                    this->timers[index].linked = false;
+                    this->freeTimer(index);
+                }
+            }
+            this->numRemovedLinked = 0;
+        }
+        this->curTick = targetTick;
+        return 0;
+    }
+
+    this->advancing = true;
+    int32 numFired = 0;
+    if ((targetTick - this->curTick) >= NumSlots) {
+        // a full revolution has passed, visit each slot once
+        this->dueTimers.Clear();
+        for (int32 i = 0; i < NumSlots; i++) {
+            this->unlinkDue(i, targetTick);
+        }
+        std::sort(this->dueTimers.begin(), this->dueTimers.end(), [this](int32 a, int32 b) {
+            const int64 dueA = this->timers[a].dueTick;
+            const int64 dueB = this->timers[b].dueTick;
+            return (dueA < dueB) || ((dueA == dueB) && (a < b));
+        });
+        this->curTick = targetTick;
+        numFired += this->fireDue(targetTick);
+    }
+    while (this->curTick < targetTick) {
+        this->curTick++;
+        this->dueTimers.Clear();
+        this->unlinkDue(int32(this->curTick & (NumSlots - 1)), this->curTick);
+        numFired += this->fireDue(targetTick);
+    }
+    this->advancing = false;
+    return numFired;
+}
+
+//------------------------------------------------------------------------------
+void
+TimerWheel::unlinkDue(int32 slot, int64 tick) {
+    int32* link = &this->slots[slot];
+    while (InvalidIndex != *link) {
+        const int32 index = *link;
+        timer& t = this->timers[index];
+        if (!t.active || (t.dueTick <= tick)) {
+            *link = t.next;
+            t.next = InvalidIndex;
+            t.linked = false;
+            if (t.active) {
+                this->dueTimers.AddBack(index);
+            }
+            else {
+                this->numRemovedLinked--;
+                this->freeTimer(index);
+            }
+        }
+        else {
+            link = &t.next;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+int32
+TimerWheel::fireDue(int64 targetTick) {
+    // fire the due timers, the callback may add timers (which can
+    // move the timers array), or remove timers
+    int32 numFired = 0;
+    for (int32 i = 0; i < this->dueTimers.Size(); i++) {
+        const int32 index = this->dueTimers[i];
+        if (!this->timers[index].active) {
+            // removed by an earlier callback
+            this->freeTimer(index);
+            continue;
+        }
+        std::function<void()> func = std::move(this->timers[index].func);
+        func();
+        numFired++;
+        timer& t = this->timers[index];
+        if (t.active && (t.interval > 0)) {
+            t.func = std::move(func);
+            t.dueTick += t.interval;
+            if (t.dueTick <= targetTick) {
+                // skip periods missed because Advance() fell behind
+                t.dueTick += ((targetTick - t.dueTick) / t.interval + 1) * t.interval;
+            }
+            this->link(index);
+        }
+        else {
+            if (t.active) {
+                t.active = false;
+                this->numTimers--;
+            }
+            this->freeTimer(index);
+        }
+    }
+    return numFired;
+}
+
+//------------------------------------------------------------------------------
+void
+TimerWheel::link(int32 index) {
+    timer& t = this->timers[index];
+    int32& head = this->slots[t.dueTick & (NumSlots - 1)];
+    t.next = head;
+    t.linked = true;
+    head = index;
+}
+
+//------------------------------------------------------------------------------
+int32
+TimerWheel::allocTimer() {
+    int32 index;
+    if (this->freeTimers.Empty()) {
+        index = this->timers.Size();
+        this->timers.EmplaceBack();
+    }
+    else {
+        index = this->freeTimers.Back();
+        this->freeTimers.EraseSwapBack(this->freeTimers.Size() - 1);
+    }
+    this->timers[index].generation++;
+    return index;
+}
+
+//------------------------------------------------------------------------------
+void
+TimerWheel::freeTimer(int32 index) {
+    timer& t = this->timers[index];
+    t.func = nullptr;
+    t.next = InvalidIndex;
+    this->freeTimers.AddBack(index);
+}
+
+} // namespace Core
+} // namespace Oryol
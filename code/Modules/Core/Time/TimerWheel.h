@@ -0,0 +1,109 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Core::TimerWheel
+    @brief cheap scheduling of one-shot and periodic callbacks
+
+    A hashed timer wheel: time is divided into ticks of a fixed
+    resolution (default 1 millisecond), and each timer is linked into
+    the wheel slot of the tick it's due in. Adding and removing a
+    timer is O(1), and Advance() only looks at the slots of the ticks
+    which have passed, no matter how many timers are scheduled, which
+    makes it cheap enough to call every frame. Timers due more than one
+    revolution (NumSlots ticks) in the future stay in their slot until
+    their tick comes around. If a full revolution or more has passed
+    since the last Advance(), each slot is visited once, and the due
+    timers fire in the order of their due time.
+
+    Delays are relative to the time of the last Advance() call. A timer
+    never fires early, and fires at most one resolution tick plus the
+    Advance() interval late. Periodic timers are rescheduled relative
+    to their previous due time (not to when they actually fired), so
+    they don't drift. A periodic timer fires at most once per Advance(),
+    if Advance() falls behind by more than a period, the missed periods
+    are skipped instead of firing in a burst.
+
+    Callbacks are called from Advance() on the calling thread, they may
+    add and remove timers (including their own). Not thread-safe.
+
+    Each RunLoop has a TimerWheel which is advanced at the start of
+    each frame.
+*/
+#include <functional>
+#include "Core/Types.h"
+#include "Core/Containers/Array.h"
+#include "Core/Time/Clock.h"
+
+namespace Oryol {
+namespace Core {
+
+class TimerWheel {
+public:
+    /// a timer id
+    typedef uint64 Id;
+    /// an invalid timer id
+    static const Id InvalidId = 0;
+    /// number of slots in the wheel (must be 2^N)
+    static const int32 NumSlots = 256;
+
+    /// constructor
+    TimerWheel();
+
+    /// set the resolution and current time, must be called before adding timers
+    void Setup(Clock::Ticks resolution, Clock::Ticks now);
+    /// get the resolution
+    Clock::Ticks Resolution() const;
+    /// get the current time (of the last Advance() call)
+    Clock::Ticks Time() const;
+
+    /// add a timer which fires after delay, and then every interval (if > 0)
+    Id Add(Clock::Ticks delay, std::function<void()> func, Clock::Ticks interval = 0);
+    /// remove a timer, return false if the timer no longer exists
+    bool Remove(Id id);
+    /// return true if a timer exists (one-shot timers are gone after firing)
+    bool Contains(Id id) const;
+    /// get number of timers
+    int32 NumTimers() const;
+
+    /// advance to the current time and fire due timers, returns number of fired timers
+    int32 Advance(Clock::Ticks now);
+
+private:
+    /// allocate a timer slot
+    int32 allocTimer();
+    /// release a timer slot
+    void freeTimer(int32 index);
+    /// link a timer into the slot of its due tick
+    void link(int32 index);
+    /// unlink removed timers and timers due at tick from a slot, due timers go into dueTimers
+    void unlinkDue(int32 slot, int64 tick);
+    /// fire the timers in dueTimers, returns number of fired timers
+    int32 fireDue(int64 targetTick);
+    /// convert a duration to wheel ticks (rounding up, at least 1)
+    int64 toWheelTicks(Clock::Ticks duration) const;
+    /// get the timer index from an id, InvalidIndex if the id is stale
+    int32 lookup(Id id) const;
+
+    struct timer {
+        std::function<void()> func;
+        int64 dueTick = 0;
+        int64 interval = 0;     // in wheel ticks, 0 for one-shot timers
+        uint32 generation = 0;
+        int32 next = InvalidIndex;
+        bool active = false;    // false: removed, but maybe still linked into a slot
+        bool linked = false;
+    };
+    Clock::Ticks resolution;
+    Clock::Ticks now;
+    int64 curTick;
+    int32 numTimers;
+    int32 numRemovedLinked;     // removed timers which are still linked into a slot
+    bool advancing;
+    int32 slots[NumSlots];
+    Array<timer> timers;
+    Array<int32> freeTimers;
+    Array<int32> dueTimers;
+};
+
+} // namespace Core
+} // namespace Oryol
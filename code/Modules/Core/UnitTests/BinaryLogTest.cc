@@ -0,0 +1,206 @@
+//------------------------------------------------------------------------------
+//  BinaryLogTest.cc
+//  Test deferred-format binary logging.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/BinaryLog.h"
+#include "Core/Logger.h"
+#include "Core/String/String.h"
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+using namespace Oryol;
+using namespace Oryol::Core;
+
+// decode a dump into an array of strings
+static Array<String> decodeDump(const Array<uint8>& dump, Array<BinaryLog::Record>* outRecords = nullptr) {
+    Array<String> texts;
+    bool valid = BinaryLog::Decode(dump.begin(), dump.Size(), [&](const BinaryLog::Record& rec) {
+        texts.AddBack(rec.text);
+        if (outRecords) {
+            outRecords->AddBack(rec);
+        }
+    });
+    CHECK(valid);
+    return texts;
+}
+
+// a logger which records the formatted messages
+class binLogTestLogger : public Logger {
+    OryolClassDecl(binLogTestLogger);
+public:
+    virtual void VPrint(Log::Level l, const char* msg, va_list args) override {
+        char buf[256];
+        std::vsnprintf(buf, sizeof(buf), msg, args);
+        this->messages.AddBack(buf);
+        this->levels.AddBack(l);
+    };
+    Array<String> messages;
+    Array<Log::Level> levels;
+};
+OryolClassImpl(binLogTestLogger);
+
+//------------------------------------------------------------------------------
+TEST(BinaryLogFormatTest) {
+    // start with empty buffers
+    BinaryLog::CreateDump();
+
+    const char* name = "update";
+    char mutableName[16];
+    std::strcpy(mutableName, "render");
+    const int8 i8 = -8;
+    const uint16 u16 = 16;
+    const int64 i64 = -(1ll << 40);
+    const uint64 u64 = 1ull << 63;
+    o_binlog(Log::Level::Info, "no args\n");
+    o_binlog(Log::Level::Info, "frame %d: %s took %.3f ms\n", 10, name, 1.5f);
+    o_binlog(Log::Level::Warn, "%s %c %5d|%-4u|%x\n", mutableName, 'x', i8, u16, 255u);
+    o_binlog(Log::Level::Dbg, "%lld %llu %d %f\n", i64, u64, i64, 2);
+    o_binlog(Log::Level::Dbg, "%p %s 100%%\n", (void*)0x1234, (const char*)nullptr);
+    o_binlog(Log::Level::Dbg, "%d %d\n", 1);
+    o_binlog(Log::Level::Dbg, "%d\n", "str");
+    char longBuf[1024];
+    std::memset(longBuf, 'a', sizeof(longBuf) - 1);
+    longBuf[sizeof(longBuf) - 1] = 0;
+    o_binlog(Log::Level::Dbg, "%s", longBuf);
+
+    Array<BinaryLog::Record> records;
+    Array<String> texts = decodeDump(BinaryLog::CreateDump(), &records);
+    CHECK(texts.Size() == 8);
+    CHECK(texts[0] == "no args\n");
+    CHECK(texts[1] == "frame 10: update took 1.500 ms\n");
+    CHECK(texts[2] == "render x    -8|16  |ff\n");
+    CHECK(texts[3] == "-1099511627776 9223372036854775808 -1099511627776 2.000000\n");
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%p (null) 100%%\n", (void*)0x1234);
+    CHECK(texts[4] == buf);
+    CHECK(texts[5] == "1 <missing>\n");
+    CHECK(texts[6] == "<?>\n");
+    CHECK(texts[7].Length() == ORYOL_BINARYLOG_MAX_STRING_LENGTH);
+    CHECK(records[1].level == Log::Level::Info);
+    CHECK(records[2].level == Log::Level::Warn);
+    CHECK(records[2].line == records[1].line + 1);
+    CHECK(std::strstr(records[0].file, "BinaryLogTest.cc") != nullptr);
+    CHECK(records[1].time >= records[0].time);
+
+    // the dump is consumed
+    CHECK(decodeDump(BinaryLog::CreateDump()).Empty());
+
+    // invalid dumps are rejected
+    Array<uint8> dump;
+    CHECK(!BinaryLog::Decode(dump.begin(), 0, [](const BinaryLog::Record&) { }));
+    for (int32 i = 0; i < 3; i++) {
+        o_binlog(Log::Level::Dbg, "record %d\n", i);
+    }
+    dump = BinaryLog::CreateDump();
+    int32 num = 0;
+    CHECK(!BinaryLog::Decode(dump.begin(), dump.Size() - 1, [&num](const BinaryLog::Record&) { num++; }));
+    CHECK(num == 2);
+    dump[0] = 'X';
+    CHECK(!BinaryLog::Decode(dump.begin(), dump.Size(), [](const BinaryLog::Record&) { }));
+
+    // a corrupt format count is rejected before anything gets allocated
+    dump[0] = 'G';
+    CHECK(BinaryLog::Decode(dump.begin(), dump.Size(), [](const BinaryLog::Record&) { }));
+    const int32 numOffset = 2 * sizeof(uint32);
+    const int32 corruptNum = 0x7FFFFFFF;
+    std::memcpy(&dump[numOffset], &corruptNum, sizeof(corruptNum));
+    CHECK(!BinaryLog::Decode(dump.begin(), dump.Size(), [](const BinaryLog::Record&) { }));
+}
+
+//------------------------------------------------------------------------------
+TEST(BinaryLogDispatchTest) {
+    BinaryLog::CreateDump();
+    Ptr<binLogTestLogger> logger = binLogTestLogger::Create();
+    Log::AddLogger(logger);
+    for (int32 i = 0; i < 3; i++) {
+        o_binlog(Log::Level::Warn, "dispatch %d\n", i);
+    }
+    CHECK(logger->messages.Empty());
+    CHECK(BinaryLog::Dispatch() == 3);
+    CHECK(BinaryLog::Dispatch() == 0);
+    Log::RemoveLogger(logger);
+    CHECK(logger->messages.Size() == 3);
+    CHECK(logger->messages[2] == "dispatch 2\n");
+    CHECK(logger->levels[0] == Log::Level::Warn);
+}
+
+#if ORYOL_HAS_THREADS
+//------------------------------------------------------------------------------
+TEST(BinaryLogThreadTest) {
+    BinaryLog::CreateDump();
+
+    // records of several threads, each thread's records in order
+    const int32 numThreads = 4;
+    const int32 numRecords = 500;
+    Array<std::thread> threads;
+    for (int32 t = 0; t < numThreads; t++) {
+        threads.AddBack(std::thread([t]() {
+            for (int32 i = 0; i < numRecords; i++) {
+                o_binlog(Log::Level::Dbg, "%d %d\n", t, i);
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    Array<BinaryLog::Record> records;
+    Array<String> texts = decodeDump(BinaryLog::CreateDump(), &records);
+    CHECK(texts.Size() == numThreads * numRecords);
+    int32 next[numThreads] = { };
+    bool inOrder = true;
+    for (int32 i = 0; i < texts.Size(); i++) {
+        int32 t = 0, n = 0;
+        std::sscanf(texts[i].AsCStr(), "%d %d", &t, &n);
+        inOrder &= (n == next[t]);
+        next[t] = n + 1;
+        if (i > 0) {
+            inOrder &= records[i].time >= records[i - 1].time;
+        }
+    }
+    CHECK(inOrder);
+
+    // a full buffer drops records
+    const int32 numDropped = BinaryLog::GetNumDropped();
+    const int32 numFlood = ORYOL_BINARYLOG_BUFFER_SIZE / 16;
+    for (int32 i = 0; i < numFlood; i++) {
+        o_binlog(Log::Level::Dbg, "flood %d\n", i);
+    }
+    const int32 numKept = decodeDump(BinaryLog::CreateDump()).Size();
+    CHECK(numKept < numFlood);
+    CHECK((numKept + BinaryLog::GetNumDropped() - numDropped) == numFlood);
+}
+#endif
+
+//------------------------------------------------------------------------------
+TEST(BinaryLogOverhead) {
+    BinaryLog::CreateDump();
+
+    // cost of recording a message vs. formatting it with snprintf
+    const int32 numBursts = 100;
+    const int32 burstSize = 512;
+    chrono::duration<double> binDur(0.0), fmtDur(0.0);
+    char buf[256];
+    int32 len = 0;
+    for (int32 burst = 0; burst < numBursts; burst++) {
+        chrono::time_point<chrono::steady_clock> start = chrono::steady_clock::now();
+        for (int32 i = 0; i < burstSize; i++) {
+            o_binlog(Log::Level::Dbg, "frame %d: %s took %.3f ms\n", i, "update", i * 0.5f);
+        }
+        binDur += chrono::steady_clock::now() - start;
+        BinaryLog::CreateDump();
+
+        start = chrono::steady_clock::now();
+        for (int32 i = 0; i < burstSize; i++) {
+            len += std::snprintf(buf, sizeof(buf), "frame %d: %s took %.3f ms\n", i, "update", i * 0.5f);
+        }
+        fmtDur += chrono::steady_clock::now() - start;
+    }
+    const int32 num = numBursts * burstSize;
+    Log::Info("BinaryLog: %d records: %.1f ns per record, snprintf: %.1f ns per message (%d)\n", num,
+        (binDur.count() * 1000000000.0) / num, (fmtDur.count() * 1000000000.0) / num, len);
+}
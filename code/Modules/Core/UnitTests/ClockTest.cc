@@ -0,0 +1,80 @@
+//------------------------------------------------------------------------------
+//  ClockTest.cc
+//  Test the high-resolution clock.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/Time/Clock.h"
+#include "Core/Log.h"
+#include <thread>
+#include <chrono>
+#include <cmath>
+
+using namespace Oryol;
+using namespace Oryol::Core;
+
+TEST(ClockTest) {
+    CHECK(Clock::ToSeconds(Clock::TicksPerSecond) == 1.0);
+    CHECK(Clock::ToMilliSeconds(Clock::FromMilliSeconds(16.0)) == 16.0);
+    CHECK(Clock::ToMicroSeconds(Clock::FromSeconds(0.5)) == 500000.0);
+    CHECK(Clock::FromSeconds(1.0) == Clock::TicksPerSecond);
+
+    // monotonic
+    Clock::Ticks t0 = Clock::Now();
+    for (int32 i = 0; i < 100000; i++) {
+        const Clock::Ticks t1 = Clock::Now();
+        CHECK(t1 >= t0);
+        t0 = t1;
+    }
+    // sleeping advances the clock by at least the sleep duration
+    const Clock::Ticks start = Clock::Now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK(Clock::ToMilliSeconds(Clock::Since(start)) >= 10.0);
+}
+
+//------------------------------------------------------------------------------
+TEST(ClockBenchmark) {
+    // cost of a clock query
+    const int32 num = 1000000;
+    Clock::Ticks sink = 0;
+    const Clock::Ticks start = Clock::Now();
+    for (int32 i = 0; i < num; i++) {
+        sink += Clock::Now();
+    }
+    const Clock::Ticks dur = Clock::Since(start);
+    CHECK(sink != 0);
+    Log::Info("Clock::Now(): %.1f ns per call\n", float64(dur) / num);
+
+    // smallest observable difference between two queries
+    Clock::Ticks minDelta = Clock::TicksPerSecond;
+    for (int32 i = 0; i < 1000; i++) {
+        const Clock::Ticks t0 = Clock::Now();
+        Clock::Ticks t1;
+        while ((t1 = Clock::Now()) == t0) { }
+        if ((t1 - t0) < minDelta) {
+            minDelta = t1 - t0;
+        }
+    }
+    Log::Info("Clock resolution: %lld ns\n", (long long) minDelta);
+    CHECK(minDelta < Clock::FromMilliSeconds(1.0));
+
+    // frame pacing jitter, sleep until a 4ms frame deadline
+    const Clock::Ticks frame = Clock::FromMilliSeconds(4.0);
+    const int32 numFrames = 50;
+    Clock::Ticks deadline = Clock::Now() + frame;
+    float64 sum = 0.0, sumSq = 0.0, maxJitter = 0.0;
+    for (int32 i = 0; i < numFrames; i++) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(deadline - Clock::Now()));
+        const float64 jitter = Clock::ToMicroSeconds(Clock::Now() - deadline);
+        CHECK(jitter >= 0.0);
+        sum += jitter;
+        sumSq += jitter * jitter;
+        if (jitter > maxJitter) {
+            maxJitter = jitter;
+        }
+        deadline += frame;
+    }
+    const float64 mean = sum / numFrames;
+    Log::Info("Frame pacing jitter (sleep_for): mean %.1f us, stddev %.1f us, max %.1f us\n",
+        mean, std::sqrt(sumSq / numFrames - mean * mean), maxJitter);
+}
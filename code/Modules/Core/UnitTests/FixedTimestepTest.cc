@@ -0,0 +1,57 @@
+//------------------------------------------------------------------------------
+//  FixedTimestepTest.cc
+//  Test the fixed timestep accumulator.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/Time/FixedTimestep.h"
+
+using namespace Oryol;
+using namespace Oryol::Core;
+
+TEST(FixedTimestepTest) {
+    // disabled: one step per frame
+    FixedTimestep disabled;
+    CHECK(!disabled.IsEnabled());
+    CHECK(disabled.Advance(Clock::FromMilliSeconds(33.0)) == 1);
+    CHECK(disabled.Advance(0) == 1);
+    CHECK(disabled.TotalSteps() == 2);
+    CHECK(disabled.Alpha() == 0.0);
+
+    // 10ms steps
+    FixedTimestep ts(Clock::FromMilliSeconds(10.0), 4);
+    CHECK(ts.IsEnabled());
+    CHECK(ts.StepDuration() == Clock::FromMilliSeconds(10.0));
+    CHECK(ts.MaxSteps() == 4);
+    CHECK(ts.Advance(Clock::FromMilliSeconds(5.0)) == 0);
+    CHECK(ts.Alpha() == 0.5);
+    CHECK(ts.Advance(Clock::FromMilliSeconds(5.0)) == 1);
+    CHECK(ts.Alpha() == 0.0);
+    CHECK(ts.Advance(Clock::FromMilliSeconds(25.0)) == 2);
+    CHECK(ts.NumSteps() == 2);
+    CHECK(ts.Alpha() == 0.5);
+    CHECK(ts.TotalSteps() == 3);
+
+    // a long frame is clamped to max steps, the fraction is kept
+    CHECK(ts.Advance(Clock::FromMilliSeconds(1000.0)) == 4);
+    CHECK(ts.Alpha() == 0.5);
+    CHECK(ts.DroppedTime() == Clock::FromMilliSeconds(960.0));
+    ts.Reset();
+    CHECK(ts.Alpha() == 0.0);
+    CHECK(ts.Advance(-1) == 0);
+
+    // no drift: 60 frames of 1/60 seconds each run exactly 100 steps of 1/100 sec
+    FixedTimestep ts1(Clock::TicksPerSecond / 100);
+    const Clock::Ticks frame = Clock::TicksPerSecond / 60;
+    int32 steps = 0;
+    for (int32 i = 0; i < 60; i++) {
+        steps += ts1.Advance(i < 59 ? frame : Clock::TicksPerSecond - 59 * frame);
+    }
+    CHECK(steps == 100);
+    CHECK(ts1.Alpha() == 0.0);
+
+    // re-setup resets the accumulator
+    ts1.Setup(Clock::FromMilliSeconds(1.0), 2);
+    CHECK(ts1.Advance(Clock::FromMilliSeconds(1.5)) == 1);
+    CHECK(ts1.Alpha() == 0.5);
+}
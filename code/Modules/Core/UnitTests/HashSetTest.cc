@@ -96,6 +96,12 @@ TEST(HashSetTest) {
     CHECK(hashSet3.Size() == 0);
     CHECK(hashSet3.Empty());
     CHECK(hashSet4.Size() == 8);
+    CHECK(hashSet4.NumBuckets() == 4);
+    int32 numInBuckets = 0;
+    for (int32 i = 0; i < hashSet4.NumBuckets(); i++) {
+        numInBuckets += hashSet4.Bucket(i).Size();
+    }
+    CHECK(numInBuckets == 8);
     CHECK(!hashSet4.Empty());
     CHECK(hashSet4.Contains(1));
     CHECK(hashSet4.Contains(1024));
@@ -0,0 +1,182 @@
+//------------------------------------------------------------------------------
+//  JobSystemTest.cc
+//  Test the work-stealing job system.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/CoreFacade.h"
+#include "Core/Threading/JobSystem.h"
+#include "Core/String/StringAtom.h"
+#include "Core/Log.h"
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+using namespace Oryol;
+using namespace Oryol::Core;
+
+#if ORYOL_HAS_THREADS
+// a deliberately CPU-heavy job
+static float64 busyWork(int32 seed, int32 numIterations) {
+    float64 sum = 0.0;
+    for (int32 i = 0; i < numIterations; i++) {
+        sum += std::sqrt(float64(seed + i));
+    }
+    return sum;
+}
+
+// recursively split a range into jobs (jobs spawning jobs)
+static void spawnRange(JobSystem* jobSystem, int32 begin, int32 end, std::atomic<int32>* sum, JobSystem::Counter* counter) {
+    if ((end - begin) <= 4) {
+        for (int32 i = begin; i < end; i++) {
+            sum->fetch_add(i);
+        }
+    }
+    else {
+        const int32 mid = (begin + end) / 2;
+        jobSystem->Run([=]() { spawnRange(jobSystem, begin, mid, sum, counter); }, counter);
+        jobSystem->Run([=]() { spawnRange(jobSystem, mid, end, sum, counter); }, counter);
+    }
+}
+
+TEST(JobSystemTest) {
+    JobSystem* jobSystem = CoreFacade::Instance()->JobSystem();
+    CHECK(jobSystem->NumWorkers() == JobSystem::DefaultNumWorkers());
+    CHECK(jobSystem->NumWorkers() > 0);
+
+    // simple jobs with a counter
+    std::atomic<int32> numExecuted{0};
+    JobSystem::Counter counter;
+    CHECK(counter.Done());
+    for (int32 i = 0; i < 1000; i++) {
+        jobSystem->Run([&numExecuted]() { numExecuted++; }, &counter);
+    }
+    jobSystem->Wait(&counter);
+    CHECK(counter.Done());
+    CHECK(numExecuted == 1000);
+
+    // more jobs than fit into a single deque
+    numExecuted = 0;
+    for (int32 i = 0; i < 10000; i++) {
+        jobSystem->Run([&numExecuted]() { numExecuted++; }, &counter);
+    }
+    jobSystem->Wait(&counter);
+    CHECK(numExecuted == 10000);
+
+    // jobs spawning jobs, and waiting inside a job
+    std::atomic<int32> sum{0};
+    JobSystem::Counter rangeCounter;
+    spawnRange(jobSystem, 0, 10000, &sum, &rangeCounter);
+    jobSystem->Wait(&rangeCounter);
+    CHECK(sum == (9999 * 10000) / 2);
+    sum = 0;
+    jobSystem->Run([jobSystem, &sum]() {
+        JobSystem::Counter inner;
+        spawnRange(jobSystem, 0, 1000, &sum, &inner);
+        jobSystem->Wait(&inner);
+    }, &counter);
+    jobSystem->Wait(&counter);
+    CHECK(sum == (999 * 1000) / 2);
+
+    // dependencies: stage 2 jobs may only start after all stage 1 jobs
+    std::atomic<int32> stage1{0};
+    std::atomic<int32> stage2Errors{0};
+    JobSystem::Counter stage1Counter;
+    JobSystem::Counter stage2Counter;
+    for (int32 i = 0; i < 100; i++) {
+        jobSystem->Run([&stage1]() { busyWork(0, 1000); stage1++; }, &stage1Counter);
+    }
+    for (int32 i = 0; i < 100; i++) {
+        jobSystem->RunAfter(&stage1Counter, [&stage1, &stage2Errors]() {
+            if (stage1 != 100) {
+                stage2Errors++;
+            }
+        }, &stage2Counter);
+    }
+    jobSystem->Wait(&stage2Counter);
+    CHECK(stage1Counter.Done());
+    CHECK(stage2Errors == 0);
+
+    // RunAfter with a finished dependency starts immediately
+    numExecuted = 0;
+    jobSystem->RunAfter(&stage1Counter, [&numExecuted]() { numExecuted++; }, &counter);
+    jobSystem->Wait(&counter);
+    CHECK(numExecuted == 1);
+
+    // thread-local singletons must work inside jobs
+    std::atomic<int32> numAtomsOk{0};
+    for (int32 i = 0; i < 100; i++) {
+        jobSystem->Run([&numAtomsOk]() {
+            StringAtom atom("JobSystemTest");
+            if (atom == "JobSystemTest") {
+                numAtomsOk++;
+            }
+        }, &counter);
+    }
+    jobSystem->Wait(&counter);
+    CHECK(numAtomsOk == 100);
+
+    // jobs submitted from a thread without a deque
+    numExecuted = 0;
+    std::thread t([jobSystem, &numExecuted, &counter]() {
+        for (int32 i = 0; i < 100; i++) {
+            jobSystem->Run([&numExecuted]() { numExecuted++; }, &counter);
+        }
+    });
+    t.join();
+    jobSystem->Wait(&counter);
+    CHECK(numExecuted == 100);
+}
+
+TEST(JobSystemNoWorkersTest) {
+    // without workers, jobs are executed inside Wait()
+    JobSystem jobSystem(0);
+    CHECK(jobSystem.NumWorkers() == 0);
+    int32 numExecuted = 0;
+    JobSystem::Counter counter;
+    for (int32 i = 0; i < 10; i++) {
+        jobSystem.Run([&numExecuted]() { numExecuted++; }, &counter);
+    }
+    CHECK(numExecuted == 0);
+    jobSystem.Wait(&counter);
+    CHECK(numExecuted == 10);
+}
+
+// measure how the job system scales with the number of workers
+TEST(JobSystemScalingBenchmark) {
+    const int32 numJobs = 2048;
+    const int32 numIterations = 20000;
+    const int32 maxWorkers = JobSystem::DefaultNumWorkers();
+    Array<int32> workerCounts;
+    for (int32 numWorkers = 0; numWorkers < maxWorkers; numWorkers = numWorkers ? numWorkers * 2 : 1) {
+        workerCounts.AddBack(numWorkers);
+    }
+    workerCounts.AddBack(maxWorkers);
+    float64 baseTime = 0.0;
+    for (int32 numWorkers : workerCounts) {
+        JobSystem jobSystem(numWorkers);
+        std::atomic<int32> checksum{0};
+        JobSystem::Counter counter;
+
+        chrono::time_point<chrono::system_clock> start, end;
+        start = chrono::system_clock::now();
+        for (int32 i = 0; i < numJobs; i++) {
+            jobSystem.Run([i, &checksum]() {
+                if (busyWork(i, numIterations) > 0.0) {
+                    checksum++;
+                }
+            }, &counter);
+        }
+        jobSystem.Wait(&counter);
+        end = chrono::system_clock::now();
+        chrono::duration<double> dur = end - start;
+        CHECK(checksum == numJobs);
+
+        if (0 == numWorkers) {
+            baseTime = dur.count();
+        }
+        Log::Info("JobSystem: %d workers + main thread, %d jobs: %f sec (speedup %.2fx)\n",
+                  numWorkers, numJobs, dur.count(), baseTime / dur.count());
+    }
+}
+#endif
@@ -0,0 +1,225 @@
+//------------------------------------------------------------------------------
+//  LogTest.cc
+//  Test synchronous and asynchronous logging.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/Log.h"
+#include "Core/Logger.h"
+#include "Core/CoreFacade.h"
+#include "Core/Containers/Array.h"
+#include "Core/String/String.h"
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+using namespace Oryol;
+using namespace Oryol::Core;
+
+// a logger which records the formatted messages
+class recordLogger : public Logger {
+    OryolClassDecl(recordLogger);
+public:
+    virtual void VPrint(Log::Level l, const char* msg, va_list args) override {
+        char buf[256];
+        std::vsnprintf(buf, sizeof(buf), msg, args);
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->messages.AddBack(buf);
+        this->levels.AddBack(l);
+    };
+    std::mutex mutex;
+    Array<String> messages;
+    Array<Log::Level> levels;
+};
+OryolClassImpl(recordLogger);
+
+// a logger which writes to a file, like a typical file logger
+class fileLogger : public Logger {
+    OryolClassDecl(fileLogger);
+public:
+    fileLogger() : file(std::tmpfile()) { };
+    virtual ~fileLogger() {
+        std::fclose(this->file);
+    };
+    virtual void VPrint(Log::Level /*l*/, const char* msg, va_list args) override {
+        std::vfprintf(this->file, msg, args);
+        std::fflush(this->file);
+    };
+    FILE* file;
+};
+OryolClassImpl(fileLogger);
+
+// a logger which stalls the log thread until it is opened
+class gatedLogger : public recordLogger {
+    OryolClassDecl(gatedLogger);
+public:
+    gatedLogger() : open(false) { };
+    virtual void VPrint(Log::Level l, const char* msg, va_list args) override {
+        while (!this->open.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        recordLogger::VPrint(l, msg, args);
+    };
+    std::atomic<bool> open;
+};
+OryolClassImpl(gatedLogger);
+
+//------------------------------------------------------------------------------
+TEST(LogSyncTest) {
+    Ptr<recordLogger> logger = recordLogger::Create();
+    Log::AddLogger(logger);
+    CHECK(!Log::IsAsync());
+    Log::Info("info %d\n", 1);
+    Log::Warn("warn %s\n", "2");
+    CHECK(logger->messages.Size() == 2);
+    CHECK(logger->messages[0] == "info 1\n");
+    CHECK(logger->messages[1] == "warn 2\n");
+    CHECK(logger->levels[1] == Log::Level::Warn);
+    Log::RemoveLogger(logger);
+    Log::Info("not recorded\n");
+    CHECK(logger->messages.Size() == 2);
+}
+
+#if ORYOL_HAS_THREADS
+//------------------------------------------------------------------------------
+TEST(LogAsyncTest) {
+    Ptr<recordLogger> logger = recordLogger::Create();
+    Log::AddLogger(logger);
+    Log::StartAsync();
+    CHECK(Log::IsAsync());
+
+    // messages of one thread arrive in order
+    const int32 numMessages = 1000;
+    for (int32 i = 0; i < numMessages; i++) {
+        Log::Info("msg %d\n", i);
+    }
+    Log::Flush();
+    CHECK(logger->messages.Size() == numMessages);
+    bool inOrder = true;
+    char buf[32];
+    for (int32 i = 0; i < logger->messages.Size(); i++) {
+        std::snprintf(buf, sizeof(buf), "msg %d\n", i);
+        inOrder &= logger->messages[i] == buf;
+    }
+    CHECK(inOrder);
+
+    // errors are dispatched before Log::Error() returns
+    Log::Error("error\n");
+    CHECK(logger->messages.Size() == numMessages + 1);
+    CHECK(logger->levels[numMessages] == Log::Level::Error);
+
+    // several threads, messages of each thread arrive in order
+    {
+        std::lock_guard<std::mutex> lock(logger->mutex);
+        logger->messages.Clear();
+        logger->levels.Clear();
+    }
+    const int32 numThreads = 4;
+    const int32 numThreadMessages = 200;
+    Array<std::thread> threads;
+    for (int32 t = 0; t < numThreads; t++) {
+        threads.AddBack(std::thread([t]() {
+            for (int32 i = 0; i < numThreadMessages; i++) {
+                Log::Warn("%d %d\n", t, i);
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    Log::StopAsync();
+    CHECK(!Log::IsAsync());
+    CHECK(logger->messages.Size() == numThreads * numThreadMessages);
+    int32 next[numThreads] = { };
+    inOrder = true;
+    for (const String& msg : logger->messages) {
+        int32 t = 0, i = 0;
+        std::sscanf(msg.AsCStr(), "%d %d", &t, &i);
+        inOrder &= (i == next[t]);
+        next[t] = i + 1;
+    }
+    CHECK(inOrder);
+
+    // overflowing the buffer drops info messages, but never warnings
+    Log::RemoveLogger(logger);
+    const int32 numDropped = Log::GetNumDropped();
+    Log::SetLogLevel(Log::Level::Info);
+    Log::StartAsync();
+    Ptr<gatedLogger> stalledLogger = gatedLogger::Create();
+    Log::AddLogger(stalledLogger);
+    const int32 numFlood = 2 * ORYOL_LOG_ASYNC_BUFFER_SIZE / 64;
+    for (int32 i = 0; i < numFlood; i++) {
+        Log::Info("flooding the async log buffer with message number %d\n", i);
+    }
+    // the buffer is full, warnings and errors wait until the logger is opened
+    std::thread opener([&stalledLogger]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        stalledLogger->open = true;
+    });
+    const int32 numWarnings = 100;
+    for (int32 i = 0; i < numWarnings; i++) {
+        Log::Warn("warning %d\n", i);
+        Log::Error("error %d\n", i);
+    }
+    opener.join();
+    Log::Flush();
+    Log::RemoveLogger(stalledLogger);
+    Log::StopAsync();
+    Log::SetLogLevel(Log::Level::Dbg);
+    const int32 numFloodDropped = Log::GetNumDropped() - numDropped;
+    Log::Info("Log: %d of %d messages dropped\n", numFloodDropped, numFlood);
+    CHECK(numFloodDropped > 0);
+    int32 numInfos = 0, numWarns = 0, numErrors = 0;
+    for (int32 i = 0; i < stalledLogger->messages.Size(); i++) {
+        const char* text = stalledLogger->messages[i].AsCStr();
+        if (Log::Level::Info == stalledLogger->levels[i]) {
+            numInfos++;
+        }
+        else if (0 == std::strncmp(text, "warning ", 8)) {
+            numWarns += (Log::Level::Warn == stalledLogger->levels[i]) ? 1 : 0;
+        }
+        else if (0 == std::strncmp(text, "error ", 6)) {
+            numErrors += (Log::Level::Error == stalledLogger->levels[i]) ? 1 : 0;
+        }
+    }
+    CHECK(numInfos + numFloodDropped == numFlood);
+    CHECK(numWarns == numWarnings);
+    CHECK(numErrors == numWarnings);
+}
+
+//------------------------------------------------------------------------------
+TEST(LogLatencyTest) {
+    Ptr<fileLogger> logger = fileLogger::Create();
+    Log::AddLogger(logger);
+    const int32 numMessages = 256 * 80;
+    for (int32 async = 0; async < 2; async++) {
+        if (async) {
+            Log::StartAsync();
+        }
+        // measure the latency seen by the caller, log in bursts which
+        // fit into the async buffer and flush outside of the measurement
+        chrono::duration<double> dur(0.0);
+        const int32 burstSize = 256;
+        for (int32 burst = 0; burst < numMessages; burst += burstSize) {
+            chrono::time_point<chrono::steady_clock> start = chrono::steady_clock::now();
+            for (int32 i = burst; i < burst + burstSize; i++) {
+                Log::Info("latency test message %d, value %f\n", i, i * 0.5f);
+            }
+            dur += chrono::steady_clock::now() - start;
+            Log::Flush();
+        }
+        if (async) {
+            Log::StopAsync();
+        }
+        Log::RemoveLogger(logger);
+        Log::Info("Log: %d messages (%s): %f sec, %.1f ns per message\n", numMessages,
+            async ? "async" : "sync", dur.count(), (dur.count() * 1000000000.0) / numMessages);
+        Log::AddLogger(logger);
+    }
+    Log::RemoveLogger(logger);
+}
+#endif
@@ -0,0 +1,218 @@
+//------------------------------------------------------------------------------
+//  MetricsTest.cc
+//  Test runtime metrics.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/Metrics.h"
+#include "Core/MetricsExporter.h"
+#include "Core/CoreFacade.h"
+#include "Core/RunLoop.h"
+#include "Core/Log.h"
+#include <thread>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+using namespace Oryol;
+using namespace Oryol::Core;
+
+namespace {
+class testExporter : public MetricsExporter {
+    OryolClassDecl(testExporter);
+public:
+    virtual void Export(const Array<Metrics::Sample>& samples) override {
+        this->numExports++;
+        this->numSamples = samples.Size();
+    };
+    int32 numExports = 0;
+    int32 numSamples = 0;
+};
+OryolClassImpl(testExporter);
+
+const Metrics::Sample* findSample(const Array<Metrics::Sample>& samples, const char* name) {
+    for (const Metrics::Sample& s : samples) {
+        if (s.Name == name) {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+}
+
+//------------------------------------------------------------------------------
+TEST(MetricsRegisterTest) {
+    const Metrics::Id c = Metrics::RegisterCounter("test.register.counter");
+    const Metrics::Id g = Metrics::RegisterGauge("test.register.gauge");
+    const Metrics::Id h = Metrics::RegisterHistogram("test.register.histogram");
+    CHECK(c != g);
+    CHECK(g != h);
+    CHECK(Metrics::RegisterCounter("test.register.counter") == c);
+    CHECK(Metrics::Find("test.register.gauge") == g);
+    CHECK(Metrics::Find("test.register.histogram") == h);
+    CHECK(Metrics::Find("test.register.unknown") == InvalidIndex);
+}
+
+//------------------------------------------------------------------------------
+TEST(MetricsCounterGaugeTest) {
+    const Metrics::Id counter = Metrics::RegisterCounter("test.counter");
+    const Metrics::Id gauge = Metrics::RegisterGauge("test.gauge");
+    const int32 numThreads = 4;
+    const int32 numAdds = 100000;
+    Array<std::thread> threads;
+    for (int32 i = 0; i < numThreads; i++) {
+        threads.AddBack(std::thread([counter, gauge]() {
+            for (int32 j = 0; j < numAdds; j++) {
+                Metrics::Add(counter);
+            }
+            Metrics::Add(gauge, 10);
+        }));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    // the contributions of finished threads are kept
+    CHECK(Metrics::Value(counter) == numThreads * numAdds);
+    CHECK(Metrics::Value(gauge) == numThreads * 10);
+    // a gauge can be decremented on another thread
+    Metrics::Add(gauge, -numThreads * 10);
+    CHECK(Metrics::Value(gauge) == 0);
+    // Set() replaces the calling thread's contribution
+    const Metrics::Id setGauge = Metrics::RegisterGauge("test.gauge.set");
+    Metrics::Set(setGauge, 5);
+    Metrics::Set(setGauge, 3);
+    CHECK(Metrics::Value(setGauge) == 3);
+    std::thread t([setGauge]() {
+        Metrics::Set(setGauge, 2);
+    });
+    t.join();
+    CHECK(Metrics::Value(setGauge) == 5);
+}
+
+//------------------------------------------------------------------------------
+TEST(MetricsHistogramTest) {
+    // buckets are contiguous, with a relative error of at most 1/16
+    CHECK(Metrics::HistogramBucket(0) == 0);
+    CHECK(Metrics::HistogramBucket(15) == 15);
+    CHECK(Metrics::HistogramBucket(16) == 16);
+    CHECK(Metrics::HistogramBucket(INT64_MAX) == Metrics::NumHistogramBuckets - 1);
+    for (int32 b = 0; b < Metrics::NumHistogramBuckets - 1; b++) {
+        CHECK(Metrics::HistogramBucketMax(b) + 1 == Metrics::HistogramBucketMin(b + 1));
+        CHECK(Metrics::HistogramBucket(Metrics::HistogramBucketMin(b)) == b);
+        CHECK(Metrics::HistogramBucket(Metrics::HistogramBucketMax(b)) == b);
+        const int64 width = Metrics::HistogramBucketMax(b) - Metrics::HistogramBucketMin(b) + 1;
+        CHECK(width * 16 <= Metrics::HistogramBucketMin(b) || width == 1);
+    }
+
+    // record 1..10000 from 2 threads
+    const Metrics::Id hist = Metrics::RegisterHistogram("test.histogram");
+    std::thread t([hist]() {
+        for (int64 i = 1; i <= 10000; i += 2) {
+            Metrics::Record(hist, i);
+        }
+    });
+    for (int64 i = 2; i <= 10000; i += 2) {
+        Metrics::Record(hist, i);
+    }
+    t.join();
+    Array<Metrics::Sample> samples = Metrics::Collect();
+    const Metrics::Sample* s = findSample(samples, "test.histogram");
+    CHECK(nullptr != s);
+    CHECK(s->Type == Metrics::Type::Histogram);
+    CHECK(s->Value == 10000);
+    CHECK(s->Sum == 50005000);
+    CHECK(s->Min == 1);
+    CHECK(s->Max == 10000);
+    CHECK((s->P50 >= 5000) && (s->P50 <= 5000 + 5000 / 16));
+    CHECK((s->P90 >= 9000) && (s->P90 <= 9000 + 9000 / 16));
+    CHECK((s->P99 >= 9900) && (s->P99 <= 10000));
+    CHECK((s->P999 >= 9990) && (s->P999 <= 10000));
+}
+
+//------------------------------------------------------------------------------
+TEST(MetricsExportTest) {
+    const Metrics::Id counter = Metrics::RegisterCounter("test.export.counter");
+    const Metrics::Id gauge = Metrics::RegisterGauge("test.export.gauge");
+    Metrics::Add(counter, 100);
+    Metrics::Set(gauge, 7);
+    Metrics::Collect();
+    Metrics::Add(counter, 100);
+    Array<Metrics::Sample> samples = Metrics::Collect();
+    const Metrics::Sample* s = findSample(samples, "test.export.counter");
+    CHECK(nullptr != s);
+    CHECK(s->Value == 200);
+    CHECK(s->Rate > 0.0);
+
+    String text = Metrics::Format(samples);
+    CHECK(nullptr != std::strstr(text.AsCStr(), "counter test.export.counter 200 rate="));
+    CHECK(nullptr != std::strstr(text.AsCStr(), "gauge test.export.gauge 7\n"));
+    CHECK(nullptr != std::strstr(text.AsCStr(), "histogram test.histogram count=10000 "));
+
+    // exporters
+    Ptr<testExporter> exp = testExporter::Create();
+    Metrics::AddExporter(exp);
+    Metrics::Export();
+    CHECK(exp->numExports == 1);
+    CHECK(exp->numSamples == samples.Size());
+
+    // periodic export from the RunLoop timers
+    RunLoop* runLoop = CoreFacade::Instance()->RunLoop();
+    const Clock::Ticks interval = Clock::FromMilliSeconds(10.0);
+    Metrics::StartExport(interval);
+    runLoop->Run(runLoop->Timers().Time() + interval * 2);
+    CHECK(exp->numExports == 2);
+    Metrics::StopExport();
+    runLoop->Run(runLoop->Timers().Time() + interval * 4);
+    CHECK(exp->numExports == 2);
+    Metrics::RemoveExporter(exp);
+    Metrics::Export();
+    CHECK(exp->numExports == 2);
+
+    // file exporter appends to a local file
+    const char* path = "metrics_test.txt";
+    std::remove(path);
+    Ptr<FileMetricsExporter> fileExp = FileMetricsExporter::Create(path);
+    Metrics::AddExporter(fileExp);
+    Metrics::Export();
+    Metrics::Export();
+    Metrics::RemoveExporter(fileExp);
+    FILE* fp = std::fopen(path, "r");
+    CHECK(nullptr != fp);
+    if (fp) {
+        char line[512];
+        int32 numTimeLines = 0;
+        int32 numGaugeLines = 0;
+        while (std::fgets(line, sizeof(line), fp)) {
+            if (0 == std::strncmp(line, "# time=", 7)) {
+                numTimeLines++;
+            }
+            if (0 == std::strcmp(line, "gauge test.export.gauge 7\n")) {
+                numGaugeLines++;
+            }
+        }
+        std::fclose(fp);
+        CHECK(numTimeLines == 2);
+        CHECK(numGaugeLines == 2);
+    }
+    std::remove(path);
+    Metrics::Set(gauge, 0);
+}
+
+//------------------------------------------------------------------------------
+TEST(MetricsOverheadTest) {
+    const Metrics::Id counter = Metrics::RegisterCounter("test.overhead.counter");
+    const Metrics::Id hist = Metrics::RegisterHistogram("test.overhead.histogram");
+    const int32 num = 1000000;
+    Clock::Ticks start = Clock::Now();
+    for (int32 i = 0; i < num; i++) {
+        Metrics::Add(counter);
+    }
+    const float64 addNs = float64(Clock::Since(start)) / num;
+    start = Clock::Now();
+    for (int32 i = 0; i < num; i++) {
+        Metrics::Record(hist, i);
+    }
+    const float64 recordNs = float64(Clock::Since(start)) / num;
+    CHECK(Metrics::Value(counter) == num);
+    Log::Info("Metrics: Add(): %.1fns, Record(): %.1fns\n", addNs, recordNs);
+}
@@ -0,0 +1,103 @@
+//------------------------------------------------------------------------------
+//  MutexTest.cc
+//  Test the adaptive Mutex.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/Threading/Mutex.h"
+#include "Core/Containers/Array.h"
+#include "Core/Log.h"
+#include <thread>
+#include <mutex>
+#include <chrono>
+
+using namespace std;
+using namespace Oryol;
+using namespace Oryol::Core;
+
+TEST(MutexTest) {
+    Mutex mutex;
+    CHECK(mutex.TryLock());
+    CHECK(!mutex.TryLock());
+    mutex.Unlock();
+    mutex.Lock();
+    CHECK(!mutex.TryLock());
+    mutex.Unlock();
+
+    #if ORYOL_HAS_THREADS
+    // a non-atomic counter protected by the mutex
+    const int32 numThreads = 4;
+    const int32 numIncrements = 100000;
+    int32 counter = 0;
+    Array<std::thread> threads;
+    for (int32 t = 0; t < numThreads; t++) {
+        threads.AddBack(std::thread([&mutex, &counter]() {
+            for (int32 i = 0; i < numIncrements; i++) {
+                mutex.Lock();
+                counter++;
+                mutex.Unlock();
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    CHECK(counter == numThreads * numIncrements);
+
+    // a thread sleeping on a held lock is woken up
+    mutex.Lock();
+    std::atomic<bool> acquired{false};
+    std::thread waiter([&mutex, &acquired]() {
+        mutex.Lock();
+        acquired = true;
+        mutex.Unlock();
+    });
+    std::this_thread::sleep_for(chrono::milliseconds(20));
+    CHECK(!acquired.load());
+    mutex.Unlock();
+    waiter.join();
+    CHECK(acquired.load());
+    #endif
+}
+
+#if ORYOL_HAS_THREADS
+//------------------------------------------------------------------------------
+template<class LOCK> static float64
+mutexBenchmark(LOCK& lock, int32 numThreads, int32 numIterations) {
+    int32 counter = 0;
+    Array<std::thread> threads;
+    chrono::time_point<chrono::steady_clock> start = chrono::steady_clock::now();
+    for (int32 t = 0; t < numThreads; t++) {
+        threads.AddBack(std::thread([&lock, &counter, numIterations]() {
+            for (int32 i = 0; i < numIterations; i++) {
+                lock.lock();
+                counter++;
+                lock.unlock();
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    chrono::duration<double> dur = chrono::steady_clock::now() - start;
+    return (dur.count() * 1000000000.0) / (numThreads * numIterations);
+}
+
+// adapter for the std::mutex interface
+struct mutexAdapter {
+    Mutex mutex;
+    void lock() { this->mutex.Lock(); };
+    void unlock() { this->mutex.Unlock(); };
+};
+
+TEST(MutexContentionBenchmark) {
+    const int32 numIterations = 200000;
+    for (int32 numThreads = 1; numThreads <= 8; numThreads *= 2) {
+        mutexAdapter mutex;
+        std::mutex stdMutex;
+        const float64 t0 = mutexBenchmark(mutex, numThreads, numIterations);
+        const float64 t1 = mutexBenchmark(stdMutex, numThreads, numIterations);
+        Log::Info("Mutex: %d threads: Mutex %.1f ns, std::mutex %.1f ns per lock\n", numThreads, t0, t1);
+    }
+}
+#endif
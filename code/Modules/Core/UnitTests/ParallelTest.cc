@@ -0,0 +1,216 @@
+//------------------------------------------------------------------------------
+//  ParallelTest.cc
+//  Test parallel algorithms.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/Threading/Parallel.h"
+#include "Core/Threading/JobSystem.h"
+#include "Core/Containers/Array.h"
+#include "Core/Containers/Map.h"
+#include "Core/Log.h"
+#include <chrono>
+#include <cmath>
+#include <atomic>
+
+using namespace std;
+using namespace Oryol;
+using namespace Oryol::Core;
+
+// fill an array with pseudo-random numbers (xorshift)
+static void fillRandom(Array<int32>& array, int32 num, uint32 seed) {
+    array.Clear();
+    array.Reserve(num);
+    for (int32 i = 0; i < num; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        array.AddBack(int32(seed & 0x7FFFFFFF));
+    }
+}
+
+// run the correctness checks with the current Parallel setup
+static void checkAlgorithms() {
+
+    // For() must visit each index exactly once
+    const int32 num = 100000;
+    Array<int32> visits;
+    for (int32 i = 0; i < num; i++) {
+        visits.AddBack(0);
+    }
+    int32* visitPtr = visits.begin();
+    Parallel::For(0, num, [visitPtr](int32 begin, int32 end) {
+        for (int32 i = begin; i < end; i++) {
+            visitPtr[i]++;
+        }
+    });
+    int32 numBad = 0;
+    for (int32 v : visits) {
+        if (v != 1) {
+            numBad++;
+        }
+    }
+    CHECK(numBad == 0);
+    std::atomic<int32> numCalls{0};
+    Parallel::For(10, 20, [&numCalls](int32 begin, int32 end) {
+        numCalls += end - begin;
+    }, 100);
+    CHECK(numCalls == 10);
+    Parallel::For(5, 5, [&numCalls](int32 begin, int32 end) {
+        numCalls++;
+    });
+    CHECK(numCalls == 10);
+
+    // Transform()
+    Array<int32> src;
+    fillRandom(src, num, 12345);
+    Array<int64> dst;
+    Parallel::Transform(src, dst, [](int32 x) { return int64(x) * 2; });
+    CHECK(dst.Size() == num);
+    numBad = 0;
+    for (int32 i = 0; i < num; i++) {
+        if (dst[i] != int64(src[i]) * 2) {
+            numBad++;
+        }
+    }
+    CHECK(numBad == 0);
+
+    // Reduce()
+    int64 refSum = 0;
+    for (int32 x : src) {
+        refSum += x;
+    }
+    int64 sum = Parallel::Reduce(src, int64(0),
+        [](int64 acc, int32 x) { return acc + x; },
+        [](int64 a, int64 b) { return a + b; });
+    CHECK(sum == refSum);
+    int32 maxVal = Parallel::Reduce(src, 0,
+        [](int32 acc, int32 x) { return std::max(acc, x); },
+        [](int32 a, int32 b) { return std::max(a, b); });
+    CHECK(maxVal == *std::max_element(src.begin(), src.end()));
+    Array<int32> empty;
+    CHECK(Parallel::Reduce(empty, 7, [](int32 a, int32 x) { return a + x; }, [](int32 a, int32 b) { return a + b; }) == 7);
+
+    // Sort()
+    for (int32 size : { 0, 1, 100, Parallel::MinSortSize - 1, Parallel::MinSortSize, 250001 }) {
+        Array<int32> array;
+        fillRandom(array, size, 4711 + size);
+        Array<int32> ref = array;
+        std::sort(ref.begin(), ref.end());
+        Parallel::Sort(array);
+        CHECK(std::equal(ref.begin(), ref.end(), array.begin()));
+    }
+    Array<int32> desc;
+    fillRandom(desc, 100000, 99);
+    Parallel::Sort(desc.begin(), desc.end(), [](int32 a, int32 b) { return a > b; });
+    CHECK(std::is_sorted(desc.begin(), desc.end(), [](int32 a, int32 b) { return a > b; }));
+
+    // Map::EndBulk() sorts in parallel
+    Map<int32, int32> map;
+    map.BeginBulk();
+    for (int32 i = 0; i < 50000; i++) {
+        map.InsertBulk((i * 7919) % 50000, i);
+    }
+    map.EndBulk();
+    CHECK(map.Size() == 50000);
+    numBad = 0;
+    for (int32 i = 0; i < 50000; i++) {
+        if ((map.KeyAtIndex(i) != i) || (((int64(map.ValueAtIndex(i)) * 7919) % 50000) != i)) {
+            numBad++;
+        }
+    }
+    CHECK(numBad == 0);
+    CHECK(std::is_sorted(map.begin(), map.end()));
+}
+
+TEST(ParallelTest) {
+    // default CoreFacade JobSystem
+    checkAlgorithms();
+
+    #if ORYOL_HAS_THREADS
+    // more workers than cores, exercises stealing and chunk merging
+    {
+        JobSystem jobSystem(3);
+        Parallel::SetJobSystem(&jobSystem);
+        CHECK(Parallel::NumThreads() == 4);
+        checkAlgorithms();
+        Parallel::SetJobSystem(nullptr);
+    }
+    // serial fallback
+    {
+        JobSystem jobSystem(0);
+        Parallel::SetJobSystem(&jobSystem);
+        CHECK(Parallel::NumThreads() == 1);
+        checkAlgorithms();
+        Parallel::SetJobSystem(nullptr);
+    }
+    #endif
+}
+
+#if ORYOL_HAS_THREADS
+// speedup curves for 1..N threads on container-sized workloads
+TEST(ParallelBenchmark) {
+    const int32 num = 1 << 20;
+    Array<int32> src;
+    fillRandom(src, num, 1);
+    Array<float32> dst;
+    Parallel::Transform(src, dst, [](int32 x) { return float32(x); });
+
+    const int32 maxThreads = JobSystem::DefaultNumWorkers() + 1;
+    Array<int32> threadCounts;
+    for (int32 numThreads = 1; numThreads < maxThreads; numThreads *= 2) {
+        threadCounts.AddBack(numThreads);
+    }
+    threadCounts.AddBack(maxThreads);
+
+    float64 baseFor = 0.0, baseTransform = 0.0, baseReduce = 0.0, baseSort = 0.0;
+    for (int32 numThreads : threadCounts) {
+        JobSystem jobSystem(numThreads - 1);
+        Parallel::SetJobSystem(&jobSystem);
+        chrono::time_point<chrono::system_clock> start;
+
+        start = chrono::system_clock::now();
+        std::atomic<int32> checksum{0};
+        const int32* srcPtr = src.begin();
+        Parallel::For(0, num, [srcPtr, &checksum](int32 begin, int32 end) {
+            float64 acc = 0.0;
+            for (int32 i = begin; i < end; i++) {
+                acc += std::sqrt(float64(srcPtr[i]));
+            }
+            checksum += int32(acc > 0.0);
+        });
+        chrono::duration<double> durFor = chrono::system_clock::now() - start;
+
+        start = chrono::system_clock::now();
+        Parallel::Transform(src, dst, [](int32 x) { return std::sqrt(float32(x)); });
+        chrono::duration<double> durTransform = chrono::system_clock::now() - start;
+
+        start = chrono::system_clock::now();
+        float64 sum = Parallel::Reduce(src, 0.0,
+            [](float64 acc, int32 x) { return acc + std::sqrt(float64(x)); },
+            [](float64 a, float64 b) { return a + b; });
+        chrono::duration<double> durReduce = chrono::system_clock::now() - start;
+        CHECK(sum > 0.0);
+
+        Array<int32> sorted = src;
+        start = chrono::system_clock::now();
+        Parallel::Sort(sorted);
+        chrono::duration<double> durSort = chrono::system_clock::now() - start;
+        CHECK(std::is_sorted(sorted.begin(), sorted.end()));
+
+        Parallel::SetJobSystem(nullptr);
+        if (1 == numThreads) {
+            baseFor = durFor.count();
+            baseTransform = durTransform.count();
+            baseReduce = durReduce.count();
+            baseSort = durSort.count();
+        }
+        Log::Info("Parallel %d threads, %d elements: For %f sec (%.2fx), Transform %f sec (%.2fx), Reduce %f sec (%.2fx), Sort %f sec (%.2fx)\n",
+            numThreads, num,
+            durFor.count(), baseFor / durFor.count(),
+            durTransform.count(), baseTransform / durTransform.count(),
+            durReduce.count(), baseReduce / durReduce.count(),
+            durSort.count(), baseSort / durSort.count());
+    }
+}
+#endif
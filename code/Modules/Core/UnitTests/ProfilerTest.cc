@@ -0,0 +1,101 @@
+//------------------------------------------------------------------------------
+//  ProfilerTest.cc
+//  Test the CPU profiler.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/Profiler.h"
+#include "Core/CoreFacade.h"
+#include "Core/RunLoop.h"
+#include "Core/Log.h"
+#include <thread>
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+using namespace Oryol;
+using namespace Oryol::Core;
+
+#if ORYOL_PROFILING
+static void profThreadFunc() {
+    CoreFacade::EnterThread();
+    o_prof_thread_name("ProfilerTest \"worker\"");
+    for (int32 i = 0; i < 10; i++) {
+        o_prof_scope("workerScope");
+    }
+    CoreFacade::LeaveThread();
+}
+
+TEST(ProfilerTest) {
+    // nothing is recorded outside of a capture
+    CHECK(!Profiler::IsCapturing());
+    CHECK(!Profiler::Begin("notRecorded"));
+    {
+        o_prof_scope("notRecorded");
+    }
+
+    Profiler::BeginCapture();
+    CHECK(Profiler::IsCapturing());
+    o_prof_thread_name("main");
+    {
+        o_prof_scope("outer");
+        for (int32 i = 0; i < 3; i++) {
+            o_prof_scope("inner");
+        }
+    }
+    std::thread t(profThreadFunc);
+    t.join();
+    // RunLoop callbacks are instrumented with the callback name
+    CoreFacade::Instance()->RunLoop()->Add(RunLoop::Callback("profilerTestCallback", 0, []() { }));
+    CoreFacade::Instance()->RunLoop()->Run();
+    CoreFacade::Instance()->RunLoop()->Remove("profilerTestCallback");
+    Profiler::EndCapture();
+    CHECK(!Profiler::IsCapturing());
+    {
+        o_prof_scope("notRecorded");
+    }
+
+    // outer + 3 inner + 10 worker + RunLoop::Run + callback
+    CHECK(Profiler::NumCapturedEvents() == 16);
+    String json = Profiler::ChromeTrace();
+    const char* str = json.AsCStr();
+    CHECK(std::strstr(str, "\"traceEvents\":[") != nullptr);
+    CHECK(std::strstr(str, "\"name\":\"outer\"") != nullptr);
+    CHECK(std::strstr(str, "\"name\":\"inner\"") != nullptr);
+    CHECK(std::strstr(str, "\"name\":\"workerScope\"") != nullptr);
+    CHECK(std::strstr(str, "\"name\":\"RunLoop::Run\"") != nullptr);
+    CHECK(std::strstr(str, "\"name\":\"profilerTestCallback\"") != nullptr);
+    CHECK(std::strstr(str, "\"args\":{\"name\":\"main\"}") != nullptr);
+    CHECK(std::strstr(str, "\"args\":{\"name\":\"ProfilerTest \\\"worker\\\"\"}") != nullptr);
+    CHECK(std::strstr(str, "notRecorded") == nullptr);
+
+    // a new capture starts empty, the ring buffer keeps the latest events
+    Profiler::BeginCapture();
+    CHECK(Profiler::NumCapturedEvents() == 0);
+    const int32 numEvents = ORYOL_PROFILER_EVENTS_PER_THREAD + 100;
+    for (int32 i = 0; i < numEvents; i++) {
+        o_prof_scope("overflow");
+    }
+    Profiler::EndCapture();
+    CHECK(Profiler::NumCapturedEvents() == ORYOL_PROFILER_EVENTS_PER_THREAD - 1);
+}
+
+TEST(ProfilerOverhead) {
+    const int32 numScopes = 1000000;
+    for (int32 capture = 0; capture < 2; capture++) {
+        if (capture) {
+            Profiler::BeginCapture();
+        }
+        chrono::time_point<chrono::system_clock> start = chrono::system_clock::now();
+        for (int32 i = 0; i < numScopes; i++) {
+            o_prof_scope("overhead");
+        }
+        chrono::duration<double> dur = chrono::system_clock::now() - start;
+        if (capture) {
+            Profiler::EndCapture();
+        }
+        Log::Info("Profiler: %d scopes (%s): %f sec, %.1f ns per scope\n", numScopes,
+            capture ? "capturing" : "not capturing", dur.count(), (dur.count() * 1000000000.0) / numScopes);
+    }
+}
+#endif
@@ -0,0 +1,174 @@
+//------------------------------------------------------------------------------
+//  RWLockTest.cc
+//  Test the reader-writer lock.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/Threading/RWLock.h"
+#include "Core/Containers/Array.h"
+#include "Core/Log.h"
+#include <thread>
+#include <mutex>
+#include <chrono>
+#if ORYOL_POSIX
+#include <pthread.h>
+#endif
+
+using namespace std;
+using namespace Oryol;
+using namespace Oryol::Core;
+
+#if ORYOL_HAS_THREADS
+TEST(RWLockTest) {
+    // writers keep two values equal, readers must never see them differ
+    RWLock lock;
+    int64 val0 = 0, val1 = 0;
+    std::atomic<bool> stop{false};
+    std::atomic<int32> numBroken{0};
+    std::atomic<int32> numReads{0};
+    Array<std::thread> threads;
+    for (int32 t = 0; t < 4; t++) {
+        threads.AddBack(std::thread([&]() {
+            while (!stop) {
+                lock.LockRead();
+                if (val0 != val1) {
+                    numBroken++;
+                }
+                lock.UnlockRead();
+                numReads++;
+            }
+        }));
+    }
+    // writers make progress while readers hammer the lock
+    const int32 numWrites = 1000;
+    Array<std::thread> writers;
+    for (int32 t = 0; t < 2; t++) {
+        writers.AddBack(std::thread([&]() {
+            for (int32 i = 0; i < numWrites; i++) {
+                lock.LockWrite();
+                val0++;
+                val1++;
+                lock.UnlockWrite();
+            }
+        }));
+    }
+    for (auto& thread : writers) {
+        thread.join();
+    }
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    CHECK(numBroken.load() == 0);
+    CHECK(val0 == 2 * numWrites);
+    CHECK(numReads.load() > 0);
+
+    // a writer waits for active readers, readers wait for the active writer
+    lock.LockRead();
+    std::atomic<bool> written{false};
+    std::thread writer([&lock, &written]() {
+        lock.LockWrite();
+        written = true;
+        lock.UnlockWrite();
+    });
+    std::this_thread::sleep_for(chrono::milliseconds(20));
+    CHECK(!written.load());
+    lock.UnlockRead();
+    writer.join();
+    CHECK(written.load());
+
+    lock.LockWrite();
+    std::atomic<bool> read{false};
+    std::thread reader([&lock, &read]() {
+        lock.LockRead();
+        read = true;
+        lock.UnlockRead();
+    });
+    std::this_thread::sleep_for(chrono::milliseconds(20));
+    CHECK(!read.load());
+    lock.UnlockWrite();
+    reader.join();
+    CHECK(read.load());
+}
+
+//------------------------------------------------------------------------------
+// lock adapters with a common interface for the benchmark
+struct rwLockAdapter {
+    RWLock lock;
+    void lockRead() { this->lock.LockRead(); };
+    void unlockRead() { this->lock.UnlockRead(); };
+    void lockWrite() { this->lock.LockWrite(); };
+    void unlockWrite() { this->lock.UnlockWrite(); };
+};
+struct stdMutexAdapter {
+    std::mutex lock;
+    void lockRead() { this->lock.lock(); };
+    void unlockRead() { this->lock.unlock(); };
+    void lockWrite() { this->lock.lock(); };
+    void unlockWrite() { this->lock.unlock(); };
+};
+#if ORYOL_POSIX
+// std::shared_mutex is a thin wrapper around pthread_rwlock_t on POSIX platforms
+struct pthreadRWLockAdapter {
+    pthread_rwlock_t lock;
+    pthreadRWLockAdapter() { pthread_rwlock_init(&this->lock, nullptr); };
+    ~pthreadRWLockAdapter() { pthread_rwlock_destroy(&this->lock); };
+    void lockRead() { pthread_rwlock_rdlock(&this->lock); };
+    void unlockRead() { pthread_rwlock_unlock(&this->lock); };
+    void lockWrite() { pthread_rwlock_wrlock(&this->lock); };
+    void unlockWrite() { pthread_rwlock_unlock(&this->lock); };
+};
+#endif
+
+//------------------------------------------------------------------------------
+// each thread does numOps lock operations, one in writeRatio is a write
+template<class LOCK> static float64
+rwLockBenchmark(int32 numThreads, int32 numOps, int32 writeRatio) {
+    LOCK lock;
+    int32 table[16] = { };
+    std::atomic<int32> sink{0};
+    Array<std::thread> threads;
+    chrono::time_point<chrono::steady_clock> start = chrono::steady_clock::now();
+    for (int32 t = 0; t < numThreads; t++) {
+        threads.AddBack(std::thread([&lock, &table, &sink, numOps, writeRatio, t]() {
+            int32 sum = 0;
+            for (int32 i = 0; i < numOps; i++) {
+                if (((i + t) % writeRatio) == 0) {
+                    lock.lockWrite();
+                    table[i & 15]++;
+                    lock.unlockWrite();
+                }
+                else {
+                    lock.lockRead();
+                    sum += table[i & 15];
+                    lock.unlockRead();
+                }
+            }
+            sink += sum;
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    chrono::duration<double> dur = chrono::steady_clock::now() - start;
+    return (dur.count() * 1000000000.0) / (numThreads * numOps);
+}
+
+TEST(RWLockContentionBenchmark) {
+    const int32 numOps = 100000;
+    const int32 writeRatios[] = { 10000, 20 };
+    for (int32 writeRatio : writeRatios) {
+        for (int32 numThreads = 1; numThreads <= 8; numThreads *= 2) {
+            const float64 t0 = rwLockBenchmark<rwLockAdapter>(numThreads, numOps, writeRatio);
+            const float64 t1 = rwLockBenchmark<stdMutexAdapter>(numThreads, numOps, writeRatio);
+            #if ORYOL_POSIX
+            const float64 t2 = rwLockBenchmark<pthreadRWLockAdapter>(numThreads, numOps, writeRatio);
+            #else
+            const float64 t2 = 0.0;
+            #endif
+            Log::Info("RWLock: %d threads, 1/%d writes: RWLock %.1f ns, std::mutex %.1f ns, pthread_rwlock %.1f ns per op\n",
+                numThreads, writeRatio, t0, t1, t2);
+        }
+    }
+}
+#endif
@@ -5,9 +5,16 @@
 #include "Pre.h"
 #include "UnitTest++/src/UnitTest++.h"
 #include "Core/RunLoop.h"
+#include "Core/Threading/JobSystem.h"
+#include "Core/Log.h"
+#include "Core/String/StringBuilder.h"
+#include <thread>
+#include <chrono>
+#include <cmath>
 
 using namespace Oryol;
 using namespace Oryol::Core;
+using namespace std;
 
 static int32 cb0Value = 0;
 
@@ -50,3 +57,195 @@ TEST(RunLoopTest) {
     CHECK(runLoop->Callbacks().ValueAtIndex(0).Name() == "callback0");
     runLoop = 0;
 }
+
+TEST(RunLoopPhaseTest) {
+    Ptr<RunLoop> runLoop = RunLoop::Create();
+    Array<int32> order;
+    runLoop->Add(RunLoop::Callback("render", 0, [&order]() { order.AddBack(3); }).SetPhase(RunLoop::Phase::RenderSubmit));
+    runLoop->Add(RunLoop::Callback("update1", 1, [&order]() { order.AddBack(2); }));
+    runLoop->Add(RunLoop::Callback("update0", 0, [&order]() { order.AddBack(1); }));
+    runLoop->Add(RunLoop::Callback("input", 5, [&order]() { order.AddBack(0); }).SetPhase(RunLoop::Phase::Input));
+    CHECK(!runLoop->HasCallback("input"));
+    runLoop->Run();
+    CHECK(runLoop->HasCallback("input"));
+    CHECK(!runLoop->HasCallback("bla"));
+    CHECK(order.Size() == 4);
+    for (int32 i = 0; i < order.Size(); i++) {
+        CHECK(order[i] == i);
+    }
+
+    // removed callbacks can be added again
+    runLoop->Remove("update1");
+    runLoop->Run();
+    CHECK(!runLoop->HasCallback("update1"));
+    runLoop->Add(RunLoop::Callback("update1", 1, [&order]() { order.AddBack(2); }));
+    order.Clear();
+    runLoop->Run();
+    CHECK(order.Size() == 4);
+    runLoop->Remove("update1");
+    runLoop->Run();
+}
+
+TEST(RunLoopTimeTest) {
+    Ptr<RunLoop> runLoop = RunLoop::Create();
+    const Clock::Ticks ms = Clock::FromMilliSeconds(1.0);
+    runLoop->SetFixedTimestep(10 * ms, 4);
+    CHECK(runLoop->GetFixedTimestep().StepDuration() == 10 * ms);
+    Array<int32> order;
+    int32 numSteps = 0;
+    runLoop->Add(RunLoop::Callback("input", 0, [&order]() { order.AddBack(0); }).SetPhase(RunLoop::Phase::Input));
+    runLoop->Add(RunLoop::Callback("fixed0", 0, [&order, &numSteps]() { order.AddBack(1); numSteps++; }).SetPhase(RunLoop::Phase::FixedUpdate));
+    runLoop->Add(RunLoop::Callback("fixed1", 1, [&order]() { order.AddBack(2); }).SetPhase(RunLoop::Phase::FixedUpdate));
+    runLoop->Add(RunLoop::Callback("update", 0, [&order]() { order.AddBack(3); }));
+
+    // first frame has no duration, so no fixed steps
+    Clock::Ticks now = Clock::Now();
+    runLoop->Run(now);
+    CHECK(runLoop->FrameDuration() == 0);
+    CHECK(runLoop->FrameTime() == now);
+    CHECK(numSteps == 0);
+    CHECK(order.Size() == 2);
+
+    // 25ms frame: 2 fixed steps, each step runs all fixed callbacks in order
+    order.Clear();
+    now += 25 * ms;
+    runLoop->Run(now);
+    CHECK(runLoop->FrameDuration() == 25 * ms);
+    CHECK(numSteps == 2);
+    CHECK(order.Size() == 6);
+    CHECK((order[0] == 0) && (order[1] == 1) && (order[2] == 2) && (order[3] == 1) && (order[4] == 2) && (order[5] == 3));
+    CHECK(runLoop->GetFixedTimestep().Alpha() == 0.5);
+
+    // a 16.67ms frame rate averages out to the fixed rate
+    numSteps = 0;
+    for (int32 i = 0; i < 60; i++) {
+        now += Clock::TicksPerSecond / 60;
+        runLoop->Run(now);
+    }
+    CHECK((numSteps >= 99) && (numSteps <= 101));
+
+    // timers fire at the start of the first frame after they're due
+    // (rounded up to the timer resolution)
+    int32 timerFrame = 0, frame = 0;
+    runLoop->Add(RunLoop::Callback("frame", 10, [&frame]() { frame++; }));
+    runLoop->Run(now);
+    runLoop->Timers().Add(45 * ms, [&timerFrame, &frame]() { timerFrame = frame; });
+    for (int32 i = 0; i < 10; i++) {
+        now += 10 * ms;
+        runLoop->Run(now);
+    }
+    CHECK(timerFrame == 5);
+
+    // without fixed timestep, fixed update callbacks run once per frame
+    runLoop->SetFixedTimestep(0);
+    numSteps = 0;
+    runLoop->Run(now);
+    runLoop->Run(now + 100 * ms);
+    CHECK(numSteps == 2);
+}
+
+#if ORYOL_HAS_THREADS
+TEST(RunLoopScheduledTest) {
+    JobSystem jobSystem(3);
+    Ptr<RunLoop> runLoop = RunLoop::Create();
+    runLoop->SetJobSystem(&jobSystem);
+    runLoop->SetScheduled(true);
+    CHECK(runLoop->IsScheduled());
+
+    // a dependency chain a -> b -> c, and independent callbacks
+    const std::thread::id mainThreadId = std::this_thread::get_id();
+    int32 a = 0, b = 0, c = 0;
+    bool chainOk = true;
+    bool exclusiveOnMainThread = true;
+    std::atomic<int32> numIndependent{0};
+    runLoop->Add(RunLoop::Callback("a", 0, [&a]() { a++; }).Writes("a"));
+    runLoop->Add(RunLoop::Callback("b", 1, [&a, &b]() { b = a * 10; }).Reads("a").Writes("b"));
+    runLoop->Add(RunLoop::Callback("c", 2, [&b, &c]() { c = b + 1; }).Reads("b").Writes("c"));
+    runLoop->Add(RunLoop::Callback("check", 0, [&]() {
+        chainOk &= (c == (a * 10 + 1));
+        exclusiveOnMainThread &= (std::this_thread::get_id() == mainThreadId);
+    }).SetPhase(RunLoop::Phase::RenderSubmit));
+    StringBuilder builder;
+    for (int32 i = 0; i < 8; i++) {
+        builder.Format(32, "independent%d", i);
+        StringAtom res(builder.GetString());
+        runLoop->Add(RunLoop::Callback(res, i, [&numIndependent]() { numIndependent++; }).Writes(res));
+    }
+    const int32 numFrames = 100;
+    for (int32 i = 0; i < numFrames; i++) {
+        runLoop->Run();
+    }
+    CHECK(a == numFrames);
+    CHECK(chainOk);
+    CHECK(exclusiveOnMainThread);
+    CHECK(numIndependent.load() == 8 * numFrames);
+
+    // two independent callbacks which only finish if they run concurrently
+    std::atomic<int32> numStarted{0};
+    std::atomic<bool> concurrent{true};
+    auto rendezvous = [&numStarted, &concurrent]() {
+        numStarted++;
+        chrono::time_point<chrono::steady_clock> start = chrono::steady_clock::now();
+        while (numStarted < 2) {
+            if ((chrono::steady_clock::now() - start) > chrono::seconds(5)) {
+                concurrent = false;
+                break;
+            }
+            std::this_thread::yield();
+        }
+    };
+    Ptr<RunLoop> runLoop2 = RunLoop::Create();
+    runLoop2->SetJobSystem(&jobSystem);
+    runLoop2->SetScheduled(true);
+    runLoop2->Add(RunLoop::Callback("x", 0, rendezvous).Writes("x"));
+    runLoop2->Add(RunLoop::Callback("y", 0, rendezvous).Writes("y"));
+    runLoop2->Run();
+    CHECK(concurrent.load());
+}
+
+// a deliberately CPU-heavy callback
+static float64 runLoopWork(int32 numIterations) {
+    float64 sum = 0.0;
+    for (int32 i = 0; i < numIterations; i++) {
+        sum += std::sqrt(float64(i));
+    }
+    return sum;
+}
+
+TEST(RunLoopScheduledBenchmark) {
+    // 4 chains of 4 dependent callbacks each, plus an exclusive callback
+    JobSystem jobSystem(JobSystem::DefaultNumWorkers());
+    Ptr<RunLoop> runLoop = RunLoop::Create();
+    runLoop->SetJobSystem(&jobSystem);
+    const int32 numIterations = 20000;
+    std::atomic<int32> sink{0};
+    StringBuilder builder;
+    for (int32 chain = 0; chain < 4; chain++) {
+        for (int32 i = 0; i < 4; i++) {
+            builder.Format(32, "work%d_%d", chain, i);
+            StringAtom name(builder.GetString());
+            builder.Format(32, "chain%d", chain);
+            StringAtom res(builder.GetString());
+            runLoop->Add(RunLoop::Callback(name, i, [&sink, numIterations]() {
+                sink += int32(runLoopWork(numIterations)) & 1;
+            }).Writes(res));
+        }
+    }
+    runLoop->Add(RunLoop::Callback("submit", 0, [&sink, numIterations]() {
+        sink += int32(runLoopWork(numIterations)) & 1;
+    }).SetPhase(RunLoop::Phase::RenderSubmit));
+
+    const int32 numFrames = 50;
+    for (int32 scheduled = 0; scheduled < 2; scheduled++) {
+        runLoop->SetScheduled(0 != scheduled);
+        runLoop->Run();
+        chrono::time_point<chrono::steady_clock> start = chrono::steady_clock::now();
+        for (int32 i = 0; i < numFrames; i++) {
+            runLoop->Run();
+        }
+        chrono::duration<double> dur = chrono::steady_clock::now() - start;
+        Log::Info("RunLoop: %s: %.3f ms per frame (%d workers)\n", scheduled ? "scheduled" : "serial",
+            (dur.count() * 1000.0) / numFrames, jobSystem.NumWorkers());
+    }
+}
+#endif
@@ -0,0 +1,90 @@
+//------------------------------------------------------------------------------
+//  SeqLockTest.cc
+//  Test the sequence lock.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/Threading/SeqLock.h"
+#include "Core/Containers/Array.h"
+#include <thread>
+
+using namespace std;
+using namespace Oryol;
+using namespace Oryol::Core;
+
+// a config table whose entries must always be consistent
+struct seqLockConfig {
+    int32 version;
+    float32 values[13];
+    uint8 flags[3];
+};
+
+TEST(SeqLockTest) {
+    SeqLock<seqLockConfig> config;
+    CHECK(config.Version() == 0);
+    seqLockConfig c = config.Read();
+    CHECK(c.version == 0);
+    CHECK(c.values[12] == 0.0f);
+
+    c.version = 1;
+    for (int32 i = 0; i < 13; i++) {
+        c.values[i] = float32(i);
+    }
+    c.flags[2] = 7;
+    config.Write(c);
+    CHECK(config.Version() == 1);
+    seqLockConfig c1 = config.Read();
+    CHECK(c1.version == 1);
+    CHECK(c1.values[12] == 12.0f);
+    CHECK(c1.flags[2] == 7);
+    config.Update([](seqLockConfig& c) { c.version++; });
+    CHECK(config.Read().version == 2);
+    CHECK(config.Version() == 2);
+
+    #if ORYOL_HAS_THREADS
+    // readers never see a partially written table
+    config.Update([](seqLockConfig& c) {
+        for (int32 i = 0; i < 13; i++) {
+            c.values[i] = float32(c.version + i);
+        }
+    });
+    std::atomic<bool> stop{false};
+    std::atomic<int32> numBroken{0};
+    Array<std::thread> readers;
+    for (int32 t = 0; t < 3; t++) {
+        readers.AddBack(std::thread([&]() {
+            while (!stop) {
+                const seqLockConfig c = config.Read();
+                for (int32 i = 0; i < 13; i++) {
+                    if (c.values[i] != float32(c.version + i)) {
+                        numBroken++;
+                    }
+                }
+            }
+        }));
+    }
+    const int32 numWrites = 20000;
+    Array<std::thread> writers;
+    for (int32 t = 0; t < 2; t++) {
+        writers.AddBack(std::thread([&config]() {
+            for (int32 n = 0; n < numWrites; n++) {
+                config.Update([](seqLockConfig& c) {
+                    c.version++;
+                    for (int32 i = 0; i < 13; i++) {
+                        c.values[i] = float32(c.version + i);
+                    }
+                });
+            }
+        }));
+    }
+    for (auto& thread : writers) {
+        thread.join();
+    }
+    stop = true;
+    for (auto& thread : readers) {
+        thread.join();
+    }
+    CHECK(numBroken.load() == 0);
+    CHECK(config.Read().version == 2 + 2 * numWrites);
+    #endif
+}
@@ -6,6 +6,7 @@
 #include "UnitTest++/src/UnitTest++.h"
 #include "Core/String/StringAtom.h"
 #include "Core/String/String.h"
+#include "Core/String/StringBuilder.h"
 #include "Core/CoreFacade.h"
 
 #include <cstring>
@@ -82,6 +83,115 @@ TEST(StringAtomMultiThreaded) {
     std::thread t1(threadFunc, std::ref(atom0));
     t1.join();
 }
+
+// load a snapshot of the main thread's table into a fresh thread-local table
+static void snapshotThreadFunc(const Array<uint8>& snapshot, int32 numAtoms) {
+
+    Oryol::Core::CoreFacade::EnterThread();
+    
+    CHECK(StringAtom::GetTableStats().numAtoms == 0);
+    CHECK(StringAtom::LoadSnapshot(&snapshot[0], snapshot.Size()) == numAtoms);
+    StringAtom::TableStats stats = StringAtom::GetTableStats();
+    CHECK(stats.numAtoms == numAtoms);
+    CHECK(stats.numChunks == 1);
+    
+    // loading again must not add anything
+    CHECK(StringAtom::LoadSnapshot(&snapshot[0], snapshot.Size()) == 0);
+    CHECK(StringAtom::GetTableStats().numAtoms == numAtoms);
+    CHECK(StringAtom::GetTableStats().numBytesUsed == stats.numBytesUsed);
+    
+    // the seeded strings must be found
+    StringAtom atom("SNAPSHOT_7");
+    CHECK(atom.AsString() == "SNAPSHOT_7");
+    CHECK(StringAtom::GetTableStats().numAtoms == numAtoms);
+    StringAtom newAtom("NOT_IN_SNAPSHOT");
+    CHECK(StringAtom::GetTableStats().numAtoms == numAtoms + 1);
+    
+    // truncated or corrupt snapshots must be rejected
+    CHECK(StringAtom::LoadSnapshot(&snapshot[0], snapshot.Size() - 1) == InvalidIndex);
+    CHECK(StringAtom::LoadSnapshot(&snapshot[0], 8) == InvalidIndex);
+    Array<uint8> corrupt = snapshot;
+    corrupt[0] = 'X';
+    CHECK(StringAtom::LoadSnapshot(&corrupt[0], corrupt.Size()) == InvalidIndex);
+    CHECK(StringAtom::GetTableStats().numAtoms == numAtoms + 1);
+    
+    Oryol::Core::CoreFacade::LeaveThread();
+}
+
+// test string atom table snapshots
+TEST(StringAtomSnapshot) {
+
+    StringBuilder strBuilder;
+    for (int32 i = 0; i < 100; i++) {
+        strBuilder.Format(32, "SNAPSHOT_%d", i);
+        StringAtom atom(strBuilder.GetString());
+    }
+    const int32 numAtoms = StringAtom::GetTableStats().numAtoms;
+    Array<uint8> snapshot = StringAtom::CreateSnapshot();
+    CHECK(snapshot.Size() > 100 * 11);
+    std::thread t1(snapshotThreadFunc, std::ref(snapshot), numAtoms);
+    t1.join();
+}
+
+// check table statistics and chunk size in a fresh thread-local table
+static void statsThreadFunc() {
+
+    Oryol::Core::CoreFacade::EnterThread();
+    
+    StringAtom::TableStats stats = StringAtom::GetTableStats();
+    CHECK(stats.numAtoms == 0);
+    CHECK(stats.numBytesUsed == 0);
+    CHECK(stats.numBytesReserved == 0);
+    CHECK(stats.numChunks == 0);
+    CHECK(stats.numBuckets == 1024);
+    CHECK(stats.numUsedBuckets == 0);
+    CHECK(stats.maxBucketSize == 0);
+    
+    StringAtom atom0("ONE");
+    StringAtom atom1("TWO");
+    StringAtom atom2("ONE");
+    stats = StringAtom::GetTableStats();
+    CHECK(stats.numAtoms == 2);
+    CHECK(stats.numBytesUsed > 0);
+    CHECK(stats.numBytesReserved == 1024);
+    CHECK(stats.numChunks == 1);
+    CHECK((stats.numUsedBuckets >= 1) && (stats.numUsedBuckets <= 2));
+    CHECK(stats.maxBucketSize >= 1);
+    
+    // a string which doesn't fit into a chunk gets a chunk of its own
+    StringBuilder strBuilder;
+    for (int32 i = 0; i < 200; i++) {
+        strBuilder.Append("0123456789");
+    }
+    String longString = strBuilder.GetString();
+    StringAtom atom3(longString);
+    CHECK(atom3.AsString() == longString);
+    stats = StringAtom::GetTableStats();
+    CHECK(stats.numAtoms == 3);
+    CHECK(stats.numChunks == 2);
+    CHECK(stats.numBytesReserved > 2000 + 1024);
+    
+    // fill up the chunks
+    for (int32 i = 0; i < 100; i++) {
+        strBuilder.Format(32, "STAT_%d", i);
+        StringAtom atom(strBuilder.GetString());
+    }
+    stats = StringAtom::GetTableStats();
+    CHECK(stats.numAtoms == 103);
+    CHECK(stats.numChunks > 2);
+    CHECK(stats.numBytesUsed <= stats.numBytesReserved);
+    
+    Oryol::Core::CoreFacade::LeaveThread();
+}
+
+TEST(StringAtomTableStats) {
+    const int32 chunkSize = StringAtom::GetChunkSize();
+    StringAtom::SetChunkSize(1024);
+    CHECK(StringAtom::GetChunkSize() == 1024);
+    std::thread t1(statsThreadFunc);
+    t1.join();
+    StringAtom::SetChunkSize(chunkSize);
+}
 #endif
 
 // test string atom creation performance
@@ -4,7 +4,14 @@
 #include "Pre.h"
 #include "UnitTest++/src/UnitTest++.h"
 #include "Core/String/StringBuilder.h"
+#include "Core/String/simdScan.h"
+#include "Core/Log.h"
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <string>
 
+using namespace std;
 using namespace Oryol;
 using namespace Oryol::Core;
 
@@ -164,6 +171,38 @@ TEST(StringBuilderTest) {
     CHECK(builder.FindFirstOf(0, 4, ":") == InvalidIndex);
     CHECK(builder.FindFirstOf(7, 12, ".") == 10);
     CHECK(builder.FindSubString(0, EndOfString, "://") == 4);
+    CHECK(builder.FindSubString(5, EndOfString, "://") == InvalidIndex);
+    CHECK(builder.FindSubString(0, 5, "://") == 4);
+    CHECK(builder.FindSubString(0, 4, "://") == InvalidIndex);
+    CHECK(StringBuilder::FindFirstNotOf("http://bla", 0, EndOfString, "htp:/") == 7);
+    CHECK(StringBuilder::FindFirstNotOf("http://", 0, EndOfString, "htp:/") == InvalidIndex);
+    
+    // same on longer strings (SIMD code path)
+    builder.Set("http://www.some-very-long-domain-name.example.com:8000/path/to/resource?query=1");
+    CHECK(builder.FindFirstOf(7, EndOfString, ":") == 49);
+    CHECK(builder.FindFirstOf(7, 49, ":") == InvalidIndex);
+    CHECK(builder.FindFirstOf(7, EndOfString, "?&") == 71);
+    CHECK(builder.FindFirstNotOf(0, EndOfString, "htp:/w.") == 11);
+    CHECK(builder.FindSubString(0, EndOfString, "resource") == 63);
+    CHECK(builder.FindSubString(0, 63, "resource") == InvalidIndex);
+    CHECK(builder.FindSubString(0, 64, "resource") == 63);
+    CHECK(builder.FindSubString(10, EndOfString, "http") == InvalidIndex);
+    
+    // PercentEncode, PercentDecode
+    builder.Set("Hello World/ä?a=1&b=~x-y_z.");
+    builder.PercentEncode();
+    CHECK(builder.GetString() == "Hello%20World%2F%C3%A4%3Fa%3D1%26b%3D~x-y_z.");
+    builder.PercentDecode();
+    CHECK(builder.GetString() == "Hello World/ä?a=1&b=~x-y_z.");
+    builder.Set("NothingToEncode-In_This.String~Really");
+    builder.PercentEncode();
+    CHECK(builder.GetString() == "NothingToEncode-In_This.String~Really");
+    builder.Set("bad %G1 escape %4 at end %");
+    builder.PercentDecode();
+    CHECK(builder.GetString() == "bad %G1 escape %4 at end %");
+    builder.Set("%2f%2F%41%42%43 lower and upper case hex digits %7e%7E");
+    builder.PercentDecode();
+    CHECK(builder.GetString() == "//ABC lower and upper case hex digits ~~");
     
     // test Format
     CHECK(!builder.Format(4, "One: %d, Two: %d, Three: %d", 1, 2, 3));   // this should fail because of no room
@@ -172,3 +211,133 @@ TEST(StringBuilderTest) {
     CHECK(builder.GetString() == "One: 1, Two: 2, Three: 3");
 }
 
+
+//------------------------------------------------------------------------------
+TEST(StringBuilderScanFuzzTest) {
+    // compare the SIMD scan functions against the scalar code on random strings
+    std::mt19937 rnd(4711);
+    const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-._~:/?#[]@!$&'()*+,;=% \t\xC3\xA4\x80\xFF";
+    const int32 alphabetSize = sizeof(alphabet) - 1;
+    for (int32 i = 0; i < 5000; i++) {
+        // random haystack from a small random sub-alphabet, so that matches happen
+        const int32 len = rnd() % 100;
+        const int32 numChars = 1 + (rnd() % 6);
+        char chars[8];
+        for (int32 j = 0; j < numChars; j++) {
+            chars[j] = alphabet[rnd() % alphabetSize];
+        }
+        std::string str;
+        for (int32 j = 0; j < len; j++) {
+            str.push_back(chars[rnd() % numChars]);
+        }
+
+        // random delimiter sets, sometimes with more than 8 distinct high nibbles
+        char delims[24];
+        const int32 numDelims = 1 + (rnd() % 20);
+        for (int32 j = 0; j < numDelims; j++) {
+            delims[j] = (0 == (rnd() % 3)) ? chars[rnd() % numChars] : alphabet[rnd() % alphabetSize];
+        }
+        delims[numDelims] = 0;
+        CHECK(simdScan::FindFirstOf(str.c_str(), len, delims) == simdScan::FindFirstOfScalar(str.c_str(), len, delims));
+        CHECK(simdScan::FindFirstNotOf(str.c_str(), len, delims) == simdScan::FindFirstNotOfScalar(str.c_str(), len, delims));
+
+        // substring search with a needle taken from the haystack (or random)
+        std::string needle;
+        if ((len > 0) && (rnd() % 4)) {
+            const int32 start = rnd() % len;
+            needle = str.substr(start, 1 + (rnd() % 8));
+        }
+        else {
+            needle.push_back(chars[rnd() % numChars]);
+            needle.push_back(chars[rnd() % numChars]);
+        }
+        const int32 limit = (len > 0) ? (rnd() % (len + 1)) : 0;
+        const int32 subLen = (int32) needle.length();
+        const int32 res = simdScan::FindSubString(str.c_str(), len, limit, needle.c_str(), subLen);
+        CHECK(res == simdScan::FindSubStringScalar(str.c_str(), len, limit, needle.c_str(), subLen));
+        const size_t refPos = str.find(needle);
+        const int32 ref = ((std::string::npos == refPos) || ((int32)refPos >= limit)) ? InvalidIndex : (int32)refPos;
+        CHECK(res == ref);
+
+        // percent-encode / -decode roundtrip
+        std::string encoded(len * 3 + 1, 0);
+        std::string encodedScalar(len * 3 + 1, 0);
+        const int32 encLen = simdScan::PercentEncode(str.c_str(), len, &encoded[0]);
+        CHECK(encLen == simdScan::PercentEncodeScalar(str.c_str(), len, &encodedScalar[0]));
+        CHECK(0 == std::memcmp(encoded.c_str(), encodedScalar.c_str(), encLen));
+        std::string decoded(encoded, 0, encLen);
+        const int32 decLen = simdScan::PercentDecode(&decoded[0], encLen, &decoded[0]);
+        CHECK((decLen == len) && (0 == std::memcmp(decoded.c_str(), str.c_str(), len)));
+
+        // decoding arbitrary input in-place must match the scalar code
+        std::string raw(str);
+        std::string rawScalar(len + 1, 0);
+        const int32 rawLen = simdScan::PercentDecode(&raw[0], len, &raw[0]);
+        CHECK(rawLen == simdScan::PercentDecodeScalar(str.c_str(), len, &rawScalar[0]));
+        CHECK(0 == std::memcmp(raw.c_str(), rawScalar.c_str(), rawLen));
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST(StringBuilderScanPerformance) {
+    // a long URL-like string with the delimiter at the end
+    std::string str;
+    while (str.length() < (1<<20)) {
+        str.append("www.some-domain.example.com/path/to/some/resource/with/a/long-name_v1.2~");
+    }
+    str.append("?query=1");
+    const int32 len = (int32) str.length();
+    const char* cstr = str.c_str();
+    std::string dst(len * 3 + 1, 0);
+    const int32 numIter = 20;
+    chrono::time_point<chrono::system_clock> start, end;
+    chrono::duration<double> simdDur, scalarDur;
+    const double mb = (double(len) * numIter) / (1024.0 * 1024.0);
+    int32 res0 = 0, res1 = 0;
+
+    start = chrono::system_clock::now();
+    for (int32 i = 0; i < numIter; i++) res0 += simdScan::FindFirstOf(cstr, len, "?#");
+    end = chrono::system_clock::now();
+    simdDur = end - start;
+    start = chrono::system_clock::now();
+    for (int32 i = 0; i < numIter; i++) res1 += simdScan::FindFirstOfScalar(cstr, len, "?#");
+    end = chrono::system_clock::now();
+    scalarDur = end - start;
+    CHECK(res0 == res1);
+    Log::Info("FindFirstOf: simd %.1f MB/s, scalar %.1f MB/s\n", mb / simdDur.count(), mb / scalarDur.count());
+
+    start = chrono::system_clock::now();
+    for (int32 i = 0; i < numIter; i++) res0 += simdScan::FindSubString(cstr, len, len, "?query", 6);
+    end = chrono::system_clock::now();
+    simdDur = end - start;
+    start = chrono::system_clock::now();
+    for (int32 i = 0; i < numIter; i++) res1 += simdScan::FindSubStringScalar(cstr, len, len, "?query", 6);
+    end = chrono::system_clock::now();
+    scalarDur = end - start;
+    CHECK(res0 == res1);
+    Log::Info("FindSubString: simd %.1f MB/s, scalar %.1f MB/s\n", mb / simdDur.count(), mb / scalarDur.count());
+
+    start = chrono::system_clock::now();
+    for (int32 i = 0; i < numIter; i++) res0 += simdScan::PercentEncode(cstr, len, &dst[0]);
+    end = chrono::system_clock::now();
+    simdDur = end - start;
+    start = chrono::system_clock::now();
+    for (int32 i = 0; i < numIter; i++) res1 += simdScan::PercentEncodeScalar(cstr, len, &dst[0]);
+    end = chrono::system_clock::now();
+    scalarDur = end - start;
+    CHECK(res0 == res1);
+    Log::Info("PercentEncode: simd %.1f MB/s, scalar %.1f MB/s\n", mb / simdDur.count(), mb / scalarDur.count());
+
+    const int32 encLen = simdScan::PercentEncode(cstr, len, &dst[0]);
+    std::string tmp(encLen, 0);
+    start = chrono::system_clock::now();
+    for (int32 i = 0; i < numIter; i++) res0 += simdScan::PercentDecode(dst.c_str(), encLen, &tmp[0]);
+    end = chrono::system_clock::now();
+    simdDur = end - start;
+    start = chrono::system_clock::now();
+    for (int32 i = 0; i < numIter; i++) res1 += simdScan::PercentDecodeScalar(dst.c_str(), encLen, &tmp[0]);
+    end = chrono::system_clock::now();
+    scalarDur = end - start;
+    CHECK(res0 == res1);
+    Log::Info("PercentDecode: simd %.1f MB/s, scalar %.1f MB/s\n", mb / simdDur.count(), mb / scalarDur.count());
+}
@@ -1,13 +1,270 @@
 //------------------------------------------------------------------------------
 //  StringConverterTest.cc
+//  Test UTF-8 validation and conversion.
 //------------------------------------------------------------------------------
 #include "Pre.h"
 #include "UnitTest++/src/UnitTest++.h"
 #include "Core/String/StringConverter.h"
+#include "Core/String/simdUTF.h"
+#include "Core/CpuFeatures.h"
+#include "Core/Log.h"
+#include "Ext/ConvertUTF/ConvertUTF.h"
+#include <cstring>
+#include <cwchar>
+#include <chrono>
+#include <vector>
+#include <random>
 
+using namespace std;
 using namespace Oryol;
 using namespace Oryol::Core;
 
-TEST(StringUtilTest) {
-    /// @todo IMPLEMENT STRING CONVERTER TEST!!!
-}
\ No newline at end of file
+// reference conversion straight through ConvertUTF
+static int32
+refUTF8ToWide(const uint8* src, int32 numBytes, vector<wchar_t>& dst) {
+    dst.resize(numBytes + 1);
+    const UTF8* srcPtr = src;
+    ConversionResult res;
+    int32 numChars = 0;
+    if (sizeof(wchar_t) == 4) {
+        UTF32* dstPtr = (UTF32*) &dst[0];
+        res = ConvertUTF8toUTF32(&srcPtr, src + numBytes, &dstPtr, dstPtr + numBytes, strictConversion);
+        numChars = (int32) (dstPtr - (UTF32*) &dst[0]);
+    }
+    else {
+        UTF16* dstPtr = (UTF16*) &dst[0];
+        res = ConvertUTF8toUTF16(&srcPtr, src + numBytes, &dstPtr, dstPtr + numBytes, strictConversion);
+        numChars = (int32) (dstPtr - (UTF16*) &dst[0]);
+    }
+    return (conversionOK == res) ? numChars : InvalidIndex;
+}
+
+// reference validation, straight from the 'well-formed UTF-8' table in the Unicode standard
+// (ConvertUTF can't be used for this since it accepts some ill-formed sequences)
+static bool
+refIsValidUTF8(const uint8* src, int32 numBytes) {
+    int32 i = 0;
+    while (i < numBytes) {
+        const uint8 c = src[i];
+        int32 len = 1;
+        uint8 lo = 0x80, hi = 0xBF;
+        if (c <= 0x7F)                      len = 1;
+        else if ((c >= 0xC2) && (c <= 0xDF)) len = 2;
+        else if (c == 0xE0)                 { len = 3; lo = 0xA0; }
+        else if ((c >= 0xE1) && (c <= 0xEC)) len = 3;
+        else if (c == 0xED)                 { len = 3; hi = 0x9F; }
+        else if ((c >= 0xEE) && (c <= 0xEF)) len = 3;
+        else if (c == 0xF0)                 { len = 4; lo = 0x90; }
+        else if ((c >= 0xF1) && (c <= 0xF3)) len = 4;
+        else if (c == 0xF4)                 { len = 4; hi = 0x8F; }
+        else return false;
+        if ((i + len) > numBytes) return false;
+        for (int32 j = 1; j < len; j++) {
+            const uint8 b = src[i + j];
+            const uint8 bLo = (1 == j) ? lo : 0x80;
+            const uint8 bHi = (1 == j) ? hi : 0xBF;
+            if ((b < bLo) || (b > bHi)) return false;
+        }
+        i += len;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+TEST(StringConverterUTF8Test) {
+    Log::Info("StringConverter: using '%s' UTF code path\n", simdUTF::ImplementationName());
+    for (int32 i = 0; i < CpuFeatures::NumFeatures; i++) {
+        Log::Info("  %s: %s\n", CpuFeatures::ToString((CpuFeatures::Code)i), CpuFeatures::Has((CpuFeatures::Code)i) ? "yes" : "no");
+    }
+
+    // simple ASCII and multi-byte roundtrips
+    const char* ascii = "Hello World! This is a longer ASCII string with more than 32 characters.";
+    WideString wide = StringConverter::UTF8ToWide(ascii);
+    CHECK(wide == L"Hello World! This is a longer ASCII string with more than 32 characters.");
+    CHECK(StringConverter::WideToUTF8(wide) == ascii);
+
+    // 2-, 3- and 4-byte sequences (ä, €, 日本, U+1F600)
+    const char* multi = "\xC3\xA4\xE2\x82\xAC\xE6\x97\xA5\xE6\x9C\xAC\xF0\x9F\x98\x80";
+    wide = StringConverter::UTF8ToWide(multi);
+    if (sizeof(wchar_t) == 4) {
+        CHECK(wide.Length() == 5);
+        CHECK(wide.AsCStr()[0] == 0xE4);
+        CHECK(wide.AsCStr()[1] == 0x20AC);
+        CHECK(wide.AsCStr()[2] == 0x65E5);
+        CHECK(wide.AsCStr()[3] == 0x672C);
+        CHECK((uint32)wide.AsCStr()[4] == 0x1F600);
+    }
+    else {
+        CHECK(wide.Length() == 6);
+    }
+    CHECK(StringConverter::WideToUTF8(wide) == multi);
+
+    // empty strings
+    unsigned char emptySrc[1] = { 0 };
+    wchar_t emptyDst[4];
+    CHECK(StringConverter::UTF8ToWide(emptySrc, 0, emptyDst, sizeof(emptyDst)) == 1);
+    CHECK(emptyDst[0] == 0);
+
+    // multi-byte sequences at all offsets around the 16- and 32-byte SIMD block boundaries
+    for (int32 prefix = 0; prefix < 70; prefix++) {
+        std::string str(prefix, 'a');
+        str.append(multi);
+        str.append(prefix, 'b');
+        vector<wchar_t> ref;
+        const int32 refChars = refUTF8ToWide((const uint8*)str.c_str(), (int32)str.length(), ref);
+        CHECK(refChars > 0);
+        vector<wchar_t> dst(str.length() + 1);
+        const int32 res = StringConverter::UTF8ToWide((const uint8*)str.c_str(), (int32)str.length(), &dst[0], (int32)(dst.size() * sizeof(wchar_t)));
+        CHECK(res == refChars + 1);
+        CHECK(0 == std::memcmp(&dst[0], &ref[0], refChars * sizeof(wchar_t)));
+        CHECK(StringConverter::IsValidUTF8((const uint8*)str.c_str(), (int32)str.length()));
+
+        // and back to UTF-8
+        vector<uint8> utf8(str.length() + 1);
+        CHECK(StringConverter::WideToUTF8(&dst[0], res - 1, &utf8[0], (int32)utf8.size()) == (int32)str.length() + 1);
+        CHECK(0 == std::strcmp((const char*)&utf8[0], str.c_str()));
+    }
+
+    // invalid sequences must be rejected at any offset
+    const char* invalid[] = {
+        "\xC0\x80",             // overlong 2-byte
+        "\xC1\xBF",             // overlong 2-byte
+        "\xE0\x80\x80",         // overlong 3-byte
+        "\xF0\x80\x80\x80",     // overlong 4-byte
+        "\xED\xA0\x80",         // surrogate
+        "\xF4\x90\x80\x80",     // > U+10FFFF
+        "\xF5\x80\x80\x80",     // invalid lead byte
+        "\xFF",                 // invalid lead byte
+        "\x80",                 // lone continuation
+        "\xC3\xA4\xA4",         // too many continuations
+        "\xE2\x82",             // truncated
+        "\xF0\x9F\x98",         // truncated
+        "\xC3" "a",             // too short
+    };
+    for (const char* inv : invalid) {
+        for (int32 prefix = 0; prefix < 40; prefix++) {
+            std::string str(prefix, 'x');
+            str.append(inv);
+            CHECK(!StringConverter::IsValidUTF8((const uint8*)str.c_str(), (int32)str.length()));
+            std::string str1 = str + std::string(40, 'y');
+            CHECK(!StringConverter::IsValidUTF8((const uint8*)str1.c_str(), (int32)str1.length()));
+        }
+    }
+    CHECK(StringConverter::UTF8ToWide((const unsigned char*)"abc\xC0\x80").Empty());
+
+    // invalid wide characters
+    if (sizeof(wchar_t) == 4) {
+        const wchar_t badSurrogate[] = { L'a', (wchar_t)0xD800, L'b', 0 };
+        CHECK(StringConverter::WideToUTF8(badSurrogate).Empty());
+        const wchar_t tooLarge[] = { L'a', (wchar_t)0x110000, 0 };
+        CHECK(StringConverter::WideToUTF8(tooLarge).Empty());
+    }
+
+    // destination too small
+    wchar_t smallDst[4];
+    CHECK(StringConverter::UTF8ToWide((const unsigned char*)"abcdefgh", 8, smallDst, sizeof(smallDst)) == 0);
+}
+
+//------------------------------------------------------------------------------
+TEST(StringConverterFuzzTest) {
+    // compare validation against the reference on random byte soup
+    // biased towards lead and continuation bytes, and conversion against ConvertUTF
+    std::mt19937 rnd(12345);
+    const uint8 pool[] = { 'a', 'z', 0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF, 0xC0, 0xC2, 0xDF,
+                           0xE0, 0xE1, 0xED, 0xEF, 0xF0, 0xF3, 0xF4, 0xF5, 0xFF };
+    int32 numValid = 0;
+    for (int32 i = 0; i < 20000; i++) {
+        const int32 len = rnd() % 80;
+        vector<uint8> bytes(len + 1);
+        for (int32 j = 0; j < len; j++) {
+            // mostly produce valid sequences, sometimes garbage
+            bytes[j] = (rnd() % 4) ? (uint8)('a' + (rnd() % 26)) : pool[rnd() % sizeof(pool)];
+        }
+        const bool valid = StringConverter::IsValidUTF8(&bytes[0], len);
+        CHECK(valid == refIsValidUTF8(&bytes[0], len));
+        if (valid) {
+            numValid++;
+            vector<wchar_t> ref;
+            const int32 refChars = refUTF8ToWide(&bytes[0], len, ref);
+            CHECK(InvalidIndex != refChars);
+            vector<wchar_t> dst(len + 2);
+            const int32 res = StringConverter::UTF8ToWide(&bytes[0], len, &dst[0], (int32)(dst.size() * sizeof(wchar_t)));
+            CHECK(res == refChars + 1);
+            CHECK(0 == std::memcmp(&dst[0], &ref[0], refChars * sizeof(wchar_t)));
+        }
+        else {
+            vector<uint32> dst32(len + 1);
+            CHECK(InvalidIndex == simdUTF::UTF8ToUTF32(&bytes[0], len, &dst32[0], len));
+        }
+    }
+    CHECK(numValid > 0);
+}
+
+//------------------------------------------------------------------------------
+static void
+utfPerformance(const char* name, const std::string& corpus) {
+    const int32 numBytes = (int32) corpus.length();
+    const uint8* src = (const uint8*) corpus.c_str();
+    vector<wchar_t> wideBuf(numBytes + 1);
+    vector<uint8> utf8Buf(numBytes + 1);
+    const int32 numIter = 20;
+
+    chrono::time_point<chrono::system_clock> start, end;
+    start = chrono::system_clock::now();
+    bool valid = true;
+    for (int32 i = 0; i < numIter; i++) {
+        valid &= StringConverter::IsValidUTF8(src, numBytes);
+    }
+    end = chrono::system_clock::now();
+    CHECK(valid);
+    chrono::duration<double> validateDur = end - start;
+
+    start = chrono::system_clock::now();
+    int32 numChars = 0;
+    for (int32 i = 0; i < numIter; i++) {
+        numChars = StringConverter::UTF8ToWide(src, numBytes, &wideBuf[0], (int32)(wideBuf.size() * sizeof(wchar_t)));
+    }
+    end = chrono::system_clock::now();
+    CHECK(numChars > 0);
+    chrono::duration<double> toWideDur = end - start;
+
+    start = chrono::system_clock::now();
+    int32 numUTF8 = 0;
+    for (int32 i = 0; i < numIter; i++) {
+        numUTF8 = StringConverter::WideToUTF8(&wideBuf[0], numChars - 1, &utf8Buf[0], (int32)utf8Buf.size());
+    }
+    end = chrono::system_clock::now();
+    CHECK(numUTF8 == numBytes + 1);
+    chrono::duration<double> toUTF8Dur = end - start;
+
+    // the scalar reference path
+    vector<wchar_t> ref;
+    start = chrono::system_clock::now();
+    for (int32 i = 0; i < numIter; i++) {
+        refUTF8ToWide(src, numBytes, ref);
+    }
+    end = chrono::system_clock::now();
+    chrono::duration<double> refDur = end - start;
+
+    const double mb = (double(numBytes) * numIter) / (1024.0 * 1024.0);
+    Log::Info("%s (%d bytes): validate %.1f MB/s, UTF8ToWide %.1f MB/s, WideToUTF8 %.1f MB/s, ConvertUTF8ToWide %.1f MB/s\n",
+        name, numBytes, mb / validateDur.count(), mb / toWideDur.count(), mb / toUTF8Dur.count(), mb / refDur.count());
+}
+
+//------------------------------------------------------------------------------
+TEST(StringConverterPerformance) {
+    const int32 corpusSize = 1<<20;
+    std::string asciiCorpus;
+    std::string cjkCorpus;
+    std::string mixedCorpus;
+    const char* asciiText = "The quick brown fox jumps over the lazy dog. ";
+    const char* cjkText = "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\xE4\xB8\xAD\xE6\x96\x87\xED\x95\x9C\xEA\xB5\xAD\xEC\x96\xB4";
+    const char* mixedText = "Gr\xC3\xBC\xC3\x9F" "e aus K\xC3\xB6ln, \xE2\x82\xAC" "5 \xF0\x9F\x98\x80 caf\xC3\xA9 na\xC3\xAFve ";
+    while ((int32)asciiCorpus.length() < corpusSize) asciiCorpus.append(asciiText);
+    while ((int32)cjkCorpus.length() < corpusSize) cjkCorpus.append(cjkText);
+    while ((int32)mixedCorpus.length() < corpusSize) mixedCorpus.append(mixedText);
+
+    utfPerformance("ASCII", asciiCorpus);
+    utfPerformance("CJK", cjkCorpus);
+    utfPerformance("Mixed", mixedCorpus);
+}
@@ -0,0 +1,208 @@
+//------------------------------------------------------------------------------
+//  TaskTest.cc
+//  Test Task, Promise and the RunLoop task helpers.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/Task.h"
+#include "Core/RunLoop.h"
+#include "Core/String/String.h"
+#include "Core/String/StringBuilder.h"
+#include <thread>
+
+using namespace Oryol;
+using namespace Oryol::Core;
+
+TEST(TaskTest) {
+    Task<int32> invalid;
+    CHECK(!invalid.IsValid());
+
+    // continuation attached before resolve
+    Promise<int32> p0;
+    Task<int32> t0 = p0.GetTask();
+    CHECK(t0.IsValid());
+    CHECK(!t0.IsDone());
+    int32 seen = 0;
+    Task<String> t1 = t0.Then([&seen](int32 val) {
+        seen = val;
+        return String(val == 42 ? "42" : "?");
+    });
+    CHECK(!t1.IsDone());
+    p0.Resolve(42);
+    CHECK(p0.IsResolved());
+    CHECK(t0.IsDone());
+    CHECK(t0.Result() == 42);
+    CHECK(seen == 42);
+    CHECK(t1.IsDone());
+    CHECK(t1.Result() == "42");
+
+    // continuation attached after resolve is called immediately
+    int32 late = 0;
+    t0.Then([&late](const int32& val) { late = val; });
+    CHECK(late == 42);
+
+    // several continuations are called in order
+    Promise<void> p1;
+    StringBuilder order;
+    p1.GetTask().Then([&order]() { order.Append("a"); });
+    p1.GetTask().Then([&order]() { order.Append("b"); });
+    p1.Resolve();
+    CHECK(order.GetString() == "ab");
+
+    // a continuation which returns a task is flattened
+    Promise<int32> outer;
+    Promise<int32> inner;
+    Task<int32> chained = outer.GetTask().Then([&inner](int32 val) {
+        return inner.GetTask().Then([val](int32 innerVal) {
+            return val + innerVal;
+        });
+    });
+    Task<void> chainedVoid = chained.Then([](int32) { });
+    outer.Resolve(1);
+    CHECK(!chained.IsDone());
+    inner.Resolve(2);
+    CHECK(chained.IsDone());
+    CHECK(chained.Result() == 3);
+    CHECK(chainedVoid.IsDone());
+
+    // WhenAll
+    Array<Promise<int32>> promises;
+    Array<Task<int32>> tasks;
+    for (int32 i = 0; i < 8; i++) {
+        promises.AddBack(Promise<int32>());
+        tasks.AddBack(promises.Back().GetTask());
+    }
+    Task<Array<int32>> all = WhenAll(tasks);
+    for (int32 i = 7; i >= 0; i--) {
+        CHECK(!all.IsDone());
+        promises[i].Resolve(i * 10);
+    }
+    CHECK(all.IsDone());
+    CHECK(all.Result().Size() == 8);
+    for (int32 i = 0; i < 8; i++) {
+        CHECK(all.Result()[i] == i * 10);
+    }
+    CHECK(WhenAll(Array<Task<int32>>()).IsDone());
+    Array<Task<void>> voidTasks;
+    Promise<void> v0, v1;
+    voidTasks.AddBack(v0.GetTask());
+    voidTasks.AddBack(v1.GetTask());
+    Task<void> allVoid = WhenAll(voidTasks);
+    v1.Resolve();
+    CHECK(!allVoid.IsDone());
+    v0.Resolve();
+    CHECK(allVoid.IsDone());
+
+    // a failure skips the continuations down the chain to OnFailed()
+    Promise<int32> failing;
+    int32 numCalled = 0;
+    bool failedSeen = false;
+    Task<int32> failChain = failing.GetTask().Then([&numCalled](int32 val) {
+        numCalled++;
+        return val;
+    }).Then([&numCalled](int32 val) {
+        numCalled++;
+        return val;
+    });
+    failChain.OnFailed([&failedSeen]() { failedSeen = true; });
+    failing.GetTask().OnFailed([&numCalled]() { numCalled += 10; });
+    failing.Fail();
+    CHECK(failing.IsResolved());
+    CHECK(failing.GetTask().IsDone());
+    CHECK(failing.GetTask().IsFailed());
+    CHECK(failChain.IsDone());
+    CHECK(failChain.IsFailed());
+    CHECK(failedSeen);
+    CHECK(numCalled == 10);
+    bool resolvedSeen = false;
+    t0.OnFailed([&resolvedSeen]() { resolvedSeen = true; });
+    CHECK(!resolvedSeen);
+    CHECK(!t0.IsFailed());
+
+    // an inner task which fails fails the flattened task
+    Promise<int32> failOuter;
+    Promise<int32> failInner;
+    Task<int32> failFlat = failOuter.GetTask().Then([&failInner](int32) {
+        return failInner.GetTask();
+    });
+    failOuter.Resolve(1);
+    failInner.Fail();
+    CHECK(failFlat.IsFailed());
+
+    // WhenAll fails when one of its tasks fails
+    Array<Promise<int32>> allPromises;
+    Array<Task<int32>> allTasks;
+    for (int32 i = 0; i < 3; i++) {
+        allPromises.AddBack(Promise<int32>());
+        allTasks.AddBack(allPromises.Back().GetTask());
+    }
+    Task<Array<int32>> allFail = WhenAll(allTasks);
+    allPromises[0].Resolve(0);
+    allPromises[1].Fail();
+    CHECK(allFail.IsFailed());
+    allPromises[2].Resolve(2);
+    CHECK(allFail.IsFailed());
+    Promise<void> v2, v3;
+    voidTasks.Clear();
+    voidTasks.AddBack(v2.GetTask());
+    voidTasks.AddBack(v3.GetTask());
+    Task<void> allVoidFail = WhenAll(voidTasks);
+    v2.Fail();
+    v3.Fail();
+    CHECK(allVoidFail.IsFailed());
+}
+
+//------------------------------------------------------------------------------
+TEST(RunLoopTaskTest) {
+    Ptr<RunLoop> runLoop = RunLoop::Create();
+    const Clock::Ticks ms = Clock::FromMilliSeconds(1.0);
+    Clock::Ticks now = Clock::Now();
+    runLoop->Run(now);
+
+    // delays
+    int32 step = 0;
+    Task<void> delayed = runLoop->Delay(10 * ms).Then([&runLoop, &step, ms]() {
+        step = 1;
+        return runLoop->Delay(10 * ms);
+    }).Then([&step]() {
+        step = 2;
+    });
+    for (int32 i = 0; i < 30 && !delayed.IsDone(); i++) {
+        now += 5 * ms;
+        runLoop->Run(now);
+        if (i < 1) {
+            CHECK(step == 0);
+        }
+    }
+    CHECK(delayed.IsDone());
+    CHECK(step == 2);
+
+    // posting from other threads, resolves on the RunLoop's thread
+    #if ORYOL_HAS_THREADS
+    const std::thread::id mainThreadId = std::this_thread::get_id();
+    Array<Task<int32>> tasks;
+    Array<std::thread> threads;
+    for (int32 i = 0; i < 4; i++) {
+        Promise<int32> promise;
+        tasks.AddBack(promise.GetTask().Then([mainThreadId](int32 val) {
+            return (std::this_thread::get_id() == mainThreadId) ? val : -1;
+        }));
+        threads.AddBack(std::thread([runLoop, promise, i]() {
+            Promise<int32> p(promise);
+            runLoop->Post([p, i]() mutable {
+                p.Resolve(i);
+            });
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    Task<Array<int32>> all = WhenAll(tasks);
+    CHECK(!all.IsDone());
+    runLoop->Run(now);
+    CHECK(all.IsDone());
+    for (int32 i = 0; i < 4; i++) {
+        CHECK(all.Result()[i] == i);
+    }
+    #endif
+}
@@ -0,0 +1,187 @@
+//------------------------------------------------------------------------------
+//  TimerWheelTest.cc
+//  Test the TimerWheel class.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/Time/TimerWheel.h"
+#include "Core/Log.h"
+#include <thread>
+#include <chrono>
+#include <cmath>
+
+using namespace Oryol;
+using namespace Oryol::Core;
+
+static const Clock::Ticks ms = Clock::FromMilliSeconds(1.0);
+
+TEST(TimerWheelTest) {
+    TimerWheel wheel;
+    wheel.Setup(ms, 0);
+    CHECK(wheel.Resolution() == ms);
+    CHECK(wheel.Time() == 0);
+    CHECK(wheel.NumTimers() == 0);
+
+    // one-shot timers
+    int32 fired0 = 0, fired1 = 0;
+    TimerWheel::Id id0 = wheel.Add(5 * ms, [&fired0]() { fired0++; });
+    TimerWheel::Id id1 = wheel.Add(5 * ms + 1, [&fired1]() { fired1++; });
+    CHECK(id0 != TimerWheel::InvalidId);
+    CHECK(id0 != id1);
+    CHECK(wheel.NumTimers() == 2);
+    CHECK(wheel.Contains(id0));
+    CHECK(wheel.Advance(4 * ms) == 0);
+    CHECK(wheel.Advance(5 * ms - 1) == 0);
+    CHECK(wheel.Advance(5 * ms) == 1);
+    CHECK(fired0 == 1);
+    CHECK(fired1 == 0);
+    CHECK(!wheel.Contains(id0));
+    CHECK(wheel.Advance(6 * ms) == 1);
+    CHECK(fired1 == 1);
+    CHECK(wheel.NumTimers() == 0);
+    CHECK(!wheel.Remove(id1));
+
+    // delays beyond one revolution
+    int32 firedLong = 0;
+    wheel.Add(1000 * ms, [&firedLong]() { firedLong++; });
+    for (int32 t = 7; t < 1006; t++) {
+        wheel.Advance(t * ms);
+        CHECK(firedLong == 0);
+    }
+    wheel.Advance(1006 * ms);
+    CHECK(firedLong == 1);
+
+    // periodic timer, no drift
+    int32 ticks = 0;
+    TimerWheel::Id periodic = wheel.Add(10 * ms, [&ticks]() { ticks++; }, 10 * ms);
+    const Clock::Ticks base = wheel.Time();
+    for (int32 i = 1; i <= 100; i++) {
+        wheel.Advance(base + i * 3 * ms);
+    }
+    CHECK(ticks == 30);
+    CHECK(wheel.Contains(periodic));
+    // falling behind skips missed periods
+    wheel.Advance(wheel.Time() + 55 * ms);
+    CHECK(ticks == 31);
+    CHECK(wheel.Remove(periodic));
+    CHECK(!wheel.Contains(periodic));
+    wheel.Advance(wheel.Time() + 100 * ms);
+    CHECK(ticks == 31);
+
+    // removing before firing, stale ids
+    int32 removed = 0;
+    TimerWheel::Id id2 = wheel.Add(2 * ms, [&removed]() { removed++; });
+    CHECK(wheel.Remove(id2));
+    CHECK(!wheel.Remove(id2));
+    TimerWheel::Id id3 = wheel.Add(2 * ms, [&removed]() { removed += 10; });
+    CHECK(id3 != id2);
+    CHECK(!wheel.Contains(id2));
+    wheel.Advance(wheel.Time() + 10 * ms);
+    CHECK(removed == 10);
+
+    // callbacks which add and remove timers
+    int32 chain = 0, self = 0;
+    TimerWheel::Id selfId = TimerWheel::InvalidId;
+    std::function<void()> chainFunc = [&]() {
+        chain++;
+        if (chain < 5) {
+            wheel.Add(1 * ms, chainFunc);
+        }
+    };
+    wheel.Add(1 * ms, chainFunc);
+    selfId = wheel.Add(1 * ms, [&]() { self++; wheel.Remove(selfId); }, 1 * ms);
+    for (int32 i = 0; i < 10; i++) {
+        wheel.Advance(wheel.Time() + ms);
+    }
+    CHECK(chain == 5);
+    CHECK(self == 1);
+    CHECK(wheel.NumTimers() == 0);
+
+    // a callback which removes another timer due on the same tick
+    int32 firedA = 0, firedB = 0;
+    TimerWheel::Id idB = wheel.Add(1 * ms, [&firedB]() { firedB++; });
+    wheel.Add(1 * ms, [&]() { firedA++; CHECK(wheel.Remove(idB)); });
+    CHECK(wheel.Advance(wheel.Time() + ms) == 1);
+    CHECK(firedA == 1);
+    CHECK(firedB == 0);
+    CHECK(!wheel.Contains(idB));
+    CHECK(wheel.NumTimers() == 0);
+    // the removed timer's slot is recycled
+    int32 firedC = 0;
+    wheel.Add(1 * ms, [&firedC]() { firedC++; });
+    CHECK(wheel.Advance(wheel.Time() + ms) == 1);
+    CHECK(firedC == 1);
+
+    // advancing by more than a revolution visits each slot once,
+    // the due timers fire in the order of their due time
+    Array<int32> order;
+    wheel.Add(700 * ms, [&order]() { order.AddBack(700); });
+    wheel.Add(5 * ms, [&order]() { order.AddBack(5); });
+    wheel.Add(300 * ms, [&order]() { order.AddBack(300); });
+    wheel.Add(261 * ms, [&order]() { order.AddBack(261); });
+    wheel.Add(2000 * ms, [&order]() { order.AddBack(2000); });
+    TimerWheel::Id periodic100 = wheel.Add(100 * ms, [&order]() { order.AddBack(100); }, 100 * ms);
+    CHECK(wheel.Advance(wheel.Time() + 1000 * ms) == 5);
+    CHECK(order.Size() == 5);
+    CHECK((order[0] == 5) && (order[1] == 100) && (order[2] == 261) && (order[3] == 300) && (order[4] == 700));
+    CHECK(wheel.NumTimers() == 2);
+    CHECK(wheel.Advance(wheel.Time() + 999 * ms) == 1);
+    CHECK(order.Back() == 100);
+    // the periodic timer is due again on the same tick as the 2000ms timer
+    CHECK(wheel.Advance(wheel.Time() + ms) == 2);
+    CHECK(order.Size() == 8);
+    CHECK(wheel.Remove(periodic100));
+
+    // removed timers are released when the wheel is empty
+    TimerWheel::Id idD = wheel.Add(3 * ms, [&firedC]() { firedC += 10; });
+    CHECK(wheel.Remove(idD));
+    CHECK(wheel.Advance(wheel.Time() + 500 * ms) == 0);
+    wheel.Add(3 * ms, [&firedC]() { firedC++; });
+    CHECK(wheel.Advance(wheel.Time() + 3 * ms) == 1);
+    CHECK(firedC == 2);
+    CHECK(wheel.NumTimers() == 0);
+}
+
+//------------------------------------------------------------------------------
+TEST(TimerWheelBenchmark) {
+    // cost of Advance() with many scheduled timers
+    TimerWheel wheel;
+    Clock::Ticks now = 0;
+    wheel.Setup(ms, now);
+    const int32 numTimers = 10000;
+    int32 numFired = 0;
+    for (int32 i = 0; i < numTimers; i++) {
+        wheel.Add((1 + (i * 7919) % 5000) * ms, [&numFired]() { numFired++; }, 5000 * ms);
+    }
+    const int32 numFrames = 1000;
+    Clock::Ticks start = Clock::Now();
+    for (int32 i = 0; i < numFrames; i++) {
+        now += 16 * ms;
+        wheel.Advance(now);
+    }
+    const Clock::Ticks dur = Clock::Since(start);
+    Log::Info("TimerWheel: %d timers, %.2f us per 16ms frame, %d fired\n",
+        numTimers, Clock::ToMicroSeconds(dur) / numFrames, numFired);
+    CHECK(numFired > 0);
+
+    // firing jitter against the real clock, timers never fire early
+    TimerWheel realWheel;
+    realWheel.Setup(ms, Clock::Now());
+    const int32 numShots = 20;
+    float64 sum = 0.0, maxJitter = 0.0;
+    int32 shots = 0;
+    Clock::Ticks due = realWheel.Time() + 3 * ms;
+    realWheel.Add(3 * ms, [&]() {
+        const float64 jitter = Clock::ToMicroSeconds(Clock::Now() - due);
+        CHECK(jitter >= 0.0);
+        sum += jitter;
+        maxJitter = jitter > maxJitter ? jitter : maxJitter;
+        due += 3 * ms;
+        shots++;
+    }, 3 * ms);
+    while (shots < numShots) {
+        std::this_thread::sleep_for(std::chrono::microseconds(250));
+        realWheel.Advance(Clock::Now());
+    }
+    Log::Info("TimerWheel: firing jitter at 1ms resolution, mean %.1f us, max %.1f us\n", sum / numShots, maxJitter);
+}
@@ -3,6 +3,7 @@
 //------------------------------------------------------------------------------
 #include "Pre.h"
 #include "HTTPClient.h"
+#include "Core/Metrics.h"
 
 namespace Oryol {
 namespace HTTP {
@@ -12,6 +13,17 @@ OryolClassImpl(HTTPClient);
 using namespace Core;
 using namespace Messaging;
 
+namespace {
+    Metrics::Id requestsMetric() {
+        static const Metrics::Id id = Metrics::RegisterCounter("http.requests");
+        return id;
+    }
+    Metrics::Id latencyMetric() {
+        static const Metrics::Id id = Metrics::RegisterHistogram("http.request_ns");
+        return id;
+    }
+}
+
 //------------------------------------------------------------------------------
 HTTPClient::HTTPClient() {
     // empty
@@ -26,8 +38,13 @@ HTTPClient::~HTTPClient() {
 bool
 HTTPClient::Put(const Ptr<Message>& msg) {
     o_assert(msg->IsMemberOf(HTTPProtocol::GetProtocolId()));
-    Ptr<HTTPProtocol::HTTPRequest> req = msg.dynamicCast<HTTPProtocol::HTTPRequest>();
+    Ptr<HTTPProtocol::HTTPRequest> req = MessageCast<HTTPProtocol::HTTPRequest>(msg);
     o_assert(req.isValid());
+    Metrics::Add(requestsMetric());
+    const Clock::Ticks start = Clock::Now();
+    req->OnHandled([start]() {
+        Metrics::Record(latencyMetric(), Clock::Since(start));
+    });
     this->loader.putRequest(req);
     return true;
 }
@@ -6,6 +6,7 @@
 #include <cstring>
 #include "Messaging/Message.h"
 #include "Messaging/Serializer.h"
+#include "Messaging/CompactSerializer.h"
 #include "Messaging/Protocol.h"
 #include "IO/URL.h"
 #include "HTTP/HTTPMethod.h"
@@ -21,10 +22,28 @@ public:
     static Messaging::ProtocolIdType GetProtocolId() {
         return 'HTPR';
     };
+    static bool HasProtocol(Messaging::ProtocolIdType protId) {
+        return (protId == 'HTPR') || Messaging::Protocol::HasProtocol(protId);
+    };
+    static uint32 GetWireId(Messaging::MessageIdType id) {
+        switch (id) {
+            case MessageId::HTTPResponseId: return 0x8bc9eaf0U;
+            case MessageId::HTTPRequestId: return 0x6c8e285cU;
+            default: return Messaging::Protocol::GetWireId(id);
+        }
+    };
+    static Messaging::MessageIdType FindMessageId(uint32 wireId) {
+        switch (wireId) {
+            case 0x8bc9eaf0U: return MessageId::HTTPResponseId;
+            case 0x6c8e285cU: return MessageId::HTTPRequestId;
+            default: return Messaging::Protocol::FindMessageId(wireId);
+        }
+    };
     class MessageId {
     public:
         enum {
-            HTTPResponseId = Messaging::Protocol::MessageId::NumMessageIds, 
+            FirstMessageId = Messaging::Protocol::MessageId::NumMessageIds,
+            HTTPResponseId = FirstMessageId, 
             HTTPRequestId,
             NumMessageIds
         };
@@ -52,6 +71,7 @@ public:
     public:
         HTTPResponse() {
             this->msgId = MessageId::HTTPResponseId;
+            this->protId = 'HTPR';
             this->status = IO::IOStatus::InvalidIOStatus;
         };
         static Messaging::Message* FactoryCreate() {
@@ -64,6 +84,13 @@ public:
             if (protId == 'HTPR') return true;
             else return Messaging::Message::IsMemberOf(protId);
         };
+        static const uint64 DerivedMask = 0x1ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'HTPR') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const HTTPResponse*>(msg);
+        };
         void SetStatus(const IO::IOStatus::Code& val) {
             this->status = val;
         };
@@ -99,6 +126,7 @@ private:
     public:
         HTTPRequest() {
             this->msgId = MessageId::HTTPRequestId;
+            this->protId = 'HTPR';
             this->method = HTTP::HTTPMethod::Get;
         };
         static Messaging::Message* FactoryCreate() {
@@ -111,6 +139,13 @@ private:
             if (protId == 'HTPR') return true;
             else return Messaging::Message::IsMemberOf(protId);
         };
+        static const uint64 DerivedMask = 0x2ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'HTPR') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const HTTPRequest*>(msg);
+        };
         void SetMethod(const HTTP::HTTPMethod::Code& val) {
             this->method = val;
         };
@@ -148,6 +183,16 @@ private:
         Core::Ptr<IO::Stream> body;
         Core::Ptr<HTTPProtocol::HTTPResponse> response;
     };
+    template<class VISITOR> static bool Visit(const Core::Ptr<Messaging::Message>& msg, VISITOR&& visitor) {
+        if (msg->ProtocolId() != GetProtocolId()) {
+            return Messaging::Protocol::Visit(msg, visitor);
+        }
+        switch (msg->MessageId()) {
+            case MessageId::HTTPResponseId: visitor(Core::Ptr<HTTPResponse>(static_cast<HTTPResponse*>(msg.get()))); return true;
+            case MessageId::HTTPRequestId: visitor(Core::Ptr<HTTPRequest>(static_cast<HTTPRequest*>(msg.get()))); return true;
+            default: return false;
+        }
+    };
 };
 }
 }
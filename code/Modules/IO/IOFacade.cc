@@ -5,6 +5,7 @@
 #include "IOFacade.h"
 #include "IO/assignRegistry.h"
 #include "Core/CoreFacade.h"
+#include "Messaging/Await.h"
 
 namespace Oryol {
 namespace IO {
@@ -23,7 +24,7 @@ IOFacade::IOFacade() {
     assignRegistry::CreateSingleton();
     schemeRegistry::CreateSingleton();
     this->requestRouter = ioRequestRouter::Create(IOFacade::numIOLanes);
-    CoreFacade::Instance()->RunLoop()->Add(RunLoop::Callback("IO::IOFacade", 0, std::bind(&IOFacade::doWork, this)));
+    CoreFacade::Instance()->RunLoop()->Add(RunLoop::Callback("IO::IOFacade", 0, std::bind(&IOFacade::doWork, this)).SetPhase(RunLoop::Phase::IOPump));
 }
 
 //------------------------------------------------------------------------------
@@ -88,20 +89,44 @@ IOFacade::IsFileSystemRegistered(const StringAtom& scheme) const {
 
 //------------------------------------------------------------------------------
 Ptr<IOProtocol::Get>
-IOFacade::LoadFile(const URL& url, int32 ioLane) {
+IOFacade::LoadFile(const URL& url, int32 ioLane, Messaging::Priority::Code prio) {
     Ptr<IOProtocol::Get> ioReq = IOProtocol::Get::Create();
     ioReq->SetURL(url);
     ioReq->SetLane(ioLane);
+    ioReq->SetPriority(prio);
     this->requestRouter->Put(ioReq);
     return ioReq;
 }
 
+//------------------------------------------------------------------------------
+/**
+ Like LoadFile(), but instead of polling the request for completion,
+ attach a continuation to the returned Task, which is called on this
+ thread's RunLoop after the request has been handled. The Task fails
+ if the request is rejected, or dropped without being handled.
+*/
+Task<Ptr<IOProtocol::Get>>
+IOFacade::LoadFileTask(const URL& url, int32 ioLane, Messaging::Priority::Code prio) {
+    Ptr<IOProtocol::Get> ioReq = IOProtocol::Get::Create();
+    ioReq->SetURL(url);
+    ioReq->SetLane(ioLane);
+    ioReq->SetPriority(prio);
+    if (!this->requestRouter->Put(ioReq)) {
+        Log::Warn("IOFacade::LoadFileTask(): request for '%s' rejected\n", url.AsCStr());
+        Promise<Ptr<IOProtocol::Get>> rejected;
+        rejected.Fail();
+        return rejected.GetTask();
+    }
+    return Messaging::Await(ioReq);
+}
+
 //------------------------------------------------------------------------------
 Ptr<IOProtocol::GetRange>
-IOFacade::LoadFileRange(const URL& url, int32 startOffset, int32 endOffset, int32 ioLane) {
+IOFacade::LoadFileRange(const URL& url, int32 startOffset, int32 endOffset, int32 ioLane, Messaging::Priority::Code prio) {
     Ptr<IOProtocol::GetRange> ioReq = IOProtocol::GetRange::Create();
     ioReq->SetURL(url);
     ioReq->SetLane(ioLane);
+    ioReq->SetPriority(prio);
     ioReq->SetStartOffset(startOffset);
     ioReq->SetEndOffset(endOffset);
     this->requestRouter->Put(ioReq);
@@ -13,6 +13,7 @@
 #include "IO/schemeRegistry.h"
 #include "IO/IOProtocol.h"
 #include "IO/ioRequestRouter.h"
+#include "Core/Task.h"
 #include <thread>
 
 namespace Oryol {
@@ -43,9 +44,11 @@ public:
     bool IsFileSystemRegistered(const Core::StringAtom& scheme) const;
     
     /// asynchronously load a file, returns IORequest object
-    Core::Ptr<IOProtocol::Get> LoadFile(const IO::URL& url, int32 ioLane = 0);
+    Core::Ptr<IOProtocol::Get> LoadFile(const IO::URL& url, int32 ioLane = 0, Messaging::Priority::Code prio = Messaging::Priority::Normal);
+    /// asynchronously load a file, returns a Task which completes when the request is handled
+    Core::Task<Core::Ptr<IOProtocol::Get>> LoadFileTask(const IO::URL& url, int32 ioLane = 0, Messaging::Priority::Code prio = Messaging::Priority::Normal);
     /// asynchronously load a file, return IORequest object
-    Core::Ptr<IOProtocol::GetRange> LoadFileRange(const IO::URL& url, int32 startOffset, int32 endOffset, int32 ioLane = 0);
+    Core::Ptr<IOProtocol::GetRange> LoadFileRange(const IO::URL& url, int32 startOffset, int32 endOffset, int32 ioLane = 0, Messaging::Priority::Code prio = Messaging::Priority::Normal);
     /// add a preload file
     void AddPreloadFile(const IO::URL& url, int32 ioLane = 0);
     /// return true if preloading is finished
@@ -6,6 +6,7 @@
 #include <cstring>
 #include "Messaging/Message.h"
 #include "Messaging/Serializer.h"
+#include "Messaging/CompactSerializer.h"
 #include "Messaging/Protocol.h"
 #include "Core/Ptr.h"
 #include "IO/URL.h"
@@ -19,10 +20,38 @@ public:
     static Messaging::ProtocolIdType GetProtocolId() {
         return 'IOPT';
     };
+    static bool HasProtocol(Messaging::ProtocolIdType protId) {
+        return (protId == 'IOPT') || Messaging::Protocol::HasProtocol(protId);
+    };
+    static uint32 GetWireId(Messaging::MessageIdType id) {
+        switch (id) {
+            case MessageId::RequestId: return 0xcae2cc2aU;
+            case MessageId::GetId: return 0xbf28056fU;
+            case MessageId::GetRangeId: return 0x56f996a4U;
+            case MessageId::notifyLanesId: return 0xe49a2c77U;
+            case MessageId::notifyFileSystemRemovedId: return 0x9de8d319U;
+            case MessageId::notifyFileSystemReplacedId: return 0x697bed83U;
+            case MessageId::notifyFileSystemAddedId: return 0xee972fefU;
+            default: return Messaging::Protocol::GetWireId(id);
+        }
+    };
+    static Messaging::MessageIdType FindMessageId(uint32 wireId) {
+        switch (wireId) {
+            case 0xcae2cc2aU: return MessageId::RequestId;
+            case 0xbf28056fU: return MessageId::GetId;
+            case 0x56f996a4U: return MessageId::GetRangeId;
+            case 0xe49a2c77U: return MessageId::notifyLanesId;
+            case 0x9de8d319U: return MessageId::notifyFileSystemRemovedId;
+            case 0x697bed83U: return MessageId::notifyFileSystemReplacedId;
+            case 0xee972fefU: return MessageId::notifyFileSystemAddedId;
+            default: return Messaging::Protocol::FindMessageId(wireId);
+        }
+    };
     class MessageId {
     public:
         enum {
-            RequestId = Messaging::Protocol::MessageId::NumMessageIds, 
+            FirstMessageId = Messaging::Protocol::MessageId::NumMessageIds,
+            RequestId = FirstMessageId, 
             GetId,
             GetRangeId,
             notifyLanesId,
@@ -65,6 +94,8 @@ public:
     public:
         Request() {
             this->msgId = MessageId::RequestId;
+            this->protId = 'IOPT';
+            this->priority = Messaging::Priority::Normal;
             this->lane = 0;
             this->cachereadenabled = false;
             this->cachewriteenabled = false;
@@ -80,6 +111,13 @@ public:
             if (protId == 'IOPT') return true;
             else return Messaging::Message::IsMemberOf(protId);
         };
+        static const uint64 DerivedMask = 0x7ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'IOPT') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const Request*>(msg);
+        };
         void SetURL(const IO::URL& val) {
             this->url = val;
         };
@@ -129,6 +167,7 @@ private:
     public:
         Get() {
             this->msgId = MessageId::GetId;
+            this->protId = 'IOPT';
         };
         static Messaging::Message* FactoryCreate() {
             return (Messaging::Message*) Create();
@@ -140,6 +179,13 @@ private:
             if (protId == 'IOPT') return true;
             else return Request::IsMemberOf(protId);
         };
+        static const uint64 DerivedMask = 0x6ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'IOPT') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const Get*>(msg);
+        };
         void SetStream(const Core::Ptr<IO::MemoryStream>& val) {
             this->stream = val;
         };
@@ -154,6 +200,7 @@ private:
     public:
         GetRange() {
             this->msgId = MessageId::GetRangeId;
+            this->protId = 'IOPT';
             this->startoffset = 0;
             this->endoffset = 0;
         };
@@ -167,6 +214,13 @@ private:
             if (protId == 'IOPT') return true;
             else return Get::IsMemberOf(protId);
         };
+        static const uint64 DerivedMask = 0x4ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'IOPT') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const GetRange*>(msg);
+        };
         void SetStartOffset(int32 val) {
             this->startoffset = val;
         };
@@ -188,6 +242,7 @@ private:
     public:
         notifyLanes() {
             this->msgId = MessageId::notifyLanesId;
+            this->protId = 'IOPT';
         };
         static Messaging::Message* FactoryCreate() {
             return (Messaging::Message*) Create();
@@ -199,6 +254,13 @@ private:
             if (protId == 'IOPT') return true;
             else return Messaging::Message::IsMemberOf(protId);
         };
+        static const uint64 DerivedMask = 0x78ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'IOPT') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const notifyLanes*>(msg);
+        };
 private:
     };
     class notifyFileSystemRemoved : public notifyLanes {
@@ -206,6 +268,7 @@ private:
     public:
         notifyFileSystemRemoved() {
             this->msgId = MessageId::notifyFileSystemRemovedId;
+            this->protId = 'IOPT';
         };
         static Messaging::Message* FactoryCreate() {
             return (Messaging::Message*) Create();
@@ -217,6 +280,13 @@ private:
             if (protId == 'IOPT') return true;
             else return notifyLanes::IsMemberOf(protId);
         };
+        static const uint64 DerivedMask = 0x10ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'IOPT') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const notifyFileSystemRemoved*>(msg);
+        };
         void SetScheme(const Core::StringAtom& val) {
             this->scheme = val;
         };
@@ -231,6 +301,7 @@ private:
     public:
         notifyFileSystemReplaced() {
             this->msgId = MessageId::notifyFileSystemReplacedId;
+            this->protId = 'IOPT';
         };
         static Messaging::Message* FactoryCreate() {
             return (Messaging::Message*) Create();
@@ -242,6 +313,13 @@ private:
             if (protId == 'IOPT') return true;
             else return notifyLanes::IsMemberOf(protId);
         };
+        static const uint64 DerivedMask = 0x20ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'IOPT') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const notifyFileSystemReplaced*>(msg);
+        };
         void SetScheme(const Core::StringAtom& val) {
             this->scheme = val;
         };
@@ -256,6 +334,7 @@ private:
     public:
         notifyFileSystemAdded() {
             this->msgId = MessageId::notifyFileSystemAddedId;
+            this->protId = 'IOPT';
         };
         static Messaging::Message* FactoryCreate() {
             return (Messaging::Message*) Create();
@@ -267,6 +346,13 @@ private:
             if (protId == 'IOPT') return true;
             else return notifyLanes::IsMemberOf(protId);
         };
+        static const uint64 DerivedMask = 0x40ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'IOPT') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const notifyFileSystemAdded*>(msg);
+        };
         void SetScheme(const Core::StringAtom& val) {
             this->scheme = val;
         };
@@ -276,6 +362,21 @@ private:
 private:
         Core::StringAtom scheme;
     };
+    template<class VISITOR> static bool Visit(const Core::Ptr<Messaging::Message>& msg, VISITOR&& visitor) {
+        if (msg->ProtocolId() != GetProtocolId()) {
+            return Messaging::Protocol::Visit(msg, visitor);
+        }
+        switch (msg->MessageId()) {
+            case MessageId::RequestId: visitor(Core::Ptr<Request>(static_cast<Request*>(msg.get()))); return true;
+            case MessageId::GetId: visitor(Core::Ptr<Get>(static_cast<Get*>(msg.get()))); return true;
+            case MessageId::GetRangeId: visitor(Core::Ptr<GetRange>(static_cast<GetRange*>(msg.get()))); return true;
+            case MessageId::notifyLanesId: visitor(Core::Ptr<notifyLanes>(static_cast<notifyLanes*>(msg.get()))); return true;
+            case MessageId::notifyFileSystemRemovedId: visitor(Core::Ptr<notifyFileSystemRemoved>(static_cast<notifyFileSystemRemoved*>(msg.get()))); return true;
+            case MessageId::notifyFileSystemReplacedId: visitor(Core::Ptr<notifyFileSystemReplaced>(static_cast<notifyFileSystemReplaced*>(msg.get()))); return true;
+            case MessageId::notifyFileSystemAddedId: visitor(Core::Ptr<notifyFileSystemAdded>(static_cast<notifyFileSystemAdded*>(msg.get()))); return true;
+            default: return false;
+        }
+    };
 };
 }
 }
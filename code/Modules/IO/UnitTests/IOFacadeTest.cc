@@ -8,6 +8,7 @@
 #include "IO/BinaryStreamReader.h"
 #include "IO/BinaryStreamWriter.h"
 #include "IO/MemoryStream.h"
+#include "Core/String/StringBuilder.h"
 
 using namespace Oryol;
 using namespace Oryol::Core;
@@ -82,3 +83,49 @@ TEST(IOFacadeTest) {
     
     IOFacade::DestroySingleton();
 }
+
+//------------------------------------------------------------------------------
+TEST(IOFacadeTaskTest) {
+    IOFacade* ioFacade = IOFacade::CreateSingleton();
+    ioFacade->RegisterFileSystem<TestFileSystem>("test", &TestFileSystem::Create<>);
+    ioFacade->SetAssign("bla:", "test://blub.com/");
+
+    // load many files concurrently, nobody polls the requests
+    const int32 numFiles = 256;
+    Array<Task<StringAtom>> tasks;
+    for (int32 i = 0; i < numFiles; i++) {
+        StringBuilder builder;
+        builder.Format(64, "bla:file%d.txt", i);
+        tasks.AddBack(ioFacade->LoadFileTask(URL(builder.GetString()), i % 4).Then([](const Ptr<IOProtocol::Get>& msg) {
+            StringAtom str;
+            if ((msg->GetStatus() == IOStatus::OK) && msg->GetStream().isValid()) {
+                const Ptr<Stream>& stream = msg->GetStream();
+                stream->Open(OpenMode::ReadOnly);
+                Ptr<BinaryStreamReader> reader = BinaryStreamReader::Create(stream);
+                reader->Read(str);
+                stream->Close();
+            }
+            return str;
+        }));
+    }
+    // a dependent load, started when the first one is done
+    Task<StringAtom> chained = ioFacade->LoadFileTask("bla:first.txt").Then([ioFacade](const Ptr<IOProtocol::Get>& msg) {
+        return ioFacade->LoadFileTask("bla:second.txt");
+    }).Then([](const Ptr<IOProtocol::Get>& msg) {
+        return StringAtom(msg->GetURL().Get());
+    });
+
+    Task<Array<StringAtom>> all = WhenAll(tasks);
+    while (!(all.IsDone() && chained.IsDone())) {
+        CoreFacade::Instance()->RunLoop()->Run();
+    }
+    CHECK(all.Result().Size() == numFiles);
+    for (int32 i = 0; i < numFiles; i++) {
+        StringBuilder builder;
+        builder.Format(64, "test://blub.com/file%d.txt", i);
+        CHECK(all.Result()[i].AsString() == builder.GetString());
+    }
+    CHECK(chained.Result() == "test://blub.com/second.txt");
+
+    IOFacade::DestroySingleton();
+}
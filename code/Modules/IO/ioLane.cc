@@ -5,6 +5,8 @@
 #include "ioLane.h"
 #include "Messaging/Dispatcher.h"
 #include "IO/schemeRegistry.h"
+#include "Core/Profiler.h"
+#include "Core/Metrics.h"
 
 namespace Oryol {
 namespace IO {
@@ -14,6 +16,21 @@ OryolClassImpl(ioLane);
 using namespace Core;
 using namespace Messaging;
 
+namespace {
+    Metrics::Id requestsMetric() {
+        static const Metrics::Id id = Metrics::RegisterCounter("io.requests");
+        return id;
+    }
+    Metrics::Id bytesMetric() {
+        static const Metrics::Id id = Metrics::RegisterCounter("io.bytes");
+        return id;
+    }
+    Metrics::Id latencyMetric() {
+        static const Metrics::Id id = Metrics::RegisterHistogram("io.request_ns");
+        return id;
+    }
+}
+
 //------------------------------------------------------------------------------
 ioLane::ioLane() {
     // let our thread wake up from time to time
@@ -29,6 +46,7 @@ ioLane::~ioLane() {
 void
 ioLane::onThreadEnter() {
     ThreadedQueue::onThreadEnter();
+    o_prof_thread_name("ioLane");
 
     // setup a Dispatcher to route messages to safely route messages
     // to this object's callback methods
@@ -77,6 +95,8 @@ ioLane::fileSystemForURL(const URL& url) {
 //------------------------------------------------------------------------------
 void
 ioLane::onGet(const Ptr<IOProtocol::Get>& msg) {
+    o_prof_scope("ioLane::onGet");
+    Metrics::Add(requestsMetric());
     if (msg->Cancelled()) {
         // message has been cancelled, don't waste time with it
         msg->SetStatus(IOStatus::Cancelled);
@@ -85,6 +105,15 @@ ioLane::onGet(const Ptr<IOProtocol::Get>& msg) {
     else {
         Ptr<FileSystem> fs = this->fileSystemForURL(msg->GetURL());
         if (fs) {
+            // the handler is owned by the message, so don't capture a Ptr
+            IOProtocol::Get* get = msg.get();
+            const Clock::Ticks start = Clock::Now();
+            msg->OnHandled([get, start]() {
+                Metrics::Record(latencyMetric(), Clock::Since(start));
+                if (get->GetStream().isValid()) {
+                    Metrics::Add(bytesMetric(), get->GetStream()->Size());
+                }
+            });
             fs->onGet(msg);
         }
     }
@@ -35,19 +35,18 @@ ioRequestRouter::~ioRequestRouter() {
 bool
 ioRequestRouter::Put(const Ptr<Message>& msg) {
     // is it a notify message for all lanes?
-    Ptr<IOProtocol::notifyLanes> notifyMsg = msg.dynamicCast<IOProtocol::notifyLanes>();
-    if (notifyMsg.isValid()) {
+    if (IOProtocol::notifyLanes::IsA(msg.get())) {
+        bool allPut = true;
         for (const auto& lane : this->ioLanes) {
-            lane->Put(msg);
+            allPut &= lane->Put(msg);
         }
-        return true;
+        return allPut;
     }
     else {
-        Ptr<IOProtocol::Request> req = msg.dynamicCast<IOProtocol::Request>();
+        Ptr<IOProtocol::Request> req = MessageCast<IOProtocol::Request>(msg);
         if (req.isValid()) {
             const int32 laneIndex = req->GetLane() % this->numLanes;
-            this->ioLanes[laneIndex]->Put(msg);
-            return true;
+            return this->ioLanes[laneIndex]->Put(msg);
         }
     }
     // fallthrough: unrecognized message
@@ -34,6 +34,28 @@ AsyncQueue::DoWork() {
 //------------------------------------------------------------------------------
 bool
 AsyncQueue::Put(const Ptr<Message>& msg) {
+    if (this->monitor.full()) {
+        switch (this->monitor.overflow) {
+            case Overflow::Reject:
+                this->monitor.rejected();
+                return false;
+            case Overflow::DropOldest:
+                {
+                    Ptr<Message> oldest(std::move(this->queue.Dequeue()));
+                    this->monitor.dropped(oldest.get());
+                }
+                break;
+            default:
+                o_assert(this->forwardingPort);
+                {
+                    Ptr<Message> oldest(std::move(this->queue.Dequeue()));
+                    this->monitor.dequeued(oldest.get());
+                    this->forwardingPort->Put(oldest);
+                }
+                break;
+        }
+    }
+    this->monitor.enqueued(msg.get());
     this->queue.Enqueue(msg);
     return true;
 }
@@ -43,7 +65,9 @@ void
 AsyncQueue::ForwardMessages() {
     if (this->forwardingPort) {
         while (!this->queue.Empty()) {
-            this->forwardingPort->Put(this->queue.Dequeue());
+            Ptr<Message> msg(std::move(this->queue.Dequeue()));
+            this->monitor.dequeued(msg.get());
+            this->forwardingPort->Put(msg);
         }
     }
 }
@@ -66,5 +90,35 @@ AsyncQueue::GetNumQueuedMessages() const {
     return this->queue.Size();
 }
 
+//------------------------------------------------------------------------------
+void
+AsyncQueue::SetCapacity(int32 capacity, Overflow::Code overflow) {
+    this->monitor.setCapacity(capacity, overflow);
+}
+
+//------------------------------------------------------------------------------
+int32
+AsyncQueue::GetCapacity() const {
+    return this->monitor.capacity;
+}
+
+//------------------------------------------------------------------------------
+Overflow::Code
+AsyncQueue::GetOverflow() const {
+    return this->monitor.overflow;
+}
+
+//------------------------------------------------------------------------------
+void
+AsyncQueue::SetMetricsName(const char* name) {
+    this->monitor.setMetricsName(name);
+}
+
+//------------------------------------------------------------------------------
+QueueStats
+AsyncQueue::GetStats() const {
+    return this->monitor.stats();
+}
+
 } // namespace Messaging
 } // namespace Oryol
\ No newline at end of file
@@ -7,8 +7,17 @@
     A Port which acts as a single-threaded, asynchronous, message queue.
     Incoming messages are put on a Queue, and are forwarded to the
     attached Port when DoWork() is called.
+    
+    SetCapacity() limits the number of queued messages, when the queue
+    is full Overflow::Reject lets Put() return false, Overflow::DropOldest
+    cancels and drops the oldest queued message, and Overflow::Block 
+    (there is no other thread to wait for) forwards the oldest message
+    right away to make room. GetStats() returns depth, high-water mark
+    and latency of the queue.
 */
 #include "Messaging/Port.h"
+#include "Messaging/QueueStats.h"
+#include "Messaging/queueMonitor.h"
 #include "Core/Containers/Queue.h"
 
 namespace Oryol {
@@ -28,6 +37,16 @@ public:
     const Core::Ptr<Port>& GetForwardingPort() const;
     /// get number of queued messages
     int32 GetNumQueuedMessages() const;
+    /// set max number of queued messages (0 is unbounded) and overflow policy
+    void SetCapacity(int32 capacity, Overflow::Code overflow = Overflow::Block);
+    /// get max number of queued messages, 0 if unbounded
+    int32 GetCapacity() const;
+    /// get the overflow policy
+    Overflow::Code GetOverflow() const;
+    /// publish depth and latency as metrics messaging.[name].*
+    void SetMetricsName(const char* name);
+    /// get queue statistics
+    QueueStats GetStats() const;
     
     /// this only forwards the DoWork() call to the forwarding port
     virtual void DoWork();
@@ -39,6 +58,7 @@ public:
 protected:
     Core::Queue<Core::Ptr<Message>> queue;
     Core::Ptr<Port> forwardingPort;
+    queueMonitor monitor;
 };
 
 } // namespace Messaging
@@ -0,0 +1,70 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @fn Oryol::Messaging::Await
+    @brief get a Core::Task which completes when a message is handled
+
+    Instead of polling msg->Handled() every frame, turn the message
+    into a Task and attach a continuation:
+
+        Messaging::Await(msg).Then([](const Ptr<MyProtocol::Request>& msg) {
+            ...
+        });
+
+    The message may be handled on any thread, the Task is resolved
+    at the start of the next frame on the given RunLoop (default: the
+    RunLoop of the calling thread), so continuations run on the thread
+    which awaits the message.
+
+    If the message is destroyed without having been handled (it was
+    rejected by a full queue, or a port dropped it), the Task fails
+    instead, so OnFailed() continuations run rather than nothing.
+*/
+#include "Core/Task.h"
+#include "Core/RunLoop.h"
+#include "Core/CoreFacade.h"
+#include "Messaging/Message.h"
+
+namespace Oryol {
+namespace Messaging {
+
+// private class, do not use: owned by the OnHandled() function of an
+// awaited message, fails the Task if the message goes away unhandled
+template<class MSG> class awaitState : public Core::RefCounted {
+    OryolClassDecl(awaitState);
+public:
+    ~awaitState() {
+        if (!this->handled) {
+            Core::Promise<Core::Ptr<MSG>> p(this->promise);
+            this->loop->Post([p]() mutable {
+                p.Fail();
+            });
+        }
+    };
+    Core::Promise<Core::Ptr<MSG>> promise;
+    Core::Ptr<Core::RunLoop> loop;
+    bool handled = false;
+};
+
+template<class MSG> Core::Task<Core::Ptr<MSG>>
+Await(const Core::Ptr<MSG>& msg, Core::RunLoop* runLoop = nullptr) {
+    o_assert(msg.isValid());
+    Core::Ptr<awaitState<MSG>> state = awaitState<MSG>::Create();
+    state->loop = nullptr != runLoop ? runLoop : Core::CoreFacade::Instance()->RunLoop();
+    Core::Task<Core::Ptr<MSG>> task = state->promise.GetTask();
+    // don't capture a Ptr to the message in its own handler, the
+    // message is alive while it's being handled
+    MSG* rawMsg = msg.get();
+    msg->OnHandled([state, rawMsg]() {
+        state->handled = true;
+        Core::Ptr<MSG> handledMsg(rawMsg);
+        Core::Promise<Core::Ptr<MSG>> p(state->promise);
+        state->loop->Post([p, handledMsg]() mutable {
+            p.Resolve(handledMsg);
+        });
+    });
+    return task;
+}
+
+} // namespace Messaging
+} // namespace Oryol
@@ -0,0 +1,597 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Messaging::CompactSerializer
+    @brief compact, versioned message encoding
+    
+    An alternative to the raw encoding of Serializer for data which
+    is stored, or exchanged between different builds of a program.
+    The message classes of a protocol implement both encodings
+    (EncodeCompact(), DecodeCompact() and CompactEncodedSize() for 
+    this one).
+    
+    Integers are LEB128 varints (signed integers and enums are 
+    zigzag-encoded, so small negative values are small too), floats
+    are little-endian, strings and arrays are prefixed with their 
+    size. Each attribute is a field with a key (tag << 3 | wire type),
+    attributes which have their default value are left out. The tag
+    of an attribute is its (1-based) position in its message class,
+    or set in the protocol XML:
+    
+        <Attr name="Score" type="int32" tag="5"/>
+    
+    The fields of each class of the inheritance chain are in a 
+    group with a size prefix (parent class first). A decoder skips
+    fields with unknown tags (attributes which have been added later),
+    and keeps the default value for attributes which are missing or 
+    have a different wire type, so attributes can be added and
+    removed without breaking existing data, as long as tags are not
+    reused.
+    
+    EncodeMessage() and DecodeMessage() add a header with the wire id
+    of the message class and the size. The wire id is a hash of the
+    protocol id and class name (see Protocol::GetWireId()), unlike the
+    message id it doesn't change when message classes are added to the
+    protocol or its parents, so data written before is still decoded.
+    DecodeMessage() fails for unknown wire ids (messages added by a 
+    newer build) instead of creating the wrong message.
+    
+    Views are encoded as raw elements (in host byte order), and are
+    always copied when decoded.
+*/
+#include <string.h>
+#include <type_traits>
+#include "Core/Types.h"
+#include "Core/Containers/Array.h"
+#include "Core/String/String.h"
+#include "Core/String/StringAtom.h"
+#include "Messaging/Message.h"
+#include "Messaging/WireView.h"
+
+namespace Oryol {
+namespace Messaging {
+
+template<typename TYPE, typename ENABLE = void> struct compactValue;
+
+class CompactSerializer {
+public:
+    /// wire types of fields
+    enum WireType : uint8 {
+        Varint = 0,
+        Fixed64 = 1,
+        Bytes = 2,
+        Fixed32 = 5,
+    };
+
+    /// zigzag-encode a signed integer
+    static uint64 ZigZag(int64 val);
+    /// decode a zigzag-encoded integer
+    static int64 UnZigZag(uint64 val);
+    /// get the encoded size of a varint
+    static int32 VarintSize(uint64 val);
+    /// encode a varint, returns nullptr if not enough space (or dstPtr is nullptr)
+    static uint8* EncodeVarint(uint64 val, uint8* dstPtr, const uint8* maxPtr);
+    /// decode a varint, returns nullptr if not enough data (or srcPtr is nullptr)
+    static const uint8* DecodeVarint(const uint8* srcPtr, const uint8* maxPtr, uint64& outVal);
+    
+    /// get the encoded size of a field
+    template<typename TYPE> static int32 FieldSize(uint32 tag, const TYPE& val);
+    /// encode a field
+    template<typename TYPE> static uint8* EncodeField(uint32 tag, const TYPE& val, uint8* dstPtr, const uint8* maxPtr);
+    /// decode the key of a field
+    static const uint8* DecodeKey(const uint8* srcPtr, const uint8* maxPtr, uint32& outTag, uint8& outWireType);
+    /// decode the value of a field, skips the value if the wire type doesn't match
+    template<typename TYPE> static const uint8* DecodeField(const uint8* srcPtr, const uint8* maxPtr, uint8 wireType, TYPE& outVal);
+    /// skip the value of a field
+    static const uint8* SkipField(const uint8* srcPtr, const uint8* maxPtr, uint8 wireType);
+    
+    /// get the encoded size of a group of fields
+    static int32 GroupSize(int32 fieldsSize);
+    /// decode the size of a group, returns pointer to the first field and the end of the group
+    static const uint8* DecodeGroupHeader(const uint8* srcPtr, const uint8* maxPtr, const uint8*& outEndPtr);
+    
+    /// get the encoded size of a message with header
+    static int32 EncodedMessageSize(const Core::Ptr<Message>& msg);
+    /// encode a message of PROTOCOL (or a parent protocol) with header
+    template<class PROTOCOL> static uint8* EncodeMessage(const Core::Ptr<Message>& msg, uint8* dstPtr, const uint8* maxPtr);
+    /// decode a message of PROTOCOL (or a parent protocol), returns nullptr on error or unknown message class
+    template<class PROTOCOL> static const uint8* DecodeMessage(const uint8* srcPtr, const uint8* maxPtr, Core::Ptr<Message>& outMsg);
+
+private:
+    template<typename, typename> friend struct compactValue;
+    /// write a varint, space must have been checked
+    static uint8* writeVarint(uint64 val, uint8* dstPtr);
+    /// write a little-endian 32-bit value
+    static uint8* writeFixed32(uint32 val, uint8* dstPtr);
+    /// write a little-endian 64-bit value
+    static uint8* writeFixed64(uint64 val, uint8* dstPtr);
+    /// read a little-endian 32-bit value
+    static uint32 readFixed32(const uint8* srcPtr);
+    /// read a little-endian 64-bit value
+    static uint64 readFixed64(const uint8* srcPtr);
+};
+
+// private class, do not use: other POD types are copied as raw bytes
+template<typename TYPE, typename ENABLE> struct compactValue {
+    static_assert(std::is_pod<TYPE>::value, "CompactSerializer: type not POD, must provide specialization!");
+    enum { wireType = CompactSerializer::Bytes };
+    static int32 size(const TYPE& val) {
+        return CompactSerializer::VarintSize(sizeof(TYPE)) + sizeof(TYPE);
+    };
+    static uint8* encode(const TYPE& val, uint8* dstPtr) {
+        dstPtr = CompactSerializer::writeVarint(sizeof(TYPE), dstPtr);
+        memcpy(dstPtr, &val, sizeof(TYPE));
+        return dstPtr + sizeof(TYPE);
+    };
+    static const uint8* decode(const uint8* srcPtr, const uint8* maxPtr, TYPE& outVal) {
+        uint64 len = 0;
+        srcPtr = CompactSerializer::DecodeVarint(srcPtr, maxPtr, len);
+        if ((nullptr == srcPtr) || (len > uint64(maxPtr - srcPtr))) {
+            return nullptr;
+        }
+        if (sizeof(TYPE) == len) {
+            memcpy(&outVal, srcPtr, sizeof(TYPE));
+        }
+        return srcPtr + len;
+    };
+};
+
+// private class, do not use: bool
+template<> struct compactValue<bool> {
+    enum { wireType = CompactSerializer::Varint };
+    static int32 size(bool val) {
+        return 1;
+    };
+    static uint8* encode(bool val, uint8* dstPtr) {
+        *dstPtr = val ? 1 : 0;
+        return dstPtr + 1;
+    };
+    static const uint8* decode(const uint8* srcPtr, const uint8* maxPtr, bool& outVal) {
+        uint64 val = 0;
+        srcPtr = CompactSerializer::DecodeVarint(srcPtr, maxPtr, val);
+        outVal = (0 != val);
+        return srcPtr;
+    };
+};
+
+// private class, do not use: unsigned integers
+template<typename TYPE> struct compactValue<TYPE, typename std::enable_if<std::is_integral<TYPE>::value && std::is_unsigned<TYPE>::value && !std::is_same<TYPE, bool>::value>::type> {
+    enum { wireType = CompactSerializer::Varint };
+    static int32 size(TYPE val) {
+        return CompactSerializer::VarintSize(val);
+    };
+    static uint8* encode(TYPE val, uint8* dstPtr) {
+        return CompactSerializer::writeVarint(val, dstPtr);
+    };
+    static const uint8* decode(const uint8* srcPtr, const uint8* maxPtr, TYPE& outVal) {
+        uint64 val = 0;
+        srcPtr = CompactSerializer::DecodeVarint(srcPtr, maxPtr, val);
+        outVal = TYPE(val);
+        return srcPtr;
+    };
+};
+
+// private class, do not use: signed integers and enums (zigzag)
+template<typename TYPE> struct compactValue<TYPE, typename std::enable_if<(std::is_integral<TYPE>::value && std::is_signed<TYPE>::value) || std::is_enum<TYPE>::value>::type> {
+    enum { wireType = CompactSerializer::Varint };
+    static int32 size(TYPE val) {
+        return CompactSerializer::VarintSize(CompactSerializer::ZigZag(int64(val)));
+    };
+    static uint8* encode(TYPE val, uint8* dstPtr) {
+        return CompactSerializer::writeVarint(CompactSerializer::ZigZag(int64(val)), dstPtr);
+    };
+    static const uint8* decode(const uint8* srcPtr, const uint8* maxPtr, TYPE& outVal) {
+        uint64 val = 0;
+        srcPtr = CompactSerializer::DecodeVarint(srcPtr, maxPtr, val);
+        outVal = TYPE(CompactSerializer::UnZigZag(val));
+        return srcPtr;
+    };
+};
+
+// private class, do not use: float32
+template<> struct compactValue<float32> {
+    enum { wireType = CompactSerializer::Fixed32 };
+    static int32 size(float32 val) {
+        return 4;
+    };
+    static uint8* encode(float32 val, uint8* dstPtr) {
+        uint32 bits;
+        memcpy(&bits, &val, 4);
+        return CompactSerializer::writeFixed32(bits, dstPtr);
+    };
+    static const uint8* decode(const uint8* srcPtr, const uint8* maxPtr, float32& outVal) {
+        if ((maxPtr - srcPtr) < 4) {
+            return nullptr;
+        }
+        const uint32 bits = CompactSerializer::readFixed32(srcPtr);
+        memcpy(&outVal, &bits, 4);
+        return srcPtr + 4;
+    };
+};
+
+// private class, do not use: float64
+template<> struct compactValue<float64> {
+    enum { wireType = CompactSerializer::Fixed64 };
+    static int32 size(float64 val) {
+        return 8;
+    };
+    static uint8* encode(float64 val, uint8* dstPtr) {
+        uint64 bits;
+        memcpy(&bits, &val, 8);
+        return CompactSerializer::writeFixed64(bits, dstPtr);
+    };
+    static const uint8* decode(const uint8* srcPtr, const uint8* maxPtr, float64& outVal) {
+        if ((maxPtr - srcPtr) < 8) {
+            return nullptr;
+        }
+        const uint64 bits = CompactSerializer::readFixed64(srcPtr);
+        memcpy(&outVal, &bits, 8);
+        return srcPtr + 8;
+    };
+};
+
+// private class, do not use: strings
+template<> struct compactValue<Core::String> {
+    enum { wireType = CompactSerializer::Bytes };
+    static int32 size(const Core::String& val) {
+        return CompactSerializer::VarintSize(val.Length()) + val.Length();
+    };
+    static uint8* encode(const Core::String& val, uint8* dstPtr) {
+        const int32 len = val.Length();
+        dstPtr = CompactSerializer::writeVarint(len, dstPtr);
+        memcpy(dstPtr, val.AsCStr(), len);
+        return dstPtr + len;
+    };
+    static const uint8* decode(const uint8* srcPtr, const uint8* maxPtr, Core::String& outVal) {
+        uint64 len = 0;
+        srcPtr = CompactSerializer::DecodeVarint(srcPtr, maxPtr, len);
+        if ((nullptr == srcPtr) || (len > uint64(maxPtr - srcPtr))) {
+            return nullptr;
+        }
+        if (len > 0) {
+            outVal.Assign((const char*) srcPtr, 0, int32(len));
+        }
+        else {
+            outVal.Clear();
+        }
+        return srcPtr + len;
+    };
+};
+
+// private class, do not use: string atoms
+template<> struct compactValue<Core::StringAtom> {
+    enum { wireType = CompactSerializer::Bytes };
+    static int32 size(const Core::StringAtom& val) {
+        return CompactSerializer::VarintSize(val.Length()) + val.Length();
+    };
+    static uint8* encode(const Core::StringAtom& val, uint8* dstPtr) {
+        const int32 len = val.Length();
+        dstPtr = CompactSerializer::writeVarint(len, dstPtr);
+        memcpy(dstPtr, val.AsCStr(), len);
+        return dstPtr + len;
+    };
+    static const uint8* decode(const uint8* srcPtr, const uint8* maxPtr, Core::StringAtom& outVal) {
+        Core::String str;
+        srcPtr = compactValue<Core::String>::decode(srcPtr, maxPtr, str);
+        outVal = str;
+        return srcPtr;
+    };
+};
+
+// private class, do not use: arrays (element count and elements)
+template<typename TYPE> struct compactValue<Core::Array<TYPE>> {
+    enum { wireType = CompactSerializer::Bytes };
+    static int32 payloadSize(const Core::Array<TYPE>& vals) {
+        int32 size = CompactSerializer::VarintSize(vals.Size());
+        for (const TYPE& val : vals) {
+            size += compactValue<TYPE>::size(val);
+        }
+        return size;
+    };
+    static int32 size(const Core::Array<TYPE>& vals) {
+        const int32 payload = payloadSize(vals);
+        return CompactSerializer::VarintSize(payload) + payload;
+    };
+    static uint8* encode(const Core::Array<TYPE>& vals, uint8* dstPtr) {
+        dstPtr = CompactSerializer::writeVarint(payloadSize(vals), dstPtr);
+        dstPtr = CompactSerializer::writeVarint(vals.Size(), dstPtr);
+        for (const TYPE& val : vals) {
+            dstPtr = compactValue<TYPE>::encode(val, dstPtr);
+        }
+        return dstPtr;
+    };
+    static const uint8* decode(const uint8* srcPtr, const uint8* maxPtr, Core::Array<TYPE>& outVals) {
+        uint64 len = 0;
+        srcPtr = CompactSerializer::DecodeVarint(srcPtr, maxPtr, len);
+        if ((nullptr == srcPtr) || (len > uint64(maxPtr - srcPtr))) {
+            return nullptr;
+        }
+        const uint8* endPtr = srcPtr + len;
+        uint64 num = 0;
+        srcPtr = CompactSerializer::DecodeVarint(srcPtr, endPtr, num);
+        // each element is at least 1 byte
+        if ((nullptr == srcPtr) || (num > uint64(endPtr - srcPtr))) {
+            return nullptr;
+        }
+        outVals.Clear();
+        outVals.Reserve(int32(num));
+        for (uint64 i = 0; i < num; i++) {
+            TYPE val = TYPE();
+            srcPtr = compactValue<TYPE>::decode(srcPtr, endPtr, val);
+            if (nullptr == srcPtr) {
+                return nullptr;
+            }
+            outVals.AddBack(val);
+        }
+        return (srcPtr == endPtr) ? endPtr : nullptr;
+    };
+};
+
+// private class, do not use: views (element count and raw elements)
+template<typename TYPE> struct compactValue<WireView<TYPE>> {
+    enum { wireType = CompactSerializer::Bytes };
+    static int32 payloadSize(const WireView<TYPE>& view) {
+        return CompactSerializer::VarintSize(view.Size()) + view.Size() * sizeof(TYPE);
+    };
+    static int32 size(const WireView<TYPE>& view) {
+        const int32 payload = payloadSize(view);
+        return CompactSerializer::VarintSize(payload) + payload;
+    };
+    static uint8* encode(const WireView<TYPE>& view, uint8* dstPtr) {
+        const int32 numBytes = view.Size() * sizeof(TYPE);
+        dstPtr = CompactSerializer::writeVarint(payloadSize(view), dstPtr);
+        dstPtr = CompactSerializer::writeVarint(view.Size(), dstPtr);
+        if (numBytes > 0) {
+            memcpy(dstPtr, view.begin(), numBytes);
+        }
+        return dstPtr + numBytes;
+    };
+    static const uint8* decode(const uint8* srcPtr, const uint8* maxPtr, WireView<TYPE>& outView) {
+        uint64 len = 0;
+        srcPtr = CompactSerializer::DecodeVarint(srcPtr, maxPtr, len);
+        if ((nullptr == srcPtr) || (len > uint64(maxPtr - srcPtr))) {
+            return nullptr;
+        }
+        const uint8* endPtr = srcPtr + len;
+        uint64 num = 0;
+        srcPtr = CompactSerializer::DecodeVarint(srcPtr, endPtr, num);
+        if ((nullptr == srcPtr) || ((num * sizeof(TYPE)) != uint64(endPtr - srcPtr))) {
+            return nullptr;
+        }
+        outView = WireView<TYPE>::Copy((const TYPE*) srcPtr, int32(num));
+        return endPtr;
+    };
+};
+
+//------------------------------------------------------------------------------
+inline uint64
+CompactSerializer::ZigZag(int64 val) {
+    return (uint64(val) << 1) ^ uint64(val >> 63);
+}
+
+//------------------------------------------------------------------------------
+inline int64
+CompactSerializer::UnZigZag(uint64 val) {
+    return int64(val >> 1) ^ -int64(val & 1);
+}
+
+//------------------------------------------------------------------------------
+inline int32
+CompactSerializer::VarintSize(uint64 val) {
+    int32 size = 1;
+    while (val >= 0x80) {
+        val >>= 7;
+        size++;
+    }
+    return size;
+}
+
+//------------------------------------------------------------------------------
+inline uint8*
+CompactSerializer::writeVarint(uint64 val, uint8* dstPtr) {
+    while (val >= 0x80) {
+        *dstPtr++ = uint8(val) | 0x80;
+        val >>= 7;
+    }
+    *dstPtr++ = uint8(val);
+    return dstPtr;
+}
+
+//------------------------------------------------------------------------------
+inline uint8*
+CompactSerializer::EncodeVarint(uint64 val, uint8* dstPtr, const uint8* maxPtr) {
+    if ((nullptr == dstPtr) || ((dstPtr + VarintSize(val)) > maxPtr)) {
+        return nullptr;
+    }
+    return writeVarint(val, dstPtr);
+}
+
+//------------------------------------------------------------------------------
+inline const uint8*
+CompactSerializer::DecodeVarint(const uint8* srcPtr, const uint8* maxPtr, uint64& outVal) {
+    if (nullptr == srcPtr) {
+        return nullptr;
+    }
+    uint64 val = 0;
+    for (int32 shift = 0; (shift < 64) && (srcPtr < maxPtr); shift += 7) {
+        const uint8 b = *srcPtr++;
+        val |= uint64(b & 0x7F) << shift;
+        if (0 == (b & 0x80)) {
+            outVal = val;
+            return srcPtr;
+        }
+    }
+    // not enough data, or more than 10 bytes
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+inline uint8*
+CompactSerializer::writeFixed32(uint32 val, uint8* dstPtr) {
+    dstPtr[0] = uint8(val);
+    dstPtr[1] = uint8(val >> 8);
+    dstPtr[2] = uint8(val >> 16);
+    dstPtr[3] = uint8(val >> 24);
+    return dstPtr + 4;
+}
+
+//------------------------------------------------------------------------------
+inline uint8*
+CompactSerializer::writeFixed64(uint64 val, uint8* dstPtr) {
+    dstPtr = writeFixed32(uint32(val), dstPtr);
+    return writeFixed32(uint32(val >> 32), dstPtr);
+}
+
+//------------------------------------------------------------------------------
+inline uint32
+CompactSerializer::readFixed32(const uint8* srcPtr) {
+    return uint32(srcPtr[0]) | (uint32(srcPtr[1]) << 8) | (uint32(srcPtr[2]) << 16) | (uint32(srcPtr[3]) << 24);
+}
+
+//------------------------------------------------------------------------------
+inline uint64
+CompactSerializer::readFixed64(const uint8* srcPtr) {
+    return uint64(readFixed32(srcPtr)) | (uint64(readFixed32(srcPtr + 4)) << 32);
+}
+
+//------------------------------------------------------------------------------
+template<typename TYPE> inline int32
+CompactSerializer::FieldSize(uint32 tag, const TYPE& val) {
+    return VarintSize((uint64(tag) << 3) | compactValue<TYPE>::wireType) + compactValue<TYPE>::size(val);
+}
+
+//------------------------------------------------------------------------------
+template<typename TYPE> inline uint8*
+CompactSerializer::EncodeField(uint32 tag, const TYPE& val, uint8* dstPtr, const uint8* maxPtr) {
+    if (nullptr == dstPtr) {
+        return nullptr;
+    }
+    const uint64 key = (uint64(tag) << 3) | compactValue<TYPE>::wireType;
+    if ((dstPtr + VarintSize(key) + compactValue<TYPE>::size(val)) > maxPtr) {
+        // not enough space
+        return nullptr;
+    }
+    dstPtr = writeVarint(key, dstPtr);
+    return compactValue<TYPE>::encode(val, dstPtr);
+}
+
+//------------------------------------------------------------------------------
+inline const uint8*
+CompactSerializer::DecodeKey(const uint8* srcPtr, const uint8* maxPtr, uint32& outTag, uint8& outWireType) {
+    uint64 key = 0;
+    srcPtr = DecodeVarint(srcPtr, maxPtr, key);
+    outTag = uint32(key >> 3);
+    outWireType = uint8(key & 7);
+    return srcPtr;
+}
+
+//------------------------------------------------------------------------------
+template<typename TYPE> inline const uint8*
+CompactSerializer::DecodeField(const uint8* srcPtr, const uint8* maxPtr, uint8 wireType, TYPE& outVal) {
+    if (nullptr == srcPtr) {
+        return nullptr;
+    }
+    if (compactValue<TYPE>::wireType != wireType) {
+        // the type of the attribute has changed, keep the default
+        return SkipField(srcPtr, maxPtr, wireType);
+    }
+    return compactValue<TYPE>::decode(srcPtr, maxPtr, outVal);
+}
+
+//------------------------------------------------------------------------------
+inline const uint8*
+CompactSerializer::SkipField(const uint8* srcPtr, const uint8* maxPtr, uint8 wireType) {
+    if (nullptr == srcPtr) {
+        return nullptr;
+    }
+    uint64 len = 0;
+    switch (wireType) {
+        case Varint:
+            return DecodeVarint(srcPtr, maxPtr, len);
+        case Fixed32:
+            len = 4;
+            break;
+        case Fixed64:
+            len = 8;
+            break;
+        case Bytes:
+            srcPtr = DecodeVarint(srcPtr, maxPtr, len);
+            if (nullptr == srcPtr) {
+                return nullptr;
+            }
+            break;
+        default:
+            // unknown wire type, can't skip
+            return nullptr;
+    }
+    return (len <= uint64(maxPtr - srcPtr)) ? (srcPtr + len) : nullptr;
+}
+
+//------------------------------------------------------------------------------
+inline int32
+CompactSerializer::GroupSize(int32 fieldsSize) {
+    return VarintSize(fieldsSize) + fieldsSize;
+}
+
+//------------------------------------------------------------------------------
+inline const uint8*
+CompactSerializer::DecodeGroupHeader(const uint8* srcPtr, const uint8* maxPtr, const uint8*& outEndPtr) {
+    uint64 len = 0;
+    srcPtr = DecodeVarint(srcPtr, maxPtr, len);
+    if ((nullptr == srcPtr) || (len > uint64(maxPtr - srcPtr))) {
+        return nullptr;
+    }
+    outEndPtr = srcPtr + len;
+    return srcPtr;
+}
+
+//------------------------------------------------------------------------------
+inline int32
+CompactSerializer::EncodedMessageSize(const Core::Ptr<Message>& msg) {
+    const int32 bodySize = msg->CompactEncodedSize();
+    return 4 + VarintSize(bodySize) + bodySize;
+}
+
+//------------------------------------------------------------------------------
+template<class PROTOCOL> inline uint8*
+CompactSerializer::EncodeMessage(const Core::Ptr<Message>& msg, uint8* dstPtr, const uint8* maxPtr) {
+    o_assert_dbg(PROTOCOL::HasProtocol(msg->ProtocolId()));
+    const int32 bodySize = msg->CompactEncodedSize();
+    if ((nullptr == dstPtr) || ((dstPtr + 4) > maxPtr)) {
+        return nullptr;
+    }
+    dstPtr = writeFixed32(PROTOCOL::GetWireId(msg->MessageId()), dstPtr);
+    dstPtr = EncodeVarint(bodySize, dstPtr, maxPtr);
+    if ((nullptr == dstPtr) || ((dstPtr + bodySize) > maxPtr)) {
+        return nullptr;
+    }
+    return msg->EncodeCompact(dstPtr, dstPtr + bodySize);
+}
+
+//------------------------------------------------------------------------------
+template<class PROTOCOL> inline const uint8*
+CompactSerializer::DecodeMessage(const uint8* srcPtr, const uint8* maxPtr, Core::Ptr<Message>& outMsg) {
+    if ((nullptr == srcPtr) || ((srcPtr + 4) > maxPtr)) {
+        return nullptr;
+    }
+    const MessageIdType msgId = PROTOCOL::FindMessageId(readFixed32(srcPtr));
+    if (InvalidMessageId == msgId) {
+        // unknown message class, don't guess
+        return nullptr;
+    }
+    uint64 bodySize = 0;
+    srcPtr = DecodeVarint(srcPtr + 4, maxPtr, bodySize);
+    if ((nullptr == srcPtr) || (bodySize > uint64(maxPtr - srcPtr))) {
+        return nullptr;
+    }
+    const uint8* endPtr = srcPtr + bodySize;
+    Core::Ptr<Message> msg = PROTOCOL::Factory::Create(msgId);
+    if (msg->DecodeCompact(srcPtr, endPtr) != endPtr) {
+        return nullptr;
+    }
+    outMsg = msg;
+    return endPtr;
+}
+
+} // namespace Messaging
+} // namespace Oryol
@@ -0,0 +1,319 @@
+//------------------------------------------------------------------------------
+//  Compressor.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "Compressor.h"
+#include "Messaging/fastCodec.h"
+#include "Core/Assert.h"
+#include "Core/Memory/Memory.h"
+#include "zlib/zlib.h"
+
+namespace Oryol {
+namespace Messaging {
+
+using namespace Core;
+
+namespace {
+    // raw deflate (no zlib header and checksum) with a 32 KByte window
+    const int deflateWindowBits = -15;
+    const int deflateMemLevel = 8;
+}
+
+//------------------------------------------------------------------------------
+Compressor::Compressor() :
+codec(Compression::None),
+level(DefaultLevel),
+streaming(false),
+deflateStarted(false),
+inflateStarted(false),
+deflater(nullptr),
+inflater(nullptr),
+dictionaryHash(0),
+scratch(nullptr),
+scratchCapacity(0),
+hashTable(nullptr) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+Compressor::~Compressor() {
+    if (nullptr != this->deflater) {
+        deflateEnd(this->deflater);
+        Memory::Free(this->deflater);
+    }
+    if (nullptr != this->inflater) {
+        inflateEnd(this->inflater);
+        Memory::Free(this->inflater);
+    }
+    if (nullptr != this->scratch) {
+        Memory::Free(this->scratch);
+    }
+    if (nullptr != this->hashTable) {
+        Memory::Free(this->hashTable);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+Compressor::Setup(Compression::Code codec_, int32 level_, bool streaming_) {
+    o_assert(codec_ < Compression::NumCodes);
+    o_assert((level_ >= 1) && (level_ <= 9));
+    if ((nullptr != this->deflater) && (level_ != this->level)) {
+        // the deflate stream is created again with the new level
+        deflateEnd(this->deflater);
+        Memory::Free(this->deflater);
+        this->deflater = nullptr;
+    }
+    this->codec = codec_;
+    this->level = level_;
+    this->streaming = streaming_;
+    this->Reset();
+}
+
+//------------------------------------------------------------------------------
+Compression::Code
+Compressor::GetCodec() const {
+    return this->codec;
+}
+
+//------------------------------------------------------------------------------
+int32
+Compressor::GetLevel() const {
+    return this->level;
+}
+
+//------------------------------------------------------------------------------
+bool
+Compressor::IsStreaming() const {
+    return this->streaming;
+}
+
+//------------------------------------------------------------------------------
+void
+Compressor::SetDictionary(const uint8* data, int32 size) {
+    o_assert((nullptr != data) || (0 == size));
+    this->dictionary.Clear();
+    if (size > 0) {
+        this->dictionary.Reserve(size);
+        this->dictionary.AddBack(data, size);
+    }
+    this->dictionaryHash = uint32(crc32(0, data, uInt(size)));
+    this->Reset();
+}
+
+//------------------------------------------------------------------------------
+const Array<uint8>&
+Compressor::GetDictionary() const {
+    return this->dictionary;
+}
+
+//------------------------------------------------------------------------------
+uint32
+Compressor::GetDictionaryHash() const {
+    return this->dictionaryHash;
+}
+
+//------------------------------------------------------------------------------
+void
+Compressor::Reset() {
+    if (nullptr != this->deflater) {
+        deflateReset(this->deflater);
+    }
+    if (nullptr != this->inflater) {
+        inflateReset(this->inflater);
+    }
+    this->deflateStarted = false;
+    this->inflateStarted = false;
+}
+
+//------------------------------------------------------------------------------
+int32
+Compressor::MaxCompressedSize(int32 rawSize) {
+    // deflate bound without zlib header, plus a sync flush marker
+    const int32 deflateSize = int32(compressBound(uLong(rawSize))) + 16;
+    const int32 fastSize = fastCodec::MaxCompressedSize(rawSize);
+    return deflateSize > fastSize ? deflateSize : fastSize;
+}
+
+//------------------------------------------------------------------------------
+const Compressor::Stats&
+Compressor::GetCompressStats() const {
+    return this->compressStats;
+}
+
+//------------------------------------------------------------------------------
+const Compressor::Stats&
+Compressor::GetDecompressStats() const {
+    return this->decompressStats;
+}
+
+//------------------------------------------------------------------------------
+bool
+Compressor::beginDeflate() {
+    if (nullptr == this->deflater) {
+        this->deflater = (z_stream*) Memory::Alloc(sizeof(z_stream));
+        Memory::Clear(this->deflater, sizeof(z_stream));
+        if (Z_OK != deflateInit2(this->deflater, this->level, Z_DEFLATED, deflateWindowBits, deflateMemLevel, Z_DEFAULT_STRATEGY)) {
+            Memory::Free(this->deflater);
+            this->deflater = nullptr;
+            return false;
+        }
+        this->deflateStarted = false;
+    }
+    if (this->deflateStarted) {
+        if (this->streaming) {
+            return true;
+        }
+        deflateReset(this->deflater);
+    }
+    if (!this->dictionary.Empty()) {
+        deflateSetDictionary(this->deflater, &this->dictionary[0], uInt(this->dictionary.Size()));
+    }
+    this->deflateStarted = true;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool
+Compressor::beginInflate() {
+    if (nullptr == this->inflater) {
+        this->inflater = (z_stream*) Memory::Alloc(sizeof(z_stream));
+        Memory::Clear(this->inflater, sizeof(z_stream));
+        if (Z_OK != inflateInit2(this->inflater, deflateWindowBits)) {
+            Memory::Free(this->inflater);
+            this->inflater = nullptr;
+            return false;
+        }
+        this->inflateStarted = false;
+    }
+    if (this->inflateStarted) {
+        if (this->streaming) {
+            return true;
+        }
+        inflateReset(this->inflater);
+    }
+    if (!this->dictionary.Empty()) {
+        // a raw inflate stream takes the dictionary up front
+        inflateSetDictionary(this->inflater, &this->dictionary[0], uInt(this->dictionary.Size()));
+    }
+    this->inflateStarted = true;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+int32
+Compressor::Compress(const uint8* src, int32 srcSize, uint8* dst, int32 dstCapacity) {
+    o_assert(((nullptr != src) || (0 == srcSize)) && (nullptr != dst) && (srcSize >= 0));
+    const Clock::Ticks start = Clock::Now();
+    int32 size = 0;
+    if (Compression::Deflate == this->codec) {
+        if (this->beginDeflate()) {
+            z_stream* strm = this->deflater;
+            strm->next_in = (Bytef*) src;
+            strm->avail_in = uInt(srcSize);
+            strm->next_out = dst;
+            strm->avail_out = uInt(dstCapacity);
+            const int res = deflate(strm, this->streaming ? Z_SYNC_FLUSH : Z_FINISH);
+            const bool done = this->streaming ? 
+                ((Z_OK == res) && (0 == strm->avail_in) && (strm->avail_out > 0)) : 
+                (Z_STREAM_END == res);
+            if (done) {
+                size = dstCapacity - int32(strm->avail_out);
+            }
+            else {
+                // dst too small, the stream can't be continued
+                this->Reset();
+            }
+        }
+    }
+    else if (Compression::Fast == this->codec) {
+        if (nullptr == this->hashTable) {
+            this->hashTable = (uint32*) Memory::Alloc(fastCodec::HashSize * sizeof(uint32));
+            Memory::Clear(this->hashTable, fastCodec::HashSize * sizeof(uint32));
+        }
+        if (this->dictionary.Empty()) {
+            size = fastCodec::Compress(src, 0, srcSize, dst, dstCapacity, this->hashTable);
+        }
+        else {
+            // matches may reference the end of the dictionary
+            const int32 dictSize = this->dictionary.Size() < fastCodec::MaxOffset ? this->dictionary.Size() : fastCodec::MaxOffset;
+            const int32 needed = dictSize + srcSize;
+            if (needed > this->scratchCapacity) {
+                this->scratch = (uint8*) Memory::ReAlloc(this->scratch, needed);
+                this->scratchCapacity = needed;
+            }
+            Memory::Copy(&this->dictionary[this->dictionary.Size() - dictSize], this->scratch, dictSize);
+            Memory::Copy(src, this->scratch + dictSize, srcSize);
+            size = fastCodec::Compress(this->scratch, dictSize, needed, dst, dstCapacity, this->hashTable);
+        }
+    }
+    else if (srcSize <= dstCapacity) {
+        Memory::Copy(src, dst, srcSize);
+        size = srcSize;
+    }
+    if (size > 0) {
+        this->compressStats.NumBatches++;
+        this->compressStats.RawBytes += srcSize;
+        this->compressStats.PackedBytes += size;
+        this->compressStats.Time += Clock::Since(start);
+    }
+    return size;
+}
+
+//------------------------------------------------------------------------------
+bool
+Compressor::Decompress(Compression::Code codec_, const uint8* src, int32 srcSize, uint8* dst, int32 rawSize) {
+    // the sizes come from untrusted input, the buffers of an empty batch may be nullptr
+    o_assert((srcSize >= 0) && (rawSize >= 0));
+    o_assert(((nullptr != src) || (0 == srcSize)) && ((nullptr != dst) || (0 == rawSize)));
+    const Clock::Ticks start = Clock::Now();
+    bool valid = false;
+    if (Compression::Deflate == codec_) {
+        if (this->beginInflate()) {
+            // inflate() rejects a nullptr output buffer even if it is empty
+            uint8 none = 0;
+            z_stream* strm = this->inflater;
+            strm->next_in = (Bytef*) src;
+            strm->avail_in = uInt(srcSize);
+            strm->next_out = (nullptr != dst) ? dst : &none;
+            strm->avail_out = uInt(rawSize);
+            int res = inflate(strm, Z_SYNC_FLUSH);
+            if ((Z_OK == res) && (0 == strm->avail_out) && (strm->avail_in > 0)) {
+                // consume the sync flush marker, which must not produce any output
+                uint8 extra = 0;
+                strm->next_out = &extra;
+                strm->avail_out = 1;
+                res = inflate(strm, Z_SYNC_FLUSH);
+                valid = ((Z_OK == res) || (Z_STREAM_END == res)) && (1 == strm->avail_out) && (0 == strm->avail_in);
+            }
+            else {
+                valid = ((Z_OK == res) || (Z_STREAM_END == res)) && (0 == strm->avail_out) && (0 == strm->avail_in);
+            }
+            if (!valid) {
+                this->inflateStarted = false;
+                inflateReset(strm);
+            }
+        }
+    }
+    else if (Compression::Fast == codec_) {
+        const int32 dictSize = this->dictionary.Size() < fastCodec::MaxOffset ? this->dictionary.Size() : fastCodec::MaxOffset;
+        const uint8* dict = this->dictionary.Empty() ? nullptr : &this->dictionary[this->dictionary.Size() - dictSize];
+        valid = fastCodec::Decompress(src, srcSize, dst, rawSize, dict, dictSize);
+    }
+    else if (Compression::None == codec_) {
+        valid = srcSize == rawSize;
+        if (valid && (rawSize > 0)) {
+            Memory::Copy(src, dst, rawSize);
+        }
+    }
+    if (valid) {
+        this->decompressStats.NumBatches++;
+        this->decompressStats.RawBytes += rawSize;
+        this->decompressStats.PackedBytes += srcSize;
+        this->decompressStats.Time += Clock::Since(start);
+    }
+    return valid;
+}
+
+} // namespace Messaging
+} // namespace Oryol
@@ -0,0 +1,147 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Messaging::Compressor
+    @brief compress batches of encoded messages
+    
+    The compression layer of JournalPort and SocketPort. A batch is a 
+    buffer of encoded messages (a journal block, or the frames of one
+    socket write), Compress() and Decompress() work on whole batches
+    with one of the Compression codecs:
+    
+    - Deflate: zlib deflate (raw, without zlib header), the level 
+      trades speed for ratio (1 is fastest, 9 is best)
+    - Fast: an LZ77 codec in the LZ4 format, several times faster 
+      than deflate level 1, but compresses less
+    
+    Encoded messages are small and very similar, so most of what can
+    be compressed are repetitions of earlier messages. Both codecs are
+    primed with a dictionary, so even a batch with a few messages 
+    compresses well. SetProtocolDictionary() builds the dictionary 
+    from the protocol's schema (the compact encoding of each message 
+    class with default values), with optional sample messages of 
+    typical traffic. Compressing and decompressing side must use the 
+    same dictionary.
+    
+    In streaming mode the deflate history is kept from one batch to
+    the next (each batch ends with a sync flush), which compresses 
+    small batches much better, but the batches must be decompressed
+    in the same order by one Compressor. Fast batches are always 
+    independent.
+    
+    A Compressor isn't thread-safe. It keeps statistics about the
+    compression ratio and the time spent compressing and decompressing.
+*/
+#include "Messaging/Types.h"
+#include "Messaging/Message.h"
+#include "Messaging/CompactSerializer.h"
+#include "Core/Containers/Array.h"
+#include "Core/Memory/Memory.h"
+#include "Core/Time/Clock.h"
+
+struct z_stream_s;
+
+namespace Oryol {
+namespace Messaging {
+
+class Compressor {
+public:
+    /// default deflate level
+    static const int32 DefaultLevel = 1;
+    /// compression statistics
+    struct Stats {
+        /// number of batches compressed or decompressed
+        int64 NumBatches = 0;
+        /// size of the batches before compression
+        int64 RawBytes = 0;
+        /// size of the batches after compression
+        int64 PackedBytes = 0;
+        /// time spent in the codec
+        Core::Clock::Ticks Time = 0;
+    };
+
+    /// constructor
+    Compressor();
+    /// destructor
+    ~Compressor();
+    
+    /// setup the codec for Compress() (discards streaming state)
+    void Setup(Compression::Code codec, int32 level = DefaultLevel, bool streaming = false);
+    /// get the codec used by Compress()
+    Compression::Code GetCodec() const;
+    /// get the deflate level
+    int32 GetLevel() const;
+    /// return true in streaming mode
+    bool IsStreaming() const;
+    /// set the dictionary (discards streaming state)
+    void SetDictionary(const uint8* data, int32 size);
+    /// build the dictionary from the message classes of PROTOCOL and sample messages
+    template<class PROTOCOL> void SetProtocolDictionary(const Core::Array<Core::Ptr<Message>>& samples = Core::Array<Core::Ptr<Message>>());
+    /// get the dictionary
+    const Core::Array<uint8>& GetDictionary() const;
+    /// get the crc32 of the dictionary
+    uint32 GetDictionaryHash() const;
+    /// discard streaming state (for instance after a reconnect)
+    void Reset();
+    
+    /// get the max size of a compressed batch
+    static int32 MaxCompressedSize(int32 rawSize);
+    /// compress a batch, returns the compressed size or 0 if dst is too small
+    int32 Compress(const uint8* src, int32 srcSize, uint8* dst, int32 dstCapacity);
+    /// decompress a batch of exactly rawSize bytes, returns false on corrupt data
+    bool Decompress(Compression::Code codec, const uint8* src, int32 srcSize, uint8* dst, int32 rawSize);
+    
+    /// get compression statistics
+    const Stats& GetCompressStats() const;
+    /// get decompression statistics
+    const Stats& GetDecompressStats() const;
+    
+private:
+    /// prepare the deflate stream for the next batch
+    bool beginDeflate();
+    /// prepare the inflate stream for the next batch
+    bool beginInflate();
+    
+    Compression::Code codec;
+    int32 level;
+    bool streaming;
+    bool deflateStarted;
+    bool inflateStarted;
+    z_stream_s* deflater;
+    z_stream_s* inflater;
+    Core::Array<uint8> dictionary;
+    uint32 dictionaryHash;
+    uint8* scratch;
+    int32 scratchCapacity;
+    uint32* hashTable;
+    Stats compressStats;
+    Stats decompressStats;
+};
+
+//------------------------------------------------------------------------------
+template<class PROTOCOL> void
+Compressor::SetProtocolDictionary(const Core::Array<Core::Ptr<Message>>& samples) {
+    // most recent data is most useful to deflate, so the samples go last
+    Core::Array<Core::Ptr<Message>> msgs;
+    for (MessageIdType id = 0; id < MessageIdType(PROTOCOL::MessageId::NumMessageIds); id++) {
+        msgs.AddBack(PROTOCOL::Factory::Create(id));
+    }
+    for (const Core::Ptr<Message>& msg : samples) {
+        msgs.AddBack(msg);
+    }
+    int32 size = 0;
+    for (const Core::Ptr<Message>& msg : msgs) {
+        size += CompactSerializer::EncodedMessageSize(msg);
+    }
+    uint8* dict = (uint8*) Core::Memory::Alloc(size > 0 ? size : 1);
+    uint8* dstPtr = dict;
+    for (const Core::Ptr<Message>& msg : msgs) {
+        dstPtr = CompactSerializer::EncodeMessage<PROTOCOL>(msg, dstPtr, dict + size);
+    }
+    o_assert(dstPtr == dict + size);
+    this->SetDictionary(dict, size);
+    Core::Memory::Free(dict);
+}
+
+} // namespace Messaging
+} // namespace Oryol
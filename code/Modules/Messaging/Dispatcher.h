@@ -64,8 +64,9 @@ Dispatcher<PROTOCOL>::~Dispatcher() {
 //------------------------------------------------------------------------------
 template<class PROTOCOL> bool
 Dispatcher<PROTOCOL>::Put(const Core::Ptr<Message>& msg) {
-    // only consider messages of our protocol, ignore others
-    if (msg->IsMemberOf(PROTOCOL::GetProtocolId())) {
+    // only consider messages of our protocol, ignore others, the
+    // protocol id compare catches the common case without a virtual call
+    if ((msg->ProtocolId() == PROTOCOL::GetProtocolId()) || msg->IsMemberOf(PROTOCOL::GetProtocolId())) {
     
         MessageIdType msgId = msg->MessageId();
         o_assert((msgId >= 0) && (msgId < PROTOCOL::MessageId::NumMessageIds));
@@ -0,0 +1,252 @@
+//------------------------------------------------------------------------------
+//  JournalPort.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "JournalPort.h"
+#include "Messaging/journalFormat.h"
+#include "Messaging/CompactSerializer.h"
+#include "Core/Log.h"
+#include "Core/Memory/Memory.h"
+#include "zlib/zlib.h"
+
+namespace Oryol {
+namespace Messaging {
+
+OryolClassImpl(JournalPort);
+
+using namespace Core;
+
+namespace {
+    // max size of the record header (time delta, message id and size varints)
+    const int32 maxRecordHeaderSize = 20;
+}
+
+//------------------------------------------------------------------------------
+JournalPort::JournalPort() :
+fp(nullptr),
+lastTime(0),
+blockBuf(nullptr),
+blockCapacity(0),
+blockSize(0),
+packBuf(nullptr),
+packCapacity(0) {
+    this->compressor.Setup(Compression::Deflate);
+}
+
+//------------------------------------------------------------------------------
+JournalPort::JournalPort(const Ptr<Port>& forwardingPort_) :
+forwardingPort(forwardingPort_),
+fp(nullptr),
+lastTime(0),
+blockBuf(nullptr),
+blockCapacity(0),
+blockSize(0),
+packBuf(nullptr),
+packCapacity(0) {
+    this->compressor.Setup(Compression::Deflate);
+}
+
+//------------------------------------------------------------------------------
+JournalPort::~JournalPort() {
+    this->Close();
+}
+
+//------------------------------------------------------------------------------
+bool
+JournalPort::open(const char* path_, ProtocolIdType protocolId, const Array<uint32>& wireIds) {
+    o_assert(nullptr != path_);
+    o_assert(!this->IsOpen());
+    
+    this->fp = std::fopen(path_, "wb");
+    if (nullptr == this->fp) {
+        Log::Warn("JournalPort: failed to open '%s'\n", path_);
+        return false;
+    }
+    // the replayer maps the recorded message ids through their wire ids,
+    // and decompresses with the recorded dictionary
+    const Array<uint8>& dict = this->compressor.GetDictionary();
+    const int32 headerSize = journalFormat::FileHeaderSize + wireIds.Size() * 4 + dict.Size() + 4;
+    uint8* header = (uint8*) Memory::Alloc(headerSize);
+    uint8* ptr = journalFormat::Write32(journalFormat::Magic, header);
+    ptr = journalFormat::Write32(journalFormat::Version, ptr);
+    ptr = journalFormat::Write32(protocolId, ptr);
+    ptr = journalFormat::Write32(uint32(wireIds.Size()), ptr);
+    ptr = journalFormat::Write32(uint32(dict.Size()), ptr);
+    for (uint32 wireId : wireIds) {
+        ptr = journalFormat::Write32(wireId, ptr);
+    }
+    if (!dict.Empty()) {
+        Memory::Copy(&dict[0], ptr, dict.Size());
+        ptr += dict.Size();
+    }
+    const uint8* tablePtr = header + journalFormat::FileHeaderSize;
+    journalFormat::Write32(uint32(crc32(0, tablePtr, uInt(ptr - tablePtr))), ptr);
+    const bool written = std::fwrite(header, 1, headerSize, this->fp) == size_t(headerSize);
+    Memory::Free(header);
+    if (!written) {
+        Log::Warn("JournalPort: failed to write '%s'\n", path_);
+        std::fclose(this->fp);
+        this->fp = nullptr;
+        return false;
+    }
+    this->path = path_;
+    this->stats = Stats();
+    this->stats.FileBytes = headerSize;
+    this->blockSize = 0;
+    this->reserve(journalFormat::BlockSize + maxRecordHeaderSize);
+    this->lastTime = Clock::Now();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+JournalPort::Close() {
+    if (nullptr != this->fp) {
+        this->Flush();
+        std::fclose(this->fp);
+        this->fp = nullptr;
+        this->path.Clear();
+    }
+    if (nullptr != this->blockBuf) {
+        Memory::Free(this->blockBuf);
+        this->blockBuf = nullptr;
+        this->blockCapacity = 0;
+    }
+    if (nullptr != this->packBuf) {
+        Memory::Free(this->packBuf);
+        this->packBuf = nullptr;
+        this->packCapacity = 0;
+    }
+    this->blockSize = 0;
+}
+
+//------------------------------------------------------------------------------
+bool
+JournalPort::IsOpen() const {
+    return nullptr != this->fp;
+}
+
+//------------------------------------------------------------------------------
+void
+JournalPort::Flush() {
+    if (nullptr != this->fp) {
+        this->writeBlock();
+        std::fflush(this->fp);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+JournalPort::SetCompression(Compression::Code codec, int32 level) {
+    o_assert(!this->IsOpen());
+    this->compressor.Setup(codec, level);
+}
+
+//------------------------------------------------------------------------------
+Compression::Code
+JournalPort::GetCompression() const {
+    return this->compressor.GetCodec();
+}
+
+//------------------------------------------------------------------------------
+JournalPort::Stats
+JournalPort::GetStats() const {
+    return this->stats;
+}
+
+//------------------------------------------------------------------------------
+void
+JournalPort::reserve(int32 numBytes) {
+    const int32 needed = this->blockSize + numBytes;
+    if (needed > this->blockCapacity) {
+        int32 newCapacity = this->blockCapacity > 0 ? this->blockCapacity * 2 : journalFormat::BlockSize;
+        while (newCapacity < needed) {
+            newCapacity *= 2;
+        }
+        this->blockBuf = (uint8*) Memory::ReAlloc(this->blockBuf, newCapacity);
+        this->blockCapacity = newCapacity;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+JournalPort::Put(const Ptr<Message>& msg) {
+    if (nullptr != this->fp) {
+        const Clock::Ticks now = Clock::Now();
+        const int32 bodySize = msg->CompactEncodedSize();
+        this->reserve(maxRecordHeaderSize + bodySize);
+        uint8* dstPtr = this->blockBuf + this->blockSize;
+        const uint8* maxPtr = this->blockBuf + this->blockCapacity;
+        dstPtr = CompactSerializer::EncodeVarint(uint64(now - this->lastTime), dstPtr, maxPtr);
+        dstPtr = CompactSerializer::EncodeVarint(uint64(msg->MessageId()), dstPtr, maxPtr);
+        dstPtr = CompactSerializer::EncodeVarint(uint64(bodySize), dstPtr, maxPtr);
+        dstPtr = msg->EncodeCompact(dstPtr, dstPtr + bodySize);
+        o_assert(nullptr != dstPtr);
+        this->blockSize = int32(dstPtr - this->blockBuf);
+        this->lastTime = now;
+        this->stats.NumMessages++;
+        if (this->blockSize >= journalFormat::BlockSize) {
+            this->writeBlock();
+        }
+    }
+    if (this->forwardingPort) {
+        return this->forwardingPort->Put(msg);
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+JournalPort::DoWork() {
+    if (this->forwardingPort) {
+        this->forwardingPort->DoWork();
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+JournalPort::writeBlock() {
+    if (0 == this->blockSize) {
+        return;
+    }
+    const int32 bound = journalFormat::BlockHeaderSize + Compressor::MaxCompressedSize(this->blockSize);
+    if (bound > this->packCapacity) {
+        this->packBuf = (uint8*) Memory::ReAlloc(this->packBuf, bound);
+        this->packCapacity = bound;
+    }
+    
+    // store the block uncompressed if compression doesn't help
+    uint8* dataPtr = this->packBuf + journalFormat::BlockHeaderSize;
+    uint8 codec = Compression::None;
+    int32 storedSize = this->blockSize;
+    if (Compression::None != this->compressor.GetCodec()) {
+        const int32 packedSize = this->compressor.Compress(this->blockBuf, this->blockSize, dataPtr, bound - journalFormat::BlockHeaderSize);
+        if ((packedSize > 0) && (packedSize < this->blockSize)) {
+            codec = this->compressor.GetCodec();
+            storedSize = packedSize;
+        }
+    }
+    if (Compression::None == codec) {
+        Memory::Copy(this->blockBuf, dataPtr, this->blockSize);
+    }
+    
+    uint8* hdrPtr = this->packBuf;
+    hdrPtr[0] = codec;
+    hdrPtr[1] = hdrPtr[2] = hdrPtr[3] = 0;
+    hdrPtr = journalFormat::Write32(uint32(this->blockSize), hdrPtr + 4);
+    hdrPtr = journalFormat::Write32(uint32(storedSize), hdrPtr);
+    journalFormat::Write32(uint32(crc32(0, dataPtr, uInt(storedSize))), hdrPtr);
+    
+    const int32 numBytes = journalFormat::BlockHeaderSize + storedSize;
+    if (std::fwrite(this->packBuf, 1, numBytes, this->fp) != size_t(numBytes)) {
+        Log::Warn("JournalPort: failed to write '%s'\n", this->path.AsCStr());
+    }
+    this->stats.NumBlocks++;
+    this->stats.RawBytes += this->blockSize;
+    this->stats.FileBytes += numBytes;
+    this->stats.CompressTime = this->compressor.GetCompressStats().Time;
+    this->blockSize = 0;
+}
+
+} // namespace Messaging
+} // namespace Oryol
@@ -0,0 +1,124 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Messaging::JournalPort
+    @brief record message traffic into a journal file
+    
+    A JournalPort sits in front of another port, appends every message
+    which is put into it to a journal file and forwards the message
+    to the forwarding port (if any). The recorded traffic can be fed 
+    back into a port network later with a JournalReplayer, for 
+    reproducing bugs, or as a repeatable benchmark:
+    
+        Ptr<JournalPort> journal = JournalPort::Create(dispatcher);
+        journal->Open<MyProtocol>("session.jrn");
+        ...
+        journal->Put(msg);
+        ...
+        journal->Close();
+    
+    Each message is stored with the time since the previous message
+    in the compact encoding (see CompactSerializer), so a journal can 
+    be replayed by a later build which has added message classes or 
+    attributes to the protocol (the file header stores the wire ids of
+    the recorded message classes and the compression dictionary). 
+    Records are collected into blocks of about 64 KByte, each 
+    block is compressed (see Compressor, the default is deflate level 1,
+    with a dictionary built from the protocol) and appended to the file 
+    with a checksum. Blocks are compressed independently of each other.
+    Flush() writes the current block and flushes the file, a crash 
+    loses at most the messages since the last flush, and a torn block 
+    at the end of the file is ignored by the replayer.
+    
+    A JournalPort isn't thread-safe, put it into a ThreadedQueue if
+    messages come from several threads.
+*/
+#include "Messaging/Port.h"
+#include "Messaging/Compressor.h"
+#include "Core/String/String.h"
+#include "Core/Time/Clock.h"
+#include <stdio.h>
+
+namespace Oryol {
+namespace Messaging {
+    
+class JournalPort : public Port {
+    OryolClassDecl(JournalPort);
+public:
+    /// journal statistics
+    struct Stats {
+        /// number of recorded messages
+        int64 NumMessages = 0;
+        /// number of written blocks
+        int64 NumBlocks = 0;
+        /// size of the records before compression
+        int64 RawBytes = 0;
+        /// bytes written to the file
+        int64 FileBytes = 0;
+        /// time spent compressing
+        Core::Clock::Ticks CompressTime = 0;
+    };
+
+    /// constructor without forwarding port (only records)
+    JournalPort();
+    /// constructor with forwarding port
+    JournalPort(const Core::Ptr<Port>& forwardingPort);
+    /// destructor
+    virtual ~JournalPort();
+    
+    /// create or truncate a journal file for messages of PROTOCOL
+    template<class PROTOCOL> bool Open(const char* path);
+    /// write outstanding messages and close the file
+    void Close();
+    /// return true if the journal file is open
+    bool IsOpen() const;
+    /// write the current block and flush the file
+    void Flush();
+    /// set how blocks are compressed, call before Open()
+    void SetCompression(Compression::Code codec, int32 level = Compressor::DefaultLevel);
+    /// get how blocks are compressed
+    Compression::Code GetCompression() const;
+    /// get statistics
+    Stats GetStats() const;
+    
+    /// record the message, and forward it
+    virtual bool Put(const Core::Ptr<Message>& msg) override;
+    /// forward DoWork to the forwarding port
+    virtual void DoWork() override;
+    
+private:
+    /// open the file and write the file header
+    bool open(const char* path, ProtocolIdType protocolId, const Core::Array<uint32>& wireIds);
+    /// compress and write the current block
+    void writeBlock();
+    /// make room for numBytes more bytes in the block buffer
+    void reserve(int32 numBytes);
+    
+    Core::Ptr<Port> forwardingPort;
+    Core::String path;
+    FILE* fp;
+    Compressor compressor;
+    Core::Clock::Ticks lastTime;
+    uint8* blockBuf;
+    int32 blockCapacity;
+    int32 blockSize;
+    int32 blockRecords;
+    uint8* packBuf;
+    int32 packCapacity;
+    Stats stats;
+};
+
+//------------------------------------------------------------------------------
+template<class PROTOCOL> bool
+JournalPort::Open(const char* path_) {
+    this->compressor.SetProtocolDictionary<PROTOCOL>();
+    Core::Array<uint32> wireIds;
+    wireIds.Reserve(PROTOCOL::MessageId::NumMessageIds);
+    for (MessageIdType id = 0; id < MessageIdType(PROTOCOL::MessageId::NumMessageIds); id++) {
+        wireIds.AddBack(PROTOCOL::GetWireId(id));
+    }
+    return this->open(path_, PROTOCOL::GetProtocolId(), wireIds);
+}
+
+} // namespace Messaging
+} // namespace Oryol
@@ -0,0 +1,336 @@
+//------------------------------------------------------------------------------
+//  JournalReplayer.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "JournalReplayer.h"
+#include "Messaging/journalFormat.h"
+#include "Messaging/CompactSerializer.h"
+#include "Core/Log.h"
+#include "Core/Memory/Memory.h"
+#include "zlib/zlib.h"
+#include <thread>
+#include <chrono>
+
+namespace Oryol {
+namespace Messaging {
+
+OryolClassImpl(JournalReplayer);
+
+using namespace Core;
+
+namespace {
+    // max time Replay() sleeps before calling DoWork() on the port
+    const Clock::Ticks maxSleepTime = Clock::TicksPerSecond / 1000;
+}
+
+//------------------------------------------------------------------------------
+JournalReplayer::JournalReplayer() :
+fp(nullptr),
+creator(nullptr),
+blockBuf(nullptr),
+blockCapacity(0),
+blockSize(0),
+blockPos(0),
+packBuf(nullptr),
+packCapacity(0),
+pendingTime(0),
+numMessages(0),
+rawBytes(0),
+fileBytes(0) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+JournalReplayer::~JournalReplayer() {
+    this->Close();
+}
+
+//------------------------------------------------------------------------------
+bool
+JournalReplayer::open(const char* path_, ProtocolIdType protocolId, findFunc finder) {
+    o_assert(nullptr != path_);
+    o_assert(nullptr != finder);
+    o_assert(!this->IsOpen());
+    
+    this->fp = std::fopen(path_, "rb");
+    if (nullptr == this->fp) {
+        Log::Warn("JournalReplayer: failed to open '%s'\n", path_);
+        return false;
+    }
+    uint8 header[journalFormat::FileHeaderSize];
+    uint8* table = nullptr;
+    int32 headerSize = 0;
+    bool valid = false;
+    if (std::fread(header, 1, sizeof(header), this->fp) == sizeof(header)) {
+        const uint32 numIds = journalFormat::Read32(header + 12);
+        const uint32 dictSize = journalFormat::Read32(header + 16);
+        if ((journalFormat::Read32(header) != journalFormat::Magic) || (journalFormat::Read32(header + 4) != journalFormat::Version)) {
+            Log::Warn("JournalReplayer: '%s' is not a journal or has an unsupported version\n", path_);
+        }
+        else if (journalFormat::Read32(header + 8) != protocolId) {
+            Log::Warn("JournalReplayer: '%s' was recorded with a different protocol\n", path_);
+        }
+        else if ((numIds > uint32(journalFormat::MaxMessageIds)) || (dictSize > uint32(journalFormat::MaxDictionarySize))) {
+            Log::Warn("JournalReplayer: corrupt file header in '%s'\n", path_);
+        }
+        else {
+            // the wire ids of the recorded message ids, the dictionary and the crc
+            const int32 tableSize = int32(numIds) * 4 + int32(dictSize);
+            table = (uint8*) Memory::Alloc(tableSize + 4);
+            if ((std::fread(table, 1, tableSize + 4, this->fp) != size_t(tableSize + 4)) ||
+                (uint32(crc32(0, table, uInt(tableSize))) != journalFormat::Read32(table + tableSize))) {
+                Log::Warn("JournalReplayer: corrupt file header in '%s'\n", path_);
+            }
+            else {
+                // messages of classes this build doesn't know are skipped
+                int32 numUnknown = 0;
+                this->msgIdMap.Clear();
+                this->msgIdMap.Reserve(int32(numIds));
+                for (int32 i = 0; i < int32(numIds); i++) {
+                    const MessageIdType msgId = finder(journalFormat::Read32(table + i * 4));
+                    numUnknown += (InvalidMessageId == msgId) ? 1 : 0;
+                    this->msgIdMap.AddBack(msgId);
+                }
+                if (numUnknown > 0) {
+                    Log::Warn("JournalReplayer: '%s' has %d message classes unknown to this build, skipping their messages\n", path_, numUnknown);
+                }
+                this->compressor.SetDictionary(dictSize > 0 ? table + numIds * 4 : nullptr, int32(dictSize));
+                headerSize = journalFormat::FileHeaderSize + tableSize + 4;
+                valid = true;
+            }
+        }
+    }
+    else {
+        Log::Warn("JournalReplayer: failed to read '%s'\n", path_);
+    }
+    if (nullptr != table) {
+        Memory::Free(table);
+    }
+    if (!valid) {
+        std::fclose(this->fp);
+        this->fp = nullptr;
+        return false;
+    }
+    this->path = path_;
+    this->blockSize = 0;
+    this->blockPos = 0;
+    this->pendingTime = 0;
+    this->numMessages = 0;
+    this->rawBytes = 0;
+    this->fileBytes = headerSize;
+    this->readRecord();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+JournalReplayer::Close() {
+    if (nullptr != this->fp) {
+        std::fclose(this->fp);
+        this->fp = nullptr;
+        this->path.Clear();
+    }
+    if (nullptr != this->blockBuf) {
+        Memory::Free(this->blockBuf);
+        this->blockBuf = nullptr;
+        this->blockCapacity = 0;
+    }
+    if (nullptr != this->packBuf) {
+        Memory::Free(this->packBuf);
+        this->packBuf = nullptr;
+        this->packCapacity = 0;
+    }
+    this->blockSize = 0;
+    this->blockPos = 0;
+    this->pendingMsg = nullptr;
+}
+
+//------------------------------------------------------------------------------
+bool
+JournalReplayer::IsOpen() const {
+    return nullptr != this->fp;
+}
+
+//------------------------------------------------------------------------------
+bool
+JournalReplayer::AtEnd() const {
+    return !this->pendingMsg;
+}
+
+//------------------------------------------------------------------------------
+int64
+JournalReplayer::GetNumMessages() const {
+    return this->numMessages;
+}
+
+//------------------------------------------------------------------------------
+int64
+JournalReplayer::GetRawBytes() const {
+    return this->rawBytes;
+}
+
+//------------------------------------------------------------------------------
+int64
+JournalReplayer::GetFileBytes() const {
+    return this->fileBytes;
+}
+
+//------------------------------------------------------------------------------
+Clock::Ticks
+JournalReplayer::GetDecompressTime() const {
+    return this->compressor.GetDecompressStats().Time;
+}
+
+//------------------------------------------------------------------------------
+bool
+JournalReplayer::Next(Ptr<Message>& outMsg, Clock::Ticks& outTime) {
+    if (!this->pendingMsg) {
+        return false;
+    }
+    outMsg = this->pendingMsg;
+    outTime = this->pendingTime;
+    this->numMessages++;
+    this->readRecord();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+int64
+JournalReplayer::Replay(const Ptr<Port>& port, float64 speed) {
+    o_assert(port);
+    const Clock::Ticks start = Clock::Now();
+    int64 num = 0;
+    Ptr<Message> msg;
+    Clock::Ticks time = 0;
+    while (this->Next(msg, time)) {
+        if (speed > 0.0) {
+            const Clock::Ticks due = Clock::Ticks(float64(time) / speed);
+            Clock::Ticks elapsed;
+            while ((elapsed = Clock::Since(start)) < due) {
+                port->DoWork();
+                const Clock::Ticks sleepTime = (due - elapsed) < maxSleepTime ? (due - elapsed) : maxSleepTime;
+                std::this_thread::sleep_for(std::chrono::nanoseconds(sleepTime));
+            }
+        }
+        port->Put(msg);
+        num++;
+    }
+    port->DoWork();
+    return num;
+}
+
+//------------------------------------------------------------------------------
+int32
+JournalReplayer::ReplayUntil(const Ptr<Port>& port, Clock::Ticks time) {
+    o_assert(port);
+    int32 num = 0;
+    Ptr<Message> msg;
+    Clock::Ticks msgTime = 0;
+    while (this->pendingMsg && (this->pendingTime <= time)) {
+        this->Next(msg, msgTime);
+        port->Put(msg);
+        num++;
+    }
+    return num;
+}
+
+//------------------------------------------------------------------------------
+bool
+JournalReplayer::readBlock() {
+    uint8 header[journalFormat::BlockHeaderSize];
+    const size_t headerSize = std::fread(header, 1, sizeof(header), this->fp);
+    if (headerSize != sizeof(header)) {
+        if (headerSize > 0) {
+            Log::Warn("JournalReplayer: ignoring truncated block at end of '%s'\n", this->path.AsCStr());
+        }
+        return false;
+    }
+    const uint8 codec = header[0];
+    const uint32 rawSize = journalFormat::Read32(header + 4);
+    const uint32 storedSize = journalFormat::Read32(header + 8);
+    const uint32 crc = journalFormat::Read32(header + 12);
+    // JournalPort never writes empty blocks
+    if ((codec >= Compression::NumCodes) || 
+        (0 == rawSize) || (0 == storedSize) ||
+        (rawSize > uint32(journalFormat::MaxBlockSize)) || 
+        (storedSize > uint32(journalFormat::MaxBlockSize)) ||
+        ((Compression::None == codec) && (storedSize != rawSize))) {
+        Log::Warn("JournalReplayer: corrupt block header in '%s'\n", this->path.AsCStr());
+        return false;
+    }
+    
+    if (int32(storedSize) > this->packCapacity) {
+        this->packBuf = (uint8*) Memory::ReAlloc(this->packBuf, int32(storedSize));
+        this->packCapacity = int32(storedSize);
+    }
+    if (std::fread(this->packBuf, 1, storedSize, this->fp) != storedSize) {
+        Log::Warn("JournalReplayer: ignoring truncated block at end of '%s'\n", this->path.AsCStr());
+        return false;
+    }
+    if (uint32(crc32(0, this->packBuf, uInt(storedSize))) != crc) {
+        Log::Warn("JournalReplayer: checksum mismatch in '%s'\n", this->path.AsCStr());
+        return false;
+    }
+    
+    if (int32(rawSize) > this->blockCapacity) {
+        this->blockBuf = (uint8*) Memory::ReAlloc(this->blockBuf, int32(rawSize));
+        this->blockCapacity = int32(rawSize);
+    }
+    if (!this->compressor.Decompress(Compression::Code(codec), this->packBuf, int32(storedSize), this->blockBuf, int32(rawSize))) {
+        Log::Warn("JournalReplayer: failed to decompress block in '%s'\n", this->path.AsCStr());
+        return false;
+    }
+    this->fileBytes += journalFormat::BlockHeaderSize + storedSize;
+    this->rawBytes += rawSize;
+    this->blockSize = int32(rawSize);
+    this->blockPos = 0;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool
+JournalReplayer::readRecord() {
+    this->pendingMsg = nullptr;
+    for (;;) {
+        while (this->blockPos >= this->blockSize) {
+            if (!this->readBlock()) {
+                // stop at the first broken block
+                this->blockSize = this->blockPos = 0;
+                std::fseek(this->fp, 0, SEEK_END);
+                return false;
+            }
+        }
+        const uint8* srcPtr = this->blockBuf + this->blockPos;
+        const uint8* maxPtr = this->blockBuf + this->blockSize;
+        uint64 timeDelta = 0;
+        uint64 msgId = 0;
+        uint64 bodySize = 0;
+        srcPtr = CompactSerializer::DecodeVarint(srcPtr, maxPtr, timeDelta);
+        srcPtr = CompactSerializer::DecodeVarint(srcPtr, maxPtr, msgId);
+        srcPtr = CompactSerializer::DecodeVarint(srcPtr, maxPtr, bodySize);
+        if ((nullptr == srcPtr) || (msgId >= uint64(this->msgIdMap.Size())) || (bodySize > uint64(maxPtr - srcPtr))) {
+            break;
+        }
+        const uint8* endPtr = srcPtr + bodySize;
+        this->pendingTime += Clock::Ticks(timeDelta);
+        this->blockPos = int32(endPtr - this->blockBuf);
+        const MessageIdType localId = this->msgIdMap[int32(msgId)];
+        if (InvalidMessageId == localId) {
+            // a message class this build doesn't know
+            continue;
+        }
+        Ptr<Message> msg = this->creator(localId);
+        if (msg->DecodeCompact(srcPtr, endPtr) != endPtr) {
+            break;
+        }
+        this->pendingMsg = msg;
+        return true;
+    }
+    Log::Warn("JournalReplayer: corrupt record in '%s'\n", this->path.AsCStr());
+    this->blockSize = this->blockPos = 0;
+    std::fseek(this->fp, 0, SEEK_END);
+    return false;
+}
+
+} // namespace Messaging
+} // namespace Oryol
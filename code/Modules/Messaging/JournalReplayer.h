@@ -0,0 +1,106 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Messaging::JournalReplayer
+    @brief feed messages recorded by a JournalPort back into a port
+    
+    The replayer reads a journal file written by a JournalPort, 
+    decodes the messages with the protocol's factory and puts them 
+    into a port, either as fast as possible, or with the recorded
+    timing:
+    
+        Ptr<JournalReplayer> replayer = JournalReplayer::Create();
+        replayer->Open<MyProtocol>("session.jrn");
+        replayer->Replay(dispatcher);        // as fast as possible
+        replayer->Replay(dispatcher, 1.0);   // at recorded speed
+    
+    Replay() blocks until the end of the journal, a game loop calls
+    ReplayUntil() once per frame instead, with the time since it
+    started the replay. Message times are relative to when the
+    journal was opened for recording. Open fails if the journal was 
+    recorded with a different protocol. Journals of builds with other
+    message classes can be replayed: recorded message ids are mapped
+    by their wire id (see Protocol::GetWireId()), messages of classes 
+    which this build doesn't know are skipped, and blocks are 
+    decompressed with the dictionary stored in the journal.
+*/
+#include "Messaging/Port.h"
+#include "Messaging/Compressor.h"
+#include "Core/String/String.h"
+#include "Core/Time/Clock.h"
+#include <stdio.h>
+
+namespace Oryol {
+namespace Messaging {
+    
+class JournalReplayer : public Core::RefCounted {
+    OryolClassDecl(JournalReplayer);
+public:
+    /// constructor
+    JournalReplayer();
+    /// destructor
+    virtual ~JournalReplayer();
+    
+    /// open a journal file with messages of PROTOCOL
+    template<class PROTOCOL> bool Open(const char* path);
+    /// close the journal file
+    void Close();
+    /// return true if the journal file is open
+    bool IsOpen() const;
+    /// return true if all messages have been read
+    bool AtEnd() const;
+    
+    /// read the next message and its recorded time, returns false at the end
+    bool Next(Core::Ptr<Message>& outMsg, Core::Clock::Ticks& outTime);
+    /// put all remaining messages into a port, speed 0 is as fast as possible
+    int64 Replay(const Core::Ptr<Port>& port, float64 speed = 0.0);
+    /// put the messages recorded up to a time into a port
+    int32 ReplayUntil(const Core::Ptr<Port>& port, Core::Clock::Ticks time);
+    
+    /// get the number of messages read
+    int64 GetNumMessages() const;
+    /// get the number of decompressed bytes read
+    int64 GetRawBytes() const;
+    /// get the number of bytes read from the file
+    int64 GetFileBytes() const;
+    /// get the time spent decompressing
+    Core::Clock::Ticks GetDecompressTime() const;
+    
+private:
+    typedef Message* (*createFunc)(MessageIdType);
+    typedef MessageIdType (*findFunc)(uint32);
+    
+    /// open the file and check the file header
+    bool open(const char* path, ProtocolIdType protocolId, findFunc finder);
+    /// read and decompress the next block
+    bool readBlock();
+    /// decode the next record into the pending message
+    bool readRecord();
+    
+    Core::String path;
+    FILE* fp;
+    createFunc creator;
+    Core::Array<MessageIdType> msgIdMap;
+    Compressor compressor;
+    uint8* blockBuf;
+    int32 blockCapacity;
+    int32 blockSize;
+    int32 blockPos;
+    uint8* packBuf;
+    int32 packCapacity;
+    Core::Ptr<Message> pendingMsg;
+    Core::Clock::Ticks pendingTime;
+    int64 numMessages;
+    int64 rawBytes;
+    int64 fileBytes;
+};
+
+//------------------------------------------------------------------------------
+template<class PROTOCOL> bool
+JournalReplayer::Open(const char* path_) {
+    this->creator = &PROTOCOL::Factory::Create;
+    return this->open(path_, PROTOCOL::GetProtocolId(), &PROTOCOL::FindMessageId);
+}
+
+} // namespace Messaging
+} // namespace Oryol
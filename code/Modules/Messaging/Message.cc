@@ -9,9 +9,18 @@ namespace Messaging {
     
 OryolClassImpl(Message);
 
+Message::handlerNode Message::handledMarker;
+
 //------------------------------------------------------------------------------
 Message::~Message() {
-    // empty
+    handlerNode* node = this->handlers;
+    if (&handledMarker != node) {
+        while (nullptr != node) {
+            handlerNode* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -24,6 +33,59 @@ Message::IsMemberOf(ProtocolIdType protId) const {
 void
 Message::SetHandled() {
     this->handled = true;
+    #if ORYOL_HAS_THREADS
+    handlerNode* node = this->handlers.exchange(&handledMarker, std::memory_order_acq_rel);
+    #else
+    handlerNode* node = this->handlers;
+    this->handlers = &handledMarker;
+    #endif
+    if (&handledMarker == node) {
+        return;
+    }
+    // the handler list is in reverse order of registration
+    handlerNode* reversed = nullptr;
+    while (nullptr != node) {
+        handlerNode* next = node->next;
+        node->next = reversed;
+        reversed = node;
+        node = next;
+    }
+    while (nullptr != reversed) {
+        handlerNode* next = reversed->next;
+        reversed->func();
+        delete reversed;
+        reversed = next;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+Message::OnHandled(std::function<void()> func) {
+    // push onto the handler list unless the message has already been
+    // handled, races with SetHandled() on another thread are resolved
+    // by the CAS
+    handlerNode* node = new handlerNode;
+    node->func = std::move(func);
+    #if ORYOL_HAS_THREADS
+    handlerNode* head = this->handlers.load(std::memory_order_acquire);
+    do {
+        if (&handledMarker == head) {
+            break;
+        }
+        node->next = head;
+    }
+    while (!this->handlers.compare_exchange_weak(head, node, std::memory_order_acq_rel, std::memory_order_acquire));
+    #else
+    handlerNode* head = this->handlers;
+    if (&handledMarker != head) {
+        node->next = head;
+        this->handlers = node;
+    }
+    #endif
+    if (&handledMarker == head) {
+        node->func();
+        delete node;
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -70,6 +132,38 @@ Message::Decode(const uint8* srcPtr, const uint8* maxValidPtr) {
     /// @todo: this should decode the header
     return srcPtr;
 }
+
+//------------------------------------------------------------------------------
+int32
+Message::CompactEncodedSize() const {
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+uint8*
+Message::EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const {
+    return dstPtr;
+}
+
+//------------------------------------------------------------------------------
+const uint8*
+Message::DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) {
+    return srcPtr;
+}
+
+//------------------------------------------------------------------------------
+/**
+ Decode the message from a range in a buffer, the generated Decode()
+ methods pick up the buffer for the view attributes.
+*/
+const uint8*
+Message::DecodeShared(const Core::Ptr<WireBuffer>& buf, const uint8* srcPtr, const uint8* maxValidPtr) {
+    o_assert(buf.isValid() && buf->Contains(srcPtr, maxValidPtr));
+    this->decodeBuffer = buf.get();
+    srcPtr = this->Decode(srcPtr, maxValidPtr);
+    this->decodeBuffer = nullptr;
+    return srcPtr;
+}
     
 } // namespace Messaging
 } // namespace Oryol
\ No newline at end of file
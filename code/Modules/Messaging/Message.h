@@ -3,14 +3,41 @@
 /**
     @class Oryol::Messaging::Message
     @brief base class for messages
+
+    OnHandled() registers a function which is called once when the
+    message has been handled, on the thread which calls SetHandled().
+    Several functions can be registered, they're called in order.
+    It's the building block for Messaging::Await(), which turns a
+    message into a Core::Task, and for request metrics.
+    
+    The priority decides in which order queued messages are handled
+    by a ThreadedQueue (higher priorities first). A message may also
+    have a deadline (an absolute Core::Clock time), a queue cancels
+    (SetCancelled()) a message which is still queued when its deadline
+    has passed, ports which check Cancelled() then skip the work.
+    Priority and deadline must be set before the message is put into
+    a port, and are not serialized. The default priority of a message
+    class can be set in the protocol XML file:
+    
+        <Message name="Prefetch" priority="Low"> ... </Message>
+    
+    DecodeShared() decodes a message from a refcounted WireBuffer,
+    string and array attributes which are marked as views in the 
+    protocol XML then reference the buffer instead of being copied
+    (see WireView).
 */
+#include <functional>
 #include "Core/Config.h"
 #include "Core/RefCounted.h"
+#include "Core/Time/Clock.h"
 #include "Messaging/Types.h"
+#include "Messaging/WireBuffer.h"
 
 namespace Oryol {
 namespace Messaging {
 
+class queueMonitor;
+
 class Message : public Core::RefCounted {
     OryolClassDecl(Message);
 public:
@@ -25,6 +52,8 @@ public:
     static MessageIdType ClassMessageId();
     /// get the object message id
     MessageIdType MessageId() const;
+    /// get the id of the protocol which defines the message class (non-virtual)
+    ProtocolIdType ProtocolId() const;
     /// set message to Handled state
     void SetHandled();
     /// cancel the message
@@ -35,6 +64,16 @@ public:
     bool Handled() const;
     /// return true if the message is in cancelled state
     bool Cancelled() const;
+    /// call func once when the message is handled (immediately if already handled)
+    void OnHandled(std::function<void()> func);
+    /// set the priority
+    void SetPriority(Priority::Code prio);
+    /// get the priority
+    Priority::Code GetPriority() const;
+    /// set a deadline (Core::Clock time), 0 means no deadline
+    void SetDeadline(Core::Clock::Ticks deadline);
+    /// get the deadline, 0 if no deadline
+    Core::Clock::Ticks GetDeadline() const;
     
     /// get the encoded size of the message
     virtual int32 EncodedSize() const;
@@ -42,23 +81,53 @@ public:
     virtual uint8* Encode(uint8* dstPtr, const uint8* maxValidPtr) const;
     /// decode the message from raw memory
     virtual const uint8* Decode(const uint8* srcPtr, const uint8* maxValidPtr);
+    /// decode the message from a range in a buffer, view attributes reference the buffer
+    const uint8* DecodeShared(const Core::Ptr<WireBuffer>& buf, const uint8* srcPtr, const uint8* maxValidPtr);
+    /// get the size of the compact encoding (see CompactSerializer)
+    virtual int32 CompactEncodedSize() const;
+    /// encode the message in the compact encoding
+    virtual uint8* EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const;
+    /// decode the message from the compact encoding
+    virtual const uint8* DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr);
 
 protected:
+    friend class queueMonitor;
+    /// a function registered with OnHandled()
+    struct handlerNode {
+        std::function<void()> func;
+        handlerNode* next = nullptr;
+    };
+    /// marks the handler list after the message has been handled
+    static handlerNode handledMarker;
+
     MessageIdType msgId;
+    ProtocolIdType protId;
+    Priority::Code priority;
+    Core::Clock::Ticks deadline;
+    Core::Clock::Ticks queueTime;   // when the message has been put into its current queue
+    WireBuffer* decodeBuffer;       // the source buffer during DecodeShared()
     #if ORYOL_HAS_THREADS
     std::atomic<bool> handled;
     std::atomic<bool> cancelled;
+    std::atomic<handlerNode*> handlers;
     #else
     bool handled;
     bool cancelled;
+    handlerNode* handlers;
     #endif
 };
 
 //------------------------------------------------------------------------------
 inline Message::Message() :
 msgId(InvalidMessageId),
+protId(InvalidProtocolId),
+priority(Priority::Normal),
+deadline(0),
+queueTime(0),
+decodeBuffer(nullptr),
 handled(false),
-cancelled(false) {
+cancelled(false),
+handlers(nullptr) {
     // empty
 }
 
@@ -68,5 +137,36 @@ Message::MessageId() const {
     return this->msgId;
 }
 
+//------------------------------------------------------------------------------
+inline ProtocolIdType
+Message::ProtocolId() const {
+    return this->protId;
+}
+
+//------------------------------------------------------------------------------
+inline void
+Message::SetPriority(Priority::Code prio) {
+    o_assert_dbg(prio < Priority::NumPriorities);
+    this->priority = prio;
+}
+
+//------------------------------------------------------------------------------
+inline Priority::Code
+Message::GetPriority() const {
+    return this->priority;
+}
+
+//------------------------------------------------------------------------------
+inline void
+Message::SetDeadline(Core::Clock::Ticks deadline_) {
+    this->deadline = deadline_;
+}
+
+//------------------------------------------------------------------------------
+inline Core::Clock::Ticks
+Message::GetDeadline() const {
+    return this->deadline;
+}
+
 } // namespace Messaging
 } // namespace Oryol
\ No newline at end of file
@@ -4,6 +4,35 @@
     @class Oryol::Messaging::Protocol
     
     Base message protocol, all other protocols are derived from this.
+    
+    Generated protocols provide cheap type checks which don't need
+    virtual calls or RTTI for messages of the protocol itself:
+    
+    - MessageId::FirstMessageId..NumMessageIds-1 is the id range of the
+      protocol's own messages, HasProtocol() checks if a protocol id is
+      the protocol or one of its parents
+    - each message class has a DerivedMask (bit n is set if the n-th
+      message of the protocol is the class or derived from it), and
+      IsA() which tests a message against the class with an integer
+      compare, and only falls back to dynamic_cast for messages of
+      other protocols
+    - GetWireId() returns the stable id of a message class which the
+      compact encoding uses instead of the message id (the hash of the
+      protocol id and class name, so it doesn't change when messages
+      are added to the protocol or its parents), FindMessageId() maps
+      it back to the message id, or InvalidMessageId if unknown
+    - Visit() calls visitor(const Ptr<MSG>&) with the concrete message
+      class from a switch over the message id, so handlers which are
+      known at compile time can be called directly (overloaded
+      operator(), a template operator() catches all other classes):
+    
+        struct handler {
+            void operator()(const Ptr<IOProtocol::Get>& msg) { ... };
+            template<class MSG> void operator()(const Ptr<MSG>& msg) { ... };
+        };
+        IOProtocol::Visit(msg, handler());
+    
+    MessageCast() is the IsA()-based replacement for Ptr::dynamicCast().
 */
 #include "Core/Types.h"
 #include "Messaging/Types.h"
@@ -18,11 +47,28 @@ public:
     static ProtocolIdType GetProtocolId() {
         return 'BASE';
     };
+    /// test if a protocol id is this protocol or one of its parents
+    static bool HasProtocol(ProtocolIdType protId) {
+        return false;
+    };
+    /// get the wire id of a message id (see CompactSerializer)
+    static uint32 GetWireId(MessageIdType id) {
+        return 0;
+    };
+    /// get the message id of a wire id, InvalidMessageId if unknown
+    static MessageIdType FindMessageId(uint32 wireId) {
+        return InvalidMessageId;
+    };
+    /// call visitor with the concrete message class
+    template<class VISITOR> static bool Visit(const Core::Ptr<Message>& msg, VISITOR&& visitor) {
+        return false;
+    };
 
     /// protocol message ids
     class MessageId {
     public:
         enum {
+            FirstMessageId = 0,
             NumMessageIds = 0,
         };
         
@@ -45,5 +91,18 @@ public:
     };
 };
 
+//------------------------------------------------------------------------------
+/**
+ Cast a message to a generated message class (or a parent class),
+ returns an invalid Ptr if the message isn't one.
+*/
+template<class MSG> Core::Ptr<MSG>
+MessageCast(const Core::Ptr<Message>& msg) {
+    if (msg.isValid() && MSG::IsA(msg.get())) {
+        return Core::Ptr<MSG>(static_cast<MSG*>(msg.get()));
+    }
+    return Core::Ptr<MSG>();
+}
+
 } // namespace Messaging
 } // namespace Oryol
@@ -0,0 +1,47 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Messaging::QueueStats
+    @brief runtime statistics of a message queue port
+    
+    A snapshot of the counters of a queue port (see ThreadedQueue::GetStats()
+    and AsyncQueue::GetStats()), can be taken from any thread. The
+    depth is the number of messages which have been put but not yet
+    forwarded (or dropped), the latency is the time between Put() and
+    the message being forwarded. A queue which has messages queued but
+    hasn't forwarded anything for a long time (see LastDequeueTime) is
+    stalled.
+*/
+#include "Core/Types.h"
+#include "Core/Time/Clock.h"
+
+namespace Oryol {
+namespace Messaging {
+
+struct QueueStats {
+    /// max number of queued messages, 0 if unbounded
+    int32 Capacity = 0;
+    /// current number of queued messages
+    int32 Depth = 0;
+    /// max number of queued messages so far
+    int32 HighWater = 0;
+    /// number of messages put into the queue
+    int64 NumEnqueued = 0;
+    /// number of messages forwarded
+    int64 NumDequeued = 0;
+    /// number of Put() calls rejected because the queue was full
+    int64 NumRejected = 0;
+    /// number of messages dropped because the queue was full
+    int64 NumDropped = 0;
+    /// number of Put() calls which had to wait because the queue was full
+    int64 NumBlocked = 0;
+    /// average latency of forwarded messages
+    Core::Clock::Ticks AvgLatency = 0;
+    /// max latency of forwarded messages
+    Core::Clock::Ticks MaxLatency = 0;
+    /// time of the last forwarded message, 0 if none
+    Core::Clock::Ticks LastDequeueTime = 0;
+};
+
+} // namespace Messaging
+} // namespace Oryol
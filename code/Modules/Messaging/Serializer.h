@@ -7,11 +7,21 @@
     This is a simple template class which knows how to 
     encode/decode a specific data type (the template arg) to and from
     a plain-old-data memory region.
+    
+    Arrays of POD types are encoded with a single memcpy (the encoding
+    is the same as element by element), so a POD type must not have a
+    specialized Serializer if it's used in an array.
+    
+    WireViews are encoded like arrays (and strings for WireView<char>),
+    DecodeView() can make the view reference the source buffer
+    instead of copying.
 */
 #include <string.h>
+#include <type_traits>
 #include "Core/Types.h"
 #include "Core/String/String.h"
 #include "Core/String/StringAtom.h"
+#include "Messaging/WireView.h"
 
 namespace Oryol {
 namespace Messaging {
@@ -30,6 +40,22 @@ public:
     template<typename TYPE> static uint8* EncodeArray(const Core::Array<TYPE>& vals, uint8* dstPtr, const uint8* maxPtr);
     /// decode an array of values
     template<typename TYPE> static const uint8* DecodeArray(const uint8* srcPtr, const uint8* maxPtr, Core::Array<TYPE>& outVals);
+    /// return the encoded size of a view
+    template<typename TYPE> static int32 EncodedViewSize(const WireView<TYPE>& view);
+    /// encode a view
+    template<typename TYPE> static uint8* EncodeView(const WireView<TYPE>& view, uint8* dstPtr, const uint8* maxPtr);
+    /// decode a view, references buf if not null (and the elements are aligned), otherwise copies
+    template<typename TYPE> static const uint8* DecodeView(const uint8* srcPtr, const uint8* maxPtr, WireBuffer* buf, WireView<TYPE>& outView);
+
+private:
+    /// encode array elements one by one
+    template<typename TYPE> static uint8* encodeElements(const Core::Array<TYPE>& vals, uint8* dstPtr, const uint8* maxPtr, std::false_type);
+    /// encode POD array elements with one copy
+    template<typename TYPE> static uint8* encodeElements(const Core::Array<TYPE>& vals, uint8* dstPtr, const uint8* maxPtr, std::true_type);
+    /// decode array elements one by one
+    template<typename TYPE> static const uint8* decodeElements(const uint8* srcPtr, const uint8* maxPtr, int32 num, Core::Array<TYPE>& outVals, std::false_type);
+    /// decode POD array elements with one copy
+    template<typename TYPE> static const uint8* decodeElements(const uint8* srcPtr, const uint8* maxPtr, int32 num, Core::Array<TYPE>& outVals, std::true_type);
 };
 
 //------------------------------------------------------------------------------
@@ -155,7 +181,10 @@ Serializer::Decode(const uint8* srcPtr, const uint8* maxPtr, Core::StringAtom& o
 //------------------------------------------------------------------------------
 template<typename TYPE> inline int32
 Serializer::EncodedArraySize(const Core::Array<TYPE>& vals) {
-    if (vals.Size() > 0) {
+    if (std::is_pod<TYPE>::value) {
+        return sizeof(int32) + vals.Size() * sizeof(TYPE);
+    }
+    else if (vals.Size() > 0) {
         int32 size = sizeof(int32);
         for (const TYPE& val : vals) {
             size += Serializer::EncodedSize<TYPE>(val);
@@ -176,10 +205,7 @@ Serializer::EncodeArray(const Core::Array<TYPE>& vals, uint8* dstPtr, const uint
         const int32 numElements = vals.Size();
         dstPtr = Serializer::Encode<int32>(numElements, dstPtr, maxPtr);
         if (numElements > 0) {
-            for (const TYPE& val : vals) {
-                dstPtr = Serializer::Encode<TYPE>(val, dstPtr, maxPtr);
-                o_assert(nullptr != dstPtr);
-            }
+            dstPtr = encodeElements<TYPE>(vals, dstPtr, maxPtr, typename std::is_pod<TYPE>::type());
         }
         // success
         return dstPtr;
@@ -187,34 +213,133 @@ Serializer::EncodeArray(const Core::Array<TYPE>& vals, uint8* dstPtr, const uint
     // fallthrough: not enough space
     return nullptr;
 }
+
+//------------------------------------------------------------------------------
+template<typename TYPE> inline uint8*
+Serializer::encodeElements(const Core::Array<TYPE>& vals, uint8* dstPtr, const uint8* maxPtr, std::false_type) {
+    for (const TYPE& val : vals) {
+        dstPtr = Serializer::Encode<TYPE>(val, dstPtr, maxPtr);
+        o_assert(nullptr != dstPtr);
+    }
+    return dstPtr;
+}
+
+//------------------------------------------------------------------------------
+template<typename TYPE> inline uint8*
+Serializer::encodeElements(const Core::Array<TYPE>& vals, uint8* dstPtr, const uint8* maxPtr, std::true_type) {
+    // array elements are contiguous, space has already been checked
+    const int32 numBytes = vals.Size() * sizeof(TYPE);
+    memcpy(dstPtr, &vals[0], numBytes);
+    return dstPtr + numBytes;
+}
     
 //------------------------------------------------------------------------------
 template<typename TYPE> inline const uint8*
 Serializer::DecodeArray(const uint8* srcPtr, const uint8* maxPtr, Core::Array<TYPE>& outVals) {
-    o_assert(outVals.Size() == 0);
-    if ((srcPtr + sizeof(int32)) < maxPtr) {
+    // decoding replaces the content (e.g. when a message object is reused)
+    outVals.Clear();
+    if ((srcPtr + sizeof(int32)) <= maxPtr) {
         // read number of elements
         int32 numElements = 0;
         srcPtr = Serializer::Decode<int32>(srcPtr, maxPtr, numElements);
         if (numElements > 0) {
-            outVals.Reserve(numElements);
-            for (int32 i = 0; i < numElements; i++) {
-                TYPE val;
-                srcPtr = Serializer::Decode<TYPE>(srcPtr, maxPtr, val);
-                if (nullptr == srcPtr) {
-                    // not enough data
-                    outVals.Clear();
-                    return nullptr;
-                }
-                outVals.AddBack(val);
-            }
+            srcPtr = decodeElements<TYPE>(srcPtr, maxPtr, numElements, outVals, typename std::is_pod<TYPE>::type());
         }
-        // success
         return srcPtr;
     }
     // fallthrough not enough data
     return nullptr;
 }
 
+//------------------------------------------------------------------------------
+template<typename TYPE> inline const uint8*
+Serializer::decodeElements(const uint8* srcPtr, const uint8* maxPtr, int32 num, Core::Array<TYPE>& outVals, std::false_type) {
+    outVals.Reserve(num);
+    for (int32 i = 0; i < num; i++) {
+        TYPE val;
+        srcPtr = Serializer::Decode<TYPE>(srcPtr, maxPtr, val);
+        if (nullptr == srcPtr) {
+            // not enough data
+            outVals.Clear();
+            return nullptr;
+        }
+        outVals.AddBack(val);
+    }
+    return srcPtr;
+}
+
+//------------------------------------------------------------------------------
+template<typename TYPE> inline const uint8*
+Serializer::decodeElements(const uint8* srcPtr, const uint8* maxPtr, int32 num, Core::Array<TYPE>& outVals, std::true_type) {
+    // check in 64 bits, a bogus element count must not wrap around
+    if (int64(maxPtr - srcPtr) < int64(num) * int64(sizeof(TYPE))) {
+        // not enough data
+        return nullptr;
+    }
+    const int32 numBytes = num * sizeof(TYPE);
+    if (0 == (uintptr_t(srcPtr) % std::alignment_of<TYPE>::value)) {
+        outVals.AddBack((const TYPE*) srcPtr, num);
+    }
+    else {
+        // unaligned source, must copy byte-wise
+        outVals.Reserve(num);
+        for (int32 i = 0; i < num; i++) {
+            TYPE val;
+            memcpy(&val, srcPtr + i * sizeof(TYPE), sizeof(TYPE));
+            outVals.AddBack(val);
+        }
+    }
+    return srcPtr + numBytes;
+}
+
+//------------------------------------------------------------------------------
+template<typename TYPE> inline int32
+Serializer::EncodedViewSize(const WireView<TYPE>& view) {
+    return sizeof(int32) + view.Size() * sizeof(TYPE);
+}
+
+//------------------------------------------------------------------------------
+template<typename TYPE> inline uint8*
+Serializer::EncodeView(const WireView<TYPE>& view, uint8* dstPtr, const uint8* maxPtr) {
+    if ((dstPtr + EncodedViewSize<TYPE>(view)) <= maxPtr) {
+        const int32 numBytes = view.Size() * sizeof(TYPE);
+        dstPtr = Serializer::Encode<int32>(view.Size(), dstPtr, maxPtr);
+        if (numBytes > 0) {
+            memcpy(dstPtr, view.begin(), numBytes);
+        }
+        return dstPtr + numBytes;
+    }
+    // fallthrough: not enough space
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+template<typename TYPE> inline const uint8*
+Serializer::DecodeView(const uint8* srcPtr, const uint8* maxPtr, WireBuffer* buf, WireView<TYPE>& outView) {
+    if ((nullptr != srcPtr) && ((srcPtr + sizeof(int32)) <= maxPtr)) {
+        // read number of elements
+        int32 num = 0;
+        srcPtr = Serializer::Decode<int32>(srcPtr, maxPtr, num);
+        if ((num >= 0) && (int64(maxPtr - srcPtr) >= int64(num) * int64(sizeof(TYPE)))) {
+            const int32 numBytes = num * sizeof(TYPE);
+            if (0 == num) {
+                outView = WireView<TYPE>();
+            }
+            else if ((nullptr != buf) && (0 == (uintptr_t(srcPtr) % std::alignment_of<TYPE>::value))) {
+                // reference the elements in the source buffer
+                outView = WireView<TYPE>(Core::Ptr<WireBuffer>(buf), (const TYPE*) srcPtr, num);
+            }
+            else {
+                // no source buffer, or unaligned elements, must copy
+                Core::Ptr<WireBuffer> copy = WireBuffer::Create(srcPtr, numBytes);
+                outView = WireView<TYPE>(copy, (const TYPE*) copy->Data(), num);
+            }
+            return srcPtr + numBytes;
+        }
+    }
+    // fallthrough: not enough data
+    return nullptr;
+}
+
 } // namespace Messagin
 } // namespace Oryol
\ No newline at end of file
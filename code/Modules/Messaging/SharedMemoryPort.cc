@@ -0,0 +1,320 @@
+//------------------------------------------------------------------------------
+//  SharedMemoryPort.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "SharedMemoryPort.h"
+#include "Messaging/shmRing.h"
+#include "Core/Log.h"
+#include "Core/String/StringBuilder.h"
+// POSIX shared memory is only available on desktop platforms
+#define ORYOL_HAS_SHARED_MEMORY (ORYOL_LINUX || ORYOL_MACOS)
+#if ORYOL_HAS_SHARED_MEMORY
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace Oryol {
+namespace Messaging {
+
+OryolClassImpl(SharedMemoryPort);
+
+using namespace Core;
+
+namespace {
+    // how often a blocked sender checks if the receiver is still alive
+    const Clock::Ticks aliveCheckInterval = Clock::TicksPerSecond / 10;
+
+    #if ORYOL_HAS_SHARED_MEMORY
+    // how long the attaching side waits for the creating side
+    const Clock::Ticks setupTimeout = Clock::TicksPerSecond;
+
+    // POSIX shared memory names start with a slash
+    String shmPath(const char* name) {
+        if ('/' == name[0]) {
+            return String(name);
+        }
+        StringBuilder builder;
+        builder.Append('/');
+        builder.Append(name);
+        return builder.GetString();
+    }
+
+    // test if a process exists
+    bool processAlive(int32 pid) {
+        return (0 == kill(pid_t(pid), 0)) || (EPERM == errno);
+    }
+    #endif
+}
+
+//------------------------------------------------------------------------------
+SharedMemoryPort::SharedMemoryPort() :
+ring(nullptr),
+mappedSize(0),
+sender(false),
+overflow(Overflow::Block),
+encoder(nullptr),
+decoder(nullptr),
+numMessages(0) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+SharedMemoryPort::~SharedMemoryPort() {
+    this->Close();
+}
+
+//------------------------------------------------------------------------------
+bool
+SharedMemoryPort::open(const char* name_, int32 capacity, ProtocolIdType protocolId, bool asSender) {
+    o_assert(nullptr != name_);
+    o_assert(!this->IsOpen());
+    #if ORYOL_HAS_SHARED_MEMORY
+    this->name = shmPath(name_);
+    const char* shmName = this->name.AsCStr();
+    
+    // whichever side comes first creates the segment
+    bool created = true;
+    int fd = shm_open(shmName, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if ((fd < 0) && (EEXIST == errno)) {
+        created = false;
+        fd = shm_open(shmName, O_RDWR, 0600);
+    }
+    if (fd < 0) {
+        Log::Warn("SharedMemoryPort: failed to open '%s' (%s)\n", shmName, strerror(errno));
+        return false;
+    }
+    int32 size = 0;
+    if (created) {
+        size = shmRing::segmentSize(capacity);
+        if (0 != ftruncate(fd, size)) {
+            Log::Warn("SharedMemoryPort: failed to resize '%s' (%s)\n", shmName, strerror(errno));
+            close(fd);
+            shm_unlink(shmName);
+            return false;
+        }
+    }
+    else {
+        // the capacity is defined by the creating side, which may not have resized yet
+        const Clock::Ticks start = Clock::Now();
+        struct stat st;
+        while ((0 == fstat(fd, &st)) && (0 == st.st_size) && (Clock::Since(start) < setupTimeout)) {
+            usleep(1000);
+        }
+        size = int32(st.st_size);
+    }
+    void* ptr = (size > 0) ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (MAP_FAILED == ptr) {
+        Log::Warn("SharedMemoryPort: failed to map '%s'\n", shmName);
+        if (created) {
+            shm_unlink(shmName);
+        }
+        return false;
+    }
+    this->ring = (shmRing*) ptr;
+    this->mappedSize = size;
+    
+    // set up or validate the ring buffer
+    if (created) {
+        this->ring->setup(capacity, protocolId);
+    }
+    else if (!this->ring->waitReady(setupTimeout) ||
+             (shmRing::Magic != this->ring->magic) ||
+             (shmRing::Version != this->ring->version) ||
+             (shmRing::segmentSize(this->ring->capacity) != size)) {
+        Log::Warn("SharedMemoryPort: '%s' is not a valid message port\n", shmName);
+        munmap(this->ring, size);
+        this->ring = nullptr;
+        return false;
+    }
+    else if (this->ring->protocolId != protocolId) {
+        Log::Warn("SharedMemoryPort: '%s' has a different protocol\n", shmName);
+        munmap(this->ring, size);
+        this->ring = nullptr;
+        return false;
+    }
+    
+    // claim the sender or receiver role, take over from a dead process
+    std::atomic<int32>& slot = asSender ? this->ring->senderPid : this->ring->receiverPid;
+    const int32 pid = int32(getpid());
+    int32 cur = slot.load(std::memory_order_acquire);
+    for (;;) {
+        if ((0 != cur) && processAlive(cur)) {
+            Log::Warn("SharedMemoryPort: '%s' already has a %s\n", shmName, asSender ? "sender" : "receiver");
+            munmap(this->ring, size);
+            this->ring = nullptr;
+            return false;
+        }
+        if (slot.compare_exchange_weak(cur, pid, std::memory_order_acq_rel)) {
+            break;
+        }
+    }
+    if (0 != cur) {
+        // inherit the dead process' attachment, it never detached
+        if (asSender) {
+            // a dead sender may have left an unpublished record
+            this->ring->resetProducer();
+        }
+    }
+    else {
+        this->ring->numAttached.fetch_add(1, std::memory_order_acq_rel);
+    }
+    this->sender = asSender;
+    this->numMessages = 0;
+    return true;
+    #else
+    Log::Warn("SharedMemoryPort: shared memory is not supported on this platform\n");
+    return false;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+SharedMemoryPort::Close() {
+    #if ORYOL_HAS_SHARED_MEMORY
+    if (nullptr != this->ring) {
+        std::atomic<int32>& slot = this->sender ? this->ring->senderPid : this->ring->receiverPid;
+        slot.store(0, std::memory_order_release);
+        if (1 == this->ring->numAttached.fetch_sub(1, std::memory_order_acq_rel)) {
+            shm_unlink(this->name.AsCStr());
+        }
+        munmap(this->ring, this->mappedSize);
+        this->ring = nullptr;
+        this->mappedSize = 0;
+    }
+    #endif
+    this->forwardingPort = nullptr;
+    this->encoder = nullptr;
+    this->decoder = nullptr;
+}
+
+//------------------------------------------------------------------------------
+void
+SharedMemoryPort::Unlink(const char* name_) {
+    o_assert(nullptr != name_);
+    #if ORYOL_HAS_SHARED_MEMORY
+    shm_unlink(shmPath(name_).AsCStr());
+    #endif
+}
+
+//------------------------------------------------------------------------------
+bool
+SharedMemoryPort::IsOpen() const {
+    return nullptr != this->ring;
+}
+
+//------------------------------------------------------------------------------
+bool
+SharedMemoryPort::IsSender() const {
+    return this->sender;
+}
+
+//------------------------------------------------------------------------------
+void
+SharedMemoryPort::SetOverflow(Overflow::Code overflow_) {
+    o_assert((Overflow::Block == overflow_) || (Overflow::Reject == overflow_));
+    this->overflow = overflow_;
+}
+
+//------------------------------------------------------------------------------
+Overflow::Code
+SharedMemoryPort::GetOverflow() const {
+    return this->overflow;
+}
+
+//------------------------------------------------------------------------------
+int32
+SharedMemoryPort::GetMaxMessageSize() const {
+    o_assert(this->IsOpen());
+    return this->ring->maxRecordSize();
+}
+
+//------------------------------------------------------------------------------
+int64
+SharedMemoryPort::GetNumMessages() const {
+    return this->numMessages;
+}
+
+//------------------------------------------------------------------------------
+bool
+SharedMemoryPort::peerAlive() const {
+    #if ORYOL_HAS_SHARED_MEMORY
+    const int32 pid = (this->sender ? this->ring->receiverPid : this->ring->senderPid).load(std::memory_order_acquire);
+    return (0 != pid) && processAlive(pid);
+    #else
+    return false;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+bool
+SharedMemoryPort::Put(const Ptr<Message>& msg) {
+    o_assert(this->IsOpen() && this->sender);
+    const int32 size = CompactSerializer::EncodedMessageSize(msg);
+    if (size > this->ring->maxRecordSize()) {
+        Log::Warn("SharedMemoryPort: message too big (%d bytes)\n", size);
+        return false;
+    }
+    uint8* dstPtr = this->ring->beginPush(size);
+    while (nullptr == dstPtr) {
+        if (Overflow::Reject == this->overflow) {
+            return false;
+        }
+        if (!this->ring->waitForSpace(size, aliveCheckInterval) && !this->peerAlive()) {
+            Log::Warn("SharedMemoryPort: receiver of '%s' is gone\n", this->name.AsCStr());
+            return false;
+        }
+        dstPtr = this->ring->beginPush(size);
+    }
+    uint8* endPtr = this->encoder(msg, dstPtr, dstPtr + size);
+    if (nullptr == endPtr) {
+        // don't publish a half-written record
+        this->ring->resetProducer();
+        Log::Warn("SharedMemoryPort: failed to encode message for '%s'\n", this->name.AsCStr());
+        return false;
+    }
+    o_assert_dbg(endPtr == dstPtr + size);
+    this->ring->endPush();
+    this->numMessages++;
+    msg->SetHandled();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+SharedMemoryPort::DoWork() {
+    if ((nullptr == this->ring) || this->sender) {
+        return;
+    }
+    int32 size = 0;
+    const uint8* srcPtr = nullptr;
+    while (nullptr != (srcPtr = this->ring->front(size))) {
+        Ptr<Message> msg;
+        const bool valid = nullptr != this->decoder(srcPtr, srcPtr + size, msg);
+        // the message is a copy, free the space before handling it
+        this->ring->pop();
+        if (valid && msg) {
+            this->numMessages++;
+            this->forwardingPort->Put(msg);
+        }
+        else {
+            Log::Warn("SharedMemoryPort: dropped invalid message on '%s'\n", this->name.AsCStr());
+        }
+    }
+    this->forwardingPort->DoWork();
+}
+
+//------------------------------------------------------------------------------
+bool
+SharedMemoryPort::WaitForMessages(Clock::Ticks timeout) {
+    o_assert(this->IsOpen() && !this->sender);
+    return this->ring->waitForData(timeout);
+}
+
+} // namespace Messaging
+} // namespace Oryol
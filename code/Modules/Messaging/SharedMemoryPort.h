@@ -0,0 +1,135 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Messaging::SharedMemoryPort
+    @brief send messages to another process through shared memory
+    
+    A pair of SharedMemoryPorts connects two processes on the same
+    machine through a lock-free single-producer/single-consumer ring 
+    buffer in a named POSIX shared memory segment. The sending side
+    encodes messages into the ring buffer in Put(), the receiving side
+    decodes them in DoWork() and forwards them to a local port 
+    (usually a Dispatcher):
+    
+        // process A
+        Ptr<SharedMemoryPort> tx = SharedMemoryPort::Create();
+        tx->OpenSender<MyProtocol>("mygame.tools");
+        tx->Put(msg);
+    
+        // process B
+        Ptr<SharedMemoryPort> rx = SharedMemoryPort::Create();
+        rx->OpenReceiver<MyProtocol>("mygame.tools", dispatcher);
+        ...
+        rx->DoWork();
+    
+    Whichever side opens first creates the segment, the last one to
+    close removes it. Messages are sent in the compact encoding 
+    (see CompactSerializer), so the two processes may be different
+    builds which have added message classes or attributes to the 
+    protocol, Open fails if the protocol is different. A message is handled as soon as it has been put into
+    the ring buffer, there are no responses (open a second pair of 
+    ports in the other direction for replies).
+    
+    DoWork() never blocks, a helper process which has nothing else
+    to do waits with WaitForMessages(). If the ring buffer is full,
+    Put() waits for the receiver (Overflow::Block, the default) or
+    returns false (Overflow::Reject), see SetOverflow(). A blocked
+    sender gives up if the receiving process has died.
+    
+    Each side only calls into the kernel to wake up the other side if
+    it is actually waiting (a futex on Linux, on OSX a waiting side 
+    polls). Shared memory is only supported on Linux and OSX, Open 
+    fails on other platforms.
+    
+    A process which crashed leaves the segment behind, a port of a
+    new process takes over the role of the dead process, call Unlink()
+    at startup to start with an empty ring buffer instead.
+*/
+#include "Messaging/Port.h"
+#include "Messaging/CompactSerializer.h"
+#include "Core/String/String.h"
+#include "Core/Time/Clock.h"
+
+namespace Oryol {
+namespace Messaging {
+
+class shmRing;
+
+class SharedMemoryPort : public Port {
+    OryolClassDecl(SharedMemoryPort);
+public:
+    /// default size of the ring buffer in bytes
+    static const int32 DefaultCapacity = 1 << 20;
+
+    /// constructor
+    SharedMemoryPort();
+    /// destructor
+    virtual ~SharedMemoryPort();
+    
+    /// open the sending side for messages of PROTOCOL
+    template<class PROTOCOL> bool OpenSender(const char* name, int32 capacity = DefaultCapacity);
+    /// open the receiving side, decoded messages are forwarded to forwardingPort
+    template<class PROTOCOL> bool OpenReceiver(const char* name, const Core::Ptr<Port>& forwardingPort, int32 capacity = DefaultCapacity);
+    /// close the port (removes the shared memory if the other side is closed)
+    void Close();
+    /// return true if the port is open
+    bool IsOpen() const;
+    /// return true if this is the sending side
+    bool IsSender() const;
+    /// remove a shared memory segment left behind by a crashed process
+    static void Unlink(const char* name);
+    
+    /// set what Put() does when the ring buffer is full (Block or Reject)
+    void SetOverflow(Overflow::Code overflow);
+    /// get the overflow policy
+    Overflow::Code GetOverflow() const;
+    /// get the max encoded size of a message
+    int32 GetMaxMessageSize() const;
+    /// get number of messages sent or received
+    int64 GetNumMessages() const;
+    
+    /// sending side: encode the message into the ring buffer
+    virtual bool Put(const Core::Ptr<Message>& msg) override;
+    /// receiving side: forward received messages (doesn't block)
+    virtual void DoWork() override;
+    /// receiving side: wait until messages arrive, returns false on timeout
+    bool WaitForMessages(Core::Clock::Ticks timeout);
+    
+private:
+    typedef uint8* (*encodeFunc)(const Core::Ptr<Message>&, uint8*, const uint8*);
+    typedef const uint8* (*decodeFunc)(const uint8*, const uint8*, Core::Ptr<Message>&);
+
+    /// open or create the shared memory segment
+    bool open(const char* name, int32 capacity, ProtocolIdType protocolId, bool asSender);
+    /// test if the process on the other side is alive
+    bool peerAlive() const;
+    
+    Core::String name;
+    shmRing* ring;
+    int32 mappedSize;
+    bool sender;
+    Overflow::Code overflow;
+    encodeFunc encoder;
+    decodeFunc decoder;
+    Core::Ptr<Port> forwardingPort;
+    int64 numMessages;
+};
+
+//------------------------------------------------------------------------------
+template<class PROTOCOL> bool
+SharedMemoryPort::OpenSender(const char* name_, int32 capacity) {
+    this->encoder = &CompactSerializer::EncodeMessage<PROTOCOL>;
+    return this->open(name_, capacity, PROTOCOL::GetProtocolId(), true);
+}
+
+//------------------------------------------------------------------------------
+template<class PROTOCOL> bool
+SharedMemoryPort::OpenReceiver(const char* name_, const Core::Ptr<Port>& forwardingPort_, int32 capacity) {
+    o_assert(forwardingPort_);
+    this->decoder = &CompactSerializer::DecodeMessage<PROTOCOL>;
+    this->forwardingPort = forwardingPort_;
+    return this->open(name_, capacity, PROTOCOL::GetProtocolId(), false);
+}
+
+} // namespace Messaging
+} // namespace Oryol
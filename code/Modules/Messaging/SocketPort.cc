@@ -0,0 +1,844 @@
+//------------------------------------------------------------------------------
+//  SocketPort.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "SocketPort.h"
+#include "Core/CoreFacade.h"
+#include "Core/Log.h"
+#include "Core/Profiler.h"
+#include "Core/Memory/Memory.h"
+#include <utility>
+#if ORYOL_LINUX
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#endif
+
+namespace Oryol {
+namespace Messaging {
+
+OryolClassImpl(SocketPort);
+
+using namespace Core;
+
+namespace {
+    // size of the chunks which frames are encoded into
+    const int32 chunkSize = 64 * 1024;
+    // max number of unused chunks which are kept around
+    const int32 maxFreeChunks = 4;
+    // max number of chunks in one write call
+    const int32 maxWriteChunks = 64;
+    // initial size of the read buffer
+    const int32 readBufferSize = 256 * 1024;
+    // size of the frame header
+    const int32 frameHeaderSize = 4;
+    // frames bigger than this are a protocol error
+    const int32 maxFrameSize = 64 * 1024 * 1024;
+    // a compressed packet has an 8-byte header, the packed size with the 
+    // packet flag and the codec, and the size of the frames in the packet
+    const int32 packetHeaderSize = 8;
+    const uint32 packetFlag = 0x80000000;
+    const int32 packetCodecShift = 28;
+    const uint32 packetSizeMask = 0x0FFFFFFF;
+    // the IO thread stops reading when this many messages or bytes are waiting for DoWork()
+    const int32 maxInboxMessages = 8192;
+    const int32 maxInboxBytes = 4 * 1024 * 1024;
+    // how long Close() tries to send queued messages
+    const Clock::Ticks flushTimeout = Clock::TicksPerSecond;
+}
+
+//------------------------------------------------------------------------------
+SocketPort::SocketPort() :
+listening(false),
+listenFd(-1),
+sockFd(-1),
+epollFd(-1),
+wakeFd(-1),
+encoder(nullptr),
+decoder(nullptr),
+overflow(Overflow::Block),
+maxQueuedBytes(DefaultMaxQueuedBytes),
+stopRequested(false),
+connected(false),
+queuedBytes(0),
+writePending(false),
+writeOffset(0),
+writable(true),
+readEnabled(true),
+inboxBytes(0),
+readPaused(false),
+readBuf(nullptr),
+readCapacity(0),
+readSize(0),
+unpackBuf(nullptr),
+unpackCapacity(0),
+numSent(0),
+numReceived(0),
+numWrites(0),
+numReads(0),
+bytesSent(0),
+bytesReceived(0),
+rawBytesSent(0),
+rawBytesReceived(0),
+compressTime(0),
+decompressTime(0) {
+    this->compressor.Setup(Compression::None, Compressor::DefaultLevel, true);
+}
+
+//------------------------------------------------------------------------------
+SocketPort::~SocketPort() {
+    this->Close();
+}
+
+//------------------------------------------------------------------------------
+bool
+SocketPort::open(const char* path_, bool listen) {
+    o_assert(nullptr != path_);
+    o_assert(!this->IsOpen());
+    #if ORYOL_LINUX
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path_) >= sizeof(addr.sun_path)) {
+        Log::Warn("SocketPort: socket path too long '%s'\n", path_);
+        return false;
+    }
+    strcpy(addr.sun_path, path_);
+    
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        Log::Warn("SocketPort: failed to create socket (%s)\n", strerror(errno));
+        return false;
+    }
+    if (listen) {
+        // remove a socket file left behind by an earlier run
+        unlink(path_);
+        if ((0 != bind(fd, (struct sockaddr*) &addr, sizeof(addr))) || (0 != ::listen(fd, 4))) {
+            Log::Warn("SocketPort: failed to listen on '%s' (%s)\n", path_, strerror(errno));
+            close(fd);
+            return false;
+        }
+        this->listenFd = fd;
+    }
+    else {
+        // connecting a Unix domain socket doesn't block unless the backlog is full
+        int res;
+        while ((0 != (res = connect(fd, (struct sockaddr*) &addr, sizeof(addr)))) && (EINTR == errno)) { }
+        if (0 != res) {
+            Log::Warn("SocketPort: failed to connect to '%s' (%s)\n", path_, strerror(errno));
+            close(fd);
+            return false;
+        }
+        this->sockFd = fd;
+        this->connected = true;
+    }
+    
+    this->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    this->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = this->wakeFd;
+    epoll_ctl(this->epollFd, EPOLL_CTL_ADD, this->wakeFd, &ev);
+    ev.data.fd = fd;
+    ev.events = listen ? EPOLLIN : (EPOLLIN | EPOLLRDHUP);
+    epoll_ctl(this->epollFd, EPOLL_CTL_ADD, fd, &ev);
+    
+    this->path = path_;
+    this->listening = listen;
+    this->readCapacity = readBufferSize;
+    this->readBuf = (uint8*) Memory::Alloc(this->readCapacity);
+    this->readSize = 0;
+    this->stopRequested = false;
+    this->thread = std::thread(threadFunc, this);
+    return true;
+    #else
+    Log::Warn("SocketPort: Unix domain sockets are not supported on this platform\n");
+    return false;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+SocketPort::Close() {
+    if (!this->IsOpen()) {
+        return;
+    }
+    #if ORYOL_LINUX
+    this->stopRequested = true;
+    this->wakeThread();
+    this->thread.join();
+    if (this->sockFd >= 0) {
+        close(this->sockFd);
+        this->sockFd = -1;
+    }
+    if (this->listenFd >= 0) {
+        close(this->listenFd);
+        this->listenFd = -1;
+        unlink(this->path.AsCStr());
+    }
+    close(this->epollFd);
+    close(this->wakeFd);
+    this->epollFd = -1;
+    this->wakeFd = -1;
+    #endif
+    this->connected = false;
+    for (chunk& c : this->writing) {
+        Memory::Free(c.data);
+    }
+    for (chunk& c : this->outChunks) {
+        Memory::Free(c.data);
+    }
+    for (chunk& c : this->freeChunks) {
+        Memory::Free(c.data);
+    }
+    this->writing.Clear();
+    this->outChunks.Clear();
+    this->freeChunks.Clear();
+    this->queuedBytes = 0;
+    this->writePending = false;
+    this->writeOffset = 0;
+    Memory::Free(this->readBuf);
+    this->readBuf = nullptr;
+    this->readCapacity = 0;
+    this->readSize = 0;
+    if (nullptr != this->unpackBuf) {
+        Memory::Free(this->unpackBuf);
+        this->unpackBuf = nullptr;
+        this->unpackCapacity = 0;
+    }
+    this->inbox.Clear();
+    this->received.Clear();
+    this->inboxBytes = 0;
+    this->readPaused = false;
+    this->readEnabled = true;
+    this->forwardingPort = nullptr;
+}
+
+//------------------------------------------------------------------------------
+bool
+SocketPort::IsOpen() const {
+    return this->epollFd >= 0;
+}
+
+//------------------------------------------------------------------------------
+bool
+SocketPort::IsConnected() const {
+    return this->connected;
+}
+
+//------------------------------------------------------------------------------
+bool
+SocketPort::WaitForConnection(Clock::Ticks timeout) {
+    o_assert(this->IsOpen());
+    std::unique_lock<std::mutex> lock(this->inLock);
+    return this->inCond.wait_for(lock, std::chrono::nanoseconds(timeout), [this] {
+        return this->connected.load();
+    });
+}
+
+//------------------------------------------------------------------------------
+void
+SocketPort::SetOverflow(Overflow::Code overflow_, int32 maxQueuedBytes_) {
+    o_assert((Overflow::Block == overflow_) || (Overflow::Reject == overflow_));
+    o_assert(maxQueuedBytes_ > 0);
+    std::lock_guard<std::mutex> lock(this->outLock);
+    this->overflow = overflow_;
+    this->maxQueuedBytes = maxQueuedBytes_;
+}
+
+//------------------------------------------------------------------------------
+Overflow::Code
+SocketPort::GetOverflow() const {
+    return this->overflow;
+}
+
+//------------------------------------------------------------------------------
+void
+SocketPort::SetCompression(Compression::Code codec, int32 level) {
+    o_assert(!this->IsOpen());
+    this->compressor.Setup(codec, level, true);
+}
+
+//------------------------------------------------------------------------------
+Compression::Code
+SocketPort::GetCompression() const {
+    return this->compressor.GetCodec();
+}
+
+//------------------------------------------------------------------------------
+SocketPort::Stats
+SocketPort::GetStats() const {
+    Stats stats;
+    stats.NumSent = this->numSent;
+    stats.NumReceived = this->numReceived;
+    stats.NumWrites = this->numWrites.load(std::memory_order_relaxed);
+    stats.NumReads = this->numReads.load(std::memory_order_relaxed);
+    stats.BytesSent = this->bytesSent.load(std::memory_order_relaxed);
+    stats.BytesReceived = this->bytesReceived.load(std::memory_order_relaxed);
+    stats.RawBytesSent = this->rawBytesSent.load(std::memory_order_relaxed);
+    stats.RawBytesReceived = this->rawBytesReceived.load(std::memory_order_relaxed);
+    stats.CompressTime = this->compressTime.load(std::memory_order_relaxed);
+    stats.DecompressTime = this->decompressTime.load(std::memory_order_relaxed);
+    return stats;
+}
+
+//------------------------------------------------------------------------------
+SocketPort::chunk
+SocketPort::allocChunk(int32 minCapacity) {
+    if ((minCapacity <= chunkSize) && !this->freeChunks.Empty()) {
+        chunk c = this->freeChunks.Back();
+        this->freeChunks.Erase(this->freeChunks.Size() - 1);
+        c.size = 0;
+        return c;
+    }
+    chunk c;
+    c.capacity = minCapacity > chunkSize ? minCapacity : chunkSize;
+    c.data = (uint8*) Memory::Alloc(c.capacity);
+    return c;
+}
+
+//------------------------------------------------------------------------------
+void
+SocketPort::freeChunk(chunk& c) {
+    if ((chunkSize == c.capacity) && (this->freeChunks.Size() < maxFreeChunks)) {
+        this->freeChunks.AddBack(c);
+    }
+    else {
+        Memory::Free(c.data);
+    }
+    c.data = nullptr;
+}
+
+//------------------------------------------------------------------------------
+bool
+SocketPort::Put(const Ptr<Message>& msg) {
+    o_assert(this->IsOpen());
+    if (!this->connected) {
+        return false;
+    }
+    const int32 frameSize = frameHeaderSize + CompactSerializer::EncodedMessageSize(msg);
+    if (frameSize > maxFrameSize) {
+        Log::Warn("SocketPort: message too big (%d bytes)\n", frameSize);
+        return false;
+    }
+    std::unique_lock<std::mutex> lock(this->outLock);
+    while ((this->queuedBytes > 0) && ((this->queuedBytes + frameSize) > this->maxQueuedBytes)) {
+        if ((Overflow::Reject == this->overflow) || !this->connected) {
+            return false;
+        }
+        this->outCond.wait(lock);
+    }
+    if (this->outChunks.Empty() || ((this->outChunks.Back().capacity - this->outChunks.Back().size) < frameSize)) {
+        this->outChunks.AddBack(this->allocChunk(frameSize));
+    }
+    chunk& c = this->outChunks.Back();
+    uint8* dstPtr = c.data + c.size;
+    const uint32 msgSize = uint32(frameSize - frameHeaderSize);
+    dstPtr[0] = uint8(msgSize);
+    dstPtr[1] = uint8(msgSize >> 8);
+    dstPtr[2] = uint8(msgSize >> 16);
+    dstPtr[3] = uint8(msgSize >> 24);
+    uint8* endPtr = this->encoder(msg, dstPtr + frameHeaderSize, dstPtr + frameSize);
+    o_assert_dbg(endPtr == dstPtr + frameSize);
+    if (nullptr == endPtr) {
+        return false;
+    }
+    c.size += frameSize;
+    this->queuedBytes += frameSize;
+    // only wake the IO thread if it's not writing already, messages
+    // which are put in the meantime are written together
+    const bool wake = !this->writePending;
+    this->writePending = true;
+    lock.unlock();
+    if (wake) {
+        this->wakeThread();
+    }
+    this->numSent++;
+    msg->SetHandled();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+SocketPort::DoWork() {
+    if (!this->IsOpen()) {
+        return;
+    }
+    bool resume = false;
+    {
+        std::lock_guard<std::mutex> lock(this->inLock);
+        std::swap(this->received, this->inbox);
+        this->inboxBytes = 0;
+        resume = this->readPaused;
+        this->readPaused = false;
+    }
+    if (resume) {
+        this->wakeThread();
+    }
+    for (const Ptr<Message>& msg : this->received) {
+        this->numReceived++;
+        this->forwardingPort->Put(msg);
+    }
+    this->received.Clear();
+    this->forwardingPort->DoWork();
+}
+
+//------------------------------------------------------------------------------
+bool
+SocketPort::WaitForMessages(Clock::Ticks timeout) {
+    o_assert(this->IsOpen());
+    std::unique_lock<std::mutex> lock(this->inLock);
+    return this->inCond.wait_for(lock, std::chrono::nanoseconds(timeout), [this] {
+        return !this->inbox.Empty();
+    });
+}
+
+//------------------------------------------------------------------------------
+void
+SocketPort::wakeThread() {
+    #if ORYOL_LINUX
+    const uint64 val = 1;
+    ssize_t res = write(this->wakeFd, &val, sizeof(val));
+    (void) res;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+SocketPort::threadFunc(SocketPort* self) {
+    CoreFacade::EnterThread();
+    o_prof_thread_name("SocketPort");
+    self->ioLoop();
+    CoreFacade::LeaveThread();
+}
+
+//------------------------------------------------------------------------------
+void
+SocketPort::ioLoop() {
+    #if ORYOL_LINUX
+    Clock::Ticks stopTime = 0;
+    for (;;) {
+        if (this->stopRequested) {
+            // try to send what's queued before stopping
+            if (0 == stopTime) {
+                stopTime = Clock::Now();
+            }
+            bool pending;
+            {
+                std::lock_guard<std::mutex> lock(this->outLock);
+                pending = this->writePending;
+            }
+            if (!pending || !this->connected || (Clock::Since(stopTime) > flushTimeout)) {
+                break;
+            }
+        }
+        struct epoll_event events[8];
+        const int numEvents = epoll_wait(this->epollFd, events, 8, this->stopRequested ? 10 : -1);
+        for (int i = 0; i < numEvents; i++) {
+            const int fd = events[i].data.fd;
+            if (fd == this->wakeFd) {
+                uint64 val;
+                ssize_t res = read(this->wakeFd, &val, sizeof(val));
+                (void) res;
+            }
+            else if (fd == this->listenFd) {
+                this->acceptPeer();
+            }
+            else if (fd == this->sockFd) {
+                const uint32 mask = events[i].events;
+                if (mask & EPOLLOUT) {
+                    this->writable = true;
+                    this->updateEvents();
+                }
+                // a closed connection is drained even if reading is paused
+                const bool drain = 0 != (mask & (EPOLLRDHUP | EPOLLHUP | EPOLLERR));
+                if ((drain || (mask & EPOLLIN)) && !this->readFrames(drain)) {
+                    this->closePeer();
+                }
+            }
+        }
+        if ((this->sockFd >= 0) && !this->readEnabled) {
+            // resume reading when DoWork() has emptied the inbox
+            std::lock_guard<std::mutex> lock(this->inLock);
+            if (!this->readPaused) {
+                this->readEnabled = true;
+                this->updateEvents();
+            }
+        }
+        if (this->connected && this->writable && !this->writeChunks()) {
+            this->closePeer();
+        }
+    }
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+SocketPort::acceptPeer() {
+    #if ORYOL_LINUX
+    const int fd = accept4(this->listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    if (this->sockFd >= 0) {
+        // only one peer at a time
+        close(fd);
+        return;
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.fd = fd;
+    epoll_ctl(this->epollFd, EPOLL_CTL_ADD, fd, &ev);
+    this->sockFd = fd;
+    this->writable = true;
+    this->readEnabled = true;
+    // each connection starts new compression streams
+    this->compressor.Reset();
+    {
+        std::lock_guard<std::mutex> lock(this->inLock);
+        this->connected = true;
+    }
+    this->inCond.notify_all();
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+SocketPort::closePeer() {
+    #if ORYOL_LINUX
+    if (this->sockFd < 0) {
+        return;
+    }
+    epoll_ctl(this->epollFd, EPOLL_CTL_DEL, this->sockFd, nullptr);
+    close(this->sockFd);
+    this->sockFd = -1;
+    this->readSize = 0;
+    this->writable = true;
+    this->readEnabled = true;
+    {
+        std::lock_guard<std::mutex> lock(this->inLock);
+        this->connected = false;
+        this->readPaused = false;
+    }
+    this->inCond.notify_all();
+    // unsent data is dropped, and blocked Put() calls return
+    std::lock_guard<std::mutex> lock(this->outLock);
+    for (chunk& c : this->writing) {
+        this->freeChunk(c);
+    }
+    for (chunk& c : this->outChunks) {
+        this->freeChunk(c);
+    }
+    this->writing.Clear();
+    this->outChunks.Clear();
+    this->writeOffset = 0;
+    this->queuedBytes = 0;
+    this->writePending = false;
+    this->outCond.notify_all();
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+SocketPort::updateEvents() {
+    #if ORYOL_LINUX
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLRDHUP;
+    if (this->readEnabled) {
+        ev.events |= EPOLLIN;
+    }
+    if (!this->writable) {
+        ev.events |= EPOLLOUT;
+    }
+    ev.data.fd = this->sockFd;
+    epoll_ctl(this->epollFd, EPOLL_CTL_MOD, this->sockFd, &ev);
+    #endif
+}
+
+//------------------------------------------------------------------------------
+bool
+SocketPort::writeChunks() {
+    #if ORYOL_LINUX
+    for (;;) {
+        if (this->writing.Empty()) {
+            // take all chunks which have been queued since the last write
+            {
+                std::lock_guard<std::mutex> lock(this->outLock);
+                if (this->outChunks.Empty()) {
+                    this->writePending = false;
+                    return true;
+                }
+                std::swap(this->writing, this->outChunks);
+            }
+            if (Compression::None != this->compressor.GetCodec()) {
+                this->compressChunks();
+            }
+            else {
+                int64 rawSize = 0;
+                for (const chunk& c : this->writing) {
+                    rawSize += c.size;
+                }
+                this->rawBytesSent.fetch_add(rawSize, std::memory_order_relaxed);
+            }
+        }
+        struct iovec iov[maxWriteChunks];
+        int32 numIov = 0;
+        for (int32 i = 0; (i < this->writing.Size()) && (numIov < maxWriteChunks); i++) {
+            const int32 offset = (0 == i) ? this->writeOffset : 0;
+            iov[numIov].iov_base = this->writing[i].data + offset;
+            iov[numIov].iov_len = size_t(this->writing[i].size - offset);
+            numIov++;
+        }
+        struct msghdr hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.msg_iov = iov;
+        hdr.msg_iovlen = size_t(numIov);
+        // sendmsg() is writev() without SIGPIPE if the peer is gone
+        const ssize_t res = sendmsg(this->sockFd, &hdr, MSG_NOSIGNAL);
+        if (res < 0) {
+            if ((EAGAIN == errno) || (EWOULDBLOCK == errno)) {
+                this->writable = false;
+                this->updateEvents();
+                return true;
+            }
+            else if (EINTR == errno) {
+                continue;
+            }
+            return false;
+        }
+        this->numWrites.fetch_add(1, std::memory_order_relaxed);
+        this->bytesSent.fetch_add(res, std::memory_order_relaxed);
+        
+        // remove completely written chunks, and make room for blocked Put() calls
+        std::lock_guard<std::mutex> lock(this->outLock);
+        int32 remaining = int32(res);
+        while (remaining > 0) {
+            chunk& c = this->writing.Front();
+            const int32 left = c.size - this->writeOffset;
+            if (remaining >= left) {
+                remaining -= left;
+                this->freeChunk(c);
+                this->writing.Erase(0);
+                this->writeOffset = 0;
+            }
+            else {
+                this->writeOffset += remaining;
+                remaining = 0;
+            }
+        }
+        this->queuedBytes -= int32(res);
+        this->outCond.notify_all();
+    }
+    #else
+    return false;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+bool
+SocketPort::readFrames(bool drain) {
+    #if ORYOL_LINUX
+    // a peer which sends without pause must not starve the writes
+    const int32 maxReads = 16;
+    bool alive = true;
+    Array<Ptr<Message>> msgs;
+    for (int32 numReadCalls = 0; (numReadCalls < maxReads) && (drain || this->readEnabled); numReadCalls++) {
+        if (this->readSize == this->readCapacity) {
+            // a frame which is bigger than the read buffer
+            const int32 newCapacity = this->readCapacity * 2;
+            uint8* newBuf = (uint8*) Memory::Alloc(newCapacity);
+            Memory::Copy(this->readBuf, newBuf, this->readSize);
+            Memory::Free(this->readBuf);
+            this->readBuf = newBuf;
+            this->readCapacity = newCapacity;
+        }
+        const ssize_t res = read(this->sockFd, this->readBuf + this->readSize, size_t(this->readCapacity - this->readSize));
+        if (res < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            alive = (EAGAIN == errno) || (EWOULDBLOCK == errno);
+            break;
+        }
+        else if (0 == res) {
+            alive = false;
+            break;
+        }
+        this->numReads.fetch_add(1, std::memory_order_relaxed);
+        this->bytesReceived.fetch_add(res, std::memory_order_relaxed);
+        this->readSize += int32(res);
+        
+        // decode all complete frames and packets
+        int32 numBytes = 0;
+        const uint8* ptr = this->readBuf;
+        const uint8* endPtr = this->readBuf + this->readSize;
+        while ((endPtr - ptr) >= frameHeaderSize) {
+            const uint32 msgSize = uint32(ptr[0]) | (uint32(ptr[1]) << 8) | (uint32(ptr[2]) << 16) | (uint32(ptr[3]) << 24);
+            if (msgSize & packetFlag) {
+                // a packet of compressed frames
+                if ((endPtr - ptr) < packetHeaderSize) {
+                    break;
+                }
+                const uint8 codec = uint8((msgSize & ~packetFlag) >> packetCodecShift);
+                const uint32 packedSize = msgSize & packetSizeMask;
+                const uint32 rawSize = uint32(ptr[4]) | (uint32(ptr[5]) << 8) | (uint32(ptr[6]) << 16) | (uint32(ptr[7]) << 24);
+                // compressChunks() never sends empty packets
+                if ((codec >= Compression::NumCodes) || (0 == rawSize) || (0 == packedSize) || (rawSize > uint32(maxFrameSize)) || (packedSize > uint32(Compressor::MaxCompressedSize(maxFrameSize)))) {
+                    Log::Warn("SocketPort: invalid packet on '%s', closing connection\n", this->path.AsCStr());
+                    this->readSize = 0;
+                    alive = false;
+                    break;
+                }
+                if ((endPtr - ptr) < int32(packetHeaderSize + packedSize)) {
+                    break;
+                }
+                if (int32(rawSize) > this->unpackCapacity) {
+                    this->unpackBuf = (uint8*) Memory::ReAlloc(this->unpackBuf, int32(rawSize));
+                    this->unpackCapacity = int32(rawSize);
+                }
+                const bool valid = this->compressor.Decompress(Compression::Code(codec), ptr + packetHeaderSize, int32(packedSize), this->unpackBuf, int32(rawSize)) &&
+                                   this->decodePacket(this->unpackBuf, this->unpackBuf + rawSize, msgs);
+                this->decompressTime.store(this->compressor.GetDecompressStats().Time, std::memory_order_relaxed);
+                if (!valid) {
+                    Log::Warn("SocketPort: corrupt packet on '%s', closing connection\n", this->path.AsCStr());
+                    this->readSize = 0;
+                    alive = false;
+                    break;
+                }
+                this->rawBytesReceived.fetch_add(rawSize, std::memory_order_relaxed);
+                ptr += packetHeaderSize + packedSize;
+                numBytes += int32(rawSize);
+                continue;
+            }
+            if (msgSize > uint32(maxFrameSize)) {
+                Log::Warn("SocketPort: invalid frame on '%s', closing connection\n", this->path.AsCStr());
+                this->readSize = 0;
+                alive = false;
+                break;
+            }
+            if ((endPtr - ptr) < int32(frameHeaderSize + msgSize)) {
+                break;
+            }
+            Ptr<Message> msg;
+            if (this->decoder(ptr + frameHeaderSize, ptr + frameHeaderSize + msgSize, msg) && msg) {
+                msgs.AddBack(msg);
+            }
+            else {
+                Log::Warn("SocketPort: dropped invalid message on '%s'\n", this->path.AsCStr());
+            }
+            ptr += frameHeaderSize + msgSize;
+            numBytes += frameHeaderSize + msgSize;
+            this->rawBytesReceived.fetch_add(frameHeaderSize + msgSize, std::memory_order_relaxed);
+        }
+        if (this->deliver(msgs, numBytes) && this->readEnabled) {
+            // stop reading until DoWork() has caught up
+            this->readEnabled = false;
+            this->updateEvents();
+        }
+        if (!alive) {
+            break;
+        }
+        this->readSize = int32(endPtr - ptr);
+        if ((this->readSize > 0) && (ptr != this->readBuf)) {
+            Memory::Move(ptr, this->readBuf, this->readSize);
+        }
+    }
+    return alive;
+    #else
+    return false;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+bool
+SocketPort::decodePacket(const uint8* ptr, const uint8* endPtr, Array<Ptr<Message>>& msgs) {
+    // a packet only contains complete frames
+    while (ptr < endPtr) {
+        if ((endPtr - ptr) < frameHeaderSize) {
+            return false;
+        }
+        const uint32 msgSize = uint32(ptr[0]) | (uint32(ptr[1]) << 8) | (uint32(ptr[2]) << 16) | (uint32(ptr[3]) << 24);
+        if (msgSize > uint32(endPtr - ptr - frameHeaderSize)) {
+            return false;
+        }
+        Ptr<Message> msg;
+        if (this->decoder(ptr + frameHeaderSize, ptr + frameHeaderSize + msgSize, msg) && msg) {
+            msgs.AddBack(msg);
+        }
+        else {
+            Log::Warn("SocketPort: dropped invalid message on '%s'\n", this->path.AsCStr());
+        }
+        ptr += frameHeaderSize + msgSize;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+SocketPort::compressChunks() {
+    // replace each chunk with a packet of its compressed frames
+    int32 rawSize = 0;
+    int32 packedSize = 0;
+    Array<chunk> rawChunks;
+    rawChunks.Reserve(this->writing.Size());
+    for (chunk& c : this->writing) {
+        chunk packet;
+        packet.capacity = packetHeaderSize + Compressor::MaxCompressedSize(c.size);
+        packet.data = (uint8*) Memory::Alloc(packet.capacity);
+        const int32 size = this->compressor.Compress(c.data, c.size, packet.data + packetHeaderSize, packet.capacity - packetHeaderSize);
+        o_assert(size > 0);
+        const uint32 word0 = packetFlag | (uint32(this->compressor.GetCodec()) << packetCodecShift) | uint32(size);
+        const uint32 word1 = uint32(c.size);
+        for (int32 i = 0; i < 4; i++) {
+            packet.data[i] = uint8(word0 >> (i * 8));
+            packet.data[4 + i] = uint8(word1 >> (i * 8));
+        }
+        packet.size = packetHeaderSize + size;
+        rawSize += c.size;
+        packedSize += packet.size;
+        rawChunks.AddBack(c);
+        c = packet;
+    }
+    this->rawBytesSent.fetch_add(rawSize, std::memory_order_relaxed);
+    this->compressTime.store(this->compressor.GetCompressStats().Time, std::memory_order_relaxed);
+    
+    // queued bytes are counted as they are written
+    std::lock_guard<std::mutex> lock(this->outLock);
+    for (chunk& c : rawChunks) {
+        this->freeChunk(c);
+    }
+    this->queuedBytes += packedSize - rawSize;
+}
+
+//------------------------------------------------------------------------------
+bool
+SocketPort::deliver(Array<Ptr<Message>>& msgs, int32 numBytes) {
+    bool full;
+    {
+        std::lock_guard<std::mutex> lock(this->inLock);
+        for (Ptr<Message>& msg : msgs) {
+            this->inbox.AddBack(std::move(msg));
+        }
+        this->inboxBytes += numBytes;
+        full = (this->inbox.Size() >= maxInboxMessages) || (this->inboxBytes >= maxInboxBytes);
+        if (full) {
+            this->readPaused = true;
+        }
+    }
+    if (!msgs.Empty()) {
+        msgs.Clear();
+        this->inCond.notify_all();
+    }
+    return full;
+}
+
+} // namespace Messaging
+} // namespace Oryol
@@ -0,0 +1,250 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Messaging::SocketPort
+    @brief send and receive messages over a Unix domain socket
+    
+    A SocketPort connects two processes through a stream socket, for
+    local tools which can't share memory with the game (different users,
+    sandboxes, or the other side is not an Oryol program). One side
+    listens on a socket path, the other side connects, both sides can
+    then send with Put() and forward received messages to a local 
+    port (usually a Dispatcher) in DoWork():
+    
+        // game process
+        Ptr<SocketPort> port = SocketPort::Create();
+        port->Listen<ToolsProtocol>("/tmp/mygame.sock", dispatcher);
+        
+        // tools process
+        Ptr<SocketPort> port = SocketPort::Create();
+        port->Connect<ToolsProtocol>("/tmp/mygame.sock", dispatcher);
+        port->Put(msg);
+    
+    Messages are framed (a 32-bit little-endian size followed by the 
+    message in the compact encoding, see CompactSerializer) and all
+    socket IO happens on a thread owned by the port, driven by epoll. 
+    Put() encodes the message into a chunk of the outgoing buffer and 
+    only wakes up the IO thread if it isn't already writing, so messages
+    which are put while a write is in flight are coalesced, and written 
+    with a single writev-style call. The IO thread reads as much as is 
+    available into a read buffer, decodes all complete frames, and hands
+    the messages to the port's thread in one batch.
+    
+    With SetCompression() the IO thread compresses the frames of each
+    chunk it writes into a packet (see Compressor). Deflate packets are
+    one stream per connection, so small writes compress well too. The
+    dictionary is built from the protocol, so a compressing side needs
+    the same message classes and default values as its peer (without
+    compression, builds with added message classes or attributes can 
+    talk to each other). Packets carry their codec, a port decodes what
+    the other side sends regardless of its own setting.
+    
+    Put() returns false if no peer is connected. A listening port
+    accepts one peer at a time, and accepts a new one after the peer
+    has disconnected. If more than maxQueuedBytes are waiting to be
+    written, Put() waits for the IO thread (Overflow::Block, the default)
+    or returns false (Overflow::Reject). Close() tries to send messages
+    which are still queued. If received messages pile up because 
+    DoWork() isn't called often enough, the IO thread stops reading
+    until DoWork() has caught up, so a fast sender is slowed down
+    by the socket instead of filling up the receiver's memory (if 
+    the same thread sends and calls DoWork() on the receiving port,
+    use Overflow::Reject, a blocked Put() would wait forever).
+    
+    Put(), DoWork() and the other methods must be called from the 
+    thread which opened the port. Only supported on Linux, Listen() and
+    Connect() fail on other platforms.
+*/
+#include "Messaging/Port.h"
+#include "Messaging/CompactSerializer.h"
+#include "Messaging/Compressor.h"
+#include "Core/Containers/Array.h"
+#include "Core/String/String.h"
+#include "Core/Time/Clock.h"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace Oryol {
+namespace Messaging {
+
+class SocketPort : public Port {
+    OryolClassDecl(SocketPort);
+public:
+    /// transfer statistics
+    struct Stats {
+        /// number of messages put and received
+        int64 NumSent = 0;
+        int64 NumReceived = 0;
+        /// number of write and read syscalls
+        int64 NumWrites = 0;
+        int64 NumReads = 0;
+        /// number of bytes written and read
+        int64 BytesSent = 0;
+        int64 BytesReceived = 0;
+        /// number of frame bytes before compression and after decompression
+        int64 RawBytesSent = 0;
+        int64 RawBytesReceived = 0;
+        /// time the IO thread spent compressing and decompressing
+        Core::Clock::Ticks CompressTime = 0;
+        Core::Clock::Ticks DecompressTime = 0;
+    };
+    /// default max number of bytes waiting to be written
+    static const int32 DefaultMaxQueuedBytes = 8 * 1024 * 1024;
+    
+    /// constructor
+    SocketPort();
+    /// destructor
+    virtual ~SocketPort();
+    
+    /// listen on a socket path for messages of PROTOCOL, received messages are forwarded to forwardingPort
+    template<class PROTOCOL> bool Listen(const char* path, const Core::Ptr<Port>& forwardingPort);
+    /// connect to a listening port, received messages are forwarded to forwardingPort
+    template<class PROTOCOL> bool Connect(const char* path, const Core::Ptr<Port>& forwardingPort);
+    /// close the port (stops the IO thread)
+    void Close();
+    /// return true if the port is open
+    bool IsOpen() const;
+    /// return true if a peer is connected
+    bool IsConnected() const;
+    /// wait until a peer is connected, returns false on timeout
+    bool WaitForConnection(Core::Clock::Ticks timeout);
+    
+    /// set what Put() does when too many bytes are waiting to be written (Block or Reject)
+    void SetOverflow(Overflow::Code overflow, int32 maxQueuedBytes = DefaultMaxQueuedBytes);
+    /// get the overflow policy
+    Overflow::Code GetOverflow() const;
+    /// compress outgoing messages, call before Listen() or Connect()
+    void SetCompression(Compression::Code codec, int32 level = Compressor::DefaultLevel);
+    /// get how outgoing messages are compressed
+    Compression::Code GetCompression() const;
+    /// get transfer statistics
+    Stats GetStats() const;
+    
+    /// encode a message and queue it for writing
+    virtual bool Put(const Core::Ptr<Message>& msg) override;
+    /// forward received messages
+    virtual void DoWork() override;
+    /// wait until messages have been received, returns false on timeout
+    bool WaitForMessages(Core::Clock::Ticks timeout);
+    
+private:
+    typedef uint8* (*encodeFunc)(const Core::Ptr<Message>&, uint8*, const uint8*);
+    typedef const uint8* (*decodeFunc)(const uint8*, const uint8*, Core::Ptr<Message>&);
+    /// a block of encoded frames
+    struct chunk {
+        uint8* data = nullptr;
+        int32 size = 0;
+        int32 capacity = 0;
+    };
+    
+    /// create the socket and start the IO thread
+    bool open(const char* path, bool listen);
+    /// the IO thread entry function
+    static void threadFunc(SocketPort* self);
+    /// the IO thread loop
+    void ioLoop();
+    /// IO thread: accept a connection
+    void acceptPeer();
+    /// IO thread: close the connection and drop unsent data
+    void closePeer();
+    /// IO thread: read and decode frames, returns false if the connection is closed
+    bool readFrames(bool drain);
+    /// IO thread: decode a decompressed packet of complete frames, returns false if invalid
+    bool decodePacket(const uint8* ptr, const uint8* endPtr, Core::Array<Core::Ptr<Message>>& msgs);
+    /// IO thread: compress the chunks which are about to be written
+    void compressChunks();
+    /// IO thread: hand decoded messages to the port's thread, returns true if the inbox is full
+    bool deliver(Core::Array<Core::Ptr<Message>>& msgs, int32 numBytes);
+    /// IO thread: write queued chunks, returns false on error
+    bool writeChunks();
+    /// IO thread: update the epoll events of the socket
+    void updateEvents();
+    /// wake up the IO thread
+    void wakeThread();
+    /// get a chunk for at least minCapacity bytes (outLock must be held)
+    chunk allocChunk(int32 minCapacity);
+    /// return a written chunk (outLock must be held)
+    void freeChunk(chunk& c);
+    
+    Core::String path;
+    bool listening;
+    int listenFd;
+    int sockFd;
+    int epollFd;
+    int wakeFd;
+    encodeFunc encoder;
+    decodeFunc decoder;
+    Core::Ptr<Port> forwardingPort;
+    Overflow::Code overflow;
+    int32 maxQueuedBytes;
+    std::thread thread;
+    std::atomic<bool> stopRequested;
+    std::atomic<bool> connected;
+    
+    // outgoing frames, encoded by Put(), written by the IO thread
+    std::mutex outLock;
+    std::condition_variable outCond;
+    Core::Array<chunk> outChunks;
+    Core::Array<chunk> freeChunks;
+    int32 queuedBytes;
+    bool writePending;
+    // chunks which are being written by the IO thread
+    Core::Array<chunk> writing;
+    int32 writeOffset;
+    bool writable;
+    bool readEnabled;
+    
+    // received messages, decoded by the IO thread, forwarded in DoWork()
+    std::mutex inLock;
+    std::condition_variable inCond;
+    Core::Array<Core::Ptr<Message>> inbox;
+    Core::Array<Core::Ptr<Message>> received;
+    int32 inboxBytes;
+    bool readPaused;
+    uint8* readBuf;
+    int32 readCapacity;
+    int32 readSize;
+    
+    // compression of outgoing and decompression of incoming packets (IO thread)
+    Compressor compressor;
+    uint8* unpackBuf;
+    int32 unpackCapacity;
+    
+    int64 numSent;
+    int64 numReceived;
+    std::atomic<int64> numWrites;
+    std::atomic<int64> numReads;
+    std::atomic<int64> bytesSent;
+    std::atomic<int64> bytesReceived;
+    std::atomic<int64> rawBytesSent;
+    std::atomic<int64> rawBytesReceived;
+    std::atomic<int64> compressTime;
+    std::atomic<int64> decompressTime;
+};
+
+//------------------------------------------------------------------------------
+template<class PROTOCOL> bool
+SocketPort::Listen(const char* path_, const Core::Ptr<Port>& forwardingPort_) {
+    o_assert(forwardingPort_);
+    this->encoder = &CompactSerializer::EncodeMessage<PROTOCOL>;
+    this->decoder = &CompactSerializer::DecodeMessage<PROTOCOL>;
+    this->forwardingPort = forwardingPort_;
+    this->compressor.SetProtocolDictionary<PROTOCOL>();
+    return this->open(path_, true);
+}
+
+//------------------------------------------------------------------------------
+template<class PROTOCOL> bool
+SocketPort::Connect(const char* path_, const Core::Ptr<Port>& forwardingPort_) {
+    o_assert(forwardingPort_);
+    this->encoder = &CompactSerializer::EncodeMessage<PROTOCOL>;
+    this->decoder = &CompactSerializer::DecodeMessage<PROTOCOL>;
+    this->forwardingPort = forwardingPort_;
+    this->compressor.SetProtocolDictionary<PROTOCOL>();
+    return this->open(path_, false);
+}
+
+} // namespace Messaging
+} // namespace Oryol
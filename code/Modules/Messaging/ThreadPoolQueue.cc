@@ -0,0 +1,350 @@
+//------------------------------------------------------------------------------
+//  ThreadPoolQueue.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "ThreadPoolQueue.h"
+#include "Core/CoreFacade.h"
+#include "Core/Profiler.h"
+#include "Core/Metrics.h"
+
+namespace Oryol {
+namespace Messaging {
+    
+OryolClassImpl(ThreadPoolQueue);
+
+using namespace Core;
+
+namespace {
+    Metrics::Id messagesMetric() {
+        static const Metrics::Id id = Metrics::RegisterCounter("messaging.messages");
+        return id;
+    }
+    Metrics::Id queueDepthMetric() {
+        static const Metrics::Id id = Metrics::RegisterGauge("messaging.queue_depth");
+        return id;
+    }
+    Metrics::Id stolenMetric() {
+        static const Metrics::Id id = Metrics::RegisterCounter("messaging.stolen");
+        return id;
+    }
+}
+
+//------------------------------------------------------------------------------
+ThreadPoolQueue::ThreadPoolQueue(int32 numWorkers_) :
+numWorkers(numWorkers_),
+tickDuration(0),
+workers(nullptr),
+sharedForwardingPort(false),
+nextWorker(0),
+numStolen(0),
+threadsStarted(false),
+threadsStopRequested(false),
+threadsStopped(false) {
+    o_assert(numWorkers_ > 0);
+    this->workers = new worker[numWorkers_];
+    this->forwardingPorts.Reserve(numWorkers_);
+    for (int32 i = 0; i < numWorkers_; i++) {
+        this->forwardingPorts.AddBack(Ptr<Port>());
+    }
+}
+
+//------------------------------------------------------------------------------
+ThreadPoolQueue::ThreadPoolQueue(int32 numWorkers_, const Ptr<Port>& port_) :
+ThreadPoolQueue(numWorkers_) {
+    this->sharedForwardingPort = true;
+    for (int32 i = 0; i < numWorkers_; i++) {
+        this->forwardingPorts[i] = port_;
+    }
+}
+
+//------------------------------------------------------------------------------
+ThreadPoolQueue::~ThreadPoolQueue() {
+    o_assert(!this->threadsStarted || this->threadsStopped);
+    delete[] this->workers;
+    this->workers = nullptr;
+}
+
+//------------------------------------------------------------------------------
+void
+ThreadPoolQueue::SetTickDuration(uint32 milliSec) {
+    o_assert(!this->threadsStarted);
+    this->tickDuration = milliSec;
+}
+
+//------------------------------------------------------------------------------
+uint32
+ThreadPoolQueue::GetTickDuration() const {
+    return this->tickDuration;
+}
+
+//------------------------------------------------------------------------------
+int32
+ThreadPoolQueue::GetNumWorkers() const {
+    return this->numWorkers;
+}
+
+//------------------------------------------------------------------------------
+int64
+ThreadPoolQueue::GetNumStolen() const {
+    return this->numStolen.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+void
+ThreadPoolQueue::StartThreads() {
+    o_assert(!this->threadsStarted);
+    for (int32 i = 0; i < this->numWorkers; i++) {
+        this->workers[i].thread = std::thread(threadFunc, this, i);
+    }
+    this->threadsStarted = true;
+}
+
+//------------------------------------------------------------------------------
+void
+ThreadPoolQueue::StopThreads() {
+    o_assert(this->threadsStarted && !this->threadsStopped);
+    this->threadsStopRequested = true;
+    for (int32 i = 0; i < this->numWorkers; i++) {
+        // lock, so that the worker can't miss the wakeup between
+        // checking the flag and going to sleep
+        worker& w = this->workers[i];
+        std::lock_guard<std::mutex> lock(w.wakeupMutex);
+        w.wakeup.notify_one();
+    }
+    for (int32 i = 0; i < this->numWorkers; i++) {
+        this->workers[i].thread.join();
+    }
+    this->threadsStopped = true;
+}
+
+//------------------------------------------------------------------------------
+bool
+ThreadPoolQueue::Put(const Ptr<Message>& msg) {
+    return this->Put(msg, NoAffinity);
+}
+
+//------------------------------------------------------------------------------
+bool
+ThreadPoolQueue::Put(const Ptr<Message>& msg, uint32 affinityKey) {
+    o_assert(msg.isValid());
+    Metrics::Add(queueDepthMetric(), 1);
+    int32 workerIndex;
+    if (NoAffinity != affinityKey) {
+        workerIndex = int32(affinityKey % uint32(this->numWorkers));
+        this->workers[workerIndex].pinned.Push(msg);
+    }
+    else {
+        workerIndex = int32(this->nextWorker.fetch_add(1, std::memory_order_relaxed) % uint32(this->numWorkers));
+        worker& w = this->workers[workerIndex];
+        w.localLock.Lock();
+        w.local.Enqueue(msg);
+        w.numLocal.fetch_add(1, std::memory_order_relaxed);
+        w.localLock.Unlock();
+    }
+    // pairs with the fence in wait(): either the worker sees the
+    // message, or we see that it is (going to) sleep
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!this->wake(workerIndex) && (NoAffinity == affinityKey)) {
+        // the worker is busy, wake up an idle worker to steal the message
+        for (int32 i = 1; i < this->numWorkers; i++) {
+            if (this->wake((workerIndex + i) % this->numWorkers)) {
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool
+ThreadPoolQueue::wake(int32 workerIndex) {
+    worker& w = this->workers[workerIndex];
+    if (w.sleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(w.wakeupMutex);
+        w.wakeup.notify_one();
+        return true;
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+bool
+ThreadPoolQueue::popLocal(int32 workerIndex, Ptr<Message>& outMsg) {
+    worker& w = this->workers[workerIndex];
+    if (0 == w.numLocal.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    bool result = false;
+    w.localLock.Lock();
+    if (!w.local.Empty()) {
+        outMsg = w.local.Dequeue();
+        w.numLocal.fetch_sub(1, std::memory_order_relaxed);
+        result = true;
+    }
+    w.localLock.Unlock();
+    return result;
+}
+
+//------------------------------------------------------------------------------
+bool
+ThreadPoolQueue::steal(int32 workerIndex) {
+    // find the most loaded other worker
+    int32 victim = InvalidIndex;
+    int32 maxLocal = 0;
+    for (int32 i = 0; i < this->numWorkers; i++) {
+        const int32 num = this->workers[i].numLocal.load(std::memory_order_relaxed);
+        if ((i != workerIndex) && (num > maxLocal)) {
+            victim = i;
+            maxLocal = num;
+        }
+    }
+    if (InvalidIndex == victim) {
+        return false;
+    }
+    
+    // take the older half of its messages
+    Array<Ptr<Message>> stolen;
+    worker& v = this->workers[victim];
+    v.localLock.Lock();
+    const int32 num = (v.local.Size() + 1) / 2;
+    stolen.Reserve(num);
+    for (int32 i = 0; i < num; i++) {
+        stolen.AddBack(v.local.Dequeue());
+    }
+    v.numLocal.fetch_sub(num, std::memory_order_relaxed);
+    v.localLock.Unlock();
+    if (0 == num) {
+        return false;
+    }
+    
+    worker& w = this->workers[workerIndex];
+    w.localLock.Lock();
+    for (auto& msg : stolen) {
+        w.local.Enqueue(std::move(msg));
+    }
+    w.numLocal.fetch_add(num, std::memory_order_relaxed);
+    w.localLock.Unlock();
+    this->numStolen.fetch_add(num, std::memory_order_relaxed);
+    Metrics::Add(stolenMetric(), num);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool
+ThreadPoolQueue::hasWork(int32 workerIndex) const {
+    if (!this->workers[workerIndex].pinned.Empty()) {
+        return true;
+    }
+    // own messages, or messages which can be stolen
+    for (int32 i = 0; i < this->numWorkers; i++) {
+        if (this->workers[i].numLocal.load(std::memory_order_relaxed) > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void
+ThreadPoolQueue::wait(int32 workerIndex) {
+    worker& w = this->workers[workerIndex];
+    std::unique_lock<std::mutex> lock(w.wakeupMutex);
+    w.sleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto ready = [this, workerIndex]() {
+        return this->threadsStopRequested || this->hasWork(workerIndex);
+    };
+    if (0 != this->tickDuration) {
+        w.wakeup.wait_for(lock, std::chrono::milliseconds(this->tickDuration), ready);
+    }
+    else {
+        w.wakeup.wait(lock, ready);
+    }
+    w.sleeping.store(false, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+void
+ThreadPoolQueue::threadFunc(ThreadPoolQueue* self, int32 workerIndex) {
+    
+    // notify subclass that thread has been entered
+    self->onThreadEnter(workerIndex);
+    
+    worker& w = self->workers[workerIndex];
+    while (!self->threadsStopRequested) {
+        
+        // process pinned messages, then own messages, then stolen messages
+        Ptr<Message> msg;
+        int32 numMessages = 0;
+        while (w.pinned.Pop(msg) || self->popLocal(workerIndex, msg) ||
+               (self->steal(workerIndex) && self->popLocal(workerIndex, msg))) {
+            o_prof_scope("ThreadPoolQueue::onMessage");
+            self->onMessage(workerIndex, msg);
+            numMessages++;
+        }
+        msg = nullptr;
+        if (numMessages > 0) {
+            Metrics::Add(messagesMetric(), numMessages);
+            Metrics::Add(queueDepthMetric(), -numMessages);
+        }
+        {
+            o_prof_scope("ThreadPoolQueue::onTick");
+            self->onTick(workerIndex);
+        }
+        
+        // go to sleep until new messages arrive
+        self->wait(workerIndex);
+    }
+    
+    // notify subclass that we're about to leave the thread
+    self->onThreadLeave(workerIndex);
+}
+
+//------------------------------------------------------------------------------
+/**
+ The default implementation of onThreadEnter() will call 
+ Core::Module::EnterThread() to setup any thread-locale data.
+*/
+void
+ThreadPoolQueue::onThreadEnter(int32 /*workerIndex*/) {
+    Core::CoreFacade::EnterThread();
+    o_prof_thread_name("ThreadPoolQueue");
+}
+
+//------------------------------------------------------------------------------
+/**
+ The default implementation of onMessage will invoke the Put() method
+ on the worker's forwarding port with the message as argument.
+*/
+void
+ThreadPoolQueue::onMessage(int32 workerIndex, const Ptr<Message>& msg) {
+    o_assert(this->forwardingPorts[workerIndex].isValid());
+    this->forwardingPorts[workerIndex]->Put(msg);
+}
+
+//------------------------------------------------------------------------------
+/**
+ The default implementation of onTick() will invoke the DoWork() method
+ on the worker's forwarding port. A forwarding port which is shared
+ by all workers is only ticked by the first worker.
+*/
+void
+ThreadPoolQueue::onTick(int32 workerIndex) {
+    o_assert(this->forwardingPorts[workerIndex].isValid());
+    if ((0 == workerIndex) || !this->sharedForwardingPort) {
+        this->forwardingPorts[workerIndex]->DoWork();
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+ The default implementation of onThreadLeave() will call 
+ Core::Module::LeaveThread() to discard any thread-locale data.
+*/
+void
+ThreadPoolQueue::onThreadLeave(int32 /*workerIndex*/) {
+    Core::CoreFacade::LeaveThread();
+}
+
+} // namespace Messaging
+} // namespace Oryol
@@ -0,0 +1,122 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Messaging::ThreadPoolQueue
+    @brief a message queue port served by a pool of worker threads
+    
+    A ThreadedQueue owns exactly one thread, so work can only be spread
+    over several threads by creating several queues and distributing
+    messages over them, and one slow message stalls all messages behind
+    it even if the other threads are idle. A ThreadPoolQueue runs N
+    worker threads which share the messages put into it:
+    
+    Each worker has a local queue, Put() distributes messages round-robin
+    over the local queues, and a worker which runs out of messages steals
+    half of the messages of the most loaded worker. Messages which must
+    be handled in order (e.g. all requests for the same file) are put
+    with an affinity key: all messages with the same key are handled by
+    the same worker (key % numWorkers), in the order they were put, and
+    are never stolen.
+    
+    Put() can be called from any thread, and only wakes up a worker if one
+    is sleeping. DoWork() is not needed (messages are visible to the workers
+    immediately).
+    
+    Messages are forwarded to the forwarding port of the worker which
+    handles them. By default all workers share the same forwarding port
+    (which must be able to handle concurrent calls to Put(), e.g. a 
+    Dispatcher with thread-safe handlers). Subclasses can override the
+    per-worker hooks to create one forwarding port per worker in
+    onThreadEnter(), just like ThreadedQueue subclasses do.
+*/
+#include "Messaging/Port.h"
+#include "Core/Containers/Array.h"
+#include "Core/Containers/Queue.h"
+#include "Core/Threading/Mutex.h"
+#include "Core/Threading/mpscQueue.h"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace Oryol {
+namespace Messaging {
+    
+class ThreadPoolQueue : public Port {
+    OryolClassDecl(ThreadPoolQueue);
+public:
+    /// the affinity key for messages which can be handled by any worker
+    static const uint32 NoAffinity = 0xFFFFFFFF;
+
+    /// constructor (subclass must setup forwarding ports in onThreadEnter()!)
+    ThreadPoolQueue(int32 numWorkers);
+    /// constructor with forwarding port shared by all workers
+    ThreadPoolQueue(int32 numWorkers, const Core::Ptr<Port>& forwardingPort);
+    /// destructor
+    virtual ~ThreadPoolQueue();
+    
+    /// set optional tick-duration in millisecs, workers will wake up even if no messages pending
+    void SetTickDuration(uint32 milliSecs);
+    /// get optional tick-duration in millisecs
+    uint32 GetTickDuration() const;
+    /// get number of worker threads
+    int32 GetNumWorkers() const;
+    /// start the worker threads, this cannot happen in the constructor
+    virtual void StartThreads();
+    /// stop the worker threads, this cannot happen in the destructor
+    virtual void StopThreads();
+    /// put a message which can be handled by any worker (any thread)
+    virtual bool Put(const Core::Ptr<Message>& msg) override;
+    /// put a message with an affinity key, messages with the same key are handled in order (any thread)
+    bool Put(const Core::Ptr<Message>& msg, uint32 affinityKey);
+    /// get the number of messages which have been stolen by idle workers so far
+    int64 GetNumStolen() const;
+
+protected:
+    /// the thread entry function
+    static void threadFunc(ThreadPoolQueue* self, int32 workerIndex);
+    /// called in worker thread on thread-entry
+    virtual void onThreadEnter(int32 workerIndex);
+    /// called in worker thread to forward one message
+    virtual void onMessage(int32 workerIndex, const Core::Ptr<Message>& msg);
+    /// called in worker thread after messages are processed, and on each tick (if a TickDuration is set)
+    virtual void onTick(int32 workerIndex);
+    /// called in worker thread before thread is left
+    virtual void onThreadLeave(int32 workerIndex);
+
+    // per-worker state
+    struct worker {
+        Core::Mutex localLock;
+        Core::Queue<Core::Ptr<Message>> local;           // round-robin messages, can be stolen (locked)
+        std::atomic<int32> numLocal{0};                  // approximate size of local queue
+        Core::mpscQueue<Core::Ptr<Message>> pinned;      // messages with affinity key, never stolen
+        std::atomic<bool> sleeping{false};
+        std::mutex wakeupMutex;
+        std::condition_variable wakeup;
+        std::thread thread;
+    };
+    /// pop a message from a worker's local queue
+    bool popLocal(int32 workerIndex, Core::Ptr<Message>& outMsg);
+    /// steal half of the messages of the most loaded other worker
+    bool steal(int32 workerIndex);
+    /// return true if a worker has something to do
+    bool hasWork(int32 workerIndex) const;
+    /// wait until a worker has something to do (or tick/stop)
+    void wait(int32 workerIndex);
+    /// wake up a worker if it is sleeping, return false if it was awake
+    bool wake(int32 workerIndex);
+
+    int32 numWorkers;
+    uint32 tickDuration;
+    worker* workers;
+    Core::Array<Core::Ptr<Port>> forwardingPorts;   // one per worker, used in worker threads!
+    bool sharedForwardingPort;
+    std::atomic<uint32> nextWorker;
+    std::atomic<int64> numStolen;
+    bool threadsStarted;
+    std::atomic<bool> threadsStopRequested;
+    bool threadsStopped;
+};
+    
+} // namespace Messaging
+} // namespace Oryol
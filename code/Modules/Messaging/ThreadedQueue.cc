@@ -4,6 +4,8 @@
 #include "Pre.h"
 #include "ThreadedQueue.h"
 #include "Core/CoreFacade.h"
+#include "Core/Profiler.h"
+#include "Core/Metrics.h"
 
 namespace Oryol {
 namespace Messaging {
@@ -12,6 +14,21 @@ OryolClassPoolAllocImpl(ThreadedQueue);
 
 using namespace Core;
 
+namespace {
+    Metrics::Id messagesMetric() {
+        static const Metrics::Id id = Metrics::RegisterCounter("messaging.messages");
+        return id;
+    }
+    Metrics::Id queueDepthMetric() {
+        static const Metrics::Id id = Metrics::RegisterGauge("messaging.queue_depth");
+        return id;
+    }
+    Metrics::Id expiredMetric() {
+        static const Metrics::Id id = Metrics::RegisterCounter("messaging.expired");
+        return id;
+    }
+}
+
 //------------------------------------------------------------------------------
 /**
  NOTE: if the default constructor is used, a forwarding port must be 
@@ -20,20 +37,32 @@ using namespace Core;
 */
 ThreadedQueue::ThreadedQueue() :
 tickDuration(0),
+transferPending(false),
+multiProducer(false),
+workerSleeping(false),
 threadStarted(false),
 threadStopRequested(false),
 threadStopped(false) {
     this->createThreadId = std::this_thread::get_id();
+    for (int32 i = 0; i < Priority::NumPriorities; i++) {
+        this->starvation[i] = 0;
+    }
 }
 
 //------------------------------------------------------------------------------
 ThreadedQueue::ThreadedQueue(const Ptr<Port>& port_) :
 tickDuration(0),
 forwardingPort(port_),
+transferPending(false),
+multiProducer(false),
+workerSleeping(false),
 threadStarted(false),
 threadStopRequested(false),
 threadStopped(false) {
     this->createThreadId = std::this_thread::get_id();
+    for (int32 i = 0; i < Priority::NumPriorities; i++) {
+        this->starvation[i] = 0;
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -62,6 +91,51 @@ ThreadedQueue::GetTickDuration() const {
     return this->tickDuration;
 }
 
+//------------------------------------------------------------------------------
+void
+ThreadedQueue::SetMultiProducer(bool b) {
+    o_assert(!this->threadStarted);
+    this->multiProducer = b;
+}
+
+//------------------------------------------------------------------------------
+bool
+ThreadedQueue::IsMultiProducer() const {
+    return this->multiProducer;
+}
+
+//------------------------------------------------------------------------------
+void
+ThreadedQueue::SetCapacity(int32 capacity, Overflow::Code overflow) {
+    o_assert(!this->threadStarted);
+    this->monitor.setCapacity(capacity, overflow);
+}
+
+//------------------------------------------------------------------------------
+int32
+ThreadedQueue::GetCapacity() const {
+    return this->monitor.capacity;
+}
+
+//------------------------------------------------------------------------------
+Overflow::Code
+ThreadedQueue::GetOverflow() const {
+    return this->monitor.overflow;
+}
+
+//------------------------------------------------------------------------------
+void
+ThreadedQueue::SetMetricsName(const char* name) {
+    o_assert(!this->threadStarted);
+    this->monitor.setMetricsName(name);
+}
+
+//------------------------------------------------------------------------------
+QueueStats
+ThreadedQueue::GetStats() const {
+    return this->monitor.stats();
+}
+
 //------------------------------------------------------------------------------
 void
 ThreadedQueue::StartThread() {
@@ -75,7 +149,12 @@ ThreadedQueue::StartThread() {
 void
 ThreadedQueue::StopThread() {
     o_assert(this->threadStarted);
-    this->threadStopRequested = true;
+    {
+        // set under the lock, so that the worker can't miss the wakeup
+        // between checking the flag and going to sleep
+        std::lock_guard<std::mutex> lock(this->wakeupMutex);
+        this->threadStopRequested = true;
+    }
     this->wakeup.notify_one();
     this->thread.join();
     this->threadStopped = true;
@@ -84,17 +163,116 @@ ThreadedQueue::StopThread() {
 //------------------------------------------------------------------------------
 bool
 ThreadedQueue::Put(const Ptr<Message>& msg) {
-    o_assert(this->isCreateThread());
-    o_assert(this->threadStarted);
-    o_assert(!this->threadStopped);
+    if (!this->multiProducer) {
+        o_assert(this->isCreateThread());
+        o_assert(this->threadStarted);
+        o_assert(!this->threadStopped);
+    }
+    // take the slot before queueing, so that concurrent producers
+    // can't push the queue over its capacity
+    while (!this->monitor.tryEnqueue(msg.get())) {
+        if (!this->makeRoom()) {
+            this->monitor.rejected();
+            return false;
+        }
+        if (Overflow::DropOldest == this->monitor.overflow) {
+            // the oldest message has been dropped (or will be by the worker)
+            this->monitor.enqueued(msg.get());
+            break;
+        }
+    }
+    Metrics::Add(queueDepthMetric(), 1);
+    if (this->multiProducer) {
+        this->inbox.Push(msg);
+        // only pay for the wakeup if the worker is sleeping, the fence pairs
+        // with the one in waitInbox(): either the worker sees the message,
+        // or we see that it is (going to) sleep
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (this->workerSleeping.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(this->wakeupMutex);
+            this->wakeup.notify_one();
+        }
+        return true;
+    }
     this->writeQueue.Enqueue(msg);
     return true;
 }
 
+//------------------------------------------------------------------------------
+bool
+ThreadedQueue::makeRoom() {
+    switch (this->monitor.overflow) {
+        case Overflow::Reject:
+            return false;
+        case Overflow::DropOldest:
+            // in multi-producer mode, the worker drops in dropOverflow()
+            if (!this->multiProducer) {
+                this->dropOldestQueued();
+            }
+            return true;
+        default:
+            // NOTE: a Put() from the worker thread itself would wait forever
+            if (!this->multiProducer) {
+                // the worker can only make room if it gets the queued messages
+                if (!this->writeQueue.Empty()) {
+                    this->moveWriteToTransferQueue();
+                }
+                // notify under the lock, the worker checks transferPending
+                // before it goes to sleep, so it can't miss the wakeup
+                std::lock_guard<std::mutex> lock(this->wakeupMutex);
+                this->wakeup.notify_one();
+            }
+            this->monitor.waitForSpace();
+            return true;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+ThreadedQueue::dropOldestQueued() {
+    o_assert(this->isCreateThread());
+    Ptr<Message> msg;
+    this->transferQueueLock.lock();
+    if (!this->transferQueue.Empty()) {
+        msg = this->transferQueue.Dequeue();
+    }
+    this->transferQueueLock.unlock();
+    if (!msg && !this->writeQueue.Empty()) {
+        msg = this->writeQueue.Dequeue();
+    }
+    // if the worker has all messages already, it drops in dropOverflow()
+    if (msg) {
+        Metrics::Add(queueDepthMetric(), -1);
+        this->monitor.dropped(msg.get());
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+ThreadedQueue::dropOverflow() {
+    o_assert(this->isWorkerThread());
+    while (this->monitor.overfull()) {
+        int32 prio = 0;
+        while ((prio < Priority::NumPriorities) && this->readQueues[prio].Empty()) {
+            prio++;
+        }
+        if (prio == Priority::NumPriorities) {
+            break;
+        }
+        Ptr<Message> msg(std::move(this->readQueues[prio].Dequeue()));
+        Metrics::Add(queueDepthMetric(), -1);
+        this->monitor.dropped(msg.get());
+    }
+}
+
 //------------------------------------------------------------------------------
 void
 ThreadedQueue::DoWork() {
     // move messages to transfer queue and wake up thread
+    if (this->multiProducer) {
+        // messages are already visible to the worker
+        return;
+    }
     o_assert(this->isCreateThread());
     o_assert(this->threadStarted);
     o_assert(!this->threadStopped);
@@ -133,17 +311,101 @@ ThreadedQueue::moveWriteToTransferQueue() {
             this->transferQueue.Enqueue(std::move(this->writeQueue.Dequeue()));
         }
     }
+    this->transferPending.store(true, std::memory_order_relaxed);
     this->transferQueueLock.unlock();
 }
 
 //------------------------------------------------------------------------------
 void
-ThreadedQueue::moveTransferToReadQueue() {
+ThreadedQueue::moveTransferToReadQueues() {
     o_assert(this->isWorkerThread());
-    o_assert(this->readQueue.Empty());
     this->transferQueueLock.lock();
-    this->readQueue = std::move(this->transferQueue);
+    Queue<Ptr<Message>> transferred(std::move(this->transferQueue));
+    this->transferPending.store(false, std::memory_order_relaxed);
     this->transferQueueLock.unlock();
+    // sort into the read queues outside of the lock
+    while (!transferred.Empty()) {
+        Ptr<Message> msg(std::move(transferred.Dequeue()));
+        this->readQueues[msg->GetPriority()].Enqueue(std::move(msg));
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+ThreadedQueue::moveInboxToReadQueues() {
+    o_assert(this->isWorkerThread());
+    Ptr<Message> msg;
+    while (this->inbox.Pop(msg)) {
+        this->readQueues[msg->GetPriority()].Enqueue(std::move(msg));
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+ThreadedQueue::popReadQueues(Ptr<Message>& outMsg) {
+    o_assert(this->isWorkerThread());
+    if (Overflow::DropOldest == this->monitor.overflow) {
+        this->dropOverflow();
+    }
+    int32 prio = Priority::NumPriorities - 1;
+    while ((prio >= 0) && this->readQueues[prio].Empty()) {
+        prio--;
+    }
+    if (prio < 0) {
+        return false;
+    }
+    // a lower priority which has been overtaken too often goes first,
+    // otherwise all waiting lower priorities have been overtaken once more
+    int32 starved = InvalidIndex;
+    for (int32 p = 0; p < prio; p++) {
+        if (!this->readQueues[p].Empty() && (this->starvation[p] >= StarvationLimit)) {
+            starved = p;
+            break;
+        }
+    }
+    if (InvalidIndex != starved) {
+        prio = starved;
+    }
+    else {
+        for (int32 p = 0; p < prio; p++) {
+            if (!this->readQueues[p].Empty()) {
+                this->starvation[p]++;
+            }
+        }
+    }
+    this->starvation[prio] = 0;
+    outMsg = this->readQueues[prio].Dequeue();
+    this->monitor.dequeued(outMsg.get());
+    
+    // cancel the message if its deadline has passed while it was queued
+    const Clock::Ticks deadline = outMsg->GetDeadline();
+    if ((0 != deadline) && !outMsg->Cancelled() && (Clock::Now() > deadline)) {
+        outMsg->SetCancelled();
+        Metrics::Add(expiredMetric());
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+ThreadedQueue::waitInbox() {
+    o_assert(this->isWorkerThread());
+    if (!this->inbox.Empty()) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(this->wakeupMutex);
+    this->workerSleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto ready = [this]() {
+        return !this->inbox.Empty() || this->threadStopRequested;
+    };
+    if (0 != this->tickDuration) {
+        this->wakeup.wait_for(lock, std::chrono::milliseconds(this->tickDuration), ready);
+    }
+    else {
+        this->wakeup.wait(lock, ready);
+    }
+    this->workerSleeping.store(false, std::memory_order_relaxed);
 }
 
 //------------------------------------------------------------------------------
@@ -159,24 +421,55 @@ ThreadedQueue::threadFunc(ThreadedQueue* self) {
     // and forwards them to the forwardingPort
     while (!self->threadStopRequested) {
 
-        // wait for messages to arrive, and if so, transfer to read queue
-        std::unique_lock<std::mutex> lock(self->wakeupMutex);
-        if (0 != self->tickDuration) {
-            // wait with timeout
-            self->wakeup.wait_for(lock, std::chrono::milliseconds(self->tickDuration));
+        if (self->multiProducer) {
+            // wait for messages in the inbox
+            self->waitInbox();
+            self->moveInboxToReadQueues();
         }
         else {
-            // wait infinitely for messages
-            self->wakeup.wait(lock);
+            // wait for messages to arrive, and if so, transfer to read queues
+            std::unique_lock<std::mutex> lock(self->wakeupMutex);
+            if (self->threadStopRequested || self->transferPending.load(std::memory_order_relaxed)) {
+                // don't wait, StopThread() has already signalled, or messages are waiting
+            }
+            else if (0 != self->tickDuration) {
+                // wait with timeout
+                self->wakeup.wait_for(lock, std::chrono::milliseconds(self->tickDuration));
+            }
+            else {
+                // wait infinitely for messages
+                self->wakeup.wait(lock);
+            }
+            lock.unlock();
+            self->moveTransferToReadQueues();
         }
-        self->moveTransferToReadQueue();
-        lock.unlock();
         
-        // now process the messages, this happens without locking
-        while (!self->readQueue.Empty()) {
-            self->onMessage(std::move(self->readQueue.Dequeue()));
+        // now process the messages by priority, this happens without locking,
+        // new messages are picked up after each message so that they can
+        // overtake queued messages of lower priority
+        Ptr<Message> msg;
+        if (self->popReadQueues(msg)) {
+            o_prof_scope("ThreadedQueue::onMessage");
+            int32 numMessages = 0;
+            do {
+                self->onMessage(msg);
+                numMessages++;
+                if (self->multiProducer) {
+                    self->moveInboxToReadQueues();
+                }
+                else if (self->transferPending.load(std::memory_order_relaxed)) {
+                    self->moveTransferToReadQueues();
+                }
+            }
+            while (self->popReadQueues(msg));
+            msg = nullptr;
+            Metrics::Add(messagesMetric(), numMessages);
+            Metrics::Add(queueDepthMetric(), -numMessages);
+        }
+        {
+            o_prof_scope("ThreadedQueue::onTick");
+            self->onTick();
         }
-        self->onTick();
     }
     
     // notify subclass that we're about to leave the thread
@@ -191,6 +484,7 @@ ThreadedQueue::threadFunc(ThreadedQueue* self) {
 void
 ThreadedQueue::onThreadEnter() {
     Core::CoreFacade::EnterThread();
+    o_prof_thread_name("ThreadedQueue");
 }
 
 //------------------------------------------------------------------------------
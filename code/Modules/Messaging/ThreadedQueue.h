@@ -20,9 +20,47 @@
     process messages from the read queue without locking.  When the read queue
     is empty it will check the transfer queue for more messages, and if this
     is empty, go to sleep.
+    
+    In this default mode, Put() and DoWork() must be called from the thread
+    which created the queue, and messages only reach the worker thread
+    when DoWork() is called. Call SetMultiProducer(true) before StartThread()
+    to switch to a lock-free multi-producer inbox instead: Put() can then be
+    called from any thread (e.g. from another ThreadedQueue's worker), the
+    message is visible to the worker immediately, and DoWork() is not needed.
+    The worker only goes to sleep when the inbox is empty, and a Put() only
+    signals the condition variable (which costs a mutex and a syscall) when
+    the worker is actually sleeping.
+    
+    The read side has one queue per message priority (see Message::SetPriority()),
+    the worker handles higher priorities first, and checks for new messages
+    after each message, so that a high-priority message overtakes a backlog
+    of low-priority messages. To prevent starvation, a waiting lower-priority
+    message is handled after at most StarvationLimit higher-priority messages
+    have been handled. Messages which are still queued when their deadline
+    has passed are cancelled before they are forwarded.
+    
+    By default the queue is unbounded, so a stalled worker lets the queues
+    grow without limit. SetCapacity() limits the number of queued messages
+    (put but not yet forwarded), and sets what Put() does when the queue
+    is full: Overflow::Block waits until the worker has made room (must not
+    be called from the worker thread itself), Overflow::Reject returns false
+    without queueing the message (with Block and Reject the capacity also
+    holds for concurrent producers, which reserve their slot atomically), and Overflow::DropOldest cancels and drops
+    the oldest queued message. In the default mode the producer drops from
+    the messages which haven't reached the worker yet, in multi-producer
+    mode the worker drops the oldest messages of the lowest priority before
+    it forwards the next message (so the inbox is not bounded while the
+    worker is stuck in a message handler, use Block or Reject if that
+    matters). GetStats() returns the depth, high-water mark and latency
+    (Put() to forward) of the queue from any thread, SetMetricsName()
+    additionally publishes depth and latency as Core::Metrics.
 */
 #include "Messaging/Port.h"
+#include "Messaging/QueueStats.h"
+#include "Messaging/queueMonitor.h"
 #include "Core/Containers/Queue.h"
+#include "Core/Threading/mpscQueue.h"
+#include <atomic>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -33,6 +71,9 @@ namespace Messaging {
 class ThreadedQueue : public Port {
     OryolClassPoolAllocDecl(ThreadedQueue);
 public:
+    /// max number of higher-priority messages handled before a waiting lower-priority message
+    static const int32 StarvationLimit = 16;
+
     /// default constructor (must setup forwardingPort in subclass!)
     ThreadedQueue();
     /// constructor with forwarding port
@@ -44,6 +85,20 @@ public:
     void SetTickDuration(uint32 milliSecs);
     /// get optional tick-rate in millisecs
     uint32 GetTickDuration() const;
+    /// enable the multi-producer inbox (Put() from any thread), must be called before StartThread()
+    void SetMultiProducer(bool b);
+    /// return true if the multi-producer inbox is enabled
+    bool IsMultiProducer() const;
+    /// set max number of queued messages (0 is unbounded) and overflow policy, must be called before StartThread()
+    void SetCapacity(int32 capacity, Overflow::Code overflow = Overflow::Block);
+    /// get max number of queued messages, 0 if unbounded
+    int32 GetCapacity() const;
+    /// get the overflow policy
+    Overflow::Code GetOverflow() const;
+    /// publish depth and latency as metrics messaging.[name].*, must be called before StartThread()
+    void SetMetricsName(const char* name);
+    /// get queue statistics (any thread)
+    QueueStats GetStats() const;
     /// start the handler thread, this cannot happen in the constructor
     virtual void StartThread();
     /// stop the handler thread, this cannot happen in the destructor
@@ -70,14 +125,29 @@ protected:
     virtual void onThreadLeave();
     /// move messages from the write queue to the transfer queue
     void moveWriteToTransferQueue();
-    /// move messages from transfer queue to read queue
-    void moveTransferToReadQueue();
+    /// move messages from transfer queue to the read queues
+    void moveTransferToReadQueues();
+    /// move messages from the multi-producer inbox to the read queues
+    void moveInboxToReadQueues();
+    /// get the next message from the read queues by priority, return false if empty
+    bool popReadQueues(Core::Ptr<Message>& outMsg);
+    /// wait until the multi-producer inbox has messages (or tick/stop)
+    void waitInbox();
+    /// apply the overflow policy when the queue is full, return false to reject the message
+    bool makeRoom();
+    /// drop the oldest message which hasn't reached the worker yet (creation thread)
+    void dropOldestQueued();
+    /// drop the oldest lowest-priority messages from the read queues until within capacity
+    void dropOverflow();
     
     uint32 tickDuration;
     Core::Queue<Core::Ptr<Message>> writeQueue;     // written by sender thread
     Core::Queue<Core::Ptr<Message>> transferQueue;  // written by sender, read by worker thread (locked)
-    Core::Queue<Core::Ptr<Message>> readQueue;      // read by worker thread
+    Core::Queue<Core::Ptr<Message>> readQueues[Priority::NumPriorities];  // read by worker thread
+    int32 starvation[Priority::NumPriorities];      // how often a waiting priority has been overtaken
+    Core::mpscQueue<Core::Ptr<Message>> inbox;      // written by any thread, read by worker thread (multi-producer mode)
     Core::Ptr<Port> forwardingPort;                // runs in thread!
+    queueMonitor monitor;
 
     std::thread::id createThreadId;
     std::thread::id workThreadId;
@@ -85,8 +155,11 @@ protected:
     std::mutex transferQueueLock;
     std::mutex wakeupMutex;
     std::condition_variable wakeup;
+    std::atomic<bool> transferPending;
+    bool multiProducer;
+    std::atomic<bool> workerSleeping;
     bool threadStarted;
-    bool threadStopRequested;
+    std::atomic<bool> threadStopRequested;
     bool threadStopped;
 };
     
@@ -13,6 +13,40 @@ typedef uint32 ProtocolIdType;
 static const ProtocolIdType InvalidProtocolId = 0xFFFFFFFF;
 typedef int32 MessageIdType;
 static const MessageIdType InvalidMessageId = -1;
+
+/// message priorities, queues handle higher priorities first
+class Priority {
+public:
+    enum Code : uint8 {
+        Low = 0,        // e.g. prefetching
+        Normal,         // the default
+        High,           // e.g. the user is waiting for it
+        
+        NumPriorities,
+    };
+};
+
+/// what a bounded queue does when a message is put while it is full
+class Overflow {
+public:
+    enum Code : uint8 {
+        Block = 0,      // Put() waits until there is room
+        Reject,         // Put() returns false, the message is not queued
+        DropOldest,     // the oldest queued message is cancelled and dropped
+    };
+};
+
+/// how batches of encoded messages are compressed (see Compressor)
+class Compression {
+public:
+    enum Code : uint8 {
+        None = 0,       // not compressed
+        Deflate,        // zlib deflate, best ratio
+        Fast,           // LZ77 without entropy coding, much cheaper but less compact
+        
+        NumCodes,
+    };
+};
         
 } // namespace Messaging
 } // namespace Oryol
\ No newline at end of file
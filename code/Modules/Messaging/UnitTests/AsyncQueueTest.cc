@@ -52,3 +52,48 @@ TEST(AsyncQueueTest) {
     CHECK(val0 == 2);
     CHECK(val1 == 2);
 }
+
+TEST(AsyncQueueBoundedTest) {
+    Ptr<AsyncQueue> asyncQueue = AsyncQueue::Create();
+    Ptr<Dispatcher<TestProtocol>> dispatcher = Dispatcher<TestProtocol>::Create();
+    dispatcher->Subscribe<TestProtocol::TestMsg1>(&MsgHandler1);
+    asyncQueue->SetForwardingPort(dispatcher);
+    val0 = 0;
+    
+    // reject
+    asyncQueue->SetCapacity(2, Overflow::Reject);
+    CHECK(asyncQueue->Put(TestProtocol::TestMsg1::Create()));
+    CHECK(asyncQueue->Put(TestProtocol::TestMsg1::Create()));
+    CHECK(!asyncQueue->Put(TestProtocol::TestMsg1::Create()));
+    CHECK(asyncQueue->GetNumQueuedMessages() == 2);
+    asyncQueue->ForwardMessages();
+    CHECK(val0 == 2);
+    
+    // drop oldest
+    asyncQueue->SetCapacity(2, Overflow::DropOldest);
+    Ptr<TestProtocol::TestMsg1> oldest = TestProtocol::TestMsg1::Create();
+    CHECK(asyncQueue->Put(oldest));
+    CHECK(asyncQueue->Put(TestProtocol::TestMsg1::Create()));
+    CHECK(asyncQueue->Put(TestProtocol::TestMsg1::Create()));
+    CHECK(oldest->Cancelled());
+    CHECK(asyncQueue->GetNumQueuedMessages() == 2);
+    asyncQueue->ForwardMessages();
+    CHECK(val0 == 4);
+    
+    // block forwards the oldest message to make room
+    asyncQueue->SetCapacity(2, Overflow::Block);
+    CHECK(asyncQueue->Put(TestProtocol::TestMsg1::Create()));
+    CHECK(asyncQueue->Put(TestProtocol::TestMsg1::Create()));
+    CHECK(asyncQueue->Put(TestProtocol::TestMsg1::Create()));
+    CHECK(val0 == 5);
+    CHECK(asyncQueue->GetNumQueuedMessages() == 2);
+    asyncQueue->ForwardMessages();
+    
+    QueueStats stats = asyncQueue->GetStats();
+    CHECK(stats.Depth == 0);
+    CHECK(stats.HighWater == 2);
+    CHECK(stats.NumEnqueued == 8);
+    CHECK(stats.NumDequeued == 7);
+    CHECK(stats.NumRejected == 1);
+    CHECK(stats.NumDropped == 1);
+}
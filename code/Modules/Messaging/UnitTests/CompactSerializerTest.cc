@@ -0,0 +1,283 @@
+//------------------------------------------------------------------------------
+//  CompactSerializerTest.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Messaging/CompactSerializer.h"
+#include "TestProtocol.h"
+#include "TestProtocol2.h"
+#include "TestProtocolV2.h"
+#include "Core/Time/Clock.h"
+#include "Core/Memory/Memory.h"
+
+using namespace Oryol;
+using namespace Oryol::Core;
+using namespace Oryol::Messaging;
+
+//------------------------------------------------------------------------------
+TEST(CompactVarintTest) {
+    CHECK(CompactSerializer::VarintSize(0) == 1);
+    CHECK(CompactSerializer::VarintSize(127) == 1);
+    CHECK(CompactSerializer::VarintSize(128) == 2);
+    CHECK(CompactSerializer::VarintSize(16383) == 2);
+    CHECK(CompactSerializer::VarintSize(16384) == 3);
+    CHECK(CompactSerializer::VarintSize(0xFFFFFFFFFFFFFFFFULL) == 10);
+    
+    CHECK(CompactSerializer::ZigZag(0) == 0);
+    CHECK(CompactSerializer::ZigZag(-1) == 1);
+    CHECK(CompactSerializer::ZigZag(1) == 2);
+    CHECK(CompactSerializer::ZigZag(-2) == 3);
+    CHECK(CompactSerializer::UnZigZag(CompactSerializer::ZigZag(-1234567)) == -1234567);
+    CHECK(CompactSerializer::UnZigZag(CompactSerializer::ZigZag(0x7FFFFFFFFFFFFFFFLL)) == 0x7FFFFFFFFFFFFFFFLL);
+    CHECK(CompactSerializer::UnZigZag(CompactSerializer::ZigZag(-0x7FFFFFFFFFFFFFFFLL - 1)) == -0x7FFFFFFFFFFFFFFFLL - 1);
+    
+    uint8 buf[16];
+    uint64 val = 0;
+    CHECK(CompactSerializer::EncodeVarint(300, buf, buf + sizeof(buf)) == buf + 2);
+    CHECK(buf[0] == 0xAC);
+    CHECK(buf[1] == 0x02);
+    CHECK(CompactSerializer::DecodeVarint(buf, buf + 2, val) == buf + 2);
+    CHECK(val == 300);
+    CHECK(CompactSerializer::DecodeVarint(buf, buf + 1, val) == nullptr);
+    CHECK(CompactSerializer::EncodeVarint(300, buf, buf + 1) == nullptr);
+    CHECK(CompactSerializer::EncodeVarint(0xFFFFFFFFFFFFFFFFULL, buf, buf + sizeof(buf)) == buf + 10);
+    CHECK(CompactSerializer::DecodeVarint(buf, buf + sizeof(buf), val) == buf + 10);
+    CHECK(val == 0xFFFFFFFFFFFFFFFFULL);
+}
+
+//------------------------------------------------------------------------------
+TEST(CompactMessageTest) {
+    // attributes with default values are left out
+    Ptr<TestProtocol::TestMsg1> msg1 = TestProtocol::TestMsg1::Create();
+    CHECK(msg1->CompactEncodedSize() == 1);
+    msg1->SetInt8Val(-1);
+    msg1->SetInt64Val(50);
+    msg1->SetFloat32Val(1.5f);
+    // 3 fields with 1 byte key: varint, varint, fixed32
+    CHECK(msg1->CompactEncodedSize() == 1 + (1 + 1) + (1 + 1) + (1 + 4));
+    
+    // a message with header
+    Ptr<TestProtocol::TestMsg2> msg2 = TestProtocol::TestMsg2::Create();
+    msg2->SetInt16Val(-300);
+    msg2->SetUInt64Val(0xFFFFFFFFFFFFFFFFULL);
+    msg2->SetFloat64Val(-2.25);
+    msg2->SetStringVal("Hello World");
+    msg2->SetStringAtomVal("Bla");
+    uint8 buf[256];
+    const int32 size = CompactSerializer::EncodedMessageSize(msg2);
+    CHECK(size < msg2->EncodedSize());
+    CHECK(CompactSerializer::EncodeMessage<TestProtocol>(msg2, buf, buf + size - 1) == nullptr);
+    CHECK(CompactSerializer::EncodeMessage<TestProtocol>(msg2, buf, buf + sizeof(buf)) == buf + size);
+    Ptr<Message> decoded;
+    CHECK(CompactSerializer::DecodeMessage<TestProtocol>(buf, buf + size - 1, decoded) == nullptr);
+    CHECK(CompactSerializer::DecodeMessage<TestProtocol>(buf, buf + size, decoded) == buf + size);
+    Ptr<TestProtocol::TestMsg2> decoded2 = MessageCast<TestProtocol::TestMsg2>(decoded);
+    CHECK(decoded2.isValid());
+    CHECK(decoded2->GetInt8Val() == 0);
+    CHECK(decoded2->GetInt16Val() == -300);
+    CHECK(decoded2->GetUInt64Val() == 0xFFFFFFFFFFFFFFFFULL);
+    CHECK(decoded2->GetFloat32Val() == 123.0f);
+    CHECK(decoded2->GetFloat64Val() == -2.25);
+    CHECK(decoded2->GetStringVal() == "Hello World");
+    CHECK(decoded2->GetStringAtomVal() == "Bla");
+    
+    // a child protocol decodes messages of its parent protocol
+    CHECK(TestProtocol2::GetWireId(TestProtocol::MessageId::TestMsg2Id) == TestProtocol::GetWireId(TestProtocol::MessageId::TestMsg2Id));
+    CHECK(TestProtocol2::FindMessageId(TestProtocol::GetWireId(TestProtocol::MessageId::TestMsg2Id)) == TestProtocol::MessageId::TestMsg2Id);
+    CHECK(TestProtocol::FindMessageId(TestProtocol2::GetWireId(TestProtocol2::MessageId::TestMsgExId)) == InvalidMessageId);
+    CHECK(CompactSerializer::DecodeMessage<TestProtocol2>(buf, buf + size, decoded) == buf + size);
+    CHECK(MessageCast<TestProtocol::TestMsg2>(decoded)->GetStringVal() == "Hello World");
+    
+    // a later build with a message class added in front (all message ids
+    // have moved) decodes data written before, but not the other way around
+    CHECK(TestProtocolV2::MessageId::TestMsg2Id != TestProtocol::MessageId::TestMsg2Id);
+    CHECK(CompactSerializer::DecodeMessage<TestProtocolV2>(buf, buf + size, decoded) == buf + size);
+    Ptr<TestProtocolV2::TestMsg2> decodedV2 = MessageCast<TestProtocolV2::TestMsg2>(decoded);
+    CHECK(decodedV2.isValid());
+    CHECK(decodedV2->GetInt16Val() == -300);
+    CHECK(decodedV2->GetStringVal() == "Hello World");
+    CHECK(decodedV2->GetStringAtomVal() == "Bla");
+    Ptr<TestProtocolV2::TestStatusMsg> statusMsg = TestProtocolV2::TestStatusMsg::Create();
+    statusMsg->SetStatus(3);
+    const int32 statusSize = CompactSerializer::EncodedMessageSize(statusMsg);
+    CHECK(CompactSerializer::EncodeMessage<TestProtocolV2>(statusMsg, buf, buf + sizeof(buf)) == buf + statusSize);
+    CHECK(CompactSerializer::DecodeMessage<TestProtocol>(buf, buf + statusSize, decoded) == nullptr);
+    CHECK(CompactSerializer::DecodeMessage<TestProtocolV2>(buf, buf + statusSize, decoded) == buf + statusSize);
+    CHECK(MessageCast<TestProtocolV2::TestStatusMsg>(decoded)->GetStatus() == 3);
+    
+    Ptr<TestProtocol2::TestMsgEx> msgEx = TestProtocol2::TestMsgEx::Create();
+    msgEx->SetInt32Val(-5);
+    msgEx->SetExVal2(7);
+    const int32 exSize = CompactSerializer::EncodedMessageSize(msgEx);
+    CHECK(CompactSerializer::EncodeMessage<TestProtocol2>(msgEx, buf, buf + sizeof(buf)) == buf + exSize);
+    CHECK(CompactSerializer::DecodeMessage<TestProtocol2>(buf, buf + exSize, decoded) == buf + exSize);
+    CHECK(decoded->MessageId() == TestProtocol2::MessageId::TestMsgExId);
+    CHECK(MessageCast<TestProtocol2::TestMsgEx>(decoded)->GetExVal2() == 7);
+    CHECK(MessageCast<TestProtocol::TestMsg1>(decoded)->GetInt32Val() == -5);
+    
+    // the parent class attributes come first, so a TestMsgEx can be
+    // decoded as a TestMsg1
+    const int32 bodySize = msgEx->CompactEncodedSize();
+    CHECK(msgEx->EncodeCompact(buf, buf + sizeof(buf)) == buf + bodySize);
+    Ptr<TestProtocol::TestMsg1> asMsg1 = TestProtocol::TestMsg1::Create();
+    CHECK(asMsg1->DecodeCompact(buf, buf + bodySize) == buf + asMsg1->CompactEncodedSize());
+    CHECK(asMsg1->GetInt32Val() == -5);
+    
+    // arrays and views
+    Ptr<TestProtocol::TestArrayMsg> arrayMsg = TestProtocol::TestArrayMsg::Create();
+    Array<int32> ints;
+    ints.AddBack(1);
+    ints.AddBack(-1);
+    ints.AddBack(100000);
+    Array<String> strings;
+    strings.AddBack("One");
+    strings.AddBack("Two");
+    arrayMsg->SetInt32ArrayVal(ints);
+    arrayMsg->SetStringArrayVal(strings);
+    const int32 arraySize = arrayMsg->CompactEncodedSize();
+    CHECK(arrayMsg->EncodeCompact(buf, buf + sizeof(buf)) == buf + arraySize);
+    Ptr<TestProtocol::TestArrayMsg> decodedArrayMsg = TestProtocol::TestArrayMsg::Create();
+    CHECK(decodedArrayMsg->DecodeCompact(buf, buf + arraySize) == buf + arraySize);
+    CHECK(decodedArrayMsg->GetInt32ArrayVal().Size() == 3);
+    CHECK(decodedArrayMsg->GetInt32ArrayVal()[1] == -1);
+    CHECK(decodedArrayMsg->GetInt32ArrayVal()[2] == 100000);
+    CHECK(decodedArrayMsg->GetStringArrayVal().Size() == 2);
+    CHECK(decodedArrayMsg->GetStringArrayVal()[1] == "Two");
+    
+    Ptr<TestProtocol::TestViewMsg> viewMsg = TestProtocol::TestViewMsg::Create();
+    viewMsg->SetName(String("abc"));
+    Array<float32> samples;
+    samples.AddBack(1.0f);
+    samples.AddBack(2.0f);
+    viewMsg->SetSamples(samples);
+    const int32 viewSize = viewMsg->CompactEncodedSize();
+    CHECK(viewMsg->EncodeCompact(buf, buf + sizeof(buf)) == buf + viewSize);
+    Ptr<TestProtocol::TestViewMsg> decodedViewMsg = TestProtocol::TestViewMsg::Create();
+    CHECK(decodedViewMsg->DecodeCompact(buf, buf + viewSize) == buf + viewSize);
+    CHECK(decodedViewMsg->GetName().ToString() == "abc");
+    CHECK(decodedViewMsg->GetPayload().Empty());
+    CHECK(decodedViewMsg->GetSamples()[1] == 2.0f);
+}
+
+//------------------------------------------------------------------------------
+TEST(CompactSchemaChangeTest) {
+    // a TestMsg1 group from a newer version with unknown fields, and
+    // a field which has changed its type
+    uint8 buf[64];
+    uint8* ptr = buf + 1;
+    ptr = CompactSerializer::EncodeField<int32>(20, 12345, ptr, buf + sizeof(buf));
+    ptr = CompactSerializer::EncodeField<String>(21, String("new"), ptr, buf + sizeof(buf));
+    ptr = CompactSerializer::EncodeField<float64>(22, 1.0, ptr, buf + sizeof(buf));
+    ptr = CompactSerializer::EncodeField<int32>(3, -32, ptr, buf + sizeof(buf));
+    ptr = CompactSerializer::EncodeField<String>(4, String("was int64"), ptr, buf + sizeof(buf));
+    CHECK(nullptr != ptr);
+    buf[0] = uint8(ptr - (buf + 1));
+    
+    Ptr<TestProtocol::TestMsg1> msg = TestProtocol::TestMsg1::Create();
+    msg->SetInt64Val(64);
+    CHECK(msg->DecodeCompact(buf, ptr) == ptr);
+    CHECK(msg->GetInt32Val() == -32);
+    CHECK(msg->GetInt64Val() == 0);
+    CHECK(msg->GetInt16Val() == -1);
+    CHECK(msg->GetFloat32Val() == 123.0f);
+    
+    // truncated data
+    CHECK(msg->DecodeCompact(buf, ptr - 1) == nullptr);
+}
+
+//------------------------------------------------------------------------------
+TEST(CompactSerializeBenchmark) {
+    // a mix of messages with mostly small values, as in game state updates
+    const int32 numMsgs = 30000;
+    Array<Ptr<Message>> msgs;
+    msgs.Reserve(numMsgs);
+    Array<String> items;
+    items.AddBack("sword");
+    items.AddBack("shield");
+    for (int32 i = 0; i < numMsgs; i++) {
+        const int32 kind = i % 20;
+        if (kind < 12) {
+            Ptr<TestProtocol::TestMsg1> msg = TestProtocol::TestMsg1::Create();
+            msg->SetInt32Val(i);
+            msg->SetUInt8Val(uint8(i % 4));
+            msg->SetInt16Val(int16(i % 200) - 100);
+            msg->SetFloat32Val(float32(i) * 0.5f);
+            msgs.AddBack(msg);
+        }
+        else if (kind < 17) {
+            Ptr<TestProtocol::TestMsg2> msg = TestProtocol::TestMsg2::Create();
+            msg->SetInt32Val(i);
+            msg->SetFloat64Val(float64(i) * 0.25);
+            msg->SetStringVal("player_name");
+            msg->SetStringAtomVal("chat");
+            msgs.AddBack(msg);
+        }
+        else {
+            Ptr<TestProtocol::TestArrayMsg> msg = TestProtocol::TestArrayMsg::Create();
+            Array<int32> ints;
+            for (int32 j = 0; j < 16; j++) {
+                ints.AddBack(j * 10 - 50);
+            }
+            msg->SetInt32ArrayVal(ints);
+            msg->SetStringArrayVal(items);
+            msgs.AddBack(msg);
+        }
+    }
+    // decode targets, one per message class
+    Ptr<Message> targets[3] = {
+        TestProtocol::TestMsg1::Create(),
+        TestProtocol::TestMsg2::Create(),
+        TestProtocol::TestArrayMsg::Create()
+    };
+    
+    int32 rawSize = 0;
+    int32 compactSize = 0;
+    for (const auto& msg : msgs) {
+        rawSize += msg->EncodedSize();
+        compactSize += msg->CompactEncodedSize();
+    }
+    uint8* rawBuf = (uint8*) Memory::Alloc(rawSize);
+    uint8* compactBuf = (uint8*) Memory::Alloc(compactSize);
+    
+    Clock::Ticks start = Clock::Now();
+    uint8* dstPtr = rawBuf;
+    for (const auto& msg : msgs) {
+        dstPtr = msg->Encode(dstPtr, rawBuf + rawSize);
+    }
+    const Clock::Ticks rawEncode = Clock::Since(start);
+    CHECK(dstPtr == rawBuf + rawSize);
+    start = Clock::Now();
+    dstPtr = compactBuf;
+    for (const auto& msg : msgs) {
+        dstPtr = msg->EncodeCompact(dstPtr, compactBuf + compactSize);
+    }
+    const Clock::Ticks compactEncode = Clock::Since(start);
+    CHECK(dstPtr == compactBuf + compactSize);
+    
+    start = Clock::Now();
+    const uint8* srcPtr = rawBuf;
+    for (int32 i = 0; i < numMsgs; i++) {
+        const int32 kind = i % 20;
+        srcPtr = targets[kind < 12 ? 0 : (kind < 17 ? 1 : 2)]->Decode(srcPtr, rawBuf + rawSize);
+    }
+    const Clock::Ticks rawDecode = Clock::Since(start);
+    CHECK(srcPtr == rawBuf + rawSize);
+    start = Clock::Now();
+    srcPtr = compactBuf;
+    for (int32 i = 0; i < numMsgs; i++) {
+        const int32 kind = i % 20;
+        srcPtr = targets[kind < 12 ? 0 : (kind < 17 ? 1 : 2)]->DecodeCompact(srcPtr, compactBuf + compactSize);
+    }
+    const Clock::Ticks compactDecode = Clock::Since(start);
+    CHECK(srcPtr == compactBuf + compactSize);
+    
+    Log::Info("Compact encoding (%d mixed msgs): raw %d bytes, compact %d bytes (%.1f%%)\n",
+        numMsgs, rawSize, compactSize, (100.0 * compactSize) / rawSize);
+    Log::Info("    encode: raw %.1f ns/msg, compact %.1f ns/msg, decode: raw %.1f ns/msg, compact %.1f ns/msg\n",
+        Clock::ToSeconds(rawEncode) * 1e9 / numMsgs, Clock::ToSeconds(compactEncode) * 1e9 / numMsgs,
+        Clock::ToSeconds(rawDecode) * 1e9 / numMsgs, Clock::ToSeconds(compactDecode) * 1e9 / numMsgs);
+    CHECK(compactSize < rawSize);
+    
+    Memory::Free(rawBuf);
+    Memory::Free(compactBuf);
+}
@@ -0,0 +1,200 @@
+//------------------------------------------------------------------------------
+//  CompressorTest.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Messaging/Compressor.h"
+#include "TestProtocol.h"
+#include "Core/Log.h"
+#include "Core/Time/Clock.h"
+#include "Core/Memory/Memory.h"
+
+using namespace Oryol;
+using namespace Oryol::Core;
+using namespace Oryol::Messaging;
+
+// encode a game-like stream of messages, each with a 4-byte size
+static int32 encodeStream(int32 firstMsg, int32 numMsgs, uint8* dst, int32 dstSize) {
+    Ptr<TestProtocol::TestMsg2> msg = TestProtocol::TestMsg2::Create();
+    msg->SetStringAtomVal("move");
+    uint8* dstPtr = dst;
+    for (int32 i = firstMsg; i < firstMsg + numMsgs; i++) {
+        msg->SetInt32Val(i);
+        msg->SetFloat32Val(float32(i & 1023) * 0.25f);
+        msg->SetStringVal((i % 3) ? "player" : "enemy");
+        const int32 size = CompactSerializer::EncodedMessageSize(msg);
+        if ((dstPtr + 4 + size) > (dst + dstSize)) {
+            break;
+        }
+        Memory::Copy(&size, dstPtr, 4);
+        dstPtr = CompactSerializer::EncodeMessage<TestProtocol>(msg, dstPtr + 4, dstPtr + 4 + size);
+    }
+    return int32(dstPtr - dst);
+}
+
+//------------------------------------------------------------------------------
+TEST(CompressorTest) {
+    const int32 bufSize = 256 * 1024;
+    uint8* raw = (uint8*) Memory::Alloc(bufSize);
+    uint8* packed = (uint8*) Memory::Alloc(Compressor::MaxCompressedSize(bufSize));
+    uint8* unpacked = (uint8*) Memory::Alloc(bufSize);
+    const int32 rawSize = encodeStream(0, 5000, raw, bufSize);
+    CHECK(rawSize > 100000);
+    
+    // round trips with all codecs, with and without dictionary
+    const Compression::Code codecs[] = { Compression::None, Compression::Fast, Compression::Deflate };
+    for (int32 useDict = 0; useDict < 2; useDict++) {
+        for (Compression::Code codec : codecs) {
+            Compressor tx;
+            Compressor rx;
+            tx.Setup(codec);
+            if (useDict) {
+                tx.SetProtocolDictionary<TestProtocol>();
+                rx.SetProtocolDictionary<TestProtocol>();
+                CHECK(tx.GetDictionaryHash() == rx.GetDictionaryHash());
+                CHECK(tx.GetDictionaryHash() != 0);
+            }
+            const int32 packedSize = tx.Compress(raw, rawSize, packed, Compressor::MaxCompressedSize(rawSize));
+            CHECK(packedSize > 0);
+            if (Compression::None == codec) {
+                CHECK(packedSize == rawSize);
+            }
+            else {
+                CHECK(packedSize < rawSize / 2);
+            }
+            Memory::Clear(unpacked, rawSize);
+            CHECK(rx.Decompress(codec, packed, packedSize, unpacked, rawSize));
+            CHECK(0 == memcmp(raw, unpacked, rawSize));
+            CHECK(tx.GetCompressStats().NumBatches == 1);
+            CHECK(tx.GetCompressStats().RawBytes == rawSize);
+            CHECK(tx.GetCompressStats().PackedBytes == packedSize);
+            CHECK(rx.GetDecompressStats().RawBytes == rawSize);
+            
+            // a tiny batch, and an empty one
+            const int32 smallSize = encodeStream(7, 1, raw, bufSize);
+            const int32 smallPacked = tx.Compress(raw, smallSize, packed, Compressor::MaxCompressedSize(smallSize));
+            CHECK(smallPacked > 0);
+            CHECK(rx.Decompress(codec, packed, smallPacked, unpacked, smallSize));
+            CHECK(0 == memcmp(raw, unpacked, smallSize));
+            const int32 emptyPacked = tx.Compress(raw, 0, packed, Compressor::MaxCompressedSize(0));
+            CHECK((Compression::None == codec) ? (0 == emptyPacked) : (emptyPacked > 0));
+            // empty input from a peer must not trap
+            CHECK(rx.Decompress(codec, nullptr, 0, nullptr, 0) == (Compression::None == codec));
+            encodeStream(0, 5000, raw, bufSize);
+        }
+    }
+    
+    // the dictionary makes a small batch smaller
+    const int32 smallSize = encodeStream(100, 4, raw, bufSize);
+    for (Compression::Code codec : { Compression::Fast, Compression::Deflate }) {
+        Compressor plain;
+        plain.Setup(codec);
+        Compressor primed;
+        primed.Setup(codec);
+        primed.SetProtocolDictionary<TestProtocol>();
+        const int32 plainSize = plain.Compress(raw, smallSize, packed, Compressor::MaxCompressedSize(smallSize));
+        const int32 primedSize = primed.Compress(raw, smallSize, packed, Compressor::MaxCompressedSize(smallSize));
+        CHECK(primedSize < plainSize);
+    }
+    
+    // a streaming deflate compressor needs one decompressor which gets all batches in order
+    Compressor tx;
+    tx.Setup(Compression::Deflate, 6, true);
+    tx.SetProtocolDictionary<TestProtocol>();
+    Compressor rx;
+    rx.Setup(Compression::None, Compressor::DefaultLevel, true);
+    rx.SetProtocolDictionary<TestProtocol>();
+    int32 totalPacked = 0;
+    bool allValid = true;
+    for (int32 i = 0; i < 100; i++) {
+        const int32 batchSize = encodeStream(i * 4, 4, raw, bufSize);
+        const int32 packedSize = tx.Compress(raw, batchSize, packed, Compressor::MaxCompressedSize(batchSize));
+        allValid &= packedSize > 0;
+        allValid &= rx.Decompress(Compression::Deflate, packed, packedSize, unpacked, batchSize);
+        allValid &= 0 == memcmp(raw, unpacked, batchSize);
+        totalPacked += packedSize;
+    }
+    CHECK(allValid);
+    Compressor independent;
+    independent.Setup(Compression::Deflate, 6, false);
+    independent.SetProtocolDictionary<TestProtocol>();
+    int32 totalIndependent = 0;
+    for (int32 i = 0; i < 100; i++) {
+        const int32 batchSize = encodeStream(i * 4, 4, raw, bufSize);
+        totalIndependent += independent.Compress(raw, batchSize, packed, Compressor::MaxCompressedSize(batchSize));
+    }
+    CHECK(totalPacked < totalIndependent);
+    
+    // corrupt and truncated data is detected
+    const int32 bigSize = encodeStream(0, 5000, raw, bufSize);
+    for (Compression::Code codec : { Compression::Fast, Compression::Deflate }) {
+        Compressor c;
+        c.Setup(codec);
+        const int32 packedSize = c.Compress(raw, bigSize, packed, Compressor::MaxCompressedSize(bigSize));
+        CHECK(!c.Decompress(codec, packed, packedSize / 2, unpacked, bigSize));
+        CHECK(!c.Decompress(codec, packed, packedSize, unpacked, bigSize - 1));
+        CHECK(c.Decompress(codec, packed, packedSize, unpacked, bigSize));
+        CHECK(0 == c.Compress(raw, bigSize, packed, 100));
+    }
+    CHECK(!tx.Decompress(Compression::None, raw, 10, unpacked, 11));
+    
+    Memory::Free(raw);
+    Memory::Free(packed);
+    Memory::Free(unpacked);
+}
+
+//------------------------------------------------------------------------------
+TEST(CompressorBenchmark) {
+    // compression ratio and speed of batches of different sizes
+    const int32 bufSize = 64 * 1024;
+    uint8* raw = (uint8*) Memory::Alloc(bufSize);
+    uint8* packed = (uint8*) Memory::Alloc(Compressor::MaxCompressedSize(bufSize));
+    uint8* unpacked = (uint8*) Memory::Alloc(bufSize);
+    struct setting {
+        Compression::Code codec;
+        int32 level;
+        bool streaming;
+        const char* name;
+    };
+    const setting settings[] = {
+        { Compression::Fast, 1, false, "fast" },
+        { Compression::Deflate, 1, false, "deflate 1" },
+        { Compression::Deflate, 1, true, "deflate 1 stream" },
+        { Compression::Deflate, 6, false, "deflate 6" },
+        { Compression::Deflate, 9, false, "deflate 9" },
+    };
+    const int32 batchMsgs[] = { 1, 16, 2000 };
+    for (int32 numMsgs : batchMsgs) {
+        // single messages are slow to compress, so there are less of them
+        const int64 bytesPerRun = (numMsgs > 1 ? 4096 : 256) * 1024;
+        for (const setting& s : settings) {
+            for (int32 useDict = 0; useDict < 2; useDict++) {
+                Compressor tx;
+                Compressor rx;
+                tx.Setup(s.codec, s.level, s.streaming);
+                rx.Setup(s.codec, s.level, s.streaming);
+                if (useDict) {
+                    tx.SetProtocolDictionary<TestProtocol>();
+                    rx.SetProtocolDictionary<TestProtocol>();
+                }
+                bool allValid = true;
+                for (int32 first = 0; tx.GetCompressStats().RawBytes < bytesPerRun; first += numMsgs) {
+                    const int32 rawSize = encodeStream(first, numMsgs, raw, bufSize);
+                    const int32 packedSize = tx.Compress(raw, rawSize, packed, Compressor::MaxCompressedSize(rawSize));
+                    allValid &= rx.Decompress(s.codec, packed, packedSize, unpacked, rawSize);
+                }
+                CHECK(allValid);
+                const Compressor::Stats& cs = tx.GetCompressStats();
+                const Compressor::Stats& ds = rx.GetDecompressStats();
+                const float64 mb = float64(cs.RawBytes) / (1024.0 * 1024.0);
+                Log::Info("Compressor %4d msgs/batch %-16s %s: ratio %5.2f, compress %7.1f MB/s, decompress %7.1f MB/s\n",
+                    numMsgs, s.name, useDict ? "dict   " : "no dict",
+                    float64(cs.RawBytes) / float64(cs.PackedBytes),
+                    mb / Clock::ToSeconds(cs.Time), mb / Clock::ToSeconds(ds.Time));
+            }
+        }
+    }
+    Memory::Free(raw);
+    Memory::Free(packed);
+    Memory::Free(unpacked);
+}
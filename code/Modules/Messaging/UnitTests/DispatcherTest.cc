@@ -7,6 +7,8 @@
 #include "Messaging/Broadcaster.h"
 #include "TestProtocol.h"
 #include "TestProtocol2.h"
+#include "Core/Time/Clock.h"
+#include "Core/Containers/Array.h"
 
 using namespace Oryol;
 using namespace Oryol::Core;
@@ -76,3 +78,144 @@ TEST(DispatcherTest) {
 }
 
 
+
+// a visitor which records the class of the visited message
+struct RecordVisitor {
+    MessageIdType visited = InvalidMessageId;
+    template<class MSG> void operator()(const Ptr<MSG>& msg) {
+        this->visited = MSG::ClassMessageId();
+    };
+};
+
+TEST(ProtocolTypeCheckTest) {
+    Ptr<Message> msg1 = TestProtocol::TestMsg1::Create();
+    Ptr<Message> msg2 = TestProtocol::TestMsg2::Create();
+    Ptr<Message> arrayMsg = TestProtocol::TestArrayMsg::Create();
+    Ptr<Message> msgEx = TestProtocol2::TestMsgEx::Create();
+    
+    CHECK(msg1->ProtocolId() == TestProtocol::GetProtocolId());
+    CHECK(msgEx->ProtocolId() == TestProtocol2::GetProtocolId());
+    CHECK(TestProtocol::MessageId::FirstMessageId == 0);
+    CHECK(MessageIdType(TestProtocol2::MessageId::FirstMessageId) == MessageIdType(TestProtocol::MessageId::NumMessageIds));
+    CHECK(TestProtocol2::HasProtocol(TestProtocol::GetProtocolId()));
+    CHECK(TestProtocol2::HasProtocol(TestProtocol2::GetProtocolId()));
+    CHECK(!TestProtocol::HasProtocol(TestProtocol2::GetProtocolId()));
+    
+    // TestMsg2 is derived from TestMsg1
+    CHECK(TestProtocol::TestMsg1::DerivedMask == 0x3);
+    CHECK(TestProtocol::TestMsg2::DerivedMask == 0x2);
+    CHECK(TestProtocol::TestArrayMsg::DerivedMask == 0x4);
+    CHECK(TestProtocol::TestMsg1::IsA(msg1.get()));
+    CHECK(TestProtocol::TestMsg1::IsA(msg2.get()));
+    CHECK(!TestProtocol::TestMsg2::IsA(msg1.get()));
+    CHECK(!TestProtocol::TestMsg1::IsA(arrayMsg.get()));
+    CHECK(!TestProtocol2::TestMsgEx::IsA(msg1.get()));
+    // derived from TestMsg1 in another protocol
+    CHECK(TestProtocol::TestMsg1::IsA(msgEx.get()));
+    
+    CHECK(MessageCast<TestProtocol::TestMsg1>(msg2).isValid());
+    CHECK(!MessageCast<TestProtocol::TestMsg2>(msg1).isValid());
+    CHECK(!MessageCast<TestProtocol::TestMsg2>(Ptr<Message>()).isValid());
+    
+    // visit with the concrete class, parent protocol messages are
+    // visited by derived protocols
+    RecordVisitor visitor;
+    CHECK(TestProtocol::Visit(msg2, visitor));
+    CHECK(visitor.visited == TestProtocol::MessageId::TestMsg2Id);
+    CHECK(!TestProtocol::Visit(msgEx, visitor));
+    CHECK(TestProtocol2::Visit(msgEx, visitor));
+    CHECK(visitor.visited == TestProtocol2::MessageId::TestMsgExId);
+    CHECK(TestProtocol2::Visit(arrayMsg, visitor));
+    CHECK(visitor.visited == TestProtocol::MessageId::TestArrayMsgId);
+}
+
+// dispatch benchmark handlers
+static int32 benchCount1 = 0;
+static int32 benchCount2 = 0;
+static void BenchHandler1(const Ptr<TestProtocol::TestMsg1>& msg) {
+    benchCount1++;
+}
+static void BenchHandler2(const Ptr<TestProtocol::TestMsg2>& msg) {
+    benchCount2++;
+}
+struct BenchVisitor {
+    void operator()(const Ptr<TestProtocol::TestMsg1>& msg) {
+        BenchHandler1(msg);
+    };
+    void operator()(const Ptr<TestProtocol::TestMsg2>& msg) {
+        BenchHandler2(msg);
+    };
+    template<class MSG> void operator()(const Ptr<MSG>& msg) {
+        // ignore all others
+    };
+};
+
+TEST(DispatchBenchmark) {
+    const int32 numMsgs = 64;
+    const int32 numRounds = 10000;
+    Array<Ptr<Message>> msgs;
+    for (int32 i = 0; i < numMsgs; i++) {
+        if (i & 1) {
+            msgs.AddBack(TestProtocol::TestMsg2::Create());
+        }
+        else {
+            msgs.AddBack(TestProtocol::TestMsg1::Create());
+        }
+    }
+    const int32 total = numMsgs * numRounds;
+    
+    // routing: Ptr::dynamicCast vs. generated IsA()
+    int32 numRouted = 0;
+    Clock::Ticks start = Clock::Now();
+    for (int32 round = 0; round < numRounds; round++) {
+        for (const auto& msg : msgs) {
+            if (msg.dynamicCast<TestProtocol::TestMsg2>().isValid()) {
+                numRouted++;
+            }
+        }
+    }
+    const Clock::Ticks dynamicCastTime = Clock::Since(start);
+    CHECK(numRouted == total / 2);
+    numRouted = 0;
+    start = Clock::Now();
+    for (int32 round = 0; round < numRounds; round++) {
+        for (const auto& msg : msgs) {
+            if (TestProtocol::TestMsg2::IsA(msg.get())) {
+                numRouted++;
+            }
+        }
+    }
+    const Clock::Ticks isATime = Clock::Since(start);
+    CHECK(numRouted == total / 2);
+    
+    // dispatch: Dispatcher (membership check + std::function jump table) vs. Visit()
+    Ptr<Dispatcher<TestProtocol>> disp = Dispatcher<TestProtocol>::Create();
+    disp->Subscribe<TestProtocol::TestMsg1>(&BenchHandler1);
+    disp->Subscribe<TestProtocol::TestMsg2>(&BenchHandler2);
+    benchCount1 = benchCount2 = 0;
+    start = Clock::Now();
+    for (int32 round = 0; round < numRounds; round++) {
+        for (const auto& msg : msgs) {
+            disp->Put(msg);
+        }
+    }
+    const Clock::Ticks dispatcherTime = Clock::Since(start);
+    CHECK(benchCount1 + benchCount2 == total);
+    benchCount1 = benchCount2 = 0;
+    BenchVisitor visitor;
+    start = Clock::Now();
+    for (int32 round = 0; round < numRounds; round++) {
+        for (const auto& msg : msgs) {
+            TestProtocol::Visit(msg, visitor);
+        }
+    }
+    const Clock::Ticks visitTime = Clock::Since(start);
+    CHECK(benchCount1 + benchCount2 == total);
+    
+    Log::Info("Dispatch (%d msgs): dynamicCast %.2fns, IsA %.2fns, Dispatcher::Put %.2fns, Visit %.2fns per msg\n",
+        total,
+        Clock::ToMicroSeconds(dynamicCastTime) * 1000.0 / total,
+        Clock::ToMicroSeconds(isATime) * 1000.0 / total,
+        Clock::ToMicroSeconds(dispatcherTime) * 1000.0 / total,
+        Clock::ToMicroSeconds(visitTime) * 1000.0 / total);
+}
@@ -0,0 +1,275 @@
+//------------------------------------------------------------------------------
+//  JournalPortTest.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Messaging/JournalPort.h"
+#include "Messaging/JournalReplayer.h"
+#include "Messaging/Dispatcher.h"
+#include "TestProtocol.h"
+#include "TestProtocol2.h"
+#include "TestProtocolV2.h"
+#include "Core/Log.h"
+#include "Core/Time/Clock.h"
+#include "Core/String/StringBuilder.h"
+#include <cstdio>
+#if ORYOL_POSIX
+#include <unistd.h>
+#endif
+
+using namespace Oryol;
+using namespace Oryol::Core;
+using namespace Oryol::Messaging;
+
+#if ORYOL_POSIX
+// a per-process journal path, so parallel test runs don't collide
+static String journalPath(const char* name) {
+    StringBuilder builder;
+    builder.Format(128, "/tmp/oryol_test_%s_%d.jrn", name, int32(getpid()));
+    return builder.GetString();
+}
+
+//------------------------------------------------------------------------------
+TEST(JournalPortTest) {
+    const String path = journalPath("journal");
+    
+    // record messages, and check that they are still forwarded
+    int32 numForwarded = 0;
+    Ptr<Dispatcher<TestProtocol>> recDispatcher = Dispatcher<TestProtocol>::Create();
+    recDispatcher->Subscribe<TestProtocol::TestMsg2>([&numForwarded](const Ptr<TestProtocol::TestMsg2>&) {
+        numForwarded++;
+    });
+    recDispatcher->Subscribe<TestProtocol::TestArrayMsg>([](const Ptr<TestProtocol::TestArrayMsg>&) { });
+    Ptr<JournalPort> journal = JournalPort::Create(recDispatcher);
+    CHECK(!journal->IsOpen());
+    CHECK(journal->Open<TestProtocol>(path.AsCStr()));
+    CHECK(journal->IsOpen());
+    const int32 numMsgs = 10000;
+    for (int32 i = 0; i < numMsgs; i++) {
+        Ptr<TestProtocol::TestMsg2> msg = TestProtocol::TestMsg2::Create();
+        msg->SetInt32Val(i);
+        msg->SetStringVal(i & 1 ? "odd" : "a somewhat longer even string");
+        msg->SetStringAtomVal("atom");
+        CHECK(journal->Put(msg));
+    }
+    Array<int32> ints;
+    ints.AddBack(1); ints.AddBack(2); ints.AddBack(3);
+    Ptr<TestProtocol::TestArrayMsg> arrayMsg = TestProtocol::TestArrayMsg::Create();
+    arrayMsg->SetInt32ArrayVal(ints);
+    CHECK(journal->Put(arrayMsg));
+    CHECK(numForwarded == numMsgs);
+    journal->Flush();
+    const JournalPort::Stats stats = journal->GetStats();
+    CHECK(stats.NumMessages == numMsgs + 1);
+    CHECK(stats.NumBlocks > 1);
+    CHECK(stats.FileBytes < stats.RawBytes);
+    journal->Close();
+    CHECK(!journal->IsOpen());
+    
+    // a journal only replays into the protocol it was recorded with
+    Ptr<JournalReplayer> replayer = JournalReplayer::Create();
+    CHECK(!replayer->Open<TestProtocol>("/tmp/oryol_test_nonexisting.jrn"));
+    CHECK(!replayer->Open<TestProtocol2>(path.AsCStr()));
+    
+    // replay as fast as possible
+    Array<Ptr<TestProtocol::TestMsg2>> received;
+    Array<Ptr<TestProtocol::TestArrayMsg>> receivedArrays;
+    Ptr<Dispatcher<TestProtocol>> dispatcher = Dispatcher<TestProtocol>::Create();
+    dispatcher->Subscribe<TestProtocol::TestMsg2>([&received](const Ptr<TestProtocol::TestMsg2>& msg) {
+        received.AddBack(msg);
+    });
+    dispatcher->Subscribe<TestProtocol::TestArrayMsg>([&receivedArrays](const Ptr<TestProtocol::TestArrayMsg>& msg) {
+        receivedArrays.AddBack(msg);
+    });
+    CHECK(replayer->Open<TestProtocol>(path.AsCStr()));
+    CHECK(!replayer->AtEnd());
+    CHECK(replayer->Replay(dispatcher) == numMsgs + 1);
+    CHECK(replayer->AtEnd());
+    CHECK(replayer->GetNumMessages() == numMsgs + 1);
+    CHECK(replayer->GetRawBytes() == stats.RawBytes);
+    CHECK(replayer->GetFileBytes() == stats.FileBytes);
+    CHECK(received.Size() == numMsgs);
+    bool allValid = true;
+    for (int32 i = 0; i < received.Size(); i++) {
+        const Ptr<TestProtocol::TestMsg2>& msg = received[i];
+        allValid &= (msg->GetInt32Val() == i);
+        allValid &= (msg->GetStringVal() == (i & 1 ? "odd" : "a somewhat longer even string"));
+        allValid &= (msg->GetStringAtomVal() == "atom");
+    }
+    CHECK(allValid);
+    CHECK(receivedArrays.Size() == 1);
+    CHECK(receivedArrays[0]->GetInt32ArrayVal().Size() == 3);
+    CHECK(receivedArrays[0]->GetInt32ArrayVal()[2] == 3);
+    replayer->Close();
+    
+    // message times are increasing, and ReplayUntil() stops at the given time
+    CHECK(replayer->Open<TestProtocol>(path.AsCStr()));
+    Ptr<Message> msg;
+    Clock::Ticks time = 0;
+    Clock::Ticks prevTime = 0;
+    Clock::Ticks midTime = 0;
+    bool timesValid = true;
+    for (int32 i = 0; i < numMsgs / 2; i++) {
+        CHECK(replayer->Next(msg, time));
+        timesValid &= (time >= prevTime);
+        prevTime = time;
+    }
+    CHECK(timesValid);
+    midTime = time;
+    received.Clear();
+    const int32 numUntil = replayer->ReplayUntil(dispatcher, midTime);
+    CHECK(received.Size() == numUntil);
+    CHECK(replayer->ReplayUntil(dispatcher, Clock::TicksPerSecond * 1000) == (numMsgs + 1) - (numMsgs / 2) - numUntil);
+    CHECK(replayer->AtEnd());
+    CHECK(!replayer->Next(msg, time));
+    replayer->Close();
+    
+    // a torn block at the end of the file is ignored
+    CHECK(0 == truncate(path.AsCStr(), stats.FileBytes - 10));
+    CHECK(replayer->Open<TestProtocol>(path.AsCStr()));
+    const int64 numReplayed = replayer->Replay(dispatcher);
+    CHECK((numReplayed > 0) && (numReplayed < numMsgs));
+    replayer->Close();
+    
+    // uncompressed journal
+    journal = JournalPort::Create();
+    journal->SetCompression(Compression::None);
+    CHECK(journal->Open<TestProtocol>(path.AsCStr()));
+    for (int32 i = 0; i < 100; i++) {
+        CHECK(journal->Put(TestProtocol::TestMsg1::Create()));
+    }
+    journal->Close();
+    CHECK(journal->GetStats().FileBytes > journal->GetStats().RawBytes);
+    CHECK(replayer->Open<TestProtocol>(path.AsCStr()));
+    CHECK(replayer->Replay(Port::Create()) == 100);
+    replayer->Close();
+    
+    // a zero-filled block header is rejected as corrupt
+    journal = JournalPort::Create();
+    CHECK(journal->Open<TestProtocol>(path.AsCStr()));
+    journal->Close();
+    FILE* fp = std::fopen(path.AsCStr(), "ab");
+    CHECK(nullptr != fp);
+    const uint8 zeros[16] = { 0 };
+    CHECK(std::fwrite(zeros, 1, sizeof(zeros), fp) == sizeof(zeros));
+    std::fclose(fp);
+    replayer->Open<TestProtocol>(path.AsCStr());
+    CHECK(replayer->Replay(Port::Create()) == 0);
+    replayer->Close();
+    unlink(path.AsCStr());
+}
+
+//------------------------------------------------------------------------------
+TEST(JournalPortVersionTest) {
+    const String path = journalPath("version");
+    const int32 numMsgs = 100;
+    
+    // a journal of an older build, replayed by a build with a message
+    // class added in front (all message ids have moved)
+    Ptr<JournalPort> journal = JournalPort::Create();
+    CHECK(journal->Open<TestProtocol>(path.AsCStr()));
+    for (int32 i = 0; i < numMsgs; i++) {
+        Ptr<TestProtocol::TestMsg2> msg = TestProtocol::TestMsg2::Create();
+        msg->SetInt32Val(i);
+        CHECK(journal->Put(msg));
+    }
+    journal->Close();
+    Array<Ptr<TestProtocolV2::TestMsg2>> received;
+    Ptr<Dispatcher<TestProtocolV2>> dispatcher = Dispatcher<TestProtocolV2>::Create();
+    dispatcher->Subscribe<TestProtocolV2::TestMsg2>([&received](const Ptr<TestProtocolV2::TestMsg2>& msg) {
+        received.AddBack(msg);
+    });
+    Ptr<JournalReplayer> replayer = JournalReplayer::Create();
+    CHECK(replayer->Open<TestProtocolV2>(path.AsCStr()));
+    CHECK(replayer->Replay(dispatcher) == numMsgs);
+    replayer->Close();
+    CHECK(received.Size() == numMsgs);
+    bool allValid = true;
+    for (int32 i = 0; i < received.Size(); i++) {
+        allValid &= (received[i]->GetInt32Val() == i);
+    }
+    CHECK(allValid);
+    
+    // the older build skips the messages it doesn't know
+    journal = JournalPort::Create();
+    CHECK(journal->Open<TestProtocolV2>(path.AsCStr()));
+    for (int32 i = 0; i < numMsgs; i++) {
+        CHECK(journal->Put(TestProtocolV2::TestStatusMsg::Create()));
+        Ptr<TestProtocolV2::TestMsg2> msg = TestProtocolV2::TestMsg2::Create();
+        msg->SetInt32Val(i);
+        CHECK(journal->Put(msg));
+    }
+    journal->Close();
+    int32 numOld = 0;
+    allValid = true;
+    Ptr<Dispatcher<TestProtocol>> oldDispatcher = Dispatcher<TestProtocol>::Create();
+    oldDispatcher->Subscribe<TestProtocol::TestMsg2>([&numOld, &allValid](const Ptr<TestProtocol::TestMsg2>& msg) {
+        allValid &= (msg->GetInt32Val() == numOld++);
+    });
+    CHECK(replayer->Open<TestProtocol>(path.AsCStr()));
+    CHECK(replayer->Replay(oldDispatcher) == numMsgs);
+    replayer->Close();
+    CHECK(numOld == numMsgs);
+    CHECK(allValid);
+    unlink(path.AsCStr());
+}
+
+//------------------------------------------------------------------------------
+TEST(JournalPortBenchmark) {
+    const String path = journalPath("benchmark");
+    
+    // record, replay and decode a game-like stream of small messages
+    const int32 numMsgs = 200000;
+    Ptr<TestProtocol::TestMsg2> msg = TestProtocol::TestMsg2::Create();
+    msg->SetStringVal("player");
+    msg->SetStringAtomVal("move");
+    struct setting {
+        Compression::Code codec;
+        int32 level;
+        const char* name;
+    };
+    const setting settings[] = {
+        { Compression::None, 1, "none" },
+        { Compression::Fast, 1, "fast" },
+        { Compression::Deflate, 1, "deflate 1" },
+        { Compression::Deflate, 6, "deflate 6" },
+        { Compression::Deflate, 9, "deflate 9" },
+    };
+    for (const setting& s : settings) {
+        Ptr<JournalPort> journal = JournalPort::Create();
+        journal->SetCompression(s.codec, s.level);
+        CHECK(journal->Open<TestProtocol>(path.AsCStr()));
+        Clock::Ticks start = Clock::Now();
+        for (int32 i = 0; i < numMsgs; i++) {
+            msg->SetInt32Val(i);
+            msg->SetFloat32Val(float32(i & 1023) * 0.25f);
+            journal->Put(msg);
+        }
+        journal->Close();
+        const float64 recordSecs = Clock::ToSeconds(Clock::Since(start));
+        const JournalPort::Stats stats = journal->GetStats();
+        
+        int32 numReceived = 0;
+        Ptr<Dispatcher<TestProtocol>> dispatcher = Dispatcher<TestProtocol>::Create();
+        dispatcher->Subscribe<TestProtocol::TestMsg2>([&numReceived](const Ptr<TestProtocol::TestMsg2>&) {
+            numReceived++;
+        });
+        Ptr<JournalReplayer> replayer = JournalReplayer::Create();
+        CHECK(replayer->Open<TestProtocol>(path.AsCStr()));
+        start = Clock::Now();
+        CHECK(replayer->Replay(dispatcher) == numMsgs);
+        const float64 replaySecs = Clock::ToSeconds(Clock::Since(start));
+        replayer->Close();
+        CHECK(numReceived == numMsgs);
+        
+        Log::Info("JournalPort %-9s: record %.3f Mmsgs/s (%.1f MB/s, %.1f%% compressing), replay %.3f Mmsgs/s, %.1f bytes/msg, ratio %.2f\n",
+            s.name, (numMsgs / recordSecs) / 1000000.0,
+            (float64(stats.RawBytes) / recordSecs) / (1024.0 * 1024.0),
+            100.0 * Clock::ToSeconds(stats.CompressTime) / recordSecs,
+            (numMsgs / replaySecs) / 1000000.0,
+            float64(stats.FileBytes) / numMsgs,
+            float64(stats.RawBytes) / float64(stats.FileBytes));
+    }
+    unlink(path.AsCStr());
+}
+#endif
@@ -6,6 +6,9 @@
 #include "Messaging/Serializer.h"
 #include "Core/String/String.h"
 #include "Core/String/StringAtom.h"
+#include "Core/Time/Clock.h"
+#include "Core/Memory/Memory.h"
+#include "Messaging/UnitTests/TestProtocol.h"
 
 using namespace Oryol;
 using namespace Oryol::Core;
@@ -87,3 +90,264 @@ TEST(SerializerTest) {
 }
 
 
+
+// encode TestMsg1 field by field (like messages with non-POD attributes)
+static uint8* encodeFieldwise(const Ptr<TestProtocol::TestMsg1>& msg, uint8* dstPtr, const uint8* maxPtr) {
+    dstPtr = Serializer::Encode<int8>(msg->GetInt8Val(), dstPtr, maxPtr);
+    dstPtr = Serializer::Encode<int16>(msg->GetInt16Val(), dstPtr, maxPtr);
+    dstPtr = Serializer::Encode<int32>(msg->GetInt32Val(), dstPtr, maxPtr);
+    dstPtr = Serializer::Encode<int64>(msg->GetInt64Val(), dstPtr, maxPtr);
+    dstPtr = Serializer::Encode<uint8>(msg->GetUInt8Val(), dstPtr, maxPtr);
+    dstPtr = Serializer::Encode<uint16>(msg->GetUInt16Val(), dstPtr, maxPtr);
+    dstPtr = Serializer::Encode<uint32>(msg->GetUInt32Val(), dstPtr, maxPtr);
+    dstPtr = Serializer::Encode<uint64>(msg->GetUInt64Val(), dstPtr, maxPtr);
+    dstPtr = Serializer::Encode<float32>(msg->GetFloat32Val(), dstPtr, maxPtr);
+    dstPtr = Serializer::Encode<float64>(msg->GetFloat64Val(), dstPtr, maxPtr);
+    return dstPtr;
+}
+
+// decode TestMsg1 field by field
+static const uint8* decodeFieldwise(const uint8* srcPtr, const uint8* maxPtr, const Ptr<TestProtocol::TestMsg1>& msg) {
+    int8 i8; int16 i16; int32 i32; int64 i64;
+    uint8 u8; uint16 u16; uint32 u32; uint64 u64;
+    float32 f32; float64 f64;
+    srcPtr = Serializer::Decode<int8>(srcPtr, maxPtr, i8);
+    srcPtr = Serializer::Decode<int16>(srcPtr, maxPtr, i16);
+    srcPtr = Serializer::Decode<int32>(srcPtr, maxPtr, i32);
+    srcPtr = Serializer::Decode<int64>(srcPtr, maxPtr, i64);
+    srcPtr = Serializer::Decode<uint8>(srcPtr, maxPtr, u8);
+    srcPtr = Serializer::Decode<uint16>(srcPtr, maxPtr, u16);
+    srcPtr = Serializer::Decode<uint32>(srcPtr, maxPtr, u32);
+    srcPtr = Serializer::Decode<uint64>(srcPtr, maxPtr, u64);
+    srcPtr = Serializer::Decode<float32>(srcPtr, maxPtr, f32);
+    srcPtr = Serializer::Decode<float64>(srcPtr, maxPtr, f64);
+    msg->SetInt8Val(i8); msg->SetInt16Val(i16); msg->SetInt32Val(i32); msg->SetInt64Val(i64);
+    msg->SetUInt8Val(u8); msg->SetUInt16Val(u16); msg->SetUInt32Val(u32); msg->SetUInt64Val(u64);
+    msg->SetFloat32Val(f32); msg->SetFloat64Val(f64);
+    return srcPtr;
+}
+
+TEST(FixedSizeMessageTest) {
+    // TestMsg1 only has fixed-size attributes and is encoded with one copy,
+    // the encoding must be the same as field by field
+    Ptr<TestProtocol::TestMsg1> msg = TestProtocol::TestMsg1::Create();
+    msg->SetInt8Val(-8);
+    msg->SetInt16Val(-16);
+    msg->SetInt32Val(-32);
+    msg->SetInt64Val(-64);
+    msg->SetUInt8Val(8);
+    msg->SetUInt16Val(16);
+    msg->SetUInt32Val(32);
+    msg->SetUInt64Val(64);
+    msg->SetFloat32Val(32.0f);
+    msg->SetFloat64Val(64.0);
+    const int32 size = 1 + 2 + 4 + 8 + 1 + 2 + 4 + 8 + 4 + 8;
+    CHECK(msg->EncodedSize() == size);
+    
+    uint8 fast[64];
+    uint8 fieldwise[64];
+    CHECK(msg->Encode(fast, fast + sizeof(fast)) == fast + size);
+    CHECK(encodeFieldwise(msg, fieldwise, fieldwise + sizeof(fieldwise)) == fieldwise + size);
+    CHECK(0 == memcmp(fast, fieldwise, size));
+    CHECK(msg->Encode(fast, fast + size - 1) == nullptr);
+    
+    Ptr<TestProtocol::TestMsg1> decoded = TestProtocol::TestMsg1::Create();
+    CHECK(decoded->Decode(fieldwise, fieldwise + size - 1) == nullptr);
+    CHECK(decoded->Decode(fieldwise, fieldwise + size) == fieldwise + size);
+    CHECK(decoded->GetInt8Val() == -8);
+    CHECK(decoded->GetInt16Val() == -16);
+    CHECK(decoded->GetInt32Val() == -32);
+    CHECK(decoded->GetInt64Val() == -64);
+    CHECK(decoded->GetUInt8Val() == 8);
+    CHECK(decoded->GetUInt16Val() == 16);
+    CHECK(decoded->GetUInt32Val() == 32);
+    CHECK(decoded->GetUInt64Val() == 64);
+    CHECK(decoded->GetFloat32Val() == 32.0f);
+    CHECK(decoded->GetFloat64Val() == 64.0);
+    
+    // POD arrays are copied in one go, also from unaligned memory
+    Array<int32> vals;
+    for (int32 i = 0; i < 100; i++) {
+        vals.AddBack(i);
+    }
+    uint8 space[512];
+    CHECK(Serializer::EncodedArraySize<int32>(vals) == 404);
+    CHECK(Serializer::EncodeArray<int32>(vals, space + 1, space + sizeof(space)) == space + 405);
+    Array<int32> decodedVals;
+    CHECK(Serializer::DecodeArray<int32>(space + 1, space + 405, decodedVals) == space + 405);
+    CHECK(decodedVals.Size() == 100);
+    CHECK(decodedVals[99] == 99);
+    Array<int32> truncatedVals;
+    CHECK(Serializer::DecodeArray<int32>(space + 1, space + 404, truncatedVals) == nullptr);
+    
+    // an element count whose byte size overflows 32 bits
+    uint8 bogus[8] = { 0 };
+    Serializer::Encode<int32>(0x40000001, bogus, bogus + sizeof(bogus));
+    Array<int32> bogusVals;
+    CHECK(Serializer::DecodeArray<int32>(bogus, bogus + sizeof(bogus), bogusVals) == nullptr);
+    CHECK(bogusVals.Empty());
+    
+    // an empty array at the end of the buffer
+    Array<int32> emptyVals;
+    CHECK(Serializer::EncodeArray<int32>(emptyVals, space, space + 4) == space + 4);
+    Array<int32> decodedEmptyVals;
+    CHECK(Serializer::DecodeArray<int32>(space, space + 4, decodedEmptyVals) == space + 4);
+    CHECK(decodedEmptyVals.Empty());
+}
+
+TEST(SerializeBenchmark) {
+    const int32 numMsgs = 100000;
+    const int32 msgSize = TestProtocol::TestMsg1::Create()->EncodedSize();
+    const int32 bufSize = numMsgs * msgSize;
+    uint8* buf = (uint8*) Memory::Alloc(bufSize);
+    const uint8* maxPtr = buf + bufSize;
+    Ptr<TestProtocol::TestMsg1> msg = TestProtocol::TestMsg1::Create();
+    msg->SetInt32Val(32);
+    
+    // TestMsg1: one copy vs. field by field
+    Clock::Ticks start = Clock::Now();
+    uint8* dstPtr = buf;
+    for (int32 i = 0; i < numMsgs; i++) {
+        dstPtr = msg->Encode(dstPtr, maxPtr);
+    }
+    const Clock::Ticks fastEncode = Clock::Since(start);
+    CHECK(dstPtr == maxPtr);
+    start = Clock::Now();
+    const uint8* srcPtr = buf;
+    for (int32 i = 0; i < numMsgs; i++) {
+        srcPtr = msg->Decode(srcPtr, maxPtr);
+    }
+    const Clock::Ticks fastDecode = Clock::Since(start);
+    CHECK(srcPtr == maxPtr);
+    CHECK(msg->GetInt32Val() == 32);
+    start = Clock::Now();
+    dstPtr = buf;
+    for (int32 i = 0; i < numMsgs; i++) {
+        dstPtr = encodeFieldwise(msg, dstPtr, maxPtr);
+    }
+    const Clock::Ticks fieldEncode = Clock::Since(start);
+    CHECK(dstPtr == maxPtr);
+    start = Clock::Now();
+    srcPtr = buf;
+    for (int32 i = 0; i < numMsgs; i++) {
+        srcPtr = decodeFieldwise(srcPtr, maxPtr, msg);
+    }
+    const Clock::Ticks fieldDecode = Clock::Since(start);
+    CHECK(srcPtr == maxPtr);
+    const float64 mb = bufSize / (1024.0 * 1024.0);
+    Log::Info("Serialize TestMsg1 (%d msgs): encode %.1f MB/s (field by field %.1f MB/s), decode %.1f MB/s (field by field %.1f MB/s)\n",
+        numMsgs,
+        mb / Clock::ToSeconds(fastEncode), mb / Clock::ToSeconds(fieldEncode),
+        mb / Clock::ToSeconds(fastDecode), mb / Clock::ToSeconds(fieldDecode));
+    Memory::Free(buf);
+    
+    // TestArrayMsg with a large int32 array (the string array is empty)
+    Ptr<TestProtocol::TestArrayMsg> arrayMsg = TestProtocol::TestArrayMsg::Create();
+    Array<int32> vals;
+    for (int32 i = 0; i < 1000000; i++) {
+        vals.AddBack(i);
+    }
+    arrayMsg->SetInt32ArrayVal(vals);
+    const int32 arraySize = arrayMsg->EncodedSize();
+    uint8* arrayBuf = (uint8*) Memory::Alloc(arraySize);
+    start = Clock::Now();
+    CHECK(arrayMsg->Encode(arrayBuf, arrayBuf + arraySize) == arrayBuf + arraySize);
+    const Clock::Ticks arrayEncode = Clock::Since(start);
+    Ptr<TestProtocol::TestArrayMsg> decodedArrayMsg = TestProtocol::TestArrayMsg::Create();
+    start = Clock::Now();
+    CHECK(decodedArrayMsg->Decode(arrayBuf, arrayBuf + arraySize) == arrayBuf + arraySize);
+    const Clock::Ticks arrayDecode = Clock::Since(start);
+    CHECK(decodedArrayMsg->GetInt32ArrayVal().Size() == 1000000);
+    CHECK(decodedArrayMsg->GetInt32ArrayVal()[999999] == 999999);
+    const float64 arrayMB = arraySize / (1024.0 * 1024.0);
+    Log::Info("Serialize TestArrayMsg (1000000 int32): encode %.1f MB/s, decode %.1f MB/s\n",
+        arrayMB / Clock::ToSeconds(arrayEncode), arrayMB / Clock::ToSeconds(arrayDecode));
+    Memory::Free(arrayBuf);
+}
+
+TEST(ZeroCopyDecodeTest) {
+    Array<uint8> payload;
+    for (int32 i = 0; i < 65536; i++) {
+        payload.AddBack(uint8(i));
+    }
+    Array<float32> samples;
+    for (int32 i = 0; i < 1000; i++) {
+        samples.AddBack(float32(i));
+    }
+    Ptr<TestProtocol::TestViewMsg> msg = TestProtocol::TestViewMsg::Create();
+    CHECK(msg->GetName().ToString() == "Test");
+    msg->SetId(7);
+    msg->SetName(String("abcd"));
+    msg->SetPayload(payload);
+    msg->SetSamples(samples);
+    CHECK(msg->GetPayload().Size() == 65536);
+    const int32 size = msg->EncodedSize();
+    CHECK(size == 4 + 8 + 65540 + 4004);
+    Ptr<WireBuffer> buf = WireBuffer::Create(size);
+    CHECK(msg->Encode(buf->Data(), buf->End()) == buf->End());
+    
+    // views are encoded like strings and arrays
+    int32 id = 0;
+    String name;
+    Array<uint8> decodedPayload;
+    Array<float32> decodedSamples;
+    const uint8* srcPtr = Serializer::Decode<int32>(buf->Data(), buf->End(), id);
+    srcPtr = Serializer::Decode<String>(srcPtr, buf->End(), name);
+    srcPtr = Serializer::DecodeArray<uint8>(srcPtr, buf->End(), decodedPayload);
+    srcPtr = Serializer::DecodeArray<float32>(srcPtr, buf->End(), decodedSamples);
+    CHECK(srcPtr == buf->End());
+    CHECK(id == 7);
+    CHECK(name == "abcd");
+    CHECK(decodedPayload.Size() == 65536);
+    CHECK(decodedSamples.Size() == 1000);
+    CHECK(decodedSamples[999] == 999.0f);
+    
+    // Decode() copies the views
+    Ptr<TestProtocol::TestViewMsg> copied = TestProtocol::TestViewMsg::Create();
+    int64 numAllocs = Memory::NumAllocs();
+    CHECK(copied->Decode(buf->Data(), buf->End()) == buf->End());
+    const int64 numCopyAllocs = Memory::NumAllocs() - numAllocs;
+    CHECK(numCopyAllocs >= 3);
+    CHECK(copied->GetPayload().Buffer() != buf);
+    CHECK(copied->GetName().ToString() == "abcd");
+    CHECK(copied->GetPayload()[1000] == uint8(1000));
+    
+    // DecodeShared() references the buffer without allocations
+    Ptr<TestProtocol::TestViewMsg> shared = TestProtocol::TestViewMsg::Create();
+    numAllocs = Memory::NumAllocs();
+    CHECK(shared->DecodeShared(buf, buf->Data(), buf->End()) == buf->End());
+    const int64 numSharedAllocs = Memory::NumAllocs() - numAllocs;
+    CHECK(numSharedAllocs == 0);
+    Log::Info("Decode TestViewMsg (%d bytes): %d allocations with Decode(), %d with DecodeShared()\n",
+        size, int32(numCopyAllocs), int32(numSharedAllocs));
+    CHECK(shared->GetId() == 7);
+    CHECK(shared->GetName().ToString() == "abcd");
+    CHECK(shared->GetPayload().Buffer() == buf);
+    CHECK(shared->GetPayload().begin() == buf->Data() + 16);
+    CHECK(shared->GetSamples().Buffer() == buf);
+    CHECK(shared->GetSamples()[999] == 999.0f);
+    CHECK(shared->GetSamples().ToArray().Size() == 1000);
+    
+    // the message keeps the buffer alive
+    buf = nullptr;
+    CHECK(shared->GetPayload()[1000] == uint8(1000));
+    CHECK(shared->GetPayload().Buffer()->GetRefCount() == 3);
+    
+    // unaligned elements are copied
+    msg->SetName(String("abc"));
+    buf = WireBuffer::Create(msg->EncodedSize());
+    CHECK(msg->Encode(buf->Data(), buf->End()) == buf->End());
+    CHECK(shared->DecodeShared(buf, buf->Data(), buf->End()) == buf->End());
+    CHECK(shared->GetPayload().Buffer() == buf);
+    CHECK(shared->GetSamples().Buffer() != buf);
+    CHECK(shared->GetSamples()[999] == 999.0f);
+    
+    // not enough data
+    CHECK(shared->DecodeShared(buf, buf->Data(), buf->End() - 1) == nullptr);
+    
+    // empty views
+    msg->SetName(String());
+    msg->SetPayload(Array<uint8>());
+    CHECK(msg->GetName().Empty());
+    CHECK(msg->EncodedSize() == 4 + 4 + 4 + 4004);
+}
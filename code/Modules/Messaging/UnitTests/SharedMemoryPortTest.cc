@@ -0,0 +1,293 @@
+//------------------------------------------------------------------------------
+//  SharedMemoryPortTest.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Messaging/SharedMemoryPort.h"
+#include "Messaging/Dispatcher.h"
+#include "TestProtocol.h"
+#include "TestProtocol2.h"
+#include "Core/Log.h"
+#include "Core/Time/Clock.h"
+#include "Core/String/StringBuilder.h"
+#if ORYOL_LINUX
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <vector>
+#endif
+
+using namespace Oryol;
+using namespace Oryol::Core;
+using namespace Oryol::Messaging;
+
+#if ORYOL_LINUX
+// a per-process segment name, so parallel test runs don't collide
+static String portName(const char* name) {
+    StringBuilder builder;
+    builder.Format(128, "oryol_test_%s_%d", name, int32(getpid()));
+    return builder.GetString();
+}
+
+//------------------------------------------------------------------------------
+TEST(SharedMemoryPortTest) {
+    const String name = portName("local");
+    SharedMemoryPort::Unlink(name.AsCStr());
+
+    Array<Ptr<TestProtocol::TestMsg2>> received;
+    Ptr<Dispatcher<TestProtocol>> dispatcher = Dispatcher<TestProtocol>::Create();
+    dispatcher->Subscribe<TestProtocol::TestMsg2>([&received](const Ptr<TestProtocol::TestMsg2>& msg) {
+        received.AddBack(msg);
+    });
+    
+    // sender and receiver in the same process, the smallest ring buffer
+    Ptr<SharedMemoryPort> tx = SharedMemoryPort::Create();
+    Ptr<SharedMemoryPort> rx = SharedMemoryPort::Create();
+    CHECK(tx->OpenSender<TestProtocol>(name.AsCStr(), 4096));
+    CHECK(tx->IsOpen());
+    CHECK(tx->IsSender());
+    CHECK(tx->GetMaxMessageSize() < 4096);
+    CHECK(rx->OpenReceiver<TestProtocol>(name.AsCStr(), dispatcher));
+    CHECK(!rx->IsSender());
+    
+    // there can only be one sender, and the protocol must match
+    Ptr<SharedMemoryPort> tx2 = SharedMemoryPort::Create();
+    CHECK(!tx2->OpenSender<TestProtocol>(name.AsCStr()));
+    Ptr<SharedMemoryPort> rx2 = SharedMemoryPort::Create();
+    CHECK(!rx2->OpenReceiver<TestProtocol2>(name.AsCStr(), Dispatcher<TestProtocol2>::Create()));
+    
+    // nothing there yet
+    CHECK(!rx->WaitForMessages(Clock::FromMilliSeconds(1.0)));
+    rx->DoWork();
+    CHECK(received.Empty());
+    
+    // send enough messages to wrap around the ring buffer several times
+    for (int32 i = 0; i < 1000; i++) {
+        Ptr<TestProtocol::TestMsg2> msg = TestProtocol::TestMsg2::Create();
+        msg->SetInt32Val(i);
+        msg->SetStringVal(i & 1 ? "odd" : "a somewhat longer even string");
+        msg->SetStringAtomVal("atom");
+        CHECK(tx->Put(msg));
+        CHECK(msg->Handled());
+        if ((i % 10) == 9) {
+            CHECK(rx->WaitForMessages(Clock::FromMilliSeconds(100.0)));
+            rx->DoWork();
+        }
+    }
+    CHECK(received.Size() == 1000);
+    bool allValid = true;
+    for (int32 i = 0; i < received.Size(); i++) {
+        const Ptr<TestProtocol::TestMsg2>& msg = received[i];
+        allValid &= msg->GetInt32Val() == i;
+        allValid &= msg->GetStringVal() == (i & 1 ? "odd" : "a somewhat longer even string");
+        allValid &= msg->GetStringAtomVal() == "atom";
+        allValid &= msg->GetInt16Val() == -1;
+    }
+    CHECK(allValid);
+    CHECK(tx->GetNumMessages() == 1000);
+    CHECK(rx->GetNumMessages() == 1000);
+    
+    // a full ring buffer rejects messages
+    tx->SetOverflow(Overflow::Reject);
+    int32 numSent = 0;
+    for (int32 i = 0; i < 1000; i++) {
+        Ptr<TestProtocol::TestMsg2> msg = TestProtocol::TestMsg2::Create();
+        if (tx->Put(msg)) {
+            numSent++;
+        }
+    }
+    CHECK((numSent > 0) && (numSent < 1000));
+    received.Clear();
+    rx->DoWork();
+    CHECK(received.Size() == numSent);
+    
+    // the last one to close removes the segment, the name can be reused
+    tx->Close();
+    rx->Close();
+    CHECK(!tx->IsOpen());
+    CHECK(rx->OpenReceiver<TestProtocol>(name.AsCStr(), dispatcher));
+    rx->DoWork();
+    CHECK(received.Size() == numSent);
+    rx->Close();
+}
+
+//------------------------------------------------------------------------------
+/**
+ The child process of the two-process test: receives on req, and
+ answers flush and ping messages on rsp, UInt8Val is the command.
+*/
+enum testCommand : uint8 {
+    testData = 0,
+    testFlush,
+    testPing,
+    testStop,
+};
+
+static int childProcess(const String& reqName, const String& rspName) {
+    Ptr<SharedMemoryPort> rsp = SharedMemoryPort::Create();
+    if (!rsp->OpenSender<TestProtocol>(rspName.AsCStr())) {
+        return 1;
+    }
+    int64 numData = 0;
+    int64 numErrors = 0;
+    bool stop = false;
+    Ptr<Dispatcher<TestProtocol>> dispatcher = Dispatcher<TestProtocol>::Create();
+    dispatcher->Subscribe<TestProtocol::TestMsg1>([&](const Ptr<TestProtocol::TestMsg1>& msg) {
+        switch (msg->GetUInt8Val()) {
+            case testData:
+                if (msg->GetInt64Val() != numData++) {
+                    numErrors++;
+                }
+                break;
+            case testFlush:
+            case testPing:
+                {
+                    Ptr<TestProtocol::TestMsg1> reply = TestProtocol::TestMsg1::Create();
+                    reply->SetUInt8Val(msg->GetUInt8Val());
+                    reply->SetInt64Val(testFlush == msg->GetUInt8Val() ? numData : msg->GetInt64Val());
+                    reply->SetInt32Val(int32(numErrors));
+                    rsp->Put(reply);
+                }
+                break;
+            default:
+                stop = true;
+                break;
+        }
+    });
+    Ptr<SharedMemoryPort> req = SharedMemoryPort::Create();
+    if (!req->OpenReceiver<TestProtocol>(reqName.AsCStr(), dispatcher)) {
+        return 2;
+    }
+    while (!stop) {
+        if (!req->WaitForMessages(Clock::FromSeconds(10.0))) {
+            return 3;
+        }
+        req->DoWork();
+    }
+    req->Close();
+    rsp->Close();
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+TEST(SharedMemoryPortProcessTest) {
+    const String reqName = portName("req");
+    const String rspName = portName("rsp");
+    SharedMemoryPort::Unlink(reqName.AsCStr());
+    SharedMemoryPort::Unlink(rspName.AsCStr());
+    
+    const pid_t child = fork();
+    CHECK(child >= 0);
+    if (0 == child) {
+        // don't return into the test runner
+        _exit(childProcess(reqName, rspName));
+    }
+    
+    Ptr<TestProtocol::TestMsg1> reply;
+    Ptr<Dispatcher<TestProtocol>> dispatcher = Dispatcher<TestProtocol>::Create();
+    dispatcher->Subscribe<TestProtocol::TestMsg1>([&reply](const Ptr<TestProtocol::TestMsg1>& msg) {
+        reply = msg;
+    });
+    Ptr<SharedMemoryPort> req = SharedMemoryPort::Create();
+    Ptr<SharedMemoryPort> rsp = SharedMemoryPort::Create();
+    CHECK(req->OpenSender<TestProtocol>(reqName.AsCStr()));
+    CHECK(rsp->OpenReceiver<TestProtocol>(rspName.AsCStr(), dispatcher));
+    auto waitReply = [&]() -> bool {
+        reply = nullptr;
+        while (!reply) {
+            if (!rsp->WaitForMessages(Clock::FromSeconds(10.0))) {
+                return false;
+            }
+            rsp->DoWork();
+        }
+        return true;
+    };
+    
+    // throughput: stream messages, the child checks the sequence
+    const int32 numMsgs = 200000;
+    Ptr<TestProtocol::TestMsg1> msg = TestProtocol::TestMsg1::Create();
+    msg->SetInt64Val(numMsgs / 2);
+    msg->SetFloat32Val(float32(numMsgs / 2));
+    const int32 msgSize = CompactSerializer::EncodedMessageSize(msg);
+    Clock::Ticks start = Clock::Now();
+    for (int32 i = 0; i < numMsgs; i++) {
+        msg = TestProtocol::TestMsg1::Create();
+        msg->SetInt64Val(i);
+        msg->SetFloat32Val(float32(i));
+        req->Put(msg);
+    }
+    msg = TestProtocol::TestMsg1::Create();
+    msg->SetUInt8Val(testFlush);
+    req->Put(msg);
+    CHECK(waitReply());
+    const float64 secs = Clock::ToSeconds(Clock::Since(start));
+    CHECK(reply && (reply->GetInt64Val() == numMsgs) && (reply->GetInt32Val() == 0));
+    Log::Info("SharedMemoryPort throughput: %d msgs in %.3f ms, %.2f Mmsgs/s, %.1f MB/s (%d bytes/msg)\n",
+        numMsgs, secs * 1000.0, (numMsgs / secs) / 1000000.0, (float64(numMsgs) * msgSize / secs) / (1024.0 * 1024.0), msgSize);
+    
+    // latency: ping-pong round trips
+    const int32 numPings = 5000;
+    std::vector<Clock::Ticks> rtt;
+    rtt.reserve(numPings);
+    bool allValid = true;
+    for (int32 i = 0; i < numPings; i++) {
+        msg = TestProtocol::TestMsg1::Create();
+        msg->SetUInt8Val(testPing);
+        msg->SetInt64Val(i);
+        start = Clock::Now();
+        req->Put(msg);
+        allValid &= waitReply() && (reply->GetInt64Val() == i);
+        rtt.push_back(Clock::Since(start));
+    }
+    CHECK(allValid);
+    std::sort(rtt.begin(), rtt.end());
+    Log::Info("SharedMemoryPort round trip: p50 %.2f us, p99 %.2f us, max %.2f us\n",
+        Clock::ToMicroSeconds(rtt[numPings / 2]), Clock::ToMicroSeconds(rtt[numPings * 99 / 100]), Clock::ToMicroSeconds(rtt.back()));
+    
+    // stop the child
+    msg = TestProtocol::TestMsg1::Create();
+    msg->SetUInt8Val(testStop);
+    req->Put(msg);
+    int status = -1;
+    CHECK(child == waitpid(child, &status, 0));
+    CHECK(WIFEXITED(status) && (0 == WEXITSTATUS(status)));
+    req->Close();
+    rsp->Close();
+}
+
+//------------------------------------------------------------------------------
+TEST(SharedMemoryPortTakeoverTest) {
+    const String name = portName("takeover");
+    SharedMemoryPort::Unlink(name.AsCStr());
+    
+    // a sender which dies without closing the port
+    const pid_t child = fork();
+    CHECK(child >= 0);
+    if (0 == child) {
+        Ptr<SharedMemoryPort> dead = SharedMemoryPort::Create();
+        _exit(dead->OpenSender<TestProtocol>(name.AsCStr()) ? 0 : 1);
+    }
+    int status = -1;
+    CHECK(child == waitpid(child, &status, 0));
+    CHECK(WIFEXITED(status) && (0 == WEXITSTATUS(status)));
+    
+    // take over the sender role, the segment goes away with the last close
+    Ptr<SharedMemoryPort> tx = SharedMemoryPort::Create();
+    Ptr<SharedMemoryPort> rx = SharedMemoryPort::Create();
+    CHECK(tx->OpenSender<TestProtocol>(name.AsCStr()));
+    CHECK(rx->OpenReceiver<TestProtocol>(name.AsCStr(), Dispatcher<TestProtocol>::Create()));
+    tx->Close();
+    rx->Close();
+    StringBuilder path;
+    path.Append('/');
+    path.Append(name);
+    const int fd = shm_open(path.AsCStr(), O_RDONLY, 0);
+    CHECK(-1 == fd);
+    if (-1 != fd) {
+        close(fd);
+        SharedMemoryPort::Unlink(name.AsCStr());
+    }
+}
+#endif
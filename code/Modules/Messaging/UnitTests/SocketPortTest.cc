@@ -0,0 +1,315 @@
+//------------------------------------------------------------------------------
+//  SocketPortTest.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Messaging/SocketPort.h"
+#include "Messaging/Dispatcher.h"
+#include "TestProtocol.h"
+#include "Core/Log.h"
+#include "Core/Time/Clock.h"
+#include "Core/String/StringBuilder.h"
+#if ORYOL_LINUX
+#include <unistd.h>
+#endif
+
+using namespace Oryol;
+using namespace Oryol::Core;
+using namespace Oryol::Messaging;
+
+#if ORYOL_LINUX
+// a per-process socket path, so parallel test runs don't collide
+static String socketPath(const char* name) {
+    StringBuilder builder;
+    builder.Format(128, "/tmp/oryol_test_%s_%d.sock", name, int32(getpid()));
+    return builder.GetString();
+}
+
+//------------------------------------------------------------------------------
+TEST(SocketPortTest) {
+    const String path = socketPath("loopback");
+    
+    Array<Ptr<TestProtocol::TestMsg2>> serverReceived;
+    Ptr<Dispatcher<TestProtocol>> serverDispatcher = Dispatcher<TestProtocol>::Create();
+    serverDispatcher->Subscribe<TestProtocol::TestMsg2>([&serverReceived](const Ptr<TestProtocol::TestMsg2>& msg) {
+        serverReceived.AddBack(msg);
+    });
+    Array<Ptr<TestProtocol::TestMsg1>> clientReceived;
+    Ptr<Dispatcher<TestProtocol>> clientDispatcher = Dispatcher<TestProtocol>::Create();
+    clientDispatcher->Subscribe<TestProtocol::TestMsg1>([&clientReceived](const Ptr<TestProtocol::TestMsg1>& msg) {
+        clientReceived.AddBack(msg);
+    });
+    
+    Ptr<SocketPort> server = SocketPort::Create();
+    CHECK(server->Listen<TestProtocol>(path.AsCStr(), serverDispatcher));
+    CHECK(server->IsOpen());
+    CHECK(!server->IsConnected());
+    CHECK(!server->Put(TestProtocol::TestMsg1::Create()));
+    
+    Ptr<SocketPort> client = SocketPort::Create();
+    CHECK(!client->Connect<TestProtocol>("/tmp/oryol_test_nonexisting.sock", clientDispatcher));
+    CHECK(client->Connect<TestProtocol>(path.AsCStr(), clientDispatcher));
+    CHECK(client->IsConnected());
+    CHECK(server->WaitForConnection(Clock::FromSeconds(5.0)));
+    
+    // client to server
+    const int32 numMsgs = 1000;
+    for (int32 i = 0; i < numMsgs; i++) {
+        Ptr<TestProtocol::TestMsg2> msg = TestProtocol::TestMsg2::Create();
+        msg->SetInt32Val(i);
+        msg->SetStringVal(i & 1 ? "odd" : "a somewhat longer even string");
+        msg->SetStringAtomVal("atom");
+        CHECK(client->Put(msg));
+        CHECK(msg->Handled());
+    }
+    while ((serverReceived.Size() < numMsgs) && server->WaitForMessages(Clock::FromSeconds(5.0))) {
+        server->DoWork();
+    }
+    CHECK(serverReceived.Size() == numMsgs);
+    bool allValid = true;
+    for (int32 i = 0; i < serverReceived.Size(); i++) {
+        const Ptr<TestProtocol::TestMsg2>& msg = serverReceived[i];
+        allValid &= msg->GetInt32Val() == i;
+        allValid &= msg->GetStringVal() == (i & 1 ? "odd" : "a somewhat longer even string");
+        allValid &= msg->GetStringAtomVal() == "atom";
+        allValid &= msg->GetInt16Val() == -1;
+    }
+    CHECK(allValid);
+    
+    // server to client
+    Ptr<TestProtocol::TestMsg1> reply = TestProtocol::TestMsg1::Create();
+    reply->SetInt64Val(1234);
+    CHECK(server->Put(reply));
+    CHECK(client->WaitForMessages(Clock::FromSeconds(5.0)));
+    client->DoWork();
+    CHECK(clientReceived.Size() == 1);
+    CHECK(clientReceived[0]->GetInt64Val() == 1234);
+    
+    SocketPort::Stats stats = client->GetStats();
+    CHECK(stats.NumSent == numMsgs);
+    CHECK(stats.NumReceived == 1);
+    CHECK((stats.NumWrites > 0) && (stats.NumWrites <= numMsgs));
+    CHECK(server->GetStats().BytesReceived == stats.BytesSent);
+    
+    // the server notices when the client goes away, and accepts a new client
+    client->Close();
+    CHECK(!client->IsOpen());
+    for (int32 i = 0; (i < 500) && server->IsConnected(); i++) {
+        usleep(1000);
+    }
+    CHECK(!server->IsConnected());
+    CHECK(!server->Put(reply));
+    CHECK(client->Connect<TestProtocol>(path.AsCStr(), clientDispatcher));
+    CHECK(server->WaitForConnection(Clock::FromSeconds(5.0)));
+    CHECK(server->Put(reply));
+    CHECK(client->WaitForMessages(Clock::FromSeconds(5.0)));
+    client->DoWork();
+    CHECK(clientReceived.Size() == 2);
+    
+    client->Close();
+    server->Close();
+    CHECK(0 != access(path.AsCStr(), F_OK));
+}
+
+//------------------------------------------------------------------------------
+TEST(SocketPortCompressionTest) {
+    const String path = socketPath("compression");
+    
+    Array<Ptr<TestProtocol::TestMsg2>> serverReceived;
+    Ptr<Dispatcher<TestProtocol>> serverDispatcher = Dispatcher<TestProtocol>::Create();
+    serverDispatcher->Subscribe<TestProtocol::TestMsg2>([&serverReceived](const Ptr<TestProtocol::TestMsg2>& msg) {
+        serverReceived.AddBack(msg);
+    });
+    int32 numClientReceived = 0;
+    Ptr<Dispatcher<TestProtocol>> clientDispatcher = Dispatcher<TestProtocol>::Create();
+    clientDispatcher->Subscribe<TestProtocol::TestMsg1>([&numClientReceived](const Ptr<TestProtocol::TestMsg1>&) {
+        numClientReceived++;
+    });
+    
+    // each side compresses with a different codec
+    Ptr<SocketPort> server = SocketPort::Create();
+    server->SetCompression(Compression::Fast);
+    CHECK(server->GetCompression() == Compression::Fast);
+    CHECK(server->Listen<TestProtocol>(path.AsCStr(), serverDispatcher));
+    Ptr<SocketPort> client = SocketPort::Create();
+    for (int32 connection = 0; connection < 2; connection++) {
+        // a new connection starts new compression streams
+        client->SetCompression(Compression::Deflate);
+        CHECK(client->Connect<TestProtocol>(path.AsCStr(), clientDispatcher));
+        CHECK(server->WaitForConnection(Clock::FromSeconds(5.0)));
+        client->SetOverflow(Overflow::Reject);
+        
+        serverReceived.Clear();
+        const int32 numMsgs = 20000;
+        for (int32 i = 0; i < numMsgs; i++) {
+            Ptr<TestProtocol::TestMsg2> msg = TestProtocol::TestMsg2::Create();
+            msg->SetInt32Val(i);
+            msg->SetStringVal(i & 1 ? "odd" : "a somewhat longer even string");
+            while (!client->Put(msg)) {
+                server->DoWork();
+            }
+        }
+        while ((serverReceived.Size() < numMsgs) && server->WaitForMessages(Clock::FromSeconds(5.0))) {
+            server->DoWork();
+        }
+        CHECK(serverReceived.Size() == numMsgs);
+        bool allValid = true;
+        for (int32 i = 0; i < serverReceived.Size(); i++) {
+            allValid &= serverReceived[i]->GetInt32Val() == i;
+            allValid &= serverReceived[i]->GetStringVal() == (i & 1 ? "odd" : "a somewhat longer even string");
+        }
+        CHECK(allValid);
+        
+        for (int32 i = 0; i < 1000; i++) {
+            Ptr<TestProtocol::TestMsg1> reply = TestProtocol::TestMsg1::Create();
+            reply->SetInt32Val(i);
+            CHECK(server->Put(reply));
+        }
+        while ((numClientReceived < (connection + 1) * 1000) && client->WaitForMessages(Clock::FromSeconds(5.0))) {
+            client->DoWork();
+        }
+        CHECK(numClientReceived == (connection + 1) * 1000);
+        
+        const SocketPort::Stats stats = client->GetStats();
+        CHECK(stats.BytesSent * 3 < stats.RawBytesSent);
+        CHECK(stats.RawBytesReceived > stats.BytesReceived);
+        CHECK(stats.CompressTime > 0);
+        CHECK(stats.DecompressTime > 0);
+        CHECK(server->GetStats().RawBytesReceived == stats.RawBytesSent);
+        client->Close();
+        for (int32 i = 0; (i < 500) && server->IsConnected(); i++) {
+            usleep(1000);
+        }
+    }
+    server->Close();
+}
+
+//------------------------------------------------------------------------------
+TEST(SocketPortBenchmark) {
+    const String path = socketPath("bench");
+    
+    int64 numReceived = 0;
+    int64 bytesReceived = 0;
+    Ptr<Dispatcher<TestProtocol>> dispatcher = Dispatcher<TestProtocol>::Create();
+    dispatcher->Subscribe<TestProtocol::TestViewMsg>([&](const Ptr<TestProtocol::TestViewMsg>& msg) {
+        numReceived++;
+        bytesReceived += msg->GetPayload().Size();
+    });
+    Ptr<SocketPort> server = SocketPort::Create();
+    Ptr<SocketPort> client = SocketPort::Create();
+    CHECK(server->Listen<TestProtocol>(path.AsCStr(), dispatcher));
+    CHECK(client->Connect<TestProtocol>(path.AsCStr(), Dispatcher<TestProtocol>::Create()));
+    CHECK(server->WaitForConnection(Clock::FromSeconds(5.0)));
+    
+    // messages per second by payload size, sender and receiver in
+    // the same thread (the IO threads do the socket work), Put() 
+    // would wait for DoWork() forever if it blocked when full
+    client->SetOverflow(Overflow::Reject);
+    const int32 payloadSizes[] = { 16, 64, 256, 1024, 4096, 16384 };
+    for (int32 payloadSize : payloadSizes) {
+        int32 numMsgs = (64 * 1024 * 1024) / payloadSize;
+        numMsgs = numMsgs > 100000 ? 100000 : numMsgs;
+        Array<uint8> payload;
+        payload.Reserve(payloadSize);
+        for (int32 i = 0; i < payloadSize; i++) {
+            payload.AddBack(uint8(i));
+        }
+        Ptr<TestProtocol::TestViewMsg> msg = TestProtocol::TestViewMsg::Create();
+        msg->SetPayload(payload);
+        
+        const SocketPort::Stats before = client->GetStats();
+        const SocketPort::Stats serverBefore = server->GetStats();
+        numReceived = 0;
+        bytesReceived = 0;
+        const Clock::Ticks start = Clock::Now();
+        for (int32 i = 0; i < numMsgs; i++) {
+            msg->SetId(i);
+            while (!client->Put(msg)) {
+                server->DoWork();
+            }
+            if ((i & 255) == 255) {
+                server->DoWork();
+            }
+        }
+        while ((numReceived < numMsgs) && server->WaitForMessages(Clock::FromSeconds(5.0))) {
+            server->DoWork();
+        }
+        const float64 secs = Clock::ToSeconds(Clock::Since(start));
+        CHECK(numReceived == numMsgs);
+        CHECK(bytesReceived == int64(numMsgs) * payloadSize);
+        const SocketPort::Stats after = client->GetStats();
+        const SocketPort::Stats serverAfter = server->GetStats();
+        const int64 numWrites = after.NumWrites - before.NumWrites;
+        const int64 numReads = serverAfter.NumReads - serverBefore.NumReads;
+        Log::Info("SocketPort %5d bytes: %.3f Mmsgs/s, %.1f MB/s, %.1f msgs/write, %.1f msgs/read\n",
+            payloadSize, (numMsgs / secs) / 1000000.0, 
+            (float64(after.BytesSent - before.BytesSent) / secs) / (1024.0 * 1024.0),
+            float64(numMsgs) / float64(numWrites > 0 ? numWrites : 1),
+            float64(numMsgs) / float64(numReads > 0 ? numReads : 1));
+    }
+    client->Close();
+    server->Close();
+}
+//------------------------------------------------------------------------------
+TEST(SocketPortCompressionBenchmark) {
+    // throughput, wire size and compression time of a game-like 
+    // stream of small messages with each codec
+    struct setting {
+        Compression::Code codec;
+        int32 level;
+        const char* name;
+    };
+    const setting settings[] = {
+        { Compression::None, 1, "none" },
+        { Compression::Fast, 1, "fast" },
+        { Compression::Deflate, 1, "deflate 1" },
+        { Compression::Deflate, 6, "deflate 6" },
+    };
+    const int32 numMsgs = 200000;
+    for (const setting& s : settings) {
+        const String path = socketPath("compressionbench");
+        int32 numReceived = 0;
+        Ptr<Dispatcher<TestProtocol>> dispatcher = Dispatcher<TestProtocol>::Create();
+        dispatcher->Subscribe<TestProtocol::TestMsg2>([&numReceived](const Ptr<TestProtocol::TestMsg2>&) {
+            numReceived++;
+        });
+        Ptr<SocketPort> server = SocketPort::Create();
+        Ptr<SocketPort> client = SocketPort::Create();
+        client->SetCompression(s.codec, s.level);
+        CHECK(server->Listen<TestProtocol>(path.AsCStr(), dispatcher));
+        CHECK(client->Connect<TestProtocol>(path.AsCStr(), Dispatcher<TestProtocol>::Create()));
+        CHECK(server->WaitForConnection(Clock::FromSeconds(5.0)));
+        client->SetOverflow(Overflow::Reject);
+        
+        Ptr<TestProtocol::TestMsg2> msg = TestProtocol::TestMsg2::Create();
+        msg->SetStringAtomVal("move");
+        const Clock::Ticks start = Clock::Now();
+        for (int32 i = 0; i < numMsgs; i++) {
+            msg->SetInt32Val(i);
+            msg->SetFloat32Val(float32(i & 1023) * 0.25f);
+            msg->SetStringVal((i % 3) ? "player" : "enemy");
+            while (!client->Put(msg)) {
+                server->DoWork();
+            }
+            if ((i & 255) == 255) {
+                server->DoWork();
+            }
+        }
+        while ((numReceived < numMsgs) && server->WaitForMessages(Clock::FromSeconds(5.0))) {
+            server->DoWork();
+        }
+        const float64 secs = Clock::ToSeconds(Clock::Since(start));
+        CHECK(numReceived == numMsgs);
+        const SocketPort::Stats stats = client->GetStats();
+        const SocketPort::Stats serverStats = server->GetStats();
+        Log::Info("SocketPort %-9s: %.3f Mmsgs/s, %.1f wire bytes/msg, ratio %.2f, compress %.1f%%, decompress %.1f%% of the time\n",
+            s.name, (numMsgs / secs) / 1000000.0,
+            float64(stats.BytesSent) / numMsgs,
+            float64(stats.RawBytesSent) / float64(stats.BytesSent),
+            100.0 * Clock::ToSeconds(stats.CompressTime) / secs,
+            100.0 * Clock::ToSeconds(serverStats.DecompressTime) / secs);
+        client->Close();
+        server->Close();
+    }
+}
+#endif
@@ -6,6 +6,7 @@
 #include <cstring>
 #include "Messaging/Message.h"
 #include "Messaging/Serializer.h"
+#include "Messaging/CompactSerializer.h"
 #include "Messaging/Protocol.h"
 #include "Core/String/String.h"
 #include "Core/String/StringAtom.h"
@@ -14,15 +15,38 @@ namespace Oryol {
 namespace Messaging {
 class TestProtocol {
 public:
-    static ProtocolIdType GetProtocolId() {
+    static Messaging::ProtocolIdType GetProtocolId() {
         return 'TSTP';
     };
+    static bool HasProtocol(Messaging::ProtocolIdType protId) {
+        return (protId == 'TSTP') || Messaging::Protocol::HasProtocol(protId);
+    };
+    static uint32 GetWireId(Messaging::MessageIdType id) {
+        switch (id) {
+            case MessageId::TestMsg1Id: return 0x73f30b6aU;
+            case MessageId::TestMsg2Id: return 0x72f309d7U;
+            case MessageId::TestArrayMsgId: return 0x3c15d11cU;
+            case MessageId::TestViewMsgId: return 0xce88d594U;
+            default: return Messaging::Protocol::GetWireId(id);
+        }
+    };
+    static Messaging::MessageIdType FindMessageId(uint32 wireId) {
+        switch (wireId) {
+            case 0x73f30b6aU: return MessageId::TestMsg1Id;
+            case 0x72f309d7U: return MessageId::TestMsg2Id;
+            case 0x3c15d11cU: return MessageId::TestArrayMsgId;
+            case 0xce88d594U: return MessageId::TestViewMsgId;
+            default: return Messaging::Protocol::FindMessageId(wireId);
+        }
+    };
     class MessageId {
     public:
         enum {
-            TestMsg1Id = Messaging::Protocol::MessageId::NumMessageIds, 
+            FirstMessageId = Messaging::Protocol::MessageId::NumMessageIds,
+            TestMsg1Id = FirstMessageId, 
             TestMsg2Id,
             TestArrayMsgId,
+            TestViewMsgId,
             NumMessageIds
         };
         static const char* ToString(Messaging::MessageIdType c) {
@@ -30,6 +54,7 @@ public:
                 case TestMsg1Id: return "TestMsg1Id";
                 case TestMsg2Id: return "TestMsg2Id";
                 case TestArrayMsgId: return "TestArrayMsgId";
+                case TestViewMsgId: return "TestViewMsgId";
                 default: return "InvalidMessageId";
             }
         };
@@ -37,6 +62,7 @@ public:
             if (std::strcmp("TestMsg1Id", str) == 0) return TestMsg1Id;
             if (std::strcmp("TestMsg2Id", str) == 0) return TestMsg2Id;
             if (std::strcmp("TestArrayMsgId", str) == 0) return TestArrayMsgId;
+            if (std::strcmp("TestViewMsgId", str) == 0) return TestViewMsgId;
             return Messaging::InvalidMessageId;
         };
     };
@@ -51,6 +77,7 @@ public:
     public:
         TestMsg1() {
             this->msgId = MessageId::TestMsg1Id;
+            this->protId = 'TSTP';
             this->int8val = 0;
             this->int16val = -1;
             this->int32val = 0;
@@ -72,9 +99,19 @@ public:
             if (protId == 'TSTP') return true;
             else return Messaging::Message::IsMemberOf(protId);
         };
+        static const uint64 DerivedMask = 0x3ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'TSTP') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const TestMsg1*>(msg);
+        };
         virtual int32 EncodedSize() const override;
         virtual uint8* Encode(uint8* dstPtr, const uint8* maxValidPtr) const override;
         virtual const uint8* Decode(const uint8* srcPtr, const uint8* maxValidPtr) override;
+        virtual int32 CompactEncodedSize() const override;
+        virtual uint8* EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const override;
+        virtual const uint8* DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) override;
         void SetInt8Val(int8 val) {
             this->int8val = val;
         };
@@ -136,6 +173,7 @@ public:
             return this->float64val;
         };
 private:
+        int32 compactFieldsSize() const;
         int8 int8val;
         int16 int16val;
         int32 int32val;
@@ -152,6 +190,8 @@ private:
     public:
         TestMsg2() {
             this->msgId = MessageId::TestMsg2Id;
+            this->protId = 'TSTP';
+            this->priority = Messaging::Priority::High;
             this->stringval = "Test";
         };
         static Messaging::Message* FactoryCreate() {
@@ -164,9 +204,19 @@ private:
             if (protId == 'TSTP') return true;
             else return TestMsg1::IsMemberOf(protId);
         };
+        static const uint64 DerivedMask = 0x2ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'TSTP') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const TestMsg2*>(msg);
+        };
         virtual int32 EncodedSize() const override;
         virtual uint8* Encode(uint8* dstPtr, const uint8* maxValidPtr) const override;
         virtual const uint8* Decode(const uint8* srcPtr, const uint8* maxValidPtr) override;
+        virtual int32 CompactEncodedSize() const override;
+        virtual uint8* EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const override;
+        virtual const uint8* DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) override;
         void SetStringVal(const Core::String& val) {
             this->stringval = val;
         };
@@ -180,6 +230,7 @@ private:
             return this->stringatomval;
         };
 private:
+        int32 compactFieldsSize() const;
         Core::String stringval;
         Core::StringAtom stringatomval;
     };
@@ -188,6 +239,7 @@ private:
     public:
         TestArrayMsg() {
             this->msgId = MessageId::TestArrayMsgId;
+            this->protId = 'TSTP';
         };
         static Messaging::Message* FactoryCreate() {
             return (Messaging::Message*) Create();
@@ -199,9 +251,19 @@ private:
             if (protId == 'TSTP') return true;
             else return Messaging::Message::IsMemberOf(protId);
         };
+        static const uint64 DerivedMask = 0x4ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'TSTP') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const TestArrayMsg*>(msg);
+        };
         virtual int32 EncodedSize() const override;
         virtual uint8* Encode(uint8* dstPtr, const uint8* maxValidPtr) const override;
         virtual const uint8* Decode(const uint8* srcPtr, const uint8* maxValidPtr) override;
+        virtual int32 CompactEncodedSize() const override;
+        virtual uint8* EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const override;
+        virtual const uint8* DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) override;
         void SetInt32ArrayVal(const Core::Array<int32>& val) {
             this->int32arrayval = val;
         };
@@ -215,9 +277,94 @@ private:
             return this->stringarrayval;
         };
 private:
+        int32 compactFieldsSize() const;
         Core::Array<int32> int32arrayval;
         Core::Array<Core::String> stringarrayval;
     };
+    class TestViewMsg : public Messaging::Message {
+        OryolClassPoolAllocDecl(TestViewMsg);
+    public:
+        TestViewMsg() {
+            this->msgId = MessageId::TestViewMsgId;
+            this->protId = 'TSTP';
+            this->id = 0;
+            this->SetName(Core::String("Test"));
+        };
+        static Messaging::Message* FactoryCreate() {
+            return (Messaging::Message*) Create();
+        };
+        static Messaging::MessageIdType ClassMessageId() {
+            return MessageId::TestViewMsgId;
+        };
+        virtual bool IsMemberOf(Messaging::ProtocolIdType protId) const {
+            if (protId == 'TSTP') return true;
+            else return Messaging::Message::IsMemberOf(protId);
+        };
+        static const uint64 DerivedMask = 0x8ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'TSTP') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const TestViewMsg*>(msg);
+        };
+        virtual int32 EncodedSize() const override;
+        virtual uint8* Encode(uint8* dstPtr, const uint8* maxValidPtr) const override;
+        virtual const uint8* Decode(const uint8* srcPtr, const uint8* maxValidPtr) override;
+        virtual int32 CompactEncodedSize() const override;
+        virtual uint8* EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const override;
+        virtual const uint8* DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) override;
+        void SetId(int32 val) {
+            this->id = val;
+        };
+        int32 GetId() const {
+            return this->id;
+        };
+        void SetName(const Messaging::WireView<char>& val) {
+            this->name = val;
+        };
+        void SetName(const Core::String& val) {
+            this->name = Messaging::WireView<char>::Copy(val.AsCStr(), val.Length());
+        };
+        const Messaging::WireView<char>& GetName() const {
+            return this->name;
+        };
+        void SetPayload(const Messaging::WireView<uint8>& val) {
+            this->payload = val;
+        };
+        void SetPayload(const Core::Array<uint8>& val) {
+            this->payload = Messaging::WireView<uint8>::Copy(val.begin(), val.Size());
+        };
+        const Messaging::WireView<uint8>& GetPayload() const {
+            return this->payload;
+        };
+        void SetSamples(const Messaging::WireView<float32>& val) {
+            this->samples = val;
+        };
+        void SetSamples(const Core::Array<float32>& val) {
+            this->samples = Messaging::WireView<float32>::Copy(val.begin(), val.Size());
+        };
+        const Messaging::WireView<float32>& GetSamples() const {
+            return this->samples;
+        };
+private:
+        int32 compactFieldsSize() const;
+        int32 id;
+        Messaging::WireView<char> name;
+        Messaging::WireView<uint8> payload;
+        Messaging::WireView<float32> samples;
+    };
+    template<class VISITOR> static bool Visit(const Core::Ptr<Messaging::Message>& msg, VISITOR&& visitor) {
+        if (msg->ProtocolId() != GetProtocolId()) {
+            return Messaging::Protocol::Visit(msg, visitor);
+        }
+        switch (msg->MessageId()) {
+            case MessageId::TestMsg1Id: visitor(Core::Ptr<TestMsg1>(static_cast<TestMsg1*>(msg.get()))); return true;
+            case MessageId::TestMsg2Id: visitor(Core::Ptr<TestMsg2>(static_cast<TestMsg2*>(msg.get()))); return true;
+            case MessageId::TestArrayMsgId: visitor(Core::Ptr<TestArrayMsg>(static_cast<TestArrayMsg*>(msg.get()))); return true;
+            case MessageId::TestViewMsgId: visitor(Core::Ptr<TestViewMsg>(static_cast<TestViewMsg*>(msg.get()))); return true;
+            default: return false;
+        }
+    };
 };
 }
 }
@@ -20,6 +20,36 @@ TestProtocol2::Factory::Create(Messaging::MessageIdType id) {
         return jumpTable[id - Messaging::TestProtocol::MessageId::NumMessageIds]();
     };
 }
+int32 TestProtocol2::TestMsgEx::compactFieldsSize() const {
+    int32 s = 0;
+    if (this->exval2 != 0) s += Messaging::CompactSerializer::FieldSize<int8>(1, this->exval2);
+    return s;
+}
+int32 TestProtocol2::TestMsgEx::CompactEncodedSize() const {
+    return Messaging::TestProtocol::TestMsg1::CompactEncodedSize() + Messaging::CompactSerializer::GroupSize(this->compactFieldsSize());
+}
+uint8* TestProtocol2::TestMsgEx::EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const {
+    dstPtr = Messaging::TestProtocol::TestMsg1::EncodeCompact(dstPtr, maxValidPtr);
+    dstPtr = Messaging::CompactSerializer::EncodeVarint(this->compactFieldsSize(), dstPtr, maxValidPtr);
+    if (this->exval2 != 0) dstPtr = Messaging::CompactSerializer::EncodeField<int8>(1, this->exval2, dstPtr, maxValidPtr);
+    return dstPtr;
+}
+const uint8* TestProtocol2::TestMsgEx::DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) {
+    srcPtr = Messaging::TestProtocol::TestMsg1::DecodeCompact(srcPtr, maxValidPtr);
+    const uint8* endPtr = nullptr;
+    srcPtr = Messaging::CompactSerializer::DecodeGroupHeader(srcPtr, maxValidPtr, endPtr);
+    this->exval2 = 0;
+    while ((nullptr != srcPtr) && (srcPtr < endPtr)) {
+        uint32 tag = 0;
+        uint8 wireType = 0;
+        srcPtr = Messaging::CompactSerializer::DecodeKey(srcPtr, endPtr, tag, wireType);
+        switch (tag) {
+            case 1: srcPtr = Messaging::CompactSerializer::DecodeField<int8>(srcPtr, endPtr, wireType, this->exval2); break;
+            default: srcPtr = Messaging::CompactSerializer::SkipField(srcPtr, endPtr, wireType); break;
+        }
+    }
+    return srcPtr;
+}
 int32 TestProtocol2::TestMsgEx::EncodedSize() const {
     int32 s = Messaging::TestProtocol::TestMsg1::EncodedSize();
     s += Messaging::Serializer::EncodedSize<int8>(this->exval2);
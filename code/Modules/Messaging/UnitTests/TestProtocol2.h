@@ -6,19 +6,36 @@
 #include <cstring>
 #include "Messaging/Message.h"
 #include "Messaging/Serializer.h"
+#include "Messaging/CompactSerializer.h"
 #include "Messaging/UnitTests/TestProtocol.h"
 
 namespace Oryol {
 namespace Messaging {
 class TestProtocol2 {
 public:
-    static ProtocolIdType GetProtocolId() {
+    static Messaging::ProtocolIdType GetProtocolId() {
         return 'TSP2';
     };
+    static bool HasProtocol(Messaging::ProtocolIdType protId) {
+        return (protId == 'TSP2') || Messaging::TestProtocol::HasProtocol(protId);
+    };
+    static uint32 GetWireId(Messaging::MessageIdType id) {
+        switch (id) {
+            case MessageId::TestMsgExId: return 0xc112f06cU;
+            default: return Messaging::TestProtocol::GetWireId(id);
+        }
+    };
+    static Messaging::MessageIdType FindMessageId(uint32 wireId) {
+        switch (wireId) {
+            case 0xc112f06cU: return MessageId::TestMsgExId;
+            default: return Messaging::TestProtocol::FindMessageId(wireId);
+        }
+    };
     class MessageId {
     public:
         enum {
-            TestMsgExId = Messaging::TestProtocol::MessageId::NumMessageIds, 
+            FirstMessageId = Messaging::TestProtocol::MessageId::NumMessageIds,
+            TestMsgExId = FirstMessageId, 
             NumMessageIds
         };
         static const char* ToString(Messaging::MessageIdType c) {
@@ -43,6 +60,7 @@ public:
     public:
         TestMsgEx() {
             this->msgId = MessageId::TestMsgExId;
+            this->protId = 'TSP2';
             this->exval2 = 0;
         };
         static Messaging::Message* FactoryCreate() {
@@ -55,9 +73,19 @@ public:
             if (protId == 'TSP2') return true;
             else return Messaging::TestProtocol::TestMsg1::IsMemberOf(protId);
         };
+        static const uint64 DerivedMask = 0x1ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'TSP2') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const TestMsgEx*>(msg);
+        };
         virtual int32 EncodedSize() const override;
         virtual uint8* Encode(uint8* dstPtr, const uint8* maxValidPtr) const override;
         virtual const uint8* Decode(const uint8* srcPtr, const uint8* maxValidPtr) override;
+        virtual int32 CompactEncodedSize() const override;
+        virtual uint8* EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const override;
+        virtual const uint8* DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) override;
         void SetExVal2(int8 val) {
             this->exval2 = val;
         };
@@ -65,8 +93,18 @@ public:
             return this->exval2;
         };
 private:
+        int32 compactFieldsSize() const;
         int8 exval2;
     };
+    template<class VISITOR> static bool Visit(const Core::Ptr<Messaging::Message>& msg, VISITOR&& visitor) {
+        if (msg->ProtocolId() != GetProtocolId()) {
+            return Messaging::TestProtocol::Visit(msg, visitor);
+        }
+        switch (msg->MessageId()) {
+            case MessageId::TestMsgExId: visitor(Core::Ptr<TestMsgEx>(static_cast<TestMsgEx*>(msg.get()))); return true;
+            default: return false;
+        }
+    };
 };
 }
 }
@@ -0,0 +1,386 @@
+//-----------------------------------------------------------------------------
+// machine generated, do not edit!
+//-----------------------------------------------------------------------------
+#include "Pre.h"
+#include "TestProtocolV2.h"
+
+namespace Oryol {
+namespace Messaging {
+OryolClassPoolAllocImpl(TestProtocolV2::TestStatusMsg);
+OryolClassPoolAllocImpl(TestProtocolV2::TestMsg1);
+OryolClassPoolAllocImpl(TestProtocolV2::TestMsg2);
+OryolClassPoolAllocImpl(TestProtocolV2::TestArrayMsg);
+OryolClassPoolAllocImpl(TestProtocolV2::TestViewMsg);
+TestProtocolV2::CreateCallback TestProtocolV2::jumpTable[TestProtocolV2::MessageId::NumMessageIds] = { 
+    &TestProtocolV2::TestStatusMsg::FactoryCreate,
+    &TestProtocolV2::TestMsg1::FactoryCreate,
+    &TestProtocolV2::TestMsg2::FactoryCreate,
+    &TestProtocolV2::TestArrayMsg::FactoryCreate,
+    &TestProtocolV2::TestViewMsg::FactoryCreate,
+};
+Messaging::Message*
+TestProtocolV2::Factory::Create(Messaging::MessageIdType id) {
+    if (id < Messaging::Protocol::MessageId::NumMessageIds) {
+        return Messaging::Protocol::Factory::Create(id);
+    }
+    else {
+        o_assert(id < TestProtocolV2::MessageId::NumMessageIds);
+        return jumpTable[id - Messaging::Protocol::MessageId::NumMessageIds]();
+    };
+}
+int32 TestProtocolV2::TestStatusMsg::compactFieldsSize() const {
+    int32 s = 0;
+    if (this->status != 0) s += Messaging::CompactSerializer::FieldSize<int32>(1, this->status);
+    return s;
+}
+int32 TestProtocolV2::TestStatusMsg::CompactEncodedSize() const {
+    return Messaging::Message::CompactEncodedSize() + Messaging::CompactSerializer::GroupSize(this->compactFieldsSize());
+}
+uint8* TestProtocolV2::TestStatusMsg::EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const {
+    dstPtr = Messaging::Message::EncodeCompact(dstPtr, maxValidPtr);
+    dstPtr = Messaging::CompactSerializer::EncodeVarint(this->compactFieldsSize(), dstPtr, maxValidPtr);
+    if (this->status != 0) dstPtr = Messaging::CompactSerializer::EncodeField<int32>(1, this->status, dstPtr, maxValidPtr);
+    return dstPtr;
+}
+const uint8* TestProtocolV2::TestStatusMsg::DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) {
+    srcPtr = Messaging::Message::DecodeCompact(srcPtr, maxValidPtr);
+    const uint8* endPtr = nullptr;
+    srcPtr = Messaging::CompactSerializer::DecodeGroupHeader(srcPtr, maxValidPtr, endPtr);
+    this->status = 0;
+    while ((nullptr != srcPtr) && (srcPtr < endPtr)) {
+        uint32 tag = 0;
+        uint8 wireType = 0;
+        srcPtr = Messaging::CompactSerializer::DecodeKey(srcPtr, endPtr, tag, wireType);
+        switch (tag) {
+            case 1: srcPtr = Messaging::CompactSerializer::DecodeField<int32>(srcPtr, endPtr, wireType, this->status); break;
+            default: srcPtr = Messaging::CompactSerializer::SkipField(srcPtr, endPtr, wireType); break;
+        }
+    }
+    return srcPtr;
+}
+namespace {
+#pragma pack(push, 1)
+struct TestStatusMsgWire {
+    int32 status;
+};
+#pragma pack(pop)
+}
+int32 TestProtocolV2::TestStatusMsg::EncodedSize() const {
+    return Messaging::Message::EncodedSize() + sizeof(TestStatusMsgWire);
+}
+uint8* TestProtocolV2::TestStatusMsg::Encode(uint8* dstPtr, const uint8* maxValidPtr) const {
+    dstPtr = Messaging::Message::Encode(dstPtr, maxValidPtr);
+    if ((nullptr == dstPtr) || ((dstPtr + sizeof(TestStatusMsgWire)) > maxValidPtr)) {
+        return nullptr;
+    }
+    TestStatusMsgWire wire;
+    wire.status = this->GetStatus();
+    std::memcpy(dstPtr, &wire, sizeof(wire));
+    return dstPtr + sizeof(wire);
+}
+const uint8* TestProtocolV2::TestStatusMsg::Decode(const uint8* srcPtr, const uint8* maxValidPtr) {
+    srcPtr = Messaging::Message::Decode(srcPtr, maxValidPtr);
+    if ((nullptr == srcPtr) || ((srcPtr + sizeof(TestStatusMsgWire)) > maxValidPtr)) {
+        return nullptr;
+    }
+    TestStatusMsgWire wire;
+    std::memcpy(&wire, srcPtr, sizeof(wire));
+    this->SetStatus(wire.status);
+    return srcPtr + sizeof(wire);
+}
+int32 TestProtocolV2::TestMsg1::compactFieldsSize() const {
+    int32 s = 0;
+    if (this->int8val != 0) s += Messaging::CompactSerializer::FieldSize<int8>(1, this->int8val);
+    if (this->int16val != -1) s += Messaging::CompactSerializer::FieldSize<int16>(2, this->int16val);
+    if (this->int32val != 0) s += Messaging::CompactSerializer::FieldSize<int32>(3, this->int32val);
+    if (this->int64val != 0) s += Messaging::CompactSerializer::FieldSize<int64>(4, this->int64val);
+    if (this->uint8val != 0) s += Messaging::CompactSerializer::FieldSize<uint8>(5, this->uint8val);
+    if (this->uint16val != 0) s += Messaging::CompactSerializer::FieldSize<uint16>(6, this->uint16val);
+    if (this->uint32val != 0) s += Messaging::CompactSerializer::FieldSize<uint32>(7, this->uint32val);
+    if (this->uint64val != 0) s += Messaging::CompactSerializer::FieldSize<uint64>(8, this->uint64val);
+    if (this->float32val != 123.0f) s += Messaging::CompactSerializer::FieldSize<float32>(9, this->float32val);
+    if (this->float64val != 12.0) s += Messaging::CompactSerializer::FieldSize<float64>(10, this->float64val);
+    return s;
+}
+int32 TestProtocolV2::TestMsg1::CompactEncodedSize() const {
+    return Messaging::Message::CompactEncodedSize() + Messaging::CompactSerializer::GroupSize(this->compactFieldsSize());
+}
+uint8* TestProtocolV2::TestMsg1::EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const {
+    dstPtr = Messaging::Message::EncodeCompact(dstPtr, maxValidPtr);
+    dstPtr = Messaging::CompactSerializer::EncodeVarint(this->compactFieldsSize(), dstPtr, maxValidPtr);
+    if (this->int8val != 0) dstPtr = Messaging::CompactSerializer::EncodeField<int8>(1, this->int8val, dstPtr, maxValidPtr);
+    if (this->int16val != -1) dstPtr = Messaging::CompactSerializer::EncodeField<int16>(2, this->int16val, dstPtr, maxValidPtr);
+    if (this->int32val != 0) dstPtr = Messaging::CompactSerializer::EncodeField<int32>(3, this->int32val, dstPtr, maxValidPtr);
+    if (this->int64val != 0) dstPtr = Messaging::CompactSerializer::EncodeField<int64>(4, this->int64val, dstPtr, maxValidPtr);
+    if (this->uint8val != 0) dstPtr = Messaging::CompactSerializer::EncodeField<uint8>(5, this->uint8val, dstPtr, maxValidPtr);
+    if (this->uint16val != 0) dstPtr = Messaging::CompactSerializer::EncodeField<uint16>(6, this->uint16val, dstPtr, maxValidPtr);
+    if (this->uint32val != 0) dstPtr = Messaging::CompactSerializer::EncodeField<uint32>(7, this->uint32val, dstPtr, maxValidPtr);
+    if (this->uint64val != 0) dstPtr = Messaging::CompactSerializer::EncodeField<uint64>(8, this->uint64val, dstPtr, maxValidPtr);
+    if (this->float32val != 123.0f) dstPtr = Messaging::CompactSerializer::EncodeField<float32>(9, this->float32val, dstPtr, maxValidPtr);
+    if (this->float64val != 12.0) dstPtr = Messaging::CompactSerializer::EncodeField<float64>(10, this->float64val, dstPtr, maxValidPtr);
+    return dstPtr;
+}
+const uint8* TestProtocolV2::TestMsg1::DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) {
+    srcPtr = Messaging::Message::DecodeCompact(srcPtr, maxValidPtr);
+    const uint8* endPtr = nullptr;
+    srcPtr = Messaging::CompactSerializer::DecodeGroupHeader(srcPtr, maxValidPtr, endPtr);
+    this->int8val = 0;
+    this->int16val = -1;
+    this->int32val = 0;
+    this->int64val = 0;
+    this->uint8val = 0;
+    this->uint16val = 0;
+    this->uint32val = 0;
+    this->uint64val = 0;
+    this->float32val = 123.0f;
+    this->float64val = 12.0;
+    while ((nullptr != srcPtr) && (srcPtr < endPtr)) {
+        uint32 tag = 0;
+        uint8 wireType = 0;
+        srcPtr = Messaging::CompactSerializer::DecodeKey(srcPtr, endPtr, tag, wireType);
+        switch (tag) {
+            case 1: srcPtr = Messaging::CompactSerializer::DecodeField<int8>(srcPtr, endPtr, wireType, this->int8val); break;
+            case 2: srcPtr = Messaging::CompactSerializer::DecodeField<int16>(srcPtr, endPtr, wireType, this->int16val); break;
+            case 3: srcPtr = Messaging::CompactSerializer::DecodeField<int32>(srcPtr, endPtr, wireType, this->int32val); break;
+            case 4: srcPtr = Messaging::CompactSerializer::DecodeField<int64>(srcPtr, endPtr, wireType, this->int64val); break;
+            case 5: srcPtr = Messaging::CompactSerializer::DecodeField<uint8>(srcPtr, endPtr, wireType, this->uint8val); break;
+            case 6: srcPtr = Messaging::CompactSerializer::DecodeField<uint16>(srcPtr, endPtr, wireType, this->uint16val); break;
+            case 7: srcPtr = Messaging::CompactSerializer::DecodeField<uint32>(srcPtr, endPtr, wireType, this->uint32val); break;
+            case 8: srcPtr = Messaging::CompactSerializer::DecodeField<uint64>(srcPtr, endPtr, wireType, this->uint64val); break;
+            case 9: srcPtr = Messaging::CompactSerializer::DecodeField<float32>(srcPtr, endPtr, wireType, this->float32val); break;
+            case 10: srcPtr = Messaging::CompactSerializer::DecodeField<float64>(srcPtr, endPtr, wireType, this->float64val); break;
+            default: srcPtr = Messaging::CompactSerializer::SkipField(srcPtr, endPtr, wireType); break;
+        }
+    }
+    return srcPtr;
+}
+namespace {
+#pragma pack(push, 1)
+struct TestMsg1Wire {
+    int8 int8val;
+    int16 int16val;
+    int32 int32val;
+    int64 int64val;
+    uint8 uint8val;
+    uint16 uint16val;
+    uint32 uint32val;
+    uint64 uint64val;
+    float32 float32val;
+    float64 float64val;
+};
+#pragma pack(pop)
+}
+int32 TestProtocolV2::TestMsg1::EncodedSize() const {
+    return Messaging::Message::EncodedSize() + sizeof(TestMsg1Wire);
+}
+uint8* TestProtocolV2::TestMsg1::Encode(uint8* dstPtr, const uint8* maxValidPtr) const {
+    dstPtr = Messaging::Message::Encode(dstPtr, maxValidPtr);
+    if ((nullptr == dstPtr) || ((dstPtr + sizeof(TestMsg1Wire)) > maxValidPtr)) {
+        return nullptr;
+    }
+    TestMsg1Wire wire;
+    wire.int8val = this->GetInt8Val();
+    wire.int16val = this->GetInt16Val();
+    wire.int32val = this->GetInt32Val();
+    wire.int64val = this->GetInt64Val();
+    wire.uint8val = this->GetUInt8Val();
+    wire.uint16val = this->GetUInt16Val();
+    wire.uint32val = this->GetUInt32Val();
+    wire.uint64val = this->GetUInt64Val();
+    wire.float32val = this->GetFloat32Val();
+    wire.float64val = this->GetFloat64Val();
+    std::memcpy(dstPtr, &wire, sizeof(wire));
+    return dstPtr + sizeof(wire);
+}
+const uint8* TestProtocolV2::TestMsg1::Decode(const uint8* srcPtr, const uint8* maxValidPtr) {
+    srcPtr = Messaging::Message::Decode(srcPtr, maxValidPtr);
+    if ((nullptr == srcPtr) || ((srcPtr + sizeof(TestMsg1Wire)) > maxValidPtr)) {
+        return nullptr;
+    }
+    TestMsg1Wire wire;
+    std::memcpy(&wire, srcPtr, sizeof(wire));
+    this->SetInt8Val(wire.int8val);
+    this->SetInt16Val(wire.int16val);
+    this->SetInt32Val(wire.int32val);
+    this->SetInt64Val(wire.int64val);
+    this->SetUInt8Val(wire.uint8val);
+    this->SetUInt16Val(wire.uint16val);
+    this->SetUInt32Val(wire.uint32val);
+    this->SetUInt64Val(wire.uint64val);
+    this->SetFloat32Val(wire.float32val);
+    this->SetFloat64Val(wire.float64val);
+    return srcPtr + sizeof(wire);
+}
+int32 TestProtocolV2::TestMsg2::compactFieldsSize() const {
+    int32 s = 0;
+    s += Messaging::CompactSerializer::FieldSize<Core::String>(1, this->stringval);
+    if (!this->stringatomval.Empty()) s += Messaging::CompactSerializer::FieldSize<Core::StringAtom>(2, this->stringatomval);
+    return s;
+}
+int32 TestProtocolV2::TestMsg2::CompactEncodedSize() const {
+    return TestMsg1::CompactEncodedSize() + Messaging::CompactSerializer::GroupSize(this->compactFieldsSize());
+}
+uint8* TestProtocolV2::TestMsg2::EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const {
+    dstPtr = TestMsg1::EncodeCompact(dstPtr, maxValidPtr);
+    dstPtr = Messaging::CompactSerializer::EncodeVarint(this->compactFieldsSize(), dstPtr, maxValidPtr);
+    dstPtr = Messaging::CompactSerializer::EncodeField<Core::String>(1, this->stringval, dstPtr, maxValidPtr);
+    if (!this->stringatomval.Empty()) dstPtr = Messaging::CompactSerializer::EncodeField<Core::StringAtom>(2, this->stringatomval, dstPtr, maxValidPtr);
+    return dstPtr;
+}
+const uint8* TestProtocolV2::TestMsg2::DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) {
+    srcPtr = TestMsg1::DecodeCompact(srcPtr, maxValidPtr);
+    const uint8* endPtr = nullptr;
+    srcPtr = Messaging::CompactSerializer::DecodeGroupHeader(srcPtr, maxValidPtr, endPtr);
+    this->stringval = "Test";
+    this->stringatomval = Core::StringAtom();
+    while ((nullptr != srcPtr) && (srcPtr < endPtr)) {
+        uint32 tag = 0;
+        uint8 wireType = 0;
+        srcPtr = Messaging::CompactSerializer::DecodeKey(srcPtr, endPtr, tag, wireType);
+        switch (tag) {
+            case 1: srcPtr = Messaging::CompactSerializer::DecodeField<Core::String>(srcPtr, endPtr, wireType, this->stringval); break;
+            case 2: srcPtr = Messaging::CompactSerializer::DecodeField<Core::StringAtom>(srcPtr, endPtr, wireType, this->stringatomval); break;
+            default: srcPtr = Messaging::CompactSerializer::SkipField(srcPtr, endPtr, wireType); break;
+        }
+    }
+    return srcPtr;
+}
+int32 TestProtocolV2::TestMsg2::EncodedSize() const {
+    int32 s = TestMsg1::EncodedSize();
+    s += Messaging::Serializer::EncodedSize<Core::String>(this->stringval);
+    s += Messaging::Serializer::EncodedSize<Core::StringAtom>(this->stringatomval);
+    return s;
+}
+uint8* TestProtocolV2::TestMsg2::Encode(uint8* dstPtr, const uint8* maxValidPtr) const {
+    dstPtr = TestMsg1::Encode(dstPtr, maxValidPtr);
+    dstPtr = Messaging::Serializer::Encode<Core::String>(this->stringval, dstPtr, maxValidPtr);
+    dstPtr = Messaging::Serializer::Encode<Core::StringAtom>(this->stringatomval, dstPtr, maxValidPtr);
+    return dstPtr;
+}
+const uint8* TestProtocolV2::TestMsg2::Decode(const uint8* srcPtr, const uint8* maxValidPtr) {
+    srcPtr = TestMsg1::Decode(srcPtr, maxValidPtr);
+    srcPtr = Messaging::Serializer::Decode<Core::String>(srcPtr, maxValidPtr, this->stringval);
+    srcPtr = Messaging::Serializer::Decode<Core::StringAtom>(srcPtr, maxValidPtr, this->stringatomval);
+    return srcPtr;
+}
+int32 TestProtocolV2::TestArrayMsg::compactFieldsSize() const {
+    int32 s = 0;
+    if (!this->int32arrayval.Empty()) s += Messaging::CompactSerializer::FieldSize<Core::Array<int32>>(1, this->int32arrayval);
+    if (!this->stringarrayval.Empty()) s += Messaging::CompactSerializer::FieldSize<Core::Array<Core::String>>(2, this->stringarrayval);
+    return s;
+}
+int32 TestProtocolV2::TestArrayMsg::CompactEncodedSize() const {
+    return Messaging::Message::CompactEncodedSize() + Messaging::CompactSerializer::GroupSize(this->compactFieldsSize());
+}
+uint8* TestProtocolV2::TestArrayMsg::EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const {
+    dstPtr = Messaging::Message::EncodeCompact(dstPtr, maxValidPtr);
+    dstPtr = Messaging::CompactSerializer::EncodeVarint(this->compactFieldsSize(), dstPtr, maxValidPtr);
+    if (!this->int32arrayval.Empty()) dstPtr = Messaging::CompactSerializer::EncodeField<Core::Array<int32>>(1, this->int32arrayval, dstPtr, maxValidPtr);
+    if (!this->stringarrayval.Empty()) dstPtr = Messaging::CompactSerializer::EncodeField<Core::Array<Core::String>>(2, this->stringarrayval, dstPtr, maxValidPtr);
+    return dstPtr;
+}
+const uint8* TestProtocolV2::TestArrayMsg::DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) {
+    srcPtr = Messaging::Message::DecodeCompact(srcPtr, maxValidPtr);
+    const uint8* endPtr = nullptr;
+    srcPtr = Messaging::CompactSerializer::DecodeGroupHeader(srcPtr, maxValidPtr, endPtr);
+    this->int32arrayval = Core::Array<int32>();
+    this->stringarrayval = Core::Array<Core::String>();
+    while ((nullptr != srcPtr) && (srcPtr < endPtr)) {
+        uint32 tag = 0;
+        uint8 wireType = 0;
+        srcPtr = Messaging::CompactSerializer::DecodeKey(srcPtr, endPtr, tag, wireType);
+        switch (tag) {
+            case 1: srcPtr = Messaging::CompactSerializer::DecodeField<Core::Array<int32>>(srcPtr, endPtr, wireType, this->int32arrayval); break;
+            case 2: srcPtr = Messaging::CompactSerializer::DecodeField<Core::Array<Core::String>>(srcPtr, endPtr, wireType, this->stringarrayval); break;
+            default: srcPtr = Messaging::CompactSerializer::SkipField(srcPtr, endPtr, wireType); break;
+        }
+    }
+    return srcPtr;
+}
+int32 TestProtocolV2::TestArrayMsg::EncodedSize() const {
+    int32 s = Messaging::Message::EncodedSize();
+    s += Messaging::Serializer::EncodedArraySize<int32>(this->int32arrayval);
+    s += Messaging::Serializer::EncodedArraySize<Core::String>(this->stringarrayval);
+    return s;
+}
+uint8* TestProtocolV2::TestArrayMsg::Encode(uint8* dstPtr, const uint8* maxValidPtr) const {
+    dstPtr = Messaging::Message::Encode(dstPtr, maxValidPtr);
+    dstPtr = Messaging::Serializer::EncodeArray<int32>(this->int32arrayval, dstPtr, maxValidPtr);
+    dstPtr = Messaging::Serializer::EncodeArray<Core::String>(this->stringarrayval, dstPtr, maxValidPtr);
+    return dstPtr;
+}
+const uint8* TestProtocolV2::TestArrayMsg::Decode(const uint8* srcPtr, const uint8* maxValidPtr) {
+    srcPtr = Messaging::Message::Decode(srcPtr, maxValidPtr);
+    srcPtr = Messaging::Serializer::DecodeArray<int32>(srcPtr, maxValidPtr, this->int32arrayval);
+    srcPtr = Messaging::Serializer::DecodeArray<Core::String>(srcPtr, maxValidPtr, this->stringarrayval);
+    return srcPtr;
+}
+int32 TestProtocolV2::TestViewMsg::compactFieldsSize() const {
+    int32 s = 0;
+    if (this->id != 0) s += Messaging::CompactSerializer::FieldSize<int32>(1, this->id);
+    s += Messaging::CompactSerializer::FieldSize<Messaging::WireView<char>>(2, this->name);
+    if (!this->payload.Empty()) s += Messaging::CompactSerializer::FieldSize<Messaging::WireView<uint8>>(3, this->payload);
+    if (!this->samples.Empty()) s += Messaging::CompactSerializer::FieldSize<Messaging::WireView<float32>>(4, this->samples);
+    return s;
+}
+int32 TestProtocolV2::TestViewMsg::CompactEncodedSize() const {
+    return Messaging::Message::CompactEncodedSize() + Messaging::CompactSerializer::GroupSize(this->compactFieldsSize());
+}
+uint8* TestProtocolV2::TestViewMsg::EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const {
+    dstPtr = Messaging::Message::EncodeCompact(dstPtr, maxValidPtr);
+    dstPtr = Messaging::CompactSerializer::EncodeVarint(this->compactFieldsSize(), dstPtr, maxValidPtr);
+    if (this->id != 0) dstPtr = Messaging::CompactSerializer::EncodeField<int32>(1, this->id, dstPtr, maxValidPtr);
+    dstPtr = Messaging::CompactSerializer::EncodeField<Messaging::WireView<char>>(2, this->name, dstPtr, maxValidPtr);
+    if (!this->payload.Empty()) dstPtr = Messaging::CompactSerializer::EncodeField<Messaging::WireView<uint8>>(3, this->payload, dstPtr, maxValidPtr);
+    if (!this->samples.Empty()) dstPtr = Messaging::CompactSerializer::EncodeField<Messaging::WireView<float32>>(4, this->samples, dstPtr, maxValidPtr);
+    return dstPtr;
+}
+const uint8* TestProtocolV2::TestViewMsg::DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) {
+    srcPtr = Messaging::Message::DecodeCompact(srcPtr, maxValidPtr);
+    const uint8* endPtr = nullptr;
+    srcPtr = Messaging::CompactSerializer::DecodeGroupHeader(srcPtr, maxValidPtr, endPtr);
+    this->id = 0;
+    this->name = Messaging::WireView<char>();
+    this->SetName(Core::String("Test"));
+    this->payload = Messaging::WireView<uint8>();
+    this->samples = Messaging::WireView<float32>();
+    while ((nullptr != srcPtr) && (srcPtr < endPtr)) {
+        uint32 tag = 0;
+        uint8 wireType = 0;
+        srcPtr = Messaging::CompactSerializer::DecodeKey(srcPtr, endPtr, tag, wireType);
+        switch (tag) {
+            case 1: srcPtr = Messaging::CompactSerializer::DecodeField<int32>(srcPtr, endPtr, wireType, this->id); break;
+            case 2: srcPtr = Messaging::CompactSerializer::DecodeField<Messaging::WireView<char>>(srcPtr, endPtr, wireType, this->name); break;
+            case 3: srcPtr = Messaging::CompactSerializer::DecodeField<Messaging::WireView<uint8>>(srcPtr, endPtr, wireType, this->payload); break;
+            case 4: srcPtr = Messaging::CompactSerializer::DecodeField<Messaging::WireView<float32>>(srcPtr, endPtr, wireType, this->samples); break;
+            default: srcPtr = Messaging::CompactSerializer::SkipField(srcPtr, endPtr, wireType); break;
+        }
+    }
+    return srcPtr;
+}
+int32 TestProtocolV2::TestViewMsg::EncodedSize() const {
+    int32 s = Messaging::Message::EncodedSize();
+    s += Messaging::Serializer::EncodedSize<int32>(this->id);
+    s += Messaging::Serializer::EncodedViewSize<char>(this->name);
+    s += Messaging::Serializer::EncodedViewSize<uint8>(this->payload);
+    s += Messaging::Serializer::EncodedViewSize<float32>(this->samples);
+    return s;
+}
+uint8* TestProtocolV2::TestViewMsg::Encode(uint8* dstPtr, const uint8* maxValidPtr) const {
+    dstPtr = Messaging::Message::Encode(dstPtr, maxValidPtr);
+    dstPtr = Messaging::Serializer::Encode<int32>(this->id, dstPtr, maxValidPtr);
+    dstPtr = Messaging::Serializer::EncodeView<char>(this->name, dstPtr, maxValidPtr);
+    dstPtr = Messaging::Serializer::EncodeView<uint8>(this->payload, dstPtr, maxValidPtr);
+    dstPtr = Messaging::Serializer::EncodeView<float32>(this->samples, dstPtr, maxValidPtr);
+    return dstPtr;
+}
+const uint8* TestProtocolV2::TestViewMsg::Decode(const uint8* srcPtr, const uint8* maxValidPtr) {
+    srcPtr = Messaging::Message::Decode(srcPtr, maxValidPtr);
+    srcPtr = Messaging::Serializer::Decode<int32>(srcPtr, maxValidPtr, this->id);
+    srcPtr = Messaging::Serializer::DecodeView<char>(srcPtr, maxValidPtr, this->decodeBuffer, this->name);
+    srcPtr = Messaging::Serializer::DecodeView<uint8>(srcPtr, maxValidPtr, this->decodeBuffer, this->payload);
+    srcPtr = Messaging::Serializer::DecodeView<float32>(srcPtr, maxValidPtr, this->decodeBuffer, this->samples);
+    return srcPtr;
+}
+}
+}
@@ -0,0 +1,417 @@
+#pragma once
+//-----------------------------------------------------------------------------
+/*
+    machine generated, do not edit!
+*/
+#include <cstring>
+#include "Messaging/Message.h"
+#include "Messaging/Serializer.h"
+#include "Messaging/CompactSerializer.h"
+#include "Messaging/Protocol.h"
+#include "Core/String/String.h"
+#include "Core/String/StringAtom.h"
+
+namespace Oryol {
+namespace Messaging {
+class TestProtocolV2 {
+public:
+    static Messaging::ProtocolIdType GetProtocolId() {
+        return 'TSTP';
+    };
+    static bool HasProtocol(Messaging::ProtocolIdType protId) {
+        return (protId == 'TSTP') || Messaging::Protocol::HasProtocol(protId);
+    };
+    static uint32 GetWireId(Messaging::MessageIdType id) {
+        switch (id) {
+            case MessageId::TestStatusMsgId: return 0x8d1d7c4dU;
+            case MessageId::TestMsg1Id: return 0x73f30b6aU;
+            case MessageId::TestMsg2Id: return 0x72f309d7U;
+            case MessageId::TestArrayMsgId: return 0x3c15d11cU;
+            case MessageId::TestViewMsgId: return 0xce88d594U;
+            default: return Messaging::Protocol::GetWireId(id);
+        }
+    };
+    static Messaging::MessageIdType FindMessageId(uint32 wireId) {
+        switch (wireId) {
+            case 0x8d1d7c4dU: return MessageId::TestStatusMsgId;
+            case 0x73f30b6aU: return MessageId::TestMsg1Id;
+            case 0x72f309d7U: return MessageId::TestMsg2Id;
+            case 0x3c15d11cU: return MessageId::TestArrayMsgId;
+            case 0xce88d594U: return MessageId::TestViewMsgId;
+            default: return Messaging::Protocol::FindMessageId(wireId);
+        }
+    };
+    class MessageId {
+    public:
+        enum {
+            FirstMessageId = Messaging::Protocol::MessageId::NumMessageIds,
+            TestStatusMsgId = FirstMessageId, 
+            TestMsg1Id,
+            TestMsg2Id,
+            TestArrayMsgId,
+            TestViewMsgId,
+            NumMessageIds
+        };
+        static const char* ToString(Messaging::MessageIdType c) {
+            switch (c) {
+                case TestStatusMsgId: return "TestStatusMsgId";
+                case TestMsg1Id: return "TestMsg1Id";
+                case TestMsg2Id: return "TestMsg2Id";
+                case TestArrayMsgId: return "TestArrayMsgId";
+                case TestViewMsgId: return "TestViewMsgId";
+                default: return "InvalidMessageId";
+            }
+        };
+        static Messaging::MessageIdType FromString(const char* str) {
+            if (std::strcmp("TestStatusMsgId", str) == 0) return TestStatusMsgId;
+            if (std::strcmp("TestMsg1Id", str) == 0) return TestMsg1Id;
+            if (std::strcmp("TestMsg2Id", str) == 0) return TestMsg2Id;
+            if (std::strcmp("TestArrayMsgId", str) == 0) return TestArrayMsgId;
+            if (std::strcmp("TestViewMsgId", str) == 0) return TestViewMsgId;
+            return Messaging::InvalidMessageId;
+        };
+    };
+    typedef Messaging::Message* (*CreateCallback)();
+    static CreateCallback jumpTable[TestProtocolV2::MessageId::NumMessageIds];
+    class Factory {
+    public:
+        static Messaging::Message* Create(Messaging::MessageIdType id);
+    };
+    class TestStatusMsg : public Messaging::Message {
+        OryolClassPoolAllocDecl(TestStatusMsg);
+    public:
+        TestStatusMsg() {
+            this->msgId = MessageId::TestStatusMsgId;
+            this->protId = 'TSTP';
+            this->status = 0;
+        };
+        static Messaging::Message* FactoryCreate() {
+            return (Messaging::Message*) Create();
+        };
+        static Messaging::MessageIdType ClassMessageId() {
+            return MessageId::TestStatusMsgId;
+        };
+        virtual bool IsMemberOf(Messaging::ProtocolIdType protId) const {
+            if (protId == 'TSTP') return true;
+            else return Messaging::Message::IsMemberOf(protId);
+        };
+        static const uint64 DerivedMask = 0x1ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'TSTP') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const TestStatusMsg*>(msg);
+        };
+        virtual int32 EncodedSize() const override;
+        virtual uint8* Encode(uint8* dstPtr, const uint8* maxValidPtr) const override;
+        virtual const uint8* Decode(const uint8* srcPtr, const uint8* maxValidPtr) override;
+        virtual int32 CompactEncodedSize() const override;
+        virtual uint8* EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const override;
+        virtual const uint8* DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) override;
+        void SetStatus(int32 val) {
+            this->status = val;
+        };
+        int32 GetStatus() const {
+            return this->status;
+        };
+private:
+        int32 compactFieldsSize() const;
+        int32 status;
+    };
+    class TestMsg1 : public Messaging::Message {
+        OryolClassPoolAllocDecl(TestMsg1);
+    public:
+        TestMsg1() {
+            this->msgId = MessageId::TestMsg1Id;
+            this->protId = 'TSTP';
+            this->int8val = 0;
+            this->int16val = -1;
+            this->int32val = 0;
+            this->int64val = 0;
+            this->uint8val = 0;
+            this->uint16val = 0;
+            this->uint32val = 0;
+            this->uint64val = 0;
+            this->float32val = 123.0f;
+            this->float64val = 12.0;
+        };
+        static Messaging::Message* FactoryCreate() {
+            return (Messaging::Message*) Create();
+        };
+        static Messaging::MessageIdType ClassMessageId() {
+            return MessageId::TestMsg1Id;
+        };
+        virtual bool IsMemberOf(Messaging::ProtocolIdType protId) const {
+            if (protId == 'TSTP') return true;
+            else return Messaging::Message::IsMemberOf(protId);
+        };
+        static const uint64 DerivedMask = 0x6ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'TSTP') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const TestMsg1*>(msg);
+        };
+        virtual int32 EncodedSize() const override;
+        virtual uint8* Encode(uint8* dstPtr, const uint8* maxValidPtr) const override;
+        virtual const uint8* Decode(const uint8* srcPtr, const uint8* maxValidPtr) override;
+        virtual int32 CompactEncodedSize() const override;
+        virtual uint8* EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const override;
+        virtual const uint8* DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) override;
+        void SetInt8Val(int8 val) {
+            this->int8val = val;
+        };
+        int8 GetInt8Val() const {
+            return this->int8val;
+        };
+        void SetInt16Val(int16 val) {
+            this->int16val = val;
+        };
+        int16 GetInt16Val() const {
+            return this->int16val;
+        };
+        void SetInt32Val(int32 val) {
+            this->int32val = val;
+        };
+        int32 GetInt32Val() const {
+            return this->int32val;
+        };
+        void SetInt64Val(int64 val) {
+            this->int64val = val;
+        };
+        int64 GetInt64Val() const {
+            return this->int64val;
+        };
+        void SetUInt8Val(uint8 val) {
+            this->uint8val = val;
+        };
+        uint8 GetUInt8Val() const {
+            return this->uint8val;
+        };
+        void SetUInt16Val(uint16 val) {
+            this->uint16val = val;
+        };
+        uint16 GetUInt16Val() const {
+            return this->uint16val;
+        };
+        void SetUInt32Val(uint32 val) {
+            this->uint32val = val;
+        };
+        uint32 GetUInt32Val() const {
+            return this->uint32val;
+        };
+        void SetUInt64Val(uint64 val) {
+            this->uint64val = val;
+        };
+        uint64 GetUInt64Val() const {
+            return this->uint64val;
+        };
+        void SetFloat32Val(float32 val) {
+            this->float32val = val;
+        };
+        float32 GetFloat32Val() const {
+            return this->float32val;
+        };
+        void SetFloat64Val(float64 val) {
+            this->float64val = val;
+        };
+        float64 GetFloat64Val() const {
+            return this->float64val;
+        };
+private:
+        int32 compactFieldsSize() const;
+        int8 int8val;
+        int16 int16val;
+        int32 int32val;
+        int64 int64val;
+        uint8 uint8val;
+        uint16 uint16val;
+        uint32 uint32val;
+        uint64 uint64val;
+        float32 float32val;
+        float64 float64val;
+    };
+    class TestMsg2 : public TestMsg1 {
+        OryolClassPoolAllocDecl(TestMsg2);
+    public:
+        TestMsg2() {
+            this->msgId = MessageId::TestMsg2Id;
+            this->protId = 'TSTP';
+            this->priority = Messaging::Priority::High;
+            this->stringval = "Test";
+        };
+        static Messaging::Message* FactoryCreate() {
+            return (Messaging::Message*) Create();
+        };
+        static Messaging::MessageIdType ClassMessageId() {
+            return MessageId::TestMsg2Id;
+        };
+        virtual bool IsMemberOf(Messaging::ProtocolIdType protId) const {
+            if (protId == 'TSTP') return true;
+            else return TestMsg1::IsMemberOf(protId);
+        };
+        static const uint64 DerivedMask = 0x4ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'TSTP') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const TestMsg2*>(msg);
+        };
+        virtual int32 EncodedSize() const override;
+        virtual uint8* Encode(uint8* dstPtr, const uint8* maxValidPtr) const override;
+        virtual const uint8* Decode(const uint8* srcPtr, const uint8* maxValidPtr) override;
+        virtual int32 CompactEncodedSize() const override;
+        virtual uint8* EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const override;
+        virtual const uint8* DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) override;
+        void SetStringVal(const Core::String& val) {
+            this->stringval = val;
+        };
+        const Core::String& GetStringVal() const {
+            return this->stringval;
+        };
+        void SetStringAtomVal(const Core::StringAtom& val) {
+            this->stringatomval = val;
+        };
+        const Core::StringAtom& GetStringAtomVal() const {
+            return this->stringatomval;
+        };
+private:
+        int32 compactFieldsSize() const;
+        Core::String stringval;
+        Core::StringAtom stringatomval;
+    };
+    class TestArrayMsg : public Messaging::Message {
+        OryolClassPoolAllocDecl(TestArrayMsg);
+    public:
+        TestArrayMsg() {
+            this->msgId = MessageId::TestArrayMsgId;
+            this->protId = 'TSTP';
+        };
+        static Messaging::Message* FactoryCreate() {
+            return (Messaging::Message*) Create();
+        };
+        static Messaging::MessageIdType ClassMessageId() {
+            return MessageId::TestArrayMsgId;
+        };
+        virtual bool IsMemberOf(Messaging::ProtocolIdType protId) const {
+            if (protId == 'TSTP') return true;
+            else return Messaging::Message::IsMemberOf(protId);
+        };
+        static const uint64 DerivedMask = 0x8ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'TSTP') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const TestArrayMsg*>(msg);
+        };
+        virtual int32 EncodedSize() const override;
+        virtual uint8* Encode(uint8* dstPtr, const uint8* maxValidPtr) const override;
+        virtual const uint8* Decode(const uint8* srcPtr, const uint8* maxValidPtr) override;
+        virtual int32 CompactEncodedSize() const override;
+        virtual uint8* EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const override;
+        virtual const uint8* DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) override;
+        void SetInt32ArrayVal(const Core::Array<int32>& val) {
+            this->int32arrayval = val;
+        };
+        const Core::Array<int32>& GetInt32ArrayVal() const {
+            return this->int32arrayval;
+        };
+        void SetStringArrayVal(const Core::Array<Core::String>& val) {
+            this->stringarrayval = val;
+        };
+        const Core::Array<Core::String>& GetStringArrayVal() const {
+            return this->stringarrayval;
+        };
+private:
+        int32 compactFieldsSize() const;
+        Core::Array<int32> int32arrayval;
+        Core::Array<Core::String> stringarrayval;
+    };
+    class TestViewMsg : public Messaging::Message {
+        OryolClassPoolAllocDecl(TestViewMsg);
+    public:
+        TestViewMsg() {
+            this->msgId = MessageId::TestViewMsgId;
+            this->protId = 'TSTP';
+            this->id = 0;
+            this->SetName(Core::String("Test"));
+        };
+        static Messaging::Message* FactoryCreate() {
+            return (Messaging::Message*) Create();
+        };
+        static Messaging::MessageIdType ClassMessageId() {
+            return MessageId::TestViewMsgId;
+        };
+        virtual bool IsMemberOf(Messaging::ProtocolIdType protId) const {
+            if (protId == 'TSTP') return true;
+            else return Messaging::Message::IsMemberOf(protId);
+        };
+        static const uint64 DerivedMask = 0x10ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'TSTP') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const TestViewMsg*>(msg);
+        };
+        virtual int32 EncodedSize() const override;
+        virtual uint8* Encode(uint8* dstPtr, const uint8* maxValidPtr) const override;
+        virtual const uint8* Decode(const uint8* srcPtr, const uint8* maxValidPtr) override;
+        virtual int32 CompactEncodedSize() const override;
+        virtual uint8* EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const override;
+        virtual const uint8* DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) override;
+        void SetId(int32 val) {
+            this->id = val;
+        };
+        int32 GetId() const {
+            return this->id;
+        };
+        void SetName(const Messaging::WireView<char>& val) {
+            this->name = val;
+        };
+        void SetName(const Core::String& val) {
+            this->name = Messaging::WireView<char>::Copy(val.AsCStr(), val.Length());
+        };
+        const Messaging::WireView<char>& GetName() const {
+            return this->name;
+        };
+        void SetPayload(const Messaging::WireView<uint8>& val) {
+            this->payload = val;
+        };
+        void SetPayload(const Core::Array<uint8>& val) {
+            this->payload = Messaging::WireView<uint8>::Copy(val.begin(), val.Size());
+        };
+        const Messaging::WireView<uint8>& GetPayload() const {
+            return this->payload;
+        };
+        void SetSamples(const Messaging::WireView<float32>& val) {
+            this->samples = val;
+        };
+        void SetSamples(const Core::Array<float32>& val) {
+            this->samples = Messaging::WireView<float32>::Copy(val.begin(), val.Size());
+        };
+        const Messaging::WireView<float32>& GetSamples() const {
+            return this->samples;
+        };
+private:
+        int32 compactFieldsSize() const;
+        int32 id;
+        Messaging::WireView<char> name;
+        Messaging::WireView<uint8> payload;
+        Messaging::WireView<float32> samples;
+    };
+    template<class VISITOR> static bool Visit(const Core::Ptr<Messaging::Message>& msg, VISITOR&& visitor) {
+        if (msg->ProtocolId() != GetProtocolId()) {
+            return Messaging::Protocol::Visit(msg, visitor);
+        }
+        switch (msg->MessageId()) {
+            case MessageId::TestStatusMsgId: visitor(Core::Ptr<TestStatusMsg>(static_cast<TestStatusMsg*>(msg.get()))); return true;
+            case MessageId::TestMsg1Id: visitor(Core::Ptr<TestMsg1>(static_cast<TestMsg1*>(msg.get()))); return true;
+            case MessageId::TestMsg2Id: visitor(Core::Ptr<TestMsg2>(static_cast<TestMsg2*>(msg.get()))); return true;
+            case MessageId::TestArrayMsgId: visitor(Core::Ptr<TestArrayMsg>(static_cast<TestArrayMsg*>(msg.get()))); return true;
+            case MessageId::TestViewMsgId: visitor(Core::Ptr<TestViewMsg>(static_cast<TestViewMsg*>(msg.get()))); return true;
+            default: return false;
+        }
+    };
+};
+}
+}
@@ -0,0 +1,165 @@
+//------------------------------------------------------------------------------
+//  ThreadPoolQueueTest.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Messaging/ThreadPoolQueue.h"
+#include "Messaging/ThreadedQueue.h"
+#include "Messaging/Dispatcher.h"
+#include "Messaging/UnitTests/TestProtocol.h"
+#include "Core/Time/Clock.h"
+#include <atomic>
+#include <thread>
+
+using namespace Oryol;
+using namespace Oryol::Core;
+using namespace Oryol::Messaging;
+
+// ThreadPoolQueue subclass which counts the thread hooks
+class countingPoolQueue : public ThreadPoolQueue {
+    OryolClassDecl(countingPoolQueue);
+public:
+    countingPoolQueue(int32 numWorkers, const Ptr<Port>& port) : ThreadPoolQueue(numWorkers, port) { };
+    std::atomic<int32> numEnter{0};
+    std::atomic<int32> numLeave{0};
+protected:
+    virtual void onThreadEnter(int32 workerIndex) override {
+        ThreadPoolQueue::onThreadEnter(workerIndex);
+        this->numEnter++;
+    };
+    virtual void onThreadLeave(int32 workerIndex) override {
+        this->numLeave++;
+        ThreadPoolQueue::onThreadLeave(workerIndex);
+    };
+};
+OryolClassImpl(countingPoolQueue);
+
+// message handler, runs in the worker threads, int8 is the affinity key + 1
+// (0 if none), int32 the sequence number per key, int16 the work in microseconds
+static const int32 NumKeys = 16;
+static std::atomic<int32> poolHandled{0};
+static int32 poolLastSeq[NumKeys];
+static bool poolOrderOk[NumKeys];
+static void HandlePoolMsg(const Ptr<TestProtocol::TestMsg1>& msg) {
+    if (msg->GetInt16Val() > 0) {
+        const Clock::Ticks end = Clock::Now() + Clock::FromMilliSeconds(msg->GetInt16Val() / 1000.0);
+        while (Clock::Now() < end) {
+            // busy
+        }
+    }
+    if (msg->GetInt8Val() > 0) {
+        const int32 key = msg->GetInt8Val() - 1;
+        if (msg->GetInt32Val() != poolLastSeq[key] + 1) {
+            poolOrderOk[key] = false;
+        }
+        poolLastSeq[key] = msg->GetInt32Val();
+    }
+    msg->SetHandled();
+    poolHandled.fetch_add(1, std::memory_order_release);
+}
+
+static Ptr<TestProtocol::TestMsg1> poolMsg(int32 key, int32 seq, int16 workMicroSecs) {
+    Ptr<TestProtocol::TestMsg1> msg = TestProtocol::TestMsg1::Create();
+    msg->SetInt8Val(int8(key + 1));
+    msg->SetInt32Val(seq);
+    msg->SetInt16Val(workMicroSecs);
+    return msg;
+}
+
+static void poolWait(int32 num) {
+    while (poolHandled.load(std::memory_order_acquire) < num) {
+        std::this_thread::yield();
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST(ThreadPoolQueueTest) {
+    Ptr<Dispatcher<TestProtocol>> disp = Dispatcher<TestProtocol>::Create();
+    disp->Subscribe<TestProtocol::TestMsg1>(&HandlePoolMsg);
+    Ptr<countingPoolQueue> pool = countingPoolQueue::Create(4, disp);
+    CHECK(pool->GetNumWorkers() == 4);
+    pool->StartThreads();
+
+    poolHandled = 0;
+    for (int32 i = 0; i < NumKeys; i++) {
+        poolLastSeq[i] = 0;
+        poolOrderOk[i] = true;
+    }
+    // messages with affinity keys must be handled in order, the
+    // messages without key are put from another thread at the same time
+    const int32 numPerKey = 500;
+    const int32 numFree = 8000;
+    std::thread producer([pool, numFree]() {
+        for (int32 i = 0; i < numFree; i++) {
+            pool->Put(poolMsg(-1, 0, 0));
+        }
+    });
+    for (int32 seq = 1; seq <= numPerKey; seq++) {
+        for (int32 key = 0; key < NumKeys; key++) {
+            pool->Put(poolMsg(key, seq, 0), key);
+        }
+    }
+    producer.join();
+    poolWait(NumKeys * numPerKey + numFree);
+    for (int32 key = 0; key < NumKeys; key++) {
+        CHECK(poolOrderOk[key]);
+        CHECK(poolLastSeq[key] == numPerKey);
+    }
+
+    pool->StopThreads();
+    CHECK(pool->numEnter == 4);
+    CHECK(pool->numLeave == 4);
+    CHECK(poolHandled == NumKeys * numPerKey + numFree);
+}
+
+//------------------------------------------------------------------------------
+TEST(ThreadPoolQueueSkewedLoadTest) {
+    // compare N lanes (one ThreadedQueue each, messages hashed onto
+    // lanes by key) with one ThreadPoolQueue with N workers, under a
+    // skewed load where half of the messages have the same key
+    const int32 numWorkers = 4;
+    const int32 numMsgs = 2000;
+    const int16 workMicroSecs = 20;
+    Ptr<Dispatcher<TestProtocol>> disp = Dispatcher<TestProtocol>::Create();
+    disp->Subscribe<TestProtocol::TestMsg1>(&HandlePoolMsg);
+    auto skewedKey = [](int32 i) {
+        return (i & 1) ? 0 : (i % 7);
+    };
+
+    // N lanes
+    Array<Ptr<ThreadedQueue>> lanes;
+    for (int32 i = 0; i < numWorkers; i++) {
+        Ptr<ThreadedQueue> lane = ThreadedQueue::Create(disp);
+        lane->SetMultiProducer(true);
+        lane->StartThread();
+        lanes.AddBack(lane);
+    }
+    poolHandled = 0;
+    Clock::Ticks start = Clock::Now();
+    for (int32 i = 0; i < numMsgs; i++) {
+        lanes[skewedKey(i) % numWorkers]->Put(poolMsg(-1, 0, workMicroSecs));
+    }
+    poolWait(numMsgs);
+    const float64 lanesMs = Clock::ToMilliSeconds(Clock::Since(start));
+    for (const auto& lane : lanes) {
+        lane->StopThread();
+    }
+    lanes.Clear();
+
+    // thread pool
+    Ptr<ThreadPoolQueue> pool = ThreadPoolQueue::Create(numWorkers, disp);
+    pool->StartThreads();
+    poolHandled = 0;
+    start = Clock::Now();
+    for (int32 i = 0; i < numMsgs; i++) {
+        pool->Put(poolMsg(-1, 0, workMicroSecs));
+    }
+    poolWait(numMsgs);
+    const float64 poolMs = Clock::ToMilliSeconds(Clock::Since(start));
+    pool->StopThreads();
+    CHECK(poolHandled == numMsgs);
+
+    Log::Info("ThreadPoolQueue: %d msgs of %dus on %d threads (%d cores): %d lanes %.2fms, pool %.2fms (%d stolen)\n",
+        numMsgs, workMicroSecs, numWorkers, int32(std::thread::hardware_concurrency()),
+        numWorkers, lanesMs, poolMs, int32(pool->GetNumStolen()));
+}
@@ -5,8 +5,16 @@
 #include "UnitTest++/src/UnitTest++.h"
 #include "Messaging/ThreadedQueue.h"
 #include "Messaging/Dispatcher.h"
+#include "Messaging/Await.h"
 #include "Messaging/UnitTests/TestProtocol.h"
+#include "Core/Time/Clock.h"
+#include "Core/Metrics.h"
+#include "Core/RunLoop.h"
+#include "Core/Containers/Array.h"
+#include <atomic>
 #include <chrono>
+#include <thread>
+#include <vector>
 
 using namespace Oryol;
 using namespace Oryol::Core;
@@ -78,3 +86,469 @@ TEST(ThreadedQueueTest) {
     threadedQueue = 0;
 }
 
+// multi-producer test, handler runs in the worker thread
+static const int32 MaxProducers = 8;
+static std::atomic<int32> mpHandled{0};
+static int32 mpLastSeq[MaxProducers];
+static bool mpOrderOk = true;
+static int64 mpLatencySum = 0;
+static void HandleMPMsg(const Ptr<TestProtocol::TestMsg1>& msg) {
+    mpLatencySum += Clock::Since(msg->GetInt64Val());
+    // messages of one producer must arrive in order
+    const int32 producer = msg->GetInt8Val();
+    if (msg->GetInt32Val() != mpLastSeq[producer] + 1) {
+        mpOrderOk = false;
+    }
+    mpLastSeq[producer] = msg->GetInt32Val();
+    msg->SetHandled();
+    mpHandled.fetch_add(1, std::memory_order_release);
+}
+
+// put numMsgs messages in batches, wait for each batch to be handled
+static void mpProduce(ThreadedQueue* queue, int32 producer, int32 numMsgs, int32 batchSize, bool callDoWork) {
+    for (int32 seq = 1; seq <= numMsgs; ) {
+        Ptr<TestProtocol::TestMsg1> msg;
+        for (int32 i = 0; (i < batchSize) && (seq <= numMsgs); i++, seq++) {
+            msg = TestProtocol::TestMsg1::Create();
+            msg->SetInt8Val(int8(producer));
+            msg->SetInt32Val(seq);
+            msg->SetInt64Val(Clock::Now());
+            queue->Put(msg);
+        }
+        while (!msg->Handled()) {
+            if (callDoWork) {
+                queue->DoWork();
+            }
+            std::this_thread::yield();
+        }
+    }
+}
+
+// run one producer configuration, log msgs per second and mean latency
+static void mpRun(int32 numProducers, bool multiProducer, int32 msgsPerProducer, int32 batchSize) {
+    Ptr<Dispatcher<TestProtocol>> disp = Dispatcher<TestProtocol>::Create();
+    disp->Subscribe<TestProtocol::TestMsg1>(&HandleMPMsg);
+    Ptr<ThreadedQueue> queue = ThreadedQueue::Create(disp);
+    queue->SetMultiProducer(multiProducer);
+    CHECK(queue->IsMultiProducer() == multiProducer);
+    queue->StartThread();
+
+    mpHandled = 0;
+    mpOrderOk = true;
+    mpLatencySum = 0;
+    for (int32 i = 0; i < MaxProducers; i++) {
+        mpLastSeq[i] = 0;
+    }
+    const int32 numMsgs = numProducers * msgsPerProducer;
+    const Clock::Ticks start = Clock::Now();
+    if (multiProducer) {
+        Array<std::thread> producers;
+        for (int32 i = 0; i < numProducers; i++) {
+            producers.AddBack(std::thread(mpProduce, queue.get(), i, msgsPerProducer, batchSize, false));
+        }
+        for (auto& t : producers) {
+            t.join();
+        }
+    }
+    else {
+        // the classic queue can only be fed from the creator thread
+        o_assert(1 == numProducers);
+        mpProduce(queue.get(), 0, msgsPerProducer, batchSize, true);
+    }
+    const float64 sec = Clock::ToSeconds(Clock::Since(start));
+    queue->StopThread();
+    queue = nullptr;
+
+    CHECK(mpHandled.load(std::memory_order_acquire) == numMsgs);
+    CHECK(mpOrderOk);
+    Log::Info("ThreadedQueue (%s, %d producers, batch %d): %.0f msgs/sec, mean latency %.1f us\n",
+        multiProducer ? "multi-producer" : "classic", numProducers, batchSize,
+        numMsgs / sec, Clock::ToMicroSeconds(mpLatencySum) / numMsgs);
+}
+
+TEST(ThreadedQueueMultiProducerTest) {
+    // throughput: batches of 1000 messages
+    const int32 msgsPerProducer = 20000;
+    mpRun(1, false, msgsPerProducer, 1000);
+    for (int32 numProducers = 1; numProducers <= MaxProducers; numProducers *= 2) {
+        mpRun(numProducers, true, msgsPerProducer, 1000);
+    }
+    // latency: one message at a time
+    mpRun(1, false, 2000, 1);
+    for (int32 numProducers = 1; numProducers <= MaxProducers; numProducers *= 2) {
+        mpRun(numProducers, true, 2000, 1);
+    }
+}
+
+// priority test, handler runs in the worker thread, int64 is the
+// put time, int16 the work in microseconds
+static Metrics::Id prioLatency[Priority::NumPriorities];
+static Array<Priority::Code> prioOrder;
+static std::atomic<int32> prioHandled{0};
+static void HandlePrioMsg(const Ptr<TestProtocol::TestMsg1>& msg) {
+    if (msg->GetInt16Val() > 0) {
+        const Clock::Ticks end = Clock::Now() + Clock::FromMilliSeconds(msg->GetInt16Val() / 1000.0);
+        while (Clock::Now() < end) {
+            // busy
+        }
+    }
+    if (0 != msg->GetInt64Val()) {
+        Metrics::Record(prioLatency[msg->GetPriority()], Clock::Since(msg->GetInt64Val()));
+    }
+    prioOrder.AddBack(msg->GetPriority());
+    msg->SetHandled();
+    prioHandled.fetch_add(1, std::memory_order_release);
+}
+
+static Ptr<TestProtocol::TestMsg1> prioMsg(Priority::Code prio, int16 workMicroSecs = 0) {
+    Ptr<TestProtocol::TestMsg1> msg = TestProtocol::TestMsg1::Create();
+    msg->SetPriority(prio);
+    msg->SetInt16Val(workMicroSecs);
+    return msg;
+}
+
+static void prioWait(ThreadedQueue* queue, int32 num) {
+    while (prioHandled.load(std::memory_order_acquire) < num) {
+        queue->DoWork();
+        std::this_thread::yield();
+    }
+}
+
+TEST(ThreadedQueuePriorityTest) {
+    // default priorities from the protocol XML
+    CHECK(TestProtocol::TestMsg1::Create()->GetPriority() == Priority::Normal);
+    CHECK(TestProtocol::TestMsg2::Create()->GetPriority() == Priority::High);
+
+    Ptr<Dispatcher<TestProtocol>> disp = Dispatcher<TestProtocol>::Create();
+    disp->Subscribe<TestProtocol::TestMsg1>(&HandlePrioMsg);
+    Ptr<ThreadedQueue> queue = ThreadedQueue::Create(disp);
+    queue->StartThread();
+
+    // high-priority messages overtake queued low-priority messages
+    prioHandled = 0;
+    prioOrder.Clear();
+    for (int32 i = 0; i < 100; i++) {
+        queue->Put(prioMsg(Priority::Low));
+    }
+    for (int32 i = 0; i < 10; i++) {
+        queue->Put(prioMsg(Priority::High));
+    }
+    prioWait(queue.get(), 110);
+    for (int32 i = 0; i < 10; i++) {
+        CHECK(prioOrder[i] == Priority::High);
+    }
+    CHECK(prioOrder[10] == Priority::Low);
+
+    // ...but can't starve them
+    prioHandled = 0;
+    prioOrder.Clear();
+    for (int32 i = 0; i < 5; i++) {
+        queue->Put(prioMsg(Priority::Low));
+    }
+    for (int32 i = 0; i < 50; i++) {
+        queue->Put(prioMsg(Priority::High));
+    }
+    prioWait(queue.get(), 55);
+    CHECK(prioOrder.FindIndexLinear(Priority::Low) == ThreadedQueue::StarvationLimit);
+
+    // messages which are still queued after their deadline are cancelled
+    prioHandled = 0;
+    Ptr<TestProtocol::TestMsg1> expired = prioMsg(Priority::Normal);
+    expired->SetDeadline(Clock::Now() - 1);
+    Ptr<TestProtocol::TestMsg1> inTime = prioMsg(Priority::Normal);
+    inTime->SetDeadline(Clock::Now() + Clock::FromSeconds(60.0));
+    queue->Put(expired);
+    queue->Put(inTime);
+    prioWait(queue.get(), 2);
+    CHECK(expired->Cancelled());
+    CHECK(!inTime->Cancelled());
+    queue->StopThread();
+    queue = nullptr;
+}
+
+TEST(ThreadedQueuePriorityLatencyTest) {
+    // mixed load: bursts of low-priority prefetch messages, a steady
+    // stream of normal messages and a few high-priority messages,
+    // log latency percentiles per priority
+    prioLatency[Priority::Low] = Metrics::RegisterHistogram("test.prio_latency_ns.low");
+    prioLatency[Priority::Normal] = Metrics::RegisterHistogram("test.prio_latency_ns.normal");
+    prioLatency[Priority::High] = Metrics::RegisterHistogram("test.prio_latency_ns.high");
+    Ptr<Dispatcher<TestProtocol>> disp = Dispatcher<TestProtocol>::Create();
+    disp->Subscribe<TestProtocol::TestMsg1>(&HandlePrioMsg);
+    Ptr<ThreadedQueue> queue = ThreadedQueue::Create(disp);
+    queue->SetMultiProducer(true);
+    queue->StartThread();
+
+    prioHandled = 0;
+    prioOrder.Clear();
+    const int16 work = 10;
+    int32 numMsgs = 0;
+    for (int32 round = 0; round < 10; round++) {
+        for (int32 i = 0; i < 200; i++, numMsgs++) {
+            Ptr<TestProtocol::TestMsg1> msg = prioMsg(Priority::Low, work);
+            msg->SetInt64Val(Clock::Now());
+            queue->Put(msg);
+        }
+        for (int32 i = 0; i < 40; i++, numMsgs++) {
+            Ptr<TestProtocol::TestMsg1> msg = prioMsg((i % 10) ? Priority::Normal : Priority::High, work);
+            msg->SetInt64Val(Clock::Now());
+            queue->Put(msg);
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+    prioWait(queue.get(), numMsgs);
+    queue->StopThread();
+    queue = nullptr;
+
+    Array<Metrics::Sample> samples = Metrics::Collect();
+    int64 p50[Priority::NumPriorities] = { };
+    const char* names[Priority::NumPriorities] = { "low", "normal", "high" };
+    for (const Metrics::Sample& s : samples) {
+        for (int32 prio = 0; prio < Priority::NumPriorities; prio++) {
+            if (Metrics::Find(s.Name.AsCStr()) == prioLatency[prio]) {
+                p50[prio] = s.P50;
+                Log::Info("ThreadedQueue latency (%s): count=%d p50=%.1fus p90=%.1fus p99=%.1fus max=%.1fus\n",
+                    names[prio], int32(s.Value), Clock::ToMicroSeconds(s.P50), Clock::ToMicroSeconds(s.P90),
+                    Clock::ToMicroSeconds(s.P99), Clock::ToMicroSeconds(s.Max));
+            }
+        }
+    }
+    CHECK(p50[Priority::High] < p50[Priority::Low]);
+}
+
+// bounded queue test, the handler blocks until the gate is opened
+// to simulate a stalled worker
+static std::atomic<bool> boundedGate{true};
+static std::atomic<int32> boundedHandled{0};
+static void HandleBoundedMsg(const Ptr<TestProtocol::TestMsg1>& msg) {
+    while (!boundedGate.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    msg->SetHandled();
+    boundedHandled.fetch_add(1, std::memory_order_release);
+}
+
+static Ptr<ThreadedQueue> boundedQueue(int32 capacity, Overflow::Code overflow, bool multiProducer, const char* metricsName = nullptr) {
+    Ptr<Dispatcher<TestProtocol>> disp = Dispatcher<TestProtocol>::Create();
+    disp->Subscribe<TestProtocol::TestMsg1>(&HandleBoundedMsg);
+    Ptr<ThreadedQueue> queue = ThreadedQueue::Create(disp);
+    queue->SetCapacity(capacity, overflow);
+    queue->SetMultiProducer(multiProducer);
+    if (nullptr != metricsName) {
+        queue->SetMetricsName(metricsName);
+    }
+    queue->StartThread();
+    return queue;
+}
+
+// put a message and wait until the worker is stuck in its handler
+static void boundedStall(ThreadedQueue* queue) {
+    boundedGate = false;
+    queue->Put(TestProtocol::TestMsg1::Create());
+    while (queue->GetStats().NumDequeued == 0) {
+        queue->DoWork();
+        std::this_thread::yield();
+    }
+}
+
+static void boundedWait(ThreadedQueue* queue, int32 num) {
+    boundedGate = true;
+    while (boundedHandled.load(std::memory_order_acquire) < num) {
+        queue->DoWork();
+        std::this_thread::yield();
+    }
+}
+
+TEST(ThreadedQueueBoundedTest) {
+    const int32 capacity = 4;
+    
+    // reject
+    boundedHandled = 0;
+    Ptr<ThreadedQueue> queue = boundedQueue(capacity, Overflow::Reject, false);
+    CHECK(queue->GetCapacity() == capacity);
+    CHECK(queue->GetOverflow() == Overflow::Reject);
+    boundedStall(queue.get());
+    for (int32 i = 0; i < capacity; i++) {
+        CHECK(queue->Put(TestProtocol::TestMsg1::Create()));
+    }
+    CHECK(!queue->Put(TestProtocol::TestMsg1::Create()));
+    QueueStats stats = queue->GetStats();
+    CHECK(stats.Capacity == capacity);
+    CHECK(stats.Depth == capacity);
+    CHECK(stats.HighWater == capacity);
+    CHECK(stats.NumRejected == 1);
+    boundedWait(queue.get(), capacity + 1);
+    queue->StopThread();
+    stats = queue->GetStats();
+    CHECK(stats.Depth == 0);
+    CHECK(stats.NumEnqueued == capacity + 1);
+    CHECK(stats.NumDequeued == capacity + 1);
+    CHECK(stats.MaxLatency > 0);
+    CHECK(stats.MaxLatency >= stats.AvgLatency);
+    CHECK(stats.LastDequeueTime > 0);
+    
+    // drop oldest, in the default mode the producer drops
+    // and in multi-producer mode the worker drops
+    for (int32 mode = 0; mode < 2; mode++) {
+        boundedHandled = 0;
+        queue = boundedQueue(capacity, Overflow::DropOldest, 1 == mode);
+        boundedStall(queue.get());
+        Array<Ptr<TestProtocol::TestMsg1>> msgs;
+        for (int32 i = 0; i < 10; i++) {
+            msgs.AddBack(TestProtocol::TestMsg1::Create());
+            CHECK(queue->Put(msgs.Back()));
+        }
+        if (0 == mode) {
+            CHECK(queue->GetStats().HighWater == capacity);
+        }
+        boundedWait(queue.get(), capacity + 1);
+        queue->StopThread();
+        for (int32 i = 0; i < 10; i++) {
+            CHECK(msgs[i]->Handled());
+            CHECK(msgs[i]->Cancelled() == (i < 10 - capacity));
+        }
+        stats = queue->GetStats();
+        CHECK(stats.NumDropped == 10 - capacity);
+        CHECK(stats.NumDequeued == capacity + 1);
+        CHECK(stats.Depth == 0);
+    }
+    
+    // block: a producer thread waits while the worker is stalled
+    boundedHandled = 0;
+    queue = boundedQueue(capacity, Overflow::Block, true, "test_bounded");
+    boundedStall(queue.get());
+    std::atomic<bool> producerDone{false};
+    std::thread producer([&queue, &producerDone]() {
+        for (int32 i = 0; i < 10; i++) {
+            queue->Put(TestProtocol::TestMsg1::Create());
+        }
+        producerDone = true;
+    });
+    while (queue->GetStats().NumBlocked == 0) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(milliseconds(10));
+    CHECK(!producerDone);
+    CHECK(queue->GetStats().Depth == capacity);
+    boundedWait(queue.get(), 11);
+    producer.join();
+    queue->StopThread();
+    stats = queue->GetStats();
+    CHECK(stats.HighWater == capacity);
+    CHECK(stats.NumDequeued == 11);
+    CHECK(Metrics::Value(Metrics::Find("messaging.test_bounded.depth")) == 0);
+    CHECK(InvalidIndex != Metrics::Find("messaging.test_bounded.latency_ns"));
+    
+    // block in the default mode: Put() hands the queued messages to the worker itself
+    boundedHandled = 0;
+    queue = boundedQueue(2, Overflow::Block, false);
+    for (int32 i = 0; i < 1000; i++) {
+        queue->Put(TestProtocol::TestMsg1::Create());
+    }
+    boundedWait(queue.get(), 1000);
+    queue->StopThread();
+    CHECK(queue->GetStats().HighWater == 2);
+    queue = nullptr;
+}
+
+TEST(ThreadedQueueBoundedMultiProducerTest) {
+    // concurrent producers must never push the queue over its capacity
+    const int32 capacity = 4;
+    const int32 numProducers = 8;
+    const int32 msgsPerProducer = 2000;
+    
+    // reject: producers race for the free slots of a stalled worker
+    boundedHandled = 0;
+    Ptr<ThreadedQueue> queue = boundedQueue(capacity, Overflow::Reject, true);
+    boundedStall(queue.get());
+    std::atomic<bool> go{false};
+    std::atomic<int32> numAccepted{0};
+    std::vector<std::thread> producers;
+    for (int32 p = 0; p < numProducers; p++) {
+        producers.push_back(std::thread([&queue, &go, &numAccepted]() {
+            while (!go) {
+                std::this_thread::yield();
+            }
+            for (int32 i = 0; i < 100; i++) {
+                if (queue->Put(TestProtocol::TestMsg1::Create())) {
+                    numAccepted++;
+                }
+            }
+        }));
+    }
+    go = true;
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    producers.clear();
+    QueueStats stats = queue->GetStats();
+    CHECK(numAccepted == capacity);
+    CHECK(stats.Depth == capacity);
+    CHECK(stats.HighWater == capacity);
+    CHECK(stats.NumRejected == numProducers * 100 - capacity);
+    boundedWait(queue.get(), capacity + 1);
+    queue->StopThread();
+    
+    // block: producers keep the queue full while the worker runs
+    boundedHandled = 0;
+    queue = boundedQueue(capacity, Overflow::Block, true);
+    for (int32 p = 0; p < numProducers; p++) {
+        producers.push_back(std::thread([&queue]() {
+            for (int32 i = 0; i < msgsPerProducer; i++) {
+                queue->Put(TestProtocol::TestMsg1::Create());
+            }
+        }));
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    boundedWait(queue.get(), numProducers * msgsPerProducer);
+    queue->StopThread();
+    stats = queue->GetStats();
+    CHECK(stats.HighWater <= capacity);
+    CHECK(stats.NumDequeued == numProducers * msgsPerProducer);
+    CHECK(stats.NumRejected == 0);
+    queue = nullptr;
+}
+
+TEST(ThreadedQueueAwaitTest) {
+    Ptr<RunLoop> runLoop = RunLoop::Create();
+    boundedHandled = 0;
+    Ptr<ThreadedQueue> queue = boundedQueue(1, Overflow::Reject, false);
+    boundedStall(queue.get());
+
+    // the queue accepts one message...
+    Ptr<TestProtocol::TestMsg1> accepted = TestProtocol::TestMsg1::Create();
+    Task<Ptr<TestProtocol::TestMsg1>> acceptedTask = Await(accepted, runLoop.get());
+    CHECK(queue->Put(accepted));
+
+    // ...and rejects the next, the task fails when the message goes away
+    Ptr<TestProtocol::TestMsg1> rejected = TestProtocol::TestMsg1::Create();
+    Task<Ptr<TestProtocol::TestMsg1>> rejectedTask = Await(rejected, runLoop.get());
+    bool rejectedSeen = false;
+    rejectedTask.OnFailed([&rejectedSeen]() { rejectedSeen = true; });
+    CHECK(!queue->Put(rejected));
+    rejected = nullptr;
+
+    // a port which drops the message
+    Ptr<Port> port = Port::Create();
+    Ptr<TestProtocol::TestMsg1> dropped = TestProtocol::TestMsg1::Create();
+    Task<Ptr<TestProtocol::TestMsg1>> droppedTask = Await(dropped, runLoop.get());
+    CHECK(!port->Put(dropped));
+    dropped = nullptr;
+
+    // tasks are resolved on the RunLoop
+    CHECK(!rejectedTask.IsDone());
+    runLoop->Run();
+    CHECK(rejectedTask.IsFailed());
+    CHECK(rejectedSeen);
+    CHECK(droppedTask.IsFailed());
+    CHECK(!acceptedTask.IsDone());
+    boundedWait(queue.get(), 2);
+    queue->StopThread();
+    runLoop->Run();
+    CHECK(acceptedTask.IsDone());
+    CHECK(!acceptedTask.IsFailed());
+    CHECK(acceptedTask.Result().get() == accepted.get());
+    queue = nullptr;
+}
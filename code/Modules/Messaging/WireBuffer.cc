@@ -0,0 +1,40 @@
+//------------------------------------------------------------------------------
+//  WireBuffer.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "WireBuffer.h"
+#include "Core/Memory/Memory.h"
+
+namespace Oryol {
+namespace Messaging {
+
+OryolClassPoolAllocImpl(WireBuffer);
+
+//------------------------------------------------------------------------------
+WireBuffer::WireBuffer(int32 size_) :
+data(nullptr),
+size(size_) {
+    o_assert(size_ >= 0);
+    if (size_ > 0) {
+        this->data = (uint8*) Core::Memory::Alloc(size_);
+    }
+}
+
+//------------------------------------------------------------------------------
+WireBuffer::WireBuffer(const void* data_, int32 size_) :
+WireBuffer(size_) {
+    if (size_ > 0) {
+        Core::Memory::Copy(data_, this->data, size_);
+    }
+}
+
+//------------------------------------------------------------------------------
+WireBuffer::~WireBuffer() {
+    if (nullptr != this->data) {
+        Core::Memory::Free(this->data);
+        this->data = nullptr;
+    }
+}
+
+} // namespace Messaging
+} // namespace Oryol
@@ -0,0 +1,78 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Messaging::WireBuffer
+    @brief a refcounted buffer with encoded messages
+    
+    Messages which are decoded from a WireBuffer with 
+    Message::DecodeShared() don't copy their view attributes (strings
+    and POD arrays marked with view="true" in the protocol XML), 
+    instead the attributes are WireViews into the buffer, which keep
+    the buffer alive. A WireBuffer must not be changed after messages
+    have been decoded from it.
+    
+    @see WireView, Message
+*/
+#include "Core/RefCounted.h"
+
+namespace Oryol {
+namespace Messaging {
+    
+class WireBuffer : public Core::RefCounted {
+    OryolClassPoolAllocDecl(WireBuffer);
+public:
+    /// construct with size in bytes (content is undefined)
+    WireBuffer(int32 size);
+    /// construct with a copy of data
+    WireBuffer(const void* data, int32 size);
+    /// destructor
+    virtual ~WireBuffer();
+    
+    /// get the size in bytes
+    int32 Size() const;
+    /// get pointer to the data
+    uint8* Data();
+    /// get pointer to the data
+    const uint8* Data() const;
+    /// get pointer to the end of the data
+    const uint8* End() const;
+    /// test if a memory range is inside the buffer
+    bool Contains(const uint8* ptr, const uint8* endPtr) const;
+
+private:
+    uint8* data;
+    int32 size;
+};
+
+//------------------------------------------------------------------------------
+inline int32
+WireBuffer::Size() const {
+    return this->size;
+}
+
+//------------------------------------------------------------------------------
+inline uint8*
+WireBuffer::Data() {
+    return this->data;
+}
+
+//------------------------------------------------------------------------------
+inline const uint8*
+WireBuffer::Data() const {
+    return this->data;
+}
+
+//------------------------------------------------------------------------------
+inline const uint8*
+WireBuffer::End() const {
+    return this->data + this->size;
+}
+
+//------------------------------------------------------------------------------
+inline bool
+WireBuffer::Contains(const uint8* ptr, const uint8* endPtr) const {
+    return (ptr >= this->data) && (ptr <= endPtr) && (endPtr <= this->data + this->size);
+}
+
+} // namespace Messaging
+} // namespace Oryol
@@ -0,0 +1,157 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Messaging::WireView
+    @brief a read-only view of POD elements in a WireBuffer
+    
+    Message attributes which are marked with view="true" in the 
+    protocol XML are WireViews instead of Core::Strings or 
+    Core::Arrays (WireView<char> for strings), the encoding is the
+    same, so a view attribute can be received as a normal attribute
+    and vice versa:
+    
+        <Attr name="Payload" type="Core::Array&lt;uint8&gt;" view="true"/>
+    
+    When a message is decoded with Message::DecodeShared(), the
+    view attributes point into the source WireBuffer (which they keep
+    alive) without any allocations, unless the elements are not 
+    correctly aligned in the buffer, then the elements are copied
+    into a new WireBuffer. Decode() always copies.
+    
+    Use Copy() to create a view with its own buffer (e.g. to set
+    an attribute of a message which is sent), and ToArray() or 
+    ToString() for a copy which can be changed.
+*/
+#include <type_traits>
+#include "Core/Containers/Array.h"
+#include "Core/String/String.h"
+#include "Messaging/WireBuffer.h"
+
+namespace Oryol {
+namespace Messaging {
+
+template<class TYPE> class WireView {
+    static_assert(std::is_pod<TYPE>::value, "WireView: element type must be POD!");
+public:
+    /// default constructor, creates an empty view
+    WireView();
+    /// construct a view of num elements in a buffer
+    WireView(const Core::Ptr<WireBuffer>& buf, const TYPE* ptr, int32 num);
+    
+    /// create a view of a copy of elements
+    static WireView Copy(const TYPE* ptr, int32 num);
+    
+    /// get number of elements
+    int32 Size() const;
+    /// return true if empty
+    bool Empty() const;
+    /// read-only access to an element
+    const TYPE& operator[](int32 index) const;
+    /// get pointer to the first element
+    const TYPE* begin() const;
+    /// get pointer to the end of the elements
+    const TYPE* end() const;
+    /// get the buffer the view points into (invalid if empty)
+    const Core::Ptr<WireBuffer>& Buffer() const;
+    
+    /// copy the elements to an array
+    Core::Array<TYPE> ToArray() const;
+    /// copy the elements to a string (only for WireView<char>)
+    Core::String ToString() const;
+
+private:
+    Core::Ptr<WireBuffer> buffer;
+    const TYPE* ptr;
+    int32 num;
+};
+
+//------------------------------------------------------------------------------
+template<class TYPE>
+WireView<TYPE>::WireView() :
+ptr(nullptr),
+num(0) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE>
+WireView<TYPE>::WireView(const Core::Ptr<WireBuffer>& buf, const TYPE* ptr_, int32 num_) :
+buffer(buf),
+ptr(ptr_),
+num(num_) {
+    o_assert_dbg((num_ == 0) || buf->Contains((const uint8*)ptr_, (const uint8*)(ptr_ + num_)));
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> WireView<TYPE>
+WireView<TYPE>::Copy(const TYPE* ptr, int32 num) {
+    if (num > 0) {
+        Core::Ptr<WireBuffer> buf = WireBuffer::Create(ptr, int32(num * sizeof(TYPE)));
+        return WireView(buf, (const TYPE*) buf->Data(), num);
+    }
+    else {
+        return WireView();
+    }
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> int32
+WireView<TYPE>::Size() const {
+    return this->num;
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> bool
+WireView<TYPE>::Empty() const {
+    return 0 == this->num;
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> const TYPE&
+WireView<TYPE>::operator[](int32 index) const {
+    o_assert_dbg((index >= 0) && (index < this->num));
+    return this->ptr[index];
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> const TYPE*
+WireView<TYPE>::begin() const {
+    return this->ptr;
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> const TYPE*
+WireView<TYPE>::end() const {
+    return this->ptr + this->num;
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> const Core::Ptr<WireBuffer>&
+WireView<TYPE>::Buffer() const {
+    return this->buffer;
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> Core::Array<TYPE>
+WireView<TYPE>::ToArray() const {
+    Core::Array<TYPE> array;
+    if (this->num > 0) {
+        array.AddBack(this->ptr, this->num);
+    }
+    return array;
+}
+
+//------------------------------------------------------------------------------
+template<class TYPE> Core::String
+WireView<TYPE>::ToString() const {
+    static_assert(std::is_same<TYPE, char>::value, "WireView::ToString(): only for WireView<char>!");
+    if (this->num > 0) {
+        return Core::String(this->ptr, 0, this->num);
+    }
+    else {
+        return Core::String();
+    }
+}
+
+} // namespace Messaging
+} // namespace Oryol
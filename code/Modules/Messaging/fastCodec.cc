@@ -0,0 +1,222 @@
+//------------------------------------------------------------------------------
+//  fastCodec.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "fastCodec.h"
+#include <string.h>
+
+namespace Oryol {
+namespace Messaging {
+
+namespace {
+    // min length of a match
+    const int32 minMatch = 4;
+    // the last bytes are always literals
+    const int32 lastLiterals = 5;
+    // no match may start in the last bytes
+    const int32 matchStartLimit = 12;
+    // after this many misses in a row the compressor skips ahead faster
+    const int32 skipTrigger = 6;
+
+    inline uint32 read32(const uint8* ptr) {
+        uint32 val;
+        memcpy(&val, ptr, sizeof(val));
+        return val;
+    }
+    
+    inline uint32 hash(uint32 val) {
+        return (val * 2654435761U) >> (32 - 14);
+    }
+    
+    inline uint8* writeLength(int32 len, uint8* dstPtr) {
+        while (len >= 255) {
+            *dstPtr++ = 255;
+            len -= 255;
+        }
+        *dstPtr++ = uint8(len);
+        return dstPtr;
+    }
+    
+    inline bool readLength(const uint8*& srcPtr, const uint8* endPtr, int32& len) {
+        uint8 b;
+        do {
+            if ((srcPtr >= endPtr) || (len > (1 << 30))) {
+                return false;
+            }
+            b = *srcPtr++;
+            len += b;
+        }
+        while (255 == b);
+        return true;
+    }
+}
+
+//------------------------------------------------------------------------------
+int32
+fastCodec::MaxCompressedSize(int32 rawSize) {
+    return rawSize + (rawSize / 255) + 16;
+}
+
+//------------------------------------------------------------------------------
+int32
+fastCodec::Compress(const uint8* base, int32 start, int32 end, uint8* dst, int32 dstCapacity, uint32* hashTable) {
+    static_assert((1 << 14) == HashSize, "fastCodec: hash() must match HashSize");
+    // the hash table isn't cleared between calls, entries left over from
+    // an earlier call are only candidates, each match is verified
+    const int32 historyStart = (start > MaxOffset) ? (start - MaxOffset) : 0;
+    for (int32 pos = historyStart; pos + minMatch <= start; pos++) {
+        hashTable[hash(read32(base + pos))] = uint32(pos);
+    }
+    
+    uint8* op = dst;
+    const uint8* opEnd = dst + dstCapacity;
+    int32 anchor = start;
+    int32 ip = start;
+    const int32 ipLimit = end - matchStartLimit;
+    const int32 matchLimit = end - lastLiterals;
+    int32 misses = 0;
+    while (ip < ipLimit) {
+        const uint32 seq = read32(base + ip);
+        const uint32 h = hash(seq);
+        const int32 ref = int32(hashTable[h]);
+        hashTable[h] = uint32(ip);
+        if ((ref >= ip) || ((ip - ref) > MaxOffset) || (read32(base + ref) != seq)) {
+            ip += 1 + (misses++ >> skipTrigger);
+            continue;
+        }
+        misses = 0;
+        // extend the match backwards into the pending literals, and forward
+        int32 matchPos = ref;
+        while ((ip > anchor) && (matchPos > 0) && (base[ip - 1] == base[matchPos - 1])) {
+            ip--;
+            matchPos--;
+        }
+        int32 len = minMatch;
+        while (((ip + len) < matchLimit) && (base[ip + len] == base[matchPos + len])) {
+            len++;
+        }
+        
+        const int32 litLen = ip - anchor;
+        if ((op + 1 + (litLen / 255) + 1 + litLen + 2 + (len / 255) + 1) > opEnd) {
+            return 0;
+        }
+        uint8* token = op++;
+        if (litLen >= 15) {
+            *token = 15 << 4;
+            op = writeLength(litLen - 15, op);
+        }
+        else {
+            *token = uint8(litLen << 4);
+        }
+        memcpy(op, base + anchor, litLen);
+        op += litLen;
+        const int32 offset = ip - matchPos;
+        *op++ = uint8(offset);
+        *op++ = uint8(offset >> 8);
+        const int32 matchLen = len - minMatch;
+        if (matchLen >= 15) {
+            *token |= 15;
+            op = writeLength(matchLen - 15, op);
+        }
+        else {
+            *token |= uint8(matchLen);
+        }
+        ip += len;
+        anchor = ip;
+        if (ip < ipLimit) {
+            hashTable[hash(read32(base + ip - 2))] = uint32(ip - 2);
+        }
+    }
+    
+    // the rest are literals
+    const int32 litLen = end - anchor;
+    if ((op + 1 + (litLen / 255) + 1 + litLen) > opEnd) {
+        return 0;
+    }
+    uint8* token = op++;
+    if (litLen >= 15) {
+        *token = 15 << 4;
+        op = writeLength(litLen - 15, op);
+    }
+    else {
+        *token = uint8(litLen << 4);
+    }
+    memcpy(op, base + anchor, litLen);
+    op += litLen;
+    return int32(op - dst);
+}
+
+//------------------------------------------------------------------------------
+bool
+fastCodec::Decompress(const uint8* src, int32 srcSize, uint8* dst, int32 rawSize, const uint8* dict, int32 dictSize) {
+    const uint8* ip = src;
+    const uint8* ipEnd = src + srcSize;
+    uint8* op = dst;
+    uint8* opEnd = dst + rawSize;
+    for (;;) {
+        if (ip >= ipEnd) {
+            return false;
+        }
+        const uint8 token = *ip++;
+        int32 litLen = token >> 4;
+        if ((15 == litLen) && !readLength(ip, ipEnd, litLen)) {
+            return false;
+        }
+        if ((litLen > (ipEnd - ip)) || (litLen > (opEnd - op))) {
+            return false;
+        }
+        memcpy(op, ip, litLen);
+        op += litLen;
+        ip += litLen;
+        if (ip == ipEnd) {
+            // the last sequence has no match
+            return op == opEnd;
+        }
+        
+        if ((ipEnd - ip) < 2) {
+            return false;
+        }
+        const int32 offset = int32(ip[0]) | (int32(ip[1]) << 8);
+        ip += 2;
+        int32 len = token & 15;
+        if ((15 == len) && !readLength(ip, ipEnd, len)) {
+            return false;
+        }
+        len += minMatch;
+        if ((0 == offset) || (len > (opEnd - op))) {
+            return false;
+        }
+        const int32 produced = int32(op - dst);
+        if (offset > produced) {
+            // the match starts in the dictionary
+            const int32 back = offset - produced;
+            if (back > dictSize) {
+                return false;
+            }
+            const int32 num = back < len ? back : len;
+            memcpy(op, dict + dictSize - back, num);
+            op += num;
+            len -= num;
+            const uint8* match = dst;
+            while (len-- > 0) {
+                *op++ = *match++;
+            }
+        }
+        else {
+            const uint8* match = op - offset;
+            if (offset >= len) {
+                memcpy(op, match, len);
+                op += len;
+            }
+            else {
+                // overlapping match, repeats the last offset bytes
+                while (len-- > 0) {
+                    *op++ = *match++;
+                }
+            }
+        }
+    }
+}
+
+} // namespace Messaging
+} // namespace Oryol
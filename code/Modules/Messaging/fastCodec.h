@@ -0,0 +1,40 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Messaging::fastCodec
+    @brief private: LZ77 codec for Compression::Fast
+    
+    A greedy single-probe LZ77 compressor which writes the LZ4 block 
+    format (a token with literal and match length, the literals, a 
+    16-bit offset and the rest of the match length). It doesn't use 
+    any entropy coding, so it compresses much less than deflate, but is 
+    several times faster in both directions.
+    
+    Matches may reference up to 64 KByte of history before the data, 
+    this is how a dictionary is used: the compressor gets the dictionary
+    and the data in one buffer, the decompressor gets the dictionary 
+    separately. 
+*/
+#include "Core/Types.h"
+
+namespace Oryol {
+namespace Messaging {
+
+class fastCodec {
+public:
+    /// number of entries in the hash table
+    static const int32 HashSize = 1 << 14;
+    /// max distance of a match
+    static const int32 MaxOffset = 65535;
+    
+    /// get the max compressed size
+    static int32 MaxCompressedSize(int32 rawSize);
+    /// compress base[start..end), base[0..start) is history, returns compressed size or 0 if dst is too small
+    /// (hashTable must have HashSize entries, and be initialized once)
+    static int32 Compress(const uint8* base, int32 start, int32 end, uint8* dst, int32 dstCapacity, uint32* hashTable);
+    /// decompress exactly rawSize bytes, returns false on corrupt data
+    static bool Decompress(const uint8* src, int32 srcSize, uint8* dst, int32 rawSize, const uint8* dict, int32 dictSize);
+};
+
+} // namespace Messaging
+} // namespace Oryol
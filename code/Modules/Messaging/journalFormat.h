@@ -0,0 +1,60 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Messaging::journalFormat
+    @brief private: file format of JournalPort journals
+    
+    A journal starts with a 20-byte file header (magic, version, 
+    protocol id, number of message ids and size of the compression 
+    dictionary), followed by the wire id of each message id (see 
+    Protocol::GetWireId()), the dictionary and a crc32 of the wire ids
+    and dictionary, followed by blocks. Each block has a 16-byte header 
+    (the Compression code, size before and after compression and a
+    crc32 of the stored data), followed by the stored data. All header 
+    values are little-endian.
+    
+    A decompressed block is a sequence of records, each record is the
+    time since the previous record in ticks, the message id and the
+    size of the message as varints, followed by the compact encoding 
+    of the message (without the CompactSerializer message header, the
+    message id is mapped to the wire id through the file header).
+*/
+#include "Core/Types.h"
+
+namespace Oryol {
+namespace Messaging {
+
+class journalFormat {
+public:
+    /// file magic ('ORJL')
+    static const uint32 Magic = 0x4c4a524f;
+    /// file format version
+    static const uint32 Version = 3;
+    /// size of the file header
+    static const int32 FileHeaderSize = 20;
+    /// size of a block header
+    static const int32 BlockHeaderSize = 16;
+    /// records are collected until a block has this size
+    static const int32 BlockSize = 64 * 1024;
+    /// blocks bigger than this are treated as corrupt
+    static const int32 MaxBlockSize = 64 * 1024 * 1024;
+    /// file headers with more message ids are treated as corrupt
+    static const int32 MaxMessageIds = 64 * 1024;
+    /// file headers with a bigger dictionary are treated as corrupt
+    static const int32 MaxDictionarySize = 16 * 1024 * 1024;
+    /// write a little-endian 32-bit value
+    static uint8* Write32(uint32 val, uint8* dstPtr) {
+        dstPtr[0] = uint8(val);
+        dstPtr[1] = uint8(val >> 8);
+        dstPtr[2] = uint8(val >> 16);
+        dstPtr[3] = uint8(val >> 24);
+        return dstPtr + 4;
+    };
+    /// read a little-endian 32-bit value
+    static uint32 Read32(const uint8* srcPtr) {
+        return uint32(srcPtr[0]) | (uint32(srcPtr[1]) << 8) | (uint32(srcPtr[2]) << 16) | (uint32(srcPtr[3]) << 24);
+    };
+};
+
+} // namespace Messaging
+} // namespace Oryol
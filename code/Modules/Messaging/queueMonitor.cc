@@ -0,0 +1,195 @@
+//------------------------------------------------------------------------------
+//  queueMonitor.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "queueMonitor.h"
+#include "Core/String/StringBuilder.h"
+
+namespace Oryol {
+namespace Messaging {
+
+using namespace Core;
+
+namespace {
+    Metrics::Id rejectedMetric() {
+        static const Metrics::Id id = Metrics::RegisterCounter("messaging.rejected");
+        return id;
+    }
+    Metrics::Id droppedMetric() {
+        static const Metrics::Id id = Metrics::RegisterCounter("messaging.dropped");
+        return id;
+    }
+}
+
+//------------------------------------------------------------------------------
+queueMonitor::queueMonitor() :
+capacity(0),
+overflow(Overflow::Block),
+depth(0),
+highWater(0),
+numWaiting(0),
+numEnqueued(0),
+numDequeued(0),
+numRejected(0),
+numDropped(0),
+numBlocked(0),
+latencySum(0),
+latencyMax(0),
+lastDequeueTime(0),
+depthMetric(InvalidIndex),
+latencyMetric(InvalidIndex) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+void
+queueMonitor::setCapacity(int32 capacity_, Overflow::Code overflow_) {
+    o_assert(capacity_ >= 0);
+    this->capacity = capacity_;
+    this->overflow = overflow_;
+}
+
+//------------------------------------------------------------------------------
+void
+queueMonitor::setMetricsName(const char* name) {
+    o_assert(nullptr != name);
+    StringBuilder strBuilder;
+    strBuilder.Format(128, "messaging.%s.depth", name);
+    this->depthMetric = Metrics::RegisterGauge(strBuilder.AsCStr());
+    strBuilder.Format(128, "messaging.%s.latency_ns", name);
+    this->latencyMetric = Metrics::RegisterHistogram(strBuilder.AsCStr());
+}
+
+//------------------------------------------------------------------------------
+void
+queueMonitor::enqueued(Message* msg) {
+    const int32 newDepth = this->depth.fetch_add(1, std::memory_order_relaxed) + 1;
+    this->recordEnqueued(msg, newDepth);
+}
+
+//------------------------------------------------------------------------------
+bool
+queueMonitor::tryEnqueue(Message* msg) {
+    if (0 == this->capacity) {
+        this->enqueued(msg);
+        return true;
+    }
+    // reserve the slot with a compare-exchange, a plain full() check
+    // followed by enqueued() lets concurrent producers pass together
+    int32 curDepth = this->depth.load(std::memory_order_relaxed);
+    do {
+        if (curDepth >= this->capacity) {
+            return false;
+        }
+    }
+    while (!this->depth.compare_exchange_weak(curDepth, curDepth + 1, std::memory_order_relaxed));
+    this->recordEnqueued(msg, curDepth + 1);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+queueMonitor::recordEnqueued(Message* msg, int32 newDepth) {
+    msg->queueTime = Clock::Now();
+    this->numEnqueued.fetch_add(1, std::memory_order_relaxed);
+    int32 high = this->highWater.load(std::memory_order_relaxed);
+    while ((newDepth > high) && !this->highWater.compare_exchange_weak(high, newDepth, std::memory_order_relaxed)) {
+        // high has been reloaded, try again
+    }
+    if (InvalidIndex != this->depthMetric) {
+        Metrics::Add(this->depthMetric, 1);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+queueMonitor::dequeued(Message* msg) {
+    const Clock::Ticks now = Clock::Now();
+    const Clock::Ticks latency = now - msg->queueTime;
+    this->numDequeued.fetch_add(1, std::memory_order_relaxed);
+    this->latencySum.fetch_add(latency, std::memory_order_relaxed);
+    if (latency > this->latencyMax.load(std::memory_order_relaxed)) {
+        // only the consumer writes the max
+        this->latencyMax.store(latency, std::memory_order_relaxed);
+    }
+    this->lastDequeueTime.store(now, std::memory_order_relaxed);
+    if (InvalidIndex != this->latencyMetric) {
+        Metrics::Record(this->latencyMetric, latency);
+    }
+    this->released();
+}
+
+//------------------------------------------------------------------------------
+void
+queueMonitor::rejected() {
+    this->numRejected.fetch_add(1, std::memory_order_relaxed);
+    Metrics::Add(rejectedMetric());
+}
+
+//------------------------------------------------------------------------------
+/**
+ The message is cancelled and set to handled, so that code which waits
+ for it to be handled (e.g. Messaging::Await()) isn't stuck, and sees
+ that the message has been cancelled.
+*/
+void
+queueMonitor::dropped(Message* msg) {
+    this->numDropped.fetch_add(1, std::memory_order_relaxed);
+    Metrics::Add(droppedMetric());
+    this->released();
+    msg->SetCancelled();
+    msg->SetHandled();
+}
+
+//------------------------------------------------------------------------------
+void
+queueMonitor::released() {
+    this->depth.fetch_sub(1, std::memory_order_seq_cst);
+    if (InvalidIndex != this->depthMetric) {
+        Metrics::Add(this->depthMetric, -1);
+    }
+    // pairs with waitForSpace(): either the waiting producer sees the
+    // new depth, or we see the waiting producer
+    if (this->numWaiting.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(this->spaceMutex);
+        this->spaceAvailable.notify_all();
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+queueMonitor::waitForSpace() {
+    if (!this->full()) {
+        return;
+    }
+    this->numBlocked.fetch_add(1, std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lock(this->spaceMutex);
+    this->numWaiting.fetch_add(1, std::memory_order_seq_cst);
+    while (this->depth.load(std::memory_order_seq_cst) >= this->capacity) {
+        this->spaceAvailable.wait(lock);
+    }
+    this->numWaiting.fetch_sub(1, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+QueueStats
+queueMonitor::stats() const {
+    QueueStats s;
+    s.Capacity = this->capacity;
+    s.Depth = this->depth.load(std::memory_order_relaxed);
+    s.HighWater = this->highWater.load(std::memory_order_relaxed);
+    s.NumEnqueued = this->numEnqueued.load(std::memory_order_relaxed);
+    s.NumDequeued = this->numDequeued.load(std::memory_order_relaxed);
+    s.NumRejected = this->numRejected.load(std::memory_order_relaxed);
+    s.NumDropped = this->numDropped.load(std::memory_order_relaxed);
+    s.NumBlocked = this->numBlocked.load(std::memory_order_relaxed);
+    if (s.NumDequeued > 0) {
+        s.AvgLatency = this->latencySum.load(std::memory_order_relaxed) / s.NumDequeued;
+    }
+    s.MaxLatency = this->latencyMax.load(std::memory_order_relaxed);
+    s.LastDequeueTime = this->lastDequeueTime.load(std::memory_order_relaxed);
+    return s;
+}
+
+} // namespace Messaging
+} // namespace Oryol
@@ -0,0 +1,95 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Messaging::queueMonitor
+    @brief private: capacity, overflow policy and statistics of a queue port
+    
+    The producer side of a queue port calls enqueued() for each queued
+    message, or tryEnqueue() which only takes the slot if the queue isn't
+    full (so that concurrent producers can't overshoot the capacity
+    between checking and queueing), the consumer side calls dequeued() for each forwarded
+    message and dropped() for each message dropped by the DropOldest
+    policy. The counters are atomics, so producer and consumer may run
+    on different threads and stats() can be called from any thread.
+    In Overflow::Block mode, waitForSpace() blocks the producer until
+    the consumer has made room, the consumer only pays for the wakeup
+    if a producer is actually waiting.
+*/
+#include "Core/Metrics.h"
+#include "Messaging/Message.h"
+#include "Messaging/QueueStats.h"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+namespace Oryol {
+namespace Messaging {
+
+class queueMonitor {
+public:
+    /// constructor
+    queueMonitor();
+    
+    /// set capacity (0 is unbounded) and overflow policy
+    void setCapacity(int32 capacity, Overflow::Code overflow);
+    /// register per-queue metrics (messaging.[name].depth and messaging.[name].latency_ns)
+    void setMetricsName(const char* name);
+    /// return true if the queue is bounded and full
+    bool full() const;
+    /// return true if the queue holds more messages than its capacity
+    bool overfull() const;
+    /// a message has been queued (producer)
+    void enqueued(Message* msg);
+    /// queue a message if the queue isn't full, atomically (producer)
+    bool tryEnqueue(Message* msg);
+    /// a message is about to be forwarded (consumer)
+    void dequeued(Message* msg);
+    /// a Put() has been rejected (producer)
+    void rejected();
+    /// cancel a queued message and drop it (producer or consumer)
+    void dropped(Message* msg);
+    /// wait until the queue isn't full (producer, Overflow::Block)
+    void waitForSpace();
+    /// get a snapshot of the statistics (any thread)
+    QueueStats stats() const;
+
+    int32 capacity;
+    Overflow::Code overflow;
+
+private:
+    /// record a queued message with the new queue depth
+    void recordEnqueued(Message* msg, int32 newDepth);
+    /// a message has left the queue, wake up waiting producers
+    void released();
+
+    std::atomic<int32> depth;
+    std::atomic<int32> highWater;
+    std::atomic<int32> numWaiting;
+    std::atomic<int64> numEnqueued;
+    std::atomic<int64> numDequeued;
+    std::atomic<int64> numRejected;
+    std::atomic<int64> numDropped;
+    std::atomic<int64> numBlocked;
+    std::atomic<int64> latencySum;
+    std::atomic<int64> latencyMax;
+    std::atomic<int64> lastDequeueTime;
+    Core::Metrics::Id depthMetric;
+    Core::Metrics::Id latencyMetric;
+    std::mutex spaceMutex;
+    std::condition_variable spaceAvailable;
+};
+
+//------------------------------------------------------------------------------
+inline bool
+queueMonitor::full() const {
+    return (0 != this->capacity) && (this->depth.load(std::memory_order_relaxed) >= this->capacity);
+}
+
+//------------------------------------------------------------------------------
+inline bool
+queueMonitor::overfull() const {
+    return (0 != this->capacity) && (this->depth.load(std::memory_order_relaxed) > this->capacity);
+}
+
+} // namespace Messaging
+} // namespace Oryol
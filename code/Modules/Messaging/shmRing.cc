@@ -0,0 +1,235 @@
+//------------------------------------------------------------------------------
+//  shmRing.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "shmRing.h"
+#include "Core/Assert.h"
+#include "Core/Threading/futex.h"
+#include "Core/Time/Clock.h"
+#if ORYOL_HAS_THREADS
+#include <thread>
+#endif
+
+namespace Oryol {
+namespace Messaging {
+
+using namespace Core;
+
+namespace {
+    // number of times to check the ring before waiting in the kernel,
+    // spinning only makes sense if the other side runs on another CPU
+    #if ORYOL_HAS_THREADS
+    const int32 numSpins = (std::thread::hardware_concurrency() > 1) ? 512 : 0;
+    #else
+    const int32 numSpins = 0;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+int32
+shmRing::roundCapacity(int32 capacity) {
+    int32 cap = 4096;
+    while ((cap < capacity) && (cap < (1 << 30))) {
+        cap <<= 1;
+    }
+    return cap;
+}
+
+//------------------------------------------------------------------------------
+int32
+shmRing::segmentSize(int32 capacity) {
+    return int32(sizeof(shmRing)) + roundCapacity(capacity);
+}
+
+//------------------------------------------------------------------------------
+void
+shmRing::setup(int32 capacity_, uint32 protocolId_) {
+    this->magic = Magic;
+    this->version = Version;
+    this->capacity = roundCapacity(capacity_);
+    this->protocolId = protocolId_;
+    this->head.store(0, std::memory_order_relaxed);
+    this->tail.store(0, std::memory_order_relaxed);
+    this->pendingTail = 0;
+    this->ready.store(1, std::memory_order_release);
+    futex::WakeAllShared(&this->ready);
+}
+
+//------------------------------------------------------------------------------
+bool
+shmRing::waitReady(int64 timeoutNs) {
+    const Clock::Ticks start = Clock::Now();
+    while (0 == this->ready.load(std::memory_order_acquire)) {
+        const int64 remaining = timeoutNs - Clock::Since(start);
+        if (remaining <= 0) {
+            return false;
+        }
+        futex::WaitShared(&this->ready, 0, remaining);
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+int32
+shmRing::maxRecordSize() const {
+    // a record of half the capacity always fits into an empty ring
+    return (this->capacity / 2) - headerSize;
+}
+
+//------------------------------------------------------------------------------
+uint64
+shmRing::skipSize(uint64 pos, uint64 need) const {
+    const uint64 offset = pos & uint64(this->capacity - 1);
+    return ((offset + need) > uint64(this->capacity)) ? (this->capacity - offset) : 0;
+}
+
+//------------------------------------------------------------------------------
+uint8*
+shmRing::beginPush(int32 size) {
+    o_assert_dbg((size >= 0) && (size <= this->maxRecordSize()));
+    const uint64 need = recordSize(size);
+    uint64 pos = this->pendingTail;
+    const uint64 skip = this->skipSize(pos, need);
+    if ((pos + skip + need - this->head.load(std::memory_order_acquire)) > uint64(this->capacity)) {
+        return nullptr;
+    }
+    const uint64 mask = this->capacity - 1;
+    if (skip > 0) {
+        *(uint32*)(this->data() + (pos & mask)) = padMarker;
+        pos += skip;
+    }
+    *(uint32*)(this->data() + (pos & mask)) = uint32(size);
+    this->pendingTail = pos + need;
+    return this->data() + (pos & mask) + headerSize;
+}
+
+//------------------------------------------------------------------------------
+void
+shmRing::endPush() {
+    this->tail.store(this->pendingTail, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (this->consumerWaiting.load(std::memory_order_relaxed)) {
+        this->dataSeq.fetch_add(1, std::memory_order_relaxed);
+        futex::WakeAllShared(&this->dataSeq);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+shmRing::hasSpace(int32 size) const {
+    const uint64 need = recordSize(size);
+    const uint64 pos = this->pendingTail;
+    const uint64 skip = this->skipSize(pos, need);
+    return (pos + skip + need - this->head.load(std::memory_order_acquire)) <= uint64(this->capacity);
+}
+
+//------------------------------------------------------------------------------
+bool
+shmRing::waitForSpace(int32 size, int64 timeoutNs) {
+    for (int32 i = 0; i < numSpins; i++) {
+        if (this->hasSpace(size)) {
+            return true;
+        }
+        futex::Relax();
+    }
+    const Clock::Ticks start = Clock::Now();
+    while (!this->hasSpace(size)) {
+        const int32 seq = this->spaceSeq.load(std::memory_order_acquire);
+        this->producerWaiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (this->hasSpace(size)) {
+            this->producerWaiting.store(0, std::memory_order_relaxed);
+            break;
+        }
+        const int64 remaining = (timeoutNs < 0) ? -1 : (timeoutNs - Clock::Since(start));
+        if ((timeoutNs >= 0) && (remaining <= 0)) {
+            this->producerWaiting.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        futex::WaitShared(&this->spaceSeq, seq, remaining);
+        this->producerWaiting.store(0, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+shmRing::resetProducer() {
+    this->pendingTail = this->tail.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+const uint8*
+shmRing::front(int32& outSize) {
+    uint64 pos = this->head.load(std::memory_order_relaxed);
+    if (pos == this->tail.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    const uint64 mask = this->capacity - 1;
+    uint32 size = *(const uint32*)(this->data() + (pos & mask));
+    if (padMarker == size) {
+        // a pad record is always followed by a record in the same push
+        pos += this->capacity - (pos & mask);
+        this->head.store(pos, std::memory_order_release);
+        size = *(const uint32*)(this->data() + (pos & mask));
+    }
+    outSize = int32(size);
+    return this->data() + (pos & mask) + headerSize;
+}
+
+//------------------------------------------------------------------------------
+void
+shmRing::pop() {
+    const uint64 pos = this->head.load(std::memory_order_relaxed);
+    o_assert_dbg(pos != this->tail.load(std::memory_order_relaxed));
+    const int32 size = int32(*(const uint32*)(this->data() + (pos & uint64(this->capacity - 1))));
+    o_assert_dbg(padMarker != uint32(size));
+    const uint64 newPos = pos + recordSize(size);
+    this->head.store(newPos, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // wake a waiting producer when a quarter of the ring is free (or
+    // the ring is empty), not for each record
+    if (this->producerWaiting.load(std::memory_order_relaxed) &&
+        ((this->tail.load(std::memory_order_relaxed) - newPos) <= uint64(this->capacity - (this->capacity / 4)))) {
+        this->spaceSeq.fetch_add(1, std::memory_order_relaxed);
+        futex::WakeAllShared(&this->spaceSeq);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+shmRing::empty() const {
+    return this->head.load(std::memory_order_relaxed) == this->tail.load(std::memory_order_acquire);
+}
+
+//------------------------------------------------------------------------------
+bool
+shmRing::waitForData(int64 timeoutNs) {
+    for (int32 i = 0; i < numSpins; i++) {
+        if (!this->empty()) {
+            return true;
+        }
+        futex::Relax();
+    }
+    const Clock::Ticks start = Clock::Now();
+    while (this->empty()) {
+        const int32 seq = this->dataSeq.load(std::memory_order_acquire);
+        this->consumerWaiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!this->empty()) {
+            this->consumerWaiting.store(0, std::memory_order_relaxed);
+            break;
+        }
+        const int64 remaining = (timeoutNs < 0) ? -1 : (timeoutNs - Clock::Since(start));
+        if ((timeoutNs >= 0) && (remaining <= 0)) {
+            this->consumerWaiting.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        futex::WaitShared(&this->dataSeq, seq, remaining);
+        this->consumerWaiting.store(0, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+} // namespace Messaging
+} // namespace Oryol
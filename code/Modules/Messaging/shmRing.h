@@ -0,0 +1,113 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Messaging::shmRing
+    @brief private: single-producer/single-consumer byte ring in shared memory
+    
+    The header of a SharedMemoryPort segment, followed by the ring buffer
+    data. Everything lives in the shared memory, so there are no pointers,
+    only offsets and atomics (which are lock-free and address-free on all
+    supported platforms). The segment is created zeroed, the creating 
+    process calls setup(), the other process waits for ready.
+    
+    Records are 8-byte aligned, with an 8-byte header (the record size)
+    and never wrap around the end of the ring: if a record doesn't fit
+    into the rest of the ring, the rest is skipped with a pad marker,
+    so a record can be at most half the capacity. Head and tail are
+    64-bit positions which are never reset. 
+    
+    Consumer and producer only call into the kernel (futex wait/wake) 
+    when the other side is actually waiting: a side which wants to wait
+    sets its waiting flag and re-checks the ring, the other side checks
+    the flag after publishing (with a full fence on both sides).
+*/
+#include <atomic>
+#include "Core/Types.h"
+
+namespace Oryol {
+namespace Messaging {
+
+class shmRing {
+public:
+    /// magic number of a set up segment
+    static const uint32 Magic = 0x4d53524f;
+    /// layout version
+    static const uint32 Version = 2;
+
+    /// round up to a valid capacity (power of 2)
+    static int32 roundCapacity(int32 capacity);
+    /// size of the shared memory segment for a capacity
+    static int32 segmentSize(int32 capacity);
+    
+    /// creating side: set up in zeroed memory and mark as ready
+    void setup(int32 capacity, uint32 protocolId);
+    /// attaching side: wait until the ring is set up, returns false on timeout
+    bool waitReady(int64 timeoutNs);
+    /// max size of a record
+    int32 maxRecordSize() const;
+    
+    /// producer: reserve room for a record, returns nullptr if full
+    uint8* beginPush(int32 size);
+    /// producer: publish the reserved record
+    void endPush();
+    /// producer: test if there's room for a record
+    bool hasSpace(int32 size) const;
+    /// producer: wait until there's room for a record, returns false on timeout
+    bool waitForSpace(int32 size, int64 timeoutNs);
+    /// producer: discard unpublished data (after a failed encode, or taking over from a dead producer)
+    void resetProducer();
+    
+    /// consumer: get the next record, returns nullptr if empty
+    const uint8* front(int32& outSize);
+    /// consumer: remove the record returned by front()
+    void pop();
+    /// consumer: test if empty
+    bool empty() const;
+    /// consumer: wait until there are records, returns false on timeout
+    bool waitForData(int64 timeoutNs);
+    
+    // set up by the creating side
+    std::atomic<int32> ready;
+    uint32 magic;
+    uint32 version;
+    int32 capacity;
+    uint32 protocolId;
+    // process ids of the attached sender and receiver, 0 if none
+    std::atomic<int32> senderPid;
+    std::atomic<int32> receiverPid;
+    std::atomic<int32> numAttached;
+    
+    // written by the consumer
+    alignas(64) std::atomic<uint64> head;
+    std::atomic<int32> spaceSeq;
+    std::atomic<int32> producerWaiting;
+    
+    // written by the producer
+    alignas(64) std::atomic<uint64> tail;
+    std::atomic<int32> dataSeq;
+    std::atomic<int32> consumerWaiting;
+    uint64 pendingTail;
+    
+private:
+    /// size of a record header
+    static const int32 headerSize = 8;
+    /// record size of a pad record
+    static const uint32 padMarker = 0xFFFFFFFF;
+    /// size of a record with header and alignment
+    static uint64 recordSize(int32 size) {
+        return uint64(headerSize + size + 7) & ~uint64(7);
+    };
+    /// pointer to the ring buffer data
+    uint8* data() {
+        return ((uint8*)this) + sizeof(shmRing);
+    };
+    /// pointer to the ring buffer data
+    const uint8* data() const {
+        return ((const uint8*)this) + sizeof(shmRing);
+    };
+    /// get number of bytes to skip at pos to fit a record
+    uint64 skipSize(uint64 pos, uint64 need) const;
+};
+
+} // namespace Messaging
+} // namespace Oryol
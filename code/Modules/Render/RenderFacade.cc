@@ -3,6 +3,7 @@
 //------------------------------------------------------------------------------
 #include "Pre.h"
 #include "RenderFacade.h"
+#include "Core/Profiler.h"
 
 namespace Oryol {
 namespace Render {
@@ -137,6 +138,7 @@ RenderFacade::ApplyProgram(const Id& resId, uint32 selMask) {
 //------------------------------------------------------------------------------
 bool
 RenderFacade::BeginFrame() {
+    o_prof_scope("RenderFacade::BeginFrame");
     this->resourceManager.Update();
     this->displayManager.ProcessSystemEvents();
     
@@ -147,6 +149,7 @@ RenderFacade::BeginFrame() {
 //------------------------------------------------------------------------------
 void
 RenderFacade::EndFrame() {
+    o_prof_scope("RenderFacade::EndFrame");
     this->displayManager.Present();
 }
 
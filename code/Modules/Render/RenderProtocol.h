@@ -6,6 +6,7 @@
 #include <cstring>
 #include "Messaging/Message.h"
 #include "Messaging/Serializer.h"
+#include "Messaging/CompactSerializer.h"
 #include "Messaging/Protocol.h"
 
 namespace Oryol {
@@ -15,10 +16,30 @@ public:
     static Messaging::ProtocolIdType GetProtocolId() {
         return 'RRPT';
     };
+    static bool HasProtocol(Messaging::ProtocolIdType protId) {
+        return (protId == 'RRPT') || Messaging::Protocol::HasProtocol(protId);
+    };
+    static uint32 GetWireId(Messaging::MessageIdType id) {
+        switch (id) {
+            case MessageId::DisplaySetupId: return 0x1772d27aU;
+            case MessageId::DisplayDiscardedId: return 0x6e5cef94U;
+            case MessageId::DisplayModifiedId: return 0xa025cfc6U;
+            default: return Messaging::Protocol::GetWireId(id);
+        }
+    };
+    static Messaging::MessageIdType FindMessageId(uint32 wireId) {
+        switch (wireId) {
+            case 0x1772d27aU: return MessageId::DisplaySetupId;
+            case 0x6e5cef94U: return MessageId::DisplayDiscardedId;
+            case 0xa025cfc6U: return MessageId::DisplayModifiedId;
+            default: return Messaging::Protocol::FindMessageId(wireId);
+        }
+    };
     class MessageId {
     public:
         enum {
-            DisplaySetupId = Messaging::Protocol::MessageId::NumMessageIds, 
+            FirstMessageId = Messaging::Protocol::MessageId::NumMessageIds,
+            DisplaySetupId = FirstMessageId, 
             DisplayDiscardedId,
             DisplayModifiedId,
             NumMessageIds
@@ -49,6 +70,7 @@ public:
     public:
         DisplaySetup() {
             this->msgId = MessageId::DisplaySetupId;
+            this->protId = 'RRPT';
         };
         static Messaging::Message* FactoryCreate() {
             return (Messaging::Message*) Create();
@@ -60,6 +82,13 @@ public:
             if (protId == 'RRPT') return true;
             else return Messaging::Message::IsMemberOf(protId);
         };
+        static const uint64 DerivedMask = 0x1ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'RRPT') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const DisplaySetup*>(msg);
+        };
 private:
     };
     class DisplayDiscarded : public Messaging::Message {
@@ -67,6 +96,7 @@ private:
     public:
         DisplayDiscarded() {
             this->msgId = MessageId::DisplayDiscardedId;
+            this->protId = 'RRPT';
         };
         static Messaging::Message* FactoryCreate() {
             return (Messaging::Message*) Create();
@@ -78,6 +108,13 @@ private:
             if (protId == 'RRPT') return true;
             else return Messaging::Message::IsMemberOf(protId);
         };
+        static const uint64 DerivedMask = 0x2ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'RRPT') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const DisplayDiscarded*>(msg);
+        };
 private:
     };
     class DisplayModified : public Messaging::Message {
@@ -85,6 +122,7 @@ private:
     public:
         DisplayModified() {
             this->msgId = MessageId::DisplayModifiedId;
+            this->protId = 'RRPT';
         };
         static Messaging::Message* FactoryCreate() {
             return (Messaging::Message*) Create();
@@ -96,8 +134,26 @@ private:
             if (protId == 'RRPT') return true;
             else return Messaging::Message::IsMemberOf(protId);
         };
+        static const uint64 DerivedMask = 0x4ULL;
+        static bool IsA(const Messaging::Message* msg) {
+            if (msg->ProtocolId() == 'RRPT') {
+                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);
+            }
+            return nullptr != dynamic_cast<const DisplayModified*>(msg);
+        };
 private:
     };
+    template<class VISITOR> static bool Visit(const Core::Ptr<Messaging::Message>& msg, VISITOR&& visitor) {
+        if (msg->ProtocolId() != GetProtocolId()) {
+            return Messaging::Protocol::Visit(msg, visitor);
+        }
+        switch (msg->MessageId()) {
+            case MessageId::DisplaySetupId: visitor(Core::Ptr<DisplaySetup>(static_cast<DisplaySetup*>(msg.get()))); return true;
+            case MessageId::DisplayDiscardedId: visitor(Core::Ptr<DisplayDiscarded>(static_cast<DisplayDiscarded*>(msg.get()))); return true;
+            case MessageId::DisplayModifiedId: visitor(Core::Ptr<DisplayModified>(static_cast<DisplayModified*>(msg.get()))); return true;
+            default: return false;
+        }
+    };
 };
 }
 }
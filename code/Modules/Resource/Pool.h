@@ -9,6 +9,9 @@
 #include "Core/Containers/Queue.h"
 #include "Core/Containers/Array.h"
 #include "Core/Containers/Map.h"
+#include "Core/Profiler.h"
+#include "Core/Metrics.h"
+#include "Core/String/StringBuilder.h"
 #include "Resource/Id.h"
 #include "Resource/Slot.h"
 #include "IO/Stream.h"
@@ -73,6 +76,9 @@ protected:
     int32 maxNumCreatePerFrame;
     uint32 genericPlaceholderType;
     uint16 resourceType;
+    Core::Metrics::Id usedMetric;
+    Core::Metrics::Id pendingMetric;
+    Core::Metrics::Id freeMetric;
     
     Core::Array<slot<RESOURCE,SETUP,FACTORY>> slots;
     Core::Map<uint32, Id> placeholders;
@@ -88,7 +94,10 @@ factory(nullptr),
 uniqueCounter(0),
 maxNumCreatePerFrame(0),
 genericPlaceholderType(0),
-resourceType(0xFFFF) {
+resourceType(0xFFFF),
+usedMetric(InvalidIndex),
+pendingMetric(InvalidIndex),
+freeMetric(InvalidIndex) {
     // empty
 }
 
@@ -123,6 +132,15 @@ Pool<RESOURCE,SETUP,FACTORY>::Setup(FACTORY* factory_, int32 poolSize, int32 max
         this->freeSlots.Enqueue(i);
     }
     
+    // slot occupancy gauges, updated once per frame in Update()
+    Core::StringBuilder builder;
+    builder.Format(64, "resource.pool%d.used", this->resourceType);
+    this->usedMetric = Core::Metrics::RegisterGauge(builder.AsCStr());
+    builder.Format(64, "resource.pool%d.pending", this->resourceType);
+    this->pendingMetric = Core::Metrics::RegisterGauge(builder.AsCStr());
+    builder.Format(64, "resource.pool%d.free", this->resourceType);
+    this->freeMetric = Core::Metrics::RegisterGauge(builder.AsCStr());
+    
     this->isValid = true;
 }
 
@@ -137,6 +155,9 @@ Pool<RESOURCE,SETUP,FACTORY>::Discard() {
     this->slots.Clear();
     this->freeSlots.Clear();
     this->pendingSlots.Clear();
+    Core::Metrics::Set(this->usedMetric, 0);
+    Core::Metrics::Set(this->pendingMetric, 0);
+    Core::Metrics::Set(this->freeMetric, 0);
     this->placeholders.Clear();
     this->factory = nullptr;
 }
@@ -275,6 +296,7 @@ Pool<RESOURCE,SETUP,FACTORY>::lookupPlaceholder(uint32 typeFourcc) {
 template<class RESOURCE, class SETUP, class FACTORY> void
 Pool<RESOURCE,SETUP,FACTORY>::Update() {
     o_assert(this->isValid);
+    o_prof_scope("Pool::Update");
     
     // go over pending slots (these are currently loading), and call their update
     // method, break if maxNumCreatePerFrame is reached
@@ -294,6 +316,9 @@ Pool<RESOURCE,SETUP,FACTORY>::Update() {
             }
         }
     }
+    Core::Metrics::Set(this->usedMetric, this->GetNumUsedSlots());
+    Core::Metrics::Set(this->pendingMetric, this->GetNumPendingSlots());
+    Core::Metrics::Set(this->freeMetric, this->GetNumFreeSlots());
 }
 
 //------------------------------------------------------------------------------
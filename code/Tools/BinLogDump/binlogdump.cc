@@ -0,0 +1,62 @@
+//------------------------------------------------------------------------------
+//	binlogdump.cc
+//  Decode a dump created with BinaryLog::CreateDump() and print
+//  the formatted records to stdout.
+//
+//  Usage: binlogdump file [-v]
+//  -v: also print the source file and line of each record
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "Core/BinaryLog.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace Oryol;
+using namespace Oryol::Core;
+
+int main(int argc, const char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: binlogdump file [-v]\n");
+        return 10;
+    }
+    const bool verbose = (argc > 2) && (0 == std::strcmp(argv[2], "-v"));
+
+    // load the dump file
+    FILE* fp = std::fopen(argv[1], "rb");
+    if (nullptr == fp) {
+        std::fprintf(stderr, "binlogdump: failed to open '%s'\n", argv[1]);
+        return 10;
+    }
+    Array<uint8> data;
+    uint8 buf[4096];
+    size_t num;
+    while ((num = std::fread(buf, 1, sizeof(buf), fp)) > 0) {
+        for (size_t i = 0; i < num; i++) {
+            data.AddBack(buf[i]);
+        }
+    }
+    std::fclose(fp);
+
+    // print records with the time relative to the first record
+    static const char* levelNames[] = { "NONE", "ERROR", "WARN", "INFO", "DEBUG" };
+    int64 startTime = -1;
+    int32 numRecords = 0;
+    const bool valid = BinaryLog::Decode(data.begin(), data.Size(), [&](const BinaryLog::Record& rec) {
+        if (startTime < 0) {
+            startTime = rec.time;
+        }
+        const int32 level = int32(rec.level);
+        const char* levelName = ((level >= 0) && (level < int32(Log::Level::NumLevels))) ? levelNames[level] : "?";
+        std::printf("%12.6f [%d] %-5s ", float64(rec.time - startTime) * 0.000000001, rec.threadIndex, levelName);
+        if (verbose) {
+            std::printf("%s(%d): ", rec.file, rec.line);
+        }
+        std::fputs(rec.text, stdout);
+        numRecords++;
+    });
+    if (!valid) {
+        std::fprintf(stderr, "binlogdump: '%s' is not a valid dump (after %d records)\n", argv[1], numRecords);
+        return 10;
+    }
+    return 0;
+}
@@ -13,9 +13,157 @@ def error(msg) :
 #-------------------------------------------------------------------------------
 def checkValidAttr(attr) :
     for key in attr.keys() :
-        if not key in ('name', 'type', 'def', 'dir') :
+        if not key in ('name', 'type', 'def', 'dir', 'view', 'tag') :
             error('Invalid Attr attr "{}"'.format(key))
+    if isViewAttr(attr) :
+        attrType = attr.get('type')
+        if attrType != 'Core::String' and not (isArrayType(attrType) and isFixedSizeType(getArrayType(attrType))) :
+            error('Attr "{}": only Core::String and arrays of scalar types can be views'.format(attr.get('name')))
     
+#-------------------------------------------------------------------------------
+def checkValidPriority(msg) :
+    prio = msg.get('priority')
+    if prio and not prio in ('Low', 'Normal', 'High') :
+        error('Invalid Message priority "{}" (must be Low, Normal or High)'.format(prio))
+
+#-------------------------------------------------------------------------------
+def isFixedSizeType(attrType) :
+    '''
+    Test if the type string is a fixed-size scalar type
+    '''
+    return attrType in ('int8', 'int16', 'int32', 'int64', 'uint8', 'uint16', 'uint32', 'uint64',
+                        'float32', 'float64', 'bool', 'char', 'unsigned char', 'short', 'unsigned short',
+                        'int', 'unsigned int', 'long', 'unsigned long', 'float', 'double')
+
+#-------------------------------------------------------------------------------
+def isViewAttr(attr) :
+    '''
+    Test if an attribute is a view into the decode buffer (Messaging::WireView)
+    '''
+    return attr.get('view', 'false') == 'true'
+
+#-------------------------------------------------------------------------------
+def getViewElementType(attrType) :
+    '''
+    Get the element type of a view attribute (char for strings)
+    '''
+    if attrType == 'Core::String' :
+        return 'char'
+    else :
+        return getArrayType(attrType)
+
+#-------------------------------------------------------------------------------
+def getViewType(attrType) :
+    '''
+    Get the WireView type of a view attribute
+    '''
+    return 'Messaging::WireView<' + getViewElementType(attrType) + '>'
+
+#-------------------------------------------------------------------------------
+def getFixedSizeAttrs(xmlRoot, msg) :
+    '''
+    Get the attributes of a message and its parent messages (parents first)
+    if they are all fixed-size, otherwise None. Parent classes from other
+    protocols are unknown here, so these messages are never fixed-size.
+    '''
+    msgsByName = {}
+    for m in xmlRoot.findall('Message') :
+        msgsByName[m.get('name')] = m
+    chain = []
+    while msg is not None :
+        chain.insert(0, msg)
+        parent = msg.get('parent')
+        if parent and not parent in msgsByName :
+            return None
+        msg = msgsByName.get(parent) if parent else None
+    attrs = []
+    names = set()
+    for m in chain :
+        # the attributes of non-serialized parents are skipped by the encoding
+        if m.get('serialize', 'true') != 'true' :
+            continue
+        for attr in m.findall('Attr') :
+            if not isFixedSizeType(attr.get('type')) or attr.get('name') in names :
+                return None
+            names.add(attr.get('name'))
+            attrs.append(attr)
+    return attrs
+
+#-------------------------------------------------------------------------------
+def getCompactTags(msg) :
+    '''
+    Get the compact encoding tags of the attributes of a message class,
+    the tag is the 1-based position of the attribute, or the tag attribute
+    '''
+    tags = []
+    for index, attr in enumerate(msg.findall('Attr')) :
+        tag = int(attr.get('tag', index + 1))
+        if tag <= 0 or tag in tags :
+            error('Invalid or duplicate tag {} in message "{}"'.format(tag, msg.get('name')))
+        tags.append(tag)
+    return tags
+
+#-------------------------------------------------------------------------------
+def getCompactCondition(attr) :
+    '''
+    Get the C++ condition under which an attribute is written in the
+    compact encoding (attributes with default values are left out),
+    or None if the attribute is always written
+    '''
+    attrName = attr.get('name').lower()
+    attrType = attr.get('type')
+    defValue = getAttrDefaultValue(attr)
+    if isViewAttr(attr) :
+        return None if attr.get('def') else '!this->' + attrName + '.Empty()'
+    elif attrType in ('Core::String', 'Core::StringAtom') or isArrayType(attrType) :
+        return None if attr.get('def') else '!this->' + attrName + '.Empty()'
+    elif defValue :
+        return 'this->' + attrName + ' != ' + defValue
+    else :
+        return None
+
+#-------------------------------------------------------------------------------
+def getWireIds(xmlRoot) :
+    '''
+    Get the wire ids of the message classes of a protocol, the FNV-1a
+    hash of the protocol id and the class name: unlike the message ids,
+    they don't change when message classes are added to the protocol
+    or its parent protocols, so the compact encoding identifies messages
+    by their wire id
+    '''
+    wireIds = []
+    for msg in xmlRoot.findall('Message') :
+        h = 0x811c9dc5
+        for c in xmlRoot.get('id') + ':' + msg.get('name') :
+            h = ((h ^ ord(c)) * 0x01000193) & 0xffffffff
+        if h in wireIds :
+            error('Wire id collision of message "{}", rename the message'.format(msg.get('name')))
+        wireIds.append(h)
+    return wireIds
+
+#-------------------------------------------------------------------------------
+def getDerivedMask(xmlRoot, msgName) :
+    '''
+    Get the inheritance bitmask of a message class, bit n is set if the
+    n-th message of the protocol is the class itself or derived from it
+    (only parent classes from the same protocol are known here)
+    '''
+    msgs = xmlRoot.findall('Message')
+    if len(msgs) > 64 :
+        error('Too many messages in protocol "{}" (max 64)'.format(xmlRoot.get('name')))
+    parents = {}
+    for msg in msgs :
+        parents[msg.get('name')] = msg.get('parent')
+    mask = 0
+    for index, msg in enumerate(msgs) :
+        name = msg.get('name')
+        while name :
+            if name == msgName :
+                mask |= 1 << index
+                break
+            name = parents.get(name)
+    return mask
+
 #-------------------------------------------------------------------------------
 def writeHeaderTop(f, xmlRoot) :
     '''
@@ -35,6 +183,7 @@ def writeIncludes(f, xmlRoot) :
     '''
     f.write('#include "Messaging/Message.h"\n')
     f.write('#include "Messaging/Serializer.h"\n')
+    f.write('#include "Messaging/CompactSerializer.h"\n')
     parentHdr = xmlRoot.get('parenthdr', 'Messaging/Protocol.h')
     f.write('#include "{}"\n'.format(parentHdr))
 
@@ -50,6 +199,26 @@ def writeProtocolMethods(f, xmlRoot) :
     f.write('    static Messaging::ProtocolIdType GetProtocolId() {\n')
     f.write("        return '{}';\n".format(xmlRoot.get('id')))
     f.write('    };\n')
+    f.write('    static bool HasProtocol(Messaging::ProtocolIdType protId) {\n')
+    f.write("        return (protId == '{}') || {}::HasProtocol(protId);\n".format(xmlRoot.get('id'), xmlRoot.get('parent', 'Messaging::Protocol')))
+    f.write('    };\n')
+    parentProtocol = xmlRoot.get('parent', 'Messaging::Protocol')
+    msgs = xmlRoot.findall('Message')
+    wireIds = getWireIds(xmlRoot)
+    f.write('    static uint32 GetWireId(Messaging::MessageIdType id) {\n')
+    f.write('        switch (id) {\n')
+    for msg, wireId in zip(msgs, wireIds) :
+        f.write('            case MessageId::{}Id: return 0x{:08x}U;\n'.format(msg.get('name'), wireId))
+    f.write('            default: return {}::GetWireId(id);\n'.format(parentProtocol))
+    f.write('        }\n')
+    f.write('    };\n')
+    f.write('    static Messaging::MessageIdType FindMessageId(uint32 wireId) {\n')
+    f.write('        switch (wireId) {\n')
+    for msg, wireId in zip(msgs, wireIds) :
+        f.write('            case 0x{:08x}U: return MessageId::{}Id;\n'.format(wireId, msg.get('name')))
+    f.write('            default: return {}::FindMessageId(wireId);\n'.format(parentProtocol))
+    f.write('        }\n')
+    f.write('    };\n')
 
 #-------------------------------------------------------------------------------
 def writeMessageIdEnum(f, xmlRoot) :
@@ -62,10 +231,11 @@ def writeMessageIdEnum(f, xmlRoot) :
     f.write('    class MessageId {\n')
     f.write('    public:\n')
     f.write('        enum {\n')
+    f.write('            FirstMessageId = ' + parentProtocol + '::MessageId::NumMessageIds,\n')
     msgCount = 0
     for msg in xmlRoot.findall('Message') :
         if msgCount == 0:
-            f.write('            ' + msg.get('name') + 'Id = ' + parentProtocol + '::MessageId::NumMessageIds, \n')
+            f.write('            ' + msg.get('name') + 'Id = FirstMessageId, \n')
         else :
             f.write('            ' + msg.get('name') + 'Id,\n')
         msgCount += 1
@@ -89,6 +259,26 @@ def writeMessageIdEnum(f, xmlRoot) :
     f.write('    typedef Messaging::Message* (*CreateCallback)();\n')
     f.write('    static CreateCallback jumpTable[' + protocol + '::MessageId::NumMessageIds];\n')
 
+#-------------------------------------------------------------------------------
+def writeVisitMethod(f, xmlRoot) :
+    '''
+    Write the switch-based visitor, calls visitor(const Ptr<MSG>&) with
+    the concrete message class, messages of parent protocols are passed
+    to the parent protocol's Visit()
+    '''
+    parentProtocol = xmlRoot.get('parent', 'Messaging::Protocol')
+    f.write('    template<class VISITOR> static bool Visit(const Core::Ptr<Messaging::Message>& msg, VISITOR&& visitor) {\n')
+    f.write('        if (msg->ProtocolId() != GetProtocolId()) {\n')
+    f.write('            return ' + parentProtocol + '::Visit(msg, visitor);\n')
+    f.write('        }\n')
+    f.write('        switch (msg->MessageId()) {\n')
+    for msg in xmlRoot.findall('Message') :
+        msgClassName = msg.get('name')
+        f.write('            case MessageId::' + msgClassName + 'Id: visitor(Core::Ptr<' + msgClassName + '>(static_cast<' + msgClassName + '*>(msg.get()))); return true;\n')
+    f.write('            default: return false;\n')
+    f.write('        }\n')
+    f.write('    };\n')
+
 #-------------------------------------------------------------------------------
 def writeFactoryClassDecl(f, xmlRoot) :
     '''
@@ -200,10 +390,16 @@ def writeMessageClasses(f, xmlRoot) :
         # write constructor
         f.write('        ' + msgClassName + '() {\n')
         f.write('            this->msgId = MessageId::' + msgClassName + 'Id;\n')
+        f.write("            this->protId = '" + protocolId + "';\n")
+        checkValidPriority(msg)
+        if msg.get('priority') :
+            f.write('            this->priority = Messaging::Priority::' + msg.get('priority') + ';\n')
         for attr in msg.findall('Attr') :
             attrName = attr.get('name').lower()
             defValue = getAttrDefaultValue(attr)
-            if defValue :
+            if defValue and isViewAttr(attr) :
+                f.write('            this->Set' + attr.get('name') + '(' + attr.get('type') + '(' + defValue + '));\n')
+            elif defValue :
                 f.write('            this->' + attrName + ' = ' + defValue + ';\n')
         f.write('        };\n')
 
@@ -223,17 +419,45 @@ def writeMessageClasses(f, xmlRoot) :
         f.write('            else return ' + msgParentClassName + '::IsMemberOf(protId);\n')
         f.write('        };\n') 
 
+        # inheritance bitmask and fast is-a test (dynamic_cast only for messages of other protocols)
+        f.write('        static const uint64 DerivedMask = 0x{:x}ULL;\n'.format(getDerivedMask(xmlRoot, msgClassName)))
+        f.write('        static bool IsA(const Messaging::Message* msg) {\n')
+        f.write("            if (msg->ProtocolId() == '" + protocolId + "') {\n")
+        f.write('                return 0 != ((DerivedMask >> (msg->MessageId() - MessageId::FirstMessageId)) & 1);\n')
+        f.write('            }\n')
+        f.write('            return nullptr != dynamic_cast<const ' + msgClassName + '*>(msg);\n')
+        f.write('        };\n')
+
         # write serializer methods
         if msg.get('serialize', 'true') == 'true' :
             f.write('        virtual int32 EncodedSize() const override;\n')
             f.write('        virtual uint8* Encode(uint8* dstPtr, const uint8* maxValidPtr) const override;\n')
             f.write('        virtual const uint8* Decode(const uint8* srcPtr, const uint8* maxValidPtr) override;\n')
+            f.write('        virtual int32 CompactEncodedSize() const override;\n')
+            f.write('        virtual uint8* EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const override;\n')
+            f.write('        virtual const uint8* DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) override;\n')
 
         # write setters/getters
         for attr in msg.findall('Attr') :
             checkValidAttr(attr)
             attrName = attr.get('name')
             attrType = attr.get('type')
+            if isViewAttr(attr) :
+                # view attributes can also be set from a string or array (which is copied)
+                viewType = getViewType(attrType)
+                f.write('        void Set' + attrName + '(const ' + viewType + '& val) {\n')
+                f.write('            this->' + attrName.lower() + ' = val;\n')
+                f.write('        };\n')
+                f.write('        void Set' + attrName + '(' + getRefType(attrType) + ' val) {\n')
+                if attrType == 'Core::String' :
+                    f.write('            this->' + attrName.lower() + ' = ' + viewType + '::Copy(val.AsCStr(), val.Length());\n')
+                else :
+                    f.write('            this->' + attrName.lower() + ' = ' + viewType + '::Copy(val.begin(), val.Size());\n')
+                f.write('        };\n')
+                f.write('        const ' + viewType + '& Get' + attrName + '() const {\n')
+                f.write('            return this->' + attrName.lower() + ';\n')
+                f.write('        };\n')
+                continue
             f.write('        void Set' + attrName + '(' + getRefType(attrType) + ' val) {\n')
             f.write('            this->' + attrName.lower() + ' = val;\n')
             f.write('        };\n')
@@ -243,12 +467,150 @@ def writeMessageClasses(f, xmlRoot) :
 
         # write members
         f.write('private:\n')
+        if msg.get('serialize', 'true') == 'true' :
+            f.write('        int32 compactFieldsSize() const;\n')
         for attr in msg.findall('Attr') :
             attrName = attr.get('name').lower()
             attrType = attr.get('type')
-            f.write('        ' + getValueType(attrType) + ' ' + attrName + ';\n')
+            if isViewAttr(attr) :
+                f.write('        ' + getViewType(attrType) + ' ' + attrName + ';\n')
+            else :
+                f.write('        ' + getValueType(attrType) + ' ' + attrName + ';\n')
         f.write('    };\n')
 
+#-------------------------------------------------------------------------------
+def writeFixedSizeSerializeMethods(f, xmlRoot, msg, attrs) :
+    '''
+    Writes the serializer methods of a message with only fixed-size
+    attributes, the attributes (including those of the parent classes)
+    are copied through a packed wire struct, which has the same layout
+    as the field-by-field encoding.
+    '''
+    protocol = xmlRoot.get('name')
+    msgClassName = msg.get('name')
+    wireName = msgClassName + 'Wire'
+
+    f.write('namespace {\n')
+    f.write('#pragma pack(push, 1)\n')
+    f.write('struct ' + wireName + ' {\n')
+    for attr in attrs :
+        f.write('    ' + attr.get('type') + ' ' + attr.get('name').lower() + ';\n')
+    f.write('};\n')
+    f.write('#pragma pack(pop)\n')
+    f.write('}\n')
+
+    # EncodedSize()
+    f.write('int32 ' + protocol + '::' + msgClassName + '::EncodedSize() const {\n')
+    f.write('    return Messaging::Message::EncodedSize() + sizeof(' + wireName + ');\n')
+    f.write('}\n')
+
+    # Encode()
+    f.write('uint8* ' + protocol + '::' + msgClassName + '::Encode(uint8* dstPtr, const uint8* maxValidPtr) const {\n')
+    f.write('    dstPtr = Messaging::Message::Encode(dstPtr, maxValidPtr);\n')
+    f.write('    if ((nullptr == dstPtr) || ((dstPtr + sizeof(' + wireName + ')) > maxValidPtr)) {\n')
+    f.write('        return nullptr;\n')
+    f.write('    }\n')
+    f.write('    ' + wireName + ' wire;\n')
+    for attr in attrs :
+        f.write('    wire.' + attr.get('name').lower() + ' = this->Get' + attr.get('name') + '();\n')
+    f.write('    std::memcpy(dstPtr, &wire, sizeof(wire));\n')
+    f.write('    return dstPtr + sizeof(wire);\n')
+    f.write('}\n')
+
+    # Decode()
+    f.write('const uint8* ' + protocol + '::' + msgClassName + '::Decode(const uint8* srcPtr, const uint8* maxValidPtr) {\n')
+    f.write('    srcPtr = Messaging::Message::Decode(srcPtr, maxValidPtr);\n')
+    f.write('    if ((nullptr == srcPtr) || ((srcPtr + sizeof(' + wireName + ')) > maxValidPtr)) {\n')
+    f.write('        return nullptr;\n')
+    f.write('    }\n')
+    f.write('    ' + wireName + ' wire;\n')
+    f.write('    std::memcpy(&wire, srcPtr, sizeof(wire));\n')
+    for attr in attrs :
+        f.write('    this->Set' + attr.get('name') + '(wire.' + attr.get('name').lower() + ');\n')
+    f.write('    return srcPtr + sizeof(wire);\n')
+    f.write('}\n')
+
+#-------------------------------------------------------------------------------
+def writeCompactSerializeMethods(f, xmlRoot, msg) :
+    '''
+    Writes the compact serializer methods of a message (see 
+    Messaging::CompactSerializer), the attributes of the message
+    class are encoded as a group of tagged fields after the parent
+    class attributes.
+    '''
+    protocol = xmlRoot.get('name')
+    msgClassName = msg.get('name')
+    msgParentClassName = msg.get('parent', 'Messaging::Message')
+    attrs = msg.findall('Attr')
+    tags = getCompactTags(msg)
+
+    # compactFieldsSize()
+    f.write('int32 ' + protocol + '::' + msgClassName + '::compactFieldsSize() const {\n')
+    f.write('    int32 s = 0;\n')
+    for attr, tag in zip(attrs, tags) :
+        attrName = attr.get('name').lower()
+        attrType = getViewType(attr.get('type')) if isViewAttr(attr) else attr.get('type')
+        cond = getCompactCondition(attr)
+        line = 's += Messaging::CompactSerializer::FieldSize<' + attrType + '>(' + str(tag) + ', this->' + attrName + ');\n'
+        if cond :
+            f.write('    if (' + cond + ') ' + line)
+        else :
+            f.write('    ' + line)
+    f.write('    return s;\n')
+    f.write('}\n')
+
+    # CompactEncodedSize()
+    f.write('int32 ' + protocol + '::' + msgClassName + '::CompactEncodedSize() const {\n')
+    f.write('    return ' + msgParentClassName + '::CompactEncodedSize() + Messaging::CompactSerializer::GroupSize(this->compactFieldsSize());\n')
+    f.write('}\n')
+
+    # EncodeCompact()
+    f.write('uint8* ' + protocol + '::' + msgClassName + '::EncodeCompact(uint8* dstPtr, const uint8* maxValidPtr) const {\n')
+    f.write('    dstPtr = ' + msgParentClassName + '::EncodeCompact(dstPtr, maxValidPtr);\n')
+    f.write('    dstPtr = Messaging::CompactSerializer::EncodeVarint(this->compactFieldsSize(), dstPtr, maxValidPtr);\n')
+    for attr, tag in zip(attrs, tags) :
+        attrName = attr.get('name').lower()
+        attrType = getViewType(attr.get('type')) if isViewAttr(attr) else attr.get('type')
+        cond = getCompactCondition(attr)
+        line = 'dstPtr = Messaging::CompactSerializer::EncodeField<' + attrType + '>(' + str(tag) + ', this->' + attrName + ', dstPtr, maxValidPtr);\n'
+        if cond :
+            f.write('    if (' + cond + ') ' + line)
+        else :
+            f.write('    ' + line)
+    f.write('    return dstPtr;\n')
+    f.write('}\n')
+
+    # DecodeCompact(), missing attributes get their default value
+    f.write('const uint8* ' + protocol + '::' + msgClassName + '::DecodeCompact(const uint8* srcPtr, const uint8* maxValidPtr) {\n')
+    f.write('    srcPtr = ' + msgParentClassName + '::DecodeCompact(srcPtr, maxValidPtr);\n')
+    f.write('    const uint8* endPtr = nullptr;\n')
+    f.write('    srcPtr = Messaging::CompactSerializer::DecodeGroupHeader(srcPtr, maxValidPtr, endPtr);\n')
+    for attr in attrs :
+        attrName = attr.get('name').lower()
+        defValue = getAttrDefaultValue(attr)
+        if isViewAttr(attr) :
+            f.write('    this->' + attrName + ' = ' + getViewType(attr.get('type')) + '();\n')
+            if defValue :
+                f.write('    this->Set' + attr.get('name') + '(' + attr.get('type') + '(' + defValue + '));\n')
+        elif defValue :
+            f.write('    this->' + attrName + ' = ' + defValue + ';\n')
+        else :
+            f.write('    this->' + attrName + ' = ' + attr.get('type') + '();\n')
+    f.write('    while ((nullptr != srcPtr) && (srcPtr < endPtr)) {\n')
+    f.write('        uint32 tag = 0;\n')
+    f.write('        uint8 wireType = 0;\n')
+    f.write('        srcPtr = Messaging::CompactSerializer::DecodeKey(srcPtr, endPtr, tag, wireType);\n')
+    f.write('        switch (tag) {\n')
+    for attr, tag in zip(attrs, tags) :
+        attrName = attr.get('name').lower()
+        attrType = getViewType(attr.get('type')) if isViewAttr(attr) else attr.get('type')
+        f.write('            case ' + str(tag) + ': srcPtr = Messaging::CompactSerializer::DecodeField<' + attrType + '>(srcPtr, endPtr, wireType, this->' + attrName + '); break;\n')
+    f.write('            default: srcPtr = Messaging::CompactSerializer::SkipField(srcPtr, endPtr, wireType); break;\n')
+    f.write('        }\n')
+    f.write('    }\n')
+    f.write('    return srcPtr;\n')
+    f.write('}\n')
+
 #-------------------------------------------------------------------------------
 def writeSerializeMethods(f, xmlRoot) :
     '''
@@ -260,13 +622,23 @@ def writeSerializeMethods(f, xmlRoot) :
             msgClassName = msg.get('name')
             msgParentClassName = msg.get('parent', 'Messaging::Message')
 
+            writeCompactSerializeMethods(f, xmlRoot, msg)
+
+            # messages with only fixed-size attributes have a fast path
+            fixedSizeAttrs = getFixedSizeAttrs(xmlRoot, msg)
+            if fixedSizeAttrs is not None :
+                writeFixedSizeSerializeMethods(f, xmlRoot, msg, fixedSizeAttrs)
+                continue
+
             # EncodedSize()
             f.write('int32 ' + protocol + '::' + msgClassName + '::EncodedSize() const {\n')
             f.write('    int32 s = ' + msgParentClassName + '::EncodedSize();\n')
             for attr in msg.findall('Attr') :
                 attrName = attr.get('name').lower()
                 attrType = attr.get('type')
-                if isArrayType(attrType) :
+                if isViewAttr(attr) :
+                    f.write('    s += Messaging::Serializer::EncodedViewSize<' + getViewElementType(attrType) + '>(this->' + attrName + ');\n')
+                elif isArrayType(attrType) :
                     elmType = getArrayType(attrType)                
                     f.write('    s += Messaging::Serializer::EncodedArraySize<' + elmType + '>(this->' + attrName + ');\n')
                 else :
@@ -282,7 +654,9 @@ def writeSerializeMethods(f, xmlRoot) :
             for attr in msg.findall('Attr') :
                 attrName = attr.get('name').lower()
                 attrType = attr.get('type')
-                if isArrayType(attrType) :
+                if isViewAttr(attr) :
+                    f.write('    dstPtr = Messaging::Serializer::EncodeView<' + getViewElementType(attrType) + '>(this->' + attrName + ', dstPtr, maxValidPtr);\n')
+                elif isArrayType(attrType) :
                     elmType = getArrayType(attrType)                
                     f.write('    dstPtr = Messaging::Serializer::EncodeArray<' + elmType + '>(this->' + attrName + ', dstPtr, maxValidPtr);\n')
                 else :            
@@ -296,7 +670,10 @@ def writeSerializeMethods(f, xmlRoot) :
             for attr in msg.findall('Attr') :
                 attrName = attr.get('name').lower()
                 attrType = attr.get('type')
-                if isArrayType(attrType) :
+                if isViewAttr(attr) :
+                    # references this->decodeBuffer when decoded with DecodeShared()
+                    f.write('    srcPtr = Messaging::Serializer::DecodeView<' + getViewElementType(attrType) + '>(srcPtr, maxValidPtr, this->decodeBuffer, this->' + attrName + ');\n')
+                elif isArrayType(attrType) :
                     elmType = getArrayType(attrType)
                     f.write('    srcPtr = Messaging::Serializer::DecodeArray<' + elmType + '>(srcPtr, maxValidPtr, this->' + attrName + ');\n')
                 else :
@@ -325,6 +702,7 @@ def generateHeader(xmlTree, absHeaderPath) :
     writeMessageIdEnum(f, xmlRoot)
     writeFactoryClassDecl(f, xmlRoot)
     writeMessageClasses(f, xmlRoot)
+    writeVisitMethod(f, xmlRoot)
     f.write('};\n')
     f.write('}\n')
     f.write('}\n')